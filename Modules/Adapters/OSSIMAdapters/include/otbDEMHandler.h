@@ -29,6 +29,10 @@
 #include "itkObjectFactory.h"
 #include "itkPoint.h"
 
+#include "otbDEMTileCache.h"
+
+#include <vector>
+
 #include "OTBOSSIMAdaptersExport.h"
 
 class ossimElevManager;
@@ -81,6 +85,16 @@ namespace otb
  * GetHeightAboveEllipsoid() method.
  *
  * DEM directory can either contain DTED or SRTM formats.
+ *
+ * Heights are retrieved through the ossimElevManager singleton by
+ * default. When a cache size is set with SetDEMCacheSize(), the DEM
+ * directories are also indexed by an OTB-side DEMTileCache, which serves
+ * the heights with lock-free lookups and follows the logic above. The
+ * cache is only used when it could index tiles in every opened
+ * directory, otherwise the ossimElevManager is still queried. Batch
+ * versions of the height queries are provided to amortize the lookups
+ * over many points.
+ *
  * \ingroup Images
  *
  *
@@ -143,6 +157,26 @@ public:
   virtual double GetHeightAboveEllipsoid(double lon, double lat) const;
   virtual double GetHeightAboveEllipsoid(const PointType& geoPoint) const;
 
+  /** Compute the heights above MSL and above ellipsoid of a batch of
+   * geographic points. */
+  virtual void GetHeightAboveMSL(const PointType* geoPoints, double* heights, unsigned long nbPoints) const;
+  virtual void GetHeightAboveEllipsoid(const PointType* geoPoints, double* heights, unsigned long nbPoints) const;
+
+  /**
+   * \brief Set the memory size of the DEM tile cache, in MB.
+   *
+   * A null size, the default, disables the cache and all heights are
+   * retrieved through the ossimElevManager.
+   */
+  void SetDEMCacheSize(unsigned int megabytes);
+  unsigned int GetDEMCacheSize() const;
+
+  /** \return true if heights are served by the DEM tile cache */
+  bool IsDEMCacheActive() const;
+
+  /** Get the DEM tile cache, for its hit statistics */
+  const DEMTileCache* GetDEMCache() const;
+
   /** Set the default height above ellipsoid in case no information is available*/
   virtual void SetDefaultHeightAboveEllipsoid(double h);
 
@@ -181,8 +215,22 @@ protected:
   // ellipsoid We therefore must keep it on our side
   double m_DefaultHeightAboveEllipsoid;
 
+  // Directories opened so far, to be indexed by the tile cache
+  std::vector<std::string> m_DEMDirectories;
+
+  DEMTileCache::Pointer m_DEMCache;
+  unsigned int          m_DEMCacheSize;
+  bool                  m_DEMCacheActive;
+
   static Pointer m_Singleton;
 
+private:
+  /** Index the opened directories in the tile cache */
+  void UpdateDEMCache();
+
+  /** Height above ellipsoid from a height above MSL served by the cache */
+  double HeightAboveEllipsoidFromMSL(double heightAboveMSL, double lon, double lat) const;
+
 };
 
 } // namespace otb
@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbDEMTileCache_h
+#define otbDEMTileCache_h
+
+#include <string>
+#include <vector>
+
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+#include "itkPoint.h"
+#include "itkAtomicInt.h"
+#include "itkConditionVariable.h"
+#include "itkSimpleMutexLock.h"
+
+#include "OTBOSSIMAdaptersExport.h"
+
+namespace otb
+{
+
+namespace internal
+{
+class DEMTile;
+struct DEMReaderSlot;
+class DEMReaderTable;
+}
+
+/** \class DEMTileCache
+ *
+ * \brief In-memory cache of DEM tiles, with lock-free lookups
+ *
+ * The tiles of the registered directories (SRTM hgt files, DTED cells and
+ * geographic GeoTIFF files) are indexed by one degree cells when the
+ * directory is added, and their posts are read on first use into a
+ * contiguous buffer. Heights above Mean Sea Level are bilinearly
+ * interpolated between the four surrounding posts, the posts with no data
+ * being left out of the weights, as the OSSIM elevation handlers do.
+ *
+ * Lookups of loaded tiles do not take any lock, nor write any shared
+ * counter: each querying thread has its own slot, where it publishes the
+ * epoch at which it started reading and counts its hits. The posts of the
+ * evicted tiles are unpublished at a new epoch, and only released once no
+ * thread started reading before it, the eviction waiting on a condition
+ * variable if needed. Loading a tile and evicting the least recently used
+ * ones to stay under MaximumMemorySize are serialized by a mutex. Adding or
+ * clearing directories must not happen while heights are queried.
+ *
+ * This class is used by DEMHandler when its cache is enabled, it should
+ * not be needed directly.
+ *
+ * \sa DEMHandler
+ *
+ * \ingroup OTBOSSIMAdapters
+ */
+class OTBOSSIMAdapters_EXPORT DEMTileCache : public itk::Object
+{
+public:
+  /** Standard class typedefs. */
+  typedef DEMTileCache                  Self;
+  typedef itk::Object                   Superclass;
+  typedef itk::SmartPointer<Self>       Pointer;
+  typedef itk::SmartPointer<const Self> ConstPointer;
+
+  typedef itk::Point<double, 2> PointType;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(DEMTileCache, itk::Object);
+
+  /** Index the DEM tiles of a directory, and return their number */
+  unsigned int AddDirectory(const std::string & directory);
+
+  /** Release all the tiles */
+  void Clear();
+
+  /** Number of indexed tiles */
+  unsigned int GetNumberOfTiles() const;
+
+  /** Set/Get the maximum memory used by the loaded tiles, in MB. At least
+   *  one tile is kept loaded whatever the value. */
+  void SetMaximumMemorySize(unsigned int megabytes);
+  itkGetConstMacro(MaximumMemorySize, unsigned int);
+
+  /** Height above MSL of a geographic point, or NaN if no tile covers it */
+  double GetHeightAboveMSL(double lon, double lat) const;
+
+  /** Heights above MSL of a batch of geographic points, NaN where no tile
+   *  covers the point. Consecutive points in the same tile share a single
+   *  tile lookup. */
+  void GetHeightAboveMSL(const PointType * points, double * heights, unsigned long nbPoints) const;
+
+  /** Statistics: lookups served by a loaded tile, lookups which needed to
+   *  load a tile, and memory used by the loaded tiles (in bytes) */
+  itk::SizeValueType GetNumberOfHits() const;
+  itk::SizeValueType GetNumberOfMisses() const;
+  itk::SizeValueType GetMemorySize() const;
+  void ResetStatistics();
+
+protected:
+  DEMTileCache();
+  ~DEMTileCache() ITK_OVERRIDE;
+
+  void PrintSelf(std::ostream& os, itk::Indent indent) const ITK_OVERRIDE;
+
+private:
+  DEMTileCache(const Self &); //purposely not implemented
+  void operator =(const Self&); //purposely not implemented
+
+  typedef internal::DEMTile       TileType;
+  typedef internal::DEMReaderSlot ReaderSlotType;
+
+  /** Posts unpublished at an epoch, released when no thread reads them */
+  struct RetiredPosts
+  {
+    float *            m_Posts;
+    itk::int64_t       m_Epoch;
+    itk::SizeValueType m_MemorySize;
+  };
+
+  /** Tile covering a point, or NULL */
+  TileType * FindTile(double lon, double lat) const;
+
+  /** Slot of the calling thread, and start/stop reading posts in it */
+  ReaderSlotType * GetReaderSlot() const;
+  void StartReading(ReaderSlotType * slot) const;
+  void StopReading(ReaderSlotType * slot) const;
+
+  /** Posts of a tile, loaded if needed, for a thread reading. Returns NULL
+   *  if the tile can not be read. */
+  const float * GetPosts(TileType * tile, ReaderSlotType * slot) const;
+
+  /** Load the posts of a tile, evict tiles over the memory budget and
+   *  release the retired posts no thread reads any more. Called with the
+   *  mutex locked. */
+  void LoadTile(TileType * tile) const;
+  void EvictTiles(const TileType * keep) const;
+  void ReleaseRetiredPosts(bool wait) const;
+
+  /** Interpolated height in the posts of a tile being read */
+  static double Interpolate(const TileType * tile, const float * posts, double lon, double lat);
+
+  std::vector<TileType *> m_Tiles;
+
+  /** Tiles intersecting each one degree cell */
+  std::vector<std::vector<unsigned int> > m_CellIndex;
+
+  unsigned int m_MaximumMemorySize;
+
+  itk::SmartPointer<internal::DEMReaderTable> m_Readers;
+
+  mutable itk::AtomicInt<itk::int64_t> m_Epoch;
+  mutable itk::AtomicInt<int>          m_NumberOfWaitingEvictions;
+
+  mutable itk::SimpleMutexLock            m_Mutex;
+  mutable itk::ConditionVariable::Pointer m_ReadingStopped;
+  mutable std::vector<RetiredPosts>       m_RetiredPosts;
+  mutable itk::SizeValueType              m_LoadedMemorySize;
+  mutable itk::SizeValueType              m_RetiredMemorySize;
+  mutable itk::SizeValueType              m_NumberOfMisses;
+  mutable unsigned int                    m_ClockHand;
+};
+
+} // namespace otb
+
+#endif
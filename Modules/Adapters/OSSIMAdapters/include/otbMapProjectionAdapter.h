@@ -36,6 +36,11 @@ class ossimProjection;
 namespace otb
 {
 
+namespace internal
+{
+class MapProjectionKernel;
+}
+
 /**
  * \class MapProjectionAdapter
  * \brief Wrapper class to group all dependencies to ossim for map projection
@@ -85,6 +90,25 @@ public:
   void ForwardTransform(double lon, double lat, double h,
                         double& x, double& y, double& z);
 
+  /** Batch version of InverseTransform. Heights are copied from z to h,
+   * both may be null. When the projection has a native kernel (see
+   * HasNativeKernel()), points are processed without going through OSSIM. */
+  void InverseTransformPoints(const double * x, const double * y, const double * z,
+                              double * lon, double * lat, double * h,
+                              unsigned long nbPoints);
+
+  /** Batch version of ForwardTransform. Heights are copied from h to z,
+   * both may be null. */
+  void ForwardTransformPoints(const double * lon, const double * lat, const double * h,
+                              double * x, double * y, double * z,
+                              unsigned long nbPoints);
+
+  /** True if batch transforms use a native implementation of the
+   * projection (UTM, transverse Mercator, Lambert conformal conic,
+   * Mercator and sinusoidal on the WGS84 datum). The kernel is only
+   * enabled if it reproduces the OSSIM projection around its origin. */
+  bool HasNativeKernel() const;
+
   void PrintMap() const;
 
 protected:
@@ -97,6 +121,9 @@ private:
 
   void ApplyParametersToProjection();
 
+  /** Rebuild the native kernel of the current projection */
+  void UpdateKernel();
+
   InternalMapProjectionPointer m_MapProjection;
   std::string                  m_ProjectionRefWkt;
 
@@ -108,6 +135,8 @@ private:
   StoreType m_ParameterStore;
 
   bool m_ReinstanciateProjection;
+
+  internal::MapProjectionKernel * m_Kernel;
 };
 
 // Some useful free functions related to ossim
@@ -56,6 +56,7 @@ public:
   typedef itk::Point<double, 3>               Point3DType;
   typedef std::pair<Point2DType, Point3DType> GCPType;
   typedef std::vector<GCPType>                GCPsContainerType;
+  typedef std::vector<bool>                   InlierFlagsType;
 
   /** Solve RPC modelling from a set of GCPs and image bounds.
    *  The estimated RPC model is written in a keywordlist understood
@@ -77,6 +78,30 @@ public:
                     double& rmsError,
                     const std::string & outgeom);
 
+  /** Solve RPC modelling from a set of GCPs with the native solver.
+   *  The numerator and denominator coefficients of each image axis
+   *  are estimated by iteratively reweighted least squares on the
+   *  normal equations of the linearised rational functions, instead
+   *  of going through the OSSIM solver. The same minimum numbers of
+   *  points as above apply.
+   *
+   *  If ransacThreshold is strictly positive, ransacIterations random
+   *  minimal sets of GCPs are drawn (in parallel) and the final fit
+   *  only uses the largest consensus set, i.e. the GCPs whose image
+   *  residual is lower than ransacThreshold pixels. The draws are
+   *  seeded by their rank, so that the result does not depend on the
+   *  number of threads.
+   *
+   *  On return, inliers flags the GCPs used by the final fit, and
+   *  rmsError is the image RMS residual (in pixels) over these GCPs.
+   */
+  static void Solve(const GCPsContainerType& gcpContainer,
+                    double ransacThreshold,
+                    unsigned int ransacIterations,
+                    double& rmsError,
+                    InlierFlagsType& inliers,
+                    ImageKeywordlist& otb_kwl);
+
 
 private:
   RPCSolverAdapter(const Self &); //purposely not implemented
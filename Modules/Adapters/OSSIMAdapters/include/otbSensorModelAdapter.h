@@ -31,6 +31,11 @@ namespace otb
 
 class ImageKeywordlist;
 
+namespace internal
+{
+class RPCEvaluator;
+}
+
 /**
  * \class SensorModelAdapter
  * \brief Wrapper class to group all dependencies to ossim for sensor models
@@ -66,6 +71,10 @@ public:
   /** Run-time type information (and related methods). */
   itkTypeMacro(SensorModelAdapter, itk::Object);
 
+  /** Copy of the adapter with its own ossim model, to be used by another
+   * thread. Tie points are not copied. */
+  itkCloneMacro(Self);
+
   /** Create the projection ( m_Model). Called by the SetImageGeometry methods */
   void CreateProjection(const ImageKeywordlist& image_kwl);
   // FIXME check if it should be protected instead
@@ -87,6 +96,19 @@ public:
   void InverseTransformPoint(double lon, double lat,
                              double& x, double& y, double& z) const;
 
+  /** Forward sensor modelling of nbPoints points stored in contiguous
+   * arrays. If z is null, the elevation is estimated by the algorithm. */
+  void ForwardTransformPoints(const double * x, const double * y, const double * z,
+                              double * lon, double * lat, double * h,
+                              unsigned long nbPoints) const;
+
+  /** Inverse sensor modelling of nbPoints points stored in contiguous
+   * arrays. If h is null, the elevation is read from DEMHandler. RPC models
+   * are evaluated directly on the whole batch. */
+  void InverseTransformPoints(const double * lon, const double * lat, const double * h,
+                              double * x, double * y, double * z,
+                              unsigned long nbPoints) const;
+
 
   /** Add a tie point with elevation (above ellipsoid) provided by the user */
   void AddTiePoint(double x, double y, double z, double lon, double lat);
@@ -113,12 +135,20 @@ protected:
   SensorModelAdapter();
   ~SensorModelAdapter() ITK_OVERRIDE;
 
+  itk::LightObject::Pointer InternalClone() const ITK_OVERRIDE;
+
 private:
   SensorModelAdapter(const Self &); //purposely not implemented
   void operator =(const Self&); //purposely not implemented
 
+  /** Set up the direct RPC evaluation if the model is a RPC model */
+  void UpdateRPCEvaluator();
+
   InternalMapProjectionPointer m_SensorModel;
 
+  /** Direct evaluation of the RPC model, null for other models */
+  internal::RPCEvaluator * m_RPCEvaluator;
+
   InternalTiePointsContainerPointer m_TiePoints;
 
   /** Object that read and use DEM */
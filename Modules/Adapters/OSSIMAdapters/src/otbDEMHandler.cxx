@@ -20,6 +20,7 @@
 
 #include "otbDEMHandler.h"
 #include "otbMacro.h"
+#include "vnl/vnl_math.h"
 
 #include <cassert>
 
@@ -72,7 +73,10 @@ DEMHandler::Pointer DEMHandler::Instance()
 DEMHandler
 ::DEMHandler() :
   m_GeoidFile(""),
-  m_DefaultHeightAboveEllipsoid(0)
+  m_DefaultHeightAboveEllipsoid(0),
+  m_DEMCache(DEMTileCache::New()),
+  m_DEMCacheSize(0),
+  m_DEMCacheActive(false)
 {
   assert( ossimElevManager::instance()!=NULL );
 
@@ -109,6 +113,9 @@ DEMHandler
       ossimElevManager::instance()->addDatabase(imageElevationDatabase.get());
       }
     }
+
+  m_DEMDirectories.push_back(DEMDirectory);
+  UpdateDEMCache();
 }
 
 
@@ -119,6 +126,9 @@ DEMHandler
   assert( ossimElevManager::instance()!=NULL );
 
   ossimElevManager::instance()->clear();
+
+  m_DEMDirectories.clear();
+  UpdateDEMCache();
 }
 
 
@@ -205,6 +215,12 @@ DEMHandler
   ossimWorldPoint.lon = lon;
   ossimWorldPoint.lat = lat;
 
+  if (m_DEMCacheActive)
+    {
+    height = m_DEMCache->GetHeightAboveMSL(lon, lat);
+    return vnl_math_isnan(height) ? 0. : height;
+    }
+
   assert( ossimElevManager::instance()!=NULL );
 
   height = ossimElevManager::instance()->getHeightAboveMSL(ossimWorldPoint);
@@ -229,6 +245,11 @@ DEMHandler
   ossimWorldPoint.lon = lon;
   ossimWorldPoint.lat = lat;
 
+  if (m_DEMCacheActive)
+    {
+    return HeightAboveEllipsoidFromMSL(m_DEMCache->GetHeightAboveMSL(lon, lat), lon, lat);
+    }
+
   assert( ossimElevManager::instance()!=NULL );
 
   height = ossimElevManager::instance()->getHeightAboveEllipsoid(ossimWorldPoint);
@@ -243,6 +264,136 @@ DEMHandler
   return GetHeightAboveEllipsoid(geoPoint[0], geoPoint[1]);
 }
 
+void
+DEMHandler
+::GetHeightAboveMSL(const PointType* geoPoints, double* heights, unsigned long nbPoints) const
+{
+  if (!m_DEMCacheActive)
+    {
+    for (unsigned long i = 0; i < nbPoints; ++i)
+      {
+      heights[i] = GetHeightAboveMSL(geoPoints[i]);
+      }
+    return;
+    }
+
+  m_DEMCache->GetHeightAboveMSL(geoPoints, heights, nbPoints);
+  for (unsigned long i = 0; i < nbPoints; ++i)
+    {
+    if (vnl_math_isnan(heights[i]))
+      {
+      heights[i] = 0.;
+      }
+    }
+}
+
+void
+DEMHandler
+::GetHeightAboveEllipsoid(const PointType* geoPoints, double* heights, unsigned long nbPoints) const
+{
+  if (!m_DEMCacheActive)
+    {
+    for (unsigned long i = 0; i < nbPoints; ++i)
+      {
+      heights[i] = GetHeightAboveEllipsoid(geoPoints[i]);
+      }
+    return;
+    }
+
+  m_DEMCache->GetHeightAboveMSL(geoPoints, heights, nbPoints);
+  for (unsigned long i = 0; i < nbPoints; ++i)
+    {
+    heights[i] = HeightAboveEllipsoidFromMSL(heights[i], geoPoints[i][0], geoPoints[i][1]);
+    }
+}
+
+double
+DEMHandler
+::HeightAboveEllipsoidFromMSL(double heightAboveMSL, double lon, double lat) const
+{
+  ossimGpt ossimWorldPoint;
+  ossimWorldPoint.lon = lon;
+  ossimWorldPoint.lat = lat;
+
+  // Same fallbacks as the ossimElevManager: geoid offset added to the DEM
+  // height, geoid offset alone, then default height above ellipsoid
+  const double geoidOffset = ossimGeoidManager::instance()->offsetFromEllipsoid(ossimWorldPoint);
+
+  if (!vnl_math_isnan(heightAboveMSL))
+    {
+    return vnl_math_isnan(geoidOffset) ? heightAboveMSL : heightAboveMSL + geoidOffset;
+    }
+  if (!vnl_math_isnan(geoidOffset))
+    {
+    return geoidOffset;
+    }
+  return m_DefaultHeightAboveEllipsoid;
+}
+
+void
+DEMHandler
+::SetDEMCacheSize(unsigned int megabytes)
+{
+  m_DEMCacheSize = megabytes;
+  if (megabytes > 0)
+    {
+    m_DEMCache->SetMaximumMemorySize(megabytes);
+    }
+  UpdateDEMCache();
+}
+
+unsigned int
+DEMHandler
+::GetDEMCacheSize() const
+{
+  return m_DEMCacheSize;
+}
+
+bool
+DEMHandler
+::IsDEMCacheActive() const
+{
+  return m_DEMCacheActive;
+}
+
+const DEMTileCache*
+DEMHandler
+::GetDEMCache() const
+{
+  return m_DEMCache.GetPointer();
+}
+
+void
+DEMHandler
+::UpdateDEMCache()
+{
+  m_DEMCacheActive = false;
+  m_DEMCache->Clear();
+
+  if (m_DEMCacheSize == 0 || m_DEMDirectories.empty())
+    {
+    return;
+    }
+
+  // The cache only serves the heights if it indexed all the opened
+  // directories, so that it does not miss tiles ossim would use
+  m_DEMCacheActive = true;
+  for (std::vector<std::string>::const_iterator it = m_DEMDirectories.begin();
+       it != m_DEMDirectories.end() && m_DEMCacheActive; ++it)
+    {
+    if (m_DEMCache->AddDirectory(*it) == 0)
+      {
+      otbMsgDevMacro(<< "No DEM tile could be indexed in " << *it << ", the DEM cache is disabled");
+      m_DEMCacheActive = false;
+      }
+    }
+
+  if (!m_DEMCacheActive)
+    {
+    m_DEMCache->Clear();
+    }
+}
+
 void
 DEMHandler
 ::SetDefaultHeightAboveEllipsoid(double h)
@@ -300,6 +451,13 @@ DEMHandler
 {
   Superclass::PrintSelf(os, indent);
   os << indent << "DEMHandler" << std::endl;
+  os << indent << "DEMCacheSize: " << m_DEMCacheSize << " MB" << std::endl;
+  os << indent << "DEMCacheActive: " << (m_DEMCacheActive ? "true" : "false") << std::endl;
+  if (m_DEMCacheActive)
+    {
+    os << indent << "DEMCache: " << std::endl;
+    m_DEMCache->Print(os, indent.GetNextIndent());
+    }
 }
 
 } // namespace otb
@@ -0,0 +1,778 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbDEMTileCache.h"
+#include "otbMacro.h"
+
+#include "itkMutexLockHolder.h"
+#include "itkSimpleFastMutexLock.h"
+#include "itksys/Directory.hxx"
+#include "itksys/SystemTools.hxx"
+#include "vnl/vnl_math.h"
+
+#include "gdal.h"
+#include "ogr_spatialref.h"
+
+#include <algorithm>
+#include <deque>
+#include <limits>
+
+namespace otb
+{
+
+namespace internal
+{
+/** \class DEMTile
+ * \brief Geometry and posts of a DEM tile.
+ *
+ * The geometry is set when the tile is indexed and never changes. The posts
+ * pointer is published and unpublished atomically, the unpublished posts
+ * being released by the cache once no thread reads them any more.
+ *
+ * \ingroup OTBOSSIMAdapters
+ */
+class DEMTile
+{
+public:
+  DEMTile() :
+    m_OriginX(0.), m_OriginY(0.), m_SpacingX(0.), m_SpacingY(0.),
+    m_SizeX(0), m_SizeY(0), m_HasNoData(false), m_NoData(0.),
+    m_Posts(ITK_NULLPTR), m_Referenced(0), m_Failed(0)
+  {
+  }
+
+  ~DEMTile()
+  {
+    delete[] m_Posts.Load();
+  }
+
+  bool Contains(double lon, double lat) const
+  {
+    const double lastX = m_OriginX + (m_SizeX - 1) * m_SpacingX;
+    const double lastY = m_OriginY + (m_SizeY - 1) * m_SpacingY;
+    return lon >= std::min(m_OriginX, lastX) && lon <= std::max(m_OriginX, lastX)
+      && lat >= std::min(m_OriginY, lastY) && lat <= std::max(m_OriginY, lastY);
+  }
+
+  itk::SizeValueType GetMemorySize() const
+  {
+    return static_cast<itk::SizeValueType>(m_SizeX) * m_SizeY * sizeof(float);
+  }
+
+  std::string  m_FileName;
+
+  // Position of the first post and spacing between posts, in degrees
+  double       m_OriginX;
+  double       m_OriginY;
+  double       m_SpacingX;
+  double       m_SpacingY;
+  unsigned int m_SizeX;
+  unsigned int m_SizeY;
+  bool         m_HasNoData;
+  double       m_NoData;
+
+  itk::AtomicInt<float *> m_Posts;
+  itk::AtomicInt<int>     m_Referenced;
+  itk::AtomicInt<int>     m_Failed;
+
+private:
+  DEMTile(const DEMTile &); //purposely not implemented
+  void operator =(const DEMTile&); //purposely not implemented
+};
+
+/** \class DEMReaderSlot
+ * \brief Reading state of a thread querying a DEM tile cache.
+ *
+ * The epoch at which the thread started reading posts, 0 when it does not
+ * read any, and its number of lookups served by a loaded tile. Both are
+ * only written by the thread, and the padding keeps them away from the
+ * cache line of the other slots.
+ *
+ * \ingroup OTBOSSIMAdapters
+ */
+struct DEMReaderSlot
+{
+  DEMReaderSlot() : m_Epoch(0), m_Hits(0), m_Used(false)
+  {
+  }
+
+  itk::AtomicInt<itk::int64_t> m_Epoch;
+  itk::AtomicInt<itk::int64_t> m_Hits;
+  bool                         m_Used;
+  char                         m_Padding[64];
+};
+
+/** \class DEMReaderTable
+ * \brief Slots of the threads querying a DEM tile cache.
+ *
+ * A thread gets a slot on its first query and gives it back when it exits,
+ * so that the table only grows with the number of concurrent threads. The
+ * table is reference counted, as threads may exit after the cache is
+ * destroyed.
+ *
+ * \ingroup OTBOSSIMAdapters
+ */
+class DEMReaderTable : public itk::LightObject
+{
+public:
+  typedef DEMReaderTable            Self;
+  typedef itk::LightObject          Superclass;
+  typedef itk::SmartPointer<Self>   Pointer;
+
+  itkNewMacro(Self);
+
+  DEMReaderSlot * Acquire()
+  {
+    itk::MutexLockHolder<itk::SimpleFastMutexLock> lock(m_Mutex);
+    for (std::deque<DEMReaderSlot>::iterator it = m_Slots.begin(); it != m_Slots.end(); ++it)
+      {
+      if (!it->m_Used)
+        {
+        it->m_Used = true;
+        return &*it;
+        }
+      }
+    // Slots never move, as a deque does not reallocate its elements
+    m_Slots.resize(m_Slots.size() + 1);
+    m_Slots.back().m_Used = true;
+    return &m_Slots.back();
+  }
+
+  void Release(DEMReaderSlot * slot)
+  {
+    itk::MutexLockHolder<itk::SimpleFastMutexLock> lock(m_Mutex);
+    slot->m_Used = false;
+  }
+
+  /** Epoch of the oldest reading thread, or the largest epoch if none */
+  itk::int64_t GetOldestEpoch() const
+  {
+    itk::MutexLockHolder<itk::SimpleFastMutexLock> lock(m_Mutex);
+    itk::int64_t oldestEpoch = std::numeric_limits<itk::int64_t>::max();
+    for (std::deque<DEMReaderSlot>::const_iterator it = m_Slots.begin(); it != m_Slots.end(); ++it)
+      {
+      const itk::int64_t epoch = it->m_Epoch.Load();
+      if (epoch != 0)
+        {
+        oldestEpoch = std::min(oldestEpoch, epoch);
+        }
+      }
+    return oldestEpoch;
+  }
+
+  itk::SizeValueType GetNumberOfHits() const
+  {
+    itk::MutexLockHolder<itk::SimpleFastMutexLock> lock(m_Mutex);
+    itk::SizeValueType nbHits = 0;
+    for (std::deque<DEMReaderSlot>::const_iterator it = m_Slots.begin(); it != m_Slots.end(); ++it)
+      {
+      nbHits += it->m_Hits.Load();
+      }
+    return nbHits;
+  }
+
+  void ResetNumberOfHits()
+  {
+    itk::MutexLockHolder<itk::SimpleFastMutexLock> lock(m_Mutex);
+    for (std::deque<DEMReaderSlot>::iterator it = m_Slots.begin(); it != m_Slots.end(); ++it)
+      {
+      it->m_Hits.Store(0);
+      }
+  }
+
+protected:
+  DEMReaderTable() {}
+  ~DEMReaderTable() ITK_OVERRIDE {}
+
+private:
+  DEMReaderTable(const Self &); //purposely not implemented
+  void operator =(const Self&); //purposely not implemented
+
+  mutable itk::SimpleFastMutexLock m_Mutex;
+  std::deque<DEMReaderSlot>        m_Slots;
+};
+}
+
+namespace
+{
+const int NumberOfCellsX = 360;
+const int NumberOfCellsY = 180;
+
+bool IsDEMFile(const std::string & filename)
+{
+  const std::string extension =
+    itksys::SystemTools::LowerCase(itksys::SystemTools::GetFilenameLastExtension(filename));
+  return extension == ".hgt" || extension == ".dt0" || extension == ".dt1" || extension == ".dt2"
+    || extension == ".tif" || extension == ".tiff";
+}
+
+void FindDEMFiles(const std::string & directory, std::vector<std::string> & filenames)
+{
+  itksys::Directory dir;
+  if (!dir.Load(directory.c_str()))
+    {
+    return;
+    }
+  for (unsigned long i = 0; i < dir.GetNumberOfFiles(); ++i)
+    {
+    const std::string name = dir.GetFile(i);
+    if (name == "." || name == "..")
+      {
+      continue;
+      }
+    const std::string path = directory + "/" + name;
+    if (itksys::SystemTools::FileIsDirectory(path.c_str()))
+      {
+      // DTED cells are stored in one sub-directory per longitude
+      FindDEMFiles(path, filenames);
+      }
+    else if (IsDEMFile(name))
+      {
+      filenames.push_back(path);
+      }
+    }
+}
+
+/** Slot of the calling thread, given back when the thread exits */
+struct DEMReaderRegistration
+{
+  DEMReaderRegistration() : m_Slot(ITK_NULLPTR)
+  {
+  }
+
+  ~DEMReaderRegistration()
+  {
+    if (m_Slot)
+      {
+      m_Table->Release(m_Slot);
+      }
+  }
+
+  internal::DEMReaderTable::Pointer m_Table;
+  internal::DEMReaderSlot *         m_Slot;
+};
+
+thread_local DEMReaderRegistration ThreadReaderRegistration;
+}
+
+DEMTileCache
+::DEMTileCache() :
+  m_CellIndex(NumberOfCellsX * NumberOfCellsY),
+  m_MaximumMemorySize(256),
+  m_Readers(internal::DEMReaderTable::New()),
+  m_Epoch(1),
+  m_NumberOfWaitingEvictions(0),
+  m_ReadingStopped(itk::ConditionVariable::New()),
+  m_LoadedMemorySize(0),
+  m_RetiredMemorySize(0),
+  m_NumberOfMisses(0),
+  m_ClockHand(0)
+{
+}
+
+DEMTileCache
+::~DEMTileCache()
+{
+  this->Clear();
+}
+
+unsigned int
+DEMTileCache
+::AddDirectory(const std::string & directory)
+{
+  GDALAllRegister();
+
+  std::vector<std::string> filenames;
+  FindDEMFiles(directory, filenames);
+  std::sort(filenames.begin(), filenames.end());
+
+  unsigned int nbTiles = 0;
+  for (std::vector<std::string>::const_iterator it = filenames.begin(); it != filenames.end(); ++it)
+    {
+    GDALDatasetH dataset = GDALOpen(it->c_str(), GA_ReadOnly);
+    if (dataset == ITK_NULLPTR)
+      {
+      continue;
+      }
+
+    // Only north-up tiles in geographic coordinates are supported
+    double geoTransform[6];
+    bool valid = GDALGetRasterCount(dataset) > 0
+      && GDALGetGeoTransform(dataset, geoTransform) == CE_None
+      && geoTransform[2] == 0. && geoTransform[4] == 0.;
+
+    const char * projectionRef = GDALGetProjectionRef(dataset);
+    if (valid)
+      {
+      OGRSpatialReference srs;
+      valid = projectionRef != ITK_NULLPTR && projectionRef[0] != '\0'
+        && srs.SetFromUserInput(projectionRef) == OGRERR_NONE && srs.IsGeographic();
+      }
+
+    if (valid)
+      {
+      TileType * tile = new TileType;
+      tile->m_FileName = *it;
+      // Posts are at the centre of the GDAL pixels
+      tile->m_SpacingX = geoTransform[1];
+      tile->m_SpacingY = geoTransform[5];
+      tile->m_OriginX  = geoTransform[0] + 0.5 * geoTransform[1];
+      tile->m_OriginY  = geoTransform[3] + 0.5 * geoTransform[5];
+      tile->m_SizeX    = GDALGetRasterXSize(dataset);
+      tile->m_SizeY    = GDALGetRasterYSize(dataset);
+
+      int hasNoData = 0;
+      tile->m_NoData    = GDALGetRasterNoDataValue(GDALGetRasterBand(dataset, 1), &hasNoData);
+      tile->m_HasNoData = hasNoData != 0;
+
+      const unsigned int tileId = m_Tiles.size();
+      m_Tiles.push_back(tile);
+      ++nbTiles;
+
+      // Index the tile in all the one degree cells it intersects
+      const double lastX = tile->m_OriginX + (tile->m_SizeX - 1) * tile->m_SpacingX;
+      const double lastY = tile->m_OriginY + (tile->m_SizeY - 1) * tile->m_SpacingY;
+      const int minX = std::max(static_cast<int>(vcl_floor(std::min(tile->m_OriginX, lastX))) + 180, 0);
+      const int maxX = std::min(static_cast<int>(vcl_floor(std::max(tile->m_OriginX, lastX))) + 180, NumberOfCellsX - 1);
+      const int minY = std::max(static_cast<int>(vcl_floor(std::min(tile->m_OriginY, lastY))) + 90, 0);
+      const int maxY = std::min(static_cast<int>(vcl_floor(std::max(tile->m_OriginY, lastY))) + 90, NumberOfCellsY - 1);
+      for (int y = minY; y <= maxY; ++y)
+        {
+        for (int x = minX; x <= maxX; ++x)
+          {
+          m_CellIndex[y * NumberOfCellsX + x].push_back(tileId);
+          }
+        }
+      }
+    else
+      {
+      otbMsgDevMacro(<< "Skipping DEM file " << *it << ": not a north-up geographic raster");
+      }
+
+    GDALClose(dataset);
+    }
+
+  otbMsgDevMacro(<< nbTiles << " DEM tiles indexed in " << directory);
+  this->Modified();
+  return nbTiles;
+}
+
+void
+DEMTileCache
+::Clear()
+{
+  for (std::vector<TileType *>::iterator it = m_Tiles.begin(); it != m_Tiles.end(); ++it)
+    {
+    delete *it;
+    }
+  for (std::vector<RetiredPosts>::iterator it = m_RetiredPosts.begin(); it != m_RetiredPosts.end(); ++it)
+    {
+    delete[] it->m_Posts;
+    }
+  m_Tiles.clear();
+  m_RetiredPosts.clear();
+  m_CellIndex.assign(NumberOfCellsX * NumberOfCellsY, std::vector<unsigned int>());
+  m_LoadedMemorySize = 0;
+  m_RetiredMemorySize = 0;
+  m_ClockHand = 0;
+  this->Modified();
+}
+
+unsigned int
+DEMTileCache
+::GetNumberOfTiles() const
+{
+  return m_Tiles.size();
+}
+
+void
+DEMTileCache
+::SetMaximumMemorySize(unsigned int megabytes)
+{
+  itk::MutexLockHolder<itk::SimpleMutexLock> lock(m_Mutex);
+  m_MaximumMemorySize = megabytes;
+  this->EvictTiles(ITK_NULLPTR);
+  this->Modified();
+}
+
+DEMTileCache::TileType *
+DEMTileCache
+::FindTile(double lon, double lat) const
+{
+  if (!(lon >= -180. && lon <= 180. && lat >= -90. && lat <= 90.))
+    {
+    return ITK_NULLPTR;
+    }
+
+  const int x = std::min(static_cast<int>(vcl_floor(lon)) + 180, NumberOfCellsX - 1);
+  const int y = std::min(static_cast<int>(vcl_floor(lat)) + 90, NumberOfCellsY - 1);
+  const std::vector<unsigned int> & cell = m_CellIndex[y * NumberOfCellsX + x];
+
+  for (std::vector<unsigned int>::const_iterator it = cell.begin(); it != cell.end(); ++it)
+    {
+    if (m_Tiles[*it]->Contains(lon, lat))
+      {
+      return m_Tiles[*it];
+      }
+    }
+  return ITK_NULLPTR;
+}
+
+DEMTileCache::ReaderSlotType *
+DEMTileCache
+::GetReaderSlot() const
+{
+  DEMReaderRegistration & registration = ThreadReaderRegistration;
+  if (registration.m_Table.GetPointer() != m_Readers.GetPointer())
+    {
+    if (registration.m_Slot)
+      {
+      registration.m_Table->Release(registration.m_Slot);
+      }
+    registration.m_Table = m_Readers;
+    registration.m_Slot = m_Readers->Acquire();
+    }
+  return registration.m_Slot;
+}
+
+void
+DEMTileCache
+::StartReading(ReaderSlotType * slot) const
+{
+  // The atomic store is sequentially consistent: the posts read afterwards
+  // can not have been unpublished before the current epoch
+  slot->m_Epoch.Store(m_Epoch.Load());
+}
+
+void
+DEMTileCache
+::StopReading(ReaderSlotType * slot) const
+{
+  slot->m_Epoch.Store(0);
+  if (m_NumberOfWaitingEvictions.Load() != 0)
+    {
+    // The waiting evictions only release the mutex while waiting
+    itk::MutexLockHolder<itk::SimpleMutexLock> lock(m_Mutex);
+    m_ReadingStopped->Broadcast();
+    }
+}
+
+const float *
+DEMTileCache
+::GetPosts(TileType * tile, ReaderSlotType * slot) const
+{
+  while (true)
+    {
+    float * posts = tile->m_Posts.Load();
+    if (posts != ITK_NULLPTR)
+      {
+      // Avoid writing a shared flag on each lookup
+      if (tile->m_Referenced.Load() == 0)
+        {
+        tile->m_Referenced.Store(1);
+        }
+      return posts;
+      }
+
+    if (tile->m_Failed.Load() != 0)
+      {
+      return ITK_NULLPTR;
+      }
+
+    // Never wait for the mutex while reading, as an eviction holding it may
+    // be waiting for this thread
+    this->StopReading(slot);
+      {
+      itk::MutexLockHolder<itk::SimpleMutexLock> lock(m_Mutex);
+      if (tile->m_Posts.Load() == ITK_NULLPTR)
+        {
+        this->LoadTile(tile);
+        }
+      }
+    this->StartReading(slot);
+    }
+}
+
+void
+DEMTileCache
+::LoadTile(TileType * tile) const
+{
+  ++m_NumberOfMisses;
+
+  GDALDatasetH dataset = GDALOpen(tile->m_FileName.c_str(), GA_ReadOnly);
+  if (dataset == ITK_NULLPTR)
+    {
+    otbMsgDevMacro(<< "Failed to open DEM tile " << tile->m_FileName);
+    tile->m_Failed.Store(1);
+    return;
+    }
+
+  float * posts = new float[tile->m_SizeX * tile->m_SizeY];
+  const CPLErr error = GDALRasterIO(GDALGetRasterBand(dataset, 1), GF_Read, 0, 0, tile->m_SizeX, tile->m_SizeY,
+                                    posts, tile->m_SizeX, tile->m_SizeY, GDT_Float32, 0, 0);
+  GDALClose(dataset);
+
+  if (error != CE_None)
+    {
+    otbMsgDevMacro(<< "Failed to read DEM tile " << tile->m_FileName);
+    delete[] posts;
+    tile->m_Failed.Store(1);
+    return;
+    }
+
+  // Published before the eviction, which may release the mutex while
+  // waiting for the readers
+  m_LoadedMemorySize += tile->GetMemorySize();
+  tile->m_Referenced.Store(1);
+  tile->m_Posts.Store(posts);
+
+  this->EvictTiles(tile);
+}
+
+void
+DEMTileCache
+::EvictTiles(const TileType * keep) const
+{
+  const itk::SizeValueType maximumSize = static_cast<itk::SizeValueType>(m_MaximumMemorySize) * 1024 * 1024;
+
+  // Clock algorithm: a tile used since the last pass of the hand gets a
+  // second chance. Two rounds are enough to clear all the flags.
+  const std::vector<RetiredPosts>::size_type nbRetired = m_RetiredPosts.size();
+  for (unsigned int nbVisited = 0; m_LoadedMemorySize > maximumSize && nbVisited < 2 * m_Tiles.size(); ++nbVisited)
+    {
+    TileType * tile = m_Tiles[m_ClockHand];
+    m_ClockHand = (m_ClockHand + 1) % m_Tiles.size();
+
+    float * posts = tile->m_Posts.Load();
+    if (tile == keep || posts == ITK_NULLPTR)
+      {
+      continue;
+      }
+    if (tile->m_Referenced.Load() != 0)
+      {
+      tile->m_Referenced.Store(0);
+      continue;
+      }
+
+    tile->m_Posts.Store(ITK_NULLPTR);
+    RetiredPosts retired;
+    retired.m_Posts = posts;
+    retired.m_Epoch = 0;
+    retired.m_MemorySize = tile->GetMemorySize();
+    m_RetiredPosts.push_back(retired);
+    m_LoadedMemorySize -= retired.m_MemorySize;
+    m_RetiredMemorySize += retired.m_MemorySize;
+    }
+
+  if (m_RetiredPosts.size() > nbRetired)
+    {
+    // The threads starting to read from now on can not see the posts
+    // unpublished above
+    const itk::int64_t epoch = ++m_Epoch;
+    for (std::vector<RetiredPosts>::size_type i = nbRetired; i < m_RetiredPosts.size(); ++i)
+      {
+      m_RetiredPosts[i].m_Epoch = epoch;
+      }
+    }
+
+  this->ReleaseRetiredPosts(true);
+}
+
+void
+DEMTileCache
+::ReleaseRetiredPosts(bool wait) const
+{
+  // Raised before checking the readers, so that a thread stopping to read
+  // after the check wakes the eviction up
+  wait = wait && !m_RetiredPosts.empty();
+  if (wait)
+    {
+    ++m_NumberOfWaitingEvictions;
+    }
+
+  while (!m_RetiredPosts.empty())
+    {
+    // The posts are retired in increasing epochs
+    const itk::int64_t oldestEpoch = m_Readers->GetOldestEpoch();
+    std::vector<RetiredPosts>::iterator last = m_RetiredPosts.begin();
+    for (; last != m_RetiredPosts.end() && last->m_Epoch <= oldestEpoch; ++last)
+      {
+      delete[] last->m_Posts;
+      m_RetiredMemorySize -= last->m_MemorySize;
+      }
+    m_RetiredPosts.erase(m_RetiredPosts.begin(), last);
+
+    if (!wait || m_RetiredPosts.empty())
+      {
+      break;
+      }
+    m_ReadingStopped->Wait(&m_Mutex);
+    }
+
+  if (wait)
+    {
+    --m_NumberOfWaitingEvictions;
+    }
+}
+
+double
+DEMTileCache
+::Interpolate(const TileType * tile, const float * posts, double lon, double lat)
+{
+  const double fx = (lon - tile->m_OriginX) / tile->m_SpacingX;
+  const double fy = (lat - tile->m_OriginY) / tile->m_SpacingY;
+
+  const unsigned int x0 = std::min(static_cast<unsigned int>(std::max(fx, 0.)), tile->m_SizeX > 1 ? tile->m_SizeX - 2 : 0);
+  const unsigned int y0 = std::min(static_cast<unsigned int>(std::max(fy, 0.)), tile->m_SizeY > 1 ? tile->m_SizeY - 2 : 0);
+  const unsigned int x1 = std::min(x0 + 1, tile->m_SizeX - 1);
+  const unsigned int y1 = std::min(y0 + 1, tile->m_SizeY - 1);
+  const double u = std::min(std::max(fx - x0, 0.), 1.);
+  const double v = std::min(std::max(fy - y0, 0.), 1.);
+
+  const double values[4] = {posts[y0 * tile->m_SizeX + x0], posts[y0 * tile->m_SizeX + x1],
+                            posts[y1 * tile->m_SizeX + x0], posts[y1 * tile->m_SizeX + x1]};
+  const double weights[4] = {(1. - u) * (1. - v), u * (1. - v), (1. - u) * v, u * v};
+
+  // Posts with no data are left out, as in the OSSIM elevation handlers
+  double height = 0.;
+  double sumWeights = 0.;
+  for (unsigned int i = 0; i < 4; ++i)
+    {
+    if (!vnl_math_isnan(values[i]) && !(tile->m_HasNoData && values[i] == tile->m_NoData))
+      {
+      height += weights[i] * values[i];
+      sumWeights += weights[i];
+      }
+    }
+
+  if (sumWeights == 0.)
+    {
+    return std::numeric_limits<double>::quiet_NaN();
+    }
+  return height / sumWeights;
+}
+
+double
+DEMTileCache
+::GetHeightAboveMSL(double lon, double lat) const
+{
+  TileType * tile = this->FindTile(lon, lat);
+  if (tile == ITK_NULLPTR)
+    {
+    return std::numeric_limits<double>::quiet_NaN();
+    }
+
+  ReaderSlotType * slot = this->GetReaderSlot();
+  this->StartReading(slot);
+
+  double height = std::numeric_limits<double>::quiet_NaN();
+  const float * posts = this->GetPosts(tile, slot);
+  if (posts != ITK_NULLPTR)
+    {
+    height = Interpolate(tile, posts, lon, lat);
+    slot->m_Hits.Store(slot->m_Hits.Load() + 1);
+    }
+
+  this->StopReading(slot);
+  return height;
+}
+
+void
+DEMTileCache
+::GetHeightAboveMSL(const PointType * points, double * heights, unsigned long nbPoints) const
+{
+  ReaderSlotType * slot = this->GetReaderSlot();
+  this->StartReading(slot);
+
+  TileType *    currentTile = ITK_NULLPTR;
+  const float * posts = ITK_NULLPTR;
+  itk::int64_t  nbHits = 0;
+
+  for (unsigned long i = 0; i < nbPoints; ++i)
+    {
+    const double lon = points[i][0];
+    const double lat = points[i][1];
+
+    TileType * tile = (currentTile && currentTile->Contains(lon, lat)) ? currentTile : this->FindTile(lon, lat);
+    if (tile != currentTile)
+      {
+      posts = tile ? this->GetPosts(tile, slot) : ITK_NULLPTR;
+      currentTile = posts ? tile : ITK_NULLPTR;
+      }
+
+    if (currentTile == ITK_NULLPTR)
+      {
+      heights[i] = std::numeric_limits<double>::quiet_NaN();
+      continue;
+      }
+
+    heights[i] = Interpolate(currentTile, posts, lon, lat);
+    ++nbHits;
+    }
+
+  slot->m_Hits.Store(slot->m_Hits.Load() + nbHits);
+  this->StopReading(slot);
+}
+
+itk::SizeValueType
+DEMTileCache
+::GetNumberOfHits() const
+{
+  return m_Readers->GetNumberOfHits();
+}
+
+itk::SizeValueType
+DEMTileCache
+::GetNumberOfMisses() const
+{
+  itk::MutexLockHolder<itk::SimpleMutexLock> lock(m_Mutex);
+  return m_NumberOfMisses;
+}
+
+itk::SizeValueType
+DEMTileCache
+::GetMemorySize() const
+{
+  itk::MutexLockHolder<itk::SimpleMutexLock> lock(m_Mutex);
+  return m_LoadedMemorySize + m_RetiredMemorySize;
+}
+
+void
+DEMTileCache
+::ResetStatistics()
+{
+  m_Readers->ResetNumberOfHits();
+  itk::MutexLockHolder<itk::SimpleMutexLock> lock(m_Mutex);
+  m_NumberOfMisses = 0;
+}
+
+void
+DEMTileCache
+::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "NumberOfTiles: " << this->GetNumberOfTiles() << std::endl;
+  os << indent << "MaximumMemorySize: " << m_MaximumMemorySize << " MB" << std::endl;
+  os << indent << "MemorySize: " << this->GetMemorySize() << " bytes" << std::endl;
+  os << indent << "NumberOfHits: " << this->GetNumberOfHits() << std::endl;
+  os << indent << "NumberOfMisses: " << this->GetNumberOfMisses() << std::endl;
+}
+
+} // namespace otb
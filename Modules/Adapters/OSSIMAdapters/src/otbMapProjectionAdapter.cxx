@@ -22,6 +22,9 @@
 #include "otbMapProjectionAdapter.h"
 
 #include <cassert>
+#include <algorithm>
+#include <cmath>
+#include <vector>
 
 #include "otbMacro.h"
 #include "otbUtils.h"
@@ -46,6 +49,7 @@
 #include "ossim/projection/ossimEckert4Projection.h"
 #include "ossim/projection/ossimMollweidProjection.h"
 #include "ossim/projection/ossimSinusoidalProjection.h"
+#include "ossim/projection/ossimMercatorProjection.h"
 #include "ossim/support_data/ossimSpaceImagingGeom.h"
 #include "ossim/base/ossimKeywordNames.h"
 #pragma GCC diagnostic pop
@@ -65,18 +69,601 @@
 #include "ossim/projection/ossimEckert4Projection.h"
 #include "ossim/projection/ossimMollweidProjection.h"
 #include "ossim/projection/ossimSinusoidalProjection.h"
+#include "ossim/projection/ossimMercatorProjection.h"
 #include "ossim/support_data/ossimSpaceImagingGeom.h"
 #include "ossim/base/ossimKeywordNames.h"
 
 #endif
 
+namespace otb
+{
 
+namespace internal
+{
+/** \class MapProjectionKernel
+ * \brief Native batch implementation of a map projection
+ *
+ * Kernels reproduce the formulas of the corresponding OSSIM projections
+ * (which come from GeoTrans), on the ellipsoid of the projection and
+ * without datum shift. Points are processed by plain loops over
+ * contiguous arrays, without conversion to ossimGpt/ossimDpt, so that
+ * they can be vectorised by the compiler.
+ */
+class MapProjectionKernel
+{
+public:
+  virtual ~MapProjectionKernel() {}
+
+  /** Projection of nbPoints geographic coordinates, in degrees */
+  virtual void Forward(const double * lon, const double * lat,
+                       double * x, double * y, unsigned long nbPoints) const = 0;
+
+  /** Inverse projection of nbPoints map coordinates */
+  virtual void Inverse(const double * x, const double * y,
+                       double * lon, double * lat, unsigned long nbPoints) const = 0;
+
+  /** Geographic point around which the kernel is checked, in degrees */
+  virtual void GetCenter(double & lon, double & lat) const = 0;
+
+  /** Build the kernel of an OSSIM projection, if there is one and it
+   * reproduces OSSIM results around the center of the projection */
+  static MapProjectionKernel * Create(const ossimMapProjection * projection);
+
+protected:
+  /** Longitude difference wrapped to [-pi, pi] */
+  static double WrapLongitude(double dlam)
+  {
+    dlam = dlam > M_PI ? dlam - 2. * M_PI : dlam;
+    return dlam < -M_PI ? dlam + 2. * M_PI : dlam;
+  }
+
+private:
+  bool Validate(const ossimMapProjection * projection) const;
+};
+
+/** Transverse Mercator (and UTM), from the GeoTrans series */
+class TransverseMercatorKernel : public MapProjectionKernel
+{
+public:
+  TransverseMercatorKernel(double a, double f, double originLat, double originLon,
+                           double scaleFactor, double falseEasting, double falseNorthing)
+    : m_A(a), m_OriginLat(originLat), m_OriginLon(originLon), m_ScaleFactor(scaleFactor),
+      m_FalseEasting(falseEasting), m_FalseNorthing(falseNorthing)
+  {
+    m_Es = 2. * f - f * f;
+    m_Ebs = 1. / (1. - m_Es) - 1.;
+
+    // True meridional constants
+    const double b = a * (1. - f);
+    const double tn = (a - b) / (a + b);
+    const double tn2 = tn * tn;
+    const double tn3 = tn2 * tn;
+    const double tn4 = tn3 * tn;
+    const double tn5 = tn4 * tn;
+    m_Ap = a * (1. - tn + 5. * (tn2 - tn3) / 4. + 81. * (tn4 - tn5) / 64.);
+    m_Bp = 3. * a * (tn - tn2 + 7. * (tn3 - tn4) / 8. + 55. * tn5 / 64.) / 2.;
+    m_Cp = 15. * a * (tn2 - tn3 + 3. * (tn4 - tn5) / 4.) / 16.;
+    m_Dp = 35. * a * (tn3 - tn4 + 11. * tn5 / 16.) / 48.;
+    m_Ep = 315. * a * (tn4 - tn5) / 512.;
+
+    m_Tmdo = MeridionalDistance(originLat);
+  }
+
+  void Forward(const double * lon, const double * lat,
+               double * x, double * y, unsigned long nbPoints) const ITK_OVERRIDE
+  {
+    const double k = m_ScaleFactor;
+    for (unsigned long i = 0; i < nbPoints; ++i)
+      {
+      const double phi = lat[i] * M_PI / 180.;
+      double dlam = WrapLongitude(lon[i] * M_PI / 180. - m_OriginLon);
+      dlam = std::fabs(dlam) < 2.e-10 ? 0. : dlam;
+
+      const double s = std::sin(phi);
+      const double c = std::cos(phi);
+      const double c2 = c * c;
+      const double c3 = c2 * c;
+      const double c5 = c3 * c2;
+      const double c7 = c5 * c2;
+      const double t = std::tan(phi);
+      const double tan2 = t * t;
+      const double tan4 = tan2 * tan2;
+      const double tan6 = tan4 * tan2;
+      const double eta = m_Ebs * c2;
+      const double eta2 = eta * eta;
+      const double eta3 = eta2 * eta;
+      const double eta4 = eta3 * eta;
+
+      // Radius of curvature in prime vertical and true meridional distance
+      const double sn = m_A / std::sqrt(1. - m_Es * s * s);
+      const double tmd = MeridionalDistance(phi);
+
+      const double t1 = (tmd - m_Tmdo) * k;
+      const double t2 = sn * s * c * k / 2.;
+      const double t3 = sn * s * c3 * k * (5. - tan2 + 9. * eta + 4. * eta2) / 24.;
+      const double t4 = sn * s * c5 * k * (61. - 58. * tan2 + tan4 + 270. * eta - 330. * tan2 * eta
+                                           + 445. * eta2 + 324. * eta3 - 680. * tan2 * eta2 + 88. * eta4
+                                           - 600. * tan2 * eta3 - 192. * tan2 * eta4) / 720.;
+      const double t5 = sn * s * c7 * k * (1385. - 3111. * tan2 + 543. * tan4 - tan6) / 40320.;
+
+      const double t6 = sn * c * k;
+      const double t7 = sn * c3 * k * (1. - tan2 + eta) / 6.;
+      const double t8 = sn * c5 * k * (5. - 18. * tan2 + tan4 + 14. * eta - 58. * tan2 * eta + 13. * eta2
+                                       + 4. * eta3 - 64. * tan2 * eta2 - 24. * tan2 * eta3) / 120.;
+      const double t9 = sn * c7 * k * (61. - 479. * tan2 + 179. * tan4 - tan6) / 5040.;
+
+      const double dlam2 = dlam * dlam;
+      y[i] = m_FalseNorthing + t1 + dlam2 * (t2 + dlam2 * (t3 + dlam2 * (t4 + dlam2 * t5)));
+      x[i] = m_FalseEasting + dlam * (t6 + dlam2 * (t7 + dlam2 * (t8 + dlam2 * t9)));
+      }
+  }
+
+  void Inverse(const double * x, const double * y,
+               double * lon, double * lat, unsigned long nbPoints) const ITK_OVERRIDE
+  {
+    const double k = m_ScaleFactor;
+    const double k2 = k * k;
+    for (unsigned long i = 0; i < nbPoints; ++i)
+      {
+      // Footprint latitude, by fixed-point iterations on the meridional distance
+      const double tmd = m_Tmdo + (y[i] - m_FalseNorthing) / k;
+      double ftphi = tmd / MeridianRadius(0.);
+      for (unsigned int iteration = 0; iteration < 5; ++iteration)
+        {
+        ftphi += (tmd - MeridionalDistance(ftphi)) / MeridianRadius(std::sin(ftphi));
+        }
 
-namespace otb
+      const double s = std::sin(ftphi);
+      const double c = std::cos(ftphi);
+      const double sr = MeridianRadius(s);
+      const double sn = m_A / std::sqrt(1. - m_Es * s * s);
+      const double sn2 = sn * sn;
+      const double t = std::tan(ftphi);
+      const double tan2 = t * t;
+      const double tan4 = tan2 * tan2;
+      const double tan6 = tan4 * tan2;
+      const double eta = m_Ebs * c * c;
+      const double eta2 = eta * eta;
+      const double eta3 = eta2 * eta;
+      const double eta4 = eta3 * eta;
+
+      double de = x[i] - m_FalseEasting;
+      de = std::fabs(de) < 0.0001 ? 0. : de;
+      const double de2 = de * de;
+
+      // Latitude
+      const double t10 = t / (2. * sr * sn * k2);
+      const double t11 = t * (5. + 3. * tan2 + eta - 4. * eta2 - 9. * tan2 * eta)
+        / (24. * sr * sn2 * sn * k2 * k2);
+      const double t12 = t * (61. + 90. * tan2 + 46. * eta + 45. * tan4 - 252. * tan2 * eta - 3. * eta2
+                              + 100. * eta3 - 66. * tan2 * eta2 - 90. * tan4 * eta + 88. * eta4
+                              + 225. * tan4 * eta2 + 84. * tan2 * eta3 - 192. * tan2 * eta4)
+        / (720. * sr * sn2 * sn2 * sn * k2 * k2 * k2);
+      const double t13 = t * (1385. + 3633. * tan2 + 4095. * tan4 + 1575. * tan6)
+        / (40320. * sr * sn2 * sn2 * sn2 * sn * k2 * k2 * k2 * k2);
+      const double phi = ftphi + de2 * (-t10 + de2 * (t11 + de2 * (-t12 + de2 * t13)));
+
+      // Longitude
+      const double t14 = 1. / (sn * c * k);
+      const double t15 = (1. + 2. * tan2 + eta) / (6. * sn2 * sn * c * k2 * k);
+      const double t16 = (5. + 6. * eta + 28. * tan2 - 3. * eta2 + 8. * tan2 * eta + 24. * tan4
+                          - 4. * eta3 + 4. * tan2 * eta2 + 24. * tan2 * eta3)
+        / (120. * sn2 * sn2 * sn * c * k2 * k2 * k);
+      const double t17 = (61. + 662. * tan2 + 1320. * tan4 + 720. * tan6)
+        / (5040. * sn2 * sn2 * sn2 * sn * c * k2 * k2 * k2 * k);
+      const double dlam = de * (t14 + de2 * (-t15 + de2 * (t16 - de2 * t17)));
+
+      lat[i] = phi * 180. / M_PI;
+      lon[i] = WrapLongitude(m_OriginLon + dlam) * 180. / M_PI;
+      }
+  }
+
+  void GetCenter(double & lon, double & lat) const ITK_OVERRIDE
+  {
+    lon = m_OriginLon * 180. / M_PI;
+    lat = m_OriginLat * 180. / M_PI;
+  }
+
+private:
+  double MeridionalDistance(double phi) const
+  {
+    return m_Ap * phi - m_Bp * std::sin(2. * phi) + m_Cp * std::sin(4. * phi)
+      - m_Dp * std::sin(6. * phi) + m_Ep * std::sin(8. * phi);
+  }
+
+  double MeridianRadius(double s) const
+  {
+    const double denom = std::sqrt(1. - m_Es * s * s);
+    return m_A * (1. - m_Es) / (denom * denom * denom);
+  }
+
+  double m_A;
+  double m_OriginLat;
+  double m_OriginLon;
+  double m_ScaleFactor;
+  double m_FalseEasting;
+  double m_FalseNorthing;
+  double m_Es;
+  double m_Ebs;
+  double m_Ap;
+  double m_Bp;
+  double m_Cp;
+  double m_Dp;
+  double m_Ep;
+  double m_Tmdo;
+};
+
+/** Lambert conformal conic with one or two standard parallels */
+class LambertConformalConicKernel : public MapProjectionKernel
+{
+public:
+  LambertConformalConicKernel(double a, double f, double originLat, double originLon,
+                              double parallel1, double parallel2, double falseEasting, double falseNorthing)
+    : m_OriginLat(originLat), m_OriginLon(originLon), m_FalseEasting(falseEasting), m_FalseNorthing(falseNorthing)
+  {
+    m_E = std::sqrt(2. * f - f * f);
+
+    const double sin1 = std::sin(parallel1);
+    const double m1 = std::cos(parallel1) / std::sqrt(1. - m_E * m_E * sin1 * sin1);
+    const double t1 = T(parallel1, sin1);
+    if (std::fabs(parallel1 - parallel2) > 1.0e-10)
+      {
+      const double sin2 = std::sin(parallel2);
+      const double m2 = std::cos(parallel2) / std::sqrt(1. - m_E * m_E * sin2 * sin2);
+      const double t2 = T(parallel2, sin2);
+      m_N = std::log(m1 / m2) / std::log(t1 / t2);
+      }
+    else
+      {
+      m_N = sin1;
+      }
+
+    m_AF = a * m1 / (m_N * std::pow(t1, m_N));
+    const double t0 = T(originLat, std::sin(originLat));
+    m_Rho0 = (t0 == 0. && m_N < 0.) ? 0. : m_AF * std::pow(t0, m_N);
+  }
+
+  void Forward(const double * lon, const double * lat,
+               double * x, double * y, unsigned long nbPoints) const ITK_OVERRIDE
+  {
+    for (unsigned long i = 0; i < nbPoints; ++i)
+      {
+      const double phi = lat[i] * M_PI / 180.;
+      const double rho = std::fabs(std::fabs(phi) - M_PI / 2.) > 1.0e-10
+        ? m_AF * std::pow(T(phi, std::sin(phi)), m_N) : 0.;
+      const double theta = m_N * WrapLongitude(lon[i] * M_PI / 180. - m_OriginLon);
+
+      x[i] = rho * std::sin(theta) + m_FalseEasting;
+      y[i] = m_Rho0 - rho * std::cos(theta) + m_FalseNorthing;
+      }
+  }
+
+  void Inverse(const double * x, const double * y,
+               double * lon, double * lat, unsigned long nbPoints) const ITK_OVERRIDE
+  {
+    const double sign = m_N < 0. ? -1. : 1.;
+    for (unsigned long i = 0; i < nbPoints; ++i)
+      {
+      const double dx = sign * (x[i] - m_FalseEasting);
+      const double rho0MinusDy = sign * (m_Rho0 - (y[i] - m_FalseNorthing));
+      const double rho = sign * std::sqrt(dx * dx + rho0MinusDy * rho0MinusDy);
+
+      double phi, lambda;
+      if (rho != 0.)
+        {
+        const double theta = std::atan2(dx, rho0MinusDy);
+        const double t = std::pow(rho / m_AF, 1. / m_N);
+        phi = M_PI / 2. - 2. * std::atan(t);
+        double previous = 0.;
+        for (unsigned int iteration = 0; iteration < 30 && std::fabs(phi - previous) > 4.85e-10; ++iteration)
+          {
+          previous = phi;
+          const double esSin = m_E * std::sin(phi);
+          phi = M_PI / 2. - 2. * std::atan(t * std::pow((1. - esSin) / (1. + esSin), m_E / 2.));
+          }
+        lambda = theta / m_N + m_OriginLon;
+        }
+      else
+        {
+        phi = m_N > 0. ? M_PI / 2. : -M_PI / 2.;
+        lambda = m_OriginLon;
+        }
+
+      lat[i] = phi * 180. / M_PI;
+      lon[i] = WrapLongitude(lambda) * 180. / M_PI;
+      }
+  }
+
+  void GetCenter(double & lon, double & lat) const ITK_OVERRIDE
+  {
+    lon = m_OriginLon * 180. / M_PI;
+    lat = m_OriginLat * 180. / M_PI;
+  }
+
+private:
+  double T(double phi, double sinPhi) const
+  {
+    const double esSin = m_E * sinPhi;
+    return std::tan(M_PI / 4. - phi / 2.) / std::pow((1. - esSin) / (1. + esSin), m_E / 2.);
+  }
+
+  double m_OriginLat;
+  double m_OriginLon;
+  double m_FalseEasting;
+  double m_FalseNorthing;
+  double m_E;
+  double m_N;
+  double m_AF;
+  double m_Rho0;
+};
+
+/** Mercator, true to scale at the latitude of origin */
+class MercatorKernel : public MapProjectionKernel
+{
+public:
+  MercatorKernel(double a, double f, double originLat, double originLon,
+                 double falseEasting, double falseNorthing)
+    : m_OriginLat(originLat), m_OriginLon(originLon), m_FalseEasting(falseEasting), m_FalseNorthing(falseNorthing)
+  {
+    const double es2 = 2. * f - f * f;
+    const double es4 = es2 * es2;
+    const double es6 = es4 * es2;
+    const double es8 = es6 * es2;
+    m_E = std::sqrt(es2);
+
+    const double sinLat = std::sin(originLat);
+    m_AK = a * std::cos(originLat) / std::sqrt(1. - es2 * sinLat * sinLat);
+
+    // Series from the conformal latitude to the geodetic one
+    m_Ab = es2 / 2. + 5. * es4 / 24. + es6 / 12. + 13. * es8 / 360.;
+    m_Bb = 7. * es4 / 48. + 29. * es6 / 240. + 811. * es8 / 11520.;
+    m_Cb = 7. * es6 / 120. + 81. * es8 / 1120.;
+    m_Db = 4279. * es8 / 161280.;
+  }
+
+  void Forward(const double * lon, const double * lat,
+               double * x, double * y, unsigned long nbPoints) const ITK_OVERRIDE
+  {
+    for (unsigned long i = 0; i < nbPoints; ++i)
+      {
+      const double phi = lat[i] * M_PI / 180.;
+      const double esSin = m_E * std::sin(phi);
+      x[i] = m_AK * WrapLongitude(lon[i] * M_PI / 180. - m_OriginLon) + m_FalseEasting;
+      y[i] = m_AK * std::log(std::tan(M_PI / 4. + phi / 2.) * std::pow((1. - esSin) / (1. + esSin), m_E / 2.))
+        + m_FalseNorthing;
+      }
+  }
+
+  void Inverse(const double * x, const double * y,
+               double * lon, double * lat, unsigned long nbPoints) const ITK_OVERRIDE
+  {
+    for (unsigned long i = 0; i < nbPoints; ++i)
+      {
+      const double xphi = M_PI / 2. - 2. * std::atan(1. / std::exp((y[i] - m_FalseNorthing) / m_AK));
+      const double phi = xphi + m_Ab * std::sin(2. * xphi) + m_Bb * std::sin(4. * xphi)
+        + m_Cb * std::sin(6. * xphi) + m_Db * std::sin(8. * xphi);
+
+      lat[i] = phi * 180. / M_PI;
+      lon[i] = WrapLongitude(m_OriginLon + (x[i] - m_FalseEasting) / m_AK) * 180. / M_PI;
+      }
+  }
+
+  void GetCenter(double & lon, double & lat) const ITK_OVERRIDE
+  {
+    lon = m_OriginLon * 180. / M_PI;
+    lat = m_OriginLat * 180. / M_PI;
+  }
+
+private:
+  double m_OriginLat;
+  double m_OriginLon;
+  double m_FalseEasting;
+  double m_FalseNorthing;
+  double m_E;
+  double m_AK;
+  double m_Ab;
+  double m_Bb;
+  double m_Cb;
+  double m_Db;
+};
+
+/** Sinusoidal, on the ellipsoid */
+class SinusoidalKernel : public MapProjectionKernel
+{
+public:
+  SinusoidalKernel(double a, double f, double originLon, double falseEasting, double falseNorthing)
+    : m_A(a), m_OriginLon(originLon), m_FalseEasting(falseEasting), m_FalseNorthing(falseNorthing)
+  {
+    m_Es2 = 2. * f - f * f;
+    const double es4 = m_Es2 * m_Es2;
+    const double es6 = es4 * m_Es2;
+
+    m_C0 = 1. - m_Es2 / 4. - 3. * es4 / 64. - 5. * es6 / 256.;
+    m_C1 = 3. * m_Es2 / 8. + 3. * es4 / 32. + 45. * es6 / 1024.;
+    m_C2 = 15. * es4 / 256. + 45. * es6 / 1024.;
+    m_C3 = 35. * es6 / 3072.;
+
+    const double j = std::sqrt(1. - m_Es2);
+    const double e1 = (1. - j) / (1. + j);
+    const double e2 = e1 * e1;
+    const double e3 = e2 * e1;
+    const double e4 = e3 * e1;
+    m_A0 = 3. * e1 / 2. - 27. * e3 / 32.;
+    m_A1 = 21. * e2 / 16. - 55. * e4 / 32.;
+    m_A2 = 151. * e3 / 96.;
+    m_A3 = 1097. * e4 / 512.;
+  }
+
+  void Forward(const double * lon, const double * lat,
+               double * x, double * y, unsigned long nbPoints) const ITK_OVERRIDE
+  {
+    for (unsigned long i = 0; i < nbPoints; ++i)
+      {
+      const double phi = lat[i] * M_PI / 180.;
+      const double sinLat = std::sin(phi);
+      const double mm = std::sqrt(1. - m_Es2 * sinLat * sinLat);
+      const double meridional = m_A * (m_C0 * phi - m_C1 * std::sin(2. * phi) + m_C2 * std::sin(4. * phi)
+                                       - m_C3 * std::sin(6. * phi));
+
+      x[i] = m_A * WrapLongitude(lon[i] * M_PI / 180. - m_OriginLon) * std::cos(phi) / mm + m_FalseEasting;
+      y[i] = meridional + m_FalseNorthing;
+      }
+  }
+
+  void Inverse(const double * x, const double * y,
+               double * lon, double * lat, unsigned long nbPoints) const ITK_OVERRIDE
+  {
+    for (unsigned long i = 0; i < nbPoints; ++i)
+      {
+      const double mu = (y[i] - m_FalseNorthing) / (m_A * m_C0);
+      double phi = mu + m_A0 * std::sin(2. * mu) + m_A1 * std::sin(4. * mu)
+        + m_A2 * std::sin(6. * mu) + m_A3 * std::sin(8. * mu);
+      phi = std::max(-M_PI / 2., std::min(M_PI / 2., phi));
+
+      double lambda = m_OriginLon;
+      if (std::fabs(std::fabs(phi) - M_PI / 2.) > 1.0e-8)
+        {
+        const double sinLat = std::sin(phi);
+        const double mm = std::sqrt(1. - m_Es2 * sinLat * sinLat);
+        lambda += (x[i] - m_FalseEasting) * mm / (m_A * std::cos(phi));
+        }
+
+      lat[i] = phi * 180. / M_PI;
+      lon[i] = WrapLongitude(lambda) * 180. / M_PI;
+      }
+  }
+
+  void GetCenter(double & lon, double & lat) const ITK_OVERRIDE
+  {
+    lon = m_OriginLon * 180. / M_PI;
+    lat = 0.;
+  }
+
+private:
+  double m_A;
+  double m_OriginLon;
+  double m_FalseEasting;
+  double m_FalseNorthing;
+  double m_Es2;
+  double m_C0;
+  double m_C1;
+  double m_C2;
+  double m_C3;
+  double m_A0;
+  double m_A1;
+  double m_A2;
+  double m_A3;
+};
+
+MapProjectionKernel * MapProjectionKernel::Create(const ossimMapProjection * projection)
+{
+  if (projection == ITK_NULLPTR)
+    {
+    return ITK_NULLPTR;
+    }
+
+  const double a = projection->getA();
+  const double f = projection->getF();
+  const ossimGpt origin = projection->origin();
+  const double falseEasting = projection->getFalseEasting();
+  const double falseNorthing = projection->getFalseNorthing();
+
+  MapProjectionKernel * kernel = ITK_NULLPTR;
+
+  if (const ossimUtmProjection * utm = dynamic_cast<const ossimUtmProjection *>(projection))
+    {
+    const double centralMeridian = (6 * utm->getZone() - 183) * M_PI / 180.;
+    const double utmFalseNorthing = utm->getHemisphere() == 'S' ? 10000000. : 0.;
+    kernel = new TransverseMercatorKernel(a, f, 0., centralMeridian, 0.9996, 500000., utmFalseNorthing);
+    }
+  else if (const ossimTransMercatorProjection * tm = dynamic_cast<const ossimTransMercatorProjection *>(projection))
+    {
+    kernel = new TransverseMercatorKernel(a, f, origin.latr(), origin.lonr(), tm->getScaleFactor(),
+                                          falseEasting, falseNorthing);
+    }
+  else if (dynamic_cast<const ossimLambertConformalConicProjection *>(projection) != ITK_NULLPTR)
+    {
+    kernel = new LambertConformalConicKernel(a, f, origin.latr(), origin.lonr(),
+                                             projection->getStandardParallel1() * M_PI / 180.,
+                                             projection->getStandardParallel2() * M_PI / 180.,
+                                             falseEasting, falseNorthing);
+    }
+  else if (dynamic_cast<const ossimMercatorProjection *>(projection) != ITK_NULLPTR)
+    {
+    kernel = new MercatorKernel(a, f, origin.latr(), origin.lonr(), falseEasting, falseNorthing);
+    }
+  else if (dynamic_cast<const ossimSinusoidalProjection *>(projection) != ITK_NULLPTR)
+    {
+    kernel = new SinusoidalKernel(a, f, origin.lonr(), falseEasting, falseNorthing);
+    }
+
+  if (kernel != ITK_NULLPTR && !kernel->Validate(projection))
+    {
+    otbMsgDevMacro(<< "Native kernel of " << projection->getClassName() << " disabled: "
+                   << "it does not reproduce the OSSIM projection");
+    delete kernel;
+    kernel = ITK_NULLPTR;
+    }
+
+  return kernel;
+}
+
+bool MapProjectionKernel::Validate(const ossimMapProjection * projection) const
 {
+  // Maximum differences with OSSIM: 0.1 mm on map coordinates, about
+  // the same on geographic ones
+  const double mapTolerance = 1e-4;
+  const double geoTolerance = 1e-9;
+
+  // Points around the center of the projection. Datum shifts, units or
+  // parameters not handled by the kernel show up as differences.
+  double centerLon, centerLat;
+  this->GetCenter(centerLon, centerLat);
+
+  std::vector<double> lon, lat;
+  for (int i = -2; i <= 2; ++i)
+    {
+    for (int j = -2; j <= 2; ++j)
+      {
+      lon.push_back(centerLon + i);
+      lat.push_back(std::max(-80., std::min(80., centerLat + j)));
+      }
+    }
+
+  const unsigned long nbPoints = lon.size();
+  std::vector<double> x(nbPoints), y(nbPoints), refX(nbPoints), refY(nbPoints);
+  std::vector<double> invLon(nbPoints), invLat(nbPoints);
+
+  this->Forward(&lon[0], &lat[0], &x[0], &y[0], nbPoints);
+  for (unsigned long i = 0; i < nbPoints; ++i)
+    {
+    const ossimDpt ref = projection->forward(ossimGpt(lat[i], lon[i], 0.));
+    if (!(std::fabs(x[i] - ref.x) <= mapTolerance && std::fabs(y[i] - ref.y) <= mapTolerance))
+      {
+      return false;
+      }
+    refX[i] = ref.x;
+    refY[i] = ref.y;
+    }
+
+  this->Inverse(&refX[0], &refY[0], &invLon[0], &invLat[0], nbPoints);
+  for (unsigned long i = 0; i < nbPoints; ++i)
+    {
+    ossimGpt ref = projection->inverse(ossimDpt(refX[i], refY[i]));
+    ref.changeDatum(ossimDatumFactory::instance()->wgs84());
+    if (!(std::fabs(invLon[i] - ref.lon) <= geoTolerance && std::fabs(invLat[i] - ref.lat) <= geoTolerance))
+      {
+      return false;
+      }
+    }
+
+  return true;
+}
+
+} // namespace internal
 
 MapProjectionAdapter::MapProjectionAdapter():
-  m_MapProjection(ITK_NULLPTR), m_ProjectionRefWkt(""), m_ReinstanciateProjection(true)
+  m_MapProjection(ITK_NULLPTR), m_ProjectionRefWkt(""), m_ReinstanciateProjection(true), m_Kernel(ITK_NULLPTR)
 {
 }
 
@@ -86,6 +673,7 @@ MapProjectionAdapter::~MapProjectionAdapter()
     {
     delete m_MapProjection;
     }
+  delete m_Kernel;
 }
 
 MapProjectionAdapter::InternalMapProjectionPointer MapProjectionAdapter::GetMapProjection()
@@ -229,6 +817,9 @@ bool MapProjectionAdapter::InstantiateProjection()
 {
   if ((this->m_ReinstanciateProjection) || (m_MapProjection == ITK_NULLPTR))
     {
+    delete m_Kernel;
+    m_Kernel = ITK_NULLPTR;
+
     ossimKeywordlist      kwl;
     ossimOgcWktTranslator wktTranslator;
 
@@ -274,6 +865,7 @@ bool MapProjectionAdapter::InstantiateProjection()
 
     this->m_ReinstanciateProjection = false;
     this->ApplyParametersToProjection();
+    this->UpdateKernel();
     return true;
     }
   return false;
@@ -326,6 +918,82 @@ void MapProjectionAdapter::ForwardTransform(double lon, double lat, double h,
   z = h;
 }
 
+void MapProjectionAdapter::InverseTransformPoints(const double * x, const double * y, const double * z,
+                                                  double * lon, double * lat, double * h,
+                                                  unsigned long nbPoints)
+{
+  if (m_ReinstanciateProjection)
+    {
+    this->InstantiateProjection();
+    }
+
+  if (m_Kernel != ITK_NULLPTR)
+    {
+    m_Kernel->Inverse(x, y, lon, lat, nbPoints);
+    }
+  else
+    {
+    double height;
+    for (unsigned long i = 0; i < nbPoints; ++i)
+      {
+      this->InverseTransform(x[i], y[i], z ? z[i] : 0., lon[i], lat[i], height);
+      }
+    }
+
+  // Heights are not modified by map projections
+  if (h != ITK_NULLPTR && z != ITK_NULLPTR)
+    {
+    std::copy(z, z + nbPoints, h);
+    }
+  else if (h != ITK_NULLPTR)
+    {
+    std::fill(h, h + nbPoints, 0.);
+    }
+}
+
+void MapProjectionAdapter::ForwardTransformPoints(const double * lon, const double * lat, const double * h,
+                                                  double * x, double * y, double * z,
+                                                  unsigned long nbPoints)
+{
+  if (m_ReinstanciateProjection)
+    {
+    this->InstantiateProjection();
+    }
+
+  if (m_Kernel != ITK_NULLPTR)
+    {
+    m_Kernel->Forward(lon, lat, x, y, nbPoints);
+    }
+  else
+    {
+    double height;
+    for (unsigned long i = 0; i < nbPoints; ++i)
+      {
+      this->ForwardTransform(lon[i], lat[i], h ? h[i] : 0., x[i], y[i], height);
+      }
+    }
+
+  if (z != ITK_NULLPTR && h != ITK_NULLPTR)
+    {
+    std::copy(h, h + nbPoints, z);
+    }
+  else if (z != ITK_NULLPTR)
+    {
+    std::fill(z, z + nbPoints, 0.);
+    }
+}
+
+bool MapProjectionAdapter::HasNativeKernel() const
+{
+  return m_Kernel != ITK_NULLPTR;
+}
+
+void MapProjectionAdapter::UpdateKernel()
+{
+  delete m_Kernel;
+  m_Kernel = internal::MapProjectionKernel::Create(dynamic_cast<const ossimMapProjection*>(m_MapProjection));
+}
+
 void MapProjectionAdapter::ApplyParametersToProjection()
 {
   // Start by identifying the projection, that will be necessary for
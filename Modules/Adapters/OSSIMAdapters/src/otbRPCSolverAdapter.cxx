@@ -22,6 +22,14 @@
 #include "otbRPCSolverAdapter.h"
 #include "otbImageKeywordlist.h"
 #include "otbMacro.h"
+#include "itkMultiThreader.h"
+
+#include "vnl/vnl_matrix.h"
+#include "vnl/vnl_vector.h"
+#include "vnl/vnl_random.h"
+#include "vnl/algo/vnl_svd.h"
+
+#include <algorithm>
 
 #if defined(__GNUC__) || defined(__clang__)
 #pragma GCC diagnostic push
@@ -40,10 +48,464 @@
 #include "ossim/imaging/ossimImageGeometry.h"
 #endif
 
-
 namespace otb
 {
 
+namespace
+{
+
+/** Number of terms of a RPC polynomial */
+const unsigned int k_NbRPCTerms = 20;
+
+/** Terms of the RPC00B polynomials which do not depend on the height */
+const unsigned int k_PlanarTerms[10] = {0, 1, 2, 4, 7, 8, 11, 12, 14, 15};
+
+/** Maximum number of reweighting iterations of a fit */
+const unsigned int k_MaxReweightingIterations = 10;
+
+/** Largest change of a normalised coefficient to stop reweighting */
+const double k_ConvergenceThreshold = 1e-12;
+
+/** Seed of the first RANSAC draw */
+const unsigned long k_RansacSeed = 42;
+
+/** Maximum number of refinements of the RANSAC consensus set */
+const unsigned int k_MaxConsensusRefinements = 5;
+
+/** Check the number of GCPs, and return whether elevation can be estimated */
+bool CheckNumberOfGCPs(unsigned int nbPoints)
+{
+  // Check for enough points
+  if(nbPoints < 20)
+    {
+    itkGenericExceptionMacro(<<"At least 20 points are required to estimate the 40 parameters of a RPC model without elevation support, and 40 are required to estimate the 80 parameters of a RPC model with elevation support. Only "<<nbPoints<<" points were given.");
+    }
+
+  // If not enough points are given for a proper estimation of RPC
+  // with elevation support, disable elevation. This will result in
+  // all coefficients related to elevation set to zero.
+  if(nbPoints<40)
+    {
+    otbGenericWarningMacro("Only "<<nbPoints<<" ground control points are provided, can not estimate a RPC model with elevation support (at least 40 points required). Elevation support will be disabled for RPC estimation. All coefficients related to elevation will be set to zero, and elevation will have no effect on the resulting transform.");
+    return false;
+    }
+
+  // By default, use elevation provided with ground control points
+  return true;
+}
+
+/** Offset and scale mapping a coordinate to [-1, 1] */
+struct Normalisation
+{
+  Normalisation() : offset(0.), scale(1.) {}
+
+  void Estimate(const std::vector<double> & values)
+  {
+    const double minValue = *std::min_element(values.begin(), values.end());
+    const double maxValue = *std::max_element(values.begin(), values.end());
+    offset = 0.5 * (minValue + maxValue);
+    scale = 0.5 * (maxValue - minValue);
+    if (!(scale > 0.))
+      {
+      scale = 1.;
+      }
+  }
+
+  double operator()(double value) const
+  {
+    return (value - offset) / scale;
+  }
+
+  double offset;
+  double scale;
+};
+
+/** Numerators and denominators of both image axes, over the terms of the solver */
+struct RationalModel
+{
+  std::vector<double> lineNum;
+  std::vector<double> lineDen;
+  std::vector<double> sampNum;
+  std::vector<double> sampDen;
+};
+
+/** \class NativeRPCSolver
+ * \brief Normal equations solver of the RPC coefficients
+ *
+ * GCP coordinates are normalised and the polynomial terms of each GCP
+ * are computed once. Each image axis r = N(t) / D(t) is then fitted by
+ * solving the linearised system N(t) - r (D(t) - 1) = r, the constant
+ * term of D being 1, with weights 1 / D(t)^2 taken from the previous
+ * iteration (Tao & Hu, 2001).
+ */
+class NativeRPCSolver
+{
+public:
+  typedef std::vector<unsigned int> SubsetType;
+
+  NativeRPCSolver(const RPCSolverAdapter::GCPsContainerType & gcps, bool useElevation)
+  {
+    const unsigned int nbPoints = gcps.size();
+    std::vector<double> samp(nbPoints), line(nbPoints), lon(nbPoints), lat(nbPoints), hgt(nbPoints);
+    for (unsigned int i = 0; i < nbPoints; ++i)
+      {
+      samp[i] = internal::ConvertToOSSIMFrame(gcps[i].first[0]);
+      line[i] = internal::ConvertToOSSIMFrame(gcps[i].first[1]);
+      lon[i] = gcps[i].second[0];
+      lat[i] = gcps[i].second[1];
+      hgt[i] = gcps[i].second[2];
+      }
+
+    m_SampNormalisation.Estimate(samp);
+    m_LineNormalisation.Estimate(line);
+    m_LonNormalisation.Estimate(lon);
+    m_LatNormalisation.Estimate(lat);
+    m_HgtNormalisation.Estimate(hgt);
+
+    if (useElevation)
+      {
+      for (unsigned int k = 0; k < k_NbRPCTerms; ++k)
+        {
+        m_Terms.push_back(k);
+        }
+      }
+    else
+      {
+      m_Terms.assign(k_PlanarTerms, k_PlanarTerms + 10);
+      }
+    m_NbTerms = m_Terms.size();
+
+    m_TermValues.resize(nbPoints * m_NbTerms);
+    m_Samp.resize(nbPoints);
+    m_Line.resize(nbPoints);
+
+    double t[k_NbRPCTerms];
+    for (unsigned int i = 0; i < nbPoints; ++i)
+      {
+      const double L = m_LonNormalisation(lon[i]);
+      const double P = m_LatNormalisation(lat[i]);
+      const double H = m_HgtNormalisation(hgt[i]);
+      t[0] = 1.;
+      t[1] = L;
+      t[2] = P;
+      t[3] = H;
+      t[4] = L * P;
+      t[5] = L * H;
+      t[6] = P * H;
+      t[7] = L * L;
+      t[8] = P * P;
+      t[9] = H * H;
+      t[10] = P * L * H;
+      t[11] = L * L * L;
+      t[12] = L * P * P;
+      t[13] = L * H * H;
+      t[14] = L * L * P;
+      t[15] = P * P * P;
+      t[16] = P * H * H;
+      t[17] = L * L * H;
+      t[18] = P * P * H;
+      t[19] = H * H * H;
+
+      for (unsigned int k = 0; k < m_NbTerms; ++k)
+        {
+        m_TermValues[i * m_NbTerms + k] = t[m_Terms[k]];
+        }
+      m_Samp[i] = m_SampNormalisation(samp[i]);
+      m_Line[i] = m_LineNormalisation(line[i]);
+      }
+  }
+
+  unsigned int GetNumberOfPoints() const
+  {
+    return m_Line.size();
+  }
+
+  /** Number of unknowns of each axis, which is also the size of a minimal set */
+  unsigned int GetNumberOfUnknowns() const
+  {
+    return 2 * m_NbTerms - 1;
+  }
+
+  /** Fit both image axes over a subset of GCPs */
+  void Fit(const SubsetType & subset, RationalModel & model) const
+  {
+    this->FitAxis(m_Line, subset, model.lineNum, model.lineDen);
+    this->FitAxis(m_Samp, subset, model.sampNum, model.sampDen);
+  }
+
+  /** Image residual of a GCP, in pixels */
+  double Residual(const RationalModel & model, unsigned int i) const
+  {
+    const double * t = &m_TermValues[i * m_NbTerms];
+    const double dl = (Dot(model.lineNum, t) / Dot(model.lineDen, t) - m_Line[i]) * m_LineNormalisation.scale;
+    const double ds = (Dot(model.sampNum, t) / Dot(model.sampDen, t) - m_Samp[i]) * m_SampNormalisation.scale;
+    return vcl_sqrt(dl * dl + ds * ds);
+  }
+
+  /** Draw the rank-th random minimal set of GCPs */
+  void DrawMinimalSet(unsigned long rank, SubsetType & indices, SubsetType & sample) const
+  {
+    const unsigned int nbPoints = this->GetNumberOfPoints();
+    indices.resize(nbPoints);
+    for (unsigned int i = 0; i < nbPoints; ++i)
+      {
+      indices[i] = i;
+      }
+
+    // Partial Fisher-Yates shuffle
+    vnl_random random(k_RansacSeed + rank);
+    sample.resize(this->GetNumberOfUnknowns());
+    for (unsigned int k = 0; k < sample.size(); ++k)
+      {
+      const unsigned int j = random.lrand32(k, nbPoints - 1);
+      std::swap(indices[k], indices[j]);
+      sample[k] = indices[k];
+      }
+  }
+
+  /** Write the model as an ossimRpcProjection state */
+  void Export(const RationalModel & model, ossimKeywordlist & kwl) const
+  {
+    std::vector<double> lineNum(k_NbRPCTerms, 0.), lineDen(k_NbRPCTerms, 0.);
+    std::vector<double> sampNum(k_NbRPCTerms, 0.), sampDen(k_NbRPCTerms, 0.);
+    for (unsigned int k = 0; k < m_NbTerms; ++k)
+      {
+      lineNum[m_Terms[k]] = model.lineNum[k];
+      lineDen[m_Terms[k]] = model.lineDen[k];
+      sampNum[m_Terms[k]] = model.sampNum[k];
+      sampDen[m_Terms[k]] = model.sampDen[k];
+      }
+
+    ossimRefPtr<ossimRpcProjection> rpcProjection = new ossimRpcProjection;
+    rpcProjection->setAttributes(m_SampNormalisation.offset, m_LineNormalisation.offset,
+                                 m_SampNormalisation.scale, m_LineNormalisation.scale,
+                                 m_LatNormalisation.offset, m_LonNormalisation.offset, m_HgtNormalisation.offset,
+                                 m_LatNormalisation.scale, m_LonNormalisation.scale, m_HgtNormalisation.scale,
+                                 sampNum, sampDen, lineNum, lineDen);
+    rpcProjection->saveState(kwl);
+  }
+
+private:
+  double Dot(const std::vector<double> & coefficients, const double * t) const
+  {
+    double result = 0.;
+    for (unsigned int k = 0; k < m_NbTerms; ++k)
+      {
+      result += coefficients[k] * t[k];
+      }
+    return result;
+  }
+
+  void FitAxis(const std::vector<double> & target, const SubsetType & subset,
+               std::vector<double> & num, std::vector<double> & den) const
+  {
+    const unsigned int nbUnknowns = this->GetNumberOfUnknowns();
+
+    num.assign(m_NbTerms, 0.);
+    den.assign(m_NbTerms, 0.);
+    den[0] = 1.;
+
+    vnl_matrix<double> normal(nbUnknowns, nbUnknowns);
+    vnl_vector<double> rhs(nbUnknowns);
+    vnl_vector<double> scales(nbUnknowns);
+    std::vector<double> row(nbUnknowns);
+
+    for (unsigned int iteration = 0; iteration < k_MaxReweightingIterations; ++iteration)
+      {
+      normal.fill(0.);
+      rhs.fill(0.);
+
+      // Accumulate the upper part of the weighted normal equations
+      for (SubsetType::const_iterator it = subset.begin(); it != subset.end(); ++it)
+        {
+        const double * t = &m_TermValues[*it * m_NbTerms];
+        const double r = target[*it];
+        const double d = Dot(den, t);
+        const double w = d != 0. ? 1. / (d * d) : 0.;
+
+        for (unsigned int k = 0; k < m_NbTerms; ++k)
+          {
+          row[k] = t[k];
+          }
+        for (unsigned int k = 1; k < m_NbTerms; ++k)
+          {
+          row[m_NbTerms + k - 1] = -r * t[k];
+          }
+
+        for (unsigned int a = 0; a < nbUnknowns; ++a)
+          {
+          const double wa = w * row[a];
+          rhs[a] += wa * r;
+          for (unsigned int b = a; b < nbUnknowns; ++b)
+            {
+            normal(a, b) += wa * row[b];
+            }
+          }
+        }
+
+      // Equilibrate the system, since the normal matrix squares the
+      // condition number of the design matrix. Unknowns without any
+      // contribution (e.g. height terms over flat GCPs) are left to zero.
+      for (unsigned int a = 0; a < nbUnknowns; ++a)
+        {
+        scales[a] = normal(a, a) > 0. ? 1. / vcl_sqrt(normal(a, a)) : 0.;
+        }
+      for (unsigned int a = 0; a < nbUnknowns; ++a)
+        {
+        rhs[a] *= scales[a];
+        for (unsigned int b = a; b < nbUnknowns; ++b)
+          {
+          normal(a, b) *= scales[a] * scales[b];
+          normal(b, a) = normal(a, b);
+          }
+        }
+
+      vnl_svd<double> svd(normal);
+      svd.zero_out_relative(1e-14);
+      const vnl_vector<double> solution = svd.solve(rhs);
+
+      double change = 0.;
+      for (unsigned int k = 0; k < m_NbTerms; ++k)
+        {
+        const double value = solution[k] * scales[k];
+        change = std::max(change, vcl_abs(value - num[k]));
+        num[k] = value;
+        }
+      for (unsigned int k = 1; k < m_NbTerms; ++k)
+        {
+        const double value = solution[m_NbTerms + k - 1] * scales[m_NbTerms + k - 1];
+        change = std::max(change, vcl_abs(value - den[k]));
+        den[k] = value;
+        }
+
+      if (change < k_ConvergenceThreshold)
+        {
+        break;
+        }
+      }
+  }
+
+  Normalisation m_SampNormalisation;
+  Normalisation m_LineNormalisation;
+  Normalisation m_LonNormalisation;
+  Normalisation m_LatNormalisation;
+  Normalisation m_HgtNormalisation;
+
+  /** RPC00B indices of the estimated terms */
+  std::vector<unsigned int> m_Terms;
+  unsigned int              m_NbTerms;
+
+  /** Terms of each GCP, and its normalised image coordinates */
+  std::vector<double> m_TermValues;
+  std::vector<double> m_Samp;
+  std::vector<double> m_Line;
+};
+
+/** Internal structure used for passing data to the RANSAC threads */
+struct RansacStruct
+{
+  const NativeRPCSolver *   Solver;
+  double                    Threshold;
+  std::vector<unsigned int> NbInliers;
+  std::vector<double>       SumOfResiduals;
+};
+
+ITK_THREAD_RETURN_TYPE RansacThreaderCallback(void *arg)
+{
+  itk::MultiThreader::ThreadInfoStruct * info = static_cast<itk::MultiThreader::ThreadInfoStruct *>(arg);
+  RansacStruct * str = static_cast<RansacStruct *>(info->UserData);
+
+  const unsigned int nbPoints = str->Solver->GetNumberOfPoints();
+  NativeRPCSolver::SubsetType indices, sample;
+  RationalModel model;
+
+  for (unsigned int rank = info->ThreadID; rank < str->NbInliers.size(); rank += info->NumberOfThreads)
+    {
+    str->Solver->DrawMinimalSet(rank, indices, sample);
+    str->Solver->Fit(sample, model);
+
+    unsigned int nbInliers = 0;
+    double sum = 0.;
+    for (unsigned int i = 0; i < nbPoints; ++i)
+      {
+      const double residual = str->Solver->Residual(model, i);
+      if (residual <= str->Threshold)
+        {
+        ++nbInliers;
+        sum += residual;
+        }
+      }
+    str->NbInliers[rank] = nbInliers;
+    str->SumOfResiduals[rank] = sum;
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+/** Largest consensus set among nbIterations random minimal sets */
+void SelectConsensusSet(const NativeRPCSolver & solver, double threshold, unsigned int nbIterations,
+                        NativeRPCSolver::SubsetType & consensus)
+{
+  RansacStruct str;
+  str.Solver = &solver;
+  str.Threshold = threshold;
+  str.NbInliers.assign(nbIterations, 0);
+  str.SumOfResiduals.assign(nbIterations, 0.);
+
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  threader->SetNumberOfThreads(std::min<int>(nbIterations, itk::MultiThreader::GetGlobalDefaultNumberOfThreads()));
+  threader->SetSingleMethod(RansacThreaderCallback, &str);
+  threader->SingleMethodExecute();
+
+  // Reduce in the order of the draws, so that ties do not depend on threads
+  unsigned int best = 0;
+  for (unsigned int rank = 1; rank < nbIterations; ++rank)
+    {
+    if (str.NbInliers[rank] > str.NbInliers[best]
+        || (str.NbInliers[rank] == str.NbInliers[best] && str.SumOfResiduals[rank] < str.SumOfResiduals[best]))
+      {
+      best = rank;
+      }
+    }
+
+  NativeRPCSolver::SubsetType indices, sample;
+  RationalModel model;
+  solver.DrawMinimalSet(best, indices, sample);
+  solver.Fit(sample, model);
+
+  // Fits over minimal sets are unstable away from their points, so the
+  // consensus set is refined by fitting over it until it does not change
+  consensus.clear();
+  for (unsigned int refinement = 0; refinement <= k_MaxConsensusRefinements; ++refinement)
+    {
+    NativeRPCSolver::SubsetType refined;
+    for (unsigned int i = 0; i < solver.GetNumberOfPoints(); ++i)
+      {
+      if (solver.Residual(model, i) <= threshold)
+        {
+        refined.push_back(i);
+        }
+      }
+
+    if (refined == consensus || refined.size() < solver.GetNumberOfUnknowns())
+      {
+      break;
+      }
+    consensus.swap(refined);
+    solver.Fit(consensus, model);
+    }
+
+  if (consensus.empty())
+    {
+    consensus = sample;
+    }
+
+  otbGenericMsgDebugMacro(<<"RANSAC kept "<<consensus.size()<<" out of "<<solver.GetNumberOfPoints()
+                          <<" GCPs (draw "<<best<<" out of "<<nbIterations<<")");
+}
+
+} // end anonymous namespace
+
 RPCSolverAdapter::RPCSolverAdapter()
 {}
 
@@ -85,23 +547,7 @@ RPCSolverAdapter::Solve(const GCPsContainerType& gcpContainer,
     geoPoints.push_back(geoPoint);
     }
 
-  // Check for enough points
-  if(sensorPoints.size() < 20)
-    {
-    itkGenericExceptionMacro(<<"At least 20 points are required to estimate the 40 parameters of a RPC model without elevation support, and 40 are required to estimate the 80 parameters of a RPC model with elevation support. Only "<<sensorPoints.size()<<" points were given.");
-    }
-
-  // By default, use elevation provided with ground control points
-  bool useElevation = true;
-
-  // If not enough points are given for a proper estimation of RPC
-  // with elevation support, disable elevation. This will result in
-  // all coefficients related to elevation set to zero.
-  if(sensorPoints.size()<40)
-    {
-    otbGenericWarningMacro("Only "<<sensorPoints.size()<<" ground control points are provided, can not estimate a RPC model with elevation support (at least 40 points required). Elevation support will be disabled for RPC estimation. All coefficients related to elevation will be set to zero, and elevation will have no effect on the resulting transform.");
-    useElevation = false;
-    }
+  const bool useElevation = CheckNumberOfGCPs(sensorPoints.size());
 
   // Build the ossim rpc solver
   ossimRefPtr<ossimRpcSolver> rpcSolver = new ossimRpcSolver(useElevation, false);
@@ -139,4 +585,52 @@ bool RPCSolverAdapter::Solve(const GCPsContainerType& gcpContainer,
  }
 
 
+void
+RPCSolverAdapter::Solve(const GCPsContainerType& gcpContainer,
+                        double ransacThreshold,
+                        unsigned int ransacIterations,
+                        double& rmsError,
+                        InlierFlagsType& inliers,
+                        ImageKeywordlist& otb_kwl)
+{
+  const bool useElevation = CheckNumberOfGCPs(gcpContainer.size());
+
+  NativeRPCSolver solver(gcpContainer, useElevation);
+
+  // Select the GCPs used by the final fit
+  NativeRPCSolver::SubsetType subset;
+  if (ransacThreshold > 0. && ransacIterations > 0 && solver.GetNumberOfPoints() > solver.GetNumberOfUnknowns())
+    {
+    SelectConsensusSet(solver, ransacThreshold, ransacIterations, subset);
+    }
+  else
+    {
+    for (unsigned int i = 0; i < solver.GetNumberOfPoints(); ++i)
+      {
+      subset.push_back(i);
+      }
+    }
+
+  RationalModel model;
+  solver.Fit(subset, model);
+
+  // Image residual over the selected GCPs
+  inliers.assign(gcpContainer.size(), false);
+  double sum = 0.;
+  for (NativeRPCSolver::SubsetType::const_iterator it = subset.begin(); it != subset.end(); ++it)
+    {
+    inliers[*it] = true;
+    const double residual = solver.Residual(model, *it);
+    sum += residual * residual;
+    }
+  rmsError = vcl_sqrt(sum / subset.size());
+
+  // Export the sensor model in an ossimKeywordlist
+  ossimKeywordlist geom_kwl;
+  solver.Export(model, geom_kwl);
+
+  // Build an otb::ImageKeywordList
+  otb_kwl.SetKeywordlist(geom_kwl);
+}
+
 } // namespace otb
@@ -25,6 +25,7 @@
 
 #include "otbMacro.h"
 #include "otbImageKeywordlist.h"
+#include "vnl/vnl_math.h"
 
 #if defined(__GNUC__) || defined(__clang__)
 #pragma GCC diagnostic push
@@ -35,7 +36,9 @@
 #include "ossim/projection/ossimSensorModelFactory.h"
 #include "ossim/projection/ossimSensorModel.h"
 #include "ossim/projection/ossimRpcProjection.h"
+#include "ossim/projection/ossimRpcModel.h"
 #include "ossim/ossimPluginProjectionFactory.h"
+#include "ossim/ossimSarSensorModel.h"
 #include "ossim/base/ossimTieGptSet.h"
 
 #pragma GCC diagnostic pop
@@ -44,17 +47,147 @@
 #include "ossim/projection/ossimSensorModelFactory.h"
 #include "ossim/projection/ossimSensorModel.h"
 #include "ossim/projection/ossimRpcProjection.h"
+#include "ossim/projection/ossimRpcModel.h"
 #include "ossim/ossimPluginProjectionFactory.h"
+#include "ossim/ossimSarSensorModel.h"
 #include "ossim/base/ossimTieGptSet.h"
 
 #endif
 
+#include <algorithm>
+#include <vector>
+
 
 namespace otb
 {
 
+namespace internal
+{
+/** \class RPCEvaluator
+ * \brief Direct evaluation of the ground to image function of a RPC model
+ *
+ * The rational polynomials are evaluated by blocks of points, term by term,
+ * so that the inner loops run over contiguous arrays and can be vectorised
+ * by the compiler. Coefficients are stored in the RPC00B order.
+ */
+class RPCEvaluator
+{
+public:
+  /** Size of the blocks of points evaluated together */
+  static const unsigned int BlockSize = 64;
+
+  explicit RPCEvaluator(const ossimRpcModel::rpcModelStruct & rpc)
+  {
+    m_LineScale = rpc.lineScale;
+    m_SampScale = rpc.sampScale;
+    m_LatScale = rpc.latScale;
+    m_LonScale = rpc.lonScale;
+    m_HgtScale = rpc.hgtScale;
+    m_LineOffset = rpc.lineOffset;
+    m_SampOffset = rpc.sampOffset;
+    m_LatOffset = rpc.latOffset;
+    m_LonOffset = rpc.lonOffset;
+    m_HgtOffset = rpc.hgtOffset;
+
+    std::copy(rpc.lineNumCoef, rpc.lineNumCoef + 20, m_LineNumCoef);
+    std::copy(rpc.lineDenCoef, rpc.lineDenCoef + 20, m_LineDenCoef);
+    std::copy(rpc.sampNumCoef, rpc.sampNumCoef + 20, m_SampNumCoef);
+    std::copy(rpc.sampDenCoef, rpc.sampDenCoef + 20, m_SampDenCoef);
+
+    if (rpc.type == 'A')
+      {
+      // RPC00A stores LPH before the squared terms
+      ToTypeB(m_LineNumCoef);
+      ToTypeB(m_LineDenCoef);
+      ToTypeB(m_SampNumCoef);
+      ToTypeB(m_SampDenCoef);
+      }
+  }
+
+  /** Image coordinates (ossim frame) of nbPoints ground points */
+  void Evaluate(const double * lon, const double * lat, const double * hgt,
+                double * line, double * samp, unsigned long nbPoints) const
+  {
+    double terms[20][BlockSize];
+
+    for (unsigned long start = 0; start < nbPoints; start += BlockSize)
+      {
+      const unsigned int n = static_cast<unsigned int>(std::min<unsigned long>(BlockSize, nbPoints - start));
+
+      for (unsigned int i = 0; i < n; ++i)
+        {
+        const double L = (lon[start + i] - m_LonOffset) / m_LonScale;
+        const double P = (lat[start + i] - m_LatOffset) / m_LatScale;
+        const double H = (hgt[start + i] - m_HgtOffset) / m_HgtScale;
+        terms[0][i] = 1.;
+        terms[1][i] = L;
+        terms[2][i] = P;
+        terms[3][i] = H;
+        terms[4][i] = L * P;
+        terms[5][i] = L * H;
+        terms[6][i] = P * H;
+        terms[7][i] = L * L;
+        terms[8][i] = P * P;
+        terms[9][i] = H * H;
+        terms[10][i] = P * L * H;
+        terms[11][i] = L * L * L;
+        terms[12][i] = L * P * P;
+        terms[13][i] = L * H * H;
+        terms[14][i] = L * L * P;
+        terms[15][i] = P * P * P;
+        terms[16][i] = P * H * H;
+        terms[17][i] = L * L * H;
+        terms[18][i] = P * P * H;
+        terms[19][i] = H * H * H;
+        }
+
+      double lineNum[BlockSize], lineDen[BlockSize], sampNum[BlockSize], sampDen[BlockSize];
+      std::fill(lineNum, lineNum + n, 0.);
+      std::fill(lineDen, lineDen + n, 0.);
+      std::fill(sampNum, sampNum + n, 0.);
+      std::fill(sampDen, sampDen + n, 0.);
+
+      for (unsigned int k = 0; k < 20; ++k)
+        {
+        const double * term = terms[k];
+        for (unsigned int i = 0; i < n; ++i)
+          {
+          lineNum[i] += m_LineNumCoef[k] * term[i];
+          lineDen[i] += m_LineDenCoef[k] * term[i];
+          sampNum[i] += m_SampNumCoef[k] * term[i];
+          sampDen[i] += m_SampDenCoef[k] * term[i];
+          }
+        }
+
+      for (unsigned int i = 0; i < n; ++i)
+        {
+        line[start + i] = lineNum[i] / lineDen[i] * m_LineScale + m_LineOffset;
+        samp[start + i] = sampNum[i] / sampDen[i] * m_SampScale + m_SampOffset;
+        }
+      }
+  }
+
+private:
+  static void ToTypeB(double * coef)
+  {
+    const double lph = coef[7];
+    coef[7] = coef[8];
+    coef[8] = coef[9];
+    coef[9] = coef[10];
+    coef[10] = lph;
+  }
+
+  double m_LineScale, m_SampScale, m_LatScale, m_LonScale, m_HgtScale;
+  double m_LineOffset, m_SampOffset, m_LatOffset, m_LonOffset, m_HgtOffset;
+  double m_LineNumCoef[20];
+  double m_LineDenCoef[20];
+  double m_SampNumCoef[20];
+  double m_SampDenCoef[20];
+};
+} // namespace internal
+
 SensorModelAdapter::SensorModelAdapter():
-  m_SensorModel(ITK_NULLPTR), m_TiePoints(ITK_NULLPTR) // FIXME keeping the original value but...
+  m_SensorModel(ITK_NULLPTR), m_RPCEvaluator(ITK_NULLPTR), m_TiePoints(ITK_NULLPTR) // FIXME keeping the original value but...
 {
   m_DEMHandler = DEMHandler::Instance();
   m_TiePoints = new ossimTieGptSet();
@@ -63,9 +196,83 @@ SensorModelAdapter::SensorModelAdapter():
 SensorModelAdapter::~SensorModelAdapter()
 {
   delete m_SensorModel;
+  delete m_RPCEvaluator;
   delete m_TiePoints;
 }
 
+itk::LightObject::Pointer SensorModelAdapter::InternalClone() const
+{
+  Pointer clone = Self::New();
+
+  if (m_SensorModel != ITK_NULLPTR)
+    {
+    clone->m_SensorModel = dynamic_cast<ossimProjection *>(m_SensorModel->dup());
+    }
+  if (m_RPCEvaluator != ITK_NULLPTR)
+    {
+    clone->m_RPCEvaluator = new internal::RPCEvaluator(*m_RPCEvaluator);
+    }
+
+  itk::LightObject::Pointer result = clone.GetPointer();
+  return result;
+}
+
+void SensorModelAdapter::UpdateRPCEvaluator()
+{
+  delete m_RPCEvaluator;
+  m_RPCEvaluator = ITK_NULLPTR;
+
+  ossimRpcModel * rpcModel = dynamic_cast<ossimRpcModel *>(m_SensorModel);
+  if (rpcModel == ITK_NULLPTR)
+    {
+    return;
+    }
+
+  ossimRpcModel::rpcModelStruct rpc;
+  rpcModel->getRpcParameters(rpc);
+  if (rpc.type != 'A' && rpc.type != 'B')
+    {
+    return;
+    }
+
+  internal::RPCEvaluator * evaluator = new internal::RPCEvaluator(rpc);
+
+  // Adjustable parameters of the model (offsets, rotation) are not handled
+  // by the direct evaluation: check it against the model over its domain
+  // and keep the generic path if they differ.
+  const unsigned int nbSamples = 27;
+  double lon[nbSamples], lat[nbSamples], hgt[nbSamples], line[nbSamples], samp[nbSamples];
+  unsigned int k = 0;
+  for (int i = -1; i <= 1; ++i)
+    {
+    for (int j = -1; j <= 1; ++j)
+      {
+      for (int l = -1; l <= 1; ++l, ++k)
+        {
+        lon[k] = rpc.lonOffset + 0.5 * i * rpc.lonScale;
+        lat[k] = rpc.latOffset + 0.5 * j * rpc.latScale;
+        hgt[k] = rpc.hgtOffset + 0.5 * l * rpc.hgtScale;
+        }
+      }
+    }
+  evaluator->Evaluate(lon, lat, hgt, line, samp, nbSamples);
+
+  for (k = 0; k < nbSamples; ++k)
+    {
+    ossimGpt ossimGPoint(lat[k], lon[k], hgt[k]);
+    ossimDpt ossimDPoint;
+    m_SensorModel->worldToLineSample(ossimGPoint, ossimDPoint);
+    if (!(vcl_abs(ossimDPoint.x - samp[k]) < 1e-6 && vcl_abs(ossimDPoint.y - line[k]) < 1e-6))
+      {
+      otbMsgDevMacro(<< "Direct RPC evaluation disabled: model has adjustments");
+      delete evaluator;
+      return;
+      }
+    }
+
+  m_RPCEvaluator = evaluator;
+}
+
 void SensorModelAdapter::CreateProjection(const ImageKeywordlist& image_kwl)
 {
   ossimKeywordlist geom;
@@ -79,6 +286,8 @@ void SensorModelAdapter::CreateProjection(const ImageKeywordlist& image_kwl)
     {
     m_SensorModel = ossimplugins::ossimPluginProjectionFactory::instance()->createProjection(geom);
     }
+
+  this->UpdateRPCEvaluator();
 }
 
 bool SensorModelAdapter::IsValidSensorModel() const
@@ -166,6 +375,116 @@ void SensorModelAdapter::InverseTransformPoint(double lon, double lat,
   z = ossimGPoint.height();
 }
 
+void SensorModelAdapter::ForwardTransformPoints(const double * x, const double * y, const double * z,
+                                                double * lon, double * lat, double * h,
+                                                unsigned long nbPoints) const
+{
+  if (this->m_SensorModel == ITK_NULLPTR)
+    {
+    itkExceptionMacro(<< "ForwardTransformPoints(): Invalid sensor model (m_SensorModel pointer is null)");
+    }
+
+  // SAR models locate a whole batch at once
+  const ossimplugins::ossimSarSensorModel * sarModel
+    = dynamic_cast<const ossimplugins::ossimSarSensorModel *>(this->m_SensorModel);
+  if (sarModel != ITK_NULLPTR && nbPoints > 0)
+    {
+    std::vector<ossimDpt> ossimPoints(nbPoints);
+    std::vector<ossimGpt> ossimGPoints(nbPoints);
+    for (unsigned long i = 0; i < nbPoints; ++i)
+      {
+      ossimPoints[i].x = internal::ConvertToOSSIMFrame(x[i]);
+      ossimPoints[i].y = internal::ConvertToOSSIMFrame(y[i]);
+      }
+
+    sarModel->lineSampleHeightToWorld(&ossimPoints[0], z, &ossimGPoints[0], nbPoints);
+
+    for (unsigned long i = 0; i < nbPoints; ++i)
+      {
+      lon[i] = ossimGPoints[i].lon;
+      lat[i] = ossimGPoints[i].lat;
+      h[i] = ossimGPoints[i].hgt;
+      }
+    return;
+    }
+
+  ossimDpt ossimPoint;
+  ossimGpt ossimGPoint;
+
+  for (unsigned long i = 0; i < nbPoints; ++i)
+    {
+    ossimPoint.x = internal::ConvertToOSSIMFrame(x[i]);
+    ossimPoint.y = internal::ConvertToOSSIMFrame(y[i]);
+
+    if (z != ITK_NULLPTR)
+      {
+      this->m_SensorModel->lineSampleHeightToWorld(ossimPoint, z[i], ossimGPoint);
+      }
+    else
+      {
+      this->m_SensorModel->lineSampleToWorld(ossimPoint, ossimGPoint);
+      }
+
+    lon[i] = ossimGPoint.lon;
+    lat[i] = ossimGPoint.lat;
+    h[i] = ossimGPoint.hgt;
+    }
+}
+
+void SensorModelAdapter::InverseTransformPoints(const double * lon, const double * lat, const double * h,
+                                                double * x, double * y, double * z,
+                                                unsigned long nbPoints) const
+{
+  if (this->m_SensorModel == ITK_NULLPTR)
+    {
+    itkExceptionMacro(<< "InverseTransformPoints(): Invalid sensor model (m_SensorModel pointer is null)");
+    }
+
+  // Heights are needed by both paths, and are returned in z
+  for (unsigned long i = 0; i < nbPoints; ++i)
+    {
+    z[i] = (h != ITK_NULLPTR) ? h[i] : m_DEMHandler->GetHeightAboveEllipsoid(lon[i], lat[i]);
+    }
+
+  if (m_RPCEvaluator != ITK_NULLPTR)
+    {
+    // Line and sample are computed in place of y and x
+    m_RPCEvaluator->Evaluate(lon, lat, z, y, x, nbPoints);
+
+    for (unsigned long i = 0; i < nbPoints; ++i)
+      {
+      if (vnl_math_isnan(z[i]))
+        {
+        // Let the model handle missing heights
+        ossimGpt ossimGPoint(lat[i], lon[i], z[i]);
+        ossimDpt ossimDPoint;
+        this->m_SensorModel->worldToLineSample(ossimGPoint, ossimDPoint);
+        x[i] = ossimDPoint.x;
+        y[i] = ossimDPoint.y;
+        }
+      x[i] = internal::ConvertFromOSSIMFrame(x[i]);
+      y[i] = internal::ConvertFromOSSIMFrame(y[i]);
+      }
+    return;
+    }
+
+  ossimGpt ossimGPoint;
+  ossimDpt ossimDPoint;
+
+  for (unsigned long i = 0; i < nbPoints; ++i)
+    {
+    ossimGPoint.lat = lat[i];
+    ossimGPoint.lon = lon[i];
+    ossimGPoint.hgt = z[i];
+
+    this->m_SensorModel->worldToLineSample(ossimGPoint, ossimDPoint);
+
+    x[i] = internal::ConvertFromOSSIMFrame(ossimDPoint.x);
+    y[i] = internal::ConvertFromOSSIMFrame(ossimDPoint.y);
+    z[i] = ossimGPoint.height();
+    }
+}
+
 void SensorModelAdapter::AddTiePoint(double x, double y, double z, double lon, double lat)
 {
   // Create the tie point
@@ -224,6 +543,8 @@ double SensorModelAdapter::Optimize()
       // Call optimize fit
       precision  = simpleRpcModel->optimizeFit(*m_TiePoints);
       }
+
+    this->UpdateRPCEvaluator();
     }
 
   // Return the precision
@@ -243,6 +564,8 @@ bool SensorModelAdapter::ReadGeomFile(const std::string & infile)
     m_SensorModel = ossimplugins::ossimPluginProjectionFactory::instance()->createProjection(geom);
     }
 
+  this->UpdateRPCEvaluator();
+
   // otbMsgDevMacro(<< "ReadGeomFile("<<geom<<") -> " << m_SensorModel);
   return (m_SensorModel != ITK_NULLPTR);
 }
@@ -0,0 +1,155 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "itkMacro.h"
+#include "itkMultiThreader.h"
+#include "otbDEMHandler.h"
+
+#include <vector>
+#include <algorithm>
+
+typedef otb::DEMHandler::PointType PointType;
+
+namespace
+{
+struct ThreadData
+{
+  const std::vector<PointType> * points;
+  std::vector<std::vector<double> > heights;
+};
+
+// Each thread queries all the points, in batch
+ITK_THREAD_RETURN_TYPE QueryHeights(void * arg)
+{
+  itk::MultiThreader::ThreadInfoStruct * info = static_cast<itk::MultiThreader::ThreadInfoStruct *>(arg);
+  ThreadData * data = static_cast<ThreadData *>(info->UserData);
+  const std::vector<PointType> & points = *data->points;
+  std::vector<double> & heights = data->heights[info->ThreadID];
+
+  heights.resize(points.size());
+  otb::DEMHandler::Instance()->GetHeightAboveEllipsoid(&points[0], &heights[0], points.size());
+  return ITK_THREAD_RETURN_VALUE;
+}
+}
+
+int otbDEMHandlerCacheTest(int argc, char * argv[])
+{
+  if(argc!=9)
+    {
+    std::cerr<<"Usage: "<<argv[0]<<" demdir geoid[path|no] lonMin latMin lonMax latMax cacheSize tolerance"<<std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const std::string geoid = argv[2];
+  const double lonMin = atof(argv[3]);
+  const double latMin = atof(argv[4]);
+  const double lonMax = atof(argv[5]);
+  const double latMax = atof(argv[6]);
+  const unsigned int cacheSize = atoi(argv[7]);
+  const double tolerance = atof(argv[8]);
+
+  otb::DEMHandler::Pointer demHandler = otb::DEMHandler::Instance();
+  demHandler->OpenDEMDirectory(argv[1]);
+  if(geoid != "no")
+    {
+    demHandler->OpenGeoidFile(geoid);
+    }
+
+  // Grid of points, scanned line by line over the area
+  std::vector<PointType> points;
+  for(unsigned int j = 0; j < 50; ++j)
+    {
+    for(unsigned int i = 0; i < 50; ++i)
+      {
+      PointType point;
+      point[0] = lonMin + (lonMax - lonMin) * i / 49.;
+      point[1] = latMin + (latMax - latMin) * j / 49.;
+      points.push_back(point);
+      }
+    }
+
+  // Reference heights through the ossimElevManager
+  demHandler->SetDEMCacheSize(0);
+  std::vector<double> refEllipsoid(points.size()), refMSL(points.size());
+  for(unsigned int i = 0; i < points.size(); ++i)
+    {
+    refEllipsoid[i] = demHandler->GetHeightAboveEllipsoid(points[i]);
+    refMSL[i] = demHandler->GetHeightAboveMSL(points[i]);
+    }
+
+  demHandler->SetDEMCacheSize(cacheSize);
+  if(!demHandler->IsDEMCacheActive())
+    {
+    std::cerr<<"DEM cache is not active on "<<argv[1]<<std::endl;
+    return EXIT_FAILURE;
+    }
+
+  unsigned int nbErrors = 0;
+  double maxError = 0.;
+
+  // Point by point queries
+  for(unsigned int i = 0; i < points.size(); ++i)
+    {
+    const double ellipsoid = demHandler->GetHeightAboveEllipsoid(points[i]);
+    const double msl = demHandler->GetHeightAboveMSL(points[i]);
+    const double error = std::max(vcl_abs(ellipsoid - refEllipsoid[i]), vcl_abs(msl - refMSL[i]));
+    maxError = std::max(maxError, error);
+    if(!(error <= tolerance))
+      {
+      std::cerr<<points[i]<<": "<<ellipsoid<<" / "<<msl<<" instead of "
+               <<refEllipsoid[i]<<" / "<<refMSL[i]<<std::endl;
+      ++nbErrors;
+      }
+    }
+
+  // Concurrent batch queries give the same heights
+  ThreadData data;
+  data.points = &points;
+  data.heights.resize(4);
+
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  threader->SetNumberOfThreads(4);
+  threader->SetSingleMethod(QueryHeights, &data);
+  threader->SingleMethodExecute();
+
+  for(unsigned int t = 0; t < data.heights.size(); ++t)
+    {
+    for(unsigned int i = 0; i < data.heights[t].size(); ++i)
+      {
+      if(data.heights[t][i] != demHandler->GetHeightAboveEllipsoid(points[i]))
+        {
+        ++nbErrors;
+        }
+      }
+    }
+
+  std::cout<<demHandler<<std::endl;
+  std::cout<<"Maximum error: "<<maxError<<" meters"<<std::endl;
+
+  if(demHandler->GetDEMCache()->GetNumberOfHits() == 0)
+    {
+    std::cerr<<"No hit in the DEM cache"<<std::endl;
+    ++nbErrors;
+    }
+
+  demHandler->SetDEMCacheSize(0);
+
+  return nbErrors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "otbMapProjectionAdapter.h"
+
+namespace
+{
+typedef std::map<std::string, std::string> ParametersType;
+
+// Compare the batch transforms of a projection with the point-wise ones,
+// over a grid of lonRange x latRange degrees around (lon0, lat0)
+bool CheckBatchTransform(const std::string& name, const std::string& projection,
+                         const ParametersType& parameters,
+                         double lon0, double lat0, double lonRange, double latRange)
+{
+  // Sub-millimetre agreement with OSSIM
+  const double tolerance = 1e-3;
+  const double metersPerDegree = 111320.;
+  const unsigned int gridSize = 21;
+
+  otb::MapProjectionAdapter::Pointer adapter = otb::MapProjectionAdapter::New();
+  adapter->SetWkt(projection);
+  for (ParametersType::const_iterator it = parameters.begin(); it != parameters.end(); ++it)
+    {
+    adapter->SetParameter(it->first, it->second);
+    }
+
+  if (!adapter->HasNativeKernel())
+    {
+    std::cerr << name << ": no native kernel" << std::endl;
+    return false;
+    }
+
+  std::vector<double> lon, lat, h;
+  for (unsigned int i = 0; i < gridSize; ++i)
+    {
+    for (unsigned int j = 0; j < gridSize; ++j)
+      {
+      lon.push_back(lon0 + lonRange * (i / (gridSize - 1.) - 0.5));
+      lat.push_back(lat0 + latRange * (j / (gridSize - 1.) - 0.5));
+      h.push_back(10. * j);
+      }
+    }
+
+  const unsigned long nbPoints = lon.size();
+  std::vector<double> x(nbPoints), y(nbPoints), z(nbPoints);
+  std::vector<double> invLon(nbPoints), invLat(nbPoints), invH(nbPoints);
+
+  adapter->ForwardTransformPoints(&lon[0], &lat[0], &h[0], &x[0], &y[0], &z[0], nbPoints);
+  adapter->InverseTransformPoints(&x[0], &y[0], &z[0], &invLon[0], &invLat[0], &invH[0], nbPoints);
+
+  double maxForwardError = 0.;
+  double maxInverseError = 0.;
+  for (unsigned long i = 0; i < nbPoints; ++i)
+    {
+    double refX, refY, refZ;
+    adapter->ForwardTransform(lon[i], lat[i], h[i], refX, refY, refZ);
+    maxForwardError = std::max(maxForwardError, std::max(vcl_abs(x[i] - refX), vcl_abs(y[i] - refY)));
+
+    double refLon, refLat, refH;
+    adapter->InverseTransform(x[i], y[i], z[i], refLon, refLat, refH);
+    const double errorLon = vcl_abs(invLon[i] - refLon) * metersPerDegree * std::cos(refLat * M_PI / 180.);
+    const double errorLat = vcl_abs(invLat[i] - refLat) * metersPerDegree;
+    maxInverseError = std::max(maxInverseError, std::max(errorLon, errorLat));
+
+    if (z[i] != h[i] || invH[i] != h[i])
+      {
+      std::cerr << name << ": heights are not preserved" << std::endl;
+      return false;
+      }
+    }
+
+  std::cout << name << ": max forward error " << maxForwardError << " m, max inverse error "
+            << maxInverseError << " m" << std::endl;
+
+  return maxForwardError < tolerance && maxInverseError < tolerance;
+}
+}
+
+int otbMapProjectionAdapterBatchTest(int itkNotUsed(argc), char* itkNotUsed(argv)[])
+{
+  bool success = true;
+
+  {
+  ParametersType parameters;
+  parameters["Zone"] = "31";
+  parameters["Hemisphere"] = "N";
+  success &= CheckBatchTransform("UTM 31N", "Utm", parameters, 3., 43.6, 6., 4.);
+  }
+
+  {
+  ParametersType parameters;
+  parameters["Zone"] = "46";
+  parameters["Hemisphere"] = "S";
+  success &= CheckBatchTransform("UTM 46S", "Utm", parameters, 93., -35., 6., 4.);
+  }
+
+  {
+  std::string projectionRefWkt =
+    "PROJCS[\"UTM Zone 31, Northern Hemisphere\", GEOGCS[\"WGS 84\", DATUM[\"WGS_1984\", SPHEROID[\"WGS 84\", 6378137, 298.257223563, AUTHORITY[\"EPSG\",\"7030\"]], TOWGS84[0, 0, 0, 0, 0, 0, 0], AUTHORITY[\"EPSG\",\"6326\"]], PRIMEM[\"Greenwich\", 0, AUTHORITY[\"EPSG\",\"8901\"]], UNIT[\"degree\", 0.0174532925199433, AUTHORITY[\"EPSG\",\"9108\"]], AXIS[\"Lat\", NORTH], AXIS[\"Long\", EAST], AUTHORITY[\"EPSG\",\"4326\"]], PROJECTION[\"Transverse_Mercator\"], PARAMETER[\"latitude_of_origin\", 0], PARAMETER[\"central_meridian\", 3], PARAMETER[\"scale_factor\", 0.9996], PARAMETER[\"false_easting\", 500000], PARAMETER[\"false_northing\", 0], UNIT[\"Meter\", 1]]";
+  success &= CheckBatchTransform("UTM 31N from WKT", projectionRefWkt, ParametersType(), 1.44, 43.605, 6., 4.);
+  }
+
+  {
+  // Lambert 93 parameters
+  ParametersType parameters;
+  parameters["OriginX"] = "3";
+  parameters["OriginY"] = "46.5";
+  parameters["Datum"] = "WE";
+  parameters["FalseNorthing"] = "6600000";
+  parameters["FalseEasting"] = "700000";
+  parameters["StandardParallel1"] = "44";
+  parameters["StandardParallel2"] = "49";
+  success &= CheckBatchTransform("Lambert 93", "LambertConformalConic", parameters, 3., 46.5, 10., 8.);
+  }
+
+  {
+  // SVY21 parameters
+  ParametersType parameters;
+  parameters["OriginX"] = "103.83333333333333";
+  parameters["OriginY"] = "1.3666666666666667";
+  parameters["Datum"] = "WE";
+  parameters["FalseNorthing"] = "38744.572";
+  parameters["FalseEasting"] = "28001.642";
+  parameters["ScaleFactor"] = "1.00";
+  success &= CheckBatchTransform("Transverse Mercator", "TransMercator", parameters, 103.8, 1.35, 1., 1.);
+  }
+
+  success &= CheckBatchTransform("Mercator", "Mercator", ParametersType(), 0., 0., 20., 120.);
+
+  success &= CheckBatchTransform("Sinusoidal", "Sinusoidal", ParametersType(), 0., 0., 60., 120.);
+
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -25,6 +25,7 @@ void RegisterTests()
   REGISTER_TEST(otbTestImageKeywordlist);
   REGISTER_TEST(otbOssimJpegFileResourceLeakTest);
   REGISTER_TEST(otbMapProjectionAdapterTest);
+  REGISTER_TEST(otbMapProjectionAdapterBatchTest);
   REGISTER_TEST(otbOssimElevManagerTest2);
   REGISTER_TEST(otbOssimElevManagerTest4);
   REGISTER_TEST(otbGeometricSarSensorModelAdapterNewTest);
@@ -32,5 +33,7 @@ void RegisterTests()
   REGISTER_TEST(otbPlatformPositionComputeBaselineNewTest);
   REGISTER_TEST(otbPlatformPositionComputeBaselineTest);
   REGISTER_TEST(otbDEMHandlerTest);
+  REGISTER_TEST(otbDEMHandlerCacheTest);
   REGISTER_TEST(otbRPCSolverAdapterTest);
+  REGISTER_TEST(otbRPCSolverAdapterNativeTest);
 }
@@ -0,0 +1,199 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbMacro.h"
+#include "otbImage.h"
+#include "otbImageFileReader.h"
+#include "otbGenericRSTransform.h"
+#include "otbGeographicalDistance.h"
+#include "itkEuclideanDistanceMetric.h"
+#include "otbRPCSolverAdapter.h"
+#include "otbDEMHandler.h"
+
+#include <algorithm>
+
+typedef otb::Image<double>                     ImageType;
+typedef otb::ImageFileReader<ImageType>        ReaderType;
+typedef otb::GenericRSTransform<>              RSTranformType;
+typedef otb::GenericRSTransform<double,3,3>    RSTranform3dType;
+typedef otb::RPCSolverAdapter::Point2DType     Point2DType;
+typedef otb::RPCSolverAdapter::Point3DType     Point3DType;
+typedef otb::RPCSolverAdapter::GCPsContainerType GCPsContainerType;
+typedef itk::Statistics::EuclideanDistanceMetric<Point2DType> EuclideanDistanceMetricType;
+typedef otb::GeographicalDistance<Point2DType> GeoDistanceType;
+
+namespace
+{
+// Check the forward and inverse precision of an estimated model over
+// the GCPs flagged in checked, and return the number of imprecise GCPs
+unsigned int CheckModel(const otb::ImageKeywordlist & rpcKwl, const GCPsContainerType & gcps,
+                        const std::vector<bool> & checked, double geoTol, double imgTol)
+{
+  RSTranform3dType::Pointer rpcFwdTransform = RSTranform3dType::New();
+  rpcFwdTransform->SetInputKeywordList(rpcKwl);
+  rpcFwdTransform->InstantiateTransform();
+  RSTranformType::Pointer rpcInvTransform = RSTranformType::New();
+  rpcInvTransform->SetOutputKeywordList(rpcKwl);
+  rpcInvTransform->InstantiateTransform();
+
+  EuclideanDistanceMetricType::Pointer euclideanDistanceMetric = EuclideanDistanceMetricType::New();
+  GeoDistanceType::Pointer geoDistance = GeoDistanceType::New();
+
+  unsigned int nbErrors = 0;
+  for (unsigned int i = 0; i < gcps.size(); ++i)
+    {
+    if (!checked[i])
+      {
+      continue;
+      }
+
+    Point2DType groundPoint, groundPoint2dRef;
+    groundPoint2dRef[0] = gcps[i].second[0];
+    groundPoint2dRef[1] = gcps[i].second[1];
+
+    Point3DType imgPoint3D;
+    imgPoint3D[0] = gcps[i].first[0];
+    imgPoint3D[1] = gcps[i].first[1];
+    imgPoint3D[2] = gcps[i].second[2];
+
+    Point3DType groundPoint3D = rpcFwdTransform->TransformPoint(imgPoint3D);
+    groundPoint[0] = groundPoint3D[0];
+    groundPoint[1] = groundPoint3D[1];
+
+    const double groundRes = geoDistance->Evaluate(groundPoint, groundPoint2dRef);
+    const double imgRes = euclideanDistanceMetric->Evaluate(rpcInvTransform->TransformPoint(groundPoint2dRef), gcps[i].first);
+
+    if (groundRes > geoTol || imgRes > imgTol)
+      {
+      std::cerr << "Imprecise result at GCP " << gcps[i].first << ": " << groundRes << " meters, "
+                << imgRes << " pixels" << std::endl;
+      ++nbErrors;
+      }
+    }
+  return nbErrors;
+}
+}
+
+int otbRPCSolverAdapterNativeTest(int argc, char* argv[])
+{
+  if (argc != 8)
+    {
+    std::cout << "Usage: test_driver input grid_size geo_tol img_tol dem_dir geoid ransac_threshold" << std::endl;
+    return EXIT_FAILURE;
+    }
+  // This test takes a sensor model, uses it to generate gcps and
+  // estimates a rpc model with the native solver. Some gcps are then
+  // corrupted, and the RANSAC estimation should reject them and keep
+  // the same precision over the others.
+  std::string infname = argv[1];
+  const unsigned int gridSize = atoi(argv[2]);
+  const double geoTol = atof(argv[3]);
+  const double imgTol = atof(argv[4]);
+  const std::string demdir = argv[5];
+  const std::string geoid = argv[6];
+  const double ransacThreshold = atof(argv[7]);
+
+  otb::DEMHandler::Pointer demHandler = otb::DEMHandler::Instance();
+  demHandler->SetDefaultHeightAboveEllipsoid(0);
+  if(demdir!="no")
+    demHandler->OpenDEMDirectory(demdir);
+  if(geoid!="no")
+    demHandler->OpenGeoidFile(geoid);
+
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(infname);
+  reader->UpdateOutputInformation();
+
+  RSTranformType::Pointer fwd2dTransform = RSTranformType::New();
+  fwd2dTransform->SetInputKeywordList(reader->GetOutput()->GetImageKeywordlist());
+  fwd2dTransform->InstantiateTransform();
+
+  ImageType::SizeType  size = reader->GetOutput()->GetLargestPossibleRegion().GetSize();
+
+  unsigned int stepx = size[0]/gridSize;
+  unsigned int stepy = size[1]/gridSize;
+
+  GCPsContainerType gcps;
+
+  // Generate gcps
+  for(unsigned int i = 0; i < gridSize; ++i)
+    {
+    for(unsigned int j = 0; j < gridSize; ++j)
+      {
+      ImageType::IndexType currentIndex;
+      currentIndex[0] = i*stepx;
+      currentIndex[1] = j*stepy;
+
+      Point2DType currentPoint, currentWgs84Point;
+      reader->GetOutput()->TransformIndexToPhysicalPoint(currentIndex,currentPoint);
+
+      currentWgs84Point = fwd2dTransform->TransformPoint(currentPoint);
+
+      Point3DType current3DWgs84Point;
+      current3DWgs84Point[0] = currentWgs84Point[0];
+      current3DWgs84Point[1] = currentWgs84Point[1];
+      current3DWgs84Point[2] = demHandler->GetHeightAboveEllipsoid(currentWgs84Point);
+
+      gcps.push_back(std::make_pair(currentPoint,current3DWgs84Point));
+      }
+    }
+
+  unsigned int nbErrors = 0;
+
+  // Plain estimation: every gcp is an inlier
+  otb::ImageKeywordlist rpcKwl;
+  otb::RPCSolverAdapter::InlierFlagsType inliers;
+  double rmse;
+  otb::RPCSolverAdapter::Solve(gcps, 0., 0, rmse, inliers, rpcKwl);
+
+  std::cout << "Native estimation done, RMSE=" << rmse << std::endl;
+
+  if (std::count(inliers.begin(), inliers.end(), true) != static_cast<long>(gcps.size()))
+    {
+    std::cerr << "Some gcps were rejected without RANSAC" << std::endl;
+    ++nbErrors;
+    }
+  nbErrors += CheckModel(rpcKwl, gcps, inliers, geoTol, imgTol);
+
+  // Corrupt one gcp out of twenty, far above the RANSAC threshold
+  GCPsContainerType corruptedGcps = gcps;
+  std::vector<bool> clean(gcps.size(), true);
+  for (unsigned int i = 3; i < corruptedGcps.size(); i += 20)
+    {
+    corruptedGcps[i].first[0] += 20 * ransacThreshold;
+    corruptedGcps[i].first[1] -= 10 * ransacThreshold;
+    clean[i] = false;
+    }
+
+  otb::ImageKeywordlist robustKwl;
+  otb::RPCSolverAdapter::Solve(corruptedGcps, ransacThreshold, 500, rmse, inliers, robustKwl);
+
+  std::cout << "RANSAC estimation done, RMSE=" << rmse << ", "
+            << std::count(inliers.begin(), inliers.end(), true) << " inliers out of " << gcps.size() << std::endl;
+
+  if (inliers != clean)
+    {
+    std::cerr << "RANSAC did not reject exactly the corrupted gcps" << std::endl;
+    ++nbErrors;
+    }
+  nbErrors += CheckModel(robustKwl, gcps, clean, geoTol, imgTol);
+
+  return nbErrors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
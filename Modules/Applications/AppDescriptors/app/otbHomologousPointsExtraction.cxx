@@ -29,6 +29,7 @@
 #include "otbImageToSIFTKeyPointSetFilter.h"
 #endif
 #include "otbImageToSURFKeyPointSetFilter.h"
+#include "otbStreamingImageToKeyPointSetFilter.h"
 #include "otbKeyPointSetsMatchingFilter.h"
 #include "otbMultiToMonoChannelExtractROI.h"
 #include "otbKeyPointSetsMatchingFilter.h"
@@ -64,6 +65,9 @@ public:
 
   typedef ImageToSURFKeyPointSetFilter<FloatImageType,PointSetType> SurfFilterType;
 
+  typedef StreamingImageToKeyPointSetFilter<SiftFilterType>::FilterType StreamingSiftFilterType;
+  typedef StreamingImageToKeyPointSetFilter<SurfFilterType>::FilterType StreamingSurfFilterType;
+
   typedef itk::Statistics::EuclideanDistanceMetric<RealVectorType> DistanceType;
   typedef otb::KeyPointSetsMatchingFilter<PointSetType,
                                           DistanceType>      MatchingFilterType;
@@ -88,13 +92,16 @@ private:
     SetDocLongDescription("This application allows computing homologous points between images using keypoints. "
       " SIFT or SURF keypoints can be used and the band on which keypoints are computed can be set independently for both images."
       " The application offers two modes :"
-      " the first is the full mode where keypoints are extracted from the full extent of both images"
-      " (please note that in this mode large image file are not supported). "
+      " the first is the full mode where keypoints are extracted from the full extent of both images."
+      " Keypoints are extracted by tiles, so that large images are supported. "
       "The second mode, called geobins, allows one to set-up spatial binning to get fewer points"
       " spread across the entire image. "
       "In this mode, the corresponding spatial bin in the second image is estimated using geographical"
       " transform or sensor modelling, and is padded according to the user defined precision. Last, in"
       " both modes the application can filter matches whose colocalisation in first image exceed this precision. "
+      "Independently, the geometric prefilter only compares descriptors with the ones of the keypoints colocalised within this precision, "
+      "which speeds up matching and avoids distant false matches. "
+      "On large sets of keypoints, the approximate nearest neighbor search speeds up matching at the expense of a few missed matches. "
       "The elevation parameters are to deal more precisely with sensor modelling in case of sensor geometry data. "
       "The outvector option allows creating a vector file with segments corresponding to the localisation error between the matches."
       " It can be useful to assess the precision of a registration for instance."
@@ -102,7 +109,7 @@ private:
       " This is done via reprojection or by applying the image sensor models.");
     // Documentation
     SetDocName("Homologous Points Extraction");
-    SetDocLimitations("Full mode does not handle large images.");
+    SetDocLimitations("In full mode, all the keypoints of both images are kept in memory for matching.");
     SetDocSeeAlso("RefineSensorModel");
     SetDocAuthors("OTB-Team");
 
@@ -140,10 +147,29 @@ private:
     MandatoryOff("backmatching");
     DisableParameter("backmatching");
 
+    AddParameter(ParameterType_Choice,"nnsearch","Nearest neighbor search for matching");
+    SetParameterDescription("nnsearch","Choice of the search of the nearest neighbor descriptors");
+
+    AddChoice("nnsearch.exact","Exact search");
+    SetParameterDescription("nnsearch.exact","Compare each descriptor of the first image with all the descriptors of the second image");
+
+    AddChoice("nnsearch.approx","Approximate search");
+    SetParameterDescription("nnsearch.approx","Search the descriptors in randomized kd-trees, which is much faster on large sets of keypoints but may miss some matches");
+
+    AddParameter(ParameterType_Int,"nnsearch.approx.trees","Number of trees");
+    SetParameterDescription("nnsearch.approx.trees","Number of randomized kd-trees searched together");
+    SetMinimumParameterIntValue("nnsearch.approx.trees",1);
+    SetDefaultParameterInt("nnsearch.approx.trees",4);
+
+    AddParameter(ParameterType_Int,"nnsearch.approx.checks","Maximum number of checks");
+    SetParameterDescription("nnsearch.approx.checks","Maximum number of descriptors compared for each search. Higher values give more matches, at the expense of speed.");
+    SetMinimumParameterIntValue("nnsearch.approx.checks",1);
+    SetDefaultParameterInt("nnsearch.approx.checks",256);
+
     AddParameter(ParameterType_Choice,"mode","Keypoints search mode");
 
-    AddChoice("mode.full","Extract and match all keypoints (no streaming)");
-    SetParameterDescription("mode.full","Extract and match all keypoints, loading both images entirely into memory");
+    AddChoice("mode.full","Extract and match all keypoints");
+    SetParameterDescription("mode.full","Extract all keypoints of both images by tiles, and match them");
 
     AddChoice("mode.geobins","Search keypoints in small spatial bins regularly spread across first image");
     SetParameterDescription("mode.geobins","This method allows retrieving a set of tie points regulary spread across image 1. Corresponding bins in image 2 are retrieved using sensor and geographical information if available. The first bin position takes into account the margin parameter. Bins are cropped to the largest image region shrunk by the margin parameter for both in1 and in2 images.");
@@ -180,11 +206,16 @@ private:
     AddParameter(ParameterType_Empty,"mfilter","Filter points according to geographical or sensor based colocalisation");
     SetParameterDescription("mfilter","If enabled, this option allows one to filter matches according to colocalisation from sensor or geographical information, using the given tolerancy expressed in pixels");
 
+    AddParameter(ParameterType_Empty,"gfilter","Only match points colocalised by geographical or sensor information");
+    SetParameterDescription("gfilter","If enabled, the descriptor of each point of the first image is only compared with the ones of the points of the second image within the given precision of its colocalised position, before the distance ratio test. Unlike mfilter, this changes the candidates of each match, and not only the matches kept.");
+
     AddParameter(ParameterType_Empty,"2wgs84","If enabled, points from second image will be exported in WGS84");
 
     // Elevation
     ElevationParametersHandler::AddElevationParameters(this, "elev");
 
+    AddRAMParameter();
+
     AddParameter(ParameterType_OutputFilename,"out","Output file with tie points");
     SetParameterDescription("out","File containing the list of tie points");
 
@@ -214,44 +245,63 @@ private:
     if(GetParameterString("algorithm")=="sift")
       {
       otbAppLogINFO("Using SIFT points");
-      SiftFilterType::Pointer sift1 = SiftFilterType::New();
-      sift1->SetInput(im1);
+      StreamingSiftFilterType::Pointer sift1 = StreamingSiftFilterType::New();
+      sift1->GetFilter()->SetInput(im1);
+      sift1->GetStreamer()->SetAutomaticAdaptativeStreaming(GetParameterInt("ram"));
 
-      SiftFilterType::Pointer sift2 = SiftFilterType::New();
-      sift2->SetInput(im2);
+      StreamingSiftFilterType::Pointer sift2 = StreamingSiftFilterType::New();
+      sift2->GetFilter()->SetInput(im2);
+      sift2->GetStreamer()->SetAutomaticAdaptativeStreaming(GetParameterInt("ram"));
 
       sift1->Update();
 
-      otbAppLogINFO("Found " << sift1->GetOutput()->GetNumberOfPoints()<<" sift points in image 1.");
+      otbAppLogINFO("Found " << sift1->GetFilter()->GetPointSet()->GetNumberOfPoints()<<" sift points in image 1.");
 
       sift2->Update();
 
-      otbAppLogINFO("Found " << sift2->GetOutput()->GetNumberOfPoints()<<" sift points in image 2.");
+      otbAppLogINFO("Found " << sift2->GetFilter()->GetPointSet()->GetNumberOfPoints()<<" sift points in image 2.");
 
-      matchingFilter->SetInput1(sift1->GetOutput());
-      matchingFilter->SetInput2(sift2->GetOutput());
+      matchingFilter->SetInput1(sift1->GetFilter()->GetPointSet());
+      matchingFilter->SetInput2(sift2->GetFilter()->GetPointSet());
       }
     else if(GetParameterString("algorithm")=="surf")
       {
-      SurfFilterType::Pointer surf1 = SurfFilterType::New();
-      surf1->SetInput(im1);
+      StreamingSurfFilterType::Pointer surf1 = StreamingSurfFilterType::New();
+      surf1->GetFilter()->SetInput(im1);
+      surf1->GetStreamer()->SetAutomaticAdaptativeStreaming(GetParameterInt("ram"));
 
-      SurfFilterType::Pointer surf2 = SurfFilterType::New();
-      surf2->SetInput(im2);
+      StreamingSurfFilterType::Pointer surf2 = StreamingSurfFilterType::New();
+      surf2->GetFilter()->SetInput(im2);
+      surf2->GetStreamer()->SetAutomaticAdaptativeStreaming(GetParameterInt("ram"));
 
       otbAppLogINFO("Doing update");
       surf1->Update();
 
-      otbAppLogINFO("Found " << surf1->GetOutput()->GetNumberOfPoints()<<" surf points in image 1.");
+      otbAppLogINFO("Found " << surf1->GetFilter()->GetPointSet()->GetNumberOfPoints()<<" surf points in image 1.");
 
       surf2->Update();
 
-      otbAppLogINFO("Found " << surf2->GetOutput()->GetNumberOfPoints()<<" surf points in image 2.");
+      otbAppLogINFO("Found " << surf2->GetFilter()->GetPointSet()->GetNumberOfPoints()<<" surf points in image 2.");
 
-      matchingFilter->SetInput1(surf1->GetOutput());
-      matchingFilter->SetInput2(surf2->GetOutput());
-      matchingFilter->SetDistanceThreshold(GetParameterFloat("threshold"));
-      matchingFilter->SetUseBackMatching(IsParameterEnabled("backmatching"));
+      matchingFilter->SetInput1(surf1->GetFilter()->GetPointSet());
+      matchingFilter->SetInput2(surf2->GetFilter()->GetPointSet());
+      }
+
+    matchingFilter->SetDistanceThreshold(GetParameterFloat("threshold"));
+    matchingFilter->SetUseBackMatching(IsParameterEnabled("backmatching"));
+
+    if(GetParameterString("nnsearch")=="approx")
+      {
+      matchingFilter->ApproximateSearchOn();
+      matchingFilter->SetNumberOfTrees(GetParameterInt("nnsearch.approx.trees"));
+      matchingFilter->SetMaximumNumberOfChecks(GetParameterInt("nnsearch.approx.checks"));
+      }
+
+    if(IsParameterEnabled("gfilter"))
+      {
+      // Only look for matches around the colocalised position of each point
+      matchingFilter->SetTransform(rsTransform);
+      matchingFilter->SetGeometricThreshold(GetParameterFloat("precision")*vcl_sqrt(vcl_abs(im2->GetSpacing()[0]*im2->GetSpacing()[1])));
       }
 
     try
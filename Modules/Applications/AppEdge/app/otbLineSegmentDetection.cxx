@@ -21,14 +21,17 @@
 #include "otbWrapperApplicationFactory.h"
 
 #include "otbStreamingLineSegmentDetector.h"
+#include "otbStreamingLineSegmentDetectorToOGRLayerFilter.h"
+#include "otbOGRDataSourceWrapper.h"
 
 #include "otbVectorImageToAmplitudeImageFilter.h"
 #include "otbStreamingStatisticsImageFilter.h"
 #include "itkShiftScaleImageFilter.h"
 
 #include "otbVectorDataProjectionFilter.h"
-#include "otbVectorDataTransformFilter.h"
-#include "itkAffineTransform.h"
+#include "otbGenericRSTransform.h"
+#include "otbGeoInformationConversion.h"
+#include "itksys/SystemTools.hxx"
 
 // Elevation handler
 #include "otbWrapperElevationParametersHandler.h"
@@ -67,8 +70,17 @@ private:
       "by Rafael Gromponevon Gioi, Jérémie Jakubowicz, Jean-Michel Morel and "
       "Gregory Randall. The given approach computes gradient and level lines of the "
       "image and detects aligned points in line support region. "
-      "The application allows exporting the detected lines in a vector data.");
-    SetDocLimitations("None");
+      "The application allows exporting the detected lines in a vector data.\n\n"
+      "With the outogr parameter, the image is processed by tiles, in parallel, "
+      "and the detected lines are written to the output file as the image is "
+      "streamed, so that large images can be processed. Lines crossing tile "
+      "borders are merged and validated again. The threshold on the gradient is "
+      "the same for all tiles: it is not normalized by the gradient range of "
+      "each tile, but scaled by the range of the input amplitude.");
+    SetDocLimitations(
+      "The lines of the out parameter are kept in memory. The lines of the "
+      "outogr parameter are written to the file while the image is streamed, "
+      "and can not be retrieved in memory through the application API.");
     SetDocAuthors("OTB-Team");
     SetDocSeeAlso(
       "On Line demonstration of the LSD algorithm is available here: "
@@ -81,6 +93,14 @@ private:
 
     AddParameter(ParameterType_OutputVectorData, "out", "Output Detected lines");
     SetParameterDescription("out"," Output detected line segments (vector data).");
+    MandatoryOff("out");
+
+    AddParameter(ParameterType_OutputFilename, "outogr", "Output Detected lines, streamed");
+    SetParameterDescription("outogr",
+      "Output file of the detected line segments, written through OGR while the"
+      " image is processed by tiles. The threshold and tilesize parameters only"
+      " apply to this output.");
+    MandatoryOff("outogr");
 
     // Elevation
     ElevationParametersHandler::AddElevationParameters(this, "elev");
@@ -91,6 +111,23 @@ private:
       " Turn on this parameter to skip rescaling");
     MandatoryOff("norescale");
 
+    AddParameter(ParameterType_Float, "threshold", "Gradient threshold");
+    SetParameterDescription("threshold",
+      "Threshold on the gradient magnitude of the outogr output, for an input"
+      " amplitude in [0,255]. With norescale, it is scaled by the range of the"
+      " input amplitude, so that the detection does not depend on the"
+      " radiometric dynamic.");
+    SetDefaultParameterFloat("threshold", 5.2);
+    SetMinimumParameterFloatValue("threshold", 0.);
+    MandatoryOff("threshold");
+
+    AddParameter(ParameterType_Int, "tilesize", "Size of the tiles");
+    SetParameterDescription("tilesize",
+      "Size of the tiles processed in parallel for the outogr output, in pixels.");
+    SetDefaultParameterInt("tilesize", 512);
+    SetMinimumParameterIntValue("tilesize", 16);
+    MandatoryOff("tilesize");
+
     AddRAMParameter();
 
     // Doc example parameter settings
@@ -115,8 +152,13 @@ private:
     typedef itk::ShiftScaleImageFilter<FloatImageType, FloatImageType>
       ShiftScaleImageFilterType;
 
-    typedef otb::StreamingLineSegmentDetector
-      < FloatImageType >::FilterType LSDFilterType;
+    const bool hasOut = IsParameterEnabled("out") && HasValue("out");
+    const bool hasOutOGR = IsParameterEnabled("outogr") && HasValue("outogr");
+
+    if ( !hasOut && !hasOutOGR )
+      {
+      otbAppLogFATAL(<< "No output: set out or outogr.");
+      }
 
     VectorImageToAmplitudeImageFilterType::Pointer amplitudeConverter
       = VectorImageToAmplitudeImageFilterType::New();
@@ -131,8 +173,10 @@ private:
     ShiftScaleImageFilterType::Pointer shiftScale
       = ShiftScaleImageFilterType::New();
 
-    // Default behavior is to do the rescaling
-    if ( !IsParameterEnabled("norescale") )
+    // The range of the amplitude is needed either to rescale it, or to scale
+    // the threshold of the streamed output
+    double range = 255.;
+    if ( !IsParameterEnabled("norescale") || hasOutOGR )
       {
       stats->SetInput(amplitudeConverter->GetOutput());
       stats->GetStreamer()->SetAutomaticAdaptativeStreaming(GetParameterInt("ram"));
@@ -141,13 +185,43 @@ private:
       stats->Update();
       FloatImageType::PixelType min = stats->GetMinimum();
       FloatImageType::PixelType max = stats->GetMaximum();
+      if ( max > min )
+        {
+        range = static_cast<double>(max - min);
+        }
+
+      // Default behavior is to do the rescaling
+      if ( !IsParameterEnabled("norescale") )
+        {
+        shiftScale->SetInput(amplitudeConverter->GetOutput());
+        shiftScale->SetShift( -min );
+        shiftScale->SetScale( 255.0 / range );
+
+        image = shiftScale->GetOutput();
+        }
+      }
 
-      shiftScale->SetInput(amplitudeConverter->GetOutput());
-      shiftScale->SetShift( -min );
-      shiftScale->SetScale( 255.0 / (max - min) );
+    if ( hasOut )
+      {
+      this->DetectToVectorData(image);
+      }
 
-      image = shiftScale->GetOutput();
+    if ( hasOutOGR )
+      {
+      double threshold = GetParameterFloat("threshold");
+      if ( IsParameterEnabled("norescale") )
+        {
+        threshold *= range / 255.;
+        }
+      this->DetectToOGR(image, threshold);
       }
+  }
+
+  /** Detect the lines of the whole image and set them to the out parameter */
+  void DetectToVectorData(FloatImageType * image)
+  {
+    typedef otb::StreamingLineSegmentDetector
+      < FloatImageType >::FilterType LSDFilterType;
 
     LSDFilterType::Pointer lsd
       = LSDFilterType::New();
@@ -184,8 +258,6 @@ private:
       VectorDataProjectionFilterType::Pointer vproj = VectorDataProjectionFilterType::New();
       vproj->SetInput(vd);
       vproj->SetInputKeywordList(GetParameterImage("in")->GetImageKeywordlist());
-      //vproj->SetInputOrigin(GetParameterImage("in")->GetOrigin());
-      //vproj->SetInputSpacing(GetParameterImage("in")->GetSpacing());
 
       // Setup the DEM Handler
       otb::Wrapper::ElevationParametersHandler::SetupDEMHandlerFromElevationParameters(this,"elev");
@@ -199,6 +271,68 @@ private:
     SetParameterOutputVectorData("out", projectedVD);
   }
 
+  /** Detect the lines by tiles and write them to the outogr file */
+  void DetectToOGR(FloatImageType * image, double threshold)
+  {
+    typedef otb::StreamingLineSegmentDetectorToOGRLayerFilter<FloatImageType>
+      LSDFilterType;
+
+    typedef otb::GenericRSTransform<> RSTransformType;
+
+    otbAppLogINFO(<< "Threshold on the gradient magnitude: " << threshold);
+
+    LSDFilterType::Pointer lsd
+      = LSDFilterType::New();
+    lsd->SetInput(image);
+    lsd->SetThreshold(threshold);
+    lsd->SetTileSize(GetParameterInt("tilesize"));
+    lsd->GetStreamer()->SetAutomaticAdaptativeStreaming(GetParameterInt("ram"));
+
+    /*
+     * Segments are written in image physical coordinates, projection WKT
+     * applied if the input image has one.
+     *
+     * We need to reproject in WGS84 if the input image is in sensor model geometry
+     */
+
+    std::string projRef = GetParameterImage("in")->GetProjectionRef();
+    ImageKeywordlist kwl = GetParameterImage("in")->GetImageKeywordlist();
+
+    RSTransformType::Pointer rsTransform = RSTransformType::New();
+
+    if ( projRef.empty() && kwl.GetSize() > 0 )
+      {
+      // image is in sensor model geometry
+
+      // Setup the DEM Handler
+      otb::Wrapper::ElevationParametersHandler::SetupDEMHandlerFromElevationParameters(this,"elev");
+
+      rsTransform->SetInputKeywordList(kwl);
+      rsTransform->InstantiateTransform();
+      lsd->SetOutputTransform(rsTransform);
+
+      projRef = otb::GeoInformationConversion::ToWKT(4326);
+      }
+
+    // Create the output layer
+    otb::ogr::DataSource::Pointer ogrDS
+      = otb::ogr::DataSource::New(GetParameterString("outogr"), otb::ogr::DataSource::Modes::Overwrite);
+    OGRSpatialReference oSRS(projRef.c_str());
+    otb::ogr::Layer layer = ogrDS->CreateLayer(
+      itksys::SystemTools::GetFilenameWithoutExtension(GetParameterString("outogr")),
+      &oSRS, wkbLineString);
+
+    lsd->SetOGRLayer(layer);
+    lsd->Initialize();
+
+    AddProcess(lsd->GetStreamer(), "Running Line Segment Detector by tiles");
+    lsd->Update();
+
+    ogrDS->SyncToDisk();
+
+    otbAppLogINFO(<< lsd->GetNumberOfSegments() << " line segments detected.");
+  }
+
 };
 
 }
@@ -30,6 +30,7 @@ otb_module(OTBAppEdge
     OTBEdge
     OTBImageManipulation
     OTBProjection
+    OTBTransform
 
   TEST_DEPENDS
     OTBTestKernel
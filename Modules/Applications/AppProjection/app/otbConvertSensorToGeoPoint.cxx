@@ -22,6 +22,8 @@
 #include "otbWrapperApplicationFactory.h"
 
 #include "otbForwardSensorModel.h"
+#include "otbLocalisationGridTransform.h"
+#include "otbWrapperLocalisationGridParametersHandler.h"
 #include "otbCoordinateToName.h"
 
 namespace otb
@@ -45,6 +47,7 @@ public:
 
   /** Filters typedef */
   typedef otb::ForwardSensorModel<double> ModelType;
+  typedef otb::LocalisationGridTransform<TransformDirection::FORWARD, double> GridTransformType;
   typedef itk::Point<double, 2>           PointType;
 
 private:
@@ -74,6 +77,9 @@ private:
     SetParameterDescription("input.idy", "Y coordinate of the point to transform.");
     SetDefaultParameterFloat("input.idy",0.0);
 
+    // Localisation grid cache
+    LocalisationGridParametersHandler::AddLocalisationGridParameters(this, "locgrid");
+
     // Output with Output Role
     AddParameter(ParameterType_Group, "output", "Geographic Coordinates");
     AddParameter(ParameterType_Float, "output.idx","Output Point Longitude");
@@ -127,7 +133,18 @@ private:
     inImage->TransformContinuousIndexToPhysicalPoint(inIndex,point);
 
     ModelType::OutputPointType outputPoint;
-    outputPoint = model->TransformPoint(point);
+    LocalisationGrid::Pointer grid = LocalisationGridParametersHandler::GetLocalisationGrid(this, "locgrid", "in");
+    if (grid.IsNotNull())
+      {
+      GridTransformType::Pointer gridTransform = GridTransformType::New();
+      gridTransform->SetGrid(grid);
+      gridTransform->SetFallbackTransform(model);
+      outputPoint = gridTransform->TransformPoint(point);
+      }
+    else
+      {
+      outputPoint = model->TransformPoint(point);
+      }
 
     // Set the value computed
     SetParameterFloat("output.idx",outputPoint[0], false);
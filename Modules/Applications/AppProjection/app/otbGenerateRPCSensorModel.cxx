@@ -26,10 +26,14 @@
 #include "otbSensorModelAdapter.h"
 #include "otbRPCSolverAdapter.h"
 #include "itkEuclideanDistanceMetric.h"
+#include "itkTimeProbe.h"
+#include "otbImageKeywordlist.h"
 #include "otbGenericRSTransform.h"
 #include "otbOGRDataSourceWrapper.h"
 #include "ogrsf_frmts.h"
 
+#include <algorithm>
+
 namespace otb
 {
 namespace Wrapper
@@ -69,7 +73,9 @@ private:
                                    "Elevation support will be automatically deactivated if an insufficient amount of points is provided. "
                                    "The application can optionally output a file containing accuracy statistics for each point,"
                                    " and a vector file containing segments representing points residues. "
-                                   "The map projection parameter allows defining a map projection in which the accuracy is evaluated." );
+                                   "The map projection parameter allows defining a map projection in which the accuracy is evaluated. "
+                                   "The coefficients can be estimated either by the OSSIM solver, or by a native solver which can "
+                                   "reject outlier points with RANSAC." );
 
     AddDocTag(Tags::Geometry);
 
@@ -93,6 +99,25 @@ private:
     MandatoryOff("outvector");
     DisableParameter("outvector");
 
+    AddParameter(ParameterType_Choice, "solver", "RPC solver");
+    SetParameterDescription("solver","Solver used to estimate the RPC coefficients");
+    AddChoice("solver.ossim", "OSSIM solver");
+    SetParameterDescription("solver.ossim","Least squares estimation by the OSSIM library");
+    AddChoice("solver.native", "Native solver");
+    SetParameterDescription("solver.native","Iteratively reweighted least squares on the normal equations, with optional RANSAC outlier rejection");
+
+    AddParameter(ParameterType_Float, "solver.native.ransac", "RANSAC threshold");
+    SetParameterDescription("solver.native.ransac","Maximum image residual (in pixels) of a tie point kept by RANSAC. RANSAC is disabled if this value is 0.");
+    SetDefaultParameterFloat("solver.native.ransac", 0.);
+    SetMinimumParameterFloatValue("solver.native.ransac", 0.);
+
+    AddParameter(ParameterType_Int, "solver.native.iterations", "RANSAC iterations");
+    SetParameterDescription("solver.native.iterations","Number of random sets of tie points drawn by RANSAC");
+    SetDefaultParameterInt("solver.native.iterations", 1000);
+    SetMinimumParameterIntValue("solver.native.iterations", 1);
+
+    SetParameterString("solver", "ossim", false);
+
     // Build the Output Map Projection
     MapProjectionParametersHandler::AddMapProjectionParameters(this, "map");
 
@@ -160,9 +185,30 @@ private:
 
   double rms;
 
-  otb::RPCSolverAdapter::Solve(tiepoints,rms,GetParameterString("outgeom"));
+  itk::TimeProbe chrono;
+  chrono.Start();
+
+  if(GetParameterString("solver") == "native")
+    {
+    otb::RPCSolverAdapter::InlierFlagsType inliers;
+    otb::ImageKeywordlist rpcKwl;
+    otb::RPCSolverAdapter::Solve(tiepoints,
+                                 GetParameterFloat("solver.native.ransac"),
+                                 GetParameterInt("solver.native.iterations"),
+                                 rms, inliers, rpcKwl);
+    otb::WriteGeometry(rpcKwl, GetParameterString("outgeom"));
+
+    const unsigned int nbInliers = std::count(inliers.begin(), inliers.end(), true);
+    otbAppLogINFO("Tie points kept by the native solver: "<<nbInliers<<" out of "<<tiepoints.size());
+    }
+  else
+    {
+    otb::RPCSolverAdapter::Solve(tiepoints,rms,GetParameterString("outgeom"));
+    }
+
+  chrono.Stop();
 
-  otbAppLogINFO("Done.\n");
+  otbAppLogINFO("Done in "<<chrono.GetTotal()<<" seconds. Image RMS residual: "<<rms<<" pixels.\n");
 
   otb::SensorModelAdapter::Pointer sm     = otb::SensorModelAdapter::New();
   sm->ReadGeomFile(GetParameterString("outgeom"));
@@ -34,6 +34,9 @@
 // Elevation handler
 #include "otbWrapperElevationParametersHandler.h"
 
+// Localisation grid handler
+#include "otbWrapperLocalisationGridParametersHandler.h"
+
 #include "otbGeographicalDistance.h"
 
 namespace otb
@@ -192,6 +195,9 @@ private:
     // Elevation
     ElevationParametersHandler::AddElevationParameters(this, "elev");
 
+    // Localisation grid cache
+    LocalisationGridParametersHandler::AddLocalisationGridParameters(this, "locgrid");
+
     // Interpolators
     AddParameter(ParameterType_Choice,   "interpolator", "Interpolation");
     AddChoice("interpolator.bco",    "Bicubic interpolation");
@@ -614,6 +620,10 @@ private:
     m_ResampleFilter->SetInputKeywordList(inImage->GetImageKeywordlist());
     m_ResampleFilter->SetOutputProjectionRef(m_OutputProjectionRef);
 
+    // Interpolate the input sensor model in its localisation grid
+    m_ResampleFilter->SetInputLocalisationGrid(
+      LocalisationGridParametersHandler::GetLocalisationGrid(this, "locgrid", "io.in"));
+
     // Check size
     if (GetParameterInt("outputs.sizex") <= 0 || GetParameterInt("outputs.sizey") <= 0)
       {
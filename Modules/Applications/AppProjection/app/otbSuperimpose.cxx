@@ -29,6 +29,7 @@
 
 // Elevation handler
 #include "otbWrapperElevationParametersHandler.h"
+#include "otbWrapperLocalisationGridParametersHandler.h"
 #include "otbPleiadesPToXSAffineTransformCalculator.h"
 
 namespace otb
@@ -104,6 +105,9 @@ private:
     // Elevation
     ElevationParametersHandler::AddElevationParameters(this, "elev");
 
+    // Localisation grid cache
+    LocalisationGridParametersHandler::AddLocalisationGridParameters(this, "locgrid");
+
     AddParameter(ParameterType_Float,        "lms",   "Spacing of the deformation field");
     SetParameterDescription("lms","Generate a coarser deformation field with the given spacing");
     SetDefaultParameterFloat("lms", 4.);
@@ -250,6 +254,12 @@ private:
       
       m_Resampler->SetOutputKeywordList(refImage->GetImageKeywordlist());
       m_Resampler->SetOutputProjectionRef(refImage->GetProjectionRef());
+
+      // Interpolate the sensor models in their localisation grids
+      m_Resampler->SetInputLocalisationGrid(
+        LocalisationGridParametersHandler::GetLocalisationGrid(this, "locgrid", "inm"));
+      m_Resampler->SetOutputLocalisationGrid(
+        LocalisationGridParametersHandler::GetLocalisationGrid(this, "locgrid", "inr"));
       
       m_Resampler->SetInput(movingImage);
       
@@ -22,6 +22,7 @@
 #include "otbWrapperNumericalParameter.h"
 #include "otbGeometriesProjectionFilter.h"
 #include "otbGeometriesSet.h"
+#include "itkTimeProbe.h"
 
 
 // MapProjection handler
@@ -72,7 +73,9 @@ private:
     oss.str("");
     oss <<" This application allows reprojecting a vector data using support image projection reference"
         ", or a user given map projection." << std::endl;
-    oss <<" If given, image keywordlist can be added to reprojected vectordata.";
+    oss <<" If given, image keywordlist can be added to reprojected vectordata."<< std::endl;
+    oss <<" Features are streamed from the input layers by chunks, whose geometries"
+        " are reprojected in parallel.";
     SetDocLongDescription(oss.str());
     SetDocLimitations(" ");
     SetDocAuthors("OTB-Team");
@@ -95,6 +98,12 @@ private:
     AddParameter(ParameterType_Group, "out", "Output data");
     AddParameter(ParameterType_OutputFilename, "out.vd", "Output vector data");
     SetParameterDescription("out.vd", "The reprojected vector data");
+    AddParameter(ParameterType_Int, "out.chunk", "Features per chunk");
+    SetParameterDescription("out.chunk", "Number of features read, reprojected in parallel and written at once. "
+                            "Layers are processed chunk by chunk, so that memory usage does not depend on their size.");
+    SetDefaultParameterInt("out.chunk", 10000);
+    SetMinimumParameterIntValue("out.chunk", 1);
+    MandatoryOff("out.chunk");
 
     // output projection choice
     AddParameter(ParameterType_Choice, "out.proj", "Output Projection choice");
@@ -186,8 +195,14 @@ private:
     m_OutputGeomSet = OutputGeometriesType::New(OGRDSout);
 
     m_GeometriesProjFilter->SetOutput(m_OutputGeomSet);
+    m_GeometriesProjFilter->SetFeatureChunkSize(GetParameterInt("out.chunk"));
+
+    itk::TimeProbe chrono;
+    chrono.Start();
     m_GeometriesProjFilter->Update();
     OGRDSout->SyncToDisk();
+    chrono.Stop();
+    otbAppLogINFO(<<"Geometries reprojected in "<<chrono.GetTotal()<<" s");
   }
 
   otb::ogr::DataSource::Pointer OGRDSout;
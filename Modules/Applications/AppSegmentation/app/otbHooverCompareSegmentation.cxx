@@ -23,6 +23,7 @@
 
 #include "otbHooverMatrixFilter.h"
 #include "otbHooverInstanceFilter.h"
+#include "otbStreamingHooverCompareFilter.h"
 #include "otbLabelMapToAttributeImageFilter.h"
 
 #include "itkLabelImageToLabelMapFilter.h"
@@ -128,6 +129,8 @@ public:
        Int16VectorImageType,
        Functor::HooverColorMapping
         <FloatPixelType, Int16PixelType> >          HooverColorFilterType;
+  typedef otb::StreamingHooverCompareFilter
+      <ImageType>                                   StreamingHooverFilterType;
 
 private:
   void DoInit() ITK_OVERRIDE
@@ -144,6 +147,9 @@ private:
                           "\n The application can output the overall Hoover scores along with colored"
                           "images of the MS and GT segmentation showing the state of each region "
                           "(correct detection, over-segmentation, under-segmentation, missed)"
+                          "\n When no colored output is requested, the input segmentations are streamed "
+                          "and only the overlapping pairs of regions are stored, which allows comparing "
+                          "large segmentations with many regions."
                           "\n The Hoover metrics are described in : Hoover et al., \"An experimental"
                           " comparison of range image segmentation algorithms\", IEEE PAMI vol. 18, no. 7, July 1996.");
     SetDocLimitations("None");
@@ -212,6 +218,24 @@ private:
     UInt32ImageType::Pointer inputGT = GetParameterUInt32Image("ingt");
     UInt32ImageType::Pointer inputMS = GetParameterUInt32Image("inms");
 
+    if (!HasValue("outgt") && !HasValue("outms"))
+      {
+      // Only the scores are needed : stream the inputs with sparse overlaps
+      m_StreamingHooverFilter = StreamingHooverFilterType::New();
+      m_StreamingHooverFilter->SetGroundTruthImage(inputGT);
+      m_StreamingHooverFilter->SetMachineSegmentationImage(inputMS);
+      m_StreamingHooverFilter->SetBackgroundValue( GetParameterInt("bg") );
+      m_StreamingHooverFilter->SetThreshold( GetParameterFloat("th") );
+      AddProcess(m_StreamingHooverFilter->GetStreamer(), "Comparing segmentations...");
+      m_StreamingHooverFilter->Update();
+
+      SetParameterFloat("rc",m_StreamingHooverFilter->GetMeanRC(), false);
+      SetParameterFloat("rf",m_StreamingHooverFilter->GetMeanRF(), false);
+      SetParameterFloat("ra",m_StreamingHooverFilter->GetMeanRA(), false);
+      SetParameterFloat("rm",m_StreamingHooverFilter->GetMeanRM(), false);
+      return;
+      }
+
     m_GTFilter = ImageToLabelMapFilterType::New();
     m_GTFilter->SetInput(inputGT);
     m_GTFilter->SetBackgroundValue( GetParameterInt("bg") );
@@ -314,6 +338,8 @@ private:
 
   HooverColorFilterType::Pointer m_GTColorFilter;
   HooverColorFilterType::Pointer m_MSColorFilter;
+
+  StreamingHooverFilterType::Pointer m_StreamingHooverFilter;
 };
 
 
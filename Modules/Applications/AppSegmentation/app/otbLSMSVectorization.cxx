@@ -26,9 +26,12 @@
 
 #include "otbStreamingStatisticsImageFilter.h"
 #include "otbLabelImageToOGRDataSourceFilter.h"
+#include "otbStreamingLabelImageToOGRLayerFilter.h"
 #include "otbOGRFeatureWrapper.h"
+#include "otbRunLengthLabelMap.h"
 
 #include <time.h>
+#include <map>
 #include <vcl_algorithm.h>
 
 namespace otb
@@ -55,10 +58,12 @@ public:
 
   typedef otb::StreamingStatisticsImageFilter<LabelImageType> StatisticsImageFilterType;
 
-  typedef itk::ImageRegionConstIterator<LabelImageType> LabelImageIterator;
   typedef itk::ImageRegionConstIterator<ImageType> ImageIterator;
 
+  typedef otb::RunLengthLabelMap<LabelImageType> RunLengthLabelMapType;
+
   typedef otb::LabelImageToOGRDataSourceFilter<LabelImageType> LabelImageToOGRDataSourceFilterType;
+  typedef otb::StreamingLabelImageToOGRLayerFilter<LabelImageType> StreamingLabelImageToOGRLayerFilterType;
 
 
   itkNewMacro(Self);
@@ -80,7 +85,13 @@ private:
                           " each channels from input image (in parameter), segmentation image"
                           " label, number of pixels in the polygon. For large images one can use"
                           " the tilesizex and tilesizey parameters for tile-wise processing, with"
-                          " the guarantees of identical results.");
+                          " the guarantees of identical results. By default, each tile is"
+                          " polygonized separately, and the polygons of segments crossing tiles"
+                          " are merged afterwards. With the streamed option, pixel boundaries are"
+                          " traced while streaming square tiles of the largest tile size, so that"
+                          " polygons crossing tiles are closed directly: this avoids the"
+                          " geometric union of the polygons, which is costly for large segments,"
+                          " but features and vertices are not written in the same order.");
     SetDocLimitations("This application is part of the Large-Scale Mean-Shift segmentation workflow (LSMS) and may not be suited for any other purpose.");
     SetDocAuthors("David Youssefi");
 
@@ -112,6 +123,10 @@ private:
     SetDefaultParameterInt("tilesizey", 500);
     SetMinimumParameterIntValue("tilesizey", 1);
 
+    AddParameter(ParameterType_Empty, "streamed", "Streamed boundary tracing");
+    SetParameterDescription("streamed", "Vectorize by tracing pixel boundaries while streaming, instead of polygonizing each tile and merging the polygons of segments crossing tiles.");
+    MandatoryOff("streamed");
+
     AddRAMParameter();
 
     // Doc example parameter settings
@@ -128,6 +143,56 @@ private:
   {
   }
 
+  /** Add the polygons of a polygon or multipolygon geometry to a multipolygon */
+  static void AddPolygons(const OGRGeometry & geometry, OGRMultiPolygon & multiPolygon)
+  {
+    if (wkbFlatten(geometry.getGeometryType()) == wkbMultiPolygon)
+      {
+      const OGRMultiPolygon & parts = static_cast<const OGRMultiPolygon &>(geometry);
+      for (int i = 0; i < parts.getNumGeometries(); ++i)
+        {
+        multiPolygon.addGeometry(parts.getGeometryRef(i));
+        }
+      }
+    else
+      {
+      multiPolygon.addGeometry(&geometry);
+      }
+  }
+
+  /** Set the statistics fields of the feature of a label, and simplify its geometry */
+  static void SetFeatureFields(otb::ogr::Feature & feature, LabelImagePixelType curLabel,
+                               const std::vector<int> & nbPixels,
+                               const std::vector<ImageType::PixelType> & sum,
+                               const std::vector<ImageType::PixelType> & sum2)
+  {
+    const unsigned int numberOfComponentsPerPixel = sum[curLabel].Size();
+
+    //Number of pixels per label
+    feature.ogr().SetField("nbPixels",nbPixels[curLabel]);
+
+    //Radiometric means per label
+    for(unsigned int comp = 0; comp<numberOfComponentsPerPixel; ++comp){
+    std::ostringstream fieldoss;
+    fieldoss<<"meanB"<<comp;
+    feature.ogr().SetField(fieldoss.str().c_str(),sum[curLabel][comp]/nbPixels[curLabel]);
+    }
+
+    //Variances per label
+    for(unsigned int comp = 0; comp<numberOfComponentsPerPixel; ++comp){
+    std::ostringstream fieldoss;
+    fieldoss<<"varB"<<comp;
+    float var = 0;
+    if (nbPixels[curLabel]!=1)
+      var = (sum2[curLabel][comp]-sum[curLabel][comp]*sum[curLabel][comp]/nbPixels[curLabel])/(nbPixels[curLabel]-1);
+    feature.ogr().SetField(fieldoss.str().c_str(),var);
+    }
+
+    //Geometries simplification
+    otb::ogr::UniqueGeometryPtr geom = otb::ogr::Simplify(*feature.GetGeometry(),0);
+    feature.SetGeometryDirectly(otb::ogr::Simplify(*geom,0));
+  }
+
   void DoExecute() ITK_OVERRIDE
   {
     clock_t tic = clock();
@@ -208,8 +273,10 @@ private:
     layer.CreateField(field, true);
     }
 
-    //Vectorization per tile
-    otbAppLogINFO(<<"Vectorization ...");
+    //Statistics per tile
+    otbAppLogINFO(<<"Computing statistics ...");
+    clock_t ticStatistics = clock();
+    RunLengthLabelMapType::Pointer labelMap = RunLengthLabelMapType::New();
     for(unsigned int row = 0; row < nbTilesY; row++)
       {
       for(unsigned int column = 0; column < nbTilesX; column++)
@@ -237,140 +304,234 @@ private:
         labelImageROI->SetSizeY(sizeY);
         labelImageROI->Update();
 
-        //Sums calculation for the mean and the variance calculation per label
-        LabelImageIterator itLabel( labelImageROI->GetOutput(), labelImageROI->GetOutput()->GetLargestPossibleRegion());
-        ImageIterator itImage( imageROI->GetOutput(), imageROI->GetOutput()->GetLargestPossibleRegion());
-        for (itLabel.GoToBegin(), itImage.GoToBegin(); !itImage.IsAtEnd(); ++itLabel, ++itImage)
+        //Runs of each label of the tile, built with several threads
+        labelMap->Build(labelImageROI->GetOutput());
+
+        //Sums calculation for the mean and the variance calculation per label.
+        //Pixels of a label are read in raster order, as when scanning the tile,
+        //directly in the buffer of the tile: the accumulators of a label are
+        //looked up once, and no iterator is built per run.
+        const ImageType * imageTile = imageROI->GetOutput();
+        const ImageType::InternalPixelType * buffer = imageTile->GetBufferPointer();
+        for(RunLengthLabelMapType::ObjectIdType id = 0; id < labelMap->GetNumberOfObjects(); ++id)
           {
-          nbPixels[itLabel.Value()]++;
-          for(unsigned int comp = 0; comp<numberOfComponentsPerPixel; ++comp)
+          const LabelImagePixelType curLabel = labelMap->GetLabel(id);
+          nbPixels[curLabel] += labelMap->GetArea(id);
+          ImageType::PixelType & labelSum = sum[curLabel];
+          ImageType::PixelType & labelSum2 = sum2[curLabel];
+          for(const RunLengthLabelMapType::RunType * run = labelMap->GetRunsBegin(id); run != labelMap->GetRunsEnd(id); ++run)
             {
-            sum[itLabel.Value()][comp]+=itImage.Get()[comp];
-            sum2[itLabel.Value()][comp]+=itImage.Get()[comp]*itImage.Get()[comp];
+            const ImageType::InternalPixelType * pixel =
+              buffer + imageTile->ComputeOffset(run->Index) * numberOfComponentsPerPixel;
+            const ImageType::InternalPixelType * runEnd = pixel + run->Length * numberOfComponentsPerPixel;
+            for (; pixel != runEnd; pixel += numberOfComponentsPerPixel)
+              {
+              for(unsigned int comp = 0; comp<numberOfComponentsPerPixel; ++comp)
+                {
+                labelSum[comp]+=pixel[comp];
+                labelSum2[comp]+=pixel[comp]*pixel[comp];
+                }
+              }
             }
           }
-
-        labelImageROI = ExtractROIFilterType::New();
-        labelImageROI->SetInput(labelIn);
-        labelImageROI->SetStartX(startX);
-        labelImageROI->SetStartY(startY);
-        labelImageROI->SetSizeX(sizeX+1);
-        labelImageROI->SetSizeY(sizeY+1);
-        labelImageROI->Update();
-
-        //Raster->Vecteur conversion
-        LabelImageToOGRDataSourceFilterType::Pointer labelToOGR = LabelImageToOGRDataSourceFilterType::New();
-        labelToOGR->SetInput(labelImageROI->GetOutput());
-        labelToOGR->SetInputMask(labelImageROI->GetOutput());
-        labelToOGR->SetFieldName("label");
-        labelToOGR->Update();
-
-        otb::ogr::DataSource::ConstPointer ogrDSTmp = labelToOGR->GetOutput();
-        otb::ogr::Layer layerTmp = ogrDSTmp->GetLayerChecked(0);
-
-        otb::ogr::Layer::const_iterator featIt = layerTmp.begin();
-        for(; featIt!=layerTmp.end(); ++featIt)
-          {
-          otb::ogr::Feature dstFeature(layer.GetLayerDefn());
-          dstFeature.SetFrom( *featIt, TRUE );
-          layer.CreateFeature( dstFeature );
-          }
        }
       }
+    clock_t tocStatistics = clock();
+    otbAppLogINFO(<<"Statistics computed in "<<(double)(tocStatistics - ticStatistics) / CLOCKS_PER_SEC<<" seconds");
 
-    //Sorting by increasing label of the features
-    std::ostringstream sqloss;
-    sqloss.str("");
-    sqloss<<"SELECT * FROM \""<<layername<<"\" ORDER BY label";
-    otb::ogr::Layer layerTmp=ogrDS->ExecuteSQL(sqloss.str().c_str(), ITK_NULLPTR, ITK_NULLPTR);
-    otb::ogr::Feature firstFeature = layerTmp.ogr().GetNextFeature();
-
-    //Geometry fusion
-    otbAppLogINFO("Merging polygons across tiles ...");
-    while(firstFeature.addr())
+    if(!IsParameterEnabled("streamed"))
       {
-      LabelImagePixelType curLabel = firstFeature.ogr().GetFieldAsInteger("label");
+      //Vectorization per tile
+      otbAppLogINFO(<<"Vectorization ...");
+      for(unsigned int row = 0; row < nbTilesY; row++)
+        {
+        for(unsigned int column = 0; column < nbTilesX; column++)
+          {
+          unsigned long startX = column*sizeTilesX;
+          unsigned long startY = row*sizeTilesY;
+          unsigned long sizeX = vcl_min(sizeTilesX,sizeImageX-startX);
+          unsigned long sizeY = vcl_min(sizeTilesY,sizeImageY-startY);
+
+          ExtractROIFilterType::Pointer labelImageROI = ExtractROIFilterType::New();
+          labelImageROI->SetInput(labelIn);
+          labelImageROI->SetStartX(startX);
+          labelImageROI->SetStartY(startY);
+          labelImageROI->SetSizeX(sizeX+1);
+          labelImageROI->SetSizeY(sizeY+1);
+          labelImageROI->Update();
+
+          //Raster->Vecteur conversion
+          LabelImageToOGRDataSourceFilterType::Pointer labelToOGR = LabelImageToOGRDataSourceFilterType::New();
+          labelToOGR->SetInput(labelImageROI->GetOutput());
+          labelToOGR->SetInputMask(labelImageROI->GetOutput());
+          labelToOGR->SetFieldName("label");
+          labelToOGR->Update();
+
+          otb::ogr::DataSource::ConstPointer ogrDSTmp = labelToOGR->GetOutput();
+          otb::ogr::Layer layerTmp = ogrDSTmp->GetLayerChecked(0);
+
+          otb::ogr::Layer::const_iterator featIt = layerTmp.begin();
+          for(; featIt!=layerTmp.end(); ++featIt)
+            {
+            otb::ogr::Feature dstFeature(layer.GetLayerDefn());
+            dstFeature.SetFrom( *featIt, TRUE );
+            layer.CreateFeature( dstFeature );
+            }
+          }
+        }
 
-      //Creation of a multipolygon where are stored the geometries to be merged
-      OGRMultiPolygon geomToMerge;
-      geomToMerge.addGeometry(firstFeature.GetGeometry());
-      bool merging = true;
-      otb::ogr::Feature nextFeature(ITK_NULLPTR);
-      bool haveMerged=false;
+      //Sorting by increasing label of the features
+      std::ostringstream sqloss;
+      sqloss.str("");
+      sqloss<<"SELECT * FROM \""<<layername<<"\" ORDER BY label";
+      otb::ogr::Layer layerTmp=ogrDS->ExecuteSQL(sqloss.str().c_str(), ITK_NULLPTR, ITK_NULLPTR);
+      otb::ogr::Feature firstFeature = layerTmp.ogr().GetNextFeature();
 
-      while(merging)
+      //Geometry fusion
+      otbAppLogINFO("Merging polygons across tiles ...");
+      while(firstFeature.addr())
         {
-        nextFeature = layerTmp.ogr().GetNextFeature();
+        LabelImagePixelType curLabel = firstFeature.ogr().GetFieldAsInteger("label");
+
+        //Creation of a multipolygon where are stored the geometries to be merged
+        OGRMultiPolygon geomToMerge;
+        geomToMerge.addGeometry(firstFeature.GetGeometry());
+        bool merging = true;
+        otb::ogr::Feature nextFeature(ITK_NULLPTR);
+        bool haveMerged=false;
 
-        if(nextFeature.addr())
+        while(merging)
           {
-          LabelImagePixelType newLabel = nextFeature.ogr().GetFieldAsInteger("label");
-          merging=(newLabel==curLabel);
+          nextFeature = layerTmp.ogr().GetNextFeature();
 
-          //Storing of the new geometry if labels are identical
-          if(merging)
+          if(nextFeature.addr())
             {
-            geomToMerge.addGeometry(nextFeature.GetGeometry());
-            layer.DeleteFeature(nextFeature.GetFID());
-            haveMerged=true;
+            LabelImagePixelType newLabel = nextFeature.ogr().GetFieldAsInteger("label");
+            merging=(newLabel==curLabel);
+
+            //Storing of the new geometry if labels are identical
+            if(merging)
+              {
+              geomToMerge.addGeometry(nextFeature.GetGeometry());
+              layer.DeleteFeature(nextFeature.GetFID());
+              haveMerged=true;
+              }
+            //If storing made and new label -> polygons fusion
+            else if(haveMerged)
+              {
+              otb::ogr::UniqueGeometryPtr fusionPolygon = otb::ogr::UnionCascaded(geomToMerge);
+              firstFeature.SetGeometry(fusionPolygon.get());
+              }
             }
-          //If storing made and new label -> polygons fusion
-          else if(haveMerged)
+          //If end of list : end of loop
+          else
             {
-            otb::ogr::UniqueGeometryPtr fusionPolygon = otb::ogr::UnionCascaded(geomToMerge);
-            firstFeature.SetGeometry(fusionPolygon.get());
+            merging=false;
             }
           }
-        //If end of list : end of loop
+
+        SetFeatureFields(firstFeature, curLabel, nbPixels, sum, sum2);
+        layer.SetFeature(firstFeature);
+
+        //Next geometry
+        firstFeature=nextFeature;
+        }
+
+      const OGRErr err = layer.ogr().CommitTransaction();
+
+      if (err != OGRERR_NONE)
+      {
+      itkExceptionMacro(<< "Unable to commit transaction for OGR layer " << layer.ogr().GetName() << ".");
+      }
+
+      if(extension==".shp"){
+      sqloss.str("");
+      sqloss<<"REPACK "<<layername;
+      ogrDS->ogr().ExecuteSQL(sqloss.str().c_str(), ITK_NULLPTR, ITK_NULLPTR);
+      }
+      }
+    else
+      {
+      //Raster->Vector conversion: polygons crossing tiles are closed while
+      //streaming, so that no fusion of polygons is needed afterwards
+      StreamingLabelImageToOGRLayerFilterType::Pointer labelToOGR = StreamingLabelImageToOGRLayerFilterType::New();
+      labelToOGR->SetInput(labelIn);
+      labelToOGR->SetInputMask(labelIn);
+      labelToOGR->SetOGRLayer(layer);
+      labelToOGR->SetFieldName("label");
+      labelToOGR->GetStreamer()->SetTileDimensionTiledStreaming(vcl_max(sizeTilesX,sizeTilesY));
+      labelToOGR->Initialize();
+      AddProcess(labelToOGR->GetStreamer(), "Vectorization ...");
+      labelToOGR->Update();
+
+      otbAppLogINFO(<<labelToOGR->GetNumberOfPolygons()<<" polygons written");
+
+      //Segments made of several connected components are written as several
+      //features: gather them so that there is one feature per label. The
+      //components of a label share no edge, so that they are valid parts of a
+      //multipolygon without any union.
+      std::vector<long> firstFID(regionCount+1, -1);
+      std::map<LabelImagePixelType, std::vector<long> > otherFIDs;
+
+      for(otb::ogr::Layer::const_iterator cFeatIt = layer.cbegin(); cFeatIt!=layer.cend(); ++cFeatIt)
+        {
+        LabelImagePixelType curLabel = cFeatIt->ogr().GetFieldAsInteger("label");
+        if (firstFID[curLabel] < 0)
+          {
+          firstFID[curLabel] = cFeatIt->GetFID();
+          }
         else
           {
-          merging=false;
+          otherFIDs[curLabel].push_back(cFeatIt->GetFID());
           }
         }
 
-      //Features calculation
-      //Number of pixels per label
-      firstFeature.ogr().SetField("nbPixels",nbPixels[curLabel]);
-
-      //Radiometric means per label
-      for(unsigned int comp = 0; comp<numberOfComponentsPerPixel; ++comp){
-      std::ostringstream fieldoss;
-      fieldoss<<"meanB"<<comp;
-      firstFeature.ogr().SetField(fieldoss.str().c_str(),sum[curLabel][comp]/nbPixels[curLabel]);
-      }
+      for(std::map<LabelImagePixelType, std::vector<long> >::const_iterator labelIt = otherFIDs.begin();
+          labelIt != otherFIDs.end(); ++labelIt)
+        {
+        otb::ogr::Feature firstFeature = layer.GetFeature(firstFID[labelIt->first]);
 
-      //Variances per label
-      for(unsigned int comp = 0; comp<numberOfComponentsPerPixel; ++comp){
-      std::ostringstream fieldoss;
-      fieldoss<<"varB"<<comp;
-      float var = 0;
-      if (nbPixels[curLabel]!=1)
-        var = (sum2[curLabel][comp]-sum[curLabel][comp]*sum[curLabel][comp]/nbPixels[curLabel])/(nbPixels[curLabel]-1);
-      firstFeature.ogr().SetField(fieldoss.str().c_str(),var);
-      }
+        OGRMultiPolygon components;
+        AddPolygons(*firstFeature.GetGeometry(), components);
+        for(std::vector<long>::const_iterator fidIt = labelIt->second.begin(); fidIt != labelIt->second.end(); ++fidIt)
+          {
+          otb::ogr::Feature nextFeature = layer.GetFeature(*fidIt);
+          AddPolygons(*nextFeature.GetGeometry(), components);
+          layer.DeleteFeature(*fidIt);
+          }
 
-      //Geometries simplification
-      otb::ogr::UniqueGeometryPtr geom = otb::ogr::Simplify(*firstFeature.GetGeometry(),0);
-      firstFeature.SetGeometryDirectly(otb::ogr::Simplify(*geom,0));
+        firstFeature.SetGeometry(&components);
+        layer.SetFeature(firstFeature);
+        }
 
-      layer.SetFeature(firstFeature);
+      //Features calculation
+      OGRErr err = layer.ogr().StartTransaction();
 
-      //Next geometry
-      firstFeature=nextFeature;
+      if (err != OGRERR_NONE)
+      {
+      itkExceptionMacro(<< "Unable to start transaction for OGR layer " << layer.ogr().GetName() << ".");
       }
 
-    const OGRErr err = layer.ogr().CommitTransaction();
+      otb::ogr::Layer::iterator featIt = layer.begin();
+      for(; featIt!=layer.end(); ++featIt)
+        {
+        SetFeatureFields(*featIt, featIt->ogr().GetFieldAsInteger("label"), nbPixels, sum, sum2);
+        layer.SetFeature(*featIt);
+        }
 
-    if (err != OGRERR_NONE)
-    {
-    itkExceptionMacro(<< "Unable to commit transaction for OGR layer " << layer.ogr().GetName() << ".");
-    }
+      err = layer.ogr().CommitTransaction();
 
-    if(extension==".shp"){
-    sqloss.str("");
-    sqloss<<"REPACK "<<layername;
-    ogrDS->ogr().ExecuteSQL(sqloss.str().c_str(), ITK_NULLPTR, ITK_NULLPTR);
-    }
+      if (err != OGRERR_NONE)
+      {
+      itkExceptionMacro(<< "Unable to commit transaction for OGR layer " << layer.ogr().GetName() << ".");
+      }
+
+      if(extension==".shp" && !otherFIDs.empty()){
+      std::ostringstream sqloss;
+      sqloss<<"REPACK "<<layername;
+      ogrDS->ogr().ExecuteSQL(sqloss.str().c_str(), ITK_NULLPTR, ITK_NULLPTR);
+      }
+      }
 
     ogrDS->SyncToDisk();
 
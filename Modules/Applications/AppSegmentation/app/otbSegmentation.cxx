@@ -38,6 +38,10 @@
 // Fusion filter
 #include "otbOGRLayerStreamStitchingFilter.h"
 
+// Seamless label image from tiled segmentation
+#include "otbStreamingStatisticsImageFilter.h"
+#include "otbOGRDataSourceToLabelImageFilter.h"
+
 #include "otbGeoInformationConversion.h"
 #include "otbClampImageFilter.h"
 
@@ -132,6 +136,9 @@ public:
 
   typedef otb::ClampImageFilter<FloatImageType, UInt32ImageType> ClampFilterType;
 
+  typedef otb::StreamingStatisticsImageFilter<FloatImageType>     StatisticsFilterType;
+  typedef otb::OGRDataSourceToLabelImageFilter<UInt32ImageType>   RasterizeFilterType;
+
   /** Standard macro */
   itkNewMacro(Self);
   itkTypeMacro(Segmentation, otb::Application);
@@ -157,7 +164,7 @@ private:
                           " (i.e. remove nodes in polygons) according to a user-defined tolerance. The stitch option tries to stitch together the polygons corresponding"
                           " to segmented region that may have been split by the tiling scheme. ");
 
-    SetDocLimitations("In raster mode, the application can not handle large input images. Stitching step of vector mode might become slow with very large input images."
+    SetDocLimitations("In raster mode, the application can not handle large input images, unless the watershed segmentation is done by overlapping tiles. Stitching step of vector mode might become slow with very large input images."
                      " \nMeanShift filter results depends on the number of threads used. \nWatershed and multiscale geodesic morphology segmentation will be performed on the amplitude "
                      " of the input image.");
 
@@ -259,6 +266,20 @@ private:
     SetParameterDescription( "mode.raster.out", "The output labeled image.");
     SetDefaultOutputPixelType("mode.raster.out",ImagePixelType_uint32);
 
+    AddParameter(ParameterType_Int, "mode.raster.tileoverlap", "Tiles overlap");
+    SetParameterDescription("mode.raster.tileoverlap",
+                            "Only used with the watershed segmentation. If not null, the image is segmented by tiles with a margin of this size (in pixels), segments crossing tile borders are merged, and the labeled image is rasterized from the merged polygons, so that large images can be processed. The polygons are written in a temporary Shapefile next to the output image (with the _polygons suffix), removed once the output image is written.");
+    SetDefaultParameterInt("mode.raster.tileoverlap", 0);
+    SetMinimumParameterIntValue("mode.raster.tileoverlap", 0);
+    MandatoryOff("mode.raster.tileoverlap");
+
+    AddParameter(ParameterType_Int, "mode.raster.tilesize", "Tiles size");
+    SetParameterDescription("mode.raster.tilesize",
+                            "Size of the tiles segmented in parallel when the tiles overlap is not null.");
+    SetDefaultParameterInt("mode.raster.tilesize", 1024);
+    SetMinimumParameterIntValue("mode.raster.tilesize", 16);
+    MandatoryOff("mode.raster.tilesize");
+
     //Streaming vectorization parameters
     AddParameter(ParameterType_OutputFilename, "mode.vector.out", "Output vector file");
     SetParameterDescription("mode.vector.out", "The output vector file or database (name can be anything understood by OGR)");
@@ -294,6 +315,11 @@ private:
     MandatoryOff("mode.vector.stitch");
     EnableParameter("mode.vector.stitch");
 
+    AddParameter(ParameterType_Empty,"mode.vector.parallelstitch","Stitch stream lines in parallel");
+    SetParameterDescription("mode.vector.parallelstitch", "Stitch each stream line at once, with all available threads. Polygons fused along a stream line are merged together, so that the result may slightly differ from the default sequential stitching, but does not depend on the number of threads.");
+    MandatoryOff("mode.vector.parallelstitch");
+    DisableParameter("mode.vector.parallelstitch");
+
     AddParameter(ParameterType_Int, "mode.vector.minsize", "Minimum object size");
     SetParameterDescription("mode.vector.minsize",
                             "Objects whose size is below the minimum object size (area in pixels) will be ignored during vectorization.");
@@ -323,6 +349,13 @@ private:
     SetDefaultParameterInt("mode.vector.tilesize",1024);
     SetMinimumParameterIntValue("mode.vector.tilesize",0);
 
+    AddParameter(ParameterType_Int, "mode.vector.tileoverlap", "Tiles overlap");
+    SetParameterDescription("mode.vector.tileoverlap",
+                            "Only used with the watershed segmentation. Margin (in pixels) added around each tile for segmentation. If not null, tiles are segmented in parallel with the threshold and level computed on the whole image, segments on both sides of tile borders are merged when the saliency of their lowest pass is below the flood level, and their polygons are dissolved, so that stitching is not needed. The image is then streamed according to the available RAM, and the tiles size parameter sets the size of the tiles segmented in parallel.");
+    SetDefaultParameterInt("mode.vector.tileoverlap", 0);
+    SetMinimumParameterIntValue("mode.vector.tileoverlap", 0);
+    MandatoryOff("mode.vector.tileoverlap");
+
     AddParameter(ParameterType_Int, "mode.vector.startlabel", "Starting geometry index");
     SetParameterDescription("mode.vector.startlabel", "Starting value of the geometry index field");
     SetDefaultParameterInt("mode.vector.startlabel", 1);
@@ -353,6 +386,21 @@ private:
     // Nothing to do here : all parameters are independent
   }
 
+  /** Overlap of the tiles segmented with seams merging, 0 if the
+   * segmentation is not done by overlapping tiles */
+  unsigned int GetTileOverlap()
+  {
+    if (GetParameterString("filter") != "watershed")
+      {
+      return 0;
+      }
+    if (GetParameterString("mode") == "vector")
+      {
+      return static_cast<unsigned int>(GetParameterInt("mode.vector.tileoverlap"));
+      }
+    return static_cast<unsigned int>(GetParameterInt("mode.raster.tileoverlap"));
+  }
+
   template<class TInputImage, class TSegmentationFilter>
   FloatVectorImageType::SizeType
   GenericApplySegmentation(
@@ -372,6 +420,10 @@ private:
     // Switch on segmentation mode
     const std::string segModeType = GetParameterString("mode");
 
+    // Overlapping tiles are vectorized in both modes
+    const unsigned int tileOverlap = this->GetTileOverlap();
+    const bool vectorize = segModeType == "vector" || tileOverlap > 0;
+
     streamingVectorizedFilter->SetInput(inputImage);
 
     if (segModeType == "vector" && HasValue("mode.vector.inmask"))
@@ -381,7 +433,16 @@ private:
       }
     streamingVectorizedFilter->SetOGRLayer(layer);
 
-    if (tileSize != 0)
+    if (tileOverlap > 0)
+      {
+      // Pieces are cut into tiles segmented in parallel
+      otbAppLogINFO(<<"Use overlapping tiles with a margin of "<< tileOverlap <<" pixels."<<std::endl);
+      streamingVectorizedFilter->SetTileOverlap(tileOverlap);
+      streamingVectorizedFilter->SetTileSize(segModeType == "vector" ? tileSize
+                                             : static_cast<unsigned int>(this->GetParameterInt("mode.raster.tilesize")));
+      streamingVectorizedFilter->GetStreamer()->SetAutomaticStrippedStreaming();
+      }
+    else if (tileSize != 0)
       {
       streamingVectorizedFilter->GetStreamer()->SetTileDimensionTiledStreaming(tileSize);
       }
@@ -422,13 +483,10 @@ private:
       streamingVectorizedFilter->SetSimplify(false);
       }
 
-    if (segModeType == "vector")
+    if (vectorize)
       {
       otbAppLogINFO(<<"Large scale segmentation mode which output vector data" << std::endl);
 
-      DisableParameter("mode.raster.out");
-      EnableParameter("mode.vector.out");
-
       AddProcess(streamingVectorizedFilter->GetStreamer(), "Computing "
         + this->GetParameterString("filter")
         + " segmentation");
@@ -471,8 +529,18 @@ private:
 
     OGRSpatialReference oSRS(projRef.c_str());
 
+    const unsigned int tileOverlap = this->GetTileOverlap();
+    if (tileOverlap == 0 && segType != "watershed"
+        && GetParameterInt(segModeType == "vector" ? "mode.vector.tileoverlap" : "mode.raster.tileoverlap") > 0)
+      {
+      otbAppLogWARNING(<<"Tiles overlap is only used with the watershed segmentation, it is ignored.");
+      }
+
     if (segModeType == "vector")
       {
+      DisableParameter("mode.raster.out");
+      EnableParameter("mode.vector.out");
+
       // Retrieve output filename as well as layer names
       std::string dataSourceName = GetParameterString("mode.vector.out");
 
@@ -551,6 +619,32 @@ private:
         otbAppLogFATAL(<<"outmode not handled yet: "<< outmode);
         }
       }
+    else
+      {
+      DisableParameter("mode.vector.out");
+      EnableParameter("mode.raster.out");
+
+      if (tileOverlap > 0)
+        {
+        // Polygons of the tiled segmentation are streamed to a temporary
+        // Shapefile next to the output image, to be rasterized in the output
+        // labeled image. It is removed once the output is written.
+        std::string outName = GetParameterString("mode.raster.out");
+        outName = outName.substr(0, outName.find('?'));
+        m_PolygonsFileName = itksys::SystemTools::GetFilenamePath(outName);
+        if (!m_PolygonsFileName.empty())
+          {
+          m_PolygonsFileName += "/";
+          }
+        m_PolygonsFileName += itksys::SystemTools::GetFilenameWithoutExtension(outName) + "_polygons.shp";
+
+        ogrDS = otb::ogr::DataSource::New(m_PolygonsFileName, otb::ogr::DataSource::Modes::Overwrite);
+        layer = ogrDS->CreateLayer(itksys::SystemTools::GetFilenameWithoutExtension(m_PolygonsFileName),
+                                   &oSRS, wkbMultiPolygon);
+        OGRFieldDefn field(this->GetParameterString("mode.vector.fieldname").c_str(), OFTInteger);
+        layer.CreateField(field, true);
+        }
+      }
 
     // handle mask
     if (HasValue("mode.vector.inmask"))
@@ -629,6 +723,24 @@ private:
         GetParameterFloat("filter.watershed.threshold"));
       watershedVectorizedFilter->GetSegmentationFilter()->SetLevel(GetParameterFloat("filter.watershed.level"));
 
+      if (tileOverlap > 0)
+        {
+        // Threshold and level are relative to the gradient range of the
+        // whole image, not of each tile
+        StatisticsFilterType::Pointer statisticsFilter = StatisticsFilterType::New();
+        statisticsFilter->SetInput(gradientMagnitudeFilter->GetOutput());
+        AddProcess(statisticsFilter->GetStreamer(), "Computing gradient range");
+        statisticsFilter->Update();
+
+        const double minimum = statisticsFilter->GetMinimum();
+        const double maximum = statisticsFilter->GetMaximum();
+        otbAppLogINFO(<<"Gradient range: [" << minimum << ", " << maximum << "]");
+
+        watershedVectorizedFilter->GetSegmentationFilter()->SetInputMinimum(minimum);
+        watershedVectorizedFilter->GetSegmentationFilter()->SetInputMaximum(maximum);
+        watershedVectorizedFilter->SetSeamMergeLevel(GetParameterFloat("filter.watershed.level") * (maximum - minimum));
+        }
+
       streamSize = this->GenericApplySegmentation<FloatImageType,WatershedSegmentationFilterType>(
         watershedVectorizedFilter,
         gradientMagnitudeFilter->GetOutput(),
@@ -672,8 +784,8 @@ private:
 
       ogrDS->SyncToDisk();
 
-      // Stitching mode
-      if (IsParameterEnabled("mode.vector.stitch"))
+      // Stitching mode (polygons are already merged across tiles with overlapping tiles)
+      if (IsParameterEnabled("mode.vector.stitch") && tileOverlap == 0)
         {
         otbAppLogINFO(<<"Segmentation done, stiching polygons ...");
 
@@ -681,6 +793,7 @@ private:
         fusionFilter->SetInput(GetParameterFloatVectorImage("in"));
         fusionFilter->SetOGRLayer(layer);
         fusionFilter->SetStreamSize(streamSize);
+        fusionFilter->SetParallelStitching(IsParameterEnabled("mode.vector.parallelstitch"));
 
         AddProcess(fusionFilter, "Stitching polygons");
         fusionFilter->GenerateData();
@@ -703,9 +816,44 @@ private:
           }
         }
       }
+    else if (tileOverlap > 0)
+      {
+      otbAppLogINFO(<<"Segmentation done, rasterizing polygons ...");
+
+      ogrDS->SyncToDisk();
+      m_PolygonsDataSource = ogrDS;
+      m_RasterizeFilter = RasterizeFilterType::New();
+      m_RasterizeFilter->AddOGRDataSource(m_PolygonsDataSource);
+      m_RasterizeFilter->SetOutputParametersFromImage(GetParameterFloatVectorImage("in"));
+      m_RasterizeFilter->SetBurnAttribute(GetParameterString("mode.vector.fieldname"));
+      m_RasterizeFilter->SetBackgroundValue(0);
+
+      SetParameterOutputImage<UInt32ImageType>("mode.raster.out", m_RasterizeFilter->GetOutput());
+      }
+  }
+
+  void AfterExecuteAndWriteOutputs() ITK_OVERRIDE
+  {
+    // Release and remove the temporary polygons of the tiled segmentation
+    m_RasterizeFilter = ITK_NULLPTR;
+    m_PolygonsDataSource = ITK_NULLPTR;
+
+    if (!m_PolygonsFileName.empty())
+      {
+      const std::string baseName = m_PolygonsFileName.substr(0, m_PolygonsFileName.size() - 4);
+      const char * extensions[] = {".shp", ".shx", ".dbf", ".prj"};
+      for (unsigned int i = 0; i < 4; ++i)
+        {
+        itksys::SystemTools::RemoveFile((baseName + extensions[i]).c_str());
+        }
+      m_PolygonsFileName.clear();
+      }
   }
 
   ClampFilterType::Pointer m_ClampFilter;
+  otb::ogr::DataSource::Pointer m_PolygonsDataSource;
+  RasterizeFilterType::Pointer m_RasterizeFilter;
+  std::string m_PolygonsFileName;
 };
 }
 }
@@ -27,6 +27,7 @@
 #include "otbImageListToVectorImageFilter.h"
 
 #include "otbSubPixelDisparityImageFilter.h"
+#include "otbSemiGlobalMatchingImageFilter.h"
 #include "otbDisparityMapMedianFilter.h"
 
 namespace otb
@@ -65,6 +66,11 @@ public:
                                                            FloatImageType,
                                                            LPBlockMatchingFunctorType> LPBlockMatchingFilterType;
 
+  typedef otb::SemiGlobalMatchingImageFilter<FloatImageType,
+                                             FloatImageType,
+                                             FloatImageType,
+                                             FloatImageType> SemiGlobalMatchingFilterType;
+
   typedef otb::VarianceImageFilter<FloatImageType,FloatImageType> VarianceFilterType;
 
 
@@ -111,6 +117,7 @@ private:
     m_SSDBlockMatcher = SSDBlockMatchingFilterType::New();
     m_NCCBlockMatcher = NCCBlockMatchingFilterType::New();
     m_LPBlockMatcher  = LPBlockMatchingFilterType::New();
+    m_SemiGlobalMatcher = SemiGlobalMatchingFilterType::New();
     m_SSDSubPixFilter = SSDSubPixelDisparityFilterType::New();
     m_NCCSubPixFilter = NCCSubPixelDisparityFilterType::New();
     m_LPSubPixFilter  = LPSubPixelDisparityFilterType::New();
@@ -149,7 +156,14 @@ private:
       "  * SSD : Sum of Squared Distances\n"
       "  * NCC : Normalized Cross-Correlation\n"
       "  * Lp  : Lp pseudo norm\n"
-      "\n"                    
+      "\n"
+      "Instead of the local winner-take-all approach, horizontal disparities "
+      "can be estimated with Semi-Global Matching, which aggregates census or "
+      "SSD matching costs along several paths across the image. It gives "
+      "denser and smoother disparities on low-texture areas. Vertical "
+      "disparities, the computation step and initial disparities are not used "
+      "in this mode, and sub-pixel interpolation is done with the SSD metric.\n"
+      "\n"
       "Once the best integer disparity is found, an optional step of sub-pixel "
       "disparity estimation can be performed, with various algorithms "
       "(triangular interpolation, parabollic interpolation, dichotimic search)."
@@ -247,6 +261,56 @@ private:
     SetParameterDescription("bm","This group of parameters allow tuning the "
       "block-matching behaviour");
 
+    AddParameter(ParameterType_Choice, "bm.method", "Disparity estimation method");
+    SetParameterDescription("bm.method", "Method used to select the disparity "
+      "of each pixel.");
+
+    AddChoice("bm.method.wta", "Winner-take-all");
+    SetParameterDescription("bm.method.wta", "The disparity of each pixel is "
+      "the one optimizing the block-matching metric.");
+
+    AddChoice("bm.method.sgm", "Semi-Global Matching");
+    SetParameterDescription("bm.method.sgm", "The matching costs are aggregated"
+      " along several paths, with penalties on disparity changes, before "
+      "selecting the disparity of each pixel. The block-matching metric is not "
+      "used.");
+
+    AddParameter(ParameterType_Choice, "bm.method.sgm.cost", "Matching cost");
+    SetParameterDescription("bm.method.sgm.cost", "Pixel-wise matching cost, "
+      "evaluated on blocks of the given radius.");
+
+    AddChoice("bm.method.sgm.cost.census", "Census");
+    SetParameterDescription("bm.method.sgm.cost.census", "Hamming distance "
+      "between the census transforms of the blocks (blocks are limited to 65 "
+      "pixels, i.e. a radius of 3).");
+
+    AddChoice("bm.method.sgm.cost.ssd", "SSD");
+    SetParameterDescription("bm.method.sgm.cost.ssd", "Root mean square "
+      "difference between the blocks, saturated to 255.");
+
+    AddParameter(ParameterType_Int, "bm.method.sgm.p1", "Small disparity change penalty");
+    SetParameterDescription("bm.method.sgm.p1", "Penalty of disparity changes "
+      "of one pixel between neighbors.");
+    SetDefaultParameterInt("bm.method.sgm.p1", 4);
+    SetMinimumParameterIntValue("bm.method.sgm.p1", 0);
+
+    AddParameter(ParameterType_Int, "bm.method.sgm.p2", "Large disparity change penalty");
+    SetParameterDescription("bm.method.sgm.p2", "Penalty of disparity changes "
+      "of more than one pixel between neighbors.");
+    SetDefaultParameterInt("bm.method.sgm.p2", 32);
+    SetMinimumParameterIntValue("bm.method.sgm.p2", 0);
+
+    AddParameter(ParameterType_Int, "bm.method.sgm.paths", "Number of paths");
+    SetParameterDescription("bm.method.sgm.paths", "Number of aggregation "
+      "paths (4, 8 or 16).");
+    SetDefaultParameterInt("bm.method.sgm.paths", 8);
+
+    AddParameter(ParameterType_Int, "bm.method.sgm.overlap", "Aggregation overlap");
+    SetParameterDescription("bm.method.sgm.overlap", "Distance (in pixels) "
+      "around each processed tile from which the aggregation paths start.");
+    SetDefaultParameterInt("bm.method.sgm.overlap", 32);
+    SetMinimumParameterIntValue("bm.method.sgm.overlap", 0);
+
     AddParameter(ParameterType_Choice,   "bm.metric", "Block-matching metric");
     SetParameterDescription("bm.metric",
       "Metric to evaluate matching between two local windows.");
@@ -269,6 +333,14 @@ private:
     SetDefaultParameterFloat("bm.metric.lp.p", 1.0);
     SetMinimumParameterFloatValue("bm.metric.lp.p", 0.0);
 
+    AddParameter(ParameterType_Empty,"bm.costvolume","Cost volume evaluation");
+    SetParameterDescription("bm.costvolume","If enabled, the metric is "
+      "evaluated from block sums computed once per disparity over the whole "
+      "tile, instead of a neighborhood per pixel and disparity. It is faster "
+      "for large blocks, but floating point rounding may differ slightly, "
+      "which can change the disparity of pixels where two disparities tie.");
+    MandatoryOff("bm.costvolume");
+
     AddParameter(ParameterType_Int,"bm.radius","Radius of blocks");
     SetParameterDescription("bm.radius","The radius (in pixels) of blocks in Block-Matching");
     SetDefaultParameterInt("bm.radius",3);
@@ -611,8 +683,88 @@ private:
     maskLeftImage = m_LBandMathFilter->GetOutput();
     maskRightImage = m_RBandMathFilter->GetOutput();
 
+    // Semi-Global Matching case
+    if (GetParameterInt("bm.method") == 1)
+      {
+      if (minvdisp != 0 || maxvdisp != 0 || step != 1 || useInitialDispUniform || useInitialDispMap)
+        {
+        otbAppLogWARNING(<<"Vertical disparities, computation step and initial disparities are not used by Semi-Global Matching");
+        }
+
+      m_SemiGlobalMatcher->SetLeftInput(leftImage);
+      m_SemiGlobalMatcher->SetRightInput(rightImage);
+      m_SemiGlobalMatcher->SetRadius(radius);
+      m_SemiGlobalMatcher->SetMinimumHorizontalDisparity(minhdisp);
+      m_SemiGlobalMatcher->SetMaximumHorizontalDisparity(maxhdisp);
+      if (GetParameterInt("bm.method.sgm.cost") == 0)
+        {
+        m_SemiGlobalMatcher->SetMatchingCost(SemiGlobalMatchingFilterType::CENSUS);
+        }
+      else
+        {
+        m_SemiGlobalMatcher->SetMatchingCost(SemiGlobalMatchingFilterType::SSD);
+        }
+      m_SemiGlobalMatcher->SetP1(GetParameterInt("bm.method.sgm.p1"));
+      m_SemiGlobalMatcher->SetP2(GetParameterInt("bm.method.sgm.p2"));
+      m_SemiGlobalMatcher->SetNumberOfPaths(GetParameterInt("bm.method.sgm.paths"));
+      m_SemiGlobalMatcher->SetOverlap(GetParameterInt("bm.method.sgm.overlap"));
+
+      AddProcess(m_SemiGlobalMatcher,"Semi-Global Matching");
+
+      if(maskingLeft)
+        {
+        m_SemiGlobalMatcher->SetLeftMaskInput(maskLeftImage);
+        }
+      if(maskingRight)
+        {
+        m_SemiGlobalMatcher->SetRightMaskInput(maskRightImage);
+        }
+
+      if (GetParameterInt("bm.subpixel") > 0)
+        {
+        m_SSDSubPixFilter->SetLeftInput(leftImage);
+        m_SSDSubPixFilter->SetRightInput(rightImage);
+        m_SSDSubPixFilter->SetRadius(radius);
+        m_SSDSubPixFilter->SetMinimumHorizontalDisparity(minhdisp);
+        m_SSDSubPixFilter->SetMaximumHorizontalDisparity(maxhdisp);
+        m_SSDSubPixFilter->SetMinimumVerticalDisparity(0);
+        m_SSDSubPixFilter->SetMaximumVerticalDisparity(0);
+        m_SSDSubPixFilter->MinimizeOn();
+        m_SSDSubPixFilter->SetHorizontalDisparityInput(m_SemiGlobalMatcher->GetHorizontalDisparityOutput());
+        m_SSDSubPixFilter->SetVerticalDisparityInput(m_SemiGlobalMatcher->GetVerticalDisparityOutput());
+        m_SSDSubPixFilter->SetMetricInput(m_SemiGlobalMatcher->GetMetricOutput());
+        if(maskingLeft)
+          {
+          m_SSDSubPixFilter->SetLeftMaskInput(maskLeftImage);
+          }
+        if(maskingRight)
+          {
+          m_SSDSubPixFilter->SetRightMaskInput(maskRightImage);
+          }
+        AddProcess(m_SSDSubPixFilter,"Sub-pixel refinement");
+        switch (GetParameterInt("bm.subpixel"))
+          {
+          case 1 : m_SSDSubPixFilter->SetRefineMethod(SSDSubPixelDisparityFilterType::PARABOLIC);
+            break;
+          case 2 : m_SSDSubPixFilter->SetRefineMethod(SSDSubPixelDisparityFilterType::TRIANGULAR);
+            break;
+          case 3 : m_SSDSubPixFilter->SetRefineMethod(SSDSubPixelDisparityFilterType::DICHOTOMY);
+            break;
+          default : break;
+          }
+        hdispImage = m_SSDSubPixFilter->GetHorizontalDisparityOutput();
+        vdispImage = m_SSDSubPixFilter->GetVerticalDisparityOutput();
+        metricImage = m_SSDSubPixFilter->GetMetricOutput();
+        }
+      else
+        {
+        hdispImage = m_SemiGlobalMatcher->GetHorizontalDisparityOutput();
+        vdispImage = m_SemiGlobalMatcher->GetVerticalDisparityOutput();
+        metricImage = m_SemiGlobalMatcher->GetMetricOutput();
+        }
+      }
     // SSD case
-    if(GetParameterInt("bm.metric") == 0)
+    else if(GetParameterInt("bm.metric") == 0)
       {
       m_SSDBlockMatcher->SetLeftInput(leftImage);
       m_SSDBlockMatcher->SetRightInput(rightImage);
@@ -623,6 +775,7 @@ private:
       m_SSDBlockMatcher->SetMaximumHorizontalDisparity(maxhdisp);
       m_SSDBlockMatcher->SetMinimumVerticalDisparity(minvdisp);
       m_SSDBlockMatcher->SetMaximumVerticalDisparity(maxvdisp);
+      m_SSDBlockMatcher->SetCostVolume(IsParameterEnabled("bm.costvolume"));
 
       AddProcess(m_SSDBlockMatcher,"SSD block matching");
       if(maskingLeft)
@@ -689,6 +842,7 @@ private:
       m_NCCBlockMatcher->SetMaximumHorizontalDisparity(maxhdisp);
       m_NCCBlockMatcher->SetMinimumVerticalDisparity(minvdisp);
       m_NCCBlockMatcher->SetMaximumVerticalDisparity(maxvdisp);
+      m_NCCBlockMatcher->SetCostVolume(IsParameterEnabled("bm.costvolume"));
       m_NCCBlockMatcher->MinimizeOff();
 
       AddProcess(m_NCCBlockMatcher,"NCC block matching");
@@ -758,6 +912,7 @@ private:
       m_LPBlockMatcher->SetMaximumHorizontalDisparity(maxhdisp);
       m_LPBlockMatcher->SetMinimumVerticalDisparity(minvdisp);
       m_LPBlockMatcher->SetMaximumVerticalDisparity(maxvdisp);
+      m_LPBlockMatcher->SetCostVolume(IsParameterEnabled("bm.costvolume"));
 
       AddProcess(m_LPBlockMatcher,"Lp block matching");
 
@@ -872,6 +1027,9 @@ private:
   // Lp Block matching filter
   LPBlockMatchingFilterType::Pointer  m_LPBlockMatcher;
 
+  // Semi-Global Matching filter
+  SemiGlobalMatchingFilterType::Pointer m_SemiGlobalMatcher;
+
   // SSD sub-pixel disparity filter
   SSDSubPixelDisparityFilterType::Pointer m_SSDSubPixFilter;
 
@@ -24,6 +24,7 @@
 #include "otbStreamingWarpImageFilter.h"
 #include "otbBandMathImageFilter.h"
 #include "otbSubPixelDisparityImageFilter.h"
+#include "otbSemiGlobalMatchingImageFilter.h"
 #include "otbDisparityMapMedianFilter.h"
 #include "otbDisparityMapToDEMFilter.h"
 #include "otbDisparityMapTo3DFilter.h"
@@ -164,6 +165,12 @@ public:
      FloatImageType,
      NCCBlockMatchingFunctorType>             NCCSubPixelFilterType;
 
+  typedef otb::SemiGlobalMatchingImageFilter
+    <FloatImageType,
+     FloatImageType,
+     FloatImageType,
+     FloatImageType>                          SemiGlobalMatchingFilterType;
+
   typedef otb::DisparityMapMedianFilter
     <FloatImageType,
      FloatImageType,
@@ -325,7 +332,7 @@ private:
                           "\t- resample the stereo pair into epipolar geometry using BCO interpolation\n"
                           "\t- create masks for each epipolar image : remove black borders and resample"
                           " input masks\n"
-                          "\t- compute horizontal disparities with a block matching algorithm\n"
+                          "\t- compute horizontal disparities with a block matching algorithm, or with Semi-Global Matching\n"
                           "\t- refine disparities to sub-pixel precision with a dichotomy algorithm\n"
                           "\t- apply an optional median filter\n"
                           "\t- filter disparities based on the correlation score  and exploration bounds\n"
@@ -384,6 +391,7 @@ private:
     AddChoice("output.fusionmethod.min", "The cell is filled with the minimum measured elevation values");
     AddChoice("output.fusionmethod.mean","The cell is filled with the mean of measured elevation values");
     AddChoice("output.fusionmethod.acc", "accumulator mode. The cell is filled with the the number of values (for debugging purposes).");
+    AddChoice("output.fusionmethod.median","The cell is filled with the median of measured elevation values");
 
     AddParameter(ParameterType_OutputImage,"output.out","Output DSM");
     SetParameterDescription("output.out","Output elevation image");
@@ -434,6 +442,43 @@ private:
     AddParameter(ParameterType_Group,"bm","Block matching parameters");
     SetParameterDescription("bm","This group of parameters allow tuning the block-matching behavior");
 
+    AddParameter(ParameterType_Choice, "bm.method", "Disparity estimation method");
+    SetParameterDescription("bm.method", "Method used to select the disparity of each pixel");
+
+    AddChoice("bm.method.wta", "Winner-take-all");
+    SetParameterDescription("bm.method.wta", "The disparity of each pixel is the one optimizing the block-matching metric");
+
+    AddChoice("bm.method.sgm", "Semi-Global Matching");
+    SetParameterDescription("bm.method.sgm", "The matching costs are aggregated along several paths, with penalties on disparity changes, before selecting the disparity of each pixel. The block-matching metric is not used, disparities are refined with the SSD metric.");
+
+    AddParameter(ParameterType_Choice, "bm.method.sgm.cost", "Matching cost");
+    SetParameterDescription("bm.method.sgm.cost", "Pixel-wise matching cost, evaluated on blocks of radius bm.radius");
+
+    AddChoice("bm.method.sgm.cost.census", "Census");
+    SetParameterDescription("bm.method.sgm.cost.census", "Hamming distance between the census transforms of the blocks (blocks are limited to 65 pixels, i.e. a radius of 3)");
+
+    AddChoice("bm.method.sgm.cost.ssd", "SSD");
+    SetParameterDescription("bm.method.sgm.cost.ssd", "Root mean square difference between the blocks, saturated to 255");
+
+    AddParameter(ParameterType_Int, "bm.method.sgm.p1", "Small disparity change penalty");
+    SetParameterDescription("bm.method.sgm.p1", "Penalty of disparity changes of one pixel between neighbors");
+    SetDefaultParameterInt("bm.method.sgm.p1", 4);
+    SetMinimumParameterIntValue("bm.method.sgm.p1", 0);
+
+    AddParameter(ParameterType_Int, "bm.method.sgm.p2", "Large disparity change penalty");
+    SetParameterDescription("bm.method.sgm.p2", "Penalty of disparity changes of more than one pixel between neighbors");
+    SetDefaultParameterInt("bm.method.sgm.p2", 32);
+    SetMinimumParameterIntValue("bm.method.sgm.p2", 0);
+
+    AddParameter(ParameterType_Int, "bm.method.sgm.paths", "Number of paths");
+    SetParameterDescription("bm.method.sgm.paths", "Number of aggregation paths (4, 8 or 16)");
+    SetDefaultParameterInt("bm.method.sgm.paths", 8);
+
+    AddParameter(ParameterType_Int, "bm.method.sgm.overlap", "Aggregation overlap");
+    SetParameterDescription("bm.method.sgm.overlap", "Distance (in pixels) around each processed tile from which the aggregation paths start");
+    SetDefaultParameterInt("bm.method.sgm.overlap", 32);
+    SetMinimumParameterIntValue("bm.method.sgm.overlap", 0);
+
     AddParameter(ParameterType_Choice,   "bm.metric", "Block-matching metric");
     //SetDefaultParameterInt("bm.metric",3);
 
@@ -454,6 +499,10 @@ private:
     SetDefaultParameterFloat("bm.metric.lp.p", 1.0);
     SetMinimumParameterFloatValue("bm.metric.lp.p", 0.0);
 
+    AddParameter(ParameterType_Empty,"bm.costvolume","Cost volume evaluation");
+    SetParameterDescription("bm.costvolume","If enabled, the SSD, NCC and Lp metrics are evaluated from block sums computed once per disparity over the whole tile. It is faster for large blocks, but floating point rounding may differ slightly, which can change the disparity of pixels where two disparities tie");
+    MandatoryOff("bm.costvolume");
+
     AddParameter(ParameterType_Int,"bm.radius","Radius of blocks for matching filter (in pixels)");
     SetParameterDescription("bm.radius","The radius of blocks in Block-Matching (in pixels)");
     SetDefaultParameterInt("bm.radius",2);
@@ -557,6 +606,7 @@ private:
     blockMatcherFilter->SetMaximumHorizontalDisparity(maxDisp);
     blockMatcherFilter->SetMinimumVerticalDisparity(0);
     blockMatcherFilter->SetMaximumVerticalDisparity(0);
+    blockMatcherFilter->SetCostVolume(IsParameterEnabled("bm.costvolume"));
 
     if (minimize)
       {
@@ -575,6 +625,7 @@ private:
       invBlockMatcherFilter->SetMaximumHorizontalDisparity(-minDisp);
       invBlockMatcherFilter->SetMinimumVerticalDisparity(0);
       invBlockMatcherFilter->SetMaximumVerticalDisparity(0);
+      invBlockMatcherFilter->SetCostVolume(IsParameterEnabled("bm.costvolume"));
 
       if (minimize)
         {
@@ -589,6 +640,69 @@ private:
     subPixelFilter->UpdateOutputInformation();
   }
 
+  void
+  SetSemiGlobalMatchingParameters(SemiGlobalMatchingFilterType * matcherFilter, SemiGlobalMatchingFilterType * invMatcherFilter,
+                                  SSDSubPixelFilterType * subPixelFilter, FloatImageType * leftImage, FloatImageType * rightImage,
+                                  FloatImageType * leftMask, FloatImageType * rightMask, FloatImageType * finalMask,
+                                  double minDisp, double maxDisp)
+  {
+    std::vector<SemiGlobalMatchingFilterType *> matcherFilters;
+    matcherFilters.push_back(matcherFilter);
+
+    matcherFilter->SetLeftInput(leftImage);
+    matcherFilter->SetRightInput(rightImage);
+    matcherFilter->SetLeftMaskInput(leftMask);
+    matcherFilter->SetRightMaskInput(rightMask);
+    matcherFilter->SetMinimumHorizontalDisparity(minDisp);
+    matcherFilter->SetMaximumHorizontalDisparity(maxDisp);
+
+    if (IsParameterEnabled("postproc.bij"))
+      {
+      matcherFilters.push_back(invMatcherFilter);
+
+      invMatcherFilter->SetLeftInput(rightImage);
+      invMatcherFilter->SetRightInput(leftImage);
+      invMatcherFilter->SetLeftMaskInput(rightMask);
+      invMatcherFilter->SetRightMaskInput(leftMask);
+      invMatcherFilter->SetMinimumHorizontalDisparity(-maxDisp);
+      invMatcherFilter->SetMaximumHorizontalDisparity(-minDisp);
+      }
+
+    for (unsigned int i = 0; i < matcherFilters.size(); ++i)
+      {
+      matcherFilters[i]->SetRadius(this->GetParameterInt("bm.radius"));
+      if (this->GetParameterInt("bm.method.sgm.cost") == 0)
+        {
+        matcherFilters[i]->SetMatchingCost(SemiGlobalMatchingFilterType::CENSUS);
+        }
+      else
+        {
+        matcherFilters[i]->SetMatchingCost(SemiGlobalMatchingFilterType::SSD);
+        }
+      matcherFilters[i]->SetP1(this->GetParameterInt("bm.method.sgm.p1"));
+      matcherFilters[i]->SetP2(this->GetParameterInt("bm.method.sgm.p2"));
+      matcherFilters[i]->SetNumberOfPaths(this->GetParameterInt("bm.method.sgm.paths"));
+      matcherFilters[i]->SetOverlap(this->GetParameterInt("bm.method.sgm.overlap"));
+      }
+
+    // Integer disparities are refined with the SSD metric
+    subPixelFilter->SetLeftInput(leftImage);
+    subPixelFilter->SetRightInput(rightImage);
+    subPixelFilter->SetRadius(this->GetParameterInt("bm.radius"));
+    subPixelFilter->SetMinimumHorizontalDisparity(minDisp);
+    subPixelFilter->SetMaximumHorizontalDisparity(maxDisp);
+    subPixelFilter->SetMinimumVerticalDisparity(0);
+    subPixelFilter->SetMaximumVerticalDisparity(0);
+    subPixelFilter->MinimizeOn();
+    subPixelFilter->SetHorizontalDisparityInput(matcherFilter->GetHorizontalDisparityOutput());
+    subPixelFilter->SetVerticalDisparityInput(matcherFilter->GetVerticalDisparityOutput());
+    subPixelFilter->SetMetricInput(matcherFilter->GetMetricOutput());
+    subPixelFilter->SetRightMaskInput(rightMask);
+    subPixelFilter->SetRefineMethod(SSDSubPixelFilterType::DICHOTOMY);
+    subPixelFilter->SetLeftMaskInput(finalMask);
+    subPixelFilter->UpdateOutputInformation();
+  }
+
 
   void DoExecute() ITK_OVERRIDE
   {
@@ -923,7 +1037,41 @@ private:
       LPBlockMatchingFilterType::Pointer invLPBlockMatcherFilter;
       LPSubPixelFilterType::Pointer LPSubPixelFilter;
 
-      switch (GetParameterInt("bm.metric"))
+      SemiGlobalMatchingFilterType::Pointer SemiGlobalMatcherFilter;
+      SemiGlobalMatchingFilterType::Pointer invSemiGlobalMatcherFilter;
+
+      if (GetParameterInt("bm.method") == 1)
+        {
+        otbAppLogINFO(<<"Using Semi-Global Matching.");
+
+        SemiGlobalMatcherFilter = SemiGlobalMatchingFilterType::New();
+        blockMatcherFilterPointer = SemiGlobalMatcherFilter.GetPointer();
+        m_Filters.push_back(blockMatcherFilterPointer);
+
+        if (IsParameterEnabled("postproc.bij"))
+          {
+          //Reverse matching
+          invSemiGlobalMatcherFilter = SemiGlobalMatchingFilterType::New();
+          invBlockMatcherFilterPointer = invSemiGlobalMatcherFilter.GetPointer();
+          m_Filters.push_back(invBlockMatcherFilterPointer);
+          }
+        SSDSubPixelFilter = SSDSubPixelFilterType::New();
+        subPixelFilterPointer = SSDSubPixelFilter.GetPointer();
+        m_Filters.push_back(SSDSubPixelFilter.GetPointer());
+
+        minimize = true;
+        this->SetSemiGlobalMatchingParameters(
+          SemiGlobalMatcherFilter,
+          invSemiGlobalMatcherFilter,
+          SSDSubPixelFilter,
+          leftResampleFilter->GetOutput(),
+          rightResampleFilter->GetOutput(),
+          lBandMathFilter->GetOutput(),
+          rBandMathFilter->GetOutput(),
+          finalMaskFilter->GetOutput(),
+          minDisp, maxDisp);
+        }
+      else switch (GetParameterInt("bm.metric"))
         {
         case 0: //SSDDivMean
           otbAppLogINFO(<<"Using robust SSD Metric for BlockMatching.");
@@ -1298,6 +1446,10 @@ private:
       {
       m_Multi3DMapToDEMFilter ->SetCellFusionMode(otb::CellFusionMode::ACC);
       }
+    else if(GetParameterString("output.fusionmethod") == "median")
+      {
+      m_Multi3DMapToDEMFilter ->SetCellFusionMode(otb::CellFusionMode::MEDIAN);
+      }
     else
       {
       m_Multi3DMapToDEMFilter ->SetCellFusionMode(otb::CellFusionMode::MAX);
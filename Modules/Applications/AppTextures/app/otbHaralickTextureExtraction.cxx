@@ -22,12 +22,13 @@
 #include "otbWrapperApplication.h"
 #include "otbWrapperApplicationFactory.h"
 
-#include "otbScalarImageToTexturesFilter.h"
+#include "otbVectorImageToTexturesFilter.h"
 #include "otbScalarImageToAdvancedTexturesFilter.h"
 #include "otbScalarImageToHigherOrderTexturesFilter.h"
 
 #include "otbMultiToMonoChannelExtractROI.h"
 #include "otbClampImageFilter.h"
+#include "otbImageToVectorImageCastFilter.h"
 #include "otbImageList.h"
 #include "otbImageListToVectorImageFilter.h"
 
@@ -49,12 +50,14 @@ typedef MultiToMonoChannelExtractROI<FloatVectorImageType::InternalPixelType,Flo
                                                                                ExtractorFilterType;
 typedef ClampImageFilter<FloatImageType, FloatImageType>                       ClampFilterType;
 
-typedef ScalarImageToTexturesFilter<FloatImageType, FloatImageType>            HarTexturesFilterType;
+typedef ImageToVectorImageCastFilter<FloatImageType, FloatVectorImageType>     CastFilterType;
+
+typedef VectorImageToTexturesFilter<FloatVectorImageType, FloatVectorImageType> HarTexturesFilterType;
 typedef ScalarImageToAdvancedTexturesFilter<FloatImageType, FloatImageType>    AdvTexturesFilterType;
 typedef ScalarImageToHigherOrderTexturesFilter<FloatImageType, FloatImageType> HigTexturesFilterType;
 
-typedef HarTexturesFilterType::SizeType                                        RadiusType;
-typedef HarTexturesFilterType::OffsetType                                      OffsetType;
+typedef AdvTexturesFilterType::SizeType                                        RadiusType;
+typedef AdvTexturesFilterType::OffsetType                                      OffsetType;
 
 typedef ImageList<FloatImageType>                                              ImageListType;
 typedef ImageListToVectorImageFilter<ImageListType, FloatVectorImageType>      ImageListToVectorImageFilterType;
@@ -77,7 +80,7 @@ SetDocName("Haralick Texture Extraction");
 SetDocLongDescription("This application computes Haralick, advanced and higher order textures on a mono band image");
 SetDocLimitations("None");
 SetDocAuthors("OTB-Team");
-SetDocSeeAlso("otbScalarImageToTexturesFilter, otbScalarImageToAdvancedTexturesFilter and otbScalarImageToHigherOrderTexturesFilter classes");
+SetDocSeeAlso("otbVectorImageToTexturesFilter, otbScalarImageToTexturesFilter, otbScalarImageToAdvancedTexturesFilter and otbScalarImageToHigherOrderTexturesFilter classes");
 
 AddDocTag(Tags::FeatureExtraction);
 AddDocTag("Textures");
@@ -212,9 +215,8 @@ void DoExecute() ITK_OVERRIDE
   m_ClampFilter->SetLower(GetParameterFloat("parameters.min"));
   m_ClampFilter->SetUpper(GetParameterFloat("parameters.max"));
 
-  m_HarTexFilter    = HarTexturesFilterType::New();
-  m_HarImageList    = ImageListType::New();
-  m_HarConcatener   = ImageListToVectorImageFilterType::New();
+  m_CastFilter    = CastFilterType::New();
+  m_HarTexFilter  = HarTexturesFilterType::New();
 
   m_AdvTexFilter  = AdvTexturesFilterType::New();
   m_AdvImageList  = ImageListType::New();
@@ -226,25 +228,18 @@ void DoExecute() ITK_OVERRIDE
 
   if( texType == "simple" )
     {
-    m_HarTexFilter->SetInput(const_cast<FloatImageType*>(m_ClampFilter->GetOutput()));
+    // The multi-band filter gives the 8 textures of the selected channel, in
+    // the order of ScalarImageToTexturesFilter outputs
+    m_CastFilter->SetInput(m_ClampFilter->GetOutput());
+    m_HarTexFilter->SetInput(m_CastFilter->GetOutput());
     m_HarTexFilter->SetRadius(radius);
-    m_HarTexFilter->SetOffset(offset);
+    m_HarTexFilter->AddOffset(offset);
     m_HarTexFilter->SetInputImageMinimum(GetParameterFloat("parameters.min"));
     m_HarTexFilter->SetInputImageMaximum(GetParameterFloat("parameters.max"));
     m_HarTexFilter->SetNumberOfBinsPerAxis(GetParameterInt("parameters.nbbin"));
     m_HarTexFilter->SetSubsampleFactor(stepping);
     m_HarTexFilter->SetSubsampleOffset(stepOffset);
-    m_HarTexFilter->UpdateOutputInformation();
-    m_HarImageList->PushBack(m_HarTexFilter->GetEnergyOutput());
-    m_HarImageList->PushBack(m_HarTexFilter->GetEntropyOutput());
-    m_HarImageList->PushBack(m_HarTexFilter->GetCorrelationOutput());
-    m_HarImageList->PushBack(m_HarTexFilter->GetInverseDifferenceMomentOutput());
-    m_HarImageList->PushBack(m_HarTexFilter->GetInertiaOutput());
-    m_HarImageList->PushBack(m_HarTexFilter->GetClusterShadeOutput());
-    m_HarImageList->PushBack(m_HarTexFilter->GetClusterProminenceOutput());
-    m_HarImageList->PushBack(m_HarTexFilter->GetHaralickCorrelationOutput());
-    m_HarConcatener->SetInput(m_HarImageList);
-    SetParameterOutputImage("out", m_HarConcatener->GetOutput());
+    SetParameterOutputImage("out", m_HarTexFilter->GetOutput());
     }
 
   if( texType == "advanced" )
@@ -300,9 +295,8 @@ void DoExecute() ITK_OVERRIDE
 ExtractorFilterType::Pointer m_ExtractorFilter;
 ClampFilterType::Pointer     m_ClampFilter;
 
+CastFilterType::Pointer                   m_CastFilter;
 HarTexturesFilterType::Pointer            m_HarTexFilter;
-ImageListType::Pointer                    m_HarImageList;
-ImageListToVectorImageFilterType::Pointer m_HarConcatener;
 AdvTexturesFilterType::Pointer            m_AdvTexFilter;
 ImageListType::Pointer                    m_AdvImageList;
 ImageListToVectorImageFilterType::Pointer m_AdvConcatener;
@@ -111,6 +111,10 @@ public:
    * calling the method. */
   OutputType EvaluateAtContinuousIndex( const ContinuousIndexType & index ) const ITK_OVERRIDE = 0;
 
+  /** Compute the 2*Radius+1 BCO coefficients of an index value into coef,
+   * without allocating a container as EvaluateCoef() does. */
+  void ComputeCoefficients( const ContinuousIndexValueType & indexValue, double * coef ) const;
+
 protected:
   BCOInterpolateImageFunctionBase() : m_Radius(2), m_WinSize(5), m_Alpha(-0.5) {};
   ~BCOInterpolateImageFunctionBase() ITK_OVERRIDE {};
@@ -82,6 +82,15 @@ BCOInterpolateImageFunctionBase<TInputImage, TCoordRep>
   // Init BCO coefficient container
 
   CoefContainerType BCOCoef(m_WinSize, 0.);
+  this->ComputeCoefficients(indexValue, BCOCoef.data_block());
+  return BCOCoef;
+}
+
+template<class TInputImage, class TCoordRep>
+void
+BCOInterpolateImageFunctionBase<TInputImage, TCoordRep>
+::ComputeCoefficients( const ContinuousIndexValueType & indexValue, double * BCOCoef ) const
+{
   double offset, dist, position, step;
 
   offset = indexValue - itk::Math::Floor<IndexValueType>(indexValue+0.5);
@@ -122,8 +131,6 @@ BCOInterpolateImageFunctionBase<TInputImage, TCoordRep>
 
   for ( unsigned int i = 0; i < m_WinSize; ++i)
     BCOCoef[i] = BCOCoef[i] / sum;
-
-  return BCOCoef;
 }
 
 template <class TInputImage, class TCoordRep>
@@ -0,0 +1,319 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbRunLengthLabelMap_h
+#define otbRunLengthLabelMap_h
+
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+#include "itkMultiThreader.h"
+#include "itkContinuousIndex.h"
+
+#include <vector>
+#include <unordered_map>
+
+namespace otb
+{
+
+/** \class RunLengthLabelMap
+ *  \brief Compact run-length representation of the objects of a label image.
+ *
+ *  Contrary to \c itk::LabelMap, where each \c LabelObject holds its own
+ *  list of lines, all the runs of all objects are stored in a single array,
+ *  sorted by object and in raster order within each object. An offset array
+ *  gives the first run of each object. Objects are sorted by label, and are
+ *  accessed through their position in this order.
+ *
+ *  \c Build() scans the label image with several threads: a first pass counts
+ *  the runs of each label in each band of rows, a second pass writes the runs
+ *  directly at their final position.
+ *
+ *  Area, bounding region and centroid are computed by \c Build(), in parallel
+ *  over objects. Perimeter and Feret diameter, which are more expensive, are
+ *  only computed on request: either object by object through \c GetPerimeter()
+ *  and \c GetFeretDiameter(), or for all objects at once in parallel through
+ *  \c ComputePerimeters() and \c ComputeFeretDiameters(). Radiometric
+ *  statistics of each object over a feature image are computed in parallel by
+ *  \c ComputeStatistics().
+ *
+ *  The perimeter is the length of the boundary between the object and the other
+ *  pixels (4-connected pixel edges). The Feret diameter is the largest distance
+ *  between the centers of two pixels of the object, as in
+ *  \c itk::ShapeLabelObject. Both are given in physical units, using the
+ *  absolute value of the image spacing.
+ *
+ * \note Lazy accessors are not thread-safe. Use the \c Compute* methods before
+ * reading attributes from several threads.
+ *
+ * \note Only 2D label images are supported.
+ *
+ * \sa itk::LabelMap
+ * \sa ShapeAttributesLabelMapFilter
+ * \sa StatisticsAttributesLabelMapFilter
+ *
+ * \ingroup OTBLabelMap
+ */
+template <class TLabelImage>
+class ITK_EXPORT RunLengthLabelMap : public itk::Object
+{
+public:
+  /** Standard class typedefs. */
+  typedef RunLengthLabelMap             Self;
+  typedef itk::Object                   Superclass;
+  typedef itk::SmartPointer<Self>       Pointer;
+  typedef itk::SmartPointer<const Self> ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(RunLengthLabelMap, itk::Object);
+
+  typedef TLabelImage                            LabelImageType;
+  typedef typename LabelImageType::PixelType     LabelType;
+  typedef typename LabelImageType::IndexType     IndexType;
+  typedef typename LabelImageType::SizeType      SizeType;
+  typedef typename LabelImageType::RegionType    RegionType;
+  typedef typename LabelImageType::SpacingType   SpacingType;
+  typedef typename IndexType::IndexValueType     IndexValueType;
+  typedef itk::ContinuousIndex<double, 2>        ContinuousIndexType;
+  typedef itk::SizeValueType                     ObjectIdType;
+
+  itkStaticConstMacro(ImageDimension, unsigned int, LabelImageType::ImageDimension);
+
+  /** One run of pixels along the first dimension */
+  struct RunType
+  {
+    IndexType          Index;
+    itk::SizeValueType Length;
+  };
+
+  /** Set/Get the background value, which is not stored (default is 0). */
+  itkSetMacro(BackgroundValue, LabelType);
+  itkGetConstMacro(BackgroundValue, LabelType);
+
+  /** Set/Get the number of threads (default is the global default number of threads). */
+  itkSetMacro(NumberOfThreads, unsigned int);
+  itkGetConstMacro(NumberOfThreads, unsigned int);
+
+  /** Build the runs of all objects of the buffered region of the label image.
+   * Previous content and attributes are discarded. */
+  void Build(const LabelImageType * labelImage);
+
+  /** Release all runs and attributes */
+  void Clear();
+
+  /** Number of objects (background excluded) */
+  ObjectIdType GetNumberOfObjects() const
+  {
+    return m_Labels.size();
+  }
+
+  /** Total number of runs */
+  itk::SizeValueType GetNumberOfRuns() const
+  {
+    return m_Runs.size();
+  }
+
+  /** Label of an object */
+  LabelType GetLabel(ObjectIdType id) const
+  {
+    return m_Labels[id];
+  }
+
+  /** Return true and set the object id if the label is present */
+  bool FindObject(LabelType label, ObjectIdType & id) const;
+
+  /** Runs of an object, in raster order */
+  const RunType * GetRunsBegin(ObjectIdType id) const
+  {
+    return m_Runs.empty() ? ITK_NULLPTR : &m_Runs[0] + m_RunOffsets[id];
+  }
+  const RunType * GetRunsEnd(ObjectIdType id) const
+  {
+    return m_Runs.empty() ? ITK_NULLPTR : &m_Runs[0] + m_RunOffsets[id + 1];
+  }
+  itk::SizeValueType GetNumberOfRuns(ObjectIdType id) const
+  {
+    return m_RunOffsets[id + 1] - m_RunOffsets[id];
+  }
+
+  /** Number of pixels of an object */
+  itk::SizeValueType GetArea(ObjectIdType id) const
+  {
+    return m_Areas[id];
+  }
+
+  /** Area of an object in physical units */
+  double GetPhysicalArea(ObjectIdType id) const;
+
+  /** Smallest region containing the object */
+  RegionType GetBoundingRegion(ObjectIdType id) const;
+
+  /** Mean index of the pixels of an object */
+  ContinuousIndexType GetCentroid(ObjectIdType id) const;
+
+  /** Perimeter of an object, computed on first request */
+  double GetPerimeter(ObjectIdType id);
+
+  /** Feret diameter of an object, computed on first request */
+  double GetFeretDiameter(ObjectIdType id);
+
+  /** Compute the perimeters of all objects in parallel */
+  void ComputePerimeters();
+
+  /** Compute the Feret diameters of all objects in parallel */
+  void ComputeFeretDiameters();
+
+  /** Compute mean, variance, minimum and maximum of each band of the feature
+   * image over each object, in parallel. The feature image must have been
+   * buffered over the region of the label image. */
+  template <class TFeatureImage>
+  void ComputeStatistics(const TFeatureImage * featureImage);
+
+  /** Number of bands of the last statistics computed */
+  unsigned int GetNumberOfBands() const
+  {
+    return m_NumberOfBands;
+  }
+
+  /** Statistics of one band over an object. \c ComputeStatistics() must have been called. */
+  double GetMean(ObjectIdType id, unsigned int band) const
+  {
+    return m_Means[id * m_NumberOfBands + band];
+  }
+  double GetVariance(ObjectIdType id, unsigned int band) const
+  {
+    return m_Variances[id * m_NumberOfBands + band];
+  }
+  double GetMinimum(ObjectIdType id, unsigned int band) const
+  {
+    return m_Minima[id * m_NumberOfBands + band];
+  }
+  double GetMaximum(ObjectIdType id, unsigned int band) const
+  {
+    return m_Maxima[id * m_NumberOfBands + band];
+  }
+
+protected:
+  RunLengthLabelMap();
+  ~RunLengthLabelMap() ITK_OVERRIDE {}
+
+  void PrintSelf(std::ostream& os, itk::Indent indent) const ITK_OVERRIDE;
+
+private:
+  RunLengthLabelMap(const Self &); //purposely not implemented
+  void operator =(const Self&); //purposely not implemented
+
+  typedef std::unordered_map<LabelType, itk::SizeValueType> RunCountMapType;
+
+  /** Kinds of threaded work */
+  enum ThreadedTaskType
+  {
+    CountRuns,
+    WriteRuns,
+    BasicAttributes,
+    Perimeters,
+    FeretDiameters
+  };
+
+  struct ThreadStruct
+  {
+    Self *               Map;
+    const LabelImageType * LabelImage;
+    ThreadedTaskType     Task;
+  };
+
+  /** Run a task with the multi-threader */
+  void ExecuteTask(ThreadedTaskType task, const LabelImageType * labelImage);
+
+  /** Rows of the label image processed by one thread */
+  void GetThreadRows(unsigned int threadId, unsigned int threadCount,
+                     IndexValueType & firstRow, IndexValueType & endRow) const;
+
+  /** Objects processed by one thread */
+  void GetThreadObjects(unsigned int threadId, unsigned int threadCount,
+                        ObjectIdType & first, ObjectIdType & end) const;
+
+  void ThreadedCountRuns(const LabelImageType * labelImage, unsigned int threadId, unsigned int threadCount);
+  void ThreadedWriteRuns(const LabelImageType * labelImage, unsigned int threadId, unsigned int threadCount);
+  void ComputeBasicAttributes(ObjectIdType id);
+
+  double ComputePerimeter(ObjectIdType id) const;
+  double ComputeFeretDiameter(ObjectIdType id) const;
+
+  /** Cross product of (b - a) and (c - a), points stored as flat pairs */
+  static double Cross(const std::vector<double> & points, std::size_t a, std::size_t b, std::size_t c);
+
+  static ITK_THREAD_RETURN_TYPE ThreaderCallback(void * arg);
+
+  template <class TFeatureImage>
+  struct StatisticsThreadStruct
+  {
+    Self *                Map;
+    const TFeatureImage * FeatureImage;
+  };
+
+  template <class TFeatureImage>
+  static ITK_THREAD_RETURN_TYPE StatisticsThreaderCallback(void * arg);
+
+  template <class TFeatureImage>
+  void ComputeObjectStatistics(const TFeatureImage * featureImage, ObjectIdType id);
+
+  LabelType    m_BackgroundValue;
+  unsigned int m_NumberOfThreads;
+  SpacingType  m_Spacing;
+  RegionType   m_Region;
+
+  /** Labels of the objects, sorted */
+  std::vector<LabelType>          m_Labels;
+  /** First run of each object, with one more element for the end */
+  std::vector<itk::SizeValueType> m_RunOffsets;
+  /** Runs of all objects */
+  std::vector<RunType>            m_Runs;
+
+  /** Per-thread run counts, then write positions, of each label */
+  std::vector<RunCountMapType>    m_ThreadRunCounts;
+
+  /** Basic attributes */
+  std::vector<itk::SizeValueType> m_Areas;
+  std::vector<IndexType>          m_BoundingMinima;
+  std::vector<IndexType>          m_BoundingMaxima;
+  std::vector<double>             m_Centroids;
+
+  /** Lazy attributes, negative until computed */
+  std::vector<double>             m_Perimeters;
+  std::vector<double>             m_FeretDiameters;
+
+  /** Statistics, stored band by band for each object */
+  unsigned int                    m_NumberOfBands;
+  std::vector<double>             m_Means;
+  std::vector<double>             m_Variances;
+  std::vector<double>             m_Minima;
+  std::vector<double>             m_Maxima;
+};
+
+} // end namespace otb
+
+#ifndef OTB_MANUAL_INSTANTIATION
+#include "otbRunLengthLabelMap.txx"
+#endif
+
+#endif
@@ -0,0 +1,659 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbRunLengthLabelMap_txx
+#define otbRunLengthLabelMap_txx
+
+#include "otbRunLengthLabelMap.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkDefaultConvertPixelTraits.h"
+#include "itkNumericTraits.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace otb
+{
+
+template <class TLabelImage>
+RunLengthLabelMap<TLabelImage>
+::RunLengthLabelMap()
+  : m_BackgroundValue(itk::NumericTraits<LabelType>::Zero),
+    m_NumberOfThreads(itk::MultiThreader::GetGlobalDefaultNumberOfThreads()),
+    m_NumberOfBands(0)
+{
+  m_Spacing.Fill(1.);
+  m_RunOffsets.assign(1, 0);
+}
+
+template <class TLabelImage>
+void
+RunLengthLabelMap<TLabelImage>
+::Clear()
+{
+  m_Labels.clear();
+  m_RunOffsets.assign(1, 0);
+  m_Runs.clear();
+  m_ThreadRunCounts.clear();
+  m_Areas.clear();
+  m_BoundingMinima.clear();
+  m_BoundingMaxima.clear();
+  m_Centroids.clear();
+  m_Perimeters.clear();
+  m_FeretDiameters.clear();
+  m_NumberOfBands = 0;
+  m_Means.clear();
+  m_Variances.clear();
+  m_Minima.clear();
+  m_Maxima.clear();
+}
+
+template <class TLabelImage>
+void
+RunLengthLabelMap<TLabelImage>
+::Build(const LabelImageType * labelImage)
+{
+  if (!labelImage)
+    {
+    itkExceptionMacro(<< "Label image is null.");
+    }
+  if (ImageDimension != 2)
+    {
+    itkExceptionMacro(<< "Only 2D label images are supported.");
+    }
+
+  this->Clear();
+  m_Region = labelImage->GetBufferedRegion();
+  m_Spacing = labelImage->GetSpacing();
+
+  // First pass: count the runs of each label in each band of rows
+  m_ThreadRunCounts.assign(std::max(m_NumberOfThreads, 1U), RunCountMapType());
+  this->ExecuteTask(CountRuns, labelImage);
+
+  for (unsigned int t = 0; t < m_ThreadRunCounts.size(); ++t)
+    {
+    for (typename RunCountMapType::const_iterator it = m_ThreadRunCounts[t].begin();
+         it != m_ThreadRunCounts[t].end(); ++it)
+      {
+      m_Labels.push_back(it->first);
+      }
+    }
+  std::sort(m_Labels.begin(), m_Labels.end());
+  m_Labels.erase(std::unique(m_Labels.begin(), m_Labels.end()), m_Labels.end());
+
+  // Turn the counts into write positions. Bands of rows are written one
+  // after the other, which keeps the runs of each object in raster order.
+  const ObjectIdType numberOfObjects = m_Labels.size();
+  m_RunOffsets.assign(numberOfObjects + 1, 0);
+  itk::SizeValueType position = 0;
+  for (ObjectIdType id = 0; id < numberOfObjects; ++id)
+    {
+    m_RunOffsets[id] = position;
+    for (unsigned int t = 0; t < m_ThreadRunCounts.size(); ++t)
+      {
+      typename RunCountMapType::iterator it = m_ThreadRunCounts[t].find(m_Labels[id]);
+      if (it != m_ThreadRunCounts[t].end())
+        {
+        const itk::SizeValueType count = it->second;
+        it->second = position;
+        position += count;
+        }
+      }
+    }
+  m_RunOffsets[numberOfObjects] = position;
+
+  // Second pass: write the runs at their final position
+  m_Runs.resize(position);
+  this->ExecuteTask(WriteRuns, labelImage);
+  m_ThreadRunCounts.clear();
+
+  // Basic attributes
+  m_Areas.resize(numberOfObjects);
+  m_BoundingMinima.resize(numberOfObjects);
+  m_BoundingMaxima.resize(numberOfObjects);
+  m_Centroids.resize(2 * numberOfObjects);
+  this->ExecuteTask(BasicAttributes, labelImage);
+
+  m_Perimeters.assign(numberOfObjects, -1.);
+  m_FeretDiameters.assign(numberOfObjects, -1.);
+
+  this->Modified();
+}
+
+template <class TLabelImage>
+void
+RunLengthLabelMap<TLabelImage>
+::ExecuteTask(ThreadedTaskType task, const LabelImageType * labelImage)
+{
+  ThreadStruct str;
+  str.Map = this;
+  str.LabelImage = labelImage;
+  str.Task = task;
+
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  threader->SetNumberOfThreads(std::max(m_NumberOfThreads, 1U));
+  threader->SetSingleMethod(this->ThreaderCallback, &str);
+  threader->SingleMethodExecute();
+}
+
+template <class TLabelImage>
+ITK_THREAD_RETURN_TYPE
+RunLengthLabelMap<TLabelImage>
+::ThreaderCallback(void * arg)
+{
+  itk::MultiThreader::ThreadInfoStruct * info = static_cast<itk::MultiThreader::ThreadInfoStruct *>(arg);
+  const unsigned int threadId = info->ThreadID;
+  const unsigned int threadCount = info->NumberOfThreads;
+  ThreadStruct * str = static_cast<ThreadStruct *>(info->UserData);
+  Self * map = str->Map;
+
+  switch (str->Task)
+    {
+    case CountRuns:
+      map->ThreadedCountRuns(str->LabelImage, threadId, threadCount);
+      break;
+    case WriteRuns:
+      map->ThreadedWriteRuns(str->LabelImage, threadId, threadCount);
+      break;
+    default:
+    {
+      ObjectIdType first, end;
+      map->GetThreadObjects(threadId, threadCount, first, end);
+      for (ObjectIdType id = first; id < end; ++id)
+        {
+        if (str->Task == BasicAttributes)
+          {
+          map->ComputeBasicAttributes(id);
+          }
+        else if (str->Task == Perimeters)
+          {
+          map->m_Perimeters[id] = map->ComputePerimeter(id);
+          }
+        else
+          {
+          map->m_FeretDiameters[id] = map->ComputeFeretDiameter(id);
+          }
+        }
+      break;
+    }
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template <class TLabelImage>
+void
+RunLengthLabelMap<TLabelImage>
+::GetThreadRows(unsigned int threadId, unsigned int threadCount,
+                IndexValueType & firstRow, IndexValueType & endRow) const
+{
+  const IndexValueType rows = static_cast<IndexValueType>(m_Region.GetSize(1));
+  firstRow = m_Region.GetIndex(1) + rows * threadId / threadCount;
+  endRow = m_Region.GetIndex(1) + rows * (threadId + 1) / threadCount;
+}
+
+template <class TLabelImage>
+void
+RunLengthLabelMap<TLabelImage>
+::GetThreadObjects(unsigned int threadId, unsigned int threadCount,
+                   ObjectIdType & first, ObjectIdType & end) const
+{
+  // Balance threads on the number of runs rather than on the number of objects
+  const itk::SizeValueType runs = m_Runs.size();
+  const itk::SizeValueType firstRun = runs * threadId / threadCount;
+  const itk::SizeValueType endRun = runs * (threadId + 1) / threadCount;
+  first = std::lower_bound(m_RunOffsets.begin(), m_RunOffsets.end() - 1, firstRun) - m_RunOffsets.begin();
+  end = std::lower_bound(m_RunOffsets.begin(), m_RunOffsets.end() - 1, endRun) - m_RunOffsets.begin();
+  if (threadId + 1 == threadCount)
+    {
+    end = m_Labels.size();
+    }
+}
+
+template <class TLabelImage>
+void
+RunLengthLabelMap<TLabelImage>
+::ThreadedCountRuns(const LabelImageType * labelImage, unsigned int threadId, unsigned int threadCount)
+{
+  RunCountMapType & counts = m_ThreadRunCounts[threadId];
+  const IndexValueType width = static_cast<IndexValueType>(m_Region.GetSize(0));
+
+  IndexValueType firstRow, endRow;
+  this->GetThreadRows(threadId, threadCount, firstRow, endRow);
+
+  IndexType index = m_Region.GetIndex();
+  for (index[1] = firstRow; index[1] < endRow; ++index[1])
+    {
+    const LabelType * row = labelImage->GetBufferPointer() + labelImage->ComputeOffset(index);
+    IndexValueType x = 0;
+    while (x < width)
+      {
+      const LabelType label = row[x];
+      IndexValueType runEnd = x + 1;
+      while (runEnd < width && row[runEnd] == label)
+        {
+        ++runEnd;
+        }
+      if (label != m_BackgroundValue)
+        {
+        ++counts[label];
+        }
+      x = runEnd;
+      }
+    }
+}
+
+template <class TLabelImage>
+void
+RunLengthLabelMap<TLabelImage>
+::ThreadedWriteRuns(const LabelImageType * labelImage, unsigned int threadId, unsigned int threadCount)
+{
+  RunCountMapType & positions = m_ThreadRunCounts[threadId];
+  const IndexValueType width = static_cast<IndexValueType>(m_Region.GetSize(0));
+
+  IndexValueType firstRow, endRow;
+  this->GetThreadRows(threadId, threadCount, firstRow, endRow);
+
+  IndexType index = m_Region.GetIndex();
+  for (index[1] = firstRow; index[1] < endRow; ++index[1])
+    {
+    const LabelType * row = labelImage->GetBufferPointer() + labelImage->ComputeOffset(index);
+    IndexValueType x = 0;
+    while (x < width)
+      {
+      const LabelType label = row[x];
+      IndexValueType runEnd = x + 1;
+      while (runEnd < width && row[runEnd] == label)
+        {
+        ++runEnd;
+        }
+      if (label != m_BackgroundValue)
+        {
+        RunType & run = m_Runs[positions[label]++];
+        run.Index[0] = m_Region.GetIndex(0) + x;
+        run.Index[1] = index[1];
+        run.Length = runEnd - x;
+        }
+      x = runEnd;
+      }
+    }
+}
+
+template <class TLabelImage>
+void
+RunLengthLabelMap<TLabelImage>
+::ComputeBasicAttributes(ObjectIdType id)
+{
+  itk::SizeValueType area = 0;
+  double sumX = 0.;
+  double sumY = 0.;
+  IndexType minimum = this->GetRunsBegin(id)->Index;
+  IndexType maximum = minimum;
+
+  for (const RunType * run = this->GetRunsBegin(id); run != this->GetRunsEnd(id); ++run)
+    {
+    const double length = static_cast<double>(run->Length);
+    const IndexValueType lastX = run->Index[0] + static_cast<IndexValueType>(run->Length) - 1;
+    area += run->Length;
+    sumX += length * run->Index[0] + 0.5 * length * (length - 1.);
+    sumY += length * run->Index[1];
+    minimum[0] = std::min(minimum[0], run->Index[0]);
+    maximum[0] = std::max(maximum[0], lastX);
+    // Runs are in raster order
+    maximum[1] = run->Index[1];
+    }
+
+  m_Areas[id] = area;
+  m_BoundingMinima[id] = minimum;
+  m_BoundingMaxima[id] = maximum;
+  m_Centroids[2 * id] = sumX / area;
+  m_Centroids[2 * id + 1] = sumY / area;
+}
+
+template <class TLabelImage>
+bool
+RunLengthLabelMap<TLabelImage>
+::FindObject(LabelType label, ObjectIdType & id) const
+{
+  typename std::vector<LabelType>::const_iterator it = std::lower_bound(m_Labels.begin(), m_Labels.end(), label);
+  if (it == m_Labels.end() || *it != label)
+    {
+    return false;
+    }
+  id = it - m_Labels.begin();
+  return true;
+}
+
+template <class TLabelImage>
+double
+RunLengthLabelMap<TLabelImage>
+::GetPhysicalArea(ObjectIdType id) const
+{
+  return m_Areas[id] * vcl_abs(m_Spacing[0] * m_Spacing[1]);
+}
+
+template <class TLabelImage>
+typename RunLengthLabelMap<TLabelImage>::RegionType
+RunLengthLabelMap<TLabelImage>
+::GetBoundingRegion(ObjectIdType id) const
+{
+  RegionType region;
+  region.SetIndex(m_BoundingMinima[id]);
+  SizeType size;
+  for (unsigned int dim = 0; dim < ImageDimension; ++dim)
+    {
+    size[dim] = m_BoundingMaxima[id][dim] - m_BoundingMinima[id][dim] + 1;
+    }
+  region.SetSize(size);
+  return region;
+}
+
+template <class TLabelImage>
+typename RunLengthLabelMap<TLabelImage>::ContinuousIndexType
+RunLengthLabelMap<TLabelImage>
+::GetCentroid(ObjectIdType id) const
+{
+  ContinuousIndexType centroid;
+  centroid[0] = m_Centroids[2 * id];
+  centroid[1] = m_Centroids[2 * id + 1];
+  return centroid;
+}
+
+template <class TLabelImage>
+double
+RunLengthLabelMap<TLabelImage>
+::GetPerimeter(ObjectIdType id)
+{
+  if (m_Perimeters[id] < 0.)
+    {
+    m_Perimeters[id] = this->ComputePerimeter(id);
+    }
+  return m_Perimeters[id];
+}
+
+template <class TLabelImage>
+double
+RunLengthLabelMap<TLabelImage>
+::GetFeretDiameter(ObjectIdType id)
+{
+  if (m_FeretDiameters[id] < 0.)
+    {
+    m_FeretDiameters[id] = this->ComputeFeretDiameter(id);
+    }
+  return m_FeretDiameters[id];
+}
+
+template <class TLabelImage>
+void
+RunLengthLabelMap<TLabelImage>
+::ComputePerimeters()
+{
+  this->ExecuteTask(Perimeters, ITK_NULLPTR);
+}
+
+template <class TLabelImage>
+void
+RunLengthLabelMap<TLabelImage>
+::ComputeFeretDiameters()
+{
+  this->ExecuteTask(FeretDiameters, ITK_NULLPTR);
+}
+
+template <class TLabelImage>
+double
+RunLengthLabelMap<TLabelImage>
+::ComputePerimeter(ObjectIdType id) const
+{
+  const RunType * begin = this->GetRunsBegin(id);
+  const RunType * end = this->GetRunsEnd(id);
+
+  // Both ends of each run are vertical boundary edges. Each pixel has a top
+  // and a bottom edge, minus the edges shared with the row above or below.
+  const itk::SizeValueType verticalEdges = 2 * (end - begin);
+  itk::SizeValueType horizontalEdges = 2 * m_Areas[id];
+
+  const RunType * rowBegin = begin;
+  while (rowBegin != end)
+    {
+    const RunType * rowEnd = rowBegin;
+    while (rowEnd != end && rowEnd->Index[1] == rowBegin->Index[1])
+      {
+      ++rowEnd;
+      }
+    const RunType * nextRowEnd = rowEnd;
+    while (nextRowEnd != end && nextRowEnd->Index[1] == rowBegin->Index[1] + 1)
+      {
+      ++nextRowEnd;
+      }
+
+    // Overlap between the runs of two consecutive rows, sorted along x
+    const RunType * upper = rowBegin;
+    const RunType * lower = rowEnd;
+    while (upper != rowEnd && lower != nextRowEnd)
+      {
+      const IndexValueType upperEnd = upper->Index[0] + static_cast<IndexValueType>(upper->Length);
+      const IndexValueType lowerEnd = lower->Index[0] + static_cast<IndexValueType>(lower->Length);
+      const IndexValueType overlap = std::min(upperEnd, lowerEnd) - std::max(upper->Index[0], lower->Index[0]);
+      if (overlap > 0)
+        {
+        horizontalEdges -= 2 * overlap;
+        }
+      if (upperEnd < lowerEnd)
+        {
+        ++upper;
+        }
+      else
+        {
+        ++lower;
+        }
+      }
+    rowBegin = rowEnd;
+    }
+
+  return verticalEdges * vcl_abs(m_Spacing[1]) + horizontalEdges * vcl_abs(m_Spacing[0]);
+}
+
+template <class TLabelImage>
+double
+RunLengthLabelMap<TLabelImage>
+::Cross(const std::vector<double> & points, std::size_t a, std::size_t b, std::size_t c)
+{
+  return (points[2 * b] - points[2 * a]) * (points[2 * c + 1] - points[2 * a + 1])
+    - (points[2 * b + 1] - points[2 * a + 1]) * (points[2 * c] - points[2 * a]);
+}
+
+template <class TLabelImage>
+double
+RunLengthLabelMap<TLabelImage>
+::ComputeFeretDiameter(ObjectIdType id) const
+{
+  // The farthest pixels are vertices of the convex hull, which are ends of
+  // runs. Run ends come sorted by row then column, as required by the
+  // monotone chain algorithm.
+  const double sx = vcl_abs(m_Spacing[0]);
+  const double sy = vcl_abs(m_Spacing[1]);
+
+  std::vector<double> points;
+  points.reserve(4 * this->GetNumberOfRuns(id));
+  for (const RunType * run = this->GetRunsBegin(id); run != this->GetRunsEnd(id); ++run)
+    {
+    points.push_back(run->Index[1] * sy);
+    points.push_back(run->Index[0] * sx);
+    if (run->Length > 1)
+      {
+      points.push_back(run->Index[1] * sy);
+      points.push_back((run->Index[0] + static_cast<IndexValueType>(run->Length) - 1) * sx);
+      }
+    }
+
+  const std::size_t n = points.size() / 2;
+  if (n < 2)
+    {
+    return 0.;
+    }
+
+  std::vector<std::size_t> hull(2 * n);
+  std::size_t k = 0;
+  // Lower hull
+  for (std::size_t i = 0; i < n; ++i)
+    {
+    while (k >= 2 && Cross(points, hull[k - 2], hull[k - 1], i) <= 0.)
+      {
+      --k;
+      }
+    hull[k++] = i;
+    }
+  // Upper hull
+  const std::size_t lowerSize = k + 1;
+  for (std::size_t i = n - 1; i > 0; --i)
+    {
+    while (k >= lowerSize && Cross(points, hull[k - 2], hull[k - 1], i - 1) <= 0.)
+      {
+      --k;
+      }
+    hull[k++] = i - 1;
+    }
+  // The first point is repeated at the end
+  --k;
+
+  double maximum = 0.;
+  for (std::size_t a = 0; a < k; ++a)
+    {
+    for (std::size_t b = a + 1; b < k; ++b)
+      {
+      const double du = points[2 * hull[a]] - points[2 * hull[b]];
+      const double dv = points[2 * hull[a] + 1] - points[2 * hull[b] + 1];
+      maximum = std::max(maximum, du * du + dv * dv);
+      }
+    }
+  return vcl_sqrt(maximum);
+}
+
+template <class TLabelImage>
+template <class TFeatureImage>
+void
+RunLengthLabelMap<TLabelImage>
+::ComputeStatistics(const TFeatureImage * featureImage)
+{
+  if (!featureImage)
+    {
+    itkExceptionMacro(<< "Feature image is null.");
+    }
+  if (!featureImage->GetBufferedRegion().IsInside(m_Region) && !m_Labels.empty())
+    {
+    itkExceptionMacro(<< "Feature image is not buffered over the label image region.");
+    }
+
+  m_NumberOfBands = featureImage->GetNumberOfComponentsPerPixel();
+  const itk::SizeValueType size = m_Labels.size() * m_NumberOfBands;
+  m_Means.assign(size, 0.);
+  m_Variances.assign(size, 0.);
+  m_Minima.assign(size, itk::NumericTraits<double>::max());
+  m_Maxima.assign(size, itk::NumericTraits<double>::NonpositiveMin());
+
+  StatisticsThreadStruct<TFeatureImage> str;
+  str.Map = this;
+  str.FeatureImage = featureImage;
+
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  threader->SetNumberOfThreads(std::max(m_NumberOfThreads, 1U));
+  threader->SetSingleMethod(&Self::template StatisticsThreaderCallback<TFeatureImage>, &str);
+  threader->SingleMethodExecute();
+}
+
+template <class TLabelImage>
+template <class TFeatureImage>
+ITK_THREAD_RETURN_TYPE
+RunLengthLabelMap<TLabelImage>
+::StatisticsThreaderCallback(void * arg)
+{
+  itk::MultiThreader::ThreadInfoStruct * info = static_cast<itk::MultiThreader::ThreadInfoStruct *>(arg);
+  StatisticsThreadStruct<TFeatureImage> * str = static_cast<StatisticsThreadStruct<TFeatureImage> *>(info->UserData);
+
+  ObjectIdType first, end;
+  str->Map->GetThreadObjects(info->ThreadID, info->NumberOfThreads, first, end);
+  for (ObjectIdType id = first; id < end; ++id)
+    {
+    str->Map->ComputeObjectStatistics(str->FeatureImage, id);
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template <class TLabelImage>
+template <class TFeatureImage>
+void
+RunLengthLabelMap<TLabelImage>
+::ComputeObjectStatistics(const TFeatureImage * featureImage, ObjectIdType id)
+{
+  typedef typename TFeatureImage::PixelType                   FeaturePixelType;
+  typedef itk::DefaultConvertPixelTraits<FeaturePixelType>    PixelTraitsType;
+
+  double * sums = &m_Means[id * m_NumberOfBands];
+  double * squaredSums = &m_Variances[id * m_NumberOfBands];
+  double * minima = &m_Minima[id * m_NumberOfBands];
+  double * maxima = &m_Maxima[id * m_NumberOfBands];
+
+  for (const RunType * run = this->GetRunsBegin(id); run != this->GetRunsEnd(id); ++run)
+    {
+    typename TFeatureImage::RegionType runRegion;
+    runRegion.SetIndex(run->Index);
+    runRegion.SetSize(0, run->Length);
+    runRegion.SetSize(1, 1);
+
+    itk::ImageRegionConstIterator<TFeatureImage> it(featureImage, runRegion);
+    for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+      {
+      const FeaturePixelType pixel = it.Get();
+      for (unsigned int band = 0; band < m_NumberOfBands; ++band)
+        {
+        const double value = static_cast<double>(PixelTraitsType::GetNthComponent(band, pixel));
+        sums[band] += value;
+        squaredSums[band] += value * value;
+        minima[band] = std::min(minima[band], value);
+        maxima[band] = std::max(maxima[band], value);
+        }
+      }
+    }
+
+  const double area = static_cast<double>(m_Areas[id]);
+  for (unsigned int band = 0; band < m_NumberOfBands; ++band)
+    {
+    const double sum = sums[band];
+    sums[band] = sum / area;
+    squaredSums[band] = area > 1. ? (squaredSums[band] - sum * sum / area) / (area - 1.) : 0.;
+    }
+}
+
+template <class TLabelImage>
+void
+RunLengthLabelMap<TLabelImage>
+::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "BackgroundValue: " << static_cast<typename itk::NumericTraits<LabelType>::PrintType>(m_BackgroundValue) << std::endl;
+  os << indent << "NumberOfThreads: " << m_NumberOfThreads << std::endl;
+  os << indent << "NumberOfObjects: " << m_Labels.size() << std::endl;
+  os << indent << "NumberOfRuns: " << m_Runs.size() << std::endl;
+}
+
+} // end namespace otb
+
+#endif
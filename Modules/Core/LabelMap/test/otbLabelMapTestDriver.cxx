@@ -47,4 +47,6 @@ void RegisterTests()
   REGISTER_TEST(otbShapeAttributesLabelMapFilterNew);
   REGISTER_TEST(otbBandsStatisticsAttributesLabelMapFilter);
   REGISTER_TEST(otbBandsStatisticsAttributesLabelMapFilterNew);
+  REGISTER_TEST(otbRunLengthLabelMapNew);
+  REGISTER_TEST(otbRunLengthLabelMap);
 }
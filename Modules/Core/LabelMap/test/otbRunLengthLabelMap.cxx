@@ -0,0 +1,227 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "otbImageFileReader.h"
+#include "otbImage.h"
+#include "otbVectorImage.h"
+#include "otbRunLengthLabelMap.h"
+
+#include "itkVectorIndexSelectionCastImageFilter.h"
+#include "itkLabelImageToShapeLabelMapFilter.h"
+#include "itkLabelStatisticsImageFilter.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+
+#include <map>
+
+const unsigned int Dimension = 2;
+typedef unsigned int   LabelType;
+typedef double         PixelType;
+
+typedef otb::Image<LabelType, Dimension>                        LabelImageType;
+typedef otb::VectorImage<PixelType, Dimension>                  VectorImageType;
+typedef otb::Image<PixelType, Dimension>                        ImageType;
+typedef otb::RunLengthLabelMap<LabelImageType>                  RunLengthLabelMapType;
+
+typedef otb::ImageFileReader<VectorImageType>                   ReaderType;
+typedef otb::ImageFileReader<LabelImageType>                    LabelReaderType;
+typedef itk::VectorIndexSelectionCastImageFilter<VectorImageType, ImageType> BandFilterType;
+typedef itk::LabelImageToShapeLabelMapFilter<LabelImageType>    ShapeFilterType;
+typedef ShapeFilterType::OutputImageType                        ShapeLabelMapType;
+typedef itk::LabelStatisticsImageFilter<ImageType, LabelImageType> StatisticsFilterType;
+
+int otbRunLengthLabelMapNew(int itkNotUsed(argc), char * itkNotUsed(argv)[])
+{
+  RunLengthLabelMapType::Pointer labelMap = RunLengthLabelMapType::New();
+  std::cout << labelMap << std::endl;
+  return EXIT_SUCCESS;
+}
+
+namespace
+{
+bool IsClose(double value, double reference)
+{
+  return vcl_abs(value - reference) <= 1e-6 * std::max(1., vcl_abs(reference));
+}
+}
+
+int otbRunLengthLabelMap(int itkNotUsed(argc), char * argv[])
+{
+  const char * infname = argv[1];
+  const char * lfname  = argv[2];
+  const unsigned int numberOfThreads = atoi(argv[3]);
+
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(infname);
+  reader->Update();
+
+  LabelReaderType::Pointer labelReader = LabelReaderType::New();
+  labelReader->SetFileName(lfname);
+  labelReader->Update();
+  const LabelImageType * labelImage = labelReader->GetOutput();
+
+  RunLengthLabelMapType::Pointer labelMap = RunLengthLabelMapType::New();
+  labelMap->SetNumberOfThreads(numberOfThreads);
+  labelMap->SetBackgroundValue(0);
+  labelMap->Build(labelImage);
+  labelMap->ComputeStatistics(reader->GetOutput());
+
+  // Reference shape attributes
+  ShapeFilterType::Pointer shapeFilter = ShapeFilterType::New();
+  shapeFilter->SetInput(labelImage);
+  shapeFilter->SetBackgroundValue(0);
+  shapeFilter->SetComputeFeretDiameter(true);
+  shapeFilter->Update();
+  ShapeLabelMapType * shapeLabelMap = shapeFilter->GetOutput();
+
+  unsigned int nbErrors = 0;
+  if (labelMap->GetNumberOfObjects() != shapeLabelMap->GetNumberOfLabelObjects())
+    {
+    std::cerr << "Found " << labelMap->GetNumberOfObjects() << " objects, expected "
+              << shapeLabelMap->GetNumberOfLabelObjects() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Perimeter reference: count of pixel edges between the object and other pixels
+  std::map<LabelType, itk::SizeValueType> boundaryEdges;
+  const LabelImageType::RegionType region = labelImage->GetBufferedRegion();
+  itk::ImageRegionConstIteratorWithIndex<LabelImageType> it(labelImage, region);
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+    if (it.Get() == 0)
+      {
+      continue;
+      }
+    for (unsigned int dim = 0; dim < Dimension; ++dim)
+      {
+      for (int step = -1; step <= 1; step += 2)
+        {
+        LabelImageType::IndexType neighbour = it.GetIndex();
+        neighbour[dim] += step;
+        if (!region.IsInside(neighbour) || labelImage->GetPixel(neighbour) != it.Get())
+          {
+          ++boundaryEdges[it.Get()];
+          }
+        }
+      }
+    }
+
+  const LabelImageType::SpacingType spacing = labelImage->GetSpacing();
+
+  for (RunLengthLabelMapType::ObjectIdType id = 0; id < labelMap->GetNumberOfObjects(); ++id)
+    {
+    const LabelType label = labelMap->GetLabel(id);
+    const ShapeLabelMapType::LabelObjectType * reference = shapeLabelMap->GetLabelObject(label);
+
+    RunLengthLabelMapType::ObjectIdType foundId;
+    if (!labelMap->FindObject(label, foundId) || foundId != id)
+      {
+      std::cerr << "Label " << label << ": FindObject() failed" << std::endl;
+      ++nbErrors;
+      }
+    if (labelMap->GetArea(id) != reference->GetNumberOfPixels())
+      {
+      std::cerr << "Label " << label << ": area " << labelMap->GetArea(id)
+                << " instead of " << reference->GetNumberOfPixels() << std::endl;
+      ++nbErrors;
+      }
+    if (labelMap->GetBoundingRegion(id) != reference->GetBoundingBox())
+      {
+      std::cerr << "Label " << label << ": bounding region " << labelMap->GetBoundingRegion(id)
+                << " instead of " << reference->GetBoundingBox() << std::endl;
+      ++nbErrors;
+      }
+
+    LabelImageType::PointType centroid;
+    labelImage->TransformContinuousIndexToPhysicalPoint(labelMap->GetCentroid(id), centroid);
+    for (unsigned int dim = 0; dim < Dimension; ++dim)
+      {
+      if (!IsClose(centroid[dim], reference->GetCentroid()[dim]))
+        {
+        std::cerr << "Label " << label << ": centroid " << centroid
+                  << " instead of " << reference->GetCentroid() << std::endl;
+        ++nbErrors;
+        break;
+        }
+      }
+
+    if (!IsClose(labelMap->GetFeretDiameter(id), reference->GetFeretDiameter()))
+      {
+      std::cerr << "Label " << label << ": Feret diameter " << labelMap->GetFeretDiameter(id)
+                << " instead of " << reference->GetFeretDiameter() << std::endl;
+      ++nbErrors;
+      }
+
+    // Pixels are square in the test image
+    if (!IsClose(labelMap->GetPerimeter(id), boundaryEdges[label] * vcl_abs(spacing[0])))
+      {
+      std::cerr << "Label " << label << ": perimeter " << labelMap->GetPerimeter(id)
+                << " instead of " << boundaryEdges[label] * vcl_abs(spacing[0]) << std::endl;
+      ++nbErrors;
+      }
+    }
+
+  // Lazy and threaded computations give the same values
+  RunLengthLabelMapType::Pointer threadedLabelMap = RunLengthLabelMapType::New();
+  threadedLabelMap->SetNumberOfThreads(numberOfThreads);
+  threadedLabelMap->Build(labelImage);
+  threadedLabelMap->ComputePerimeters();
+  threadedLabelMap->ComputeFeretDiameters();
+  for (RunLengthLabelMapType::ObjectIdType id = 0; id < labelMap->GetNumberOfObjects(); ++id)
+    {
+    if (threadedLabelMap->GetPerimeter(id) != labelMap->GetPerimeter(id)
+        || threadedLabelMap->GetFeretDiameter(id) != labelMap->GetFeretDiameter(id))
+      {
+      std::cerr << "Label " << labelMap->GetLabel(id) << ": threaded attributes differ" << std::endl;
+      ++nbErrors;
+      }
+    }
+
+  // Reference statistics, band by band
+  for (unsigned int band = 0; band < labelMap->GetNumberOfBands(); ++band)
+    {
+    BandFilterType::Pointer bandFilter = BandFilterType::New();
+    bandFilter->SetInput(reader->GetOutput());
+    bandFilter->SetIndex(band);
+
+    StatisticsFilterType::Pointer statistics = StatisticsFilterType::New();
+    statistics->SetInput(bandFilter->GetOutput());
+    statistics->SetLabelInput(labelImage);
+    statistics->Update();
+
+    for (RunLengthLabelMapType::ObjectIdType id = 0; id < labelMap->GetNumberOfObjects(); ++id)
+      {
+      const LabelType label = labelMap->GetLabel(id);
+      if (!IsClose(labelMap->GetMean(id, band), statistics->GetMean(label))
+          || !IsClose(labelMap->GetVariance(id, band), statistics->GetVariance(label))
+          || !IsClose(labelMap->GetMinimum(id, band), statistics->GetMinimum(label))
+          || !IsClose(labelMap->GetMaximum(id, band), statistics->GetMaximum(label)))
+        {
+        std::cerr << "Label " << label << ", band " << band << ": statistics differ" << std::endl;
+        ++nbErrors;
+        }
+      }
+    }
+
+  std::cout << labelMap->GetNumberOfObjects() << " objects, " << labelMap->GetNumberOfRuns() << " runs, "
+            << nbErrors << " errors" << std::endl;
+
+  return nbErrors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
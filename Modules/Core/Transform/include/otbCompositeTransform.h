@@ -120,6 +120,11 @@ public:
   /**  Method to transform a point. */
   SecondTransformOutputPointType TransformPoint(const FirstTransformInputPointType&) const ITK_OVERRIDE;
 
+  /**  Method to transform a batch of points, through both transforms. */
+  void TransformPoints(const FirstTransformInputPointType * inputPoints,
+                       SecondTransformOutputPointType * outputPoints,
+                       unsigned long nbPoints) const ITK_OVERRIDE;
+
   /**  Method to transform a vector. */
   //  virtual OutputVectorType TransformVector(const InputVectorType &) const;
 
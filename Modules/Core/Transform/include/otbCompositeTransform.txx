@@ -28,6 +28,8 @@
 #include "otbInverseSensorModel.h"
 #include "itkIdentityTransform.h"
 
+#include <vector>
+
 namespace otb
 {
 
@@ -89,6 +91,38 @@ CompositeTransform<TFirstTransform,
   return outputPoint;
 }
 
+template<class TFirstTransform,
+    class TSecondTransform,
+    class TScalarType,
+    unsigned int NInputDimensions,
+    unsigned int NOutputDimensions>
+void
+CompositeTransform<TFirstTransform,
+    TSecondTransform,
+    TScalarType,
+    NInputDimensions,
+    NOutputDimensions>
+::TransformPoints(const FirstTransformInputPointType * inputPoints,
+                  SecondTransformOutputPointType * outputPoints,
+                  unsigned long nbPoints) const
+{
+  typedef Transform<typename TFirstTransform::ScalarType,
+                    TFirstTransform::InputSpaceDimension,
+                    TFirstTransform::OutputSpaceDimension>  FirstOTBTransformType;
+  typedef Transform<typename TSecondTransform::ScalarType,
+                    TSecondTransform::InputSpaceDimension,
+                    TSecondTransform::OutputSpaceDimension> SecondOTBTransformType;
+
+  if (nbPoints == 0)
+    {
+    return;
+    }
+
+  std::vector<FirstTransformOutputPointType> geoPoints(nbPoints);
+  FirstOTBTransformType::BatchTransformPoints(m_FirstTransform, inputPoints, &geoPoints[0], nbPoints);
+  SecondOTBTransformType::BatchTransformPoints(m_SecondTransform, &geoPoints[0], outputPoints, nbPoints);
+}
+
 /*template<class TFirstTransform, class TSecondTransform, class TScalarType, unsigned int NInputDimensions, unsigned int NOutputDimensions>
   typename CompositeTransform<TFirstTransform, TSecondTransform, TScalarType, NInputDimensions, NOutputDimensions>::OutputVectorType
   CompositeTransform<TFirstTransform, TSecondTransform, TScalarType, NInputDimensions, NOutputDimensions>
@@ -76,6 +76,11 @@ public:
   /** Compute the world coordinates. */
   OutputPointType TransformPoint(const InputPointType& point) const ITK_OVERRIDE;
 
+  /** Compute the world coordinates of a batch of points. */
+  void TransformPoints(const InputPointType * inputPoints,
+                       OutputPointType * outputPoints,
+                       unsigned long nbPoints) const ITK_OVERRIDE;
+
 protected:
   ForwardSensorModel();
   ~ForwardSensorModel() ITK_OVERRIDE;
@@ -24,6 +24,8 @@
 #include "otbForwardSensorModel.h"
 #include "otbMacro.h"
 
+#include <vector>
+
 namespace otb
 {
 
@@ -69,6 +71,51 @@ ForwardSensorModel<TScalarType, NInputDimensions, NOutputDimensions>
   return outputPoint;
 }
 
+template <class TScalarType, unsigned int NInputDimensions, unsigned int NOutputDimensions>
+void
+ForwardSensorModel<TScalarType, NInputDimensions, NOutputDimensions>
+::TransformPoints(const InputPointType * inputPoints, OutputPointType * outputPoints, unsigned long nbPoints) const
+{
+  std::vector<double> x(nbPoints), y(nbPoints), z;
+  std::vector<double> lon(nbPoints), lat(nbPoints), h(nbPoints);
+
+  if (nbPoints == 0)
+    {
+    return;
+    }
+
+  for (unsigned long i = 0; i < nbPoints; ++i)
+    {
+    x[i] = inputPoints[i][0];
+    y[i] = inputPoints[i][1];
+    }
+
+  if (InputPointType::PointDimension == 3)
+    {
+    z.resize(nbPoints);
+    for (unsigned long i = 0; i < nbPoints; ++i)
+      {
+      z[i] = inputPoints[i][2];
+      }
+    this->m_Model->ForwardTransformPoints(&x[0], &y[0], &z[0], &lon[0], &lat[0], &h[0], nbPoints);
+    }
+  else
+    {
+    this->m_Model->ForwardTransformPoints(&x[0], &y[0], ITK_NULLPTR, &lon[0], &lat[0], &h[0], nbPoints);
+    }
+
+  for (unsigned long i = 0; i < nbPoints; ++i)
+    {
+    outputPoints[i][0] = lon[i];
+    outputPoints[i][1] = lat[i];
+
+    if (OutputPointType::PointDimension == 3)
+      {
+      outputPoints[i][2] = h[i];
+      }
+    }
+}
+
 template <class TScalarType, unsigned int NInputDimensions, unsigned int NOutputDimensions>
 void
 ForwardSensorModel<TScalarType, NInputDimensions, NOutputDimensions>
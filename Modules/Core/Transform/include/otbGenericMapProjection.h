@@ -23,6 +23,7 @@
 
 #include <iostream>
 #include <sstream>
+#include <vector>
 
 #include "otbTransform.h"
 #include "itkMacro.h"
@@ -100,6 +101,13 @@ public:
 
   OutputPointType TransformPoint(const InputPointType& point) const ITK_OVERRIDE;
 
+  /** Transform a batch of points with the batch methods of the
+   * MapProjectionAdapter, which use native kernels for the common
+   * projections. */
+  void TransformPoints(const InputPointType * inputPoints,
+                       OutputPointType * outputPoints,
+                       unsigned long nbPoints) const ITK_OVERRIDE;
+
   virtual bool InstantiateProjection();
 
   const MapProjectionAdapter* GetMapProjection() const;
@@ -118,6 +118,44 @@ GenericMapProjection<TDirectionOfMapping, TScalarType, NInputDimensions, NOutput
   return outputPoint;
 }
 
+template<TransformDirection::TransformationDirection TDirectionOfMapping, class TScalarType, unsigned int NInputDimensions,
+    unsigned int NOutputDimensions>
+void
+GenericMapProjection<TDirectionOfMapping, TScalarType, NInputDimensions, NOutputDimensions>
+::TransformPoints(const InputPointType * inputPoints, OutputPointType * outputPoints, unsigned long nbPoints) const
+{
+  if (nbPoints == 0)
+    {
+    return;
+    }
+
+  // Split the points into coordinate arrays
+  std::vector<double> inX(nbPoints), inY(nbPoints), inZ(nbPoints, 0.);
+  std::vector<double> outX(nbPoints), outY(nbPoints), outZ(nbPoints);
+  for (unsigned long i = 0; i < nbPoints; ++i)
+    {
+    inX[i] = inputPoints[i][0];
+    inY[i] = inputPoints[i][1];
+    if (InputPointType::PointDimension == 3) inZ[i] = inputPoints[i][2];
+    }
+
+  if (DirectionOfMapping == TransformDirection::INVERSE)
+    {
+    m_MapProjection->InverseTransformPoints(&inX[0], &inY[0], &inZ[0], &outX[0], &outY[0], &outZ[0], nbPoints);
+    }
+  if (DirectionOfMapping == TransformDirection::FORWARD)
+    {
+    m_MapProjection->ForwardTransformPoints(&inX[0], &inY[0], &inZ[0], &outX[0], &outY[0], &outZ[0], nbPoints);
+    }
+
+  for (unsigned long i = 0; i < nbPoints; ++i)
+    {
+    outputPoints[i][0] = outX[i];
+    outputPoints[i][1] = outY[i];
+    if (OutputPointType::PointDimension == 3) outputPoints[i][2] = outZ[i];
+    }
+}
+
 template<TransformDirection::TransformationDirection TDirectionOfMapping, class TScalarType, unsigned int NInputDimensions,
     unsigned int NOutputDimensions>
 void
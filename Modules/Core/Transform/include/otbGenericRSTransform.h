@@ -22,6 +22,7 @@
 #define otbGenericRSTransform_h
 
 #include "otbCompositeTransform.h"
+#include "otbLocalisationGrid.h"
 
 namespace otb
 {
@@ -77,6 +78,8 @@ public:
 
   typedef typename Superclass::InverseTransformBasePointer InverseTransformBasePointer;
 
+  typedef LocalisationGrid LocalisationGridType;
+
   /** Method for creation through the object factory. */
   itkNewMacro(Self);
 
@@ -136,6 +139,16 @@ public:
     this->Modified();
   }
 
+  /** Set/Get the localisation grids of the input and output sensor models.
+   * When a grid is set, the sensor model is interpolated in the grid and
+   * only evaluated exactly outside of it. Grids are only used by 2D
+   * transforms, and must have been computed for the same keywordlist. */
+  itkSetConstObjectMacro(InputLocalisationGrid, LocalisationGridType);
+  itkGetConstObjectMacro(InputLocalisationGrid, LocalisationGridType);
+
+  itkSetConstObjectMacro(OutputLocalisationGrid, LocalisationGridType);
+  itkGetConstObjectMacro(OutputLocalisationGrid, LocalisationGridType);
+
   /** Set the origin of the vector data.
   * \sa GetOrigin() */
   itkSetMacro(InputOrigin, OriginType);
@@ -170,6 +183,12 @@ public:
 
   OutputPointType TransformPoint(const InputPointType& point) const ITK_OVERRIDE;
 
+  /** Transform a batch of points. Sensor models process the whole batch in
+   * one call. */
+  void TransformPoints(const InputPointType * inputPoints,
+                       OutputPointType * outputPoints,
+                       unsigned long nbPoints) const ITK_OVERRIDE;
+
   virtual void  InstantiateTransform();
   
   // Get inverse methods
@@ -194,6 +213,10 @@ protected:
 
   void PrintSelf(std::ostream& os, itk::Indent indent) const ITK_OVERRIDE;
 
+  /** Clone sharing the map projections but with its own copies of the
+   * sensor models, so that clones can be used by concurrent threads */
+  itk::LightObject::Pointer InternalClone() const ITK_OVERRIDE;
+
 private:
   GenericRSTransform(const Self &);    //purposely not implemented
   void operator =(const Self&);    //purposely not implemented
@@ -207,6 +230,9 @@ private:
   std::string m_InputProjectionRef;
   std::string m_OutputProjectionRef;
 
+  LocalisationGridType::ConstPointer m_InputLocalisationGrid;
+  LocalisationGridType::ConstPointer m_OutputLocalisationGrid;
+
   SpacingType m_InputSpacing;
   OriginType  m_InputOrigin;
   SpacingType m_OutputSpacing;
@@ -27,9 +27,13 @@
 #include "itkMetaDataObject.h"
 
 #include "otbGeoInformationConversion.h"
+#include "otbSensorModelBase.h"
+#include "otbLocalisationGridTransform.h"
 
 #include "ogr_spatialref.h"
 
+#include <vector>
+
 namespace otb
 {
 
@@ -153,6 +157,17 @@ GenericRSTransform<TScalarType, NInputDimensions, NOutputDimensions>
       m_InputTransform = sensorModel.GetPointer();
       inputTransformIsSensor = true;
       otbMsgDevMacro(<< "Input projection set to sensor model.");
+
+      if (InputSpaceDimension == 2 && m_InputLocalisationGrid.IsNotNull() && m_InputLocalisationGrid->IsGenerated())
+        {
+        typedef otb::LocalisationGridTransform<TransformDirection::FORWARD, double, InputSpaceDimension, InputSpaceDimension>
+            ForwardGridTransformType;
+        typename ForwardGridTransformType::Pointer gridTransform = ForwardGridTransformType::New();
+        gridTransform->SetGrid(m_InputLocalisationGrid);
+        gridTransform->SetFallbackTransform(sensorModel);
+        m_InputTransform = gridTransform.GetPointer();
+        otbMsgDevMacro(<< "Input sensor model interpolated in the localisation grid.");
+        }
       }
     }
 
@@ -214,6 +229,17 @@ GenericRSTransform<TScalarType, NInputDimensions, NOutputDimensions>
       m_OutputTransform = sensorModel.GetPointer();
       outputTransformIsSensor = true;
       otbMsgDevMacro(<< "Output projection set to sensor model");
+
+      if (InputSpaceDimension == 2 && m_OutputLocalisationGrid.IsNotNull() && m_OutputLocalisationGrid->IsGenerated())
+        {
+        typedef otb::LocalisationGridTransform<TransformDirection::INVERSE, double, InputSpaceDimension, OutputSpaceDimension>
+            InverseGridTransformType;
+        typename InverseGridTransformType::Pointer gridTransform = InverseGridTransformType::New();
+        gridTransform->SetGrid(m_OutputLocalisationGrid);
+        gridTransform->SetFallbackTransform(sensorModel);
+        m_OutputTransform = gridTransform.GetPointer();
+        otbMsgDevMacro(<< "Output sensor model interpolated in the localisation grid.");
+        }
       }
     }
 
@@ -280,6 +306,90 @@ GenericRSTransform<TScalarType, NInputDimensions, NOutputDimensions>
   return outputPoint;
 }
 
+template<class TScalarType, unsigned int NInputDimensions, unsigned int NOutputDimensions>
+void
+GenericRSTransform<TScalarType, NInputDimensions, NOutputDimensions>
+::TransformPoints(const InputPointType * inputPoints, OutputPointType * outputPoints, unsigned long nbPoints) const
+{
+  if (nbPoints == 0)
+    {
+    return;
+    }
+
+  // Apply input origin/spacing
+  std::vector<InputPointType> points(inputPoints, inputPoints + nbPoints);
+  for (unsigned long i = 0; i < nbPoints; ++i)
+    {
+    points[i][0] = points[i][0] * m_InputSpacing[0] + m_InputOrigin[0];
+    points[i][1] = points[i][1] * m_InputSpacing[1] + m_InputOrigin[1];
+    }
+
+  // Transform points
+  this->GetTransform()->TransformPoints(&points[0], outputPoints, nbPoints);
+
+  // Apply output origin/spacing
+  for (unsigned long i = 0; i < nbPoints; ++i)
+    {
+    outputPoints[i][0] = (outputPoints[i][0] - m_OutputOrigin[0]) / m_OutputSpacing[0];
+    outputPoints[i][1] = (outputPoints[i][1] - m_OutputOrigin[1]) / m_OutputSpacing[1];
+    }
+}
+
+template<class TScalarType, unsigned int NInputDimensions, unsigned int NOutputDimensions>
+itk::LightObject::Pointer
+GenericRSTransform<TScalarType, NInputDimensions, NOutputDimensions>
+::InternalClone() const
+{
+  typedef SensorModelBase<double, NInputDimensions, NOutputDimensions> SensorModelType;
+  typedef LocalisationGridTransform<TransformDirection::FORWARD, double, NInputDimensions, NInputDimensions>
+      ForwardGridTransformType;
+  typedef LocalisationGridTransform<TransformDirection::INVERSE, double, NInputDimensions, NOutputDimensions>
+      InverseGridTransformType;
+
+  Pointer clone = Self::New();
+
+  // Members are copied directly: the setters would invalidate the transform
+  clone->m_InputKeywordList = m_InputKeywordList;
+  clone->m_OutputKeywordList = m_OutputKeywordList;
+  clone->m_InputDictionary = m_InputDictionary;
+  clone->m_OutputDictionary = m_OutputDictionary;
+  clone->m_InputProjectionRef = m_InputProjectionRef;
+  clone->m_OutputProjectionRef = m_OutputProjectionRef;
+  clone->m_InputLocalisationGrid = m_InputLocalisationGrid;
+  clone->m_OutputLocalisationGrid = m_OutputLocalisationGrid;
+  clone->m_InputSpacing = m_InputSpacing;
+  clone->m_InputOrigin = m_InputOrigin;
+  clone->m_OutputSpacing = m_OutputSpacing;
+  clone->m_OutputOrigin = m_OutputOrigin;
+  clone->m_TransformAccuracy = m_TransformAccuracy;
+
+  if (m_TransformUpToDate && m_Transform.IsNotNull())
+    {
+    // Sensor models, including the ones used outside of the localisation
+    // grids, are not thread safe, map projections are
+    clone->m_InputTransform = m_InputTransform;
+    if (dynamic_cast<const SensorModelType *>(m_InputTransform.GetPointer()) != ITK_NULLPTR
+        || dynamic_cast<const ForwardGridTransformType *>(m_InputTransform.GetPointer()) != ITK_NULLPTR)
+      {
+      clone->m_InputTransform = m_InputTransform->Clone();
+      }
+    clone->m_OutputTransform = m_OutputTransform;
+    if (dynamic_cast<const SensorModelType *>(m_OutputTransform.GetPointer()) != ITK_NULLPTR
+        || dynamic_cast<const InverseGridTransformType *>(m_OutputTransform.GetPointer()) != ITK_NULLPTR)
+      {
+      clone->m_OutputTransform = m_OutputTransform->Clone();
+      }
+
+    clone->m_Transform = TransformType::New();
+    clone->m_Transform->SetFirstTransform(clone->m_InputTransform);
+    clone->m_Transform->SetSecondTransform(clone->m_OutputTransform);
+    clone->m_TransformUpToDate = true;
+    }
+
+  itk::LightObject::Pointer result = clone.GetPointer();
+  return result;
+}
+
 template<class TScalarType, unsigned int NInputDimensions, unsigned int NOutputDimensions>
 bool
 GenericRSTransform<TScalarType, NInputDimensions, NOutputDimensions>
@@ -299,6 +409,10 @@ GenericRSTransform<TScalarType, NInputDimensions, NOutputDimensions>
   inverseTransform->SetInputKeywordList(m_OutputKeywordList);
   inverseTransform->SetOutputKeywordList(m_InputKeywordList);
 
+  // Switch localisation grids
+  inverseTransform->SetInputLocalisationGrid(m_OutputLocalisationGrid);
+  inverseTransform->SetOutputLocalisationGrid(m_InputLocalisationGrid);
+
   // Switch dictionnaries
   inverseTransform->SetInputDictionary(m_OutputDictionary);
   inverseTransform->SetOutputDictionary(m_InputDictionary);
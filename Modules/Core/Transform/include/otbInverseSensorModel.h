@@ -75,6 +75,12 @@ public:
 
   // Transform of geographic point in image sensor index
   OutputPointType TransformPoint(const InputPointType& point) const ITK_OVERRIDE;
+
+  /** Compute the image coordinates of a batch of points. */
+  void TransformPoints(const InputPointType * inputPoints,
+                       OutputPointType * outputPoints,
+                       unsigned long nbPoints) const ITK_OVERRIDE;
+
   // Transform of geographic point in image sensor index -- Backward Compatibility
   //  OutputPointType TransformPoint(const InputPointType &point, double height) const;
 
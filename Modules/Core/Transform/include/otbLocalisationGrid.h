@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbLocalisationGrid_h
+#define otbLocalisationGrid_h
+
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+#include "otbImageKeywordlist.h"
+#include "OTBTransformExport.h"
+
+#include <string>
+#include <vector>
+
+namespace otb
+{
+
+/** \class LocalisationGrid
+ *
+ * \brief Sampled forward and inverse localisation of a sensor model.
+ *
+ * The grid holds two regular grids of nodes computed once with the exact
+ * sensor model and the elevation settings of DEMHandler:
+ *  - a forward grid, sampled every Spacing pixels over the image area, which
+ *    stores the longitude, latitude and height above ellipsoid of each node;
+ *  - an inverse grid, with the same number of nodes, sampled over the
+ *    longitude/latitude footprint of the image plus a margin of one node,
+ *    which stores the image coordinates of each node at the DEM height.
+ *
+ * ForwardTransform() and InverseTransform() then bilinearly interpolate the
+ * nodes, which is much faster than the ossim inversions but only as accurate
+ * as the node spacing allows over rugged terrain. Image coordinates are
+ * expressed in the frame of ForwardSensorModel and InverseSensorModel.
+ *
+ * The grid is tied to a product and an elevation setup by its signature, a
+ * hash of the image keywordlist, the DEM directory, the geoid file, the
+ * default height, the image area and the node spacing. It can be written to
+ * a 5-band GeoTIFF file next to the product and read back by any later
+ * process: LoadOrGenerate() reads the cached grid if its signature matches,
+ * and generates and writes it otherwise.
+ *
+ * \sa LocalisationGridTransform
+ *
+ * \ingroup OTBTransform
+ */
+class OTBTransform_EXPORT LocalisationGrid : public itk::Object
+{
+public:
+  /** Standard class typedefs. */
+  typedef LocalisationGrid              Self;
+  typedef itk::Object                   Superclass;
+  typedef itk::SmartPointer<Self>       Pointer;
+  typedef itk::SmartPointer<const Self> ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(LocalisationGrid, itk::Object);
+
+  /** Set/Get the distance between two forward grid nodes, in pixels */
+  itkSetMacro(Spacing, unsigned int);
+  itkGetConstMacro(Spacing, unsigned int);
+
+  /** Get the signature of the grid, empty if it is not generated */
+  itkGetConstReferenceMacro(Signature, std::string);
+
+  /** True if the grid holds nodes */
+  bool IsGenerated() const;
+
+  /** Compute the nodes of the sensor model described by kwl, over the image
+   * area starting at (startX, startY) with a size of (sizeX, sizeY) */
+  void Generate(const ImageKeywordlist& kwl,
+                double startX, double startY, double sizeX, double sizeY);
+
+  /** Write the grid to a GeoTIFF file. Returns false on failure. */
+  bool Write(const std::string& filename) const;
+
+  /** Read a grid written by Write(). Returns false on failure. */
+  bool Read(const std::string& filename);
+
+  /** Read the grid cached in filename if it was computed for the same
+   * product, elevation setup and area, otherwise generate it and write it to
+   * filename. If the file can not be written, the grid is only kept in
+   * memory. Returns true if the cached grid was used. */
+  bool LoadOrGenerate(const std::string& filename, const ImageKeywordlist& kwl,
+                      double startX, double startY, double sizeX, double sizeY);
+
+  /** Signature of a grid computed for the given product and area with the
+   * current DEMHandler settings */
+  std::string ComputeSignature(const ImageKeywordlist& kwl,
+                               double startX, double startY, double sizeX, double sizeY) const;
+
+  /** Name of the cache file of the grid of an image: the image file name
+   * with a .locgrid.tif extension */
+  static std::string GetCacheFileName(const std::string& imageFileName);
+
+  /** Interpolate the ground position of an image point. Returns false if the
+   * point is outside the grid. */
+  bool ForwardTransform(double x, double y, double& lon, double& lat, double& h) const;
+
+  /** Interpolate the image position of a ground point. Returns false if the
+   * point is outside the grid. */
+  bool InverseTransform(double lon, double lat, double& x, double& y) const;
+
+protected:
+  LocalisationGrid();
+  ~LocalisationGrid() ITK_OVERRIDE {}
+
+  void PrintSelf(std::ostream& os, itk::Indent indent) const ITK_OVERRIDE;
+
+private:
+  LocalisationGrid(const Self &); //purposely not implemented
+  void operator =(const Self&); //purposely not implemented
+
+  /** Regular grid of nodes with interleaved values */
+  struct NodeGrid
+  {
+    double              Origin[2];
+    double              Step[2];
+    unsigned int        NumberOfBands;
+    std::vector<double> Values;
+  };
+
+  /** Bilinear interpolation of the values of a grid at (u, v) */
+  bool Interpolate(const NodeGrid& grid, double u, double v, double * values) const;
+
+  unsigned int m_Spacing;
+  unsigned int m_Size[2];
+  std::string  m_Signature;
+  NodeGrid     m_ForwardGrid;
+  NodeGrid     m_InverseGrid;
+};
+
+} // end namespace otb
+
+#endif
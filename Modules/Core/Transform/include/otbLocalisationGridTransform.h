@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbLocalisationGridTransform_h
+#define otbLocalisationGridTransform_h
+
+#include "otbTransform.h"
+#include "otbGenericMapProjection.h"
+#include "otbLocalisationGrid.h"
+
+namespace otb
+{
+
+/** \class LocalisationGridTransform
+ *  \brief Sensor model transform interpolated in a LocalisationGrid
+ *
+ * The FORWARD direction transforms image points to longitude/latitude (and
+ * height above ellipsoid if the output has 3 dimensions), like
+ * ForwardSensorModel. The INVERSE direction transforms longitude/latitude
+ * points to image points, like InverseSensorModel.
+ *
+ * Points outside the grid are transformed by the fallback transform, which
+ * is usually the exact sensor model the grid was computed from. Without a
+ * fallback transform, their coordinates are set to NaN.
+ *
+ * \sa LocalisationGrid
+ *
+ * \ingroup Projection
+ *
+ * \ingroup OTBTransform
+ */
+template <TransformDirection::TransformationDirection TDirectionOfMapping,
+    class TScalarType = double,
+    unsigned int NInputDimensions = 2,
+    unsigned int NOutputDimensions = 2>
+class ITK_EXPORT LocalisationGridTransform : public Transform<TScalarType,
+      NInputDimensions,
+      NOutputDimensions>
+{
+public:
+  /** Standard class typedefs. */
+  typedef Transform<TScalarType,
+      NInputDimensions,
+      NOutputDimensions>                Superclass;
+  typedef LocalisationGridTransform     Self;
+  typedef itk::SmartPointer<Self>       Pointer;
+  typedef itk::SmartPointer<const Self> ConstPointer;
+
+  typedef typename Superclass::ScalarType           ScalarType;
+  typedef itk::Point<ScalarType, NInputDimensions>  InputPointType;
+  typedef itk::Point<ScalarType, NOutputDimensions> OutputPointType;
+
+  typedef LocalisationGrid                                             GridType;
+  typedef itk::Transform<double, NInputDimensions, NOutputDimensions> FallbackTransformType;
+  typedef Transform<double, NInputDimensions, NOutputDimensions>      BatchFallbackTransformType;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(LocalisationGridTransform, Transform);
+
+  static const TransformDirection::TransformationDirection DirectionOfMapping = TDirectionOfMapping;
+
+  itkStaticConstMacro(InputSpaceDimension, unsigned int, NInputDimensions);
+  itkStaticConstMacro(OutputSpaceDimension, unsigned int, NOutputDimensions);
+  itkStaticConstMacro(SpaceDimension, unsigned int, NInputDimensions);
+  itkStaticConstMacro(ParametersDimension, unsigned int, NInputDimensions * (NInputDimensions + 1));
+
+  /** Set/Get the localisation grid */
+  itkSetConstObjectMacro(Grid, GridType);
+  itkGetConstObjectMacro(Grid, GridType);
+
+  /** Set/Get the transform used outside of the grid */
+  itkSetObjectMacro(FallbackTransform, FallbackTransformType);
+  itkGetConstObjectMacro(FallbackTransform, FallbackTransformType);
+
+  OutputPointType TransformPoint(const InputPointType& point) const ITK_OVERRIDE;
+
+  /** Transform a batch of points. Points outside the grid are gathered and
+   * transformed in one batch by the fallback transform. */
+  void TransformPoints(const InputPointType * inputPoints,
+                       OutputPointType * outputPoints,
+                       unsigned long nbPoints) const ITK_OVERRIDE;
+
+protected:
+  LocalisationGridTransform();
+  ~LocalisationGridTransform() ITK_OVERRIDE {}
+
+  void PrintSelf(std::ostream& os, itk::Indent indent) const ITK_OVERRIDE;
+
+  /** Clone sharing the grid but with its own copy of the fallback
+   * transform, which may be a sensor model */
+  itk::LightObject::Pointer InternalClone() const ITK_OVERRIDE;
+
+private:
+  LocalisationGridTransform(const Self &); //purposely not implemented
+  void operator =(const Self&); //purposely not implemented
+
+  /** Interpolate one point in the grid, returns false if it is outside */
+  bool Interpolate(const InputPointType& inputPoint, OutputPointType& outputPoint) const;
+
+  typename GridType::ConstPointer           m_Grid;
+  typename FallbackTransformType::Pointer   m_FallbackTransform;
+};
+
+} // namespace otb
+
+#ifndef OTB_MANUAL_INSTANTIATION
+#include "otbLocalisationGridTransform.txx"
+#endif
+
+#endif
@@ -0,0 +1,183 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbLocalisationGridTransform_txx
+#define otbLocalisationGridTransform_txx
+
+#include "otbLocalisationGridTransform.h"
+
+#include <limits>
+#include <vector>
+
+namespace otb
+{
+
+template<TransformDirection::TransformationDirection TDirectionOfMapping, class TScalarType, unsigned int NInputDimensions,
+    unsigned int NOutputDimensions>
+LocalisationGridTransform<TDirectionOfMapping, TScalarType, NInputDimensions, NOutputDimensions>
+::LocalisationGridTransform() : Superclass(ParametersDimension)
+{
+}
+
+template<TransformDirection::TransformationDirection TDirectionOfMapping, class TScalarType, unsigned int NInputDimensions,
+    unsigned int NOutputDimensions>
+bool
+LocalisationGridTransform<TDirectionOfMapping, TScalarType, NInputDimensions, NOutputDimensions>
+::Interpolate(const InputPointType& inputPoint, OutputPointType& outputPoint) const
+{
+  if (m_Grid.IsNull())
+    {
+    return false;
+    }
+
+  if (DirectionOfMapping == TransformDirection::FORWARD)
+    {
+    double lon, lat, h;
+    if (!m_Grid->ForwardTransform(inputPoint[0], inputPoint[1], lon, lat, h))
+      {
+      return false;
+      }
+    outputPoint[0] = lon;
+    outputPoint[1] = lat;
+    if (OutputPointType::PointDimension == 3)
+      {
+      outputPoint[2] = h;
+      }
+    }
+  else
+    {
+    double x, y;
+    if (!m_Grid->InverseTransform(inputPoint[0], inputPoint[1], x, y))
+      {
+      return false;
+      }
+    outputPoint[0] = x;
+    outputPoint[1] = y;
+    if (OutputPointType::PointDimension == 3)
+      {
+      outputPoint[2] = InputPointType::PointDimension == 3 ? inputPoint[2] : 0.;
+      }
+    }
+  return true;
+}
+
+template<TransformDirection::TransformationDirection TDirectionOfMapping, class TScalarType, unsigned int NInputDimensions,
+    unsigned int NOutputDimensions>
+typename LocalisationGridTransform<TDirectionOfMapping, TScalarType, NInputDimensions, NOutputDimensions>::OutputPointType
+LocalisationGridTransform<TDirectionOfMapping, TScalarType, NInputDimensions, NOutputDimensions>
+::TransformPoint(const InputPointType& point) const
+{
+  OutputPointType outputPoint;
+  if (!this->Interpolate(point, outputPoint))
+    {
+    if (m_FallbackTransform.IsNotNull())
+      {
+      return m_FallbackTransform->TransformPoint(point);
+      }
+    outputPoint.Fill(std::numeric_limits<ScalarType>::quiet_NaN());
+    }
+  return outputPoint;
+}
+
+template<TransformDirection::TransformationDirection TDirectionOfMapping, class TScalarType, unsigned int NInputDimensions,
+    unsigned int NOutputDimensions>
+void
+LocalisationGridTransform<TDirectionOfMapping, TScalarType, NInputDimensions, NOutputDimensions>
+::TransformPoints(const InputPointType * inputPoints, OutputPointType * outputPoints, unsigned long nbPoints) const
+{
+  std::vector<unsigned long> misses;
+  for (unsigned long i = 0; i < nbPoints; ++i)
+    {
+    if (!this->Interpolate(inputPoints[i], outputPoints[i]))
+      {
+      misses.push_back(i);
+      }
+    }
+
+  if (misses.empty())
+    {
+    return;
+    }
+
+  if (m_FallbackTransform.IsNull())
+    {
+    for (unsigned long i = 0; i < misses.size(); ++i)
+      {
+      outputPoints[misses[i]].Fill(std::numeric_limits<ScalarType>::quiet_NaN());
+      }
+    return;
+    }
+
+  const BatchFallbackTransformType * batchTransform =
+    dynamic_cast<const BatchFallbackTransformType *>(m_FallbackTransform.GetPointer());
+  if (batchTransform == ITK_NULLPTR)
+    {
+    for (unsigned long i = 0; i < misses.size(); ++i)
+      {
+      outputPoints[misses[i]] = m_FallbackTransform->TransformPoint(inputPoints[misses[i]]);
+      }
+    return;
+    }
+
+  std::vector<InputPointType> missedInputs(misses.size());
+  std::vector<OutputPointType> missedOutputs(misses.size());
+  for (unsigned long i = 0; i < misses.size(); ++i)
+    {
+    missedInputs[i] = inputPoints[misses[i]];
+    }
+  batchTransform->TransformPoints(&missedInputs[0], &missedOutputs[0], misses.size());
+  for (unsigned long i = 0; i < misses.size(); ++i)
+    {
+    outputPoints[misses[i]] = missedOutputs[i];
+    }
+}
+
+template<TransformDirection::TransformationDirection TDirectionOfMapping, class TScalarType, unsigned int NInputDimensions,
+    unsigned int NOutputDimensions>
+itk::LightObject::Pointer
+LocalisationGridTransform<TDirectionOfMapping, TScalarType, NInputDimensions, NOutputDimensions>
+::InternalClone() const
+{
+  Pointer clone = Self::New();
+  clone->m_Grid = m_Grid;
+  if (m_FallbackTransform.IsNotNull())
+    {
+    clone->m_FallbackTransform = m_FallbackTransform->Clone();
+    }
+
+  itk::LightObject::Pointer result = clone.GetPointer();
+  return result;
+}
+
+template<TransformDirection::TransformationDirection TDirectionOfMapping, class TScalarType, unsigned int NInputDimensions,
+    unsigned int NOutputDimensions>
+void
+LocalisationGridTransform<TDirectionOfMapping, TScalarType, NInputDimensions, NOutputDimensions>
+::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "Direction: " << (DirectionOfMapping == TransformDirection::FORWARD ? "forward" : "inverse") << std::endl;
+  os << indent << "Grid: " << m_Grid.GetPointer() << std::endl;
+  os << indent << "Fallback transform: " << m_FallbackTransform.GetPointer() << std::endl;
+}
+
+} // namespace otb
+
+#endif
@@ -97,6 +97,10 @@ protected:
   /** PrintSelf method */
   void PrintSelf(std::ostream& os, itk::Indent indent) const ITK_OVERRIDE;
 
+  /** Clone with its own copy of the sensor model, so that the clone can be
+   * used concurrently with this instance */
+  itk::LightObject::Pointer InternalClone() const ITK_OVERRIDE;
+
   /** ImageKeywordlist */
   ImageKeywordlist m_ImageKeywordlist;
   /** Pointer on an ossim projection (created with the keywordlist) */
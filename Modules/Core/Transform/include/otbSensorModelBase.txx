@@ -66,6 +66,25 @@ SensorModelBase<TScalarType, NInputDimensions, NOutputDimensions>
   m_Model->CreateProjection(m_ImageKeywordlist);
 }
 
+template <class TScalarType,
+    unsigned int NInputDimensions,
+    unsigned int NOutputDimensions>
+itk::LightObject::Pointer
+SensorModelBase<TScalarType, NInputDimensions, NOutputDimensions>
+::InternalClone() const
+{
+  // CreateAnother() keeps the type of the derived sensor model
+  itk::LightObject::Pointer result = this->CreateAnother();
+  Self * clone = dynamic_cast<Self *>(result.GetPointer());
+  if (clone == ITK_NULLPTR)
+    {
+    itkExceptionMacro(<< "Downcast to type " << this->GetNameOfClass() << " failed.");
+    }
+  clone->m_ImageKeywordlist = m_ImageKeywordlist;
+  clone->m_Model = m_Model->Clone();
+  return result;
+}
+
 /**
  * PrintSelf method
  */
@@ -23,10 +23,51 @@
 
 #include "itkWarpImageFilter.h"
 #include "otbStreamingTraits.h"
+#include "otbImage.h"
+#include "otbVectorImage.h"
+
+#include <limits>
 
 namespace otb
 {
 
+namespace internal
+{
+/** \class WarpImageBufferTraits
+ * \brief Images whose buffer can be read and written by the warping kernels
+ * of StreamingWarpImageFilter: 2D otb::VectorImage and 2D otb::Image of a
+ * scalar type, seen as rows of pixels with contiguous components.
+ *
+ * \ingroup OTBTransform
+ */
+template <class TImage>
+struct WarpImageBufferTraits
+{
+  static const bool IsSupported = false;
+  typedef double ComponentType;
+};
+
+template <class TPixel, unsigned int VImageDimension>
+struct WarpImageBufferTraits<otb::VectorImage<TPixel, VImageDimension> >
+{
+  static const bool IsSupported = (VImageDimension == 2);
+  typedef TPixel ComponentType;
+};
+
+template <class TPixel, unsigned int VImageDimension>
+struct WarpImageBufferTraits<otb::Image<TPixel, VImageDimension> >
+{
+  static const bool IsSupported = (VImageDimension == 2) && std::numeric_limits<TPixel>::is_specialized;
+  typedef TPixel ComponentType;
+};
+
+/** Tag selecting the kernel path at compile time */
+template <bool VSupported>
+struct WarpKernelTag
+{
+};
+}
+
 /** \class StreamingWarpImageFilter
  * \brief This class acts like the itk::WarpImageFilter, but it does not request the largest possible region of the image to warp.
  *
@@ -40,6 +81,14 @@ namespace otb
  * If the maximum displacement is wrong, this filter is likely to request data outside of the input image buffered region. In this case, pixels
  * outside the region will be set to Zero according to itk::NumericTraits.
  *
+ * For 2D otb::VectorImage and scalar otb::Image, the nearest neighbour,
+ * linear and BCO interpolators are replaced by inline kernels working on
+ * the image buffers. They compute the same values as the interpolators,
+ * with the same operations, but process all the components of a pixel
+ * together in contiguous loops, without bounds checking nor pixel
+ * temporaries. Other interpolators and image types go through
+ * itk::WarpImageFilter.
+ *
  * \sa itk::WarpImageFilter
  *
  * \ingroup Streamed
@@ -98,6 +147,9 @@ protected:
 
   void GenerateOutputInformation() ITK_OVERRIDE;
 
+  /** Select the warping kernel matching the interpolator */
+  void BeforeThreadedGenerateData() ITK_OVERRIDE;
+
   /**
    * Re-implement the method ThreadedGenerateData to mask area outside the deformation grid
    */
@@ -108,8 +160,37 @@ private:
   StreamingWarpImageFilter(const Self &); //purposely not implemented
   void operator =(const Self&); //purposely not implemented
 
+  typedef typename Superclass::DisplacementType DisplacementType;
+
+  typedef internal::WarpKernelTag<internal::WarpImageBufferTraits<InputImageType>::IsSupported
+                                  && internal::WarpImageBufferTraits<OutputImageType>::IsSupported> KernelTagType;
+
+  /** Warping kernels */
+  typedef enum {NO_KERNEL, NEAREST_KERNEL, LINEAR_KERNEL, BCO_KERNEL} WarpKernelType;
+
+  /** Warp the region of the thread with the selected kernel */
+  void KernelThreadedGenerateData(const OutputImageRegionType& outputRegionForThread,
+                                  itk::ThreadIdType threadId,
+                                  const internal::WarpKernelTag<true> &);
+  void KernelThreadedGenerateData(const OutputImageRegionType&,
+                                  itk::ThreadIdType,
+                                  const internal::WarpKernelTag<false> &) {}
+
+  /** Select the kernel, only for the supported image types */
+  WarpKernelType SelectKernel(const internal::WarpKernelTag<true> &) const;
+  WarpKernelType SelectKernel(const internal::WarpKernelTag<false> &) const
+  {
+    return NO_KERNEL;
+  }
+
   // Assessment of the maximum displacement for streaming
   DisplacementValueType m_MaximumDisplacement;
+
+  // Kernel used for the current update
+  WarpKernelType m_WarpKernel;
+
+  // True if the displacement field has the geometry of the output
+  bool m_FieldSameInformation;
 };
 
 } // end namespace otb
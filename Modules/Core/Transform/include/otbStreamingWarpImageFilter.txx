@@ -26,14 +26,168 @@
 #include "itkImageRegionIteratorWithIndex.h"
 #include "itkDefaultConvertPixelTraits.h"
 #include "itkMetaDataObject.h"
+#include "itkNearestNeighborInterpolateImageFunction.h"
+#include "itkLinearInterpolateImageFunction.h"
+#include "itkProgressReporter.h"
+#include "otbBCOInterpolateImageFunction.h"
 #include "otbMetaDataKey.h"
+#include "otbMacro.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
 
 namespace otb
 {
 
+namespace internal
+{
+/** Read access to the buffer of a 2D image */
+template <class TComponent>
+struct WarpInputBuffer
+{
+  const TComponent * m_Data;
+  long               m_StartX;
+  long               m_StartY;
+  long               m_EndX;
+  long               m_EndY;
+  long               m_SizeX;
+  unsigned int       m_NumberOfComponents;
+
+  const TComponent * GetPixel(long x, long y) const
+  {
+    return m_Data + ((y - m_StartY) * m_SizeX + (x - m_StartX)) * m_NumberOfComponents;
+  }
+};
+
+/** Nearest neighbour, as itk::NearestNeighborInterpolateImageFunction */
+template <class TComponent>
+inline void WarpNearest(const WarpInputBuffer<TComponent> & buffer, const double * index, double * value)
+{
+  const long x = std::min(std::max(itk::Math::RoundHalfIntegerUp<long>(index[0]), buffer.m_StartX), buffer.m_EndX);
+  const long y = std::min(std::max(itk::Math::RoundHalfIntegerUp<long>(index[1]), buffer.m_StartY), buffer.m_EndY);
+  const TComponent * pixel = buffer.GetPixel(x, y);
+  for (unsigned int k = 0; k < buffer.m_NumberOfComponents; ++k)
+    {
+    value[k] = static_cast<double>(pixel[k]);
+    }
+}
+
+/** Linear interpolation, with the operations of the 2D case of
+ *  itk::LinearInterpolateImageFunction */
+template <class TComponent>
+inline void WarpLinear(const WarpInputBuffer<TComponent> & buffer, const double * index, double * value)
+{
+  const unsigned int nbComponents = buffer.m_NumberOfComponents;
+
+  long x = itk::Math::Floor<long>(index[0]);
+  long y = itk::Math::Floor<long>(index[1]);
+  if (x < buffer.m_StartX)
+    {
+    x = buffer.m_StartX;
+    }
+  if (y < buffer.m_StartY)
+    {
+    y = buffer.m_StartY;
+    }
+  const double distance0 = index[0] - static_cast<double>(x);
+  const double distance1 = index[1] - static_cast<double>(y);
+
+  const TComponent * p00 = buffer.GetPixel(x, y);
+
+  // Neighbours used along each direction
+  const bool alongX = distance0 > 0. && x + 1 <= buffer.m_EndX;
+  const bool alongY = distance1 > 0. && y + 1 <= buffer.m_EndY;
+
+  if (alongX && alongY)
+    {
+    const TComponent * p10 = p00 + nbComponents;
+    const TComponent * p01 = buffer.GetPixel(x, y + 1);
+    const TComponent * p11 = p01 + nbComponents;
+    for (unsigned int k = 0; k < nbComponents; ++k)
+      {
+      const double val00 = p00[k];
+      const double val01 = p01[k];
+      const double valx0 = val00 + (static_cast<double>(p10[k]) - val00) * distance0;
+      const double valx1 = val01 + (static_cast<double>(p11[k]) - val01) * distance0;
+      value[k] = valx0 + (valx1 - valx0) * distance1;
+      }
+    }
+  else if (alongX)
+    {
+    const TComponent * p10 = p00 + nbComponents;
+    for (unsigned int k = 0; k < nbComponents; ++k)
+      {
+      const double val00 = p00[k];
+      value[k] = val00 + (static_cast<double>(p10[k]) - val00) * distance0;
+      }
+    }
+  else if (alongY)
+    {
+    const TComponent * p01 = buffer.GetPixel(x, y + 1);
+    for (unsigned int k = 0; k < nbComponents; ++k)
+      {
+      const double val00 = p00[k];
+      value[k] = val00 + (static_cast<double>(p01[k]) - val00) * distance1;
+      }
+    }
+  else
+    {
+    for (unsigned int k = 0; k < nbComponents; ++k)
+      {
+      value[k] = static_cast<double>(p00[k]);
+      }
+    }
+}
+
+/** BCO interpolation, with the operations of otb::BCOInterpolateImageFunction.
+ *  The window is read row by row, each column sum being accumulated in the
+ *  same order as the interpolator does. */
+template <class TComponent>
+inline void WarpBCO(const WarpInputBuffer<TComponent> & buffer, const double * index, unsigned int radius,
+                    const double * coefX, const double * coefY, double * columns, double * value)
+{
+  const unsigned int nbComponents = buffer.m_NumberOfComponents;
+  const unsigned int winSize = 2 * radius + 1;
+  const long baseX = itk::Math::Floor<long>(index[0] + 0.5);
+  const long baseY = itk::Math::Floor<long>(index[1] + 0.5);
+
+  std::fill(columns, columns + winSize * nbComponents, 0.);
+
+  for (unsigned int j = 0; j < winSize; ++j)
+    {
+    const long y = std::min(std::max(baseY + static_cast<long>(j) - static_cast<long>(radius), buffer.m_StartY),
+                            buffer.m_EndY);
+    double * column = columns;
+    for (unsigned int i = 0; i < winSize; ++i, column += nbComponents)
+      {
+      const long x = std::min(std::max(baseX + static_cast<long>(i) - static_cast<long>(radius), buffer.m_StartX),
+                              buffer.m_EndX);
+      const TComponent * pixel = buffer.GetPixel(x, y);
+      for (unsigned int k = 0; k < nbComponents; ++k)
+        {
+        column[k] += pixel[k] * coefY[j];
+        }
+      }
+    }
+
+  std::fill(value, value + nbComponents, 0.);
+  const double * column = columns;
+  for (unsigned int i = 0; i < winSize; ++i, column += nbComponents)
+    {
+    for (unsigned int k = 0; k < nbComponents; ++k)
+      {
+      value[k] += column[k] * coefX[i];
+      }
+    }
+}
+}
+
 template<class TInputImage, class TOutputImage, class TDisplacementField>
 StreamingWarpImageFilter<TInputImage, TOutputImage, TDisplacementField>
 ::StreamingWarpImageFilter()
+  : m_WarpKernel(NO_KERNEL),
+    m_FieldSameInformation(false)
  {
   // Fill the default maximum displacement
   m_MaximumDisplacement.Fill(1);
@@ -247,6 +401,61 @@ StreamingWarpImageFilter<TInputImage, TOutputImage, TDisplacementField>
   itk::EncapsulateMetaData<std::vector<double> >(dict,MetaDataKey::NoDataValue,noDataValue);
 }
 
+template<class TInputImage, class TOutputImage, class TDisplacementField>
+void
+StreamingWarpImageFilter<TInputImage, TOutputImage, TDisplacementField>
+::BeforeThreadedGenerateData()
+{
+  Superclass::BeforeThreadedGenerateData();
+
+  const OutputImageType * outputPtr = this->GetOutput();
+  const DisplacementFieldType * fieldPtr = this->GetDisplacementField();
+
+  m_FieldSameInformation =
+    outputPtr->GetLargestPossibleRegion() == fieldPtr->GetLargestPossibleRegion()
+    && outputPtr->GetSpacing() == fieldPtr->GetSpacing()
+    && outputPtr->GetOrigin() == fieldPtr->GetOrigin()
+    && outputPtr->GetDirection() == fieldPtr->GetDirection();
+
+  m_WarpKernel = this->SelectKernel(KernelTagType());
+  otbMsgDevMacro(<< "Warping kernel: " << m_WarpKernel);
+}
+
+template<class TInputImage, class TOutputImage, class TDisplacementField>
+typename StreamingWarpImageFilter<TInputImage, TOutputImage, TDisplacementField>::WarpKernelType
+StreamingWarpImageFilter<TInputImage, TOutputImage, TDisplacementField>
+::SelectKernel(const internal::WarpKernelTag<true> &) const
+{
+  typedef typename Superclass::CoordRepType CoordRepType;
+  typedef itk::NearestNeighborInterpolateImageFunction<InputImageType, CoordRepType> NearestType;
+  typedef itk::LinearInterpolateImageFunction<InputImageType, CoordRepType>          LinearType;
+  typedef BCOInterpolateImageFunction<InputImageType, CoordRepType>                  BCOType;
+
+  const InputImageType * inputPtr = this->GetInput();
+  if (inputPtr->GetNumberOfComponentsPerPixel() != this->GetOutput()->GetNumberOfComponentsPerPixel())
+    {
+    return NO_KERNEL;
+    }
+
+  // Derived interpolators may change the evaluation, only the exact
+  // classes are replaced by kernels
+  const typename Superclass::InterpolatorType * interpolator = this->GetInterpolator();
+  const char * name = interpolator->GetNameOfClass();
+  if (dynamic_cast<const NearestType *>(interpolator) && std::strcmp(name, "NearestNeighborInterpolateImageFunction") == 0)
+    {
+    return NEAREST_KERNEL;
+    }
+  if (dynamic_cast<const LinearType *>(interpolator) && std::strcmp(name, "LinearInterpolateImageFunction") == 0)
+    {
+    return LINEAR_KERNEL;
+    }
+  if (dynamic_cast<const BCOType *>(interpolator) && std::strcmp(name, "BCOInterpolateImageFunction") == 0)
+    {
+    return BCO_KERNEL;
+    }
+  return NO_KERNEL;
+}
+
 template<class TInputImage, class TOutputImage, class TDisplacementField>
 void
 StreamingWarpImageFilter<TInputImage, TOutputImage, TDisplacementField>
@@ -254,6 +463,12 @@ StreamingWarpImageFilter<TInputImage, TOutputImage, TDisplacementField>
   const OutputImageRegionType& outputRegionForThread,
   itk::ThreadIdType threadId )
   {
+  if (m_WarpKernel != NO_KERNEL)
+    {
+    this->KernelThreadedGenerateData(outputRegionForThread, threadId, KernelTagType());
+    return;
+    }
+
   // the superclass itk::WarpImageFilter is doing the actual warping
   Superclass::ThreadedGenerateData(outputRegionForThread,threadId);
 
@@ -290,6 +505,138 @@ StreamingWarpImageFilter<TInputImage, TOutputImage, TDisplacementField>
     }
   }
 
+
+template<class TInputImage, class TOutputImage, class TDisplacementField>
+void
+StreamingWarpImageFilter<TInputImage, TOutputImage, TDisplacementField>
+::KernelThreadedGenerateData(
+  const OutputImageRegionType& outputRegionForThread,
+  itk::ThreadIdType threadId,
+  const internal::WarpKernelTag<true> &)
+{
+  typedef typename internal::WarpImageBufferTraits<InputImageType>::ComponentType  InputComponentType;
+  typedef typename internal::WarpImageBufferTraits<OutputImageType>::ComponentType OutputComponentType;
+  typedef BCOInterpolateImageFunction<InputImageType, typename Superclass::CoordRepType> BCOType;
+
+  const InputImageType * inputPtr = this->GetInput();
+  OutputImagePointerType outputPtr = this->GetOutput();
+  DisplacementFieldPointerType fieldPtr = this->GetDisplacementField();
+  const typename Superclass::InterpolatorType * interpolator = this->GetInterpolator();
+
+  const unsigned int nbComponents = inputPtr->GetNumberOfComponentsPerPixel();
+
+  // Input buffer, as seen by the interpolator
+  const typename InputImageType::RegionType & inputRegion = inputPtr->GetBufferedRegion();
+  internal::WarpInputBuffer<InputComponentType> buffer;
+  buffer.m_Data   = inputPtr->GetBufferPointer();
+  buffer.m_StartX = inputRegion.GetIndex()[0];
+  buffer.m_StartY = inputRegion.GetIndex()[1];
+  buffer.m_EndX   = buffer.m_StartX + static_cast<long>(inputRegion.GetSize()[0]) - 1;
+  buffer.m_EndY   = buffer.m_StartY + static_cast<long>(inputRegion.GetSize()[1]) - 1;
+  buffer.m_SizeX  = inputRegion.GetSize()[0];
+  buffer.m_NumberOfComponents = nbComponents;
+
+  // Edge padding components
+  const PixelType paddingValue = this->GetEdgePaddingValue();
+  std::vector<OutputComponentType> padding(nbComponents);
+  for (unsigned int k = 0; k < nbComponents; ++k)
+    {
+    padding[k] = static_cast<OutputComponentType>(
+      itk::DefaultConvertPixelTraits<PixelType>::GetNthComponent(k, paddingValue));
+    }
+
+  // BCO parameters and work buffers
+  const BCOType * bco = dynamic_cast<const BCOType *>(interpolator);
+  const unsigned int radius = bco ? bco->GetRadius() : 0;
+  std::vector<double> coefX(2 * radius + 1), coefY(2 * radius + 1);
+  std::vector<double> columns((2 * radius + 1) * nbComponents);
+  std::vector<double> value(nbComponents);
+
+  const DisplacementFieldRegionType defRegion = fieldPtr->GetLargestPossibleRegion();
+
+  const unsigned long lineLength = outputRegionForThread.GetSize()[0];
+  itk::ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels() / lineLength);
+
+  IndexType index = outputRegionForThread.GetIndex();
+  const IndexType lineStart = index;
+  PointType point;
+  DisplacementType displacement;
+  itk::NumericTraits<DisplacementType>::SetLength(displacement, DisplacementFieldType::ImageDimension);
+  itk::ContinuousIndex<double, DisplacementFieldType::ImageDimension> fieldIndex;
+  itk::ContinuousIndex<typename Superclass::CoordRepType, InputImageType::ImageDimension> inputIndex;
+
+  for (unsigned long line = 0; line < outputRegionForThread.GetSize()[1]; ++line)
+    {
+    index[0] = lineStart[0];
+    index[1] = lineStart[1] + line;
+    OutputComponentType * out = outputPtr->GetBufferPointer() + outputPtr->ComputeOffset(index) * nbComponents;
+
+    for (unsigned long i = 0; i < lineLength; ++i, ++index[0], out += nbComponents)
+      {
+      outputPtr->TransformIndexToPhysicalPoint(index, point);
+
+      // Mask the area outside the displacement grid
+      fieldPtr->TransformPhysicalPointToContinuousIndex(point, fieldIndex);
+      bool inside = true;
+      for (unsigned int dim = 0; dim < DisplacementFieldType::ImageDimension; ++dim)
+        {
+        if (fieldIndex[dim] < static_cast<double>(defRegion.GetIndex(dim)) ||
+            fieldIndex[dim] > static_cast<double>(defRegion.GetIndex(dim)+defRegion.GetSize(dim)-1))
+          {
+          inside = false;
+          }
+        }
+
+      if (inside)
+        {
+        // Same displacement and input point as itk::WarpImageFilter
+        if (m_FieldSameInformation)
+          {
+          displacement = fieldPtr->GetPixel(index);
+          }
+        else
+          {
+          this->EvaluateDisplacementAtPhysicalPoint(point, displacement);
+          }
+        for (unsigned int dim = 0; dim < InputImageType::ImageDimension; ++dim)
+          {
+          point[dim] += displacement[dim];
+          }
+        inputPtr->TransformPhysicalPointToContinuousIndex(point, inputIndex);
+        inside = interpolator->IsInsideBuffer(inputIndex);
+        }
+
+      if (!inside)
+        {
+        std::copy(padding.begin(), padding.end(), out);
+        continue;
+        }
+
+      switch (m_WarpKernel)
+        {
+        case NEAREST_KERNEL:
+          internal::WarpNearest(buffer, inputIndex.GetDataPointer(), &value[0]);
+          break;
+        case LINEAR_KERNEL:
+          internal::WarpLinear(buffer, inputIndex.GetDataPointer(), &value[0]);
+          break;
+        default:
+          bco->ComputeCoefficients(inputIndex[0], &coefX[0]);
+          bco->ComputeCoefficients(inputIndex[1], &coefY[0]);
+          internal::WarpBCO(buffer, inputIndex.GetDataPointer(), radius, &coefX[0], &coefY[0], &columns[0], &value[0]);
+          break;
+        }
+
+      for (unsigned int k = 0; k < nbComponents; ++k)
+        {
+        out[k] = static_cast<OutputComponentType>(value[k]);
+        }
+      }
+
+    progress.CompletedPixel();
+    }
+}
+
 template<class TInputImage, class TOutputImage, class TDisplacementField>
 void
 StreamingWarpImageFilter<TInputImage, TOutputImage, TDisplacementField>
@@ -100,6 +100,40 @@ public:
 
   OutputPointType TransformPoint(const InputPointType  & ) const ITK_OVERRIDE
     { return OutputPointType(); }
+
+  /** Method to transform nbPoints points stored in contiguous arrays.
+   * Subclasses whose per point cost is dominated by call overhead should
+   * override it. The default implementation calls TransformPoint(). */
+  virtual void TransformPoints(const InputPointType * inputPoints,
+                               OutputPointType * outputPoints,
+                               unsigned long nbPoints) const
+  {
+    for (unsigned long i = 0; i < nbPoints; ++i)
+      {
+      outputPoints[i] = this->TransformPoint(inputPoints[i]);
+      }
+  }
+
+  /** Transform nbPoints points with any itk::Transform, using
+   * TransformPoints() if the transform is an otb::Transform. */
+  static void BatchTransformPoints(const Superclass * transform,
+                                   const InputPointType * inputPoints,
+                                   OutputPointType * outputPoints,
+                                   unsigned long nbPoints)
+  {
+    const Self * otbTransform = dynamic_cast<const Self *>(transform);
+    if (otbTransform != ITK_NULLPTR)
+      {
+      otbTransform->TransformPoints(inputPoints, outputPoints, nbPoints);
+      }
+    else
+      {
+      for (unsigned long i = 0; i < nbPoints; ++i)
+        {
+        outputPoints[i] = transform->TransformPoint(inputPoints[i]);
+        }
+      }
+  }
   
   using Superclass::TransformVector;
   /**  Method to transform a vector. */
@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbTransformToDisplacementFieldSource_h
+#define otbTransformToDisplacementFieldSource_h
+
+#include "itkTransformToDisplacementFieldSource.h"
+
+#include <vector>
+
+namespace otb
+{
+
+/** \class TransformToDisplacementFieldSource
+ * \brief Generate a displacement field from a transform, one line of points at a time.
+ *
+ * This class acts like the itk::TransformToDisplacementFieldSource, but the
+ * points of each line of the output region are transformed in a single call
+ * to otb::Transform::TransformPoints(), so that transforms with a costly per
+ * point overhead (sensor models, map projections) can process them as a
+ * batch.
+ *
+ * When several threads are used, each thread works with its own clone of the
+ * transform (see itk::Transform::Clone()), since sensor models are not thread
+ * safe. Clones are kept between updates as long as the transform is not
+ * modified. If the transform cannot be cloned, it is shared by all threads.
+ *
+ * If a tolerance is set (see SetTolerance()), the field is estimated on an
+ * adaptive quadtree instead of transforming every point (2D only). The grid
+ * is split into cells of InitialCellSize points, aligned on the largest
+ * possible region. The transform is evaluated at the corners of each cell,
+ * at the middle of its edges and at its center. If a bilinear interpolation
+ * of the corners predicts all these points within the tolerance, the other
+ * points of the cell are interpolated, otherwise the cell is split in four.
+ * Cells are processed level by level, so that the points of a level are
+ * transformed in a single batch. The estimated field does not depend on the
+ * streaming or threading of the output. A null tolerance (default)
+ * transforms every point, which is the reference for accuracy and
+ * performance comparisons.
+ *
+ * \sa itk::TransformToDisplacementFieldSource
+ *
+ * \ingroup Threaded
+ *
+ * \ingroup OTBTransform
+ */
+template <class TOutputImage, class TTransformPrecisionType = double>
+class ITK_EXPORT TransformToDisplacementFieldSource
+  : public itk::TransformToDisplacementFieldSource<TOutputImage, TTransformPrecisionType>
+{
+public:
+  /** Standard class typedefs. */
+  typedef TransformToDisplacementFieldSource                      Self;
+  typedef itk::TransformToDisplacementFieldSource<TOutputImage,
+                                                  TTransformPrecisionType> Superclass;
+  typedef itk::SmartPointer<Self>                                 Pointer;
+  typedef itk::SmartPointer<const Self>                           ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(TransformToDisplacementFieldSource, itk::TransformToDisplacementFieldSource);
+
+  typedef typename Superclass::OutputImageType       OutputImageType;
+  typedef typename Superclass::OutputImageRegionType OutputImageRegionType;
+  typedef typename Superclass::TransformType         TransformType;
+  typedef typename Superclass::PixelType             PixelType;
+  typedef typename Superclass::PixelValueType        PixelValueType;
+  typedef typename Superclass::IndexType             IndexType;
+  typedef typename TransformType::InputPointType     InputPointType;
+  typedef typename TransformType::OutputPointType    OutputPointType;
+
+  /** Maximum interpolation error of the displacement, in the units of the
+   * transform output space. The adaptive estimation is used when it is
+   * strictly positive. */
+  itkSetMacro(Tolerance, double);
+  itkGetConstMacro(Tolerance, double);
+
+  /** Size, in points of the field, of the largest adaptive cells */
+  itkSetMacro(InitialCellSize, unsigned int);
+  itkGetConstMacro(InitialCellSize, unsigned int);
+
+  /** Number of points transformed during the last update */
+  itkGetConstMacro(NumberOfTransformedPoints, itk::SizeValueType);
+
+protected:
+  TransformToDisplacementFieldSource();
+  ~TransformToDisplacementFieldSource() ITK_OVERRIDE {}
+
+  /** Set up the transforms of the threads */
+  void BeforeThreadedGenerateData(void) ITK_OVERRIDE;
+
+  void ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
+                            itk::ThreadIdType threadId) ITK_OVERRIDE;
+
+  void AfterThreadedGenerateData(void) ITK_OVERRIDE;
+
+  /** Transform every point, one line at a time */
+  void LineThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
+                                itk::ThreadIdType threadId);
+
+  /** Adaptive estimation on a quadtree */
+  void AdaptiveThreadedGenerateData(const OutputImageRegionType & outputRegionForThread,
+                                    itk::ThreadIdType threadId);
+
+  void PrintSelf(std::ostream& os, itk::Indent indent) const ITK_OVERRIDE;
+
+private:
+  TransformToDisplacementFieldSource(const Self &); //purposely not implemented
+  void operator =(const Self&); //purposely not implemented
+
+  typedef typename TransformType::ConstPointer TransformConstPointerType;
+
+  /** Transforms used by the threads, the first one being the transform set
+   * by the user */
+  std::vector<TransformConstPointerType> m_ThreadTransforms;
+
+  /** Modification time of the transform when it was cloned */
+  itk::ModifiedTimeType m_ThreadTransformsMTime;
+
+  double       m_Tolerance;
+  unsigned int m_InitialCellSize;
+
+  itk::SizeValueType              m_NumberOfTransformedPoints;
+  std::vector<itk::SizeValueType> m_ThreadNumberOfTransformedPoints;
+};
+
+} // end namespace otb
+
+#ifndef OTB_MANUAL_INSTANTIATION
+#include "otbTransformToDisplacementFieldSource.txx"
+#endif
+
+#endif
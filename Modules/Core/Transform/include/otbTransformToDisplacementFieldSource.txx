@@ -0,0 +1,445 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbTransformToDisplacementFieldSource_txx
+#define otbTransformToDisplacementFieldSource_txx
+
+#include "otbTransformToDisplacementFieldSource.h"
+#include "otbTransform.h"
+#include "otbMacro.h"
+
+#include "itkImageScanlineIterator.h"
+#include "itkProgressReporter.h"
+
+#include <algorithm>
+
+namespace otb
+{
+
+namespace internal
+{
+/** Cell of the adaptive displacement grid, with inclusive bounds */
+struct DisplacementGridCell
+{
+  long x0, y0, x1, y1;
+};
+
+/** Bounds of the children of [v0, v1] along one dimension */
+inline unsigned int SplitDisplacementGridInterval(long v0, long v1, long * bounds)
+{
+  bounds[0] = v0;
+  if (v1 == v0)
+    {
+    return 1;
+    }
+  if (v1 - v0 == 1)
+    {
+    bounds[1] = v1;
+    return 2;
+    }
+  bounds[1] = (v0 + v1) / 2;
+  bounds[2] = v1;
+  return 3;
+}
+}
+
+template <class TOutputImage, class TTransformPrecisionType>
+TransformToDisplacementFieldSource<TOutputImage, TTransformPrecisionType>
+::TransformToDisplacementFieldSource()
+  : m_ThreadTransformsMTime(0),
+    m_Tolerance(0.),
+    m_InitialCellSize(16),
+    m_NumberOfTransformedPoints(0)
+{
+}
+
+template <class TOutputImage, class TTransformPrecisionType>
+void
+TransformToDisplacementFieldSource<TOutputImage, TTransformPrecisionType>
+::BeforeThreadedGenerateData()
+{
+  Superclass::BeforeThreadedGenerateData();
+
+  if (m_Tolerance > 0. && OutputImageType::ImageDimension != 2)
+    {
+    itkExceptionMacro(<< "Adaptive estimation of the displacement field is only available in 2D");
+    }
+
+  const TransformType * transform = this->GetTransform();
+  const unsigned int nbThreads = this->GetNumberOfThreads();
+
+  m_ThreadNumberOfTransformedPoints.assign(nbThreads, 0);
+
+  if (!m_ThreadTransforms.empty()
+      && m_ThreadTransforms[0] == transform
+      && m_ThreadTransformsMTime == transform->GetMTime()
+      && m_ThreadTransforms.size() >= nbThreads)
+    {
+    // Clones are still valid
+    return;
+    }
+
+  m_ThreadTransforms.assign(nbThreads, transform);
+  m_ThreadTransformsMTime = transform->GetMTime();
+
+  try
+    {
+    for (unsigned int threadId = 1; threadId < nbThreads; ++threadId)
+      {
+      m_ThreadTransforms[threadId] = transform->Clone().GetPointer();
+      }
+    }
+  catch (itk::ExceptionObject &)
+    {
+    otbMsgDevMacro(<< "Transform " << transform->GetNameOfClass() << " can not be cloned, it is shared by all threads");
+    m_ThreadTransforms.assign(nbThreads, transform);
+    }
+}
+
+template <class TOutputImage, class TTransformPrecisionType>
+void
+TransformToDisplacementFieldSource<TOutputImage, TTransformPrecisionType>
+::ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread, itk::ThreadIdType threadId)
+{
+  if (outputRegionForThread.GetNumberOfPixels() == 0)
+    {
+    return;
+    }
+
+  if (m_Tolerance > 0.)
+    {
+    this->AdaptiveThreadedGenerateData(outputRegionForThread, threadId);
+    }
+  else
+    {
+    this->LineThreadedGenerateData(outputRegionForThread, threadId);
+    }
+}
+
+template <class TOutputImage, class TTransformPrecisionType>
+void
+TransformToDisplacementFieldSource<TOutputImage, TTransformPrecisionType>
+::AfterThreadedGenerateData()
+{
+  m_NumberOfTransformedPoints = 0;
+  for (unsigned int threadId = 0; threadId < m_ThreadNumberOfTransformedPoints.size(); ++threadId)
+    {
+    m_NumberOfTransformedPoints += m_ThreadNumberOfTransformedPoints[threadId];
+    }
+  otbMsgDevMacro(<< m_NumberOfTransformedPoints << " points transformed for "
+                 << this->GetOutput()->GetRequestedRegion().GetNumberOfPixels() << " displacements");
+}
+
+template <class TOutputImage, class TTransformPrecisionType>
+void
+TransformToDisplacementFieldSource<TOutputImage, TTransformPrecisionType>
+::LineThreadedGenerateData(const OutputImageRegionType & outputRegionForThread, itk::ThreadIdType threadId)
+{
+  typedef Transform<TTransformPrecisionType,
+                    OutputImageType::ImageDimension,
+                    OutputImageType::ImageDimension> OTBTransformType;
+
+  OutputImageType * outputPtr = this->GetOutput();
+  const TransformType * transform = m_ThreadTransforms[threadId];
+
+  const unsigned long lineLength = outputRegionForThread.GetSize()[0];
+  const unsigned long nbLines = outputRegionForThread.GetNumberOfPixels() / lineLength;
+
+  itk::ProgressReporter progress(this, threadId, nbLines);
+
+  std::vector<InputPointType>  inputPoints(lineLength);
+  std::vector<OutputPointType> outputPoints(lineLength);
+
+  itk::ImageScanlineIterator<OutputImageType> outIt(outputPtr, outputRegionForThread);
+
+  while (!outIt.IsAtEnd())
+    {
+    // Physical points of the line
+    IndexType index = outIt.GetIndex();
+    for (unsigned long i = 0; i < lineLength; ++i, ++index[0])
+      {
+      outputPtr->TransformIndexToPhysicalPoint(index, inputPoints[i]);
+      }
+
+    OTBTransformType::BatchTransformPoints(transform, &inputPoints[0], &outputPoints[0], lineLength);
+    m_ThreadNumberOfTransformedPoints[threadId] += lineLength;
+
+    for (unsigned long i = 0; i < lineLength; ++i, ++outIt)
+      {
+      PixelType displacement;
+      for (unsigned int dim = 0; dim < OutputImageType::ImageDimension; ++dim)
+        {
+        displacement[dim] = static_cast<PixelValueType>(outputPoints[i][dim] - inputPoints[i][dim]);
+        }
+      outIt.Set(displacement);
+      }
+
+    outIt.NextLine();
+    progress.CompletedPixel();
+    }
+}
+
+template <class TOutputImage, class TTransformPrecisionType>
+void
+TransformToDisplacementFieldSource<TOutputImage, TTransformPrecisionType>
+::AdaptiveThreadedGenerateData(const OutputImageRegionType & outputRegionForThread, itk::ThreadIdType threadId)
+{
+  typedef Transform<TTransformPrecisionType,
+                    OutputImageType::ImageDimension,
+                    OutputImageType::ImageDimension> OTBTransformType;
+  typedef internal::DisplacementGridCell             CellType;
+
+  // State of the points of the local grid
+  enum {UNKNOWN = 0, INTERPOLATED, PENDING, EXACT};
+
+  OutputImageType * outputPtr = this->GetOutput();
+  const TransformType * transform = m_ThreadTransforms[threadId];
+  const OutputImageRegionType largestRegion = outputPtr->GetLargestPossibleRegion();
+  const long cellSize = std::max(m_InitialCellSize, 2u);
+
+  // Local grid covering all the cells which touch the region of the thread,
+  // so that each point gets the same value whatever the splitting
+  long begin[2], end[2];
+  for (unsigned int dim = 0; dim < 2; ++dim)
+    {
+    const long origin = largestRegion.GetIndex()[dim];
+    const long last   = origin + static_cast<long>(largestRegion.GetSize()[dim]) - 1;
+    const long start  = outputRegionForThread.GetIndex()[dim] - origin;
+    const long stop   = start + static_cast<long>(outputRegionForThread.GetSize()[dim]) - 1;
+    begin[dim] = origin + (start > 0 ? ((start - 1) / cellSize) * cellSize : 0);
+    end[dim]   = std::min(origin + (stop / cellSize + 1) * cellSize, last);
+    }
+  const long width  = end[0] - begin[0] + 1;
+  const long height = end[1] - begin[1] + 1;
+
+  std::vector<PixelType>     values(width * height);
+  std::vector<unsigned char> states(width * height, UNKNOWN);
+
+  std::vector<long>            pending;
+  std::vector<InputPointType>  inputPoints;
+  std::vector<OutputPointType> outputPoints;
+
+  // Top level cells and their corners
+  std::vector<CellType> cells, nextCells;
+  for (long y0 = begin[1]; ; y0 += cellSize)
+    {
+    const long y1 = std::min(y0 + cellSize, end[1]);
+    for (long x0 = begin[0]; ; x0 += cellSize)
+      {
+      const long x1 = std::min(x0 + cellSize, end[0]);
+      CellType cell = {x0, y0, x1, y1};
+      cells.push_back(cell);
+      if (x1 >= end[0]) break;
+      }
+    if (y1 >= end[1]) break;
+    }
+
+  bool firstLevel = true;
+  while (!cells.empty())
+    {
+    // Points to transform at this level: corners of the top level cells,
+    // then middle points of the cells
+    pending.clear();
+    for (std::vector<CellType>::const_iterator cellIt = cells.begin(); cellIt != cells.end(); ++cellIt)
+      {
+      long xs[3], ys[3];
+      const unsigned int nx = internal::SplitDisplacementGridInterval(cellIt->x0, cellIt->x1, xs);
+      const unsigned int ny = internal::SplitDisplacementGridInterval(cellIt->y0, cellIt->y1, ys);
+      for (unsigned int j = 0; j < ny; ++j)
+        {
+        for (unsigned int i = 0; i < nx; ++i)
+          {
+          const bool isCorner = (i == 0 || i == nx - 1) && (j == 0 || j == ny - 1);
+          if (isCorner != firstLevel)
+            {
+            continue;
+            }
+          const long offset = (ys[j] - begin[1]) * width + (xs[i] - begin[0]);
+          if (states[offset] != EXACT && states[offset] != PENDING)
+            {
+            states[offset] = PENDING;
+            pending.push_back(offset);
+            }
+          }
+        }
+      }
+
+    if (!pending.empty())
+      {
+      inputPoints.resize(pending.size());
+      outputPoints.resize(pending.size());
+      for (unsigned long k = 0; k < pending.size(); ++k)
+        {
+        IndexType index;
+        index[0] = begin[0] + pending[k] % width;
+        index[1] = begin[1] + pending[k] / width;
+        outputPtr->TransformIndexToPhysicalPoint(index, inputPoints[k]);
+        }
+
+      OTBTransformType::BatchTransformPoints(transform, &inputPoints[0], &outputPoints[0], pending.size());
+      m_ThreadNumberOfTransformedPoints[threadId] += pending.size();
+
+      for (unsigned long k = 0; k < pending.size(); ++k)
+        {
+        PixelType displacement;
+        for (unsigned int dim = 0; dim < 2; ++dim)
+          {
+          displacement[dim] = static_cast<PixelValueType>(outputPoints[k][dim] - inputPoints[k][dim]);
+          }
+        values[pending[k]] = displacement;
+        states[pending[k]] = EXACT;
+        }
+      }
+
+    if (firstLevel)
+      {
+      // Corners are known, test the cells
+      firstLevel = false;
+      continue;
+      }
+
+    // Interpolate the cells predicted within tolerance, split the others
+    nextCells.clear();
+    for (std::vector<CellType>::const_iterator cellIt = cells.begin(); cellIt != cells.end(); ++cellIt)
+      {
+      long xs[3], ys[3];
+      const unsigned int nx = internal::SplitDisplacementGridInterval(cellIt->x0, cellIt->x1, xs);
+      const unsigned int ny = internal::SplitDisplacementGridInterval(cellIt->y0, cellIt->y1, ys);
+      if (nx < 3 && ny < 3)
+        {
+        // All the points of the cell are corners
+        continue;
+        }
+
+      const PixelType & c00 = values[(cellIt->y0 - begin[1]) * width + (cellIt->x0 - begin[0])];
+      const PixelType & c10 = values[(cellIt->y0 - begin[1]) * width + (cellIt->x1 - begin[0])];
+      const PixelType & c01 = values[(cellIt->y1 - begin[1]) * width + (cellIt->x0 - begin[0])];
+      const PixelType & c11 = values[(cellIt->y1 - begin[1]) * width + (cellIt->x1 - begin[0])];
+      const double dx = static_cast<double>(std::max(cellIt->x1 - cellIt->x0, 1L));
+      const double dy = static_cast<double>(std::max(cellIt->y1 - cellIt->y0, 1L));
+
+      bool accurate = true;
+      for (unsigned int j = 0; j < ny && accurate; ++j)
+        {
+        const double v = (ys[j] - cellIt->y0) / dy;
+        for (unsigned int i = 0; i < nx && accurate; ++i)
+          {
+          const double u = (xs[i] - cellIt->x0) / dx;
+          const PixelType & exact = values[(ys[j] - begin[1]) * width + (xs[i] - begin[0])];
+          for (unsigned int dim = 0; dim < 2; ++dim)
+            {
+            const double predicted = (1. - u) * (1. - v) * c00[dim] + u * (1. - v) * c10[dim]
+              + (1. - u) * v * c01[dim] + u * v * c11[dim];
+            if (vcl_abs(predicted - exact[dim]) > m_Tolerance)
+              {
+              accurate = false;
+              }
+            }
+          }
+        }
+
+      if (!accurate)
+        {
+        for (unsigned int j = 0; j + 1 < ny; ++j)
+          {
+          for (unsigned int i = 0; i + 1 < nx; ++i)
+            {
+            CellType child = {xs[i], ys[j], xs[i + 1], ys[j + 1]};
+            nextCells.push_back(child);
+            }
+          }
+        if (nx == 1)
+          {
+          for (unsigned int j = 0; j + 1 < ny; ++j)
+            {
+            CellType child = {xs[0], ys[j], xs[0], ys[j + 1]};
+            nextCells.push_back(child);
+            }
+          }
+        if (ny == 1)
+          {
+          for (unsigned int i = 0; i + 1 < nx; ++i)
+            {
+            CellType child = {xs[i], ys[0], xs[i + 1], ys[0]};
+            nextCells.push_back(child);
+            }
+          }
+        continue;
+        }
+
+      for (long y = cellIt->y0; y <= cellIt->y1; ++y)
+        {
+        const double v = (y - cellIt->y0) / dy;
+        for (long x = cellIt->x0; x <= cellIt->x1; ++x)
+          {
+          const long offset = (y - begin[1]) * width + (x - begin[0]);
+          if (states[offset] == EXACT)
+            {
+            continue;
+            }
+          const double u = (x - cellIt->x0) / dx;
+          PixelType displacement;
+          for (unsigned int dim = 0; dim < 2; ++dim)
+            {
+            displacement[dim] = static_cast<PixelValueType>((1. - u) * (1. - v) * c00[dim] + u * (1. - v) * c10[dim]
+                                                            + (1. - u) * v * c01[dim] + u * v * c11[dim]);
+            }
+          values[offset] = displacement;
+          states[offset] = INTERPOLATED;
+          }
+        }
+      }
+
+    cells.swap(nextCells);
+    }
+
+  // Copy the region of the thread from the local grid
+  const unsigned long lineLength = outputRegionForThread.GetSize()[0];
+  itk::ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels() / lineLength);
+
+  itk::ImageScanlineIterator<OutputImageType> outIt(outputPtr, outputRegionForThread);
+  while (!outIt.IsAtEnd())
+    {
+    const IndexType index = outIt.GetIndex();
+    typename std::vector<PixelType>::const_iterator valueIt =
+      values.begin() + (index[1] - begin[1]) * width + (index[0] - begin[0]);
+    for (unsigned long i = 0; i < lineLength; ++i, ++outIt, ++valueIt)
+      {
+      outIt.Set(*valueIt);
+      }
+    outIt.NextLine();
+    progress.CompletedPixel();
+    }
+}
+
+template <class TOutputImage, class TTransformPrecisionType>
+void
+TransformToDisplacementFieldSource<TOutputImage, TTransformPrecisionType>
+::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "Tolerance: " << m_Tolerance << std::endl;
+  os << indent << "InitialCellSize: " << m_InitialCellSize << std::endl;
+  os << indent << "NumberOfTransformedPoints: " << m_NumberOfTransformedPoints << std::endl;
+}
+
+} // end namespace otb
+
+#endif
@@ -0,0 +1,520 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbLocalisationGrid.h"
+
+#include "otbSensorModelAdapter.h"
+#include "otbDEMHandler.h"
+#include "otbMacro.h"
+
+#include "itkMultiThreader.h"
+#include "itkIntTypes.h"
+#include "itksys/SystemTools.hxx"
+#include "vnl/vnl_math.h"
+
+#include "gdal.h"
+#include "cpl_conv.h"
+#include "cpl_error.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+namespace otb
+{
+
+namespace
+{
+const unsigned int k_MinimumNumberOfNodes = 4;
+const char * const k_Signature     = "OTB_LOCGRID_SIGNATURE";
+const char * const k_Spacing       = "OTB_LOCGRID_SPACING";
+const char * const k_ForwardOrigin = "OTB_LOCGRID_FORWARD_ORIGIN";
+const char * const k_ForwardStep   = "OTB_LOCGRID_FORWARD_STEP";
+const char * const k_InverseOrigin = "OTB_LOCGRID_INVERSE_ORIGIN";
+const char * const k_InverseStep   = "OTB_LOCGRID_INVERSE_STEP";
+
+/** Rows of a grid to localise with one sensor model per thread */
+struct GenerationStruct
+{
+  std::vector<SensorModelAdapter::Pointer> Models;
+  bool                                     Inverse;
+  const double *                           Origin;
+  const double *                           Step;
+  const unsigned int *                     Size;
+  double *                                 Values;
+  unsigned int                             NumberOfBands;
+};
+
+ITK_THREAD_RETURN_TYPE GenerationThreaderCallback(void *arg)
+{
+  itk::MultiThreader::ThreadInfoStruct* info = static_cast<itk::MultiThreader::ThreadInfoStruct*>(arg);
+  GenerationStruct* str = static_cast<GenerationStruct*>(info->UserData);
+
+  const unsigned int nbRows = str->Size[1];
+  const unsigned int nbColumns = str->Size[0];
+  const unsigned int firstRow = static_cast<unsigned int>(
+    static_cast<itk::uint64_t>(nbRows) * info->ThreadID / info->NumberOfThreads);
+  const unsigned int lastRow = static_cast<unsigned int>(
+    static_cast<itk::uint64_t>(nbRows) * (info->ThreadID + 1) / info->NumberOfThreads);
+  const SensorModelAdapter * model = str->Models[info->ThreadID];
+
+  std::vector<double> u(nbColumns), v(nbColumns), a(nbColumns), b(nbColumns), c(nbColumns);
+
+  for (unsigned int row = firstRow; row < lastRow; ++row)
+    {
+    for (unsigned int col = 0; col < nbColumns; ++col)
+      {
+      u[col] = str->Origin[0] + col * str->Step[0];
+      v[col] = str->Origin[1] + row * str->Step[1];
+      }
+
+    if (str->Inverse)
+      {
+      model->InverseTransformPoints(&u[0], &v[0], ITK_NULLPTR, &a[0], &b[0], &c[0], nbColumns);
+      }
+    else
+      {
+      model->ForwardTransformPoints(&u[0], &v[0], ITK_NULLPTR, &a[0], &b[0], &c[0], nbColumns);
+      }
+
+    double * values = str->Values + static_cast<std::size_t>(row) * nbColumns * str->NumberOfBands;
+    for (unsigned int col = 0; col < nbColumns; ++col, values += str->NumberOfBands)
+      {
+      values[0] = a[col];
+      values[1] = b[col];
+      if (str->NumberOfBands > 2)
+        {
+        values[2] = c[col];
+        }
+      }
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+/** 64 bits FNV-1a hash */
+itk::uint64_t Hash(const std::string & text)
+{
+  itk::uint64_t hash = 14695981039346656037ULL;
+  for (std::string::const_iterator it = text.begin(); it != text.end(); ++it)
+    {
+    hash ^= static_cast<unsigned char>(*it);
+    hash *= 1099511628211ULL;
+    }
+  return hash;
+}
+
+std::string PairToString(const double * values)
+{
+  std::ostringstream oss;
+  oss << std::setprecision(17) << values[0] << " " << values[1];
+  return oss.str();
+}
+
+bool StringToPair(const char * text, double * values)
+{
+  if (text == ITK_NULLPTR)
+    {
+    return false;
+    }
+  std::istringstream iss(text);
+  iss >> values[0] >> values[1];
+  return !iss.fail();
+}
+}
+
+LocalisationGrid::LocalisationGrid()
+  : m_Spacing(16)
+{
+  m_Size[0] = 0;
+  m_Size[1] = 0;
+  m_ForwardGrid.NumberOfBands = 3;
+  m_InverseGrid.NumberOfBands = 2;
+  for (unsigned int dim = 0; dim < 2; ++dim)
+    {
+    m_ForwardGrid.Origin[dim] = 0.;
+    m_ForwardGrid.Step[dim] = 1.;
+    m_InverseGrid.Origin[dim] = 0.;
+    m_InverseGrid.Step[dim] = 1.;
+    }
+}
+
+bool LocalisationGrid::IsGenerated() const
+{
+  return !m_ForwardGrid.Values.empty() && !m_InverseGrid.Values.empty();
+}
+
+void LocalisationGrid::Generate(const ImageKeywordlist& kwl,
+                                double startX, double startY, double sizeX, double sizeY)
+{
+  SensorModelAdapter::Pointer model = SensorModelAdapter::New();
+  model->CreateProjection(kwl);
+  if (!model->IsValidSensorModel())
+    {
+    itkExceptionMacro(<< "Unable to create a sensor model to compute the localisation grid");
+    }
+
+  const unsigned int spacing = std::max(1u, m_Spacing);
+  const double area[2] = {sizeX, sizeY};
+  for (unsigned int dim = 0; dim < 2; ++dim)
+    {
+    m_Size[dim] = std::max(k_MinimumNumberOfNodes,
+                           static_cast<unsigned int>(std::ceil(area[dim] / spacing)) + 1);
+    m_ForwardGrid.Step[dim] = area[dim] / (m_Size[dim] - 1);
+    }
+  m_ForwardGrid.Origin[0] = startX;
+  m_ForwardGrid.Origin[1] = startY;
+
+  const std::size_t nbNodes = static_cast<std::size_t>(m_Size[0]) * m_Size[1];
+  m_ForwardGrid.Values.assign(nbNodes * m_ForwardGrid.NumberOfBands, 0.);
+  m_InverseGrid.Values.assign(nbNodes * m_InverseGrid.NumberOfBands, 0.);
+
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  threader->SetNumberOfThreads(std::min<int>(m_Size[1], itk::MultiThreader::GetGlobalDefaultNumberOfThreads()));
+
+  // Sensor models are not thread safe: each thread gets its own copy
+  GenerationStruct str;
+  str.Models.push_back(model);
+  for (int thread = 1; thread < threader->GetNumberOfThreads(); ++thread)
+    {
+    str.Models.push_back(model->Clone());
+    }
+  str.Size = m_Size;
+
+  // Forward grid over the image area
+  str.Inverse = false;
+  str.Origin = m_ForwardGrid.Origin;
+  str.Step = m_ForwardGrid.Step;
+  str.Values = &m_ForwardGrid.Values[0];
+  str.NumberOfBands = m_ForwardGrid.NumberOfBands;
+  threader->SetSingleMethod(GenerationThreaderCallback, &str);
+  threader->SingleMethodExecute();
+
+  // Inverse grid over the footprint, with a margin of one node
+  double minimum[2] = {std::numeric_limits<double>::max(), std::numeric_limits<double>::max()};
+  double maximum[2] = {-std::numeric_limits<double>::max(), -std::numeric_limits<double>::max()};
+  for (std::size_t node = 0; node < nbNodes; ++node)
+    {
+    const double * values = &m_ForwardGrid.Values[node * m_ForwardGrid.NumberOfBands];
+    for (unsigned int dim = 0; dim < 2; ++dim)
+      {
+      if (!vnl_math_isnan(values[dim]))
+        {
+        minimum[dim] = std::min(minimum[dim], values[dim]);
+        maximum[dim] = std::max(maximum[dim], values[dim]);
+        }
+      }
+    }
+  if (minimum[0] > maximum[0] || minimum[1] > maximum[1])
+    {
+    m_ForwardGrid.Values.clear();
+    m_InverseGrid.Values.clear();
+    itkExceptionMacro(<< "The sensor model did not localise any node of the grid");
+    }
+
+  for (unsigned int dim = 0; dim < 2; ++dim)
+    {
+    m_InverseGrid.Step[dim] = (maximum[dim] - minimum[dim]) / (m_Size[dim] - 3);
+    m_InverseGrid.Origin[dim] = minimum[dim] - m_InverseGrid.Step[dim];
+    }
+
+  str.Inverse = true;
+  str.Origin = m_InverseGrid.Origin;
+  str.Step = m_InverseGrid.Step;
+  str.Values = &m_InverseGrid.Values[0];
+  str.NumberOfBands = m_InverseGrid.NumberOfBands;
+  threader->SingleMethodExecute();
+
+  m_Signature = this->ComputeSignature(kwl, startX, startY, sizeX, sizeY);
+  this->Modified();
+}
+
+std::string LocalisationGrid::ComputeSignature(const ImageKeywordlist& kwl,
+                                               double startX, double startY,
+                                               double sizeX, double sizeY) const
+{
+  std::ostringstream oss;
+  oss << std::setprecision(17);
+
+  const ImageKeywordlist::KeywordlistMap & map = kwl.GetKeywordlist();
+  for (ImageKeywordlist::KeywordlistMap::const_iterator it = map.begin(); it != map.end(); ++it)
+    {
+    oss << it->first << "=" << it->second << "\n";
+    }
+
+  DEMHandler::Pointer demHandler = DEMHandler::Instance();
+  for (unsigned int idx = 0; idx < demHandler->GetDEMCount(); ++idx)
+    {
+    oss << "dem=" << demHandler->GetDEMDirectory(idx) << "\n";
+    }
+  oss << "geoid=" << demHandler->GetGeoidFile() << "\n";
+  oss << "height=" << demHandler->GetDefaultHeightAboveEllipsoid() << "\n";
+  oss << "area=" << startX << " " << startY << " " << sizeX << " " << sizeY << "\n";
+  oss << "spacing=" << m_Spacing << "\n";
+
+  std::ostringstream signature;
+  signature << std::hex << std::setw(16) << std::setfill('0') << Hash(oss.str());
+  return signature.str();
+}
+
+std::string LocalisationGrid::GetCacheFileName(const std::string& imageFileName)
+{
+  // Drop the extended filename options, if any
+  const std::string path = imageFileName.substr(0, imageFileName.find('?'));
+  const std::string directory = itksys::SystemTools::GetFilenamePath(path);
+  const std::string name = itksys::SystemTools::GetFilenameWithoutLastExtension(path) + ".locgrid.tif";
+  return directory.empty() ? name : directory + "/" + name;
+}
+
+bool LocalisationGrid::Write(const std::string& filename) const
+{
+  if (!this->IsGenerated())
+    {
+    return false;
+    }
+
+  GDALAllRegister();
+  GDALDriverH driver = GDALGetDriverByName("GTiff");
+  if (driver == ITK_NULLPTR)
+    {
+    return false;
+    }
+
+  // Write to a temporary file first so that concurrent readers never see a
+  // partial grid
+  const std::string tmpFilename = filename + ".tmp";
+  CPLPushErrorHandler(CPLQuietErrorHandler);
+  GDALDatasetH dataset = GDALCreate(driver, tmpFilename.c_str(), m_Size[0], m_Size[1],
+                                    m_ForwardGrid.NumberOfBands + m_InverseGrid.NumberOfBands,
+                                    GDT_Float64, ITK_NULLPTR);
+  CPLPopErrorHandler();
+  if (dataset == ITK_NULLPTR)
+    {
+    return false;
+    }
+
+  std::ostringstream spacing;
+  spacing << m_Spacing;
+  GDALSetMetadataItem(dataset, k_Signature, m_Signature.c_str(), ITK_NULLPTR);
+  GDALSetMetadataItem(dataset, k_Spacing, spacing.str().c_str(), ITK_NULLPTR);
+  GDALSetMetadataItem(dataset, k_ForwardOrigin, PairToString(m_ForwardGrid.Origin).c_str(), ITK_NULLPTR);
+  GDALSetMetadataItem(dataset, k_ForwardStep, PairToString(m_ForwardGrid.Step).c_str(), ITK_NULLPTR);
+  GDALSetMetadataItem(dataset, k_InverseOrigin, PairToString(m_InverseGrid.Origin).c_str(), ITK_NULLPTR);
+  GDALSetMetadataItem(dataset, k_InverseStep, PairToString(m_InverseGrid.Step).c_str(), ITK_NULLPTR);
+
+  // Bands 1 to 3 hold the forward grid, bands 4 and 5 the inverse grid
+  const NodeGrid * grids[2] = {&m_ForwardGrid, &m_InverseGrid};
+  bool success = true;
+  int bandIndex = 1;
+  for (unsigned int g = 0; g < 2; ++g)
+    {
+    const int pixelStride = static_cast<int>(grids[g]->NumberOfBands * sizeof(double));
+    for (unsigned int band = 0; band < grids[g]->NumberOfBands; ++band, ++bandIndex)
+      {
+      double * values = const_cast<double *>(&grids[g]->Values[band]);
+      success = success
+        && GDALRasterIO(GDALGetRasterBand(dataset, bandIndex), GF_Write, 0, 0, m_Size[0], m_Size[1],
+                        values, m_Size[0], m_Size[1], GDT_Float64,
+                        pixelStride, pixelStride * m_Size[0]) == CE_None;
+      }
+    }
+  GDALClose(dataset);
+
+  if (!success || std::rename(tmpFilename.c_str(), filename.c_str()) != 0)
+    {
+    std::remove(tmpFilename.c_str());
+    return false;
+    }
+  return true;
+}
+
+bool LocalisationGrid::Read(const std::string& filename)
+{
+  GDALAllRegister();
+  CPLPushErrorHandler(CPLQuietErrorHandler);
+  GDALDatasetH dataset = GDALOpen(filename.c_str(), GA_ReadOnly);
+  CPLPopErrorHandler();
+  if (dataset == ITK_NULLPTR)
+    {
+    return false;
+    }
+
+  NodeGrid forwardGrid = m_ForwardGrid;
+  NodeGrid inverseGrid = m_InverseGrid;
+  const char * signature = GDALGetMetadataItem(dataset, k_Signature, ITK_NULLPTR);
+  const char * spacing = GDALGetMetadataItem(dataset, k_Spacing, ITK_NULLPTR);
+  unsigned int size[2] = {static_cast<unsigned int>(GDALGetRasterXSize(dataset)),
+                          static_cast<unsigned int>(GDALGetRasterYSize(dataset))};
+
+  bool success = signature != ITK_NULLPTR && spacing != ITK_NULLPTR
+    && size[0] >= k_MinimumNumberOfNodes && size[1] >= k_MinimumNumberOfNodes
+    && GDALGetRasterCount(dataset) == static_cast<int>(forwardGrid.NumberOfBands + inverseGrid.NumberOfBands)
+    && StringToPair(GDALGetMetadataItem(dataset, k_ForwardOrigin, ITK_NULLPTR), forwardGrid.Origin)
+    && StringToPair(GDALGetMetadataItem(dataset, k_ForwardStep, ITK_NULLPTR), forwardGrid.Step)
+    && StringToPair(GDALGetMetadataItem(dataset, k_InverseOrigin, ITK_NULLPTR), inverseGrid.Origin)
+    && StringToPair(GDALGetMetadataItem(dataset, k_InverseStep, ITK_NULLPTR), inverseGrid.Step);
+
+  NodeGrid * grids[2] = {&forwardGrid, &inverseGrid};
+  int bandIndex = 1;
+  for (unsigned int g = 0; success && g < 2; ++g)
+    {
+    grids[g]->Values.resize(static_cast<std::size_t>(size[0]) * size[1] * grids[g]->NumberOfBands);
+    const int pixelStride = static_cast<int>(grids[g]->NumberOfBands * sizeof(double));
+    for (unsigned int band = 0; success && band < grids[g]->NumberOfBands; ++band, ++bandIndex)
+      {
+      success = GDALRasterIO(GDALGetRasterBand(dataset, bandIndex), GF_Read, 0, 0, size[0], size[1],
+                             &grids[g]->Values[band], size[0], size[1], GDT_Float64,
+                             pixelStride, pixelStride * size[0]) == CE_None;
+      }
+    }
+
+  if (success)
+    {
+    m_Signature = signature;
+    m_Spacing = atoi(spacing);
+    m_Size[0] = size[0];
+    m_Size[1] = size[1];
+    m_ForwardGrid = forwardGrid;
+    m_InverseGrid = inverseGrid;
+    this->Modified();
+    }
+  GDALClose(dataset);
+  return success;
+}
+
+bool LocalisationGrid::LoadOrGenerate(const std::string& filename, const ImageKeywordlist& kwl,
+                                      double startX, double startY, double sizeX, double sizeY)
+{
+  const std::string signature = this->ComputeSignature(kwl, startX, startY, sizeX, sizeY);
+
+  if (itksys::SystemTools::FileExists(filename.c_str(), true))
+    {
+    Pointer cached = Self::New();
+    if (cached->Read(filename) && cached->GetSignature() == signature)
+      {
+      m_Signature = cached->m_Signature;
+      m_Size[0] = cached->m_Size[0];
+      m_Size[1] = cached->m_Size[1];
+      m_ForwardGrid = cached->m_ForwardGrid;
+      m_InverseGrid = cached->m_InverseGrid;
+      this->Modified();
+      otbMsgDevMacro(<< "Localisation grid read from " << filename);
+      return true;
+      }
+    otbMsgDevMacro(<< "Localisation grid " << filename << " is out of date");
+    }
+
+  this->Generate(kwl, startX, startY, sizeX, sizeY);
+
+  if (!this->Write(filename))
+    {
+    otbWarningMacro(<< "Unable to write the localisation grid to " << filename
+                    << ", the grid is only kept in memory");
+    }
+  return false;
+}
+
+bool LocalisationGrid::Interpolate(const NodeGrid& grid, double u, double v, double * values) const
+{
+  // Written so that NaN coordinates are rejected
+  if (!(u >= 0. && v >= 0. && u <= m_Size[0] - 1 && v <= m_Size[1] - 1))
+    {
+    return false;
+    }
+
+  const unsigned int col = std::min(static_cast<unsigned int>(u), m_Size[0] - 2);
+  const unsigned int row = std::min(static_cast<unsigned int>(v), m_Size[1] - 2);
+  const double du = u - col;
+  const double dv = v - row;
+
+  const std::size_t rowStride = static_cast<std::size_t>(m_Size[0]) * grid.NumberOfBands;
+  const double * ul = &grid.Values[row * rowStride + col * grid.NumberOfBands];
+  const double * ur = ul + grid.NumberOfBands;
+  const double * ll = ul + rowStride;
+  const double * lr = ll + grid.NumberOfBands;
+
+  for (unsigned int band = 0; band < grid.NumberOfBands; ++band)
+    {
+    values[band] = (1. - dv) * ((1. - du) * ul[band] + du * ur[band])
+      + dv * ((1. - du) * ll[band] + du * lr[band]);
+    if (vnl_math_isnan(values[band]))
+      {
+      return false;
+      }
+    }
+  return true;
+}
+
+bool LocalisationGrid::ForwardTransform(double x, double y, double& lon, double& lat, double& h) const
+{
+  if (!this->IsGenerated())
+    {
+    return false;
+    }
+
+  double values[3];
+  if (!this->Interpolate(m_ForwardGrid,
+                         (x - m_ForwardGrid.Origin[0]) / m_ForwardGrid.Step[0],
+                         (y - m_ForwardGrid.Origin[1]) / m_ForwardGrid.Step[1], values))
+    {
+    return false;
+    }
+  lon = values[0];
+  lat = values[1];
+  h = values[2];
+  return true;
+}
+
+bool LocalisationGrid::InverseTransform(double lon, double lat, double& x, double& y) const
+{
+  if (!this->IsGenerated())
+    {
+    return false;
+    }
+
+  double values[2];
+  if (!this->Interpolate(m_InverseGrid,
+                         (lon - m_InverseGrid.Origin[0]) / m_InverseGrid.Step[0],
+                         (lat - m_InverseGrid.Origin[1]) / m_InverseGrid.Step[1], values))
+    {
+    return false;
+    }
+  x = values[0];
+  y = values[1];
+  return true;
+}
+
+void LocalisationGrid::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "Spacing: " << m_Spacing << std::endl;
+  os << indent << "Signature: " << m_Signature << std::endl;
+  os << indent << "Number of nodes: " << m_Size[0] << " x " << m_Size[1] << std::endl;
+  os << indent << "Forward origin: " << PairToString(m_ForwardGrid.Origin) << std::endl;
+  os << indent << "Forward step: " << PairToString(m_ForwardGrid.Step) << std::endl;
+  os << indent << "Inverse origin: " << PairToString(m_InverseGrid.Origin) << std::endl;
+  os << indent << "Inverse step: " << PairToString(m_InverseGrid.Step) << std::endl;
+}
+
+} // end namespace otb
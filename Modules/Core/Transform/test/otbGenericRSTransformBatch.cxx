@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <iostream>
+#include <vector>
+
+#include "otbGenericRSTransform.h"
+#include "otbImage.h"
+#include "otbImageFileReader.h"
+#include "otbGeoInformationConversion.h"
+
+typedef otb::Image<unsigned short, 2>   ImageType;
+typedef otb::ImageFileReader<ImageType> ReaderType;
+typedef otb::GenericRSTransform<>       TransformType;
+typedef TransformType::InputPointType   PointType;
+
+namespace
+{
+// Number of points whose batch transform differs from the point by point one
+unsigned int CompareBatch(const TransformType * transform, const TransformType * reference,
+                          const std::vector<PointType> & points, double tolerance)
+{
+  std::vector<PointType> batchPoints(points.size());
+  transform->TransformPoints(&points[0], &batchPoints[0], points.size());
+
+  unsigned int nbErrors = 0;
+  for (unsigned int i = 0; i < points.size(); ++i)
+    {
+    const PointType point = reference->TransformPoint(points[i]);
+    if (vcl_abs(point[0] - batchPoints[i][0]) > tolerance || vcl_abs(point[1] - batchPoints[i][1]) > tolerance)
+      {
+      std::cerr << points[i] << " -> " << batchPoints[i] << " instead of " << point << std::endl;
+      ++nbErrors;
+      }
+    }
+  return nbErrors;
+}
+}
+
+int otbGenericRSTransformBatch(int argc, char* argv[])
+{
+  if (argc != 2)
+    {
+    std::cerr << "Usage: " << argv[0] << " sensorImage" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(argv[1]);
+  reader->UpdateOutputInformation();
+  ImageType::Pointer image = reader->GetOutput();
+
+  // Sensor to WGS84
+  TransformType::Pointer forward = TransformType::New();
+  forward->SetInputKeywordList(image->GetImageKeywordlist());
+  forward->SetOutputProjectionRef(otb::GeoInformationConversion::ToWKT(4326));
+  forward->InstantiateTransform();
+
+  // WGS84 to sensor
+  TransformType::Pointer inverse = TransformType::New();
+  forward->GetInverse(inverse);
+
+  // Grid of image points, one line of the displacement field at a time
+  const ImageType::SizeType size = image->GetLargestPossibleRegion().GetSize();
+  std::vector<PointType> imagePoints;
+  for (unsigned int y = 0; y < size[1]; y += 17)
+    {
+    for (unsigned int x = 0; x < size[0]; x += 13)
+      {
+      PointType point;
+      point[0] = x;
+      point[1] = y;
+      imagePoints.push_back(point);
+      }
+    }
+
+  std::vector<PointType> geoPoints(imagePoints.size());
+  for (unsigned int i = 0; i < imagePoints.size(); ++i)
+    {
+    geoPoints[i] = forward->TransformPoint(imagePoints[i]);
+    }
+
+  unsigned int nbErrors = 0;
+  nbErrors += CompareBatch(forward, forward, imagePoints, 1e-9);
+  nbErrors += CompareBatch(inverse, inverse, geoPoints, 1e-6);
+
+  // Clones have their own sensor models and give the same results
+  TransformType::Pointer forwardClone = dynamic_cast<TransformType *>(forward->Clone().GetPointer());
+  TransformType::Pointer inverseClone = dynamic_cast<TransformType *>(inverse->Clone().GetPointer());
+  if (forwardClone.IsNull() || inverseClone.IsNull() || !forwardClone->IsUpToDate() || !inverseClone->IsUpToDate())
+    {
+    std::cerr << "Clones are not up to date" << std::endl;
+    return EXIT_FAILURE;
+    }
+  nbErrors += CompareBatch(forwardClone, forward, imagePoints, 1e-9);
+  nbErrors += CompareBatch(inverseClone, inverse, geoPoints, 1e-6);
+
+  std::cout << imagePoints.size() << " points, " << nbErrors << " errors" << std::endl;
+
+  return nbErrors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
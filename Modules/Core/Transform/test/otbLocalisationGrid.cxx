@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <iostream>
+#include <vector>
+
+#include "otbGenericRSTransform.h"
+#include "otbLocalisationGrid.h"
+#include "otbImage.h"
+#include "otbImageFileReader.h"
+#include "otbGeoInformationConversion.h"
+#include "itksys/SystemTools.hxx"
+
+typedef otb::Image<unsigned short, 2>   ImageType;
+typedef otb::ImageFileReader<ImageType> ReaderType;
+typedef otb::GenericRSTransform<>       TransformType;
+typedef TransformType::InputPointType   PointType;
+typedef otb::LocalisationGrid           GridType;
+
+namespace
+{
+// Number of points whose interpolated transform is too far from the exact one
+unsigned int CompareToModel(const TransformType * transform, const TransformType * reference,
+                            const std::vector<PointType> & points, double tolerance)
+{
+  std::vector<PointType> gridPoints(points.size());
+  transform->TransformPoints(&points[0], &gridPoints[0], points.size());
+
+  unsigned int nbErrors = 0;
+  for (unsigned int i = 0; i < points.size(); ++i)
+    {
+    const PointType point = reference->TransformPoint(points[i]);
+    if (vcl_abs(point[0] - gridPoints[i][0]) > tolerance || vcl_abs(point[1] - gridPoints[i][1]) > tolerance)
+      {
+      std::cerr << points[i] << " -> " << gridPoints[i] << " instead of " << point << std::endl;
+      ++nbErrors;
+      }
+    }
+  return nbErrors;
+}
+}
+
+int otbLocalisationGrid(int argc, char* argv[])
+{
+  if (argc != 5)
+    {
+    std::cerr << "Usage: " << argv[0] << " sensorImage cacheFile geoTolerance imageTolerance" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(argv[1]);
+  reader->UpdateOutputInformation();
+  ImageType::Pointer image = reader->GetOutput();
+
+  const char * cacheFile = argv[2];
+  const double geoTolerance = atof(argv[3]);
+  const double imageTolerance = atof(argv[4]);
+
+  const ImageType::SizeType size = image->GetLargestPossibleRegion().GetSize();
+  const double startX = image->GetOrigin()[0] - 0.5 * image->GetSpacing()[0];
+  const double startY = image->GetOrigin()[1] - 0.5 * image->GetSpacing()[1];
+  const double sizeX = size[0] * image->GetSpacing()[0];
+  const double sizeY = size[1] * image->GetSpacing()[1];
+
+  // The first call computes the grid and writes the cache, the second one
+  // reads it back
+  itksys::SystemTools::RemoveFile(cacheFile);
+  GridType::Pointer grid = GridType::New();
+  if (grid->LoadOrGenerate(cacheFile, image->GetImageKeywordlist(), startX, startY, sizeX, sizeY))
+    {
+    std::cerr << "The grid was read from a missing cache" << std::endl;
+    return EXIT_FAILURE;
+    }
+  GridType::Pointer cachedGrid = GridType::New();
+  if (!cachedGrid->LoadOrGenerate(cacheFile, image->GetImageKeywordlist(), startX, startY, sizeX, sizeY)
+      || cachedGrid->GetSignature() != grid->GetSignature())
+    {
+    std::cerr << "The grid was not read from the cache" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // A different area invalidates the cache
+  GridType::Pointer otherGrid = GridType::New();
+  if (otherGrid->LoadOrGenerate(cacheFile, image->GetImageKeywordlist(), startX, startY, sizeX / 2, sizeY / 2))
+    {
+    std::cerr << "The grid was read from an out of date cache" << std::endl;
+    return EXIT_FAILURE;
+    }
+  itksys::SystemTools::RemoveFile(cacheFile);
+
+  // Exact sensor to WGS84 and WGS84 to sensor transforms
+  TransformType::Pointer forward = TransformType::New();
+  forward->SetInputKeywordList(image->GetImageKeywordlist());
+  forward->SetOutputProjectionRef(otb::GeoInformationConversion::ToWKT(4326));
+  forward->InstantiateTransform();
+
+  TransformType::Pointer inverse = TransformType::New();
+  forward->GetInverse(inverse);
+
+  // Same transforms, interpolated in the cached grid
+  TransformType::Pointer gridForward = TransformType::New();
+  gridForward->SetInputKeywordList(image->GetImageKeywordlist());
+  gridForward->SetInputLocalisationGrid(cachedGrid);
+  gridForward->SetOutputProjectionRef(otb::GeoInformationConversion::ToWKT(4326));
+  gridForward->InstantiateTransform();
+
+  TransformType::Pointer gridInverse = TransformType::New();
+  gridForward->GetInverse(gridInverse);
+
+  // Image points inside and outside of the grid
+  std::vector<PointType> imagePoints;
+  for (int y = -20; y < static_cast<int>(size[1]) + 20; y += 17)
+    {
+    for (int x = -20; x < static_cast<int>(size[0]) + 20; x += 13)
+      {
+      PointType point;
+      point[0] = x + 0.25;
+      point[1] = y + 0.75;
+      imagePoints.push_back(point);
+      }
+    }
+
+  std::vector<PointType> geoPoints(imagePoints.size());
+  for (unsigned int i = 0; i < imagePoints.size(); ++i)
+    {
+    geoPoints[i] = forward->TransformPoint(imagePoints[i]);
+    }
+
+  unsigned int nbErrors = 0;
+  nbErrors += CompareToModel(gridForward, forward, imagePoints, geoTolerance);
+  nbErrors += CompareToModel(gridInverse, inverse, geoPoints, imageTolerance);
+
+  // Clones share the grid and give the same results
+  TransformType::Pointer gridForwardClone = dynamic_cast<TransformType *>(gridForward->Clone().GetPointer());
+  nbErrors += CompareToModel(gridForwardClone, forward, imagePoints, geoTolerance);
+
+  std::cout << imagePoints.size() << " points, " << nbErrors << " errors" << std::endl;
+
+  return nbErrors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "otbVectorImage.h"
+#include "itkVector.h"
+#include "otbImage.h"
+#include "otbImageFileReader.h"
+#include "otbStreamingWarpImageFilter.h"
+#include "otbBCOInterpolateImageFunction.h"
+#include "itkWarpImageFilter.h"
+#include "itkNearestNeighborInterpolateImageFunction.h"
+#include "itkLinearInterpolateImageFunction.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkImageRegionConstIterator.h"
+
+#include <algorithm>
+
+const unsigned int Dimension = 2;
+typedef otb::VectorImage<float, Dimension>                  ImageType;
+typedef itk::Vector<double, 2>                              DisplacementValueType;
+typedef otb::Image<DisplacementValueType, Dimension>        DisplacementFieldType;
+typedef otb::ImageFileReader<ImageType>                     ReaderType;
+typedef itk::InterpolateImageFunction<ImageType, double>    InterpolatorType;
+
+namespace
+{
+InterpolatorType::Pointer CreateInterpolator(const std::string & name)
+{
+  if (name == "nn")
+    {
+    return itk::NearestNeighborInterpolateImageFunction<ImageType, double>::New().GetPointer();
+    }
+  if (name == "linear")
+    {
+    return itk::LinearInterpolateImageFunction<ImageType, double>::New().GetPointer();
+    }
+  return otb::BCOInterpolateImageFunction<ImageType, double>::New().GetPointer();
+}
+}
+
+int otbStreamingWarpImageFilterKernels(int argc, char* argv[])
+{
+  if (argc != 3)
+    {
+    std::cerr << "usage: " << argv[0] << " infname interpolator[nn|linear|bco]" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(argv[1]);
+  reader->Update();
+  ImageType::Pointer image = reader->GetOutput();
+
+  // Smooth displacement field, three times coarser than the image, so
+  // that displacements are interpolated
+  const ImageType::SpacingType spacing = image->GetSpacing();
+  const ImageType::SizeType    size    = image->GetLargestPossibleRegion().GetSize();
+
+  DisplacementFieldType::Pointer field = DisplacementFieldType::New();
+  DisplacementFieldType::SizeType fieldSize;
+  DisplacementFieldType::SpacingType fieldSpacing;
+  for (unsigned int dim = 0; dim < Dimension; ++dim)
+    {
+    fieldSize[dim] = size[dim] / 3 + 2;
+    fieldSpacing[dim] = 3 * spacing[dim];
+    }
+  DisplacementFieldType::RegionType fieldRegion;
+  fieldRegion.SetSize(fieldSize);
+  field->SetRegions(fieldRegion);
+  field->SetSpacing(fieldSpacing);
+  field->SetOrigin(image->GetOrigin());
+  field->Allocate();
+
+  itk::ImageRegionIteratorWithIndex<DisplacementFieldType> fieldIt(field, fieldRegion);
+  for (fieldIt.GoToBegin(); !fieldIt.IsAtEnd(); ++fieldIt)
+    {
+    const DisplacementFieldType::IndexType index = fieldIt.GetIndex();
+    DisplacementValueType displacement;
+    displacement[0] = 2.3 * spacing[0] * vcl_sin(index[0] / 7.) + 0.37 * spacing[0];
+    displacement[1] = 1.7 * spacing[1] * vcl_cos(index[1] / 5.) - 0.61 * spacing[1];
+    fieldIt.Set(displacement);
+    }
+
+  ImageType::PixelType padding(image->GetNumberOfComponentsPerPixel());
+  padding.Fill(0);
+
+  // Warping with the kernels
+  typedef otb::StreamingWarpImageFilter<ImageType, ImageType, DisplacementFieldType> WarperType;
+  WarperType::Pointer warper = WarperType::New();
+  DisplacementValueType maxDisplacement;
+  maxDisplacement.Fill(5 * std::max(vcl_abs(spacing[0]), vcl_abs(spacing[1])));
+  warper->SetMaximumDisplacement(maxDisplacement);
+  warper->SetInput(image);
+  warper->SetDisplacementField(field);
+  warper->SetOutputParametersFromImage(image);
+  warper->SetInterpolator(CreateInterpolator(argv[2]));
+  warper->SetEdgePaddingValue(padding);
+  warper->Update();
+
+  // Reference warping through the interpolator
+  typedef itk::WarpImageFilter<ImageType, ImageType, DisplacementFieldType> ReferenceWarperType;
+  ReferenceWarperType::Pointer reference = ReferenceWarperType::New();
+  reference->SetInput(image);
+  reference->SetDisplacementField(field);
+  reference->SetOutputParametersFromImage(image);
+  reference->SetInterpolator(CreateInterpolator(argv[2]));
+  reference->SetEdgePaddingValue(padding);
+  reference->Update();
+
+  itk::ImageRegionConstIterator<ImageType> outIt(warper->GetOutput(), image->GetLargestPossibleRegion());
+  itk::ImageRegionConstIterator<ImageType> refIt(reference->GetOutput(), image->GetLargestPossibleRegion());
+
+  unsigned int nbErrors = 0;
+  for (; !refIt.IsAtEnd(); ++outIt, ++refIt)
+    {
+    if (outIt.Get() != refIt.Get())
+      {
+      ++nbErrors;
+      }
+    }
+
+  std::cout << nbErrors << " pixels differ from itk::WarpImageFilter" << std::endl;
+
+  return nbErrors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
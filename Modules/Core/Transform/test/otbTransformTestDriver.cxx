@@ -25,6 +25,9 @@ void RegisterTests()
   REGISTER_TEST(otbGenericRSTransformWithSRID);
   REGISTER_TEST(otbCreateInverseForwardSensorModel);
   REGISTER_TEST(otbGenericRSTransform);
+  REGISTER_TEST(otbGenericRSTransformBatch);
+  REGISTER_TEST(otbLocalisationGrid);
+  REGISTER_TEST(otbTransformToDisplacementFieldSourceAdaptive);
   REGISTER_TEST(otbCreateProjectionWithOSSIM);
   REGISTER_TEST(otbLogPolarTransformResample);
   REGISTER_TEST(otbStreamingWarpImageFilterNew);
@@ -36,6 +39,7 @@ void RegisterTests()
   REGISTER_TEST(otbGeocentricTransformNew);
   REGISTER_TEST(otbGenericMapProjection);
   REGISTER_TEST(otbStreamingWarpImageFilter);
+  REGISTER_TEST(otbStreamingWarpImageFilterKernels);
   REGISTER_TEST(otbSensorModelsNew);
   REGISTER_TEST(otbGenericMapProjectionNew);
   REGISTER_TEST(otbInverseLogPolarTransform);
@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <iostream>
+#include <algorithm>
+
+#include "otbTransformToDisplacementFieldSource.h"
+#include "otbGenericRSTransform.h"
+#include "otbImage.h"
+#include "otbImageFileReader.h"
+#include "otbGeoInformationConversion.h"
+
+#include "itkImageRegionConstIterator.h"
+
+typedef otb::Image<unsigned short, 2>                       ImageType;
+typedef otb::ImageFileReader<ImageType>                     ReaderType;
+typedef otb::GenericRSTransform<>                           TransformType;
+typedef itk::Vector<double, 2>                              DisplacementType;
+typedef otb::Image<DisplacementType, 2>                     DisplacementFieldType;
+typedef otb::TransformToDisplacementFieldSource
+  <DisplacementFieldType, double>                           GeneratorType;
+
+namespace
+{
+// Displacement field of the transform over the image grid
+DisplacementFieldType::Pointer GenerateField(const TransformType * transform, const ImageType * image,
+                                             double tolerance, unsigned int nbThreads,
+                                             itk::SizeValueType & nbTransformedPoints)
+{
+  GeneratorType::Pointer generator = GeneratorType::New();
+  generator->SetTransform(transform);
+  generator->SetOutputParametersFromImage(image);
+  generator->SetTolerance(tolerance);
+  generator->SetNumberOfThreads(nbThreads);
+  generator->Update();
+  nbTransformedPoints = generator->GetNumberOfTransformedPoints();
+  return generator->GetOutput();
+}
+}
+
+int otbTransformToDisplacementFieldSourceAdaptive(int argc, char* argv[])
+{
+  if (argc != 4)
+    {
+    std::cerr << "Usage: " << argv[0] << " sensorImage tolerance maxError" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const double tolerance = atof(argv[2]);
+  const double maxError  = atof(argv[3]);
+
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(argv[1]);
+  reader->UpdateOutputInformation();
+  ImageType::Pointer image = reader->GetOutput();
+
+  // Sensor to WGS84
+  TransformType::Pointer transform = TransformType::New();
+  transform->SetInputKeywordList(image->GetImageKeywordlist());
+  transform->SetOutputProjectionRef(otb::GeoInformationConversion::ToWKT(4326));
+  transform->InstantiateTransform();
+
+  itk::SizeValueType nbExactPoints = 0, nbAdaptivePoints = 0, nbThreadedPoints = 0;
+  DisplacementFieldType::Pointer exact    = GenerateField(transform, image, 0., 1, nbExactPoints);
+  DisplacementFieldType::Pointer adaptive = GenerateField(transform, image, tolerance, 1, nbAdaptivePoints);
+  DisplacementFieldType::Pointer threaded = GenerateField(transform, image, tolerance, 7, nbThreadedPoints);
+
+  std::cout << nbAdaptivePoints << " points transformed instead of " << nbExactPoints << std::endl;
+
+  if (nbExactPoints != image->GetLargestPossibleRegion().GetNumberOfPixels() || nbAdaptivePoints >= nbExactPoints)
+    {
+    std::cerr << "The adaptive estimation does not transform fewer points" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  itk::ImageRegionConstIterator<DisplacementFieldType> exactIt(exact, exact->GetLargestPossibleRegion());
+  itk::ImageRegionConstIterator<DisplacementFieldType> adaptiveIt(adaptive, exact->GetLargestPossibleRegion());
+  itk::ImageRegionConstIterator<DisplacementFieldType> threadedIt(threaded, exact->GetLargestPossibleRegion());
+
+  double error = 0.;
+  unsigned int nbErrors = 0;
+  for (; !exactIt.IsAtEnd(); ++exactIt, ++adaptiveIt, ++threadedIt)
+    {
+    for (unsigned int dim = 0; dim < 2; ++dim)
+      {
+      error = std::max(error, vcl_abs(exactIt.Get()[dim] - adaptiveIt.Get()[dim]));
+      }
+    // The adaptive field does not depend on the splitting of the region
+    if (adaptiveIt.Get() != threadedIt.Get())
+      {
+      ++nbErrors;
+      }
+    }
+
+  std::cout << "Maximum error: " << error << std::endl;
+
+  if (error > maxError)
+    {
+    std::cerr << "Maximum error " << error << " is greater than " << maxError << std::endl;
+    ++nbErrors;
+    }
+
+  if (nbErrors != 0)
+    {
+    std::cerr << nbErrors << " errors" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -25,6 +25,7 @@
 
 #include "itkMatrix.h"
 #include "itkProcessObject.h"
+#include <algorithm>
 
 namespace otb
 {
@@ -138,6 +139,7 @@ ImageToSIFTKeyPointSetFilter<TInputImage, TOutputPointSet>
     // repeat the process
     m_ShrinkFilter = ShrinkFilterType::New();
     m_ShrinkFilter->SetInput(m_LastGaussian);
+    m_ShrinkFilter->SetNumberOfThreads(this->GetNumberOfThreads());
     m_ShrinkFilter->SetShrinkFactors(m_ShrinkFactors);
     m_ShrinkFilter->Update();
 
@@ -176,6 +178,7 @@ ImageToSIFTKeyPointSetFilter<TInputImage, TOutputPointSet>
 ::InitializeInputImage()
 {
   m_ExpandFilter->SetInput(this->GetInput());
+  m_ExpandFilter->SetNumberOfThreads(this->GetNumberOfThreads());
   m_ExpandFilter->SetExpandFactors(m_ExpandFactors);
   m_ExpandFilter->Update();
 
@@ -224,10 +227,12 @@ ImageToSIFTKeyPointSetFilter<TInputImage, TOutputPointSet>
     m_XGaussianFilter->SetSigma(xsigman);
     m_XGaussianFilter->SetDirection(0);
     m_XGaussianFilter->SetInput(input);
+    m_XGaussianFilter->SetNumberOfThreads(this->GetNumberOfThreads());
 
     m_YGaussianFilter->SetSigma(ysigman);
     m_YGaussianFilter->SetDirection(1);
     m_YGaussianFilter->SetInput(m_XGaussianFilter->GetOutput());
+    m_YGaussianFilter->SetNumberOfThreads(this->GetNumberOfThreads());
 
     m_YGaussianFilter->Update();
 
@@ -238,6 +243,9 @@ ImageToSIFTKeyPointSetFilter<TInputImage, TOutputPointSet>
     m_GradientFilter->SetInput(m_YGaussianFilter->GetOutput());
     m_MagnitudeFilter->SetInput(m_GradientFilter->GetOutput());
     m_OrientationFilter->SetInput(m_GradientFilter->GetOutput());
+    m_GradientFilter->SetNumberOfThreads(this->GetNumberOfThreads());
+    m_MagnitudeFilter->SetNumberOfThreads(this->GetNumberOfThreads());
+    m_OrientationFilter->SetNumberOfThreads(this->GetNumberOfThreads());
 
     m_MagnitudeFilter->Update();
     m_OrientationFilter->Update();
@@ -250,6 +258,7 @@ ImageToSIFTKeyPointSetFilter<TInputImage, TOutputPointSet>
       m_SubtractFilter = SubtractFilterType::New();
       m_SubtractFilter->SetInput1(m_YGaussianFilter->GetOutput());
       m_SubtractFilter->SetInput2(previousGaussian);
+      m_SubtractFilter->SetNumberOfThreads(this->GetNumberOfThreads());
       m_SubtractFilter->Update();
       m_DoGList->PushBack(m_SubtractFilter->GetOutput());
       }
@@ -888,6 +897,70 @@ ImageToSIFTKeyPointSetFilter<TInputImage, TOutputPointSet>
   return lHistogram;
 }
 
+/**
+ * Support radius of the coarsest octave
+ */
+template <class TInputImage, class TOutputPointSet>
+unsigned int
+ImageToSIFTKeyPointSetFilter<TInputImage, TOutputPointSet>
+::GetSupportRadius() const
+{
+  // In octave pixels: 4 sigma of the widest gaussian of the octave, the
+  // 16x16 descriptor window and the sample point refinement. The blur
+  // accumulated from the previous octaves at most doubles it.
+  const double octaveRadius = 4. * 2. * m_Sigma0 + 8. + m_ChangeSamplePointsMax;
+  const double octaveScale = vcl_pow(static_cast<double>(m_ShrinkFactors),
+                                     static_cast<double>(m_OctavesNumber - 1)) / m_ExpandFactors;
+  return static_cast<unsigned int>(vcl_ceil(2. * octaveRadius * octaveScale));
+}
+
+/**
+ * Subsampling factor of the coarsest octave
+ */
+template <class TInputImage, class TOutputPointSet>
+unsigned int
+ImageToSIFTKeyPointSetFilter<TInputImage, TOutputPointSet>
+::GetSubsamplingFactor() const
+{
+  unsigned int factor = 1;
+  for (unsigned int octave = 1; octave < m_OctavesNumber; ++octave)
+    {
+    factor *= m_ShrinkFactors;
+    }
+  return std::max(1U, factor / m_ExpandFactors);
+}
+
+/**
+ * InternalClone Method
+ */
+template <class TInputImage, class TOutputPointSet>
+itk::LightObject::Pointer
+ImageToSIFTKeyPointSetFilter<TInputImage, TOutputPointSet>
+::InternalClone() const
+{
+  itk::LightObject::Pointer loPtr = Superclass::InternalClone();
+
+  Self * clone = dynamic_cast<Self *>(loPtr.GetPointer());
+  if (clone == ITK_NULLPTR)
+    {
+    itkExceptionMacro(<< "Downcast to type " << this->GetNameOfClass() << " failed.");
+    }
+
+  clone->m_OctavesNumber = m_OctavesNumber;
+  clone->m_ScalesNumber = m_ScalesNumber;
+  clone->m_ExpandFactors = m_ExpandFactors;
+  clone->m_ShrinkFactors = m_ShrinkFactors;
+  clone->m_Sigma0 = m_Sigma0;
+  clone->m_DoGThreshold = m_DoGThreshold;
+  clone->m_EdgeThreshold = m_EdgeThreshold;
+  clone->m_GradientMagnitudeThreshold = m_GradientMagnitudeThreshold;
+  clone->m_SigmaFactorOrientation = m_SigmaFactorOrientation;
+  clone->m_SigmaFactorDescriptor = m_SigmaFactorDescriptor;
+  clone->m_ChangeSamplePointsMax = m_ChangeSamplePointsMax;
+
+  return loPtr;
+}
+
 /**
  * PrintSelf Method
  */
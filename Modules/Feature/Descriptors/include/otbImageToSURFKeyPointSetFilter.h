@@ -105,6 +105,16 @@ public:
   /** Get the number of KeyPoints detected*/
   itkGetMacro(NumberOfPoints, int);
 
+  /** Get the radius, in input pixels, of the neighborhood on which the
+   * detection and the description of a key point of the coarsest octave
+   * depend. It is the overlap needed to extract key points by tiles. */
+  unsigned int GetSupportRadius() const;
+
+  /** Get the subsampling factor of the coarsest octave with respect to the
+   * input image. Tiles starting on a multiple of this factor share the
+   * sampling grid of the whole image at all octaves. */
+  unsigned int GetSubsamplingFactor() const;
+
   /** Internal filters typedefs */
   typedef itk::ConstNeighborhoodIterator<InputImageType>      NeighborhoodIteratorType;
   typedef typename NeighborhoodIteratorType::NeighborhoodType NeighborhoodType;
@@ -139,6 +149,10 @@ protected:
    * Standard PrintSelf method.
    */
   void PrintSelf(std::ostream& os, itk::Indent indent) const ITK_OVERRIDE;
+  /**
+   * Clone with the same parameters.
+   */
+  itk::LightObject::Pointer InternalClone() const ITK_OVERRIDE;
   /**
    * Main computation method.
    */
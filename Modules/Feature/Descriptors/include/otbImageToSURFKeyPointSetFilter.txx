@@ -23,6 +23,7 @@
 
 #include "otbImageToSURFKeyPointSetFilter.h"
 #include "itkCenteredRigid2DTransform.h"
+#include <algorithm>
 
 namespace otb
 {
@@ -104,6 +105,7 @@ ImageToSURFKeyPointSetFilter<TInputImage, TOutputPointSet>
 
       m_ResampleFilter = ResampleFilterType::New();
       m_ResampleFilter->SetInput(this->GetInput());
+      m_ResampleFilter->SetNumberOfThreads(this->GetNumberOfThreads());
 
       SizeType size = this->GetInput()->GetLargestPossibleRegion().GetSize();
       for (int l = 0; l < 2; ++l)
@@ -147,6 +149,7 @@ ImageToSURFKeyPointSetFilter<TInputImage, TOutputPointSet>
       else m_DetHessianFilter->SetInput(m_determinantImage);
 
       m_DetHessianFilter->SetSigma(sigma_in);
+      m_DetHessianFilter->SetNumberOfThreads(this->GetNumberOfThreads());
       m_DetHessianFilter->Update();
       m_determinantImage = m_DetHessianFilter->GetOutput();
 
@@ -697,6 +700,58 @@ ImageToSURFKeyPointSetFilter<TInputImage, TOutputPointSet>
 
 }
 
+/*----------------------------------------------------------------
+  Support radius of the coarsest octave
+  -----------------------------------------------------------------*/
+template <class TInputImage, class TOutputPointSet>
+unsigned int
+ImageToSURFKeyPointSetFilter<TInputImage, TOutputPointSet>
+::GetSupportRadius() const
+{
+  // Widest Hessian scale of an octave, in octave pixels
+  const double k = (m_ScalesNumber > 1) ? std::pow(2.0, 1. / (m_ScalesNumber - 1)) : 3.;
+  const double sigmaMax = 2. * std::pow(k, static_cast<double>(m_ScalesNumber))
+                          * std::pow(2.0, static_cast<double>(m_OctavesNumber - 1));
+
+  // The descriptor spans 10 sigma around the key point, and the Hessian
+  // 3 sigma around each of its samples
+  return static_cast<unsigned int>(vcl_ceil(13. * sigmaMax)) + 2;
+}
+
+/*----------------------------------------------------------------
+  Subsampling factor of the coarsest octave
+  -----------------------------------------------------------------*/
+template <class TInputImage, class TOutputPointSet>
+unsigned int
+ImageToSURFKeyPointSetFilter<TInputImage, TOutputPointSet>
+::GetSubsamplingFactor() const
+{
+  return 1U << std::max(0, m_OctavesNumber - 1);
+}
+
+/*----------------------------------------------------------------
+  InternalClone
+  -----------------------------------------------------------------*/
+template <class TInputImage, class TOutputPointSet>
+itk::LightObject::Pointer
+ImageToSURFKeyPointSetFilter<TInputImage, TOutputPointSet>
+::InternalClone() const
+{
+  itk::LightObject::Pointer loPtr = Superclass::InternalClone();
+
+  Self * clone = dynamic_cast<Self *>(loPtr.GetPointer());
+  if (clone == ITK_NULLPTR)
+    {
+    itkExceptionMacro(<< "Downcast to type " << this->GetNameOfClass() << " failed.");
+    }
+
+  clone->m_OctavesNumber = m_OctavesNumber;
+  clone->m_ScalesNumber = m_ScalesNumber;
+  clone->m_DoHThreshold = m_DoHThreshold;
+
+  return loPtr;
+}
+
 /*----------------------------------------------------------------
   PrintSelf
   -----------------------------------------------------------------*/
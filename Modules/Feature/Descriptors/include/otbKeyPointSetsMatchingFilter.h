@@ -24,6 +24,10 @@
 #include "otbObjectListSource.h"
 #include "otbLandmark.h"
 #include "itkEuclideanDistanceMetric.h"
+#include "itkTransform.h"
+#include "itkMultiThreader.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include <vector>
 
 namespace otb
 {
@@ -41,6 +45,18 @@ namespace otb
  *   Matches are stored in a landmark object containing both matched points and point data. The landmark data will hold the distance value
  *   between the data.
  *
+ *   By default, nearest neighbors are searched exhaustively. If ApproximateSearch is on, the point data of each pointset are
+ *   indexed in a forest of randomized kd-trees, which are explored together, closest branches first, until
+ *   MaximumNumberOfChecks points of the leaves have been visited, including the ones discarded by the geometric
+ *   pre-filtering. The number of checks trades recall for speed: with as many checks as points, the search is exhaustive. The kd-trees split the point data space along its coordinates, so the approximate
+ *   search is meant for distances consistent with the Euclidean one.
+ *
+ *   If a transform is set, matching is restricted to the pairs of points whose distance between the transformed point of
+ *   pointset 1 and the point of pointset 2 is lower than the GeometricThreshold. This allows one to use sensor models or
+ *   map projections to discard unlikely matches before the ratio test.
+ *
+ *   Searches for the points of pointset 1 are shared between threads, and the matches are output in the order of pointset 1.
+ *
  *   \sa Landmark
  *   \sa PointSet
  *   \sa EuclideanDistanceMetric
@@ -78,6 +94,8 @@ public:
   typedef typename LandmarkListType::Pointer LandmarkListPointerType;
   typedef std::pair<unsigned int, double>    NeighborSearchResultType;
 
+  typedef itk::Transform<double, PointType::PointDimension, PointType::PointDimension> TransformType;
+
   /// standard macros
   itkNewMacro(Self);
   itkTypeMacro(KeyPointSetsMatchingFilter, ObjectListSource);
@@ -89,6 +107,24 @@ public:
   itkSetMacro(DistanceThreshold, double);
   itkGetMacro(DistanceThreshold, double);
 
+  /// Use the approximate search in randomized kd-trees (off by default)
+  itkBooleanMacro(ApproximateSearch);
+  itkSetMacro(ApproximateSearch, bool);
+  itkGetMacro(ApproximateSearch, bool);
+  /// Number of randomized kd-trees of the approximate search
+  itkSetMacro(NumberOfTrees, unsigned int);
+  itkGetMacro(NumberOfTrees, unsigned int);
+  /// Maximum number of leaf points visited by an approximate search
+  itkSetMacro(MaximumNumberOfChecks, unsigned int);
+  itkGetMacro(MaximumNumberOfChecks, unsigned int);
+
+  /// Transform from the points of pointset 1 to the ones of pointset 2 for geometric pre-filtering (none by default)
+  itkSetConstObjectMacro(Transform, TransformType);
+  itkGetConstObjectMacro(Transform, TransformType);
+  /// Maximum distance between a transformed point of pointset 1 and a point of pointset 2 to try to match them
+  itkSetMacro(GeometricThreshold, double);
+  itkGetMacro(GeometricThreshold, double);
+
   /// Set the first pointset
   void SetInput1(const PointSetType * pointset);
   /// Get the first pointset
@@ -109,16 +145,63 @@ protected:
   /// Generate Data
   void GenerateData() ITK_OVERRIDE;
 
-  /**
-   * Find the nearest neighbor of data1 in pointset.
-   * \return a pair of (index, distance).
-   */
-  NeighborSearchResultType NearestNeighbor(const PointDataType& data1, const PointSetType * pointset);
+  /// Node of a kd-tree. Leaves have no children and hold the positions [Begin, End) of the tree indices.
+  struct KdTreeNode
+  {
+    unsigned int Dimension;
+    double       Value;
+    int          Left;
+    int          Right;
+    unsigned int Begin;
+    unsigned int End;
+  };
+
+  /// Randomized kd-tree on the point data of a pointset
+  struct KdTree
+  {
+    std::vector<KdTreeNode>   Nodes;
+    std::vector<unsigned int> Indices;
+  };
+
+  /// Pointset prepared for the nearest neighbor searches
+  struct SearchSet
+  {
+    std::vector<typename PointSetType::PointIdentifier> Ids;
+    std::vector<const PointDataType *>                  Data;
+    std::vector<PointType>                              Positions;
+    std::vector<KdTree>                                 Trees;
+  };
+
+  /** Find the nearest neighbor of data in the search set, among the points
+   * close to the query position if any. The first element of the result is a
+   * position in the search set. */
+  NeighborSearchResultType Search(const SearchSet& set, const PointDataType& data,
+                                  const PointType * queryPosition,
+                                  std::vector<unsigned int>& visited, unsigned int stamp) const;
+
+  typedef itk::Statistics::MersenneTwisterRandomVariateGenerator RandomGeneratorType;
+
+  /** Build the search set of a pointset. Positions are transformed if
+   * requested, and kd-trees are only built for the approximate search. */
+  void BuildSearchSet(const PointSetType * pointset, bool transformPositions, bool buildTrees, SearchSet& set);
+
+  /// Build the node of a kd-tree on the positions [begin, end) of its indices
+  int BuildKdTreeNode(KdTree& tree, const SearchSet& set, unsigned int begin, unsigned int end,
+                      RandomGeneratorType * generator);
+
+  /// Match the points of pointset 1 handled by a thread
+  void MatchPoints(itk::ThreadIdType threadId, itk::ThreadIdType threadCount);
+
+  /// Static function used as a "callback" by the MultiThreader
+  static ITK_THREAD_RETURN_TYPE MatchingThreaderCallback(void *arg);
 
 private:
   KeyPointSetsMatchingFilter(const Self &); // purposely not implemented
   void operator =(const Self&);             // purposely not implemented
 
+  /// Tells if the position p is within the geometric threshold of the query
+  bool IsGeometricCandidate(const PointType * queryPosition, const PointType& p) const;
+
   // Find back matches from 2 to 1 to validate them
   bool m_UseBackMatching;
 
@@ -127,6 +210,23 @@ private:
 
   // Distance calculator
   DistancePointerType m_DistanceCalculator;
+
+  // Approximate search parameters
+  bool         m_ApproximateSearch;
+  unsigned int m_NumberOfTrees;
+  unsigned int m_MaximumNumberOfChecks;
+
+  // Geometric pre-filtering
+  typename TransformType::ConstPointer m_Transform;
+  double                               m_GeometricThreshold;
+
+  // Search sets of the current update
+  SearchSet m_SearchSet1;
+  SearchSet m_SearchSet2;
+
+  // Forward and backward search results for each point of pointset 1
+  std::vector<NeighborSearchResultType> m_ForwardResults;
+  std::vector<NeighborSearchResultType> m_BackwardResults;
 };
 
 } // end namespace otb
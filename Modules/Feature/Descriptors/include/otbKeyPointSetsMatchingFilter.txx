@@ -22,6 +22,10 @@
 #define otbKeyPointSetsMatchingFilter_txx
 
 #include "otbKeyPointSetsMatchingFilter.h"
+#include "itkNumericTraits.h"
+#include <queue>
+#include <functional>
+#include <algorithm>
 
 namespace otb
 {
@@ -33,6 +37,10 @@ KeyPointSetsMatchingFilter<TPointSet, TDistance>
   this->SetNumberOfRequiredInputs(2);
   m_UseBackMatching   = false;
   m_DistanceThreshold = 0.6;
+  m_ApproximateSearch = false;
+  m_NumberOfTrees = 4;
+  m_MaximumNumberOfChecks = 256;
+  m_GeometricThreshold = 0.;
   // Object used to measure distance
   m_DistanceCalculator = DistanceType::New();
 }
@@ -76,8 +84,6 @@ void
 KeyPointSetsMatchingFilter<TPointSet, TDistance>
 ::GenerateData()
 {
-//   std::cout<<"GenerateData()"<<std::endl;
-
   // Get the input pointers
   const PointSetType * ps1 =  this->GetInput1();
   const PointSetType * ps2 =  this->GetInput2();
@@ -91,125 +97,388 @@ KeyPointSetsMatchingFilter<TPointSet, TDistance>
   // Get the output pointer
   LandmarkListPointerType landmarks = this->GetOutput();
 
-  // Define iterators on points and point data.
-  PointsIteratorType    pIt  = ps1->GetPoints()->Begin();
-  PointDataIteratorType pdIt = ps1->GetPointData()->Begin();
+  // Prepare the searches. Positions of pointset 1 are transformed in the
+  // geometry of pointset 2, and it is indexed only for back matching.
+  BuildSearchSet(ps1, true, m_UseBackMatching, m_SearchSet1);
+  BuildSearchSet(ps2, false, true, m_SearchSet2);
+
+  const NeighborSearchResultType noResult(0, itk::NumericTraits<double>::max());
+  m_ForwardResults.assign(m_SearchSet1.Ids.size(), noResult);
+  m_BackwardResults.assign(m_SearchSet1.Ids.size(), noResult);
+
+  // Search the neighbors of the points of pointset 1 in parallel
+  this->GetMultiThreader()->SetNumberOfThreads(this->GetNumberOfThreads());
+  this->GetMultiThreader()->SetSingleMethod(this->MatchingThreaderCallback, this);
+  this->GetMultiThreader()->SingleMethodExecute();
 
-  // iterate on pointset 1
-  while (pdIt != ps1->GetPointData()->End()
-         && pIt != ps1->GetPoints()->End())
+  // Add the matches in the order of pointset 1
+  for (unsigned int i = 0; i < m_SearchSet1.Ids.size(); ++i)
     {
-    // Get point and point data at current location
-    bool          matchFound = false;
-    unsigned int  currentIndex = pIt.Index();
-    PointDataType data = pdIt.Value();
-    PointType     point = pIt.Value();
+    const NeighborSearchResultType& searchResult1 = m_ForwardResults[i];
 
-    // These variables will hold the matched point and point data
-    PointDataType dataMatch;
-    PointType     pointMatch;
+    // Check if the neighbor distance is lower than the threshold, and if the
+    // back search finds the same match
+    if (searchResult1.second < m_DistanceThreshold
+        && (!m_UseBackMatching || m_BackwardResults[i].first == i))
+      {
+      const unsigned int match = searchResult1.first;
 
-    // call to the matching routine
-    NeighborSearchResultType searchResult1 = NearestNeighbor(data, ps2);
+      LandmarkPointerType landmark = LandmarkType::New();
+      landmark->SetPoint1(ps1->GetPoints()->GetElement(m_SearchSet1.Ids[i]));
+      landmark->SetPointData1(*m_SearchSet1.Data[i]);
+      landmark->SetPoint2(ps2->GetPoints()->GetElement(m_SearchSet2.Ids[match]));
+      landmark->SetPointData2(*m_SearchSet2.Data[match]);
+      landmark->SetLandmarkData(searchResult1.second);
+
+      // Add the new landmark to the landmark list
+      landmarks->PushBack(landmark);
+      }
+    }
+
+  // Release the search structures
+  m_SearchSet1 = SearchSet();
+  m_SearchSet2 = SearchSet();
+  m_ForwardResults.clear();
+  m_BackwardResults.clear();
+}
+
+template <class TPointSet, class TDistance>
+ITK_THREAD_RETURN_TYPE
+KeyPointSetsMatchingFilter<TPointSet, TDistance>
+::MatchingThreaderCallback(void *arg)
+{
+  itk::ThreadIdType threadId = ((itk::MultiThreader::ThreadInfoStruct *) (arg))->ThreadID;
+  itk::ThreadIdType threadCount = ((itk::MultiThreader::ThreadInfoStruct *) (arg))->NumberOfThreads;
+  Self * filter = (Self *) (((itk::MultiThreader::ThreadInfoStruct *) (arg))->UserData);
 
-    // Check if the neighbor distance is lower than the threshold
-    if (searchResult1.second < m_DistanceThreshold)
+  filter->MatchPoints(threadId, threadCount);
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template <class TPointSet, class TDistance>
+void
+KeyPointSetsMatchingFilter<TPointSet, TDistance>
+::MatchPoints(itk::ThreadIdType threadId, itk::ThreadIdType threadCount)
+{
+  const unsigned int nbPoints1 = m_SearchSet1.Ids.size();
+  const unsigned int begin = static_cast<unsigned int>((static_cast<itk::SizeValueType>(nbPoints1) * threadId) / threadCount);
+  const unsigned int end = static_cast<unsigned int>((static_cast<itk::SizeValueType>(nbPoints1) * (threadId + 1)) / threadCount);
+  const bool useGeometry = m_Transform.IsNotNull();
+
+  // Marks of the points already compared by the current approximate search
+  std::vector<unsigned int> visited1;
+  std::vector<unsigned int> visited2;
+  if (m_ApproximateSearch)
+    {
+    visited1.assign(m_UseBackMatching ? nbPoints1 : 0, 0);
+    visited2.assign(m_SearchSet2.Ids.size(), 0);
+    }
+
+  for (unsigned int i = begin; i < end; ++i)
+    {
+    m_ForwardResults[i] = Search(m_SearchSet2, *m_SearchSet1.Data[i],
+                                 useGeometry ? &m_SearchSet1.Positions[i] : ITK_NULLPTR,
+                                 visited2, i + 1);
+
+    if (m_UseBackMatching && m_ForwardResults[i].second < m_DistanceThreshold)
       {
-      // Get the matched point and point data
-      dataMatch = ps2->GetPointData()->GetElement(searchResult1.first);
-      pointMatch = ps2->GetPoints()->GetElement(searchResult1.first);
+      const unsigned int match = m_ForwardResults[i].first;
+      m_BackwardResults[i] = Search(m_SearchSet1, *m_SearchSet2.Data[match],
+                                    useGeometry ? &m_SearchSet2.Positions[match] : ITK_NULLPTR,
+                                    visited1, i + 1);
+      }
+    }
+}
 
-      // If the back matching option is on
-      if (m_UseBackMatching)
-        {
-        // Peform the back search
-        NeighborSearchResultType searchResult2 = NearestNeighbor(dataMatch, ps1);
+template <class TPointSet, class TDistance>
+void
+KeyPointSetsMatchingFilter<TPointSet, TDistance>
+::BuildSearchSet(const PointSetType * pointset, bool transformPositions, bool buildTrees, SearchSet& set)
+{
+  set = SearchSet();
 
-        // Test if back search finds the same match
-        if (currentIndex == searchResult2.first)
+  for (PointDataIteratorType pdIt = pointset->GetPointData()->Begin();
+       pdIt != pointset->GetPointData()->End(); ++pdIt)
+    {
+    set.Ids.push_back(pdIt.Index());
+    set.Data.push_back(&pdIt.Value());
+    }
+
+  // Positions are only needed for geometric pre-filtering
+  if (m_Transform.IsNotNull())
+    {
+    set.Positions.resize(set.Ids.size());
+    for (unsigned int i = 0; i < set.Ids.size(); ++i)
+      {
+      const PointType point = pointset->GetPoints()->GetElement(set.Ids[i]);
+      if (transformPositions)
+        {
+        typename TransformType::InputPointType inPoint;
+        for (unsigned int dim = 0; dim < PointType::PointDimension; ++dim)
+          {
+          inPoint[dim] = point[dim];
+          }
+        const typename TransformType::OutputPointType outPoint = m_Transform->TransformPoint(inPoint);
+        for (unsigned int dim = 0; dim < PointType::PointDimension; ++dim)
           {
-          matchFound = true;
+          set.Positions[i][dim] = outPoint[dim];
           }
         }
-      else // else back matching
+      else
         {
-        matchFound = true;
+        set.Positions[i] = point;
         }
       }
+    }
 
-    // If we found a match, add the proper landmark
-    if (matchFound)
-      {
-      LandmarkPointerType landmark = LandmarkType::New();
-      landmark->SetPoint1(point);
-      landmark->SetPointData1(data);
-      landmark->SetPoint2(pointMatch);
-      landmark->SetPointData2(dataMatch);
-      landmark->SetLandmarkData(searchResult1.second);
+  // An empty set is searched exhaustively, without trees
+  if (!m_ApproximateSearch || !buildTrees || set.Ids.empty())
+    {
+    return;
+    }
 
-      // Add the new landmark to the landmark list
-      landmarks->PushBack(landmark);
+  // Build the randomized kd-trees, with a fixed seed so that matches are
+  // reproducible
+  typename RandomGeneratorType::Pointer generator = RandomGeneratorType::New();
+  generator->SetSeed(0);
+
+  const unsigned int nbPoints = set.Ids.size();
+  set.Trees.resize(std::max(1U, m_NumberOfTrees));
+  for (unsigned int t = 0; t < set.Trees.size(); ++t)
+    {
+    KdTree& tree = set.Trees[t];
+    tree.Indices.resize(nbPoints);
+    for (unsigned int i = 0; i < nbPoints; ++i)
+      {
+      tree.Indices[i] = i;
+      }
+    // Shuffle the points, so that splits are estimated on random samples
+    for (unsigned int i = nbPoints - 1; i > 0; --i)
+      {
+      std::swap(tree.Indices[i], tree.Indices[generator->GetIntegerVariate(i)]);
       }
-    ++pdIt;
-    ++pIt;
+    BuildKdTreeNode(tree, set, 0, nbPoints, generator);
     }
 }
 
 template <class TPointSet, class TDistance>
-typename KeyPointSetsMatchingFilter<TPointSet, TDistance>::NeighborSearchResultType
+int
 KeyPointSetsMatchingFilter<TPointSet, TDistance>
-::NearestNeighbor(const PointDataType& data1, const PointSetType * pointset)
+::BuildKdTreeNode(KdTree& tree, const SearchSet& set, unsigned int begin, unsigned int end,
+                  RandomGeneratorType * generator)
 {
-//   std::cout<<"Call to NearestNeighbor()"<<std::endl;
-// Declare the result
-  NeighborSearchResultType result;
-
-  // Define iterators on points and point data.
-  PointDataIteratorType pdIt = pointset->GetPointData()->Begin();
+  // Maximum number of points in a leaf
+  const unsigned int maxLeafSize = 8;
+  // Number of points used to estimate the split and number of candidate
+  // dimensions of highest variance among which the split dimension is drawn
+  const unsigned int nbSamples = 100;
+  const unsigned int nbCandidateDimensions = 5;
+
+  const int nodeId = tree.Nodes.size();
+  KdTreeNode node;
+  node.Dimension = 0;
+  node.Value = 0.;
+  node.Left = -1;
+  node.Right = -1;
+  node.Begin = begin;
+  node.End = end;
+  tree.Nodes.push_back(node);
+
+  if (end - begin <= maxLeafSize)
+    {
+    return nodeId;
+    }
 
-  // local variables
-  unsigned int nearestIndex = 0;
-  double       d1 = m_DistanceCalculator->Evaluate(data1, pdIt.Value());
-  ++pdIt;
-  double d2 = m_DistanceCalculator->Evaluate(data1, pdIt.Value());
-  ++pdIt;
+  // Mean and variance of each dimension on the first points of the range,
+  // which are random since points have been shuffled
+  const unsigned int nbDimensions = set.Data[tree.Indices[begin]]->Size();
+  const unsigned int sampleEnd = std::min(end, begin + nbSamples);
+  std::vector<double> mean(nbDimensions, 0.);
+  std::vector<double> variance(nbDimensions, 0.);
+  for (unsigned int i = begin; i < sampleEnd; ++i)
+    {
+    const PointDataType& data = *set.Data[tree.Indices[i]];
+    for (unsigned int dim = 0; dim < nbDimensions; ++dim)
+      {
+      mean[dim] += data[dim];
+      }
+    }
+  for (unsigned int dim = 0; dim < nbDimensions; ++dim)
+    {
+    mean[dim] /= (sampleEnd - begin);
+    }
+  for (unsigned int i = begin; i < sampleEnd; ++i)
+    {
+    const PointDataType& data = *set.Data[tree.Indices[i]];
+    for (unsigned int dim = 0; dim < nbDimensions; ++dim)
+      {
+      const double diff = data[dim] - mean[dim];
+      variance[dim] += diff * diff;
+      }
+    }
 
-  if (d1 > d2)
+  // Draw the split dimension among the ones of highest variance
+  std::vector<std::pair<double, unsigned int> > dimensions(nbDimensions);
+  for (unsigned int dim = 0; dim < nbDimensions; ++dim)
+    {
+    dimensions[dim] = std::make_pair(variance[dim], dim);
+    }
+  const unsigned int nbCandidates = std::min(nbCandidateDimensions, nbDimensions);
+  std::partial_sort(dimensions.begin(), dimensions.begin() + nbCandidates, dimensions.end(),
+                    std::greater<std::pair<double, unsigned int> >());
+  const unsigned int splitDimension = dimensions[generator->GetIntegerVariate(nbCandidates - 1)].second;
+  const double splitValue = mean[splitDimension];
+
+  // Partition the points of the range
+  unsigned int middle = begin;
+  for (unsigned int i = begin; i < end; ++i)
     {
-    nearestIndex = 1;
+    if ((*set.Data[tree.Indices[i]])[splitDimension] < splitValue)
+      {
+      std::swap(tree.Indices[i], tree.Indices[middle]);
+      ++middle;
+      }
     }
-  // Initialize distances
-  double nearestDistance = std::min(d1, d2);
-  double secondNearestDistance = std::max(d1, d2);
-  double distanceValue;
 
-  // iterate on the pointset
-  while (pdIt != pointset->GetPointData()->End())
+  // Identical point data can not be split
+  if (middle == begin || middle == end)
     {
-    // Evaluate the distance
-    distanceValue = m_DistanceCalculator->Evaluate(data1, pdIt.Value());
+    return nodeId;
+    }
+
+  const int left = BuildKdTreeNode(tree, set, begin, middle, generator);
+  const int right = BuildKdTreeNode(tree, set, middle, end, generator);
+
+  tree.Nodes[nodeId].Dimension = splitDimension;
+  tree.Nodes[nodeId].Value = splitValue;
+  tree.Nodes[nodeId].Left = left;
+  tree.Nodes[nodeId].Right = right;
 
-//       std::cout<<nearestIndex<<" "<<nearestDistance<<" "<<secondNearestDistance<<std::endl;
+  return nodeId;
+}
+
+template <class TPointSet, class TDistance>
+bool
+KeyPointSetsMatchingFilter<TPointSet, TDistance>
+::IsGeometricCandidate(const PointType * queryPosition, const PointType& p) const
+{
+  return queryPosition == ITK_NULLPTR
+         || queryPosition->SquaredEuclideanDistanceTo(p) <= m_GeometricThreshold * m_GeometricThreshold;
+}
+
+template <class TPointSet, class TDistance>
+typename KeyPointSetsMatchingFilter<TPointSet, TDistance>::NeighborSearchResultType
+KeyPointSetsMatchingFilter<TPointSet, TDistance>
+::Search(const SearchSet& set, const PointDataType& data, const PointType * queryPosition,
+         std::vector<unsigned int>& visited, unsigned int stamp) const
+{
+  const double infinity = itk::NumericTraits<double>::max();
+  unsigned int nearestIndex = 0;
+  double       nearestDistance = infinity;
+  double       secondNearestDistance = infinity;
 
-    // Check if this point is the nearest neighbor
-    if (distanceValue < nearestDistance)
+  if (set.Trees.empty())
+    {
+    // Exhaustive search, in the order of the pointset
+    for (unsigned int i = 0; i < set.Data.size(); ++i)
       {
-      secondNearestDistance = nearestDistance;
-      nearestDistance = distanceValue;
-      nearestIndex = pdIt.Index();
+      if (queryPosition && !IsGeometricCandidate(queryPosition, set.Positions[i]))
+        {
+        continue;
+        }
+
+      const double distanceValue = m_DistanceCalculator->Evaluate(data, *set.Data[i]);
 
+      // Check if this point is the nearest neighbor
+      if (distanceValue < nearestDistance)
+        {
+        secondNearestDistance = nearestDistance;
+        nearestDistance = distanceValue;
+        nearestIndex = i;
+        }
+      // Else check if it is the second nearest neighbor
+      else if (distanceValue < secondNearestDistance)
+        {
+        secondNearestDistance = distanceValue;
+        }
+      }
+    }
+  else
+    {
+    // Branches not taken, sorted by the distance of the query to their
+    // splitting plane
+    typedef std::pair<double, std::pair<unsigned int, int> > BranchType;
+    std::priority_queue<BranchType, std::vector<BranchType>, std::greater<BranchType> > branches;
+
+    unsigned int nbChecks = 0;
+    for (unsigned int t = 0; t < set.Trees.size(); ++t)
+      {
+      branches.push(std::make_pair(0., std::make_pair(t, 0)));
       }
-    // Else check if it is the second nearest neighbor
-    else if (distanceValue < secondNearestDistance)
+
+    while (!branches.empty() && nbChecks < m_MaximumNumberOfChecks)
       {
-      secondNearestDistance = distanceValue;
+      const unsigned int t = branches.top().second.first;
+      int nodeId = branches.top().second.second;
+      branches.pop();
+
+      // Go down to the leaf of the query, and remember the other branches
+      const KdTree& tree = set.Trees[t];
+      while (tree.Nodes[nodeId].Left >= 0)
+        {
+        const KdTreeNode& node = tree.Nodes[nodeId];
+        const double diff = data[node.Dimension] - node.Value;
+        const int closest = (diff < 0) ? node.Left : node.Right;
+        const int farthest = (diff < 0) ? node.Right : node.Left;
+        branches.push(std::make_pair(diff * diff, std::make_pair(t, farthest)));
+        nodeId = closest;
+        }
+
+      // Compare the points of the leaf which have not been seen in other trees
+      const KdTreeNode& leaf = tree.Nodes[nodeId];
+      for (unsigned int pos = leaf.Begin; pos < leaf.End; ++pos)
+        {
+        const unsigned int i = tree.Indices[pos];
+        if (visited[i] == stamp)
+          {
+          continue;
+          }
+        visited[i] = stamp;
+
+        // Points rejected by the geometric pre-filtering count as checks too,
+        // so that the search is bounded whatever the geometric threshold
+        ++nbChecks;
+        if (queryPosition && !IsGeometricCandidate(queryPosition, set.Positions[i]))
+          {
+          continue;
+          }
+
+        const double distanceValue = m_DistanceCalculator->Evaluate(data, *set.Data[i]);
+
+        if (distanceValue < nearestDistance
+            || (distanceValue == nearestDistance && i < nearestIndex))
+          {
+          secondNearestDistance = nearestDistance;
+          nearestDistance = distanceValue;
+          nearestIndex = i;
+          }
+        else if (distanceValue < secondNearestDistance)
+          {
+          secondNearestDistance = distanceValue;
+          }
+        }
       }
-    ++pdIt;
     }
 
-  // Fill results
+  // Fill results. Without a second neighbor, the ratio can not be checked.
+  NeighborSearchResultType result;
   result.first = nearestIndex;
-  if (secondNearestDistance == 0)
+  if (nearestDistance == infinity)
+    {
+    result.second = infinity;
+    }
+  else if (secondNearestDistance == 0 || secondNearestDistance == infinity)
     {
     result.second = 1;
     }
@@ -218,9 +487,7 @@ KeyPointSetsMatchingFilter<TPointSet, TDistance>
     result.second = nearestDistance / secondNearestDistance;
     }
 
-  // return the result
   return result;
-
 }
 
 template <class TPointSet, class TDistance>
@@ -229,6 +496,12 @@ KeyPointSetsMatchingFilter<TPointSet, TDistance>
 ::PrintSelf(std::ostream& os, itk::Indent indent) const
 {
   Superclass::PrintSelf(os, indent);
+  os << indent << "UseBackMatching: " << m_UseBackMatching << std::endl;
+  os << indent << "DistanceThreshold: " << m_DistanceThreshold << std::endl;
+  os << indent << "ApproximateSearch: " << m_ApproximateSearch << std::endl;
+  os << indent << "NumberOfTrees: " << m_NumberOfTrees << std::endl;
+  os << indent << "MaximumNumberOfChecks: " << m_MaximumNumberOfChecks << std::endl;
+  os << indent << "GeometricThreshold: " << m_GeometricThreshold << std::endl;
 }
 
 } // end namespace otb
@@ -23,6 +23,7 @@
 
 #include "otbImageToPointSetFilter.h"
 #include "otbImage.h"
+#include "otbStreamingImageToKeyPointSetFilter.h"
 
 namespace otb
 {
@@ -83,6 +84,16 @@ public:
   itkSetMacro(ScalesNumber, unsigned int);
   itkGetMacro(ScalesNumber, unsigned int);
 
+  /** Get the radius, in input pixels, of the neighborhood on which the
+   * detection and the description of a key point depend. libsiftfast builds
+   * octaves down to a minimal image size, so this is only exact for key points
+   * of the first 4 octaves. */
+  unsigned int GetSupportRadius() const;
+
+  /** Get the subsampling factor of the 4th octave with respect to the input
+   * image. */
+  unsigned int GetSubsamplingFactor() const;
+
   //Set/Get the Orientation of all KeyPoints
   OrientationVectorType GetOrientationVector()
   {
@@ -102,12 +113,23 @@ protected:
   /** PrintSelf method */
   void PrintSelf(std::ostream& os, itk::Indent indent) const ITK_OVERRIDE;
 
+  /** Clone with the same parameters */
+  itk::LightObject::Pointer InternalClone() const ITK_OVERRIDE;
+
 private:
   /** The number of scales */
   unsigned int          m_ScalesNumber;
   OrientationVectorType m_OrientationVector;
 
 };
+
+/** libsiftfast keeps its state in global variables */
+template <class TInputImage, class TOutputPointSet>
+struct KeyPointFilterTraits< SiftFastImageFilter<TInputImage, TOutputPointSet> >
+{
+  static const bool Reentrant = false;
+};
+
 } // End namespace otb
 #ifndef OTB_MANUAL_INSTANTIATION
 #include "otbSiftFastImageFilter.txx"
@@ -103,6 +103,42 @@ SiftFastImageFilter<TInputImage, TOutputPointSet>
   FreeKeypoints(keypts);
   DestroyAllResources();
 }
+template <class TInputImage, class TOutputPointSet>
+unsigned int
+SiftFastImageFilter<TInputImage, TOutputPointSet>
+::GetSupportRadius() const
+{
+  // Same bound as ImageToSIFTKeyPointSetFilter with its default parameters
+  // over 4 octaves of the doubled input image
+  return 183;
+}
+
+template <class TInputImage, class TOutputPointSet>
+unsigned int
+SiftFastImageFilter<TInputImage, TOutputPointSet>
+::GetSubsamplingFactor() const
+{
+  return 4;
+}
+
+template <class TInputImage, class TOutputPointSet>
+itk::LightObject::Pointer
+SiftFastImageFilter<TInputImage, TOutputPointSet>
+::InternalClone() const
+{
+  itk::LightObject::Pointer loPtr = Superclass::InternalClone();
+
+  Self * clone = dynamic_cast<Self *>(loPtr.GetPointer());
+  if (clone == ITK_NULLPTR)
+    {
+    itkExceptionMacro(<< "Downcast to type " << this->GetNameOfClass() << " failed.");
+    }
+
+  clone->m_ScalesNumber = m_ScalesNumber;
+
+  return loPtr;
+}
+
 /*
  * PrintSelf Method
  */
@@ -0,0 +1,237 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbStreamingImageToKeyPointSetFilter_h
+#define otbStreamingImageToKeyPointSetFilter_h
+
+#include <vector>
+#include <utility>
+
+#include "otbPersistentImageFilter.h"
+#include "otbPersistentFilterStreamingDecorator.h"
+
+namespace otb
+{
+/** \class KeyPointFilterTraits
+ *  \brief Properties of the key point detectors used by
+ *  PersistentImageToKeyPointSetFilter.
+ *
+ *  Detectors that can not run concurrently in several threads specialise
+ *  this traits class with Reentrant set to false.
+ *
+ * \ingroup OTBDescriptors
+ */
+template <class TKeyPointFilter>
+struct KeyPointFilterTraits
+{
+  static const bool Reentrant = true;
+};
+
+/** \class PersistentImageToKeyPointSetFilter
+ *  \brief Extract key points of an image by tiles in a persistent way.
+ *
+ *  This filter is a PersistentImageFilter which runs a key point detector
+ *  (ImageToSIFTKeyPointSetFilter, ImageToSURFKeyPointSetFilter or
+ *  SiftFastImageFilter) on each streamed piece of the input, and gathers the
+ *  key points and descriptors of all the pieces in a single point set,
+ *  available through GetPointSet().
+ *
+ *  By default, the detector runs on each piece with all the threads. When a
+ *  SubTileSize is set, each piece is further split in square sub-tiles of
+ *  that size, and each thread runs its own single threaded copy of the
+ *  detector on the sub-tiles it is given. The sub-tiles only depend on the
+ *  pieces and on SubTileSize, not on the number of threads, so that the key
+ *  points do not depend on the number of cores. Square sub-tiles are
+ *  preferred to the strips of the default region splitting, since the margin
+ *  of the detector is large compared to the height of thin strips.
+ *
+ *  Pieces and sub-tiles are padded by a margin and extended so that they
+ *  start on a multiple of the subsampling factor of the coarsest octave: the
+ *  pyramid of each sub-tile is then sampled on the same grid as the one of
+ *  the whole image, and key points of the sub-tile core do not depend on the
+ *  tiling. A key point is kept only by the sub-tile whose core contains it,
+ *  so that key points detected in the overlap of two sub-tiles are not
+ *  duplicated.
+ *
+ *  The detector is configured through GetKeyPointFilter(), and copied with
+ *  Clone() for each sub-tile. The margin defaults to the support radius of
+ *  the detector, which grows with its number of octaves.
+ *
+ *  \note Detectors which are not reentrant specialise KeyPointFilterTraits
+ *  with Reentrant set to false: their sub-tiles are processed one after the
+ *  other, in the calling thread. This is the case of SiftFastImageFilter,
+ *  since libsiftfast keeps its state in global variables.
+ *
+ * \sa StreamingImageToKeyPointSetFilter
+ *
+ * \ingroup Streamed
+ * \ingroup Threaded
+ *
+ * \ingroup OTBDescriptors
+ */
+template <class TKeyPointFilter>
+class ITK_EXPORT PersistentImageToKeyPointSetFilter
+  : public PersistentImageFilter<typename TKeyPointFilter::InputImageType,
+                                 typename TKeyPointFilter::InputImageType>
+{
+public:
+  /** Standard Self typedef */
+  typedef PersistentImageToKeyPointSetFilter                   Self;
+  typedef PersistentImageFilter<typename TKeyPointFilter::InputImageType,
+                                typename TKeyPointFilter::InputImageType> Superclass;
+  typedef itk::SmartPointer<Self>                              Pointer;
+  typedef itk::SmartPointer<const Self>                        ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(PersistentImageToKeyPointSetFilter, PersistentImageFilter);
+
+  typedef TKeyPointFilter                                KeyPointFilterType;
+  typedef typename KeyPointFilterType::Pointer           KeyPointFilterPointerType;
+
+  typedef typename KeyPointFilterType::InputImageType    InputImageType;
+  typedef typename InputImageType::Pointer               InputImagePointerType;
+  typedef typename InputImageType::RegionType            RegionType;
+  typedef typename InputImageType::IndexType             IndexType;
+
+  typedef typename KeyPointFilterType::OutputPointSetType OutputPointSetType;
+  typedef typename OutputPointSetType::Pointer            OutputPointSetPointerType;
+  typedef typename OutputPointSetType::PointType          PointType;
+  typedef typename OutputPointSetType::PixelType          PointDataType;
+
+  /** Set/Get the key point detector applied to each tile */
+  itkSetObjectMacro(KeyPointFilter, KeyPointFilterType);
+  itkGetObjectMacro(KeyPointFilter, KeyPointFilterType);
+
+  /** Set/Get the margin added around each tile, in pixels. If 0 (the
+   * default), the support radius of the detector is used. */
+  itkSetMacro(Margin, unsigned int);
+  itkGetMacro(Margin, unsigned int);
+
+  /** Set/Get the side of the sub-tiles each piece is split in, in pixels.
+   * If 0 (the default), each piece is processed as a whole. */
+  itkSetMacro(SubTileSize, unsigned int);
+  itkGetMacro(SubTileSize, unsigned int);
+
+  /** Get the key points of all the tiles */
+  OutputPointSetType * GetPointSet() const
+  {
+    return m_PointSet;
+  }
+
+  void AllocateOutputs() ITK_OVERRIDE;
+
+  void Reset(void) ITK_OVERRIDE;
+
+  void Synthetize(void) ITK_OVERRIDE;
+
+protected:
+  PersistentImageToKeyPointSetFilter();
+
+  ~PersistentImageToKeyPointSetFilter() ITK_OVERRIDE {}
+
+  void PrintSelf(std::ostream& os, itk::Indent indent) const ITK_OVERRIDE;
+
+  void GenerateInputRequestedRegion() ITK_OVERRIDE;
+
+  void GenerateData() ITK_OVERRIDE;
+
+private:
+  PersistentImageToKeyPointSetFilter(const Self &); //purposely not implemented
+  void operator =(const Self&); //purposely not implemented
+
+  /** Margin around the tiles, either the one set or the detector one */
+  unsigned int GetTileMargin() const;
+
+  /** Compute the input region on which the key points of the given core
+   * region are detected */
+  RegionType ComputeTileRegion(const RegionType& core) const;
+
+  /** Split the piece in square sub-tiles */
+  void SplitPiece(const RegionType& piece);
+
+  /** Detect the key points of a sub-tile with a copy of the detector
+   * running the given number of threads */
+  void DetectKeyPoints(unsigned int subTile, itk::ThreadIdType nbThreads);
+
+  /** Detect the key points of the sub-tiles given to a thread */
+  void DetectKeyPointsForThread(itk::ThreadIdType threadId, itk::ThreadIdType threadCount);
+
+  /** Static callback of the multi-threader */
+  static ITK_THREAD_RETURN_TYPE DetectionThreaderCallback(void *arg);
+
+  typedef std::vector<std::pair<PointType, PointDataType> > KeyPointListType;
+
+  KeyPointFilterPointerType m_KeyPointFilter;
+
+  OutputPointSetPointerType m_PointSet;
+
+  /** Sub-tiles of the current piece */
+  std::vector<RegionType> m_SubTiles;
+
+  /** Key points found in each sub-tile of the current piece */
+  std::vector<KeyPointListType> m_SubTileKeyPoints;
+
+  unsigned int m_Margin;
+
+  unsigned int m_SubTileSize;
+};
+
+/** \class StreamingImageToKeyPointSetFilter
+ *  \brief Streamed and multi-threaded key points extraction.
+ *
+ *  This class defines the PersistentFilterStreamingDecorator of
+ *  PersistentImageToKeyPointSetFilter, which extracts the key points of
+ *  large images piece by piece. The key points are available from
+ *  GetFilter()->GetPointSet() after Update(), and can be matched with
+ *  KeyPointSetsMatchingFilter.
+ *
+ * \sa PersistentImageToKeyPointSetFilter
+ *
+ * \ingroup OTBDescriptors
+ */
+template <class TKeyPointFilter>
+class StreamingImageToKeyPointSetFilter
+{
+public:
+
+  typedef PersistentImageToKeyPointSetFilter<TKeyPointFilter>
+    PersistentImageToKeyPointSetFilterType;
+
+  typedef typename PersistentImageToKeyPointSetFilterType::InputImageType
+      InputImageType;
+  typedef typename PersistentImageToKeyPointSetFilterType::OutputPointSetType
+      OutputPointSetType;
+
+  // typedef for streaming capable filter
+  typedef PersistentFilterStreamingDecorator<PersistentImageToKeyPointSetFilterType>
+    FilterType;
+
+};
+
+} // end namespace otb
+
+#ifndef OTB_MANUAL_INSTANTIATION
+#include "otbStreamingImageToKeyPointSetFilter.txx"
+#endif
+
+#endif
@@ -0,0 +1,303 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbStreamingImageToKeyPointSetFilter_txx
+#define otbStreamingImageToKeyPointSetFilter_txx
+
+#include "otbStreamingImageToKeyPointSetFilter.h"
+
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+#include <algorithm>
+
+namespace otb
+{
+
+template <class TKeyPointFilter>
+PersistentImageToKeyPointSetFilter<TKeyPointFilter>
+::PersistentImageToKeyPointSetFilter()
+  : m_Margin(0)
+  , m_SubTileSize(0)
+{
+  m_KeyPointFilter = KeyPointFilterType::New();
+  m_PointSet = OutputPointSetType::New();
+}
+
+template <class TKeyPointFilter>
+void
+PersistentImageToKeyPointSetFilter<TKeyPointFilter>
+::AllocateOutputs()
+{
+  // Nothing that needs to be allocated for the outputs : the output is not meant to be used
+}
+
+template <class TKeyPointFilter>
+void
+PersistentImageToKeyPointSetFilter<TKeyPointFilter>
+::Reset()
+{
+  m_PointSet->Initialize();
+}
+
+template <class TKeyPointFilter>
+void
+PersistentImageToKeyPointSetFilter<TKeyPointFilter>
+::Synthetize()
+{
+}
+
+template <class TKeyPointFilter>
+unsigned int
+PersistentImageToKeyPointSetFilter<TKeyPointFilter>
+::GetTileMargin() const
+{
+  return (m_Margin > 0) ? m_Margin : m_KeyPointFilter->GetSupportRadius();
+}
+
+template <class TKeyPointFilter>
+typename PersistentImageToKeyPointSetFilter<TKeyPointFilter>::RegionType
+PersistentImageToKeyPointSetFilter<TKeyPointFilter>
+::ComputeTileRegion(const RegionType& core) const
+{
+  const RegionType& largest = this->GetInput()->GetLargestPossibleRegion();
+  const unsigned int margin = this->GetTileMargin();
+  const long factor = m_KeyPointFilter->GetSubsamplingFactor();
+
+  RegionType tile = core;
+  tile.PadByRadius(margin);
+
+  // Start the tile on the subsampling grid of the coarsest octave
+  for (unsigned int dim = 0; dim < InputImageType::ImageDimension; ++dim)
+    {
+    long start = tile.GetIndex(dim) - largest.GetIndex(dim);
+    long end = start + static_cast<long>(tile.GetSize(dim));
+    start = std::max(0L, start);
+    start -= start % factor;
+    tile.SetIndex(dim, largest.GetIndex(dim) + start);
+    tile.SetSize(dim, end - start);
+    }
+
+  tile.Crop(largest);
+  return tile;
+}
+
+template <class TKeyPointFilter>
+void
+PersistentImageToKeyPointSetFilter<TKeyPointFilter>
+::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  if (this->GetInput())
+    {
+    InputImagePointerType input = const_cast<InputImageType *> (this->GetInput());
+    input->SetRequestedRegion(this->ComputeTileRegion(this->GetOutput()->GetRequestedRegion()));
+    }
+}
+
+template <class TKeyPointFilter>
+void
+PersistentImageToKeyPointSetFilter<TKeyPointFilter>
+::SplitPiece(const RegionType& piece)
+{
+  m_SubTiles.clear();
+  if (piece.GetNumberOfPixels() == 0)
+    {
+    return;
+    }
+
+  // The whole piece is processed by a single detector by default
+  if (m_SubTileSize == 0)
+    {
+    m_SubTiles.push_back(piece);
+    return;
+    }
+
+  // Side of the square sub-tiles, which does not depend on the number of
+  // threads so that neither do the key points
+  const unsigned long side = m_SubTileSize;
+
+  // Number of sub-tiles along each dimension, the sub-tiles being as square
+  // as possible
+  unsigned long nbSubTiles[2];
+  for (unsigned int dim = 0; dim < 2; ++dim)
+    {
+    nbSubTiles[dim] = std::max(1UL, (piece.GetSize(dim) + side / 2) / side);
+    }
+
+  for (unsigned long j = 0; j < nbSubTiles[1]; ++j)
+    {
+    for (unsigned long i = 0; i < nbSubTiles[0]; ++i)
+      {
+      const unsigned long startX = piece.GetSize(0) * i / nbSubTiles[0];
+      const unsigned long endX = piece.GetSize(0) * (i + 1) / nbSubTiles[0];
+      const unsigned long startY = piece.GetSize(1) * j / nbSubTiles[1];
+      const unsigned long endY = piece.GetSize(1) * (j + 1) / nbSubTiles[1];
+
+      RegionType subTile;
+      subTile.SetIndex(0, piece.GetIndex(0) + static_cast<long>(startX));
+      subTile.SetIndex(1, piece.GetIndex(1) + static_cast<long>(startY));
+      subTile.SetSize(0, endX - startX);
+      subTile.SetSize(1, endY - startY);
+      m_SubTiles.push_back(subTile);
+      }
+    }
+}
+
+template <class TKeyPointFilter>
+void
+PersistentImageToKeyPointSetFilter<TKeyPointFilter>
+::GenerateData()
+{
+  this->AllocateOutputs();
+
+  this->SplitPiece(this->GetOutput()->GetRequestedRegion());
+  m_SubTileKeyPoints.assign(m_SubTiles.size(), KeyPointListType());
+
+  // Detect the key points of the sub-tiles in parallel. A single sub-tile is
+  // processed by a detector with all the threads. The non reentrant
+  // detectors process the sub-tiles one after the other.
+  if (m_SubTiles.size() == 1)
+    {
+    this->DetectKeyPoints(0, this->GetNumberOfThreads());
+    }
+  else if (!KeyPointFilterTraits<KeyPointFilterType>::Reentrant)
+    {
+    for (unsigned int subTile = 0; subTile < m_SubTiles.size(); ++subTile)
+      {
+      this->DetectKeyPoints(subTile, 1);
+      }
+    }
+  else
+    {
+    this->GetMultiThreader()->SetNumberOfThreads(this->GetNumberOfThreads());
+    this->GetMultiThreader()->SetSingleMethod(this->DetectionThreaderCallback, this);
+    this->GetMultiThreader()->SingleMethodExecute();
+    }
+
+  // Append the key points in the order of the sub-tiles, so that the output
+  // does not depend on the threads scheduling
+  typename OutputPointSetType::PointIdentifier id = m_PointSet->GetNumberOfPoints();
+  for (unsigned int subTile = 0; subTile < m_SubTileKeyPoints.size(); ++subTile)
+    {
+    for (typename KeyPointListType::const_iterator it = m_SubTileKeyPoints[subTile].begin();
+         it != m_SubTileKeyPoints[subTile].end(); ++it, ++id)
+      {
+      m_PointSet->SetPoint(id, it->first);
+      m_PointSet->SetPointData(id, it->second);
+      }
+    }
+  m_SubTileKeyPoints.clear();
+  m_SubTiles.clear();
+}
+
+template <class TKeyPointFilter>
+ITK_THREAD_RETURN_TYPE
+PersistentImageToKeyPointSetFilter<TKeyPointFilter>
+::DetectionThreaderCallback(void *arg)
+{
+  itk::ThreadIdType threadId = ((itk::MultiThreader::ThreadInfoStruct *) (arg))->ThreadID;
+  itk::ThreadIdType threadCount = ((itk::MultiThreader::ThreadInfoStruct *) (arg))->NumberOfThreads;
+  Self * filter = (Self *) (((itk::MultiThreader::ThreadInfoStruct *) (arg))->UserData);
+
+  filter->DetectKeyPointsForThread(threadId, threadCount);
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template <class TKeyPointFilter>
+void
+PersistentImageToKeyPointSetFilter<TKeyPointFilter>
+::DetectKeyPointsForThread(itk::ThreadIdType threadId, itk::ThreadIdType threadCount)
+{
+  for (unsigned int subTile = threadId; subTile < m_SubTiles.size(); subTile += threadCount)
+    {
+    this->DetectKeyPoints(subTile, 1);
+    }
+}
+
+template <class TKeyPointFilter>
+void
+PersistentImageToKeyPointSetFilter<TKeyPointFilter>
+::DetectKeyPoints(unsigned int subTile, itk::ThreadIdType nbThreads)
+{
+  const InputImageType * input = this->GetInput();
+  const RegionType& core = m_SubTiles[subTile];
+  const RegionType tileRegion = this->ComputeTileRegion(core);
+
+  // Copy the tile in a standalone image, so that the detector is not
+  // connected to the pipeline and its pyramid starts at the tile origin
+  RegionType bufferRegion;
+  bufferRegion.SetSize(tileRegion.GetSize());
+
+  typename InputImageType::PointType tileOrigin;
+  input->TransformIndexToPhysicalPoint(tileRegion.GetIndex(), tileOrigin);
+
+  InputImagePointerType tile = InputImageType::New();
+  tile->SetRegions(bufferRegion);
+  tile->SetOrigin(tileOrigin);
+  tile->SetSpacing(input->GetSpacing());
+  tile->SetDirection(input->GetDirection());
+  tile->Allocate();
+
+  itk::ImageRegionConstIterator<InputImageType> inIt(input, tileRegion);
+  itk::ImageRegionIterator<InputImageType>      tileIt(tile, bufferRegion);
+  for (inIt.GoToBegin(), tileIt.GoToBegin(); !inIt.IsAtEnd(); ++inIt, ++tileIt)
+    {
+    tileIt.Set(inIt.Get());
+    }
+
+  // Sub-tiles are processed concurrently, by single threaded clones
+  itk::LightObject::Pointer clone = m_KeyPointFilter->Clone();
+  KeyPointFilterPointerType detector = dynamic_cast<KeyPointFilterType *>(clone.GetPointer());
+  detector->SetNumberOfThreads(nbThreads);
+  detector->SetInput(tile);
+  detector->Update();
+
+  // Keep the key points of the core of the tile
+  const OutputPointSetType * keyPoints = detector->GetOutput();
+  KeyPointListType& subTileKeyPoints = m_SubTileKeyPoints[subTile];
+  typename OutputPointSetType::PointsContainer::ConstIterator pointIt = keyPoints->GetPoints()->Begin();
+  for (; pointIt != keyPoints->GetPoints()->End(); ++pointIt)
+    {
+    IndexType index;
+    input->TransformPhysicalPointToIndex(pointIt.Value(), index);
+    if (core.IsInside(index))
+      {
+      PointDataType data;
+      keyPoints->GetPointData(pointIt.Index(), &data);
+      subTileKeyPoints.push_back(std::make_pair(pointIt.Value(), data));
+      }
+    }
+}
+
+template <class TKeyPointFilter>
+void
+PersistentImageToKeyPointSetFilter<TKeyPointFilter>
+::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "Margin: " << m_Margin << std::endl;
+  os << indent << "SubTileSize: " << m_SubTileSize << std::endl;
+  os << indent << "Number of key points: " << m_PointSet->GetNumberOfPoints() << std::endl;
+}
+
+} // end namespace otb
+#endif
@@ -32,6 +32,7 @@ void RegisterTests()
   REGISTER_TEST(otbLandmarkNew);
   REGISTER_TEST(otbImageToSIFTKeyPointSetFilterNew);
   REGISTER_TEST(otbKeyPointSetsMatchingFilter);
+  REGISTER_TEST(otbKeyPointSetsMatchingFilterApproximate);
   REGISTER_TEST(otbImageToSIFTKeyPointSetFilterOutputDescriptorAscii);
   REGISTER_TEST(otbImageToSIFTKeyPointSetFilterOutputAscii);
   REGISTER_TEST(otbFourierMellinImageFilter);
@@ -44,6 +45,7 @@ void RegisterTests()
   REGISTER_TEST(otbImageToSIFTKeyPointSetFilterDistanceMap);
   REGISTER_TEST(otbImageToHessianDeterminantImageFilterNew);
   REGISTER_TEST(otbFourierMellinImageFilterNew);
+  REGISTER_TEST(otbStreamingImageToKeyPointSetFilter);
 #ifdef OTB_USE_SIFTFAST
   REGISTER_TEST(otbImageToFastSIFTKeyPointSetFilterNew);
   REGISTER_TEST(otbImageToFastSIFTKeyPointSetFilterOutputInterestPointAscii);
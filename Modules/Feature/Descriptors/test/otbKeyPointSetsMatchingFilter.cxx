@@ -24,6 +24,7 @@
 
 #include "itkVariableLengthVector.h"
 #include "itkPointSet.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
 
 #include <iostream>
 #include <fstream>
@@ -106,3 +107,103 @@ int otbKeyPointSetsMatchingFilter(int itkNotUsed(argc), char* argv[])
 
   return EXIT_SUCCESS;
 }
+
+int otbKeyPointSetsMatchingFilterApproximate(int itkNotUsed(argc), char* argv[])
+{
+  const unsigned int nbPoints = atoi(argv[1]);
+  const unsigned int nbComponents = atoi(argv[2]);
+  const bool         useBackMatching = atoi(argv[3]);
+
+  typedef itk::VariableLengthVector<double>             PointDataType;
+  typedef itk::PointSet<PointDataType, 2>               PointSetType;
+  typedef PointSetType::PointType                       PointType;
+  typedef otb::KeyPointSetsMatchingFilter<PointSetType> MatchingFilterType;
+  typedef MatchingFilterType::LandmarkListType          LandmarkListType;
+  typedef itk::Statistics::MersenneTwisterRandomVariateGenerator RandomGeneratorType;
+
+  RandomGeneratorType::Pointer generator = RandomGeneratorType::New();
+  generator->SetSeed(121212);
+
+  // Pointset 2 holds noisy copies of the descriptors of pointset 1, in
+  // reverse order, and as many unrelated descriptors
+  PointSetType::Pointer ps1 = PointSetType::New();
+  PointSetType::Pointer ps2 = PointSetType::New();
+
+  for (unsigned int i = 0; i < nbPoints; ++i)
+    {
+    PointType p;
+    p[0] = i;
+    p[1] = 2 * i;
+
+    PointDataType d1(nbComponents), d2(nbComponents), d3(nbComponents);
+    for (unsigned int j = 0; j < nbComponents; ++j)
+      {
+      d1[j] = generator->GetUniformVariate(0., 1.);
+      d2[j] = d1[j] + generator->GetUniformVariate(-0.05, 0.05);
+      d3[j] = generator->GetUniformVariate(0., 1.);
+      }
+
+    ps1->SetPoint(i, p);
+    ps1->SetPointData(i, d1);
+    ps2->SetPoint(nbPoints - 1 - i, p);
+    ps2->SetPointData(nbPoints - 1 - i, d2);
+    ps2->SetPoint(nbPoints + i, p);
+    ps2->SetPointData(nbPoints + i, d3);
+    }
+
+  MatchingFilterType::Pointer exactFilter = MatchingFilterType::New();
+  exactFilter->SetInput1(ps1);
+  exactFilter->SetInput2(ps2);
+  exactFilter->SetUseBackMatching(useBackMatching);
+  exactFilter->Update();
+
+  // With as many checks as points, the approximate search is exhaustive
+  MatchingFilterType::Pointer approxFilter = MatchingFilterType::New();
+  approxFilter->SetInput1(ps1);
+  approxFilter->SetInput2(ps2);
+  approxFilter->SetUseBackMatching(useBackMatching);
+  approxFilter->ApproximateSearchOn();
+  approxFilter->SetMaximumNumberOfChecks(2 * nbPoints);
+  approxFilter->Update();
+
+  LandmarkListType * exactMatches = exactFilter->GetOutput();
+  LandmarkListType * approxMatches = approxFilter->GetOutput();
+
+  std::cout << "Exact matches: " << exactMatches->Size() << std::endl;
+  std::cout << "Approximate matches: " << approxMatches->Size() << std::endl;
+
+  if (exactMatches->Size() != approxMatches->Size())
+    {
+    std::cerr << "Exact and exhaustive approximate searches do not find the same number of matches." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  LandmarkListType::Iterator exactIt = exactMatches->Begin();
+  LandmarkListType::Iterator approxIt = approxMatches->Begin();
+  for (; exactIt != exactMatches->End(); ++exactIt, ++approxIt)
+    {
+    if (exactIt.Get()->GetPoint1() != approxIt.Get()->GetPoint1()
+        || exactIt.Get()->GetPoint2() != approxIt.Get()->GetPoint2()
+        || exactIt.Get()->GetLandmarkData() != approxIt.Get()->GetLandmarkData())
+      {
+      std::cerr << "Exact and exhaustive approximate searches differ: " << exactIt.Get()->GetPoint1() << " -> "
+                << exactIt.Get()->GetPoint2() << " vs " << approxIt.Get()->GetPoint1() << " -> "
+                << approxIt.Get()->GetPoint2() << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // The default number of checks should still find most of the matches
+  approxFilter->SetMaximumNumberOfChecks(256);
+  approxFilter->Update();
+
+  std::cout << "Approximate matches with 256 checks: " << approxFilter->GetOutput()->Size() << std::endl;
+
+  if (2 * approxFilter->GetOutput()->Size() < exactMatches->Size())
+    {
+    std::cerr << "Approximate search with 256 checks finds less than half of the matches." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
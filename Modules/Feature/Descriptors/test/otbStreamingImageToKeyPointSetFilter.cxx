@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "otbStreamingImageToKeyPointSetFilter.h"
+#include "otbImageToSURFKeyPointSetFilter.h"
+#include "otbImage.h"
+#include "otbImageFileReader.h"
+#include "itkVariableLengthVector.h"
+
+namespace
+{
+typedef float                                            RealType;
+typedef otb::Image<RealType, 2>                          ImageType;
+typedef itk::VariableLengthVector<RealType>              RealVectorType;
+typedef itk::PointSet<RealVectorType, 2>                 PointSetType;
+typedef PointSetType::PointsContainer::ConstIterator     PointsIteratorType;
+
+// Count the points of the first set which are also in the second one
+unsigned int CountCommonPoints(const PointSetType * first, const PointSetType * second)
+{
+  unsigned int nbCommon = 0;
+  for (PointsIteratorType it1 = first->GetPoints()->Begin(); it1 != first->GetPoints()->End(); ++it1)
+    {
+    for (PointsIteratorType it2 = second->GetPoints()->Begin(); it2 != second->GetPoints()->End(); ++it2)
+      {
+      if (it1.Value().SquaredEuclideanDistanceTo(it2.Value()) < 1e-4)
+        {
+        ++nbCommon;
+        break;
+        }
+      }
+    }
+  return nbCommon;
+}
+}
+
+int otbStreamingImageToKeyPointSetFilter(int argc, char * argv[])
+{
+  if (argc != 6 && argc != 7)
+    {
+    std::cerr << "Usage: " << argv[0] << " infname octaves scales nbDivisions nbThreads [subTileSize]" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const char *       infname     = argv[1];
+  const unsigned int octaves     = atoi(argv[2]);
+  const unsigned int scales      = atoi(argv[3]);
+  const unsigned int nbDivisions = atoi(argv[4]);
+  const unsigned int nbThreads   = atoi(argv[5]);
+  const unsigned int subTileSize = (argc == 7) ? atoi(argv[6]) : 0;
+
+  typedef otb::ImageFileReader<ImageType>                                  ReaderType;
+  typedef otb::ImageToSURFKeyPointSetFilter<ImageType, PointSetType>       SURFFilterType;
+  typedef otb::StreamingImageToKeyPointSetFilter<SURFFilterType>::FilterType StreamingSURFFilterType;
+
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(infname);
+
+  // Key points of the whole image
+  SURFFilterType::Pointer surf = SURFFilterType::New();
+  surf->SetInput(reader->GetOutput());
+  surf->SetOctavesNumber(octaves);
+  surf->SetScalesNumber(scales);
+  surf->Update();
+
+  // Key points extracted by tiles
+  StreamingSURFFilterType::Pointer streamingSurf = StreamingSURFFilterType::New();
+  streamingSurf->GetFilter()->SetInput(reader->GetOutput());
+  streamingSurf->GetFilter()->GetKeyPointFilter()->SetOctavesNumber(octaves);
+  streamingSurf->GetFilter()->GetKeyPointFilter()->SetScalesNumber(scales);
+  streamingSurf->GetFilter()->SetNumberOfThreads(nbThreads);
+  streamingSurf->GetFilter()->SetSubTileSize(subTileSize);
+  streamingSurf->GetStreamer()->SetNumberOfDivisionsTiledStreaming(nbDivisions);
+  streamingSurf->Update();
+
+  const PointSetType * fullKeyPoints = surf->GetOutput();
+  const PointSetType * tiledKeyPoints = streamingSurf->GetFilter()->GetPointSet();
+
+  const unsigned int nbFull = fullKeyPoints->GetNumberOfPoints();
+  const unsigned int nbTiled = tiledKeyPoints->GetNumberOfPoints();
+  const unsigned int nbFullFound = CountCommonPoints(fullKeyPoints, tiledKeyPoints);
+  const unsigned int nbTiledFound = CountCommonPoints(tiledKeyPoints, fullKeyPoints);
+
+  std::cout << nbFull << " key points on the whole image, " << nbTiled << " by tiles, "
+            << nbFullFound << " and " << nbTiledFound << " in common" << std::endl;
+
+  // Tiles only differ from the whole image by the recursive gaussian
+  // boundary effects, far in the margins
+  if (nbFull == 0 || nbFullFound < 0.95 * nbFull || nbTiledFound < 0.95 * nbTiled)
+    {
+    std::cerr << "Key points extracted by tiles differ from the whole image ones" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // A single piece processed as a whole gives the key points of the whole
+  // image, whatever the number of threads
+  if (nbDivisions == 1 && subTileSize == 0 && (nbTiled != nbFull || nbFullFound != nbFull))
+    {
+    std::cerr << "A single tile does not give the key points of the whole image" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Running again gives the same key points, without accumulating them
+  streamingSurf->GetFilter()->Modified();
+  streamingSurf->Update();
+  if (tiledKeyPoints->GetNumberOfPoints() != nbTiled)
+    {
+    std::cerr << "A second run gives " << tiledKeyPoints->GetNumberOfPoints() << " key points" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -176,6 +176,41 @@ public:
   virtual void SetInput(const InputImageType *input);
   virtual const InputImageType * GetInput(void);
 
+  /** Set/Get the threshold on the gradient magnitude below which pixels
+   * can not seed nor belong to a segment (default is 5.2). */
+  itkSetMacro(Threshold, double);
+  itkGetMacro(Threshold, double);
+
+  /** If on (default), the threshold is relative to the range of the gradient
+   * magnitude of the input, scaled to [0, 255]. Turn it off to apply the same
+   * threshold to images processed by tiles. */
+  itkSetMacro(NormalizeThreshold, bool);
+  itkGetMacro(NormalizeThreshold, bool);
+  itkBooleanMacro(NormalizeThreshold);
+
+  /** Set/Get the size of the image on which segments are validated. The
+   * number of tests of the a contrario validation depends on it. When the
+   * input is a tile, setting the size of the full image validates segments
+   * as if the full image were processed. A null size (default) stands for
+   * the largest possible region of the input. */
+  itkSetMacro(ImageSize, SizeType);
+  itkGetConstReferenceMacro(ImageSize, SizeType);
+
+  /** Get the rectangles of the detected segments, in index coordinates */
+  const RectangleListType& GetRectangleList() const
+  {
+    return m_RectangleList;
+  }
+
+  /** Count the points of the region lying in a rectangle, and the ones
+   * aligned with it. Can only be called after an update. */
+  void CountAlignedPoints(const RectangleType& rec, const RegionType& region,
+                          int& nbPoints, int& nbAligned) const;
+
+  /** Number of False Alarms of a rectangle with nbPoints points, nbAligned of
+   * which are aligned, for the size of the image */
+  double ComputeNFA(int nbPoints, int nbAligned) const;
+
   /** Custom Get methods to access intermediate data*/
   LabelImagePointerType GetMap()
   {
@@ -250,6 +285,9 @@ protected:
   /** */
   virtual double ImproveRectangle(RectangleType& rectangle) const;
 
+  /** Number of pixels of the image on which segments are validated */
+  itk::SizeValueType GetNumberOfTestedPixels() const;
+
   /** NFA For a rectangle*/
   virtual double NFA(int n, int k, double p, double logNT) const;
 
@@ -269,6 +307,9 @@ private:
   RectangleListType       m_RectangleList;
 
   double       m_Threshold;
+  double       m_MagnitudeThreshold;
+  bool         m_NormalizeThreshold;
+  SizeType     m_ImageSize;
   double       m_Prec;
   double       m_DirectionsAllowed;
   unsigned int m_MinimumRegionSize;
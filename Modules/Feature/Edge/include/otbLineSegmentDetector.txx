@@ -54,6 +54,9 @@ LineSegmentDetector<TInputImage, TPrecision>
   m_DirectionsAllowed = 1. / 8.;
   m_Prec = CONST_PI * m_DirectionsAllowed;
   m_Threshold = 5.2;
+  m_MagnitudeThreshold = 0.;
+  m_NormalizeThreshold = true;
+  m_ImageSize.Fill(0);
 
   /** Compute the modulus and the orientation gradient images */
   m_GradientFilter = GradientFilterType::New();
@@ -118,6 +121,8 @@ LineSegmentDetector<TInputImage, TPrecision>
     itkExceptionMacro(<< "Not streamed filter. ERROR : requested region is not the largest possible region.");
     }
 
+  m_RectangleList.clear();
+
   /** Allocate memory for the temporary label Image*/
   m_UsedPointImage->SetRegions(this->GetInput()->GetLargestPossibleRegion());
   m_UsedPointImage->Allocate();
@@ -127,12 +132,16 @@ LineSegmentDetector<TInputImage, TPrecision>
   typedef itk::CastImageFilter<InputImageType, OutputImageType> castFilerType;
   typename castFilerType::Pointer castFilter =  castFilerType::New();
   castFilter->SetInput(this->GetInput());
+  castFilter->SetNumberOfThreads(this->GetNumberOfThreads());
 
   /** Compute the modulus and the orientation gradient image */
   m_GradientFilter->SetInput(castFilter->GetOutput());
   m_GradientFilter->SetSigma(0.6);
+  m_GradientFilter->SetNumberOfThreads(this->GetNumberOfThreads());
   m_MagnitudeFilter->SetInput(m_GradientFilter->GetOutput());
+  m_MagnitudeFilter->SetNumberOfThreads(this->GetNumberOfThreads());
   m_OrientationFilter->SetInput(m_GradientFilter->GetOutput());
+  m_OrientationFilter->SetNumberOfThreads(this->GetNumberOfThreads());
 
   m_MagnitudeFilter->Update();
   m_OrientationFilter->Update();
@@ -157,7 +166,7 @@ LineSegmentDetector<TInputImage, TPrecision>
   RegionType largestRegion = this->GetInput()->GetLargestPossibleRegion();
 
   // Compute the minimum region size
-  double logNT = 5. * vcl_log10( static_cast<double>(largestRegion.GetNumberOfPixels()) ) / 2.;
+  double logNT = 5. * vcl_log10( static_cast<double>(this->GetNumberOfTestedPixels()) ) / 2.;
   double log1_p = vcl_log10(m_DirectionsAllowed);
   double rapport = logNT / log1_p;
   m_MinimumRegionSize = static_cast<unsigned int>(-rapport);
@@ -173,11 +182,20 @@ LineSegmentDetector<TInputImage, TPrecision>
   OutputPixelType max = minmaxCalculator->GetMaximum();
 
   /** Compute the threshold on the gradient*/
-  m_Threshold = m_Threshold * ((max - min) / 255.);     // threshold normalized with min & max of the values
+  m_MagnitudeThreshold = m_Threshold;
+  if (m_NormalizeThreshold)
+    {
+    m_MagnitudeThreshold *= (max - min) / 255.;     // threshold normalized with min & max of the values
+    }
 
   /** Computing the length of the bins*/
   unsigned int NbBin = 1024;
   double       lengthBin = static_cast<double>((max - min)) / static_cast<double>(NbBin-1);
+  if (lengthBin <= 0.)
+    {
+    // Uniform gradient magnitude (flat image or tile): all pixels share the first bin
+    lengthBin = 1.;
+    }
   CoordinateHistogramType  tempHisto(NbBin);  /** Initializing the histogram */
 
   // New region : without boundaries
@@ -227,7 +245,7 @@ LineSegmentDetector<TInputImage, TPrecision>
     // Highlights bug 498
     assert(bin<NbBin);
 
-    if (it.Value() - m_Threshold > 1e-10) tempHisto[NbBin - bin - 1].push_back(it.GetIndex());
+    if (it.Value() - m_MagnitudeThreshold > 1e-10) tempHisto[NbBin - bin - 1].push_back(it.GetIndex());
     else SetPixelToUsed(it.GetIndex());
 
     ++it;
@@ -692,7 +710,7 @@ LineSegmentDetector<TInputImage, TPrecision>
       }
     } /** End Searching loop*/
 
-  unsigned int nbPixels = this->GetInput()->GetLargestPossibleRegion().GetNumberOfPixels();
+  itk::SizeValueType nbPixels = this->GetNumberOfTestedPixels();
   if (region.size() > m_MinimumRegionSize && region.size() < nbPixels / 4)
     {
     return EXIT_SUCCESS;
@@ -949,13 +967,29 @@ double
 LineSegmentDetector<TInputImage, TPrecision>
 ::ComputeRectNFA(const RectangleType& rec) const
 {
-  int    NbAligned = 0;
-  double nfa_val = 0.;
-
   /** Compute the NFA of the rectangle
    *  We Need : The number of : Points in the rec  (Area of the rectangle)
    *                            Aligned points  with theta in the rectangle
    */
+  int pts = 0;
+  int NbAligned = 0;
+  this->CountAlignedPoints(rec, m_OrientationFilter->GetOutput()->GetLargestPossibleRegion(), pts, NbAligned);
+
+  /** Compute the NFA from the rectangle computed below*/
+  return this->ComputeNFA(pts, NbAligned);
+}
+
+/**************************************************************************************************************/
+/**
+ * count the points of a region in the rectangle, and the ones aligned with it
+ */
+template <class TInputImage, class TPrecision>
+void
+LineSegmentDetector<TInputImage, TPrecision>
+::CountAlignedPoints(const RectangleType& rec, const RegionType& countRegion, int& nbPoints, int& nbAligned) const
+{
+  nbPoints = 0;
+  nbAligned = 0;
 
   /**  Compute the number of points aligned */
   typedef otb::Rectangle<double> RectangleType;
@@ -973,34 +1007,57 @@ LineSegmentDetector<TInputImage, TPrecision>
   rectangle->SetOrientation(rec[5]);
 
   /** Get The Bounding Region*/
-  OutputImageDirRegionType region = m_OrientationFilter->GetOutput()->GetLargestPossibleRegion();
-  region.Crop(rectangle->GetBoundingRegion());
-
+  OutputImageDirRegionType region = countRegion;
+  if (!region.Crop(m_OrientationFilter->GetOutput()->GetLargestPossibleRegion())
+      || !region.Crop(rectangle->GetBoundingRegion()))
+    {
+    return;
+    }
 
   itk::ImageRegionIterator<OutputImageDirType> it(m_OrientationFilter->GetOutput(), region);
   it.GoToBegin();
 
-  int pts = 0;
-
   while (!it.IsAtEnd())
     {
     if (rectangle->IsInside(it.GetIndex()) &&
         m_OrientationFilter->GetOutput()->GetBufferedRegion().IsInside(it.GetIndex()))
       {
-      ++pts;
+      ++nbPoints;
 
-      if (this->IsAligned(it.Get(), rec[5] /*theta*/, rec[6] /*Prec*/)) NbAligned++;
+      if (this->IsAligned(it.Get(), rec[5] /*theta*/, rec[6] /*Prec*/)) nbAligned++;
       }
     ++it;
     }
+}
 
-  /** Compute the NFA from the rectangle computed below*/
-  RegionType largestRegion = const_cast<Self*>(this)->GetInput()->GetLargestPossibleRegion();
-  double logNT = 5. * vcl_log10( static_cast<double>(largestRegion.GetNumberOfPixels()) ) / 2.;
+/**************************************************************************************************************/
+/**
+ * NFA of a rectangle for the number of tests of the image
+ */
+template <class TInputImage, class TPrecision>
+double
+LineSegmentDetector<TInputImage, TPrecision>
+::ComputeNFA(int nbPoints, int nbAligned) const
+{
+  double logNT = 5. * vcl_log10( static_cast<double>(this->GetNumberOfTestedPixels()) ) / 2.;
 
-  nfa_val = NFA(pts, NbAligned, m_DirectionsAllowed, logNT);
+  return this->NFA(nbPoints, nbAligned, m_DirectionsAllowed, logNT);
+}
 
-  return nfa_val;
+/**************************************************************************************************************/
+/**
+ * number of pixels of the image on which segments are validated
+ */
+template <class TInputImage, class TPrecision>
+itk::SizeValueType
+LineSegmentDetector<TInputImage, TPrecision>
+::GetNumberOfTestedPixels() const
+{
+  if (m_ImageSize[0] > 0 && m_ImageSize[1] > 0)
+    {
+    return static_cast<itk::SizeValueType>(m_ImageSize[0]) * m_ImageSize[1];
+    }
+  return const_cast<Self*>(this)->GetInput()->GetLargestPossibleRegion().GetNumberOfPixels();
 }
 
 /**************************************************************************************************************/
@@ -1050,7 +1107,9 @@ LineSegmentDetector<TInputImage, TPrecision>
 ::PrintSelf(std::ostream& os, itk::Indent indent) const
 {
   Superclass::PrintSelf(os, indent);
-
+  os << indent << "Threshold: " << m_Threshold << std::endl;
+  os << indent << "NormalizeThreshold: " << m_NormalizeThreshold << std::endl;
+  os << indent << "ImageSize: " << m_ImageSize << std::endl;
 }
 
 } // end namespace otb
@@ -0,0 +1,315 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef otbStreamingLineSegmentDetectorToOGRLayerFilter_h
+#define otbStreamingLineSegmentDetectorToOGRLayerFilter_h
+
+#include "otbLineSegmentDetector.h"
+#include "otbPersistentImageToOGRLayerFilter.h"
+#include "otbPersistentFilterStreamingDecorator.h"
+
+#include "itkTransform.h"
+#include "itkMultiThreader.h"
+
+#include <vector>
+
+namespace otb
+{
+
+/** \class PersistentLineSegmentDetectorToOGRLayerFilter
+ *  \brief Detect line segments by tiles and write them to an \c ogr::Layer.
+ *
+ *  Each streamed piece is cut into tiles of \c TileSize pixels, anchored on
+ *  the image grid. Tiles are padded by \c Margin pixels and processed
+ *  independently by the \c LineSegmentDetector in parallel threads. Segments
+ *  are validated with the number of tests of the full image, and the gradient
+ *  threshold is applied as is to all tiles (it is not normalized by the
+ *  gradient range of each tile). The input should therefore be scaled to
+ *  [0, 255], as the LSD threshold expects.
+ *
+ *  Segments lying in the core of their tile are written directly. Segments
+ *  crossing the border of a tile core are kept with the number of points and
+ *  aligned points of their rectangle in the core. Once the neighbouring tiles
+ *  have been processed, collinear segments from different tiles are merged,
+ *  and the merged segment is validated again by the a contrario test on the
+ *  sum of these counts. If the validation fails, or if a segment has no
+ *  collinear neighbour, segments are written if their middle lies in the core
+ *  of their tile.
+ *
+ *  Only the segments crossing tile borders in the last rows of streamed
+ *  pieces are kept in memory. Pieces have to be streamed in raster order
+ *  (which is the case of all OTB streaming managers).
+ *
+ *  Coordinates are written in the physical space of the input image, or
+ *  through \c OutputTransform if one is set (for instance to write segments
+ *  detected in sensor geometry in a map projection). In this case, the
+ *  spatial reference of the output layer is not checked by \c Initialize().
+ *
+ * \sa LineSegmentDetector
+ * \sa StreamingLineSegmentDetectorToOGRLayerFilter
+ *
+ * \ingroup OTBEdge
+ */
+template <class TInputImage>
+class ITK_EXPORT PersistentLineSegmentDetectorToOGRLayerFilter :
+  public PersistentImageToOGRLayerFilter<TInputImage>
+{
+public:
+  /** Standard Self typedef */
+  typedef PersistentLineSegmentDetectorToOGRLayerFilter  Self;
+  typedef PersistentImageToOGRLayerFilter<TInputImage>   Superclass;
+  typedef itk::SmartPointer<Self>                        Pointer;
+  typedef itk::SmartPointer<const Self>                  ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(PersistentLineSegmentDetectorToOGRLayerFilter, PersistentImageToOGRLayerFilter);
+
+  typedef typename Superclass::InputImageType            InputImageType;
+  typedef typename InputImageType::Pointer               InputImagePointerType;
+  typedef typename InputImageType::RegionType            RegionType;
+  typedef typename InputImageType::SizeType              SizeType;
+  typedef typename InputImageType::IndexType             IndexType;
+  typedef typename IndexType::IndexValueType             IndexValueType;
+
+  typedef typename Superclass::OGRDataSourceType         OGRDataSourceType;
+  typedef typename Superclass::OGRDataSourcePointerType  OGRDataSourcePointerType;
+  typedef typename Superclass::OGRLayerType              OGRLayerType;
+  typedef typename Superclass::OGRFeatureType            OGRFeatureType;
+
+  typedef LineSegmentDetector<InputImageType, double>    LSDType;
+  typedef typename LSDType::RectangleType                RectangleType;
+
+  typedef itk::Transform<double, 2, 2>                   TransformType;
+
+  /** Set/Get the size of the tiles processed in parallel (default is 512). */
+  itkSetMacro(TileSize, unsigned int);
+  itkGetMacro(TileSize, unsigned int);
+
+  /** Set/Get the overlap between tiles, in pixels (default is 16). */
+  itkSetMacro(Margin, unsigned int);
+  itkGetMacro(Margin, unsigned int);
+
+  /** Set/Get the threshold on the gradient magnitude (default is 5.2). */
+  itkSetMacro(Threshold, double);
+  itkGetMacro(Threshold, double);
+
+  /** Set/Get the transform applied to the physical coordinates of the segments (none by default). */
+  itkSetConstObjectMacro(OutputTransform, TransformType);
+  itkGetConstObjectMacro(OutputTransform, TransformType);
+
+  /** Get the number of segments written to the output layer. */
+  itkGetConstMacro(NumberOfSegments, itk::SizeValueType);
+
+  void Reset(void) ITK_OVERRIDE;
+  void Synthetize(void) ITK_OVERRIDE;
+
+  /** Check the spatial reference of the output layer, unless an output
+   * transform is set. */
+  void Initialize(void) ITK_OVERRIDE;
+
+protected:
+  PersistentLineSegmentDetectorToOGRLayerFilter();
+  ~PersistentLineSegmentDetectorToOGRLayerFilter() ITK_OVERRIDE;
+
+  /** Pad the requested region by the margin */
+  void GenerateInputRequestedRegion() ITK_OVERRIDE;
+
+  void PrintSelf(std::ostream& os, itk::Indent indent) const ITK_OVERRIDE;
+
+  /** Segment in the index coordinates of the input image, with the counts
+   * of its rectangle in the core of the tile where it was detected. */
+  struct Segment
+  {
+    double             X1;
+    double             Y1;
+    double             X2;
+    double             Y2;
+    double             Width;
+    double             Theta;
+    double             Prec;
+    int                NbPoints;
+    int                NbAligned;
+    itk::SizeValueType Tile;
+    RegionType         Core;
+  };
+
+  typedef std::vector<Segment>                           SegmentListType;
+
+  /** Detect the segments of a tile of the current piece */
+  void DetectSegments(unsigned int tile);
+
+  /** Detect the segments of the tiles handled by a thread */
+  void DetectSegmentsForThread(itk::ThreadIdType threadId, itk::ThreadIdType threadCount);
+
+  /** Static function used as a "callback" by the MultiThreader */
+  static ITK_THREAD_RETURN_TYPE DetectionThreaderCallback(void *arg);
+
+  /** Merge or select the pending segments crossing tile borders which lie
+   * above the given row, and append the resulting segments to output */
+  void ResolveSeamSegments(double rowLimit, SegmentListType& output);
+
+  /** Tells if two segments from different tiles are parts of the same segment */
+  bool AreCollinear(const Segment& a, const Segment& b) const;
+
+  /** Merge collinear segments in a single one, and return its validation */
+  bool MergeSegments(const SegmentListType& segments, const LSDType * validator, Segment& merged) const;
+
+  /** Write segments to a layer */
+  void WriteSegments(const SegmentListType& segments, OGRLayerType& layer) const;
+
+private:
+  PersistentLineSegmentDetectorToOGRLayerFilter(const Self &); //purposely not implemented
+  void operator =(const Self&); //purposely not implemented
+
+  OGRDataSourcePointerType ProcessTile() ITK_OVERRIDE;
+
+  /** Tells if the middle of a segment lies in the core of its tile */
+  static bool IsInCore(const Segment& segment);
+
+  /** Tells if a point in index coordinates lies in the pixels of a region */
+  static bool IsInside(const RegionType& region, double x, double y);
+
+  /** Find the root of a segment in the union-find forest */
+  static unsigned int FindRoot(std::vector<unsigned int>& parents, unsigned int i);
+
+  unsigned int m_TileSize;
+  unsigned int m_Margin;
+  double       m_Threshold;
+
+  typename TransformType::ConstPointer m_OutputTransform;
+
+  itk::SizeValueType m_NumberOfSegments;
+
+  // Number of tiles processed so far
+  itk::SizeValueType m_NumberOfTiles;
+
+  // Cores of the tiles of the current piece, and their segments
+  std::vector<RegionType>      m_PieceTiles;
+  std::vector<SegmentListType> m_CoreSegments;
+  std::vector<SegmentListType> m_BorderSegments;
+
+  // Segments crossing tile borders, waiting for the neighbouring tiles
+  SegmentListType m_SeamSegments;
+};
+
+/** \class StreamingLineSegmentDetectorToOGRLayerFilter
+ *  \brief Streamed line segment detection into an \c ogr::Layer.
+ *
+ *  This filter wraps \c PersistentLineSegmentDetectorToOGRLayerFilter with a
+ *  streaming decorator, so that line segments of large images are detected
+ *  with a bounded memory footprint, and written to the output layer piece by
+ *  piece.
+ *
+ *  \c Initialize() must be called before \c Update().
+ *
+ * \sa PersistentLineSegmentDetectorToOGRLayerFilter
+ *
+ * \ingroup OTBEdge
+ */
+template <class TInputImage>
+class ITK_EXPORT StreamingLineSegmentDetectorToOGRLayerFilter :
+  public PersistentFilterStreamingDecorator<PersistentLineSegmentDetectorToOGRLayerFilter<TInputImage> >
+{
+public:
+  /** Standard Self typedef */
+  typedef StreamingLineSegmentDetectorToOGRLayerFilter                               Self;
+  typedef PersistentFilterStreamingDecorator
+  <PersistentLineSegmentDetectorToOGRLayerFilter<TInputImage> >                       Superclass;
+  typedef itk::SmartPointer<Self>                                                    Pointer;
+  typedef itk::SmartPointer<const Self>                                              ConstPointer;
+
+  /** Type macro */
+  itkNewMacro(Self);
+
+  /** Creation through object factory macro */
+  itkTypeMacro(StreamingLineSegmentDetectorToOGRLayerFilter, PersistentFilterStreamingDecorator);
+
+  typedef TInputImage                                                                InputImageType;
+  typedef typename PersistentLineSegmentDetectorToOGRLayerFilter<TInputImage>::OGRLayerType  OGRLayerType;
+  typedef typename PersistentLineSegmentDetectorToOGRLayerFilter<TInputImage>::TransformType TransformType;
+
+  using Superclass::SetInput;
+  void SetInput(const InputImageType * input)
+  {
+    this->GetFilter()->SetInput(input);
+  }
+  const InputImageType * GetInput()
+  {
+    return this->GetFilter()->GetInput();
+  }
+
+  /** Set the \c ogr::Layer in which the segments will be written. */
+  void SetOGRLayer( const OGRLayerType & ogrLayer )
+  {
+    this->GetFilter()->SetOGRLayer(ogrLayer);
+  }
+
+  void SetTileSize(unsigned int tileSize)
+  {
+    this->GetFilter()->SetTileSize(tileSize);
+  }
+
+  void SetMargin(unsigned int margin)
+  {
+    this->GetFilter()->SetMargin(margin);
+  }
+
+  void SetThreshold(double threshold)
+  {
+    this->GetFilter()->SetThreshold(threshold);
+  }
+
+  void SetOutputTransform(const TransformType * transform)
+  {
+    this->GetFilter()->SetOutputTransform(transform);
+  }
+
+  itk::SizeValueType GetNumberOfSegments() const
+  {
+    return this->GetFilter()->GetNumberOfSegments();
+  }
+
+  void Initialize()
+  {
+    this->GetFilter()->Initialize();
+  }
+
+protected:
+  /** Constructor */
+  StreamingLineSegmentDetectorToOGRLayerFilter() {}
+  /** Destructor */
+  ~StreamingLineSegmentDetectorToOGRLayerFilter() ITK_OVERRIDE {}
+
+private:
+  StreamingLineSegmentDetectorToOGRLayerFilter(const Self &); //purposely not implemented
+  void operator =(const Self&); //purposely not implemented
+};
+
+} // end namespace otb
+
+#ifndef OTB_MANUAL_INSTANTIATION
+#include "otbStreamingLineSegmentDetectorToOGRLayerFilter.txx"
+#endif
+
+#endif
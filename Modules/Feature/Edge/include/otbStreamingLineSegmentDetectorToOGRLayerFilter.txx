@@ -0,0 +1,622 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef otbStreamingLineSegmentDetectorToOGRLayerFilter_txx
+#define otbStreamingLineSegmentDetectorToOGRLayerFilter_txx
+
+#include "otbStreamingLineSegmentDetectorToOGRLayerFilter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+#include "itkNumericTraits.h"
+#include "itkTimeProbe.h"
+#include "otbMacro.h"
+#include "otbMath.h"
+#include "ogr_geometry.h"
+
+#include <algorithm>
+#include <map>
+
+namespace otb
+{
+
+template <class TInputImage>
+PersistentLineSegmentDetectorToOGRLayerFilter<TInputImage>
+::PersistentLineSegmentDetectorToOGRLayerFilter()
+  : m_TileSize(512), m_Margin(16), m_Threshold(5.2), m_NumberOfSegments(0), m_NumberOfTiles(0)
+{
+  this->SetNumberOfRequiredInputs(1);
+}
+
+template <class TInputImage>
+PersistentLineSegmentDetectorToOGRLayerFilter<TInputImage>
+::~PersistentLineSegmentDetectorToOGRLayerFilter()
+{
+}
+
+template <class TInputImage>
+void
+PersistentLineSegmentDetectorToOGRLayerFilter<TInputImage>
+::Reset()
+{
+  m_NumberOfSegments = 0;
+  m_NumberOfTiles = 0;
+  m_SeamSegments.clear();
+}
+
+template <class TInputImage>
+void
+PersistentLineSegmentDetectorToOGRLayerFilter<TInputImage>
+::Synthetize()
+{
+  // All the tiles have been processed: resolve the remaining segments
+  SegmentListType segments;
+  this->ResolveSeamSegments(itk::NumericTraits<double>::max(), segments);
+  m_SeamSegments.clear();
+
+  if (!segments.empty())
+    {
+    OGRLayerType layer = this->GetOGRLayer();
+    this->WriteSegments(segments, layer);
+    m_NumberOfSegments += segments.size();
+    }
+}
+
+template <class TInputImage>
+void
+PersistentLineSegmentDetectorToOGRLayerFilter<TInputImage>
+::Initialize()
+{
+  // With an output transform, segments are not written in the spatial
+  // reference of the input image
+  if (m_OutputTransform.IsNull())
+    {
+    Superclass::Initialize();
+    }
+}
+
+template <class TInputImage>
+void
+PersistentLineSegmentDetectorToOGRLayerFilter<TInputImage>
+::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  if (this->GetInput())
+    {
+    InputImagePointerType input = const_cast<InputImageType *> (this->GetInput());
+
+    RegionType region = this->GetOutput()->GetRequestedRegion();
+
+    region.PadByRadius(m_Margin);
+    region.Crop(input->GetLargestPossibleRegion());
+
+    input->SetRequestedRegion(region);
+    }
+}
+
+template <class TInputImage>
+typename PersistentLineSegmentDetectorToOGRLayerFilter<TInputImage>::OGRDataSourcePointerType
+PersistentLineSegmentDetectorToOGRLayerFilter<TInputImage>
+::ProcessTile()
+{
+  itk::TimeProbe chrono;
+  chrono.Start();
+
+  const RegionType& largest = this->GetInput()->GetLargestPossibleRegion();
+  const RegionType& piece = this->GetOutput()->GetRequestedRegion();
+
+  // Cut the piece into tiles anchored on the image grid
+  const IndexValueType tileSize = static_cast<IndexValueType>(std::max(1U, m_TileSize));
+  const IndexValueType xBegin = largest.GetIndex()[0]
+    + ((piece.GetIndex()[0] - largest.GetIndex()[0]) / tileSize) * tileSize;
+  const IndexValueType yBegin = largest.GetIndex()[1]
+    + ((piece.GetIndex()[1] - largest.GetIndex()[1]) / tileSize) * tileSize;
+  const IndexValueType xEnd = piece.GetIndex()[0] + static_cast<IndexValueType>(piece.GetSize()[0]);
+  const IndexValueType yEnd = piece.GetIndex()[1] + static_cast<IndexValueType>(piece.GetSize()[1]);
+
+  m_PieceTiles.clear();
+  for (IndexValueType y = yBegin; y < yEnd; y += tileSize)
+    {
+    for (IndexValueType x = xBegin; x < xEnd; x += tileSize)
+      {
+      RegionType tile;
+      tile.SetIndex(0, x);
+      tile.SetIndex(1, y);
+      tile.SetSize(0, tileSize);
+      tile.SetSize(1, tileSize);
+      if (tile.Crop(piece))
+        {
+        m_PieceTiles.push_back(tile);
+        }
+      }
+    }
+
+  m_CoreSegments.assign(m_PieceTiles.size(), SegmentListType());
+  m_BorderSegments.assign(m_PieceTiles.size(), SegmentListType());
+
+  // Detect the segments of the tiles in parallel
+  this->GetMultiThreader()->SetNumberOfThreads(this->GetNumberOfThreads());
+  this->GetMultiThreader()->SetSingleMethod(this->DetectionThreaderCallback, this);
+  this->GetMultiThreader()->SingleMethodExecute();
+
+  OGRDataSourcePointerType tileDS = OGRDataSourceType::New();
+  OGRLayerType tileLayer = tileDS->CreateLayer("layer", ITK_NULLPTR, wkbLineString);
+
+  // Write the segments lying in the core of the tiles, in the order of the
+  // tiles so that the output does not depend on the threads scheduling
+  for (unsigned int tile = 0; tile < m_PieceTiles.size(); ++tile)
+    {
+    this->WriteSegments(m_CoreSegments[tile], tileLayer);
+    m_NumberOfSegments += m_CoreSegments[tile].size();
+    m_SeamSegments.insert(m_SeamSegments.end(), m_BorderSegments[tile].begin(), m_BorderSegments[tile].end());
+    }
+  m_NumberOfTiles += m_PieceTiles.size();
+
+  m_PieceTiles.clear();
+  m_CoreSegments.clear();
+  m_BorderSegments.clear();
+
+  // Next pieces do not see the rows above the current one minus the margin,
+  // so that the segments lying there can not be extended anymore
+  SegmentListType segments;
+  this->ResolveSeamSegments(static_cast<double>(piece.GetIndex()[1]) - m_Margin - 3., segments);
+  this->WriteSegments(segments, tileLayer);
+  m_NumberOfSegments += segments.size();
+
+  chrono.Stop();
+  otbMsgDebugMacro(<< "line segment detection of the piece took " << chrono.GetTotal() << " sec, "
+                   << m_SeamSegments.size() << " segments crossing tile borders are pending");
+
+  return tileDS;
+}
+
+template <class TInputImage>
+ITK_THREAD_RETURN_TYPE
+PersistentLineSegmentDetectorToOGRLayerFilter<TInputImage>
+::DetectionThreaderCallback(void *arg)
+{
+  itk::ThreadIdType threadId = ((itk::MultiThreader::ThreadInfoStruct *) (arg))->ThreadID;
+  itk::ThreadIdType threadCount = ((itk::MultiThreader::ThreadInfoStruct *) (arg))->NumberOfThreads;
+  Self * filter = (Self *) (((itk::MultiThreader::ThreadInfoStruct *) (arg))->UserData);
+
+  filter->DetectSegmentsForThread(threadId, threadCount);
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template <class TInputImage>
+void
+PersistentLineSegmentDetectorToOGRLayerFilter<TInputImage>
+::DetectSegmentsForThread(itk::ThreadIdType threadId, itk::ThreadIdType threadCount)
+{
+  for (unsigned int tile = threadId; tile < m_PieceTiles.size(); tile += threadCount)
+    {
+    this->DetectSegments(tile);
+    }
+}
+
+template <class TInputImage>
+void
+PersistentLineSegmentDetectorToOGRLayerFilter<TInputImage>
+::DetectSegments(unsigned int tile)
+{
+  const InputImageType * input = this->GetInput();
+  const RegionType& largest = input->GetLargestPossibleRegion();
+  const RegionType& core = m_PieceTiles[tile];
+
+  RegionType paddedRegion = core;
+  paddedRegion.PadByRadius(m_Margin);
+  paddedRegion.Crop(largest);
+
+  // The detector needs at least one pixel away from the tile border
+  if (paddedRegion.GetSize()[0] < 3 || paddedRegion.GetSize()[1] < 3)
+    {
+    return;
+    }
+
+  // Copy the padded tile in a standalone image, so that the detector is not
+  // connected to the pipeline
+  RegionType bufferRegion;
+  bufferRegion.SetSize(paddedRegion.GetSize());
+
+  typename InputImageType::PointType tileOrigin;
+  input->TransformIndexToPhysicalPoint(paddedRegion.GetIndex(), tileOrigin);
+
+  InputImagePointerType tileImage = InputImageType::New();
+  tileImage->SetRegions(bufferRegion);
+  tileImage->SetOrigin(tileOrigin);
+  tileImage->SetSpacing(input->GetSpacing());
+  tileImage->Allocate();
+
+  itk::ImageRegionConstIterator<InputImageType> inIt(input, paddedRegion);
+  itk::ImageRegionIterator<InputImageType>      tileIt(tileImage, bufferRegion);
+  for (inIt.GoToBegin(), tileIt.GoToBegin(); !inIt.IsAtEnd(); ++inIt, ++tileIt)
+    {
+    tileIt.Set(inIt.Get());
+    }
+
+  // Segments are validated as in the full image
+  typename LSDType::Pointer lsd = LSDType::New();
+  lsd->SetInput(tileImage);
+  lsd->SetImageSize(largest.GetSize());
+  lsd->SetThreshold(m_Threshold);
+  lsd->NormalizeThresholdOff();
+  lsd->SetNumberOfThreads(1);
+  lsd->Update();
+
+  const double offsetX = static_cast<double>(paddedRegion.GetIndex()[0]);
+  const double offsetY = static_cast<double>(paddedRegion.GetIndex()[1]);
+
+  RegionType localCore = core;
+  localCore.SetIndex(0, core.GetIndex()[0] - paddedRegion.GetIndex()[0]);
+  localCore.SetIndex(1, core.GetIndex()[1] - paddedRegion.GetIndex()[1]);
+
+  const typename LSDType::RectangleListType& rectangles = lsd->GetRectangleList();
+  for (typename LSDType::RectangleListType::const_iterator recIt = rectangles.begin();
+       recIt != rectangles.end(); ++recIt)
+    {
+    const RectangleType& rec = *recIt;
+
+    Segment segment;
+    segment.X1 = rec[0] + offsetX;
+    segment.Y1 = rec[1] + offsetY;
+    segment.X2 = rec[2] + offsetX;
+    segment.Y2 = rec[3] + offsetY;
+    segment.Width = rec[4];
+    segment.Theta = rec[5];
+    segment.Prec = rec[6];
+    segment.NbPoints = 0;
+    segment.NbAligned = 0;
+    segment.Tile = m_NumberOfTiles + tile;
+    segment.Core = core;
+
+    if (IsInside(core, segment.X1, segment.Y1) && IsInside(core, segment.X2, segment.Y2))
+      {
+      m_CoreSegments[tile].push_back(segment);
+      }
+    else
+      {
+      // Only the points of the core are counted, so that the counts of the
+      // parts of a segment detected in several tiles can be summed
+      lsd->CountAlignedPoints(rec, localCore, segment.NbPoints, segment.NbAligned);
+      m_BorderSegments[tile].push_back(segment);
+      }
+    }
+}
+
+template <class TInputImage>
+void
+PersistentLineSegmentDetectorToOGRLayerFilter<TInputImage>
+::ResolveSeamSegments(double rowLimit, SegmentListType& output)
+{
+  const unsigned int nbSegments = m_SeamSegments.size();
+  if (nbSegments == 0)
+    {
+    return;
+    }
+
+  // Register the segments in the cells of a grid covering their bounding box,
+  // so that only neighbouring segments are compared
+  typedef std::pair<long, long>                         CellType;
+  typedef std::map<CellType, std::vector<unsigned int> > CellMapType;
+  const double cellSize = 32.;
+  const double tolerance = 3.;
+
+  CellMapType cells;
+  for (unsigned int i = 0; i < nbSegments; ++i)
+    {
+    const Segment& segment = m_SeamSegments[i];
+    const double radius = 0.5 * segment.Width + tolerance;
+    const long xMin = static_cast<long>(vcl_floor((std::min(segment.X1, segment.X2) - radius) / cellSize));
+    const long xMax = static_cast<long>(vcl_floor((std::max(segment.X1, segment.X2) + radius) / cellSize));
+    const long yMin = static_cast<long>(vcl_floor((std::min(segment.Y1, segment.Y2) - radius) / cellSize));
+    const long yMax = static_cast<long>(vcl_floor((std::max(segment.Y1, segment.Y2) + radius) / cellSize));
+    for (long y = yMin; y <= yMax; ++y)
+      {
+      for (long x = xMin; x <= xMax; ++x)
+        {
+        cells[CellType(x, y)].push_back(i);
+        }
+      }
+    }
+
+  // Group the parts of the same segment
+  std::vector<unsigned int> parents(nbSegments);
+  for (unsigned int i = 0; i < nbSegments; ++i)
+    {
+    parents[i] = i;
+    }
+
+  for (typename CellMapType::const_iterator cellIt = cells.begin(); cellIt != cells.end(); ++cellIt)
+    {
+    const std::vector<unsigned int>& members = cellIt->second;
+    for (unsigned int a = 0; a < members.size(); ++a)
+      {
+      for (unsigned int b = a + 1; b < members.size(); ++b)
+        {
+        const unsigned int rootA = FindRoot(parents, members[a]);
+        const unsigned int rootB = FindRoot(parents, members[b]);
+        if (rootA != rootB && this->AreCollinear(m_SeamSegments[members[a]], m_SeamSegments[members[b]]))
+          {
+          parents[std::max(rootA, rootB)] = std::min(rootA, rootB);
+          }
+        }
+      }
+    }
+
+  // Groups are listed in the order of their first segment
+  std::vector<std::vector<unsigned int> > groups;
+  std::vector<int> groupOfRoot(nbSegments, -1);
+  for (unsigned int i = 0; i < nbSegments; ++i)
+    {
+    const unsigned int root = FindRoot(parents, i);
+    if (groupOfRoot[root] < 0)
+      {
+      groupOfRoot[root] = groups.size();
+      groups.push_back(std::vector<unsigned int>());
+      }
+    groups[groupOfRoot[root]].push_back(i);
+    }
+
+  typename LSDType::Pointer validator = LSDType::New();
+  validator->SetImageSize(this->GetInput()->GetLargestPossibleRegion().GetSize());
+
+  SegmentListType pending;
+  for (unsigned int g = 0; g < groups.size(); ++g)
+    {
+    SegmentListType members;
+    double maxRow = -itk::NumericTraits<double>::max();
+    for (unsigned int m = 0; m < groups[g].size(); ++m)
+      {
+      const Segment& segment = m_SeamSegments[groups[g][m]];
+      members.push_back(segment);
+      maxRow = std::max(maxRow, std::max(segment.Y1, segment.Y2) + 0.5 * segment.Width);
+      }
+
+    // Some parts may still be detected in the next pieces
+    if (maxRow >= rowLimit)
+      {
+      pending.insert(pending.end(), members.begin(), members.end());
+      continue;
+      }
+
+    Segment merged;
+    if (members.size() > 1 && this->MergeSegments(members, validator, merged))
+      {
+      output.push_back(merged);
+      }
+    else
+      {
+      // Each part is written by the tile holding its middle
+      for (typename SegmentListType::const_iterator it = members.begin(); it != members.end(); ++it)
+        {
+        if (IsInCore(*it))
+          {
+          output.push_back(*it);
+          }
+        }
+      }
+    }
+
+  m_SeamSegments.swap(pending);
+}
+
+template <class TInputImage>
+bool
+PersistentLineSegmentDetectorToOGRLayerFilter<TInputImage>
+::AreCollinear(const Segment& a, const Segment& b) const
+{
+  // Maximum gap between the parts of a segment, and lateral tolerance
+  const double gap = 2.;
+  const double lateralTolerance = 0.5 * std::max(a.Width, b.Width) + 1.;
+
+  if (a.Tile == b.Tile)
+    {
+    return false;
+    }
+
+  // Compare the orientations modulo 2 Pi
+  double angle = a.Theta - b.Theta;
+  while (angle <= -CONST_PI)
+    {
+    angle += CONST_2PI;
+    }
+  while (angle > CONST_PI)
+    {
+    angle -= CONST_2PI;
+    }
+  if (vcl_abs(angle) > std::max(a.Prec, b.Prec))
+    {
+    return false;
+    }
+
+  const double length = vcl_sqrt((a.X2 - a.X1) * (a.X2 - a.X1) + (a.Y2 - a.Y1) * (a.Y2 - a.Y1));
+  if (length < 1e-10)
+    {
+    return false;
+    }
+  const double ux = (a.X2 - a.X1) / length;
+  const double uy = (a.Y2 - a.Y1) / length;
+
+  // Ends of b must lie along the central line of a
+  const double lateral1 = -(b.X1 - a.X1) * uy + (b.Y1 - a.Y1) * ux;
+  const double lateral2 = -(b.X2 - a.X1) * uy + (b.Y2 - a.Y1) * ux;
+  if (vcl_abs(lateral1) > lateralTolerance || vcl_abs(lateral2) > lateralTolerance)
+    {
+    return false;
+    }
+
+  // and overlap a, or extend it
+  const double t1 = (b.X1 - a.X1) * ux + (b.Y1 - a.Y1) * uy;
+  const double t2 = (b.X2 - a.X1) * ux + (b.Y2 - a.Y1) * uy;
+
+  return std::min(t1, t2) <= length + gap && std::max(t1, t2) >= -gap;
+}
+
+template <class TInputImage>
+bool
+PersistentLineSegmentDetectorToOGRLayerFilter<TInputImage>
+::MergeSegments(const SegmentListType& segments, const LSDType * validator, Segment& merged) const
+{
+  // The longest part gives the direction of the merged segment
+  unsigned int longest = 0;
+  double       longestLength = -1.;
+  for (unsigned int i = 0; i < segments.size(); ++i)
+    {
+    const double length = vcl_sqrt((segments[i].X2 - segments[i].X1) * (segments[i].X2 - segments[i].X1)
+                                   + (segments[i].Y2 - segments[i].Y1) * (segments[i].Y2 - segments[i].Y1));
+    if (length > longestLength)
+      {
+      longestLength = length;
+      longest = i;
+      }
+    }
+
+  const Segment& reference = segments[longest];
+  if (longestLength < 1e-10)
+    {
+    return false;
+    }
+  const double ux = (reference.X2 - reference.X1) / longestLength;
+  const double uy = (reference.Y2 - reference.Y1) / longestLength;
+
+  // Extent of the parts along the reference direction, and mean lateral
+  // position of their middles weighted by their length
+  double tMin = itk::NumericTraits<double>::max();
+  double tMax = -itk::NumericTraits<double>::max();
+  double sumLateral = 0.;
+  double sumLength = 0.;
+
+  merged = reference;
+  merged.NbPoints = 0;
+  merged.NbAligned = 0;
+
+  for (typename SegmentListType::const_iterator it = segments.begin(); it != segments.end(); ++it)
+    {
+    const double t1 = (it->X1 - reference.X1) * ux + (it->Y1 - reference.Y1) * uy;
+    const double t2 = (it->X2 - reference.X1) * ux + (it->Y2 - reference.Y1) * uy;
+    tMin = std::min(tMin, std::min(t1, t2));
+    tMax = std::max(tMax, std::max(t1, t2));
+
+    const double length = vcl_abs(t2 - t1);
+    const double lateral = -(0.5 * (it->X1 + it->X2) - reference.X1) * uy + (0.5 * (it->Y1 + it->Y2) - reference.Y1) * ux;
+    sumLateral += lateral * length;
+    sumLength += length;
+
+    merged.Width = std::max(merged.Width, it->Width);
+    merged.Prec = std::max(merged.Prec, it->Prec);
+    merged.NbPoints += it->NbPoints;
+    merged.NbAligned += it->NbAligned;
+    }
+
+  const double lateral = (sumLength > 0.) ? sumLateral / sumLength : 0.;
+
+  merged.X1 = reference.X1 + tMin * ux - lateral * uy;
+  merged.Y1 = reference.Y1 + tMin * uy + lateral * ux;
+  merged.X2 = reference.X1 + tMax * ux - lateral * uy;
+  merged.Y2 = reference.Y1 + tMax * uy + lateral * ux;
+
+  // A contrario validation of the whole segment, from the points of the
+  // parts in the core of their tile
+  return validator->ComputeNFA(merged.NbPoints, merged.NbAligned) > 0.;
+}
+
+template <class TInputImage>
+void
+PersistentLineSegmentDetectorToOGRLayerFilter<TInputImage>
+::WriteSegments(const SegmentListType& segments, OGRLayerType& layer) const
+{
+  typedef typename TransformType::InputPointType PointType;
+
+  const typename InputImageType::PointType   origin = this->GetInput()->GetOrigin();
+  const typename InputImageType::SpacingType spacing = this->GetInput()->GetSpacing();
+
+  for (typename SegmentListType::const_iterator it = segments.begin(); it != segments.end(); ++it)
+    {
+    PointType start, end;
+    start[0] = origin[0] + it->X1 * spacing[0];
+    start[1] = origin[1] + it->Y1 * spacing[1];
+    end[0] = origin[0] + it->X2 * spacing[0];
+    end[1] = origin[1] + it->Y2 * spacing[1];
+
+    if (m_OutputTransform.IsNotNull())
+      {
+      start = m_OutputTransform->TransformPoint(start);
+      end = m_OutputTransform->TransformPoint(end);
+      }
+
+    OGRLineString line;
+    line.addPoint(start[0], start[1]);
+    line.addPoint(end[0], end[1]);
+
+    OGRFeatureType feature(layer.GetLayerDefn());
+    feature.SetGeometry(&line);
+    layer.CreateFeature(feature);
+    }
+}
+
+template <class TInputImage>
+bool
+PersistentLineSegmentDetectorToOGRLayerFilter<TInputImage>
+::IsInCore(const Segment& segment)
+{
+  return IsInside(segment.Core, 0.5 * (segment.X1 + segment.X2), 0.5 * (segment.Y1 + segment.Y2));
+}
+
+template <class TInputImage>
+bool
+PersistentLineSegmentDetectorToOGRLayerFilter<TInputImage>
+::IsInside(const RegionType& region, double x, double y)
+{
+  // Pixel centers lie at integer index coordinates
+  return x >= region.GetIndex()[0] - 0.5
+         && x < region.GetIndex()[0] + static_cast<double>(region.GetSize()[0]) - 0.5
+         && y >= region.GetIndex()[1] - 0.5
+         && y < region.GetIndex()[1] + static_cast<double>(region.GetSize()[1]) - 0.5;
+}
+
+template <class TInputImage>
+unsigned int
+PersistentLineSegmentDetectorToOGRLayerFilter<TInputImage>
+::FindRoot(std::vector<unsigned int>& parents, unsigned int i)
+{
+  while (parents[i] != i)
+    {
+    parents[i] = parents[parents[i]];
+    i = parents[i];
+    }
+  return i;
+}
+
+template <class TInputImage>
+void
+PersistentLineSegmentDetectorToOGRLayerFilter<TInputImage>
+::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "TileSize: " << m_TileSize << std::endl;
+  os << indent << "Margin: " << m_Margin << std::endl;
+  os << indent << "Threshold: " << m_Threshold << std::endl;
+  os << indent << "NumberOfSegments: " << m_NumberOfSegments << std::endl;
+}
+
+} // end namespace otb
+#endif
@@ -53,6 +53,8 @@ void RegisterTests()
   REGISTER_TEST(otbVerticalSobelVectorImageFilterTest);
   REGISTER_TEST(otbStreamingLineSegmentDetectorNew);
   REGISTER_TEST(otbStreamingLineSegmentDetector);
+  REGISTER_TEST(otbStreamingLineSegmentDetectorToOGRLayerFilterNew);
+  REGISTER_TEST(otbStreamingLineSegmentDetectorToOGRLayerFilter);
   REGISTER_TEST(otbLineRatioDetectorNew);
   REGISTER_TEST(otbTouziEdgeDetector);
   REGISTER_TEST(otbLineRatioDetectorLinear);
@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbImage.h"
+#include "otbStreamingLineSegmentDetectorToOGRLayerFilter.h"
+
+#include "itkImageRegionIteratorWithIndex.h"
+
+#include <algorithm>
+
+int otbStreamingLineSegmentDetectorToOGRLayerFilterNew(int itkNotUsed(argc), char * itkNotUsed(argv) [])
+{
+  typedef otb::Image<float, 2>                                      ImageType;
+  typedef otb::StreamingLineSegmentDetectorToOGRLayerFilter<ImageType> FilterType;
+
+  FilterType::Pointer filter = FilterType::New();
+
+  std::cout << filter << std::endl;
+
+  return EXIT_SUCCESS;
+}
+
+int otbStreamingLineSegmentDetectorToOGRLayerFilter(int argc, char * argv[])
+{
+  if (argc != 3)
+    {
+    std::cerr << "Usage: " << argv[0];
+    std::cerr << " tileSize numberOfLinesPerStrip" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  typedef otb::Image<float, 2>                                         ImageType;
+  typedef otb::StreamingLineSegmentDetectorToOGRLayerFilter<ImageType> FilterType;
+
+  const unsigned int tileSize = atoi(argv[1]);
+  const unsigned int nbLines = atoi(argv[2]);
+
+  // Smooth step edge along the line y = a.x + b, crossing many tiles
+  const double a = 0.3;
+  const double b = 40.;
+  const double norm = vcl_sqrt(1. + a * a);
+
+  ImageType::SizeType size;
+  size.Fill(300);
+  ImageType::RegionType region;
+  region.SetSize(size);
+
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions(region);
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex<ImageType> it(image, region);
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+    const double dist = (a * it.GetIndex()[0] + b - it.GetIndex()[1]) / norm;
+    it.Set(255. / (1. + vcl_exp(-dist / 1.5)));
+    }
+
+  otb::ogr::DataSource::Pointer ogrDS = otb::ogr::DataSource::New();
+  otb::ogr::Layer layer = ogrDS->CreateLayer("layer", ITK_NULLPTR, wkbLineString);
+
+  FilterType::Pointer lsd = FilterType::New();
+  lsd->SetInput(image);
+  lsd->SetOGRLayer(layer);
+  lsd->SetTileSize(tileSize);
+  lsd->GetStreamer()->SetNumberOfLinesStrippedStreaming(nbLines);
+  lsd->Initialize();
+  lsd->Update();
+
+  std::cout << lsd->GetNumberOfSegments() << " segments written" << std::endl;
+
+  // Segments must lie on the edge, and the edge must have been detected as
+  // one segment across tiles
+  const double expectedLength = (size[0] - 1) * norm;
+  double maxLength = 0.;
+
+  for (otb::ogr::Layer::const_iterator featIt = layer.begin(); featIt != layer.end(); ++featIt)
+    {
+    OGRLineString const* line = dynamic_cast<OGRLineString const*>(featIt->GetGeometry());
+    if (line == ITK_NULLPTR || line->getNumPoints() != 2)
+      {
+      std::cerr << "Feature " << featIt->GetFID() << " is not a segment" << std::endl;
+      return EXIT_FAILURE;
+      }
+    for (int i = 0; i < 2; ++i)
+      {
+      const double dist = (a * line->getX(i) + b - line->getY(i)) / norm;
+      if (vcl_abs(dist) > 3.)
+        {
+        std::cerr << "Feature " << featIt->GetFID() << " is " << dist << " pixels away from the edge" << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    maxLength = std::max(maxLength, line->get_Length());
+    }
+
+  if (maxLength < 0.9 * expectedLength)
+    {
+    std::cerr << "Longest segment is " << maxLength << " pixels long while the edge is "
+              << expectedLength << " pixels long" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
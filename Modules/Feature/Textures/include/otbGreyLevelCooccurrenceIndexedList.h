@@ -121,7 +121,7 @@ public:
   VectorType GetVector();
 
   /** Initialize the lowerbound and upper bound vecotor, Fill m_LookupArray with
-    * -1 and set m_TotalFrequency to zero */
+    * -1, clear m_Vector and set m_TotalFrequency to zero */
   void Initialize(const unsigned int nbins, const PixelValueType min,
                   const PixelValueType max, const bool symmetry = true);
 
@@ -129,6 +129,15 @@ public:
   //m_InputImageMaximum. If so add to m_Vector via AddPairToVector method */
   void AddPixelPair(const PixelValueType& pixelvalue1, const PixelValueType& pixelvalue2);
 
+  /** Remove a pixel pair previously added with AddPixelPair. This allows one
+    * to update the list of a sliding window instead of building it again. */
+  void RemovePixelPair(const PixelValueType& pixelvalue1, const PixelValueType& pixelvalue2);
+
+  /** Sort m_Vector by increasing index of the co-occurrence pairs and update
+    * m_LookupArray. Pairs are then visited in the same order whatever the
+    * order in which they were added or removed. */
+  void SortVector();
+
   /* Get the frequency value from Vector with index =[j,i] */
   RelativeFrequencyType GetFrequency(IndexValueType i, IndexValueType j);
 
@@ -146,6 +155,15 @@ protected:
     * co-occurrence pair is added again with index values swapped */
   void AddPairToVector(IndexType index);
 
+  /** decrement the frequency of the cooccurrence pair with given index. A pair
+    * whose frequency drops to zero is replaced by the last pair of m_Vector, so
+    * that m_Vector only holds non-zero pairs. If m_Symmetry is true the
+    * co-occurrence pair is removed again with index values swapped */
+  void RemovePairFromVector(IndexType index);
+
+  /** Order of the co-occurrence pairs used by SortVector() */
+  static bool IsPairBefore(const CooccurrencePairType & pair1, const CooccurrencePairType & pair2);
+
   void SetBinMin(const unsigned int dimension, const InstanceIdentifier nbin,
                  PixelValueType min);
 
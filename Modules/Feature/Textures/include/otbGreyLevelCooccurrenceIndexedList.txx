@@ -23,6 +23,7 @@
 #define otbGreyLevelCooccurrenceIndexedList_txx
 
 #include "otbGreyLevelCooccurrenceIndexedList.h"
+#include <algorithm>
 
 namespace otb
 {
@@ -57,6 +58,7 @@ Initialize(const unsigned int nbins, const PixelValueType min,
   m_Symmetry = symmetry;
   m_LookupArray = LookupArrayType(m_Size[0] * m_Size[1]);
   m_LookupArray.Fill(-1);
+  m_Vector.clear();
   m_TotalFrequency = 0;
 
   // adjust the sizes of min max value containers
@@ -246,6 +248,37 @@ AddPixelPair(const PixelValueType& pixelvalue1, const PixelValueType& pixelvalue
     }
 }
 
+template <class TPixel >
+void
+GreyLevelCooccurrenceIndexedList<TPixel>::
+RemovePixelPair(const PixelValueType& pixelvalue1, const PixelValueType& pixelvalue2)
+{
+  // Pairs out of bounds have not been added
+  if ( pixelvalue1 < m_InputImageMinimum
+       || pixelvalue1 > m_InputImageMaximum
+       || pixelvalue2 < m_InputImageMinimum
+       || pixelvalue2 > m_InputImageMaximum )
+    {
+    return;
+    }
+
+  IndexType index;
+  PixelPairType ppair( PixelPairSize);
+  ppair[0] = pixelvalue1;
+  ppair[1] = pixelvalue2;
+
+  this->GetIndex(ppair, index);
+  this->RemovePairFromVector(index);
+  if(m_Symmetry)
+    {
+    IndexValueType temp;
+    temp = index[0];
+    index[0] = index[1];
+    index[1] = temp;
+    this->RemovePairFromVector(index);
+    }
+}
+
 template <class TPixel>
 typename GreyLevelCooccurrenceIndexedList<TPixel>::RelativeFrequencyType
 GreyLevelCooccurrenceIndexedList<TPixel>::
@@ -309,6 +342,53 @@ GreyLevelCooccurrenceIndexedList<TPixel>
   m_TotalFrequency = m_TotalFrequency + 1;
 }
 
+template <class TPixel>
+void
+GreyLevelCooccurrenceIndexedList<TPixel>
+::RemovePairFromVector(IndexType index)
+{
+  InstanceIdentifier instanceId = 0;
+  instanceId = index[1] * m_Size[0] + index[0];
+  int vindex = m_LookupArray[instanceId];
+  if( vindex < 0)
+    {
+    return;
+    }
+
+  if( --m_Vector[vindex].second == 0)
+    {
+    // Move the last pair in place of the removed one
+    const CooccurrencePairType & last = m_Vector.back();
+    m_LookupArray[last.first[1] * m_Size[0] + last.first[0]] = vindex;
+    m_Vector[vindex] = last;
+    m_Vector.pop_back();
+    m_LookupArray[instanceId] = -1;
+    }
+  m_TotalFrequency = m_TotalFrequency - 1;
+}
+
+template <class TPixel>
+bool
+GreyLevelCooccurrenceIndexedList<TPixel>
+::IsPairBefore(const CooccurrencePairType & pair1, const CooccurrencePairType & pair2)
+{
+  return pair1.first[1] < pair2.first[1]
+    || (pair1.first[1] == pair2.first[1] && pair1.first[0] < pair2.first[0]);
+}
+
+template <class TPixel>
+void
+GreyLevelCooccurrenceIndexedList<TPixel>
+::SortVector()
+{
+  std::sort(m_Vector.begin(), m_Vector.end(), IsPairBefore);
+  for (unsigned int vindex = 0; vindex < m_Vector.size(); ++vindex)
+    {
+    const IndexType & index = m_Vector[vindex].first;
+    m_LookupArray[index[1] * m_Size[0] + index[0]] = vindex;
+    }
+}
+
 template <class TPixel>
 void
 GreyLevelCooccurrenceIndexedList<TPixel>
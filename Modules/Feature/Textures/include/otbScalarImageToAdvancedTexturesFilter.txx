@@ -23,7 +23,7 @@
 
 #include "otbScalarImageToAdvancedTexturesFilter.h"
 #include "itkImageRegionIteratorWithIndex.h"
-#include "itkConstNeighborhoodIterator.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
 #include "itkImageRegionIterator.h"
 #include "itkProgressReporter.h"
 #include "itkNumericTraits.h"
@@ -36,12 +36,12 @@ ScalarImageToAdvancedTexturesFilter<TInputImage, TOutputImage>
 ::ScalarImageToAdvancedTexturesFilter()
 : m_Radius()
 , m_Offset()
-, m_NeighborhoodRadius()
 , m_NumberOfBinsPerAxis(8)
 , m_InputImageMinimum(0)
 , m_InputImageMaximum(255)
 , m_SubsampleFactor()
 , m_SubsampleOffset()
+, m_IncrementalUpdate(false)
 {
   // There are 10 outputs corresponding to the 9 textures indices
   this->SetNumberOfRequiredOutputs(10);
@@ -298,18 +298,34 @@ ScalarImageToAdvancedTexturesFilter<TInputImage, TOutputImage>
 template <class TInputImage, class TOutputImage>
 void
 ScalarImageToAdvancedTexturesFilter<TInputImage, TOutputImage>
-::BeforeThreadedGenerateData()
+::UpdateCooccurrenceList(CooccurrenceIndexedListType * list, const InputRegionType& region, bool remove) const
 {
-  unsigned int minRadius = 0;
-  for ( unsigned int i = 0; i < m_Offset.GetOffsetDimension(); i++ )
+  if (region.GetNumberOfPixels() == 0)
     {
-    unsigned int distance = vcl_abs(m_Offset[i]);
-    if ( distance > minRadius )
+    return;
+    }
+
+  const InputImageType * inputPtr = this->GetInput();
+  const InputRegionType& bufferedRegion = inputPtr->GetBufferedRegion();
+
+  itk::ImageRegionConstIteratorWithIndex<InputImageType> it(inputPtr, region);
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+    const typename InputImageType::IndexType neighborIndex = it.GetIndex() + m_Offset;
+    if (!bufferedRegion.IsInside(neighborIndex))
+      {
+      continue; // don't put a pixel in the co-occurrence list if the value is
+                // out of bounds
+      }
+    if (remove)
+      {
+      list->RemovePixelPair(it.Get(), inputPtr->GetPixel(neighborIndex));
+      }
+    else
       {
-      minRadius = distance;
+      list->AddPixelPair(it.Get(), inputPtr->GetPixel(neighborIndex));
       }
     }
-  m_NeighborhoodRadius.Fill(minRadius);
 }
 
 template <class TInputImage, class TOutputImage>
@@ -363,6 +379,11 @@ ScalarImageToAdvancedTexturesFilter<TInputImage, TOutputImage>
   // Set-up progress reporting
   itk::ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels());
 
+  // Co-occurrence list of the sliding window
+  CooccurrenceIndexedListPointerType GLCIList = CooccurrenceIndexedListType::New();
+  InputRegionType previousInputRegion;
+  bool hasPreviousWindow = false;
+
   // Iterate on outputs to compute textures
   while (!varianceIt.IsAtEnd()
          && !meanIt.IsAtEnd()
@@ -398,24 +419,43 @@ ScalarImageToAdvancedTexturesFilter<TInputImage, TOutputImage>
     inputRegion.SetSize(inputSize);
     inputRegion.Crop(inputPtr->GetRequestedRegion());
 
-    CooccurrenceIndexedListPointerType GLCIList = CooccurrenceIndexedListType::New();
-    GLCIList->Initialize(m_NumberOfBinsPerAxis, m_InputImageMinimum, m_InputImageMaximum);
+    // In incremental mode, when the window moves along a row, only the pairs of
+    // the columns leaving and entering the window are updated. Otherwise the
+    // list is built again, in the raster order of the window.
+    const typename InputRegionType::IndexValueType windowEnd = inputRegion.GetIndex(0) + inputRegion.GetSize(0);
+    const typename InputRegionType::IndexValueType previousWindowEnd =
+      previousInputRegion.GetIndex(0) + previousInputRegion.GetSize(0);
+    if (m_IncrementalUpdate
+        && hasPreviousWindow
+        && inputRegion.GetIndex(1) == previousInputRegion.GetIndex(1)
+        && inputRegion.GetSize(1) == previousInputRegion.GetSize(1)
+        && inputRegion.GetIndex(0) >= previousInputRegion.GetIndex(0)
+        && inputRegion.GetIndex(0) < previousWindowEnd
+        && windowEnd >= previousWindowEnd)
+      {
+      InputRegionType leavingRegion = previousInputRegion;
+      leavingRegion.SetSize(0, inputRegion.GetIndex(0) - previousInputRegion.GetIndex(0));
+      this->UpdateCooccurrenceList(GLCIList, leavingRegion, true);
+
+      InputRegionType enteringRegion = inputRegion;
+      enteringRegion.SetIndex(0, previousWindowEnd);
+      enteringRegion.SetSize(0, windowEnd - previousWindowEnd);
+      this->UpdateCooccurrenceList(GLCIList, enteringRegion, false);
+      }
+    else
+      {
+      GLCIList->Initialize(m_NumberOfBinsPerAxis, m_InputImageMinimum, m_InputImageMaximum);
+      this->UpdateCooccurrenceList(GLCIList, inputRegion, false);
+      }
+    previousInputRegion = inputRegion;
+    hasPreviousWindow = true;
 
-    typedef itk::ConstNeighborhoodIterator< InputImageType > NeighborhoodIteratorType;
-    NeighborhoodIteratorType neighborIt;
-    neighborIt = NeighborhoodIteratorType(m_NeighborhoodRadius, inputPtr, inputRegion);
-    for ( neighborIt.GoToBegin(); !neighborIt.IsAtEnd(); ++neighborIt )
-    {
-    const InputPixelType centerPixelIntensity = neighborIt.GetCenterPixel();
-    bool pixelInBounds;
-    const InputPixelType pixelIntensity =  neighborIt.GetPixel(m_Offset, pixelInBounds);
-    if ( !pixelInBounds )
+    // The order of the pairs then depends on the updates: sort them so that
+    // the textures do not depend on where rows or thread regions start
+    if (m_IncrementalUpdate)
       {
-      continue; // don't put a pixel in the co-occurrence list if the value is
-               // out of bounds
+      GLCIList->SortVector();
       }
-    GLCIList->AddPixelPair(centerPixelIntensity, pixelIntensity);
-    }
 
     PixelValueType m_Mean                    = itk::NumericTraits< PixelValueType >::Zero;
     PixelValueType m_Variance                = itk::NumericTraits< PixelValueType >::Zero;
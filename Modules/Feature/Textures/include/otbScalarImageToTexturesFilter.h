@@ -90,6 +90,14 @@ namespace otb
  * Neighborhood size can be set using the SetRadius() method. Offset for co-occurence estimation
  * is set using the SetOffset() method.
  *
+ * By default, the co-occurrence list of each window is built from scratch.
+ * With IncrementalUpdateOn(), along a row of the output, the list of a window
+ * is updated from the one of the previous window: the pairs of the columns
+ * leaving the window are removed and the pairs of the columns entering it are
+ * added. Pairs are then sorted by bin before the textures are computed, so
+ * that they do not depend on the order of the updates. Textures may differ
+ * from the default mode at float rounding level.
+ *
  * \sa otb::GreyLevelCooccurrenceIndexedList
  * \sa otb::ScalarImageToAdvancedTexturesFiler
  * \sa otb::ScalarImageToHigherOrderTexturesFilter
@@ -181,6 +189,12 @@ public:
   /** Get the sub-sampling offset */
   itkGetMacro(SubsampleOffset, OffsetType);
 
+  /** Set/Get whether the co-occurrence lists are updated incrementally along
+   * rows (off by default) */
+  itkSetMacro(IncrementalUpdate, bool);
+  itkGetMacro(IncrementalUpdate, bool);
+  itkBooleanMacro(IncrementalUpdate);
+
   /** Get the energy output image */
   OutputImageType * GetEnergyOutput();
 
@@ -205,6 +219,10 @@ public:
   /** Get the Haralick correlation output image */
   OutputImageType * GetHaralickCorrelationOutput();
 
+  /** Compute the 8 textures of a co-occurrence list with the given number of
+   * bins per axis. Textures are written in the order of the outputs. */
+  static void ComputeTextures(CooccurrenceIndexedListType * list, unsigned int nbBins, PixelValueType * textures);
+
 protected:
   /** Constructor */
   ScalarImageToTexturesFilter();
@@ -214,8 +232,6 @@ protected:
   void GenerateOutputInformation() ITK_OVERRIDE;
   /** Generate the input requested region */
   void GenerateInputRequestedRegion() ITK_OVERRIDE;
-  /** Before Parallel textures extraction */
-  void BeforeThreadedGenerateData() ITK_OVERRIDE;
   /** Parallel textures extraction */
   void ThreadedGenerateData(const OutputRegionType& outputRegion, itk::ThreadIdType threadId) ITK_OVERRIDE;
 
@@ -226,15 +242,16 @@ private:
   /** Convenient method to compute union of 2 regions */
   static OutputRegionType RegionUnion(const OutputRegionType& region1, const OutputRegionType& region2);
 
+  /** Add (or remove) to the co-occurrence list the pairs whose first pixel
+   * lies in the given input region */
+  void UpdateCooccurrenceList(CooccurrenceIndexedListType * list, const InputRegionType& region, bool remove) const;
+
   /** Radius of the window on which to compute textures */
   SizeType m_Radius;
 
   /** Offset for co-occurence */
   OffsetType m_Offset;
 
-  /** Radius of the neighborhood iterator which is minimum of m_Radius */
-  SizeType m_NeighborhoodRadius;
-
   /** Number of bins per axis */
   unsigned int m_NumberOfBinsPerAxis;
 
@@ -245,13 +262,16 @@ private:
   InputPixelType m_InputImageMaximum;
 
   //TODO: should we use constexpr? only c++11 and problem for msvc
-  inline double GetPixelValueTolerance() const {return 0.0001; }
+  static inline double GetPixelValueTolerance() {return 0.0001; }
 
   /** Sub-sampling factor */
   SizeType m_SubsampleFactor;
 
   /** Sub-sampling offset */
   OffsetType m_SubsampleOffset;
+
+  /** Update the co-occurrence lists along rows instead of building them again */
+  bool m_IncrementalUpdate;
 };
 } // End namespace otb
 
@@ -24,7 +24,7 @@
 
 #include "otbScalarImageToTexturesFilter.h"
 #include "itkImageRegionIteratorWithIndex.h"
-#include "itkConstNeighborhoodIterator.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
 #include "itkImageRegionIterator.h"
 #include "itkProgressReporter.h"
 #include "itkNumericTraits.h"
@@ -38,12 +38,12 @@ ScalarImageToTexturesFilter<TInputImage, TOutputImage>
 ::ScalarImageToTexturesFilter()
 : m_Radius()
 , m_Offset()
-, m_NeighborhoodRadius()
 , m_NumberOfBinsPerAxis(8)
 , m_InputImageMinimum(0)
 , m_InputImageMaximum(255)
 , m_SubsampleFactor()
 , m_SubsampleOffset()
+, m_IncrementalUpdate(false)
 {
   // There are 8 outputs corresponding to the 8 textures indices
   this->SetNumberOfRequiredOutputs(8);
@@ -273,18 +273,149 @@ ScalarImageToTexturesFilter<TInputImage, TOutputImage>
 template <class TInputImage, class TOutputImage>
 void
 ScalarImageToTexturesFilter<TInputImage, TOutputImage>
-::BeforeThreadedGenerateData()
+::UpdateCooccurrenceList(CooccurrenceIndexedListType * list, const InputRegionType& region, bool remove) const
 {
-  unsigned int minRadius = 0;
-  for ( unsigned int i = 0; i < m_Offset.GetOffsetDimension(); i++ )
+  if (region.GetNumberOfPixels() == 0)
     {
-    unsigned int distance = vcl_abs(m_Offset[i]);
-    if ( distance > minRadius )
+    return;
+    }
+
+  const InputImageType * inputPtr = this->GetInput();
+  const InputRegionType& bufferedRegion = inputPtr->GetBufferedRegion();
+
+  itk::ImageRegionConstIteratorWithIndex<InputImageType> it(inputPtr, region);
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+    const typename InputImageType::IndexType neighborIndex = it.GetIndex() + m_Offset;
+    if (!bufferedRegion.IsInside(neighborIndex))
+      {
+      continue; // don't put a pixel in the co-occurrence list if the value is
+                // out of bounds
+      }
+    if (remove)
       {
-      minRadius = distance;
+      list->RemovePixelPair(it.Get(), inputPtr->GetPixel(neighborIndex));
       }
+    else
+      {
+      list->AddPixelPair(it.Get(), inputPtr->GetPixel(neighborIndex));
+      }
+    }
+}
+
+template <class TInputImage, class TOutputImage>
+void
+ScalarImageToTexturesFilter<TInputImage, TOutputImage>
+::ComputeTextures(CooccurrenceIndexedListType * list, unsigned int nbBins, PixelValueType * textures)
+{
+  const double log2 = vcl_log(2.0);
+
+  double pixelMean = 0.;
+  double marginalMean;
+  double marginalDevSquared = 0.;
+  double pixelVariance = 0.;
+
+  //Create and Initialize marginalSums
+  std::vector<double> marginalSums(nbBins, 0);
+
+  //get co-occurrence vector and totalfrequency
+  VectorType glcVector = list->GetVector();
+  double totalFrequency = static_cast<double> (list->GetTotalFrequency());
+
+  //Normalize the co-occurrence indexed list and compute mean, marginalSum
+  typename VectorType::iterator it = glcVector.begin();
+  while( it != glcVector.end())
+    {
+    double frequency = (*it).second / totalFrequency;
+    CooccurrenceIndexType index = (*it).first;
+    pixelMean += index[0] * frequency;
+    marginalSums[index[0]] += frequency;
+    ++it;
+    }
+
+  /* Now get the mean and deviaton of the marginal sums.
+     Compute incremental mean and SD, a la Knuth, "The  Art of Computer
+     Programming, Volume 2: Seminumerical Algorithms",  section 4.2.2.
+     Compute mean and standard deviation using the recurrence relation:
+     M(1) = x(1), M(k) = M(k-1) + (x(k) - M(k-1) ) / k
+     S(1) = 0, S(k) = S(k-1) + (x(k) - M(k-1)) * (x(k) - M(k))
+     for 2 <= k <= n, then
+     sigma = vcl_sqrt(S(n) / n) (or divide by n-1 for sample SD instead of
+     population SD).
+   */
+  std::vector<double>::const_iterator msIt = marginalSums.begin();
+  marginalMean = *msIt;
+  //Increment iterator to start with index 1
+  ++msIt;
+  for(int k= 2; msIt != marginalSums.end(); ++k, ++msIt)
+    {
+    double M_k_minus_1 = marginalMean;
+    double S_k_minus_1 = marginalDevSquared;
+    double x_k = *msIt;
+    double M_k = M_k_minus_1 + ( x_k - M_k_minus_1 ) / k;
+    double S_k = S_k_minus_1 + ( x_k - M_k_minus_1 ) * ( x_k - M_k );
+    marginalMean = M_k;
+    marginalDevSquared = S_k;
+    }
+  marginalDevSquared = marginalDevSquared / nbBins;
+
+  VectorConstIteratorType constVectorIt;
+  constVectorIt = glcVector.begin();
+  while( constVectorIt != glcVector.end())
+  {
+  RelativeFrequencyType frequency = (*constVectorIt).second / totalFrequency;
+  CooccurrenceIndexType        index = (*constVectorIt).first;
+  pixelVariance += ( index[0] - pixelMean ) * ( index[0] - pixelMean ) * frequency;
+  ++constVectorIt;
+  }
+
+  double pixelVarianceSquared = pixelVariance * pixelVariance;
+  // Variance is only used in correlation. If variance is 0, then (index[0] - pixelMean) * (index[1] - pixelMean)
+  // should be zero as well. In this case, set the variance to 1. in order to
+  // avoid NaN correlation.
+  if(pixelVarianceSquared < GetPixelValueTolerance())
+    {
+    pixelVarianceSquared = 1.;
     }
-  m_NeighborhoodRadius.Fill(minRadius);
+
+  //Initialize texture variables;
+  PixelValueType energy      = itk::NumericTraits< PixelValueType >::Zero;
+  PixelValueType entropy     = itk::NumericTraits< PixelValueType >::Zero;
+  PixelValueType correlation = itk::NumericTraits< PixelValueType >::Zero;
+  PixelValueType inverseDifferenceMoment      = itk::NumericTraits< PixelValueType >::Zero;
+  PixelValueType inertia             = itk::NumericTraits< PixelValueType >::Zero;
+  PixelValueType clusterShade        = itk::NumericTraits< PixelValueType >::Zero;
+  PixelValueType clusterProminence   = itk::NumericTraits< PixelValueType >::Zero;
+  PixelValueType haralickCorrelation = itk::NumericTraits< PixelValueType >::Zero;
+
+  //Compute textures
+  constVectorIt = glcVector.begin();
+  while( constVectorIt != glcVector.end())
+    {
+    CooccurrenceIndexType index = (*constVectorIt).first;
+    RelativeFrequencyType frequency = (*constVectorIt).second / totalFrequency;
+    energy += frequency * frequency;
+    entropy -= ( frequency > GetPixelValueTolerance() ) ? frequency *vcl_log(frequency) / log2 : 0;
+    correlation += ( ( index[0] - pixelMean ) * ( index[1] - pixelMean ) * frequency ) / pixelVarianceSquared;
+    inverseDifferenceMoment += frequency / ( 1.0 + ( index[0] - index[1] ) * ( index[0] - index[1] ) );
+    inertia += ( index[0] - index[1] ) * ( index[0] - index[1] ) * frequency;
+    clusterShade += vcl_pow( ( index[0] - pixelMean ) + ( index[1] - pixelMean ), 3 ) * frequency;
+    clusterProminence += vcl_pow( ( index[0] - pixelMean ) + ( index[1] - pixelMean ), 4 ) * frequency;
+    haralickCorrelation += index[0] * index[1] * frequency;
+    ++constVectorIt;
+    }
+
+  haralickCorrelation = (fabs(marginalDevSquared) > 1E-8) ?
+    ( haralickCorrelation - marginalMean * marginalMean )  / marginalDevSquared : 0;
+
+  textures[0] = energy;
+  textures[1] = entropy;
+  textures[2] = correlation;
+  textures[3] = inverseDifferenceMoment;
+  textures[4] = inertia;
+  textures[5] = clusterShade;
+  textures[6] = clusterProminence;
+  textures[7] = haralickCorrelation;
 }
 
 template <class TInputImage, class TOutputImage>
@@ -323,13 +454,16 @@ ScalarImageToTexturesFilter<TInputImage, TOutputImage>
   clusterProminenceIt.GoToBegin();
   haralickCorIt.GoToBegin();
 
-  const double log2 = vcl_log(2.0);
-
   InputRegionType inputLargest = inputPtr->GetLargestPossibleRegion();
 
   // Set-up progress reporting
   itk::ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels());
 
+  // Co-occurrence list of the sliding window
+  CooccurrenceIndexedListPointerType GLCIList = CooccurrenceIndexedListType::New();
+  InputRegionType previousInputRegion;
+  bool hasPreviousWindow = false;
+
   // Iterate on outputs to compute textures
   while (!energyIt.IsAtEnd()
          && !entropyIt.IsAtEnd()
@@ -362,132 +496,57 @@ ScalarImageToTexturesFilter<TInputImage, TOutputImage>
     inputRegion.SetSize(inputSize);
     inputRegion.Crop(inputPtr->GetRequestedRegion());
 
-    CooccurrenceIndexedListPointerType GLCIList = CooccurrenceIndexedListType::New();
-    GLCIList->Initialize(m_NumberOfBinsPerAxis, m_InputImageMinimum, m_InputImageMaximum);
-
-    typedef itk::ConstNeighborhoodIterator< InputImageType > NeighborhoodIteratorType;
-    NeighborhoodIteratorType neighborIt;
-    neighborIt = NeighborhoodIteratorType(m_NeighborhoodRadius, inputPtr, inputRegion);
-    for ( neighborIt.GoToBegin(); !neighborIt.IsAtEnd(); ++neighborIt )
-      {
-      const InputPixelType centerPixelIntensity = neighborIt.GetCenterPixel();
-      bool pixelInBounds;
-      const InputPixelType pixelIntensity =  neighborIt.GetPixel(m_Offset, pixelInBounds);
-      if ( !pixelInBounds )
-        {
-        continue; // don't put a pixel in the co-occurrence list if the value is
-                  // out of bounds
-        }
-      GLCIList->AddPixelPair(centerPixelIntensity, pixelIntensity);
-      }
-
-    double pixelMean = 0.;
-    double marginalMean;
-    double marginalDevSquared = 0.;
-    double pixelVariance = 0.;
-
-    //Create and Initialize marginalSums
-    std::vector<double> marginalSums(m_NumberOfBinsPerAxis, 0);
-
-    //get co-occurrence vector and totalfrequency
-    VectorType glcVector = GLCIList->GetVector();
-    double totalFrequency = static_cast<double> (GLCIList->GetTotalFrequency());
-
-    //Normalize the co-occurrence indexed list and compute mean, marginalSum
-    typename VectorType::iterator it = glcVector.begin();
-    while( it != glcVector.end())
-      {
-      double frequency = (*it).second / totalFrequency;
-      CooccurrenceIndexType index = (*it).first;
-      pixelMean += index[0] * frequency;
-      marginalSums[index[0]] += frequency;
-      ++it;
-      }
-
-    /* Now get the mean and deviaton of the marginal sums.
-       Compute incremental mean and SD, a la Knuth, "The  Art of Computer
-       Programming, Volume 2: Seminumerical Algorithms",  section 4.2.2.
-       Compute mean and standard deviation using the recurrence relation:
-       M(1) = x(1), M(k) = M(k-1) + (x(k) - M(k-1) ) / k
-       S(1) = 0, S(k) = S(k-1) + (x(k) - M(k-1)) * (x(k) - M(k))
-       for 2 <= k <= n, then
-       sigma = vcl_sqrt(S(n) / n) (or divide by n-1 for sample SD instead of
-       population SD).
-     */
-    std::vector<double>::const_iterator msIt = marginalSums.begin();
-    marginalMean = *msIt;
-    //Increment iterator to start with index 1
-    ++msIt;
-    for(int k= 2; msIt != marginalSums.end(); ++k, ++msIt)
+    // In incremental mode, when the window moves along a row, only the pairs of
+    // the columns leaving and entering the window are updated. Otherwise the
+    // list is built again, in the raster order of the window.
+    const typename InputRegionType::IndexValueType windowEnd = inputRegion.GetIndex(0) + inputRegion.GetSize(0);
+    const typename InputRegionType::IndexValueType previousWindowEnd =
+      previousInputRegion.GetIndex(0) + previousInputRegion.GetSize(0);
+    if (m_IncrementalUpdate
+        && hasPreviousWindow
+        && inputRegion.GetIndex(1) == previousInputRegion.GetIndex(1)
+        && inputRegion.GetSize(1) == previousInputRegion.GetSize(1)
+        && inputRegion.GetIndex(0) >= previousInputRegion.GetIndex(0)
+        && inputRegion.GetIndex(0) < previousWindowEnd
+        && windowEnd >= previousWindowEnd)
       {
-      double M_k_minus_1 = marginalMean;
-      double S_k_minus_1 = marginalDevSquared;
-      double x_k = *msIt;
-      double M_k = M_k_minus_1 + ( x_k - M_k_minus_1 ) / k;
-      double S_k = S_k_minus_1 + ( x_k - M_k_minus_1 ) * ( x_k - M_k );
-      marginalMean = M_k;
-      marginalDevSquared = S_k;
+      InputRegionType leavingRegion = previousInputRegion;
+      leavingRegion.SetSize(0, inputRegion.GetIndex(0) - previousInputRegion.GetIndex(0));
+      this->UpdateCooccurrenceList(GLCIList, leavingRegion, true);
+
+      InputRegionType enteringRegion = inputRegion;
+      enteringRegion.SetIndex(0, previousWindowEnd);
+      enteringRegion.SetSize(0, windowEnd - previousWindowEnd);
+      this->UpdateCooccurrenceList(GLCIList, enteringRegion, false);
       }
-    marginalDevSquared = marginalDevSquared / m_NumberOfBinsPerAxis;
-
-    VectorConstIteratorType constVectorIt;
-    constVectorIt = glcVector.begin();
-    while( constVectorIt != glcVector.end())
-    {
-    RelativeFrequencyType frequency = (*constVectorIt).second / totalFrequency;
-    CooccurrenceIndexType        index = (*constVectorIt).first;
-    pixelVariance += ( index[0] - pixelMean ) * ( index[0] - pixelMean ) * frequency;
-    ++constVectorIt;
-    }
-
-    double pixelVarianceSquared = pixelVariance * pixelVariance;
-    // Variance is only used in correlation. If variance is 0, then (index[0] - pixelMean) * (index[1] - pixelMean)
-    // should be zero as well. In this case, set the variance to 1. in order to
-    // avoid NaN correlation.
-    if(pixelVarianceSquared < GetPixelValueTolerance())
+    else
       {
-      pixelVarianceSquared = 1.;
+      GLCIList->Initialize(m_NumberOfBinsPerAxis, m_InputImageMinimum, m_InputImageMaximum);
+      this->UpdateCooccurrenceList(GLCIList, inputRegion, false);
       }
+    previousInputRegion = inputRegion;
+    hasPreviousWindow = true;
 
-    //Initialize texture variables;
-    PixelValueType energy      = itk::NumericTraits< PixelValueType >::Zero;
-    PixelValueType entropy     = itk::NumericTraits< PixelValueType >::Zero;
-    PixelValueType correlation = itk::NumericTraits< PixelValueType >::Zero;
-    PixelValueType inverseDifferenceMoment      = itk::NumericTraits< PixelValueType >::Zero;
-    PixelValueType inertia             = itk::NumericTraits< PixelValueType >::Zero;
-    PixelValueType clusterShade        = itk::NumericTraits< PixelValueType >::Zero;
-    PixelValueType clusterProminence   = itk::NumericTraits< PixelValueType >::Zero;
-    PixelValueType haralickCorrelation = itk::NumericTraits< PixelValueType >::Zero;
-
-    //Compute textures
-    constVectorIt = glcVector.begin();
-    while( constVectorIt != glcVector.end())
+    // The order of the pairs then depends on the updates: sort them so that
+    // the textures do not depend on where rows or thread regions start
+    if (m_IncrementalUpdate)
       {
-      CooccurrenceIndexType index = (*constVectorIt).first;
-      RelativeFrequencyType frequency = (*constVectorIt).second / totalFrequency;
-      energy += frequency * frequency;
-      entropy -= ( frequency > GetPixelValueTolerance() ) ? frequency *vcl_log(frequency) / log2 : 0;
-      correlation += ( ( index[0] - pixelMean ) * ( index[1] - pixelMean ) * frequency ) / pixelVarianceSquared;
-      inverseDifferenceMoment += frequency / ( 1.0 + ( index[0] - index[1] ) * ( index[0] - index[1] ) );
-      inertia += ( index[0] - index[1] ) * ( index[0] - index[1] ) * frequency;
-      clusterShade += vcl_pow( ( index[0] - pixelMean ) + ( index[1] - pixelMean ), 3 ) * frequency;
-      clusterProminence += vcl_pow( ( index[0] - pixelMean ) + ( index[1] - pixelMean ), 4 ) * frequency;
-      haralickCorrelation += index[0] * index[1] * frequency;
-      ++constVectorIt;
+      GLCIList->SortVector();
       }
 
-    haralickCorrelation = (fabs(marginalDevSquared) > 1E-8) ?
-      ( haralickCorrelation - marginalMean * marginalMean )  / marginalDevSquared : 0;
+    // Compute textures
+    PixelValueType textures[8];
+    Self::ComputeTextures(GLCIList, m_NumberOfBinsPerAxis, textures);
 
     // Fill outputs
-    energyIt.Set(energy);
-    entropyIt.Set(entropy);
-    correlationIt.Set(correlation);
-    invDiffMomentIt.Set(inverseDifferenceMoment);
-    inertiaIt.Set(inertia);
-    clusterShadeIt.Set(clusterShade);
-    clusterProminenceIt.Set(clusterProminence);
-    haralickCorIt.Set(haralickCorrelation);
+    energyIt.Set(textures[0]);
+    entropyIt.Set(textures[1]);
+    correlationIt.Set(textures[2]);
+    invDiffMomentIt.Set(textures[3]);
+    inertiaIt.Set(textures[4]);
+    clusterShadeIt.Set(textures[5]);
+    clusterProminenceIt.Set(textures[6]);
+    haralickCorIt.Set(textures[7]);
 
     // Update progress
     progress.CompletedPixel();
@@ -0,0 +1,271 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbVectorImageToTexturesFilter_h
+#define otbVectorImageToTexturesFilter_h
+
+#include "otbScalarImageToTexturesFilter.h"
+#include "itkImage.h"
+#include <vector>
+
+namespace otb
+{
+/**
+ * \class VectorImageToTexturesFilter
+ * \brief This class computes the 8 local Haralick textures features of
+ * ScalarImageToTexturesFilter for all the bands of a multi-band image and for
+ * a set of co-occurrence offsets, in a single pass over the input.
+ *
+ * For each output pixel, the window of the given radius is traversed once,
+ * and the co-occurrence lists of all bands and all offsets are filled at the
+ * same time. As in ScalarImageToTexturesFilter, the lists are built from
+ * scratch for each window by default, and updated along rows with
+ * IncrementalUpdateOn().
+ *
+ * The output is a single multi-band image. For each input band, and for each
+ * offset in the order they were added, the 8 textures are provided in the
+ * order of ScalarImageToTexturesFilter: Energy, Entropy, Correlation, Inverse
+ * Difference Moment, Inertia, Cluster Shade, Cluster Prominence and Haralick
+ * Correlation. The output has thus 8 x NumberOfOffsets components per input
+ * band. If OffsetAveraging is on, the textures of each band are averaged over
+ * the offsets, which gives rotation invariant features when the offsets span
+ * several directions (e.g. (1,0), (1,-1), (0,1) and (1,1)), and the output
+ * has 8 components per input band.
+ *
+ * Input values outside of [InputImageMinimum, InputImageMaximum] are ignored.
+ * These bounds are used for all bands, unless per-band bounds are given with
+ * SetInputImageMinima() and SetInputImageMaxima(), in which case they must
+ * have one value per input band.
+ *
+ * \sa otb::ScalarImageToTexturesFilter
+ * \sa otb::GreyLevelCooccurrenceIndexedList
+ *
+ * \ingroup Streamed
+ * \ingroup Threaded
+ *
+ * \ingroup OTBTextures
+ */
+template<class TInputImage, class TOutputImage>
+class ITK_EXPORT VectorImageToTexturesFilter : public itk::ImageToImageFilter
+  <TInputImage, TOutputImage>
+{
+public:
+  /** Standard class typedefs */
+  typedef VectorImageToTexturesFilter                        Self;
+  typedef itk::ImageToImageFilter<TInputImage, TOutputImage> Superclass;
+  typedef itk::SmartPointer<Self>                            Pointer;
+  typedef itk::SmartPointer<const Self>                      ConstPointer;
+
+  /** Creation through the object factory */
+  itkNewMacro(Self);
+
+  /** RTTI */
+  itkTypeMacro(VectorImageToTexturesFilter, ImageToImageFilter);
+
+  /** Template class typedefs */
+  typedef TInputImage                                 InputImageType;
+  typedef typename InputImageType::PixelType          InputPixelType;
+  typedef typename InputImageType::InternalPixelType  InputInternalPixelType;
+  typedef typename InputImageType::RegionType         InputRegionType;
+  typedef typename InputRegionType::SizeType          SizeType;
+  typedef typename InputImageType::OffsetType         OffsetType;
+  typedef std::vector<OffsetType>                     OffsetListType;
+  typedef std::vector<InputInternalPixelType>         BoundListType;
+
+  typedef TOutputImage                                OutputImageType;
+  typedef typename OutputImageType::PixelType         OutputPixelType;
+  typedef typename OutputImageType::InternalPixelType OutputInternalPixelType;
+  typedef typename OutputImageType::RegionType        OutputRegionType;
+
+  /** The textures of each band and offset are computed as in this filter */
+  typedef itk::Image<InputInternalPixelType, InputImageType::ImageDimension>  ScalarInputImageType;
+  typedef itk::Image<OutputInternalPixelType, OutputImageType::ImageDimension> ScalarOutputImageType;
+  typedef ScalarImageToTexturesFilter<ScalarInputImageType, ScalarOutputImageType> ScalarTexturesFilterType;
+
+  typedef typename ScalarTexturesFilterType::CooccurrenceIndexedListType        CooccurrenceIndexedListType;
+  typedef typename ScalarTexturesFilterType::CooccurrenceIndexedListPointerType CooccurrenceIndexedListPointerType;
+  typedef typename ScalarTexturesFilterType::PixelValueType                     PixelValueType;
+
+  /** Number of textures computed for each band and offset */
+  itkStaticConstMacro(NumberOfTextures, unsigned int, 8);
+
+  /** Set the radius of the window on which textures will be computed */
+  itkSetMacro(Radius, SizeType);
+  /** Get the radius of the window on which textures will be computed */
+  itkGetMacro(Radius, SizeType);
+
+  /** Set the offsets for co-occurence computation */
+  void SetOffsets(const OffsetListType & offsets)
+  {
+    m_Offsets = offsets;
+    this->Modified();
+  }
+
+  /** Get the offsets for co-occurence computation */
+  const OffsetListType & GetOffsets() const
+  {
+    return m_Offsets;
+  }
+
+  /** Add an offset for co-occurence computation */
+  void AddOffset(const OffsetType & offset)
+  {
+    m_Offsets.push_back(offset);
+    this->Modified();
+  }
+
+  /** Remove all the offsets */
+  void ClearOffsets()
+  {
+    m_Offsets.clear();
+    this->Modified();
+  }
+
+  /** Set/Get the averaging of the textures over the offsets (off by default) */
+  itkSetMacro(OffsetAveraging, bool);
+  itkGetMacro(OffsetAveraging, bool);
+  itkBooleanMacro(OffsetAveraging);
+
+  /** Set the number of bin per axis */
+  itkSetMacro(NumberOfBinsPerAxis, unsigned int);
+
+  /** Get the number of bin per axis */
+  itkGetMacro(NumberOfBinsPerAxis, unsigned int);
+
+  /** Set the input image minimum */
+  itkSetMacro(InputImageMinimum, InputInternalPixelType);
+
+  /** Get the input image minimum */
+  itkGetMacro(InputImageMinimum, InputInternalPixelType);
+
+  /** Set the input image maximum */
+  itkSetMacro(InputImageMaximum, InputInternalPixelType);
+
+  /** Get the input image maximum */
+  itkGetMacro(InputImageMaximum, InputInternalPixelType);
+
+  /** Set the minimum of each input band. An empty list (the default) means
+   * that InputImageMinimum is used for all bands. */
+  void SetInputImageMinima(const BoundListType& minima)
+  {
+    m_InputImageMinima = minima;
+    this->Modified();
+  }
+
+  /** Get the minimum of each input band */
+  const BoundListType& GetInputImageMinima() const
+  {
+    return m_InputImageMinima;
+  }
+
+  /** Set the maximum of each input band. An empty list (the default) means
+   * that InputImageMaximum is used for all bands. */
+  void SetInputImageMaxima(const BoundListType& maxima)
+  {
+    m_InputImageMaxima = maxima;
+    this->Modified();
+  }
+
+  /** Get the maximum of each input band */
+  const BoundListType& GetInputImageMaxima() const
+  {
+    return m_InputImageMaxima;
+  }
+
+  /** Set the sub-sampling factor */
+  itkSetMacro(SubsampleFactor, SizeType);
+
+  /** Get the sub-sampling factor */
+  itkGetMacro(SubsampleFactor, SizeType);
+
+  /** Set the sub-sampling offset */
+  itkSetMacro(SubsampleOffset, OffsetType);
+
+  /** Get the sub-sampling offset */
+  itkGetMacro(SubsampleOffset, OffsetType);
+
+  /** Set/Get whether the co-occurrence lists are updated incrementally along
+   * rows (off by default) */
+  itkSetMacro(IncrementalUpdate, bool);
+  itkGetMacro(IncrementalUpdate, bool);
+  itkBooleanMacro(IncrementalUpdate);
+
+protected:
+  /** Constructor */
+  VectorImageToTexturesFilter();
+  /** Destructor */
+  ~VectorImageToTexturesFilter() ITK_OVERRIDE;
+  /** Generate the output information */
+  void GenerateOutputInformation() ITK_OVERRIDE;
+  /** Generate the input requested region */
+  void GenerateInputRequestedRegion() ITK_OVERRIDE;
+  /** Parallel textures extraction */
+  void ThreadedGenerateData(const OutputRegionType& outputRegion, itk::ThreadIdType threadId) ITK_OVERRIDE;
+
+private:
+  VectorImageToTexturesFilter(const Self&); //purposely not implemented
+  void operator =(const Self&); //purposely not implemented
+
+  /** Add (or remove) to the co-occurrence lists of all bands and offsets the
+   * pairs whose first pixel lies in the given input region. Lists are indexed
+   * by band, then by offset. */
+  void UpdateCooccurrenceLists(std::vector<CooccurrenceIndexedListPointerType> & lists,
+                               const InputRegionType& region, bool remove) const;
+
+  /** Radius of the window on which to compute textures */
+  SizeType m_Radius;
+
+  /** Offsets for co-occurence */
+  OffsetListType m_Offsets;
+
+  /** Average the textures over the offsets */
+  bool m_OffsetAveraging;
+
+  /** Number of bins per axis */
+  unsigned int m_NumberOfBinsPerAxis;
+
+  /** Input image minimum */
+  InputInternalPixelType m_InputImageMinimum;
+
+  /** Input image maximum */
+  InputInternalPixelType m_InputImageMaximum;
+
+  /** Per-band input image minima, empty to use m_InputImageMinimum */
+  BoundListType m_InputImageMinima;
+
+  /** Per-band input image maxima, empty to use m_InputImageMaximum */
+  BoundListType m_InputImageMaxima;
+
+  /** Sub-sampling factor */
+  SizeType m_SubsampleFactor;
+
+  /** Sub-sampling offset */
+  OffsetType m_SubsampleOffset;
+
+  /** Update the co-occurrence lists along rows instead of building them again */
+  bool m_IncrementalUpdate;
+};
+} // End namespace otb
+
+#ifndef OTB_MANUAL_INSTANTIATION
+#include "otbVectorImageToTexturesFilter.txx"
+#endif
+
+#endif
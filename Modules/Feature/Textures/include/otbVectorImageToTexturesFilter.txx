@@ -0,0 +1,357 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbVectorImageToTexturesFilter_txx
+#define otbVectorImageToTexturesFilter_txx
+
+#include "otbVectorImageToTexturesFilter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkProgressReporter.h"
+#include "itkNumericTraits.h"
+#include <algorithm>
+
+namespace otb
+{
+template <class TInputImage, class TOutputImage>
+VectorImageToTexturesFilter<TInputImage, TOutputImage>
+::VectorImageToTexturesFilter()
+: m_Radius()
+, m_Offsets()
+, m_OffsetAveraging(false)
+, m_NumberOfBinsPerAxis(8)
+, m_InputImageMinimum(0)
+, m_InputImageMaximum(255)
+, m_InputImageMinima()
+, m_InputImageMaxima()
+, m_SubsampleFactor()
+, m_SubsampleOffset()
+, m_IncrementalUpdate(false)
+{
+  this->m_SubsampleFactor.Fill(1);
+  this->m_SubsampleOffset.Fill(0);
+}
+
+template <class TInputImage, class TOutputImage>
+VectorImageToTexturesFilter<TInputImage, TOutputImage>
+::~VectorImageToTexturesFilter()
+{}
+
+template <class TInputImage, class TOutputImage>
+void
+VectorImageToTexturesFilter<TInputImage, TOutputImage>
+::GenerateOutputInformation()
+{
+  // First, call superclass implementation
+  Superclass::GenerateOutputInformation();
+
+  if (m_Offsets.empty())
+    {
+    itkExceptionMacro(<< "At least one offset is needed to compute the textures.");
+    }
+
+  const InputImageType * inputPtr = this->GetInput();
+  OutputImageType * outputPtr = this->GetOutput();
+
+  const unsigned int nbBands = inputPtr->GetNumberOfComponentsPerPixel();
+  if ((!m_InputImageMinima.empty() && m_InputImageMinima.size() != nbBands)
+      || (!m_InputImageMaxima.empty() && m_InputImageMaxima.size() != nbBands))
+    {
+    itkExceptionMacro(<< "Per-band minima and maxima must have one value per input band ("
+                      << nbBands << ").");
+    }
+
+  // Compute output size, origin & spacing
+  InputRegionType inputRegion = inputPtr->GetLargestPossibleRegion();
+  OutputRegionType outputRegion;
+  outputRegion.SetIndex(0,0);
+  outputRegion.SetIndex(1,0);
+  outputRegion.SetSize(0, 1 + (inputRegion.GetSize(0) - 1 - m_SubsampleOffset[0]) / m_SubsampleFactor[0]);
+  outputRegion.SetSize(1, 1 + (inputRegion.GetSize(1) - 1 - m_SubsampleOffset[1]) / m_SubsampleFactor[1]);
+
+  typename OutputImageType::SpacingType outSpacing = inputPtr->GetSpacing();
+  outSpacing[0] *= m_SubsampleFactor[0];
+  outSpacing[1] *= m_SubsampleFactor[1];
+
+  typename OutputImageType::PointType outOrigin;
+  inputPtr->TransformIndexToPhysicalPoint(inputRegion.GetIndex()+m_SubsampleOffset,outOrigin);
+
+  outputPtr->SetLargestPossibleRegion(outputRegion);
+  outputPtr->SetOrigin(outOrigin);
+  outputPtr->SetSpacing(outSpacing);
+
+  // 8 textures per band, and per offset unless they are averaged
+  const unsigned int nbOffsets = m_OffsetAveraging ? 1 : m_Offsets.size();
+  outputPtr->SetNumberOfComponentsPerPixel(nbBands * nbOffsets * NumberOfTextures);
+}
+
+template <class TInputImage, class TOutputImage>
+void
+VectorImageToTexturesFilter<TInputImage, TOutputImage>
+::GenerateInputRequestedRegion()
+{
+  // First, call superclass implementation
+  Superclass::GenerateInputRequestedRegion();
+
+  // Retrieve the input and output pointers
+  InputImageType *  inputPtr = const_cast<InputImageType *>(this->GetInput());
+  OutputImageType * outputPtr = this->GetOutput();
+
+  if (!inputPtr || !outputPtr)
+    {
+    return;
+    }
+
+  OutputRegionType outputRequestedRegion = outputPtr->GetRequestedRegion();
+
+  typename OutputRegionType::IndexType outputIndex = outputRequestedRegion.GetIndex();
+  typename OutputRegionType::SizeType  outputSize   = outputRequestedRegion.GetSize();
+  typename InputRegionType::IndexType  inputIndex;
+  typename InputRegionType::SizeType   inputSize;
+  InputRegionType inputLargest = inputPtr->GetLargestPossibleRegion();
+
+  // Convert index and size to full grid
+  outputIndex[0] = outputIndex[0] * m_SubsampleFactor[0] + m_SubsampleOffset[0] + inputLargest.GetIndex(0);
+  outputIndex[1] = outputIndex[1] * m_SubsampleFactor[1] + m_SubsampleOffset[1] + inputLargest.GetIndex(1);
+  outputSize[0] = 1 + (outputSize[0] - 1) * m_SubsampleFactor[0];
+  outputSize[1] = 1 + (outputSize[1] - 1) * m_SubsampleFactor[1];
+
+  // First, apply the extent of all offsets
+  for (unsigned int dim = 0; dim < InputImageType::ImageDimension; ++dim)
+    {
+    typename OffsetType::OffsetValueType minOffset = 0;
+    typename OffsetType::OffsetValueType maxOffset = 0;
+    for (typename OffsetListType::const_iterator offIt = m_Offsets.begin(); offIt != m_Offsets.end(); ++offIt)
+      {
+      minOffset = std::min(minOffset, (*offIt)[dim]);
+      maxOffset = std::max(maxOffset, (*offIt)[dim]);
+      }
+    inputIndex[dim] = outputIndex[dim] + minOffset;
+    inputSize[dim] = outputSize[dim] + maxOffset - minOffset;
+    }
+
+  // Build the input requested region
+  InputRegionType inputRequestedRegion;
+  inputRequestedRegion.SetIndex(inputIndex);
+  inputRequestedRegion.SetSize(inputSize);
+
+  // Apply the radius
+  inputRequestedRegion.PadByRadius(m_Radius);
+
+  // Try to apply the requested region to the input image
+  if (inputRequestedRegion.Crop(inputPtr->GetLargestPossibleRegion()))
+    {
+    inputPtr->SetRequestedRegion(inputRequestedRegion);
+    }
+  else
+    {
+    // Build an exception
+    itk::InvalidRequestedRegionError e(__FILE__, __LINE__);
+    e.SetLocation(ITK_LOCATION);
+    e.SetDescription("Requested region is (at least partially) outside the largest possible region.");
+    e.SetDataObject(inputPtr);
+    throw e;
+    }
+}
+
+template <class TInputImage, class TOutputImage>
+void
+VectorImageToTexturesFilter<TInputImage, TOutputImage>
+::UpdateCooccurrenceLists(std::vector<CooccurrenceIndexedListPointerType> & lists,
+                          const InputRegionType& region, bool remove) const
+{
+  if (region.GetNumberOfPixels() == 0)
+    {
+    return;
+    }
+
+  const InputImageType * inputPtr = this->GetInput();
+  const InputRegionType& bufferedRegion = inputPtr->GetBufferedRegion();
+  const unsigned int nbBands = inputPtr->GetNumberOfComponentsPerPixel();
+  const unsigned int nbOffsets = m_Offsets.size();
+
+  // Each pixel is read once for all the offsets and bands
+  itk::ImageRegionConstIteratorWithIndex<InputImageType> it(inputPtr, region);
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+    const InputPixelType value = it.Get();
+    for (unsigned int offset = 0; offset < nbOffsets; ++offset)
+      {
+      const typename InputImageType::IndexType neighborIndex = it.GetIndex() + m_Offsets[offset];
+      if (!bufferedRegion.IsInside(neighborIndex))
+        {
+        continue; // don't put a pixel in the co-occurrence list if the value is
+                  // out of bounds
+        }
+      const InputPixelType neighborValue = inputPtr->GetPixel(neighborIndex);
+      for (unsigned int band = 0; band < nbBands; ++band)
+        {
+        CooccurrenceIndexedListType * list = lists[band * nbOffsets + offset];
+        if (remove)
+          {
+          list->RemovePixelPair(value[band], neighborValue[band]);
+          }
+        else
+          {
+          list->AddPixelPair(value[band], neighborValue[band]);
+          }
+        }
+      }
+    }
+}
+
+template <class TInputImage, class TOutputImage>
+void
+VectorImageToTexturesFilter<TInputImage, TOutputImage>
+::ThreadedGenerateData(const OutputRegionType& outputRegionForThread, itk::ThreadIdType threadId)
+{
+  // Retrieve the input and output pointers
+  const InputImageType * inputPtr = this->GetInput();
+  OutputImageType * outputPtr = this->GetOutput();
+
+  const unsigned int nbBands = inputPtr->GetNumberOfComponentsPerPixel();
+  const unsigned int nbOffsets = m_Offsets.size();
+  const unsigned int nbComponents = outputPtr->GetNumberOfComponentsPerPixel();
+
+  itk::ImageRegionIteratorWithIndex<OutputImageType> outIt(outputPtr, outputRegionForThread);
+
+  InputRegionType inputLargest = inputPtr->GetLargestPossibleRegion();
+
+  // Set-up progress reporting
+  itk::ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels());
+
+  // Co-occurrence lists of the sliding window, for each band and offset
+  std::vector<CooccurrenceIndexedListPointerType> lists(nbBands * nbOffsets);
+  for (unsigned int i = 0; i < lists.size(); ++i)
+    {
+    lists[i] = CooccurrenceIndexedListType::New();
+    }
+  InputRegionType previousInputRegion;
+  bool hasPreviousWindow = false;
+
+  // Bounds of the co-occurrence lists of each band
+  BoundListType minima = m_InputImageMinima;
+  BoundListType maxima = m_InputImageMaxima;
+  minima.resize(nbBands, m_InputImageMinimum);
+  maxima.resize(nbBands, m_InputImageMaximum);
+
+  OutputPixelType outPixel(nbComponents);
+
+  // Iterate on outputs to compute textures
+  for (outIt.GoToBegin(); !outIt.IsAtEnd(); ++outIt)
+    {
+    // Compute the region on which co-occurence will be estimated
+    typename InputRegionType::IndexType inputIndex;
+    typename InputRegionType::SizeType inputSize;
+
+    for (unsigned int dim = 0; dim < InputImageType::ImageDimension; ++dim)
+      {
+      const typename InputRegionType::IndexValueType center =
+        outIt.GetIndex()[dim] * m_SubsampleFactor[dim] + m_SubsampleOffset[dim] + inputLargest.GetIndex(dim);
+      inputIndex[dim] = center - m_Radius[dim];
+      inputSize[dim] = 2 * m_Radius[dim] + 1;
+      }
+
+    // Build the input  region
+    InputRegionType inputRegion;
+    inputRegion.SetIndex(inputIndex);
+    inputRegion.SetSize(inputSize);
+    inputRegion.Crop(inputPtr->GetRequestedRegion());
+
+    // In incremental mode, when the window moves along a row, only the pairs of
+    // the columns leaving and entering the window are updated. Otherwise the
+    // lists are built again, in the raster order of the window.
+    const typename InputRegionType::IndexValueType windowEnd = inputRegion.GetIndex(0) + inputRegion.GetSize(0);
+    const typename InputRegionType::IndexValueType previousWindowEnd =
+      previousInputRegion.GetIndex(0) + previousInputRegion.GetSize(0);
+    if (m_IncrementalUpdate
+        && hasPreviousWindow
+        && inputRegion.GetIndex(1) == previousInputRegion.GetIndex(1)
+        && inputRegion.GetSize(1) == previousInputRegion.GetSize(1)
+        && inputRegion.GetIndex(0) >= previousInputRegion.GetIndex(0)
+        && inputRegion.GetIndex(0) < previousWindowEnd
+        && windowEnd >= previousWindowEnd)
+      {
+      InputRegionType leavingRegion = previousInputRegion;
+      leavingRegion.SetSize(0, inputRegion.GetIndex(0) - previousInputRegion.GetIndex(0));
+      this->UpdateCooccurrenceLists(lists, leavingRegion, true);
+
+      InputRegionType enteringRegion = inputRegion;
+      enteringRegion.SetIndex(0, previousWindowEnd);
+      enteringRegion.SetSize(0, windowEnd - previousWindowEnd);
+      this->UpdateCooccurrenceLists(lists, enteringRegion, false);
+      }
+    else
+      {
+      for (unsigned int i = 0; i < lists.size(); ++i)
+        {
+        const unsigned int band = i / nbOffsets;
+        lists[i]->Initialize(m_NumberOfBinsPerAxis, minima[band], maxima[band]);
+        }
+      this->UpdateCooccurrenceLists(lists, inputRegion, false);
+      }
+    previousInputRegion = inputRegion;
+    hasPreviousWindow = true;
+
+    // The order of the pairs then depends on the updates: sort them so that
+    // the textures do not depend on where rows or thread regions start
+    if (m_IncrementalUpdate)
+      {
+      for (unsigned int i = 0; i < lists.size(); ++i)
+        {
+        lists[i]->SortVector();
+        }
+      }
+
+    // Compute textures of each band and offset
+    outPixel.Fill(itk::NumericTraits<OutputInternalPixelType>::Zero);
+    PixelValueType textures[NumberOfTextures];
+    for (unsigned int band = 0; band < nbBands; ++band)
+      {
+      for (unsigned int offset = 0; offset < nbOffsets; ++offset)
+        {
+        ScalarTexturesFilterType::ComputeTextures(lists[band * nbOffsets + offset], m_NumberOfBinsPerAxis, textures);
+
+        if (m_OffsetAveraging)
+          {
+          for (unsigned int t = 0; t < NumberOfTextures; ++t)
+            {
+            outPixel[band * NumberOfTextures + t] += textures[t] / nbOffsets;
+            }
+          }
+        else
+          {
+          for (unsigned int t = 0; t < NumberOfTextures; ++t)
+            {
+            outPixel[(band * nbOffsets + offset) * NumberOfTextures + t] = textures[t];
+            }
+          }
+        }
+      }
+    outIt.Set(outPixel);
+
+    // Update progress
+    progress.CompletedPixel();
+    }
+}
+
+} // End namespace otb
+
+#endif
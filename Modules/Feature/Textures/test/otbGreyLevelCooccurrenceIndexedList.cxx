@@ -250,3 +250,60 @@ int otbGreyLevelCooccurrenceIndexedList(int, char* [] )
       return EXIT_SUCCESS;
       }
 }
+
+int otbGreyLevelCooccurrenceIndexedListRemove(int, char* [] )
+{
+  typedef unsigned char InputPixelType;
+  typedef otb::GreyLevelCooccurrenceIndexedList< InputPixelType > CooccurrenceIndexedListType;
+
+  // Pixel pairs of a sliding window: the first pairs leave the window and the
+  // last ones enter it
+  static const InputPixelType pairs[][2] = {{0,0}, {1,2}, {2,1}, {7,3}, {3,3}, {1,2}, {5,6}, {7,7}, {2,1}, {0,6}};
+  const unsigned int nbPairs = sizeof(pairs) / sizeof(pairs[0]);
+  const unsigned int nbRemoved = 4;
+
+  CooccurrenceIndexedListType::Pointer updated = CooccurrenceIndexedListType::New();
+  updated->Initialize(8, 0, 7);
+  for (unsigned int i = 0; i < nbPairs; ++i)
+    {
+    updated->AddPixelPair(pairs[i][0], pairs[i][1]);
+    }
+  for (unsigned int i = 0; i < nbRemoved; ++i)
+    {
+    updated->RemovePixelPair(pairs[i][0], pairs[i][1]);
+    }
+
+  CooccurrenceIndexedListType::Pointer reference = CooccurrenceIndexedListType::New();
+  reference->Initialize(8, 0, 7);
+  for (unsigned int i = nbRemoved; i < nbPairs; ++i)
+    {
+    reference->AddPixelPair(pairs[i][0], pairs[i][1]);
+    }
+
+  if (updated->GetTotalFrequency() != reference->GetTotalFrequency()
+      || updated->GetVector().size() != reference->GetVector().size())
+    {
+    std::cerr << "Expected " << reference->GetVector().size() << " pairs with a total frequency of "
+              << reference->GetTotalFrequency() << ", got " << updated->GetVector().size()
+              << " pairs with a total frequency of " << updated->GetTotalFrequency() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Compare the frequencies of all the bin pairs
+  const CooccurrenceIndexedListType::VectorType updatedVector = updated->GetVector();
+  const CooccurrenceIndexedListType::VectorType referenceVector = reference->GetVector();
+  for (unsigned int i = 0; i < 8; ++i)
+    {
+    for (unsigned int j = 0; j < 8; ++j)
+      {
+      if (updated->GetFrequency(i, j, updatedVector) != reference->GetFrequency(i, j, referenceVector))
+        {
+        std::cerr << "Expected frequency " << reference->GetFrequency(i, j, referenceVector) << " at (" << i << ", " << j
+                  << "), got " << updated->GetFrequency(i, j, updatedVector) << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
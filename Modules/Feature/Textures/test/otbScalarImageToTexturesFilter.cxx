@@ -28,9 +28,9 @@
 
 int otbScalarImageToTexturesFilter(int argc, char * argv[])
 {
-  if (argc != 7)
+  if (argc != 7 && argc != 8)
     {
-    std::cerr << "Usage: " << argv[0] << " infname outprefix nbBins radius offsetx offsety" << std::endl;
+    std::cerr << "Usage: " << argv[0] << " infname outprefix nbBins radius offsetx offsety [incremental]" << std::endl;
     return EXIT_FAILURE;
     }
   const char *       infname      = argv[1];
@@ -39,6 +39,7 @@ int otbScalarImageToTexturesFilter(int argc, char * argv[])
   const unsigned int radius       = atoi(argv[4]);
   const int          offsetx      = atoi(argv[5]);
   const int          offsety      = atoi(argv[6]);
+  const bool         incremental  = (argc == 8) && (atoi(argv[7]) != 0);
 
   const unsigned int Dimension = 2;
   typedef float                            PixelType;
@@ -67,6 +68,7 @@ int otbScalarImageToTexturesFilter(int argc, char * argv[])
   filter->SetInput(reader->GetOutput());
   filter->SetRadius(sradius);
   filter->SetOffset(offset);
+  filter->SetIncrementalUpdate(incremental);
 
   otb::StandardFilterWatcher watcher(filter, "Textures filter");
 
@@ -27,6 +27,7 @@ void RegisterTests()
   REGISTER_TEST(otbHaralickTexturesImageFunctionNew);
   REGISTER_TEST(otbHaralickTexturesImageFunction);
   REGISTER_TEST(otbGreyLevelCooccurrenceIndexedList);
+  REGISTER_TEST(otbGreyLevelCooccurrenceIndexedListRemove);
   REGISTER_TEST(otbScalarImageToTexturesFilter);
   REGISTER_TEST(otbScalarImageToTexturesFilterNew);
   REGISTER_TEST(otbSFSTexturesImageFilterTest);
@@ -36,4 +37,5 @@ void RegisterTests()
   REGISTER_TEST(otbGreyLevelCooccurrenceIndexedListNew);
   REGISTER_TEST(otbScalarImageToAdvancedTexturesFilter);
   REGISTER_TEST(otbScalarImageToPanTexTextureFilter);
+  REGISTER_TEST(otbVectorImageToTexturesFilter);
 }
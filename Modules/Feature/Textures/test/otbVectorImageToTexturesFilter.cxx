@@ -0,0 +1,183 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "otbVectorImageToTexturesFilter.h"
+#include "otbScalarImageToTexturesFilter.h"
+#include "otbVectorImage.h"
+#include "otbImage.h"
+#include "otbImageFileReader.h"
+#include "otbImageFileWriter.h"
+#include "otbMultiToMonoChannelExtractROI.h"
+#include "itkImageRegionConstIterator.h"
+
+int otbVectorImageToTexturesFilter(int argc, char * argv[])
+{
+  if (argc != 5)
+    {
+    std::cerr << "Usage: " << argv[0] << " infname outfname nbBins radius" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const char *       infname  = argv[1];
+  const char *       outfname = argv[2];
+  const unsigned int nbBins   = atoi(argv[3]);
+  const unsigned int radius   = atoi(argv[4]);
+
+  const unsigned int Dimension = 2;
+  typedef float                                                         PixelType;
+  typedef otb::VectorImage<PixelType, Dimension>                        VectorImageType;
+  typedef otb::Image<PixelType, Dimension>                              ImageType;
+  typedef otb::ImageFileReader<VectorImageType>                         ReaderType;
+  typedef otb::ImageFileWriter<VectorImageType>                         WriterType;
+  typedef otb::VectorImageToTexturesFilter<VectorImageType, VectorImageType> VectorTexturesFilterType;
+  typedef otb::ScalarImageToTexturesFilter<ImageType, ImageType>        TexturesFilterType;
+  typedef otb::MultiToMonoChannelExtractROI<PixelType, PixelType>       ExtractFilterType;
+
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(infname);
+  reader->UpdateOutputInformation();
+  const unsigned int nbBands = reader->GetOutput()->GetNumberOfComponentsPerPixel();
+
+  VectorTexturesFilterType::SizeType sradius;
+  sradius.Fill(radius);
+
+  // Horizontal, diagonal and vertical offsets
+  VectorTexturesFilterType::OffsetListType offsets;
+  VectorTexturesFilterType::OffsetType offset;
+  offset[0] = 1;
+  offset[1] = 0;
+  offsets.push_back(offset);
+  offset[0] = 1;
+  offset[1] = -1;
+  offsets.push_back(offset);
+  offset[0] = 0;
+  offset[1] = 1;
+  offsets.push_back(offset);
+
+  // Per-band minima, the maximum of all bands being the scalar one
+  VectorTexturesFilterType::BoundListType minima;
+  for (unsigned int band = 0; band < nbBands; ++band)
+    {
+    minima.push_back(static_cast<PixelType>(10 * band));
+    }
+
+  VectorTexturesFilterType::Pointer filter = VectorTexturesFilterType::New();
+  filter->SetInput(reader->GetOutput());
+  filter->SetRadius(sradius);
+  filter->SetOffsets(offsets);
+  filter->SetNumberOfBinsPerAxis(nbBins);
+  filter->SetInputImageMinimum(0);
+  filter->SetInputImageMaximum(255);
+  filter->SetInputImageMinima(minima);
+
+  // Textures of all bands and offsets are checked against the baseline
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetInput(filter->GetOutput());
+  writer->SetFileName(outfname);
+  writer->SetNumberOfDivisionsStrippedStreaming(2);
+  writer->Update();
+  filter->UpdateLargestPossibleRegion();
+
+  VectorTexturesFilterType::Pointer averageFilter = VectorTexturesFilterType::New();
+  averageFilter->SetInput(reader->GetOutput());
+  averageFilter->SetRadius(sradius);
+  averageFilter->SetOffsets(offsets);
+  averageFilter->OffsetAveragingOn();
+  averageFilter->SetNumberOfBinsPerAxis(nbBins);
+  averageFilter->SetInputImageMinimum(0);
+  averageFilter->SetInputImageMaximum(255);
+  averageFilter->SetInputImageMinima(minima);
+  averageFilter->Update();
+
+  if (filter->GetOutput()->GetNumberOfComponentsPerPixel() != nbBands * offsets.size() * 8
+      || averageFilter->GetOutput()->GetNumberOfComponentsPerPixel() != nbBands * 8)
+    {
+    std::cerr << "Wrong number of output components" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Each band and offset gives the textures of the scalar filter
+  const VectorImageType::RegionType region = filter->GetOutput()->GetLargestPossibleRegion();
+  unsigned int nbErrors = 0;
+  for (unsigned int band = 0; band < nbBands; ++band)
+    {
+    ExtractFilterType::Pointer extract = ExtractFilterType::New();
+    extract->SetInput(reader->GetOutput());
+    extract->SetChannel(band + 1);
+
+    for (unsigned int o = 0; o < offsets.size(); ++o)
+      {
+      TexturesFilterType::Pointer scalarFilter = TexturesFilterType::New();
+      scalarFilter->SetInput(extract->GetOutput());
+      scalarFilter->SetRadius(sradius);
+      scalarFilter->SetOffset(offsets[o]);
+      scalarFilter->SetNumberOfBinsPerAxis(nbBins);
+      scalarFilter->SetInputImageMinimum(minima[band]);
+      scalarFilter->SetInputImageMaximum(255);
+      scalarFilter->Update();
+
+      for (unsigned int t = 0; t < 8; ++t)
+        {
+        itk::ImageRegionConstIterator<VectorImageType> vectorIt(filter->GetOutput(), region);
+        itk::ImageRegionConstIterator<ImageType> scalarIt(scalarFilter->GetOutput(t), region);
+        const unsigned int component = (band * offsets.size() + o) * 8 + t;
+
+        for (; !scalarIt.IsAtEnd(); ++vectorIt, ++scalarIt)
+          {
+          if (vcl_abs(vectorIt.Get()[component] - scalarIt.Get()) > 1e-4 * (1 + vcl_abs(scalarIt.Get())))
+            {
+            ++nbErrors;
+            }
+          }
+        }
+      }
+    }
+
+  // Averaged textures are the mean over the offsets
+  itk::ImageRegionConstIterator<VectorImageType> vectorIt(filter->GetOutput(), region);
+  itk::ImageRegionConstIterator<VectorImageType> averageIt(averageFilter->GetOutput(), region);
+  for (; !vectorIt.IsAtEnd(); ++vectorIt, ++averageIt)
+    {
+    for (unsigned int band = 0; band < nbBands; ++band)
+      {
+      for (unsigned int t = 0; t < 8; ++t)
+        {
+        double mean = 0.;
+        for (unsigned int o = 0; o < offsets.size(); ++o)
+          {
+          mean += vectorIt.Get()[(band * offsets.size() + o) * 8 + t];
+          }
+        mean /= offsets.size();
+        if (vcl_abs(averageIt.Get()[band * 8 + t] - mean) > 1e-4 * (1 + vcl_abs(mean)))
+          {
+          ++nbErrors;
+          }
+        }
+      }
+    }
+
+  if (nbErrors != 0)
+    {
+    std::cerr << nbErrors << " texture values differ from the scalar filter" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
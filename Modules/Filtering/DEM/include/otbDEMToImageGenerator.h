@@ -23,6 +23,7 @@
 
 #include <iostream>
 #include <stdio.h>
+#include <vector>
 
 #include "itkImageSource.h"
 #include "otbImage.h"
@@ -40,6 +41,21 @@ namespace otb
  * and latitude, the spacing and the output image size.
  * Handle DTED and SRTM formats.
  *
+ * The output is generated line by line: the points of a line are
+ * transformed in one batch (see Transform::TransformPoints()), with one
+ * clone of the transform per thread, and their heights are queried in
+ * one batch as well. The DEM tiles are read once through the DEM cache of
+ * DEMHandler (see DEMHandler::SetDEMCacheSize()), and the points of a
+ * line falling in the same tile are interpolated together. If DEMCacheSize
+ * is set and the cache of DEMHandler is disabled when the output is
+ * generated, the generator enables it with a size of DEMCacheSize MB, and
+ * disables it again afterwards; by default, DEMHandler is left as it is,
+ * the heights being then read point by point. As DEMHandler is a
+ * singleton, it must not be queried by other threads when the generator
+ * enables its cache. If the transform can not be cloned, the output is
+ * generated with a single thread.
+ * Heights are the same as the ones of point queries to DEMHandler.
+ *
  * \ingroup Images
  *
  * \example IO/DEMToImageGenerator.cxx
@@ -108,6 +124,12 @@ public:
   itkGetMacro(AboveEllipsoid,bool);
   itkBooleanMacro(AboveEllipsoid);
 
+  /** Set/Get the size of the DEM cache of DEMHandler, in MB, set during
+   * the generation when it is disabled. Defaults to 0, which leaves
+   * DEMHandler as it is. */
+  itkSetMacro(DEMCacheSize, unsigned int);
+  itkGetConstMacro(DEMCacheSize, unsigned int);
+
   void InstantiateTransform();
 
   /**
@@ -180,6 +202,7 @@ protected:
 
   void PrintSelf(std::ostream& os, itk::Indent indent) const ITK_OVERRIDE;
   void BeforeThreadedGenerateData() ITK_OVERRIDE;
+  void AfterThreadedGenerateData() ITK_OVERRIDE;
   void ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread,
                             itk::ThreadIdType threadId) ITK_OVERRIDE;
   void GenerateOutputInformation() ITK_OVERRIDE;
@@ -190,12 +213,17 @@ protected:
   SizeType                m_OutputSize;
   PixelType               m_DefaultUnknownValue;
   bool                    m_AboveEllipsoid;
+  unsigned int            m_DEMCacheSize;
+  bool                    m_DEMCacheEnabled;
 
 private:
   DEMToImageGenerator(const Self &); //purposely not implemented
   void operator =(const Self&); //purposely not implemented
 
   GenericRSTransformPointerType      m_Transform;
+
+  /** Transform used by each thread */
+  std::vector<GenericRSTransformPointerType> m_ThreadTransforms;
 };
 
 } // namespace otb
@@ -24,6 +24,7 @@
 #include "otbDEMToImageGenerator.h"
 #include "otbMacro.h"
 #include "itkProgressReporter.h"
+#include "itkImageScanlineIterator.h"
 
 namespace otb
 {
@@ -41,6 +42,8 @@ DEMToImageGenerator<TDEMImage>
   m_OutputOrigin[1] = 0;
   m_DefaultUnknownValue = itk::NumericTraits<PixelType>::ZeroValue();
   m_AboveEllipsoid = false;
+  m_DEMCacheSize = 0;
+  m_DEMCacheEnabled = false;
 
   m_Transform         = GenericRSTransformType::New();
 }
@@ -94,6 +97,44 @@ void DEMToImageGenerator<TDEMImage>
 ::BeforeThreadedGenerateData()
 {
   InstantiateTransform();
+
+  // Read the DEM tiles once, unless a cache size has already been set.
+  // The cache is disabled again once the output is generated.
+  m_DEMCacheEnabled = false;
+  if (m_DEMCacheSize > 0 && m_DEMHandler->GetDEMCacheSize() == 0 && m_DEMHandler->GetDEMCount() > 0)
+    {
+    otbMsgDevMacro(<< "Enabling the DEM cache of DEMHandler (" << m_DEMCacheSize << " MB)");
+    m_DEMHandler->SetDEMCacheSize(m_DEMCacheSize);
+    m_DEMCacheEnabled = true;
+    }
+
+  // Sensor models are not thread safe: each thread gets its own clone
+  const unsigned int nbThreads = this->GetNumberOfThreads();
+  m_ThreadTransforms.assign(nbThreads, m_Transform);
+  if (m_Transform.IsNotNull())
+    {
+    bool cloned = true;
+    try
+      {
+      for (unsigned int threadId = 1; threadId < nbThreads && cloned; ++threadId)
+        {
+        m_ThreadTransforms[threadId] = dynamic_cast<GenericRSTransformType *>(m_Transform->Clone().GetPointer());
+        cloned = m_ThreadTransforms[threadId].IsNotNull();
+        }
+      }
+    catch (itk::ExceptionObject &)
+      {
+      cloned = false;
+      }
+
+    if (!cloned)
+      {
+      otbMsgDevMacro(<< "Transform can not be cloned, the output is generated with a single thread");
+      this->SetNumberOfThreads(1);
+      m_ThreadTransforms.assign(1, m_Transform);
+      }
+    }
+
   DEMImagePointerType DEMImage = this->GetOutput();
 
   // allocate the output buffer
@@ -102,6 +143,20 @@ void DEMToImageGenerator<TDEMImage>
   DEMImage->FillBuffer(0);
 }
 
+template <class TDEMImage>
+void DEMToImageGenerator<TDEMImage>
+::AfterThreadedGenerateData()
+{
+  m_ThreadTransforms.clear();
+
+  // Leave DEMHandler as it was before the generation
+  if (m_DEMCacheEnabled)
+    {
+    m_DEMHandler->SetDEMCacheSize(0);
+    m_DEMCacheEnabled = false;
+    }
+}
+
 
 template <class TDEMImage>
 void
@@ -109,70 +164,88 @@ DEMToImageGenerator<TDEMImage>
 ::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread,
                        itk::ThreadIdType threadId)
 {
-  DEMImagePointerType DEMImage = this->GetOutput();
+  if (outputRegionForThread.GetNumberOfPixels() == 0)
+    {
+    return;
+    }
+
+  typedef typename GenericRSTransformType::InputPointType  TransformInputPointType;
+  typedef typename GenericRSTransformType::OutputPointType TransformOutputPointType;
+  typedef DEMHandlerType::PointType                        GeoPointType;
+
+  DEMImageType * DEMImage = this->GetOutput();
+  const GenericRSTransformType * transform = m_ThreadTransforms[threadId];
 
-  // Create an iterator that will walk the output region
-  ImageIteratorType outIt = ImageIteratorType(DEMImage, outputRegionForThread);
+  const unsigned long lineLength = outputRegionForThread.GetSize()[0];
+  const unsigned long nbLines = outputRegionForThread.GetNumberOfPixels() / lineLength;
 
   // support progress methods/callbacks
-  itk::ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels());
+  itk::ProgressReporter progress(this, threadId, nbLines);
 
-  // Walk the output image, evaluating the height at each pixel
-  IndexType currentindex;
-  PointType phyPoint;
-  double    height;
-  PointType geoPoint;
+  std::vector<TransformInputPointType>  phyPoints(lineLength);
+  std::vector<TransformOutputPointType> transformedPoints(lineLength);
+  std::vector<GeoPointType>             geoPoints(lineLength);
+  std::vector<double>                   heights(lineLength);
 
-  for (outIt.GoToBegin(); !outIt.IsAtEnd(); ++outIt)
-    {
-    currentindex = outIt.GetIndex();
-    DEMImage->TransformIndexToPhysicalPoint(currentindex, phyPoint);
+  itk::ImageScanlineIterator<DEMImageType> outIt(DEMImage, outputRegionForThread);
 
+  while (!outIt.IsAtEnd())
+    {
+    // Geographic points of the line
+    IndexType index = outIt.GetIndex();
+    PointType phyPoint;
+    for (unsigned long i = 0; i < lineLength; ++i, ++index[0])
+      {
+      DEMImage->TransformIndexToPhysicalPoint(index, phyPoint);
+      phyPoints[i][0] = phyPoint[0];
+      phyPoints[i][1] = phyPoint[1];
+      }
 
-    if(m_Transform.IsNotNull())
+    if (transform != ITK_NULLPTR)
       {
-        geoPoint = m_Transform->TransformPoint(phyPoint);
-        if(m_AboveEllipsoid)
-          {
-          height = m_DEMHandler->GetHeightAboveEllipsoid(geoPoint); // Altitude
-                                                              // calculation
-          }
-        else
-          {
-          height = m_DEMHandler->GetHeightAboveMSL(geoPoint); // Altitude
-                                                              // calculation
-          }
+      transform->TransformPoints(&phyPoints[0], &transformedPoints[0], lineLength);
+      for (unsigned long i = 0; i < lineLength; ++i)
+        {
+        geoPoints[i][0] = transformedPoints[i][0];
+        geoPoints[i][1] = transformedPoints[i][1];
+        }
       }
     else
       {
- if(m_AboveEllipsoid)
-          {
-          height = m_DEMHandler->GetHeightAboveEllipsoid(phyPoint); // Altitude
-                                                                    // calculation
-          }
-        else
-          {
-          height = m_DEMHandler->GetHeightAboveMSL(phyPoint); // Altitude
-                                                              // calculation
-          }
+      for (unsigned long i = 0; i < lineLength; ++i)
+        {
+        geoPoints[i][0] = phyPoints[i][0];
+        geoPoints[i][1] = phyPoints[i][1];
+        }
       }
-/*    otbMsgDevMacro(<< "Index : (" << currentindex[0]<< "," << currentindex[1] << ") -> PhyPoint : ("
-                   << phyPoint[0] << "," << phyPoint[1] << ") -> GeoPoint: ("
-                   << geoPoint[0] << "," << geoPoint[1] << ") -> height" << height);
-*/
-//       otbMsgDevMacro(<< "height" << height);
-    // DEM sets a default value (-32768) at point where it doesn't have altitude information.
-    // OSSIM has chosen to change this default value in OSSIM_DBL_NAN (-4.5036e15).
-    if (!vnl_math_isnan(height))
+
+    // Altitude calculation
+    if (m_AboveEllipsoid)
       {
-      // Fill the image
-      DEMImage->SetPixel(currentindex, static_cast<PixelType>(height));
+      m_DEMHandler->GetHeightAboveEllipsoid(&geoPoints[0], &heights[0], lineLength);
       }
     else
       {
-      // Back to the MNT default value
-      DEMImage->SetPixel(currentindex, m_DefaultUnknownValue);
+      m_DEMHandler->GetHeightAboveMSL(&geoPoints[0], &heights[0], lineLength);
       }
+
+    for (unsigned long i = 0; i < lineLength; ++i, ++outIt)
+      {
+      // DEM sets a default value (-32768) at point where it doesn't have altitude information.
+      // OSSIM has chosen to change this default value in OSSIM_DBL_NAN (-4.5036e15).
+      if (!vnl_math_isnan(heights[i]))
+        {
+        // Fill the image
+        outIt.Set(static_cast<PixelType>(heights[i]));
+        }
+      else
+        {
+        // Back to the MNT default value
+        outIt.Set(m_DefaultUnknownValue);
+        }
+      }
+
+    outIt.NextLine();
     progress.CompletedPixel();
     }
 }
@@ -187,6 +260,7 @@ DEMToImageGenerator<TDEMImage>
   os << indent << "Output Spacing:" << m_OutputSpacing[0] << "," << m_OutputSpacing[1] << std::endl;
   os << indent << "Output Origin:" << m_OutputOrigin[0] << "," << m_OutputOrigin[1] << std::endl;
   os << indent << "Output Size:" << m_OutputSize[0] << "," << m_OutputSize[1] << std::endl;
+  os << indent << "DEM cache size:" << m_DEMCacheSize << " MB" << std::endl;
 }
 
 } // namespace otb
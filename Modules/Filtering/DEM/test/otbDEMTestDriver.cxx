@@ -25,6 +25,7 @@ void RegisterTests()
   REGISTER_TEST(otbDEMToImageGeneratorFromImageTest);
   REGISTER_TEST(otbDEMToImageGeneratorNew);
   REGISTER_TEST(otbDEMToImageGeneratorTest);
+  REGISTER_TEST(otbDEMToImageGeneratorPointQueryTest);
   REGISTER_TEST(otbDEMCaracteristicsExtractor);
   REGISTER_TEST(otbDEMCaracteristicsExtractorNew);
 }
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "otbDEMToImageGenerator.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+
+int otbDEMToImageGeneratorPointQueryTest(int argc, char * argv[])
+{
+  if (argc != 11)
+    {
+    std::cout << argv[0] <<
+    " folder path , geoid file , Longitude Output Orign point , Latitude Output Origin point , X Output Size, Y Output size , X Spacing , Y Spacing , DEM cache size (MB) , above ellipsoid"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const unsigned int Dimension = 2;
+  typedef otb::Image<double, Dimension>            ImageType;
+  typedef otb::DEMToImageGenerator<ImageType>      DEMToImageGeneratorType;
+  typedef DEMToImageGeneratorType::PointType       PointType;
+  typedef DEMToImageGeneratorType::SizeType        SizeType;
+  typedef DEMToImageGeneratorType::SpacingType     SpacingType;
+
+  otb::DEMHandler::Pointer demHandler = otb::DEMHandler::Instance();
+  demHandler->OpenDEMDirectory(argv[1]);
+  demHandler->OpenGeoidFile(argv[2]);
+
+  const bool aboveEllipsoid = atoi(argv[10]) != 0;
+
+  PointType origin;
+  origin[0] = ::atof(argv[3]);
+  origin[1] = ::atof(argv[4]);
+
+  SizeType size;
+  size[0] = ::atoi(argv[5]);
+  size[1] = ::atoi(argv[6]);
+
+  SpacingType spacing;
+  spacing[0] = ::atof(argv[7]);
+  spacing[1] = ::atof(argv[8]);
+
+  DEMToImageGeneratorType::Pointer generator = DEMToImageGeneratorType::New();
+  generator->SetOutputOrigin(origin);
+  generator->SetOutputSize(size);
+  generator->SetOutputSpacing(spacing);
+  generator->SetAboveEllipsoid(aboveEllipsoid);
+  generator->SetDEMCacheSize(atoi(argv[9]));
+  generator->Update();
+
+  // The DEM cache of DEMHandler is only enabled during the generation, so
+  // that heights are compared with uncached point queries
+  if (demHandler->GetDEMCacheSize() != 0 || demHandler->IsDEMCacheActive())
+    {
+    std::cerr << "DEM cache of " << demHandler->GetDEMCacheSize()
+              << " MB left enabled by the generator" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Same transform as the generator, for point queries
+  DEMToImageGeneratorType::GenericRSTransformType::Pointer transform
+    = DEMToImageGeneratorType::GenericRSTransformType::New();
+  transform->InstantiateTransform();
+
+  ImageType * output = generator->GetOutput();
+  itk::ImageRegionConstIteratorWithIndex<ImageType> it(output, output->GetLargestPossibleRegion());
+
+  unsigned int nbErrors = 0;
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+    PointType phyPoint;
+    output->TransformIndexToPhysicalPoint(it.GetIndex(), phyPoint);
+    const PointType geoPoint = transform->TransformPoint(phyPoint);
+
+    double height = aboveEllipsoid ? demHandler->GetHeightAboveEllipsoid(geoPoint) : demHandler->GetHeightAboveMSL(geoPoint);
+    if (vnl_math_isnan(height))
+      {
+      height = 0.;
+      }
+
+    if (it.Get() != height)
+      {
+      if (nbErrors < 10)
+        {
+        std::cerr << "Height at " << geoPoint << " is " << it.Get() << " instead of " << height << std::endl;
+        }
+      ++nbErrors;
+      }
+    }
+
+  std::cout << nbErrors << " heights differ from point queries" << std::endl;
+
+  return nbErrors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
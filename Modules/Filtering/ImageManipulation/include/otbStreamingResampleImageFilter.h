@@ -23,7 +23,7 @@
 
 #include "itkImageToImageFilter.h"
 #include "otbStreamingWarpImageFilter.h"
-#include "itkTransformToDisplacementFieldSource.h"
+#include "otbTransformToDisplacementFieldSource.h"
 #include "itkLinearInterpolateImageFunction.h"
 #include "otbImage.h"
 #include "itkVector.h"
@@ -47,7 +47,12 @@ namespace otb
  * the  interpolator (SetInterpolator()) and the origin (SetOrigin())
  * can be set using the method between brackets.
  *
- *
+ * When a positive DisplacementFieldTolerance is set, the displacement
+ * grid is estimated adaptively: the transform is only evaluated where the
+ * bilinear interpolation of the grid would depart from the exact
+ * displacement by more than this tolerance, expressed in input pixels
+ * (see otb::TransformToDisplacementFieldSource). With a null tolerance,
+ * the default, every grid point is transformed.
  *
  * \ingroup Projection
  *
@@ -88,8 +93,8 @@ public:
                                    DisplacementFieldType>        WarpImageFilterType;
 
   /** Internal filters typedefs*/
-  typedef itk::TransformToDisplacementFieldSource<DisplacementFieldType,
-                                                 double>        DisplacementFieldGeneratorType;
+  typedef TransformToDisplacementFieldSource<DisplacementFieldType,
+                                             double>            DisplacementFieldGeneratorType;
   typedef typename DisplacementFieldGeneratorType::TransformType TransformType;
   typedef typename DisplacementFieldGeneratorType::SizeType      SizeType;
   typedef typename DisplacementFieldGeneratorType::SpacingType   SpacingType;
@@ -174,6 +179,16 @@ public:
     m_DisplacementFilter->SetNumberOfThreads(nbThread);
   }
 
+  /** Set/Get the tolerance of the adaptive displacement grid estimation, in
+   *  input pixels. A null tolerance disables the adaptive estimation. */
+  itkSetMacro(DisplacementFieldTolerance, double);
+  itkGetConstMacro(DisplacementFieldTolerance, double);
+
+  /** Set/Get the size of the initial cells of the adaptive estimation, in
+   *  displacement grid points */
+  otbSetObjectMemberMacro(DisplacementFilter, InitialCellSize, unsigned int);
+  otbGetObjectMemberConstMacro(DisplacementFilter, InitialCellSize, unsigned int);
+
   /** Override itk::ProcessObject method to let the internal filter do the propagation */
   void PropagateRequestedRegion(itk::DataObject *output) ITK_OVERRIDE;
 
@@ -195,6 +210,8 @@ private:
 
   typename DisplacementFieldGeneratorType::Pointer   m_DisplacementFilter;
   typename WarpImageFilterType::Pointer             m_WarpFilter;
+
+  double m_DisplacementFieldTolerance;
 };
 
 } // namespace otb
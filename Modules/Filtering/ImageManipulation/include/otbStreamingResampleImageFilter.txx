@@ -24,12 +24,15 @@
 #include "otbStreamingResampleImageFilter.h"
 #include "itkProgressAccumulator.h"
 
+#include <algorithm>
+
 namespace otb
 {
 
 template <class TInputImage, class TOutputImage, class TInterpolatorPrecisionType>
 StreamingResampleImageFilter<TInputImage, TOutputImage, TInterpolatorPrecisionType>
 ::StreamingResampleImageFilter()
+  : m_DisplacementFieldTolerance(0.)
 {
   // internal filters instantiation
   m_DisplacementFilter = DisplacementFieldGeneratorType::New();
@@ -69,8 +72,32 @@ StreamingResampleImageFilter<TInputImage, TOutputImage, TInterpolatorPrecisionTy
   // check the output spacing of the displacement field
   if(this->GetDisplacementFieldSpacing()== itk::NumericTraits<SpacingType>::ZeroValue())
     {
-    this->SetDisplacementFieldSpacing(2.*this->GetOutputSpacing());
+    // The adaptive estimation only transforms the points it needs, so
+    // the grid can be as fine as the output
+    if (m_DisplacementFieldTolerance > 0.)
+      {
+      this->SetDisplacementFieldSpacing(this->GetOutputSpacing());
+      }
+    else
+      {
+      this->SetDisplacementFieldSpacing(2.*this->GetOutputSpacing());
+      }
+    }
+
+  // Tolerance of the adaptive estimation, from input pixels to
+  // physical units
+  double tolerance = 0.;
+  if (m_DisplacementFieldTolerance > 0. && this->GetInput())
+    {
+    const typename InputImageType::SpacingType & inputSpacing = this->GetInput()->GetSpacing();
+    double minSpacing = vcl_abs(inputSpacing[0]);
+    for(unsigned int dim = 1; dim < InputImageType::ImageDimension; ++dim)
+      {
+      minSpacing = std::min(minSpacing, static_cast<double>(vcl_abs(inputSpacing[dim])));
+      }
+    tolerance = m_DisplacementFieldTolerance * minSpacing;
     }
+  m_DisplacementFilter->SetTolerance(tolerance);
 
   // Retrieve output largest region
   SizeType largestSize       = this->GetOutputSize();
@@ -137,6 +164,7 @@ StreamingResampleImageFilter<TInputImage, TOutputImage, TInterpolatorPrecisionTy
   os << indent << "OutputSpacing: " << this->GetOutputSpacing() << std::endl;
   os << indent << "OutputStartIndex: " << this->GetOutputStartIndex() << std::endl;
   os << indent << "OutputSize: " << this->GetOutputSize() << std::endl;
+  os << indent << "DisplacementFieldTolerance: " << m_DisplacementFieldTolerance << std::endl;
 }
 
 
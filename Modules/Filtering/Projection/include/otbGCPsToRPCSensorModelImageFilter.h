@@ -58,6 +58,13 @@ namespace otb {
  * The RMS (root mean square) ground error is available through the
  * appropriate getter.
  *
+ * If UseNativeSolver is set to true, the estimation goes through the
+ * normal equations solver of RPCSolverAdapter instead of the OSSIM
+ * one. This solver can reject outlier GCPs with RANSAC: set a
+ * positive RANSACThreshold (in pixels) to enable it. The GCPs kept by
+ * the final fit are flagged in the inliers container, and the time
+ * spent in the estimation is reported by GetEstimationTime().
+ *
  * Please note that GCPs are inferred to be given in physical
  * coordinates. This is seamless in most cases.
  *
@@ -92,6 +99,7 @@ public:
   typedef std::pair<Point2DType, Point3DType> GCPType;
   typedef std::vector<GCPType>                GCPsContainerType;
   typedef std::vector<double>                 ErrorsContainerType;
+  typedef std::vector<bool>                   InliersContainerType;
 
   typedef itk::ContinuousIndex<>          ContinuousIndexType;
   typedef itk::ContinuousIndex<double, 3> Continuous3DIndexType;
@@ -130,9 +138,38 @@ public:
   itkSetObjectMacro(DEMHandler, DEMHandlerType);
   itkGetObjectMacro(DEMHandler, DEMHandlerType);
 
+  /** Set/Get/toogle the UseNativeSolver flag */
+  itkSetMacro(UseNativeSolver, bool);
+  itkGetMacro(UseNativeSolver, bool);
+  itkBooleanMacro(UseNativeSolver);
+
+  /** Set/Get the RANSAC inlier threshold, in pixels (native solver
+   *  only). RANSAC is disabled if it is not strictly positive. */
+  itkSetMacro(RANSACThreshold, double);
+  itkGetConstReferenceMacro(RANSACThreshold, double);
+
+  /** Set/Get the number of RANSAC draws (native solver only) */
+  itkSetMacro(RANSACIterations, unsigned int);
+  itkGetConstReferenceMacro(RANSACIterations, unsigned int);
+
   /** Get the residual ground error */
   itkGetConstReferenceMacro(RMSGroundError, double);
 
+  /** Get the flags of the GCPs used by the last estimation */
+  const InliersContainerType& GetInliersContainer() const
+  {
+    return m_InliersContainer;
+  }
+
+  /** Get the number of GCPs used by the last estimation */
+  itkGetConstReferenceMacro(NumberOfInliers, unsigned int);
+
+  /** Get the maximum error */
+  itkGetConstReferenceMacro(MaximumError, double);
+
+  /** Get the time spent in the last estimation, in seconds */
+  itkGetConstReferenceMacro(EstimationTime, double);
+
   /** Get the Error container */
   ErrorsContainerType& GetErrorsContainer();
 
@@ -201,6 +238,23 @@ private:
   /** The mean error */
   double m_MeanError;
 
+  /** The maximum error */
+  double m_MaximumError;
+
+  /** True to use the native solver instead of the OSSIM one */
+  bool m_UseNativeSolver;
+
+  /** RANSAC parameters of the native solver */
+  double       m_RANSACThreshold;
+  unsigned int m_RANSACIterations;
+
+  /** Flags of the GCPs used by the estimation */
+  InliersContainerType m_InliersContainer;
+  unsigned int         m_NumberOfInliers;
+
+  /** Time spent in the estimation */
+  double m_EstimationTime;
+
   /** True if a DEM should be used */
   bool m_UseDEM;
 
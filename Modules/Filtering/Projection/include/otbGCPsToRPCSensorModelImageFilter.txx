@@ -27,8 +27,11 @@
 #include "otbGenericRSTransform.h"
 
 #include "itkMetaDataObject.h"
+#include "itkTimeProbe.h"
 #include "otbMetaDataKey.h"
 
+#include <algorithm>
+
 namespace otb {
 
 template <class TImage>
@@ -37,6 +40,13 @@ GCPsToRPCSensorModelImageFilter<TImage>
   m_RMSGroundError(0.),
   m_ErrorsContainer(),
   m_MeanError(0.),
+  m_MaximumError(0.),
+  m_UseNativeSolver(false),
+  m_RANSACThreshold(0.),
+  m_RANSACIterations(1000),
+  m_InliersContainer(),
+  m_NumberOfInliers(0),
+  m_EstimationTime(0.),
   m_UseDEM(false),
   m_MeanElevation(0.),
   m_DEMHandler(),
@@ -256,6 +266,7 @@ GCPsToRPCSensorModelImageFilter<TImage>
 
   double sum = 0.;
   m_MeanError = 0.;
+  m_MaximumError = 0.;
 
   // Clear Error container
   m_ErrorsContainer.clear();
@@ -293,6 +304,7 @@ GCPsToRPCSensorModelImageFilter<TImage>
 
     // Compute mean error
     sum += error;
+    m_MaximumError = std::max(m_MaximumError, error);
     }
 
   m_MeanError = sum / static_cast<double>(m_ErrorsContainer.size());
@@ -313,15 +325,37 @@ GCPsToRPCSensorModelImageFilter<TImage>
     {
     double rmsError;
     ImageKeywordlist otb_kwl;
-    otb::RPCSolverAdapter::Solve(m_GCPsContainer, rmsError, otb_kwl);
+
+    itk::TimeProbe chrono;
+    chrono.Start();
+
+    if (m_UseNativeSolver)
+      {
+      otb::RPCSolverAdapter::Solve(m_GCPsContainer, m_RANSACThreshold, m_RANSACIterations,
+                                   rmsError, m_InliersContainer, otb_kwl);
+      }
+    else
+      {
+      otb::RPCSolverAdapter::Solve(m_GCPsContainer, rmsError, otb_kwl);
+      m_InliersContainer.assign(m_GCPsContainer.size(), true);
+      }
+
+    chrono.Stop();
+    m_EstimationTime = chrono.GetTotal();
+    m_NumberOfInliers = std::count(m_InliersContainer.begin(), m_InliersContainer.end(), true);
 
     // Retrieve the residual ground error
     m_RMSGroundError = rmsError;
 
+    // Errors are computed with the estimated model
+    m_Keywordlist = otb_kwl;
+
     // Compute errors
     this->ComputeErrors();
 
-    m_Keywordlist = otb_kwl;
+    otbMsgDevMacro(<<"RPC model estimated from "<<m_NumberOfInliers<<" out of "<<m_GCPsContainer.size()
+                   <<" GCPs in "<<m_EstimationTime<<" s. RMS error: "<<m_RMSGroundError
+                   <<", mean error: "<<m_MeanError<<", maximum error: "<<m_MaximumError);
 
     m_ModelUpToDate = true;
     }
@@ -345,7 +379,15 @@ GCPsToRPCSensorModelImageFilter<TImage>
     {
     os << indent << "MeanElevation: " << m_MeanElevation << std::endl;
     }
+  os << indent << "UseNativeSolver: " << (m_UseNativeSolver ? "yes" : "no") << std::endl;
+  if (m_UseNativeSolver)
+    {
+    os << indent << "RANSACThreshold: " << m_RANSACThreshold << std::endl;
+    os << indent << "RANSACIterations: " << m_RANSACIterations << std::endl;
+    }
   os << indent << "RMS ground error: " << m_RMSGroundError << std::endl;
+  os << indent << "Number of inliers: " << m_NumberOfInliers << std::endl;
+  os << indent << "Estimation time: " << m_EstimationTime << " s" << std::endl;
 }
 
 } // end of namespace otb
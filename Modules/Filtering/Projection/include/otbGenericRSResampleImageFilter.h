@@ -99,6 +99,7 @@ public:
     */
   typedef GenericRSTransform<>                       GenericRSTransformType;
   typedef typename GenericRSTransformType::Pointer   GenericRSTransformPointerType;
+  typedef GenericRSTransformType::LocalisationGridType LocalisationGridType;
 
   typedef itk::ImageBase<OutputImageType::ImageDimension>      ImageBaseType;
 
@@ -109,6 +110,11 @@ public:
                                         DisplacementFieldSpacing,
                                         SpacingType);
 
+  /** Tolerance of the adaptive displacement field estimation, in input
+   *  pixels (0 to transform every grid point) */
+  otbSetObjectMemberMacro(Resampler, DisplacementFieldTolerance, double);
+  otbGetObjectMemberConstMacro(Resampler, DisplacementFieldTolerance, double);
+
   /** The resampled image parameters */
   /** Output Origin */
   void SetOutputOrigin(const OriginType & origin)
@@ -197,6 +203,28 @@ public:
     return m_Transform->GetInputKeywordList();
   }
 
+  /** Set/Get the localisation grid of the input sensor model */
+  void SetInputLocalisationGrid(const LocalisationGridType * grid)
+  {
+    m_Transform->SetOutputLocalisationGrid(grid);
+    this->Modified();
+  }
+  const LocalisationGridType * GetInputLocalisationGrid() const
+  {
+    return m_Transform->GetOutputLocalisationGrid();
+  }
+
+  /** Set/Get the localisation grid of the output sensor model */
+  void SetOutputLocalisationGrid(const LocalisationGridType * grid)
+  {
+    m_Transform->SetInputLocalisationGrid(grid);
+    this->Modified();
+  }
+  const LocalisationGridType * GetOutputLocalisationGrid() const
+  {
+    return m_Transform->GetInputLocalisationGrid();
+  }
+
   /** Useful to set the output parameters from an existing image*/
   void SetOutputParametersFromImage(const ImageBaseType * image);
 
@@ -26,9 +26,12 @@
 #include "otbImageReference.h"
 #include "itkTransform.h"
 #include "otbGenericRSTransform.h"
+#include "itkMultiThreader.h"
 
 #include "OTBProjectionExport.h"
 
+#include <vector>
+
 class OGRCoordinateTransformation;
 
 namespace otb
@@ -98,6 +101,7 @@ private:
   // void do_transform(OGRLinearRing         & g) const;
   /**
    * Transforms all the points from a line-string, thanks to \c m_Transform.
+   * The points are transformed in a single batch.
    * \param[in,out] g  line-string to transform
    * \throw Whatever is thrown by \c m_Transform::operator()
    */
@@ -154,6 +158,11 @@ private:
  * \note This filter does not support \em in-place transformation as the spatial
  * references of the new layer are expected to change.
  *
+ * Features are read, projected and written by chunks of \em FeatureChunkSize
+ * features, so that the memory footprint does not depend on the size of the
+ * layers. The geometries of a chunk are projected in parallel, each thread
+ * working with its own copy of the transform.
+ *
  * \ingroup OTBProjection
  */
 class OTBProjection_EXPORT GeometriesProjectionFilter : public GeometriesToGeometriesFilter
@@ -263,6 +272,10 @@ public:
   itkGetStringMacro(OutputProjectionRef);
   //@}
 
+  /** Set/Get the number of features projected at once (10000 by default) */
+  itkSetMacro(FeatureChunkSize, unsigned int);
+  itkGetConstMacro(FeatureChunkSize, unsigned int);
+
 private:
   /**\name Functor definition */
   //@{
@@ -274,6 +287,26 @@ private:
   TransformationFunctorDispatcherType             m_TransformationFunctor;
   //@}
 
+  /**\name Parallel projection of the features */
+  //@{
+  typedef std::vector<TransformationFunctorType>  TransformationFunctorListType;
+
+  /** Project the geometries of a chunk of features and write them to the
+   * destination layer, in the order of the chunk */
+  void ProcessChunk(std::vector<ogr::Feature> const& chunk, ogr::Layer & destination,
+                    TransformationFunctorListType const& functors) const;
+
+  /** Static function used as a "callback" by the MultiThreader */
+  static ITK_THREAD_RETURN_TYPE ThreaderCallback(void *arg);
+
+  /** Internal structure used for passing data to the threads */
+  struct ThreadStruct
+    {
+    TransformationFunctorListType const* Functors;
+    std::vector<OGRGeometry*> *          Geometries;
+    };
+  //@}
+
   /**\name 1 Point Transformation definition */
   //@{
   typedef TransformationFunctorType::InternalTransformType        InternalTransformType;
@@ -291,6 +324,7 @@ private:
   std::string                                     m_OutputProjectionRef; // in WKT format!
   ImageKeywordlist                                m_InputKeywordList;
   ImageKeywordlist                                m_OutputKeywordList;
+  unsigned int                                    m_FeatureChunkSize;
 };
 } // end namespace otb
 
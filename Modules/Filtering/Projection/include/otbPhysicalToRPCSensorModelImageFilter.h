@@ -23,6 +23,9 @@
 
 #include "otbGCPsToRPCSensorModelImageFilter.h"
 #include "otbGenericRSTransform.h"
+#include "itkMultiThreader.h"
+
+#include <vector>
 
 
 namespace otb {
@@ -48,6 +51,12 @@ namespace otb {
  * Depending on the value of the DEMDirectory, an elevation fetched
  * from the SRT directory is used.(TODO)
  *
+ * The grid points are projected in parallel, each thread working on
+ * its own copy of the sensor model. The estimation itself is done by
+ * an internal GCPsToRPCSensorModelImageFilter, whose solver options
+ * are forwarded, and whose accuracy and timing figures can be read
+ * through GetGCPsToSensorModelFilter().
+ *
  * This filter does not modify the image buffer, but only the
  * metadata. Therefore, it provides in-place support, which is
  * enabled by default. Call InPlaceOff() to change the default
@@ -109,6 +118,35 @@ public:
       }
   }
 
+  /** Set/Get the use of the native RPC solver */
+  void SetUseNativeSolver(bool use)
+  {
+    m_GCPsToSensorModelFilter->SetUseNativeSolver(use);
+    this->Modified();
+  }
+  bool GetUseNativeSolver() const
+  {
+    return m_GCPsToSensorModelFilter->GetUseNativeSolver();
+  }
+  itkBooleanMacro(UseNativeSolver);
+
+  /** Set/Get the RANSAC inlier threshold of the native solver, in pixels */
+  void SetRANSACThreshold(double threshold)
+  {
+    m_GCPsToSensorModelFilter->SetRANSACThreshold(threshold);
+    this->Modified();
+  }
+  double GetRANSACThreshold() const
+  {
+    return m_GCPsToSensorModelFilter->GetRANSACThreshold();
+  }
+
+  /** Get the internal rpc model estimator, to read the estimation errors */
+  itkGetConstObjectMacro(GCPsToSensorModelFilter, GCPsToSensorModelType);
+
+  /** Get the time spent projecting the grid points, in seconds */
+  itkGetConstReferenceMacro(GridGenerationTime, double);
+
   /** Reimplement the method Modified() */
   void Modified() const ITK_OVERRIDE;
 
@@ -128,10 +166,23 @@ private:
   PhysicalToRPCSensorModelImageFilter(const Self &);   // purposely not implemented
   void operator =(const Self&);    // purposely not implemented
 
+  /** Static function used as a "callback" by the MultiThreader to
+   * project the grid points */
+  static ITK_THREAD_RETURN_TYPE GridThreaderCallback(void *arg);
+
+  /** Internal structure used for passing data into the threading library */
+  struct ThreadStruct
+  {
+    std::vector<RSTransformPointerType> Transforms;
+    const std::vector<PointType> *      InputPoints;
+    std::vector<PointType> *            OutputPoints;
+  };
+
   /** The rpc model estimator */
   GCPsToSensorModelPointerType       m_GCPsToSensorModelFilter;
 
   SizeType                           m_GridSize;
+  double                             m_GridGenerationTime;
   mutable bool                       m_OutputInformationGenerated;
 
 };
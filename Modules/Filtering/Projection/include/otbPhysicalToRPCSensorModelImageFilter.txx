@@ -23,6 +23,9 @@
 
 #include "otbPhysicalToRPCSensorModelImageFilter.h"
 #include "otbDEMHandler.h"
+#include "itkTimeProbe.h"
+
+#include <algorithm>
 
 namespace otb {
 
@@ -41,6 +44,7 @@ PhysicalToRPCSensorModelImageFilter<TImage>
   // Initialize the gridSize : 16 points to have a correct estimation
   // of the model
   m_GridSize.Fill(4);
+  m_GridGenerationTime = 0.;
 
   // Flag initilalisation
   m_OutputInformationGenerated = false;
@@ -76,6 +80,8 @@ PhysicalToRPCSensorModelImageFilter<TImage>
     double gridSpacingX = size[0]/m_GridSize[0];
     double gridSpacingY = size[1]/m_GridSize[1];
 
+    std::vector<PointType> inputPoints;
+    inputPoints.reserve(m_GridSize[0] * m_GridSize[1]);
     for(unsigned int px = 0; px<m_GridSize[0]; ++px)
       {
       for(unsigned int py = 0; py<m_GridSize[1]; ++py)
@@ -83,16 +89,57 @@ PhysicalToRPCSensorModelImageFilter<TImage>
         PointType inputPoint =  input->GetOrigin();
         inputPoint[0] += (px * gridSpacingX + 0.5) * input->GetSpacing()[0];
         inputPoint[1] += (py * gridSpacingY + 0.5) * input->GetSpacing()[1];
-        PointType outputPoint = rsTransform->TransformPoint(inputPoint);
-        m_GCPsToSensorModelFilter->AddGCP(inputPoint, outputPoint);
+        inputPoints.push_back(inputPoint);
+        }
+      }
+    std::vector<PointType> outputPoints(inputPoints.size());
+
+    itk::TimeProbe chrono;
+    chrono.Start();
+
+    // Project the grid points in parallel, each thread with its own
+    // copy of the sensor model
+    unsigned int nbThreads = std::max(1u, std::min<unsigned int>(this->GetNumberOfThreads(), inputPoints.size()));
+
+    ThreadStruct str;
+    str.InputPoints = &inputPoints;
+    str.OutputPoints = &outputPoints;
+    str.Transforms.push_back(rsTransform);
+    for(unsigned int thread = 1; thread < nbThreads; ++thread)
+      {
+      RSTransformPointerType clone = dynamic_cast<RSTransformType *>(rsTransform->Clone().GetPointer());
+      if (clone.IsNull())
+        {
+        // The sensor model can not be shared: project with a single thread
+        otbGenericMsgDebugMacro(<<"Sensor model can not be cloned, the grid is projected with a single thread");
+        nbThreads = 1;
+        str.Transforms.resize(1);
+        break;
         }
+      str.Transforms.push_back(clone);
+      }
+
+    this->GetMultiThreader()->SetNumberOfThreads(nbThreads);
+    this->GetMultiThreader()->SetSingleMethod(this->GridThreaderCallback, &str);
+    this->GetMultiThreader()->SingleMethodExecute();
+
+    chrono.Stop();
+    m_GridGenerationTime = chrono.GetTotal();
+
+    m_GCPsToSensorModelFilter->ClearGCPs();
+    for(unsigned int i = 0; i < inputPoints.size(); ++i)
+      {
+      m_GCPsToSensorModelFilter->AddGCP(inputPoints[i], outputPoints[i]);
       }
 
     m_GCPsToSensorModelFilter->SetInput(input);
     m_GCPsToSensorModelFilter->UpdateOutputInformation();
 
     otbGenericMsgDebugMacro(<<"RPC model estimated. RMS ground error: "<<m_GCPsToSensorModelFilter->GetRMSGroundError()
-             <<", Mean error: "<<m_GCPsToSensorModelFilter->GetMeanError());
+             <<", Mean error: "<<m_GCPsToSensorModelFilter->GetMeanError()
+             <<", Maximum error: "<<m_GCPsToSensorModelFilter->GetMaximumError()
+             <<", Grid generation time: "<<m_GridGenerationTime<<" s"
+             <<", Estimation time: "<<m_GCPsToSensorModelFilter->GetEstimationTime()<<" s");
 
     // Encapsulate the keywordlist
     itk::MetaDataDictionary& dict = this->GetOutput()->GetMetaDataDictionary();
@@ -104,6 +151,31 @@ PhysicalToRPCSensorModelImageFilter<TImage>
     }
 }
 
+template <class TImage>
+ITK_THREAD_RETURN_TYPE
+PhysicalToRPCSensorModelImageFilter<TImage>
+::GridThreaderCallback(void *arg)
+{
+  ThreadStruct *str;
+  int           threadId, threadCount;
+
+  threadId = ((itk::MultiThreader::ThreadInfoStruct *) (arg))->ThreadID;
+  threadCount = ((itk::MultiThreader::ThreadInfoStruct *) (arg))->NumberOfThreads;
+  str = (ThreadStruct *) (((itk::MultiThreader::ThreadInfoStruct *) (arg))->UserData);
+
+  // Contiguous chunks, so that each thread benefits from batch projections
+  const unsigned long nbPoints = str->InputPoints->size();
+  const unsigned long start = nbPoints * threadId / threadCount;
+  const unsigned long end = nbPoints * (threadId + 1) / threadCount;
+
+  if (end > start && static_cast<unsigned int>(threadId) < str->Transforms.size())
+    {
+    str->Transforms[threadId]->TransformPoints(&(*str->InputPoints)[start], &(*str->OutputPoints)[start], end - start);
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
 template <class TImage>
 void
 PhysicalToRPCSensorModelImageFilter<TImage>
@@ -119,6 +191,8 @@ PhysicalToRPCSensorModelImageFilter<TImage>
 ::PrintSelf(std::ostream& os, itk::Indent indent) const
 {
   Superclass::PrintSelf(os, indent);
+  os << indent << "GridSize: " << m_GridSize << std::endl;
+  os << indent << "Grid generation time: " << m_GridGenerationTime << " s" << std::endl;
 }
 
 } // end of namespace otb
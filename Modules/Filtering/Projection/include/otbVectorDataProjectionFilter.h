@@ -24,6 +24,9 @@
 #include "otbVectorDataToVectorDataFilter.h"
 #include "otbGenericRSTransform.h"
 #include "otbImageKeywordlist.h"
+#include "itkMultiThreader.h"
+
+#include <vector>
 
 namespace otb
 {
@@ -46,6 +49,12 @@ namespace otb
   * Each of this step is optional and would default to an identity transform if nothing
   * is specified.
   *
+  * The structure of the input tree is first copied, then the features are
+  * projected in parallel: they are split among threads according to their
+  * number of vertices, and each thread projects the vertices of consecutive
+  * features in batches of BatchSize vertices, with its own copy of the
+  * transform.
+  *
   * The offset/scaling steps are necessary only when working with the local coordinate
   * system of the image (origin on the top left). The value need to be provided by the
   * SetInputSpacing, SetInputOrigin, SetOutputSpacing and SetOutputOrigin methods.
@@ -86,6 +95,8 @@ public:
 //   typedef otb::CompositeTransform<GenericTransformType, GenericTransformType, double, 2, 2> InternalTransformType;
   typedef otb::GenericRSTransform<double, 2, 2>   InternalTransformType;
   typedef typename InternalTransformType::Pointer InternalTransformPointerType;
+  typedef typename InternalTransformType::InputPointType  TransformInputPointType;
+  typedef typename InternalTransformType::OutputPointType TransformOutputPointType;
 
   typedef itk::Vector<double, 2> SpacingType;
   typedef itk::Point<double, 2>  OriginType;
@@ -96,6 +107,9 @@ public:
   typedef typename InputVectorDataType::DataTreeType::TreeNodeType  InputInternalTreeNodeType;
   typedef typename OutputVectorDataType::DataTreeType::TreeNodeType OutputInternalTreeNodeType;
 
+  typedef typename InputVectorDataType::DataNodePointerType  InputDataNodePointerType;
+  typedef typename OutputVectorDataType::DataNodePointerType OutputDataNodePointerType;
+
   typedef typename InputDataNodeType::PointType        InputPointType;
   typedef typename InputDataNodeType::LineType         InputLineType;
   typedef typename InputDataNodeType::PolygonType      InputPolygonType;
@@ -173,6 +187,10 @@ public:
 
   itkGetConstReferenceMacro(OutputSpacing, SpacingType);
 
+  /** Set/Get the number of vertices projected at once by each thread */
+  itkSetMacro(BatchSize, unsigned int);
+  itkGetConstMacro(BatchSize, unsigned int);
+
 protected:
   VectorDataProjectionFilter();
   ~VectorDataProjectionFilter() ITK_OVERRIDE {}
@@ -182,6 +200,55 @@ protected:
   OutputPolygonPointerType ProcessPolygon(InputPolygonPointerType polygon) const ITK_OVERRIDE;
   OutputPolygonListPointerType ProcessPolygonList(InputPolygonListPointerType polygonList) const ITK_OVERRIDE;
 
+  /** Project the vertices of a line or a polygon in a single batch */
+  template <class TVertexIterator>
+  void ProcessVertices(TVertexIterator begin, TVertexIterator end,
+                       std::vector<TransformInputPointType>& points,
+                       std::vector<TransformOutputPointType>& projectedPoints) const;
+
+  /** Append the vertices of a line or a polygon to a batch */
+  template <class TVertexIterator>
+  static void AppendVertices(TVertexIterator begin, TVertexIterator end,
+                             std::vector<TransformInputPointType>& points);
+
+  /** Feature of the input tree and the output node it is projected into */
+  struct FeatureType
+  {
+    InputDataNodePointerType  Input;
+    OutputDataNodePointerType Output;
+  };
+  typedef std::vector<FeatureType> FeatureListType;
+
+  /** Copy the structure of the input tree to the output tree, gathering the
+   * features whose geometries are to be projected */
+  void CopyTree(InputInternalTreeNodeType * source, OutputInternalTreeNodeType * destination,
+                FeatureListType& features) const;
+
+  /** Project the geometries of the features in [begin, end) */
+  void ProcessFeatures(const FeatureListType& features, unsigned long begin, unsigned long end,
+                       const InternalTransformType * transform) const;
+
+  /** Vertices of the geometry of a feature */
+  static unsigned long GetNumberOfVertices(const InputDataNodeType * node);
+  static void AppendFeatureVertices(const InputDataNodeType * node,
+                                    std::vector<TransformInputPointType>& points);
+
+  /** Set the geometry of an output feature from projected vertices */
+  void SetFeatureGeometry(const FeatureType& feature,
+                          typename std::vector<TransformOutputPointType>::const_iterator& pointIt) const;
+
+  /** Static function used as a "callback" by the MultiThreader */
+  static ITK_THREAD_RETURN_TYPE ThreaderCallback(void *arg);
+
+  /** Internal structure used for passing data to the threads */
+  struct ThreadStruct
+  {
+    const Self *                              Filter;
+    const FeatureListType *                   Features;
+    const std::vector<unsigned long> *        VertexOffsets;
+    std::vector<InternalTransformPointerType> Transforms;
+  };
+
   virtual void InstantiateTransform(void);
 
   void GenerateOutputInformation(void) ITK_OVERRIDE;
@@ -202,6 +269,7 @@ private:
   SpacingType m_OutputSpacing;
   OriginType  m_OutputOrigin;
 
+  unsigned int m_BatchSize;
 };
 
 } // end namespace otb
@@ -27,6 +27,9 @@
 #include "otbMetaDataKey.h"
 #include "itkTimeProbe.h"
 
+#include <algorithm>
+#include <vector>
+
 namespace otb
 {
 /**
@@ -44,6 +47,7 @@ VectorDataProjectionFilter<TInputVectorData, TOutputVectorData>
   m_InputOrigin.Fill(0);
   m_OutputSpacing.Fill(1);
   m_OutputOrigin.Fill(0);
+  m_BatchSize = 4096;
 }
 
 //----------------------------------------------------------------------------
@@ -190,6 +194,46 @@ VectorDataProjectionFilter<TInputVectorData, TOutputVectorData>
   return point;
 }
 
+/**
+ * Convert a list of vertices
+ */
+template <class TInputVectorData, class TOutputVectorData>
+template <class TVertexIterator>
+void
+VectorDataProjectionFilter<TInputVectorData, TOutputVectorData>
+::ProcessVertices(TVertexIterator begin, TVertexIterator end,
+                  std::vector<TransformInputPointType>& points,
+                  std::vector<TransformOutputPointType>& projectedPoints) const
+{
+  points.clear();
+  AppendVertices(begin, end, points);
+
+  projectedPoints.resize(points.size());
+  if (!points.empty())
+    {
+    m_Transform->TransformPoints(&points[0], &projectedPoints[0], points.size());
+    }
+}
+
+/**
+ * Append a list of vertices to a batch
+ */
+template <class TInputVectorData, class TOutputVectorData>
+template <class TVertexIterator>
+void
+VectorDataProjectionFilter<TInputVectorData, TOutputVectorData>
+::AppendVertices(TVertexIterator begin, TVertexIterator end,
+                 std::vector<TransformInputPointType>& points)
+{
+  for (TVertexIterator it = begin; it != end; ++it)
+    {
+    TransformInputPointType point;
+    point[0] = it.Value()[0];
+    point[1] = it.Value()[1];
+    points.push_back(point);
+    }
+}
+
 /**
  * Convert line
  */
@@ -199,21 +243,21 @@ VectorDataProjectionFilter<TInputVectorData, TOutputVectorData>
 ::ProcessLine(InputLinePointerType line) const
 {
   typedef typename InputLineType::VertexListType::ConstPointer VertexListConstPointerType;
-  typedef typename InputLineType::VertexListConstIteratorType  VertexListConstIteratorType;
   VertexListConstPointerType  vertexList = line->GetVertexList();
-  VertexListConstIteratorType it = vertexList->Begin();
   typename OutputLineType::Pointer  newLine = OutputLineType::New();
-  while (it != vertexList->End())
+
+  // Vertices are projected in a single batch
+  std::vector<TransformInputPointType>  points;
+  std::vector<TransformOutputPointType> projectedPoints;
+  this->ProcessVertices(vertexList->Begin(), vertexList->End(), points, projectedPoints);
+
+  for (typename std::vector<TransformOutputPointType>::const_iterator it = projectedPoints.begin();
+       it != projectedPoints.end(); ++it)
     {
-    itk::Point<double, 2>           point;
     itk::ContinuousIndex<double, 2> index;
-    typename InputLineType::VertexType   pointCoord = it.Value();
-    point = m_Transform->TransformPoint(pointCoord);
-    index[0] = point[0];
-    index[1] = point[1];
-//       otbMsgDevMacro(<< "Converting: " << it.Value() << " -> " << pointCoord << " -> " << point << " -> " << index);
+    index[0] = (*it)[0];
+    index[1] = (*it)[1];
     newLine->AddVertex(index);
-    ++it;
     }
 
   return newLine;
@@ -228,20 +272,21 @@ VectorDataProjectionFilter<TInputVectorData, TOutputVectorData>
 ::ProcessPolygon(InputPolygonPointerType polygon) const
 {
   typedef typename InputPolygonType::VertexListType::ConstPointer VertexListConstPointerType;
-  typedef typename InputPolygonType::VertexListConstIteratorType  VertexListConstIteratorType;
   VertexListConstPointerType    vertexList = polygon->GetVertexList();
-  VertexListConstIteratorType   it = vertexList->Begin();
   typename OutputPolygonType::Pointer newPolygon = OutputPolygonType::New();
-  while (it != vertexList->End())
+
+  // Vertices are projected in a single batch
+  std::vector<TransformInputPointType>  points;
+  std::vector<TransformOutputPointType> projectedPoints;
+  this->ProcessVertices(vertexList->Begin(), vertexList->End(), points, projectedPoints);
+
+  for (typename std::vector<TransformOutputPointType>::const_iterator it = projectedPoints.begin();
+       it != projectedPoints.end(); ++it)
     {
-    itk::Point<double, 2>            point;
-    itk::ContinuousIndex<double, 2>  index;
-    typename InputPolygonType::VertexType pointCoord = it.Value();
-    point = m_Transform->TransformPoint(pointCoord);
-    index[0] = point[0];
-    index[1] = point[1];
+    itk::ContinuousIndex<double, 2> index;
+    index[0] = (*it)[0];
+    index[1] = (*it)[1];
     newPolygon->AddVertex(index);
-    ++it;
     }
   return newPolygon;
 }
@@ -327,6 +372,269 @@ VectorDataProjectionFilter<TInputVectorData, TOutputVectorData>
 
 }
 
+/**
+ * Copy the tree structure, gathering the features to project
+ */
+template <class TInputVectorData, class TOutputVectorData>
+void
+VectorDataProjectionFilter<TInputVectorData, TOutputVectorData>
+::CopyTree(InputInternalTreeNodeType * source, OutputInternalTreeNodeType * destination,
+           FeatureListType& features) const
+{
+  typedef typename InputInternalTreeNodeType::ChildrenListType InputChildrenListType;
+  InputChildrenListType children = source->GetChildrenList();
+
+  for (typename InputChildrenListType::const_iterator it = children.begin(); it != children.end(); ++it)
+    {
+    // Copy input DataNode info
+    InputDataNodePointerType  dataNode = (*it)->Get();
+    OutputDataNodePointerType newDataNode = OutputDataNodeType::New();
+    newDataNode->SetNodeType(dataNode->GetNodeType());
+    newDataNode->SetNodeId(dataNode->GetNodeId());
+    newDataNode->SetMetaDataDictionary(dataNode->GetMetaDataDictionary());
+
+    typename OutputInternalTreeNodeType::Pointer newContainer = OutputInternalTreeNodeType::New();
+    newContainer->Set(newDataNode);
+    destination->AddChild(newContainer);
+
+    switch (dataNode->GetNodeType())
+      {
+      case FEATURE_POINT:
+      case FEATURE_LINE:
+      case FEATURE_POLYGON:
+        {
+        // Geometries are projected later on
+        FeatureType feature;
+        feature.Input = dataNode;
+        feature.Output = newDataNode;
+        features.push_back(feature);
+        break;
+        }
+      default:
+        {
+        this->CopyTree(*it, newContainer, features);
+        break;
+        }
+      }
+    }
+}
+
+template <class TInputVectorData, class TOutputVectorData>
+unsigned long
+VectorDataProjectionFilter<TInputVectorData, TOutputVectorData>
+::GetNumberOfVertices(const InputDataNodeType * node)
+{
+  switch (node->GetNodeType())
+    {
+    case FEATURE_POINT:
+      {
+      return 1;
+      }
+    case FEATURE_LINE:
+      {
+      return node->GetLine()->GetVertexList()->Size();
+      }
+    case FEATURE_POLYGON:
+      {
+      unsigned long nbVertices = node->GetPolygonExteriorRing()->GetVertexList()->Size();
+      InputPolygonListPointerType interiorRings = node->GetPolygonInteriorRings();
+      for (typename InputPolygonListType::ConstIterator it = interiorRings->Begin(); it != interiorRings->End(); ++it)
+        {
+        nbVertices += it.Get()->GetVertexList()->Size();
+        }
+      return nbVertices;
+      }
+    default:
+      {
+      return 0;
+      }
+    }
+}
+
+template <class TInputVectorData, class TOutputVectorData>
+void
+VectorDataProjectionFilter<TInputVectorData, TOutputVectorData>
+::AppendFeatureVertices(const InputDataNodeType * node, std::vector<TransformInputPointType>& points)
+{
+  switch (node->GetNodeType())
+    {
+    case FEATURE_POINT:
+      {
+      TransformInputPointType point;
+      point[0] = node->GetPoint()[0];
+      point[1] = node->GetPoint()[1];
+      points.push_back(point);
+      break;
+      }
+    case FEATURE_LINE:
+      {
+      typename InputLineType::VertexListType::ConstPointer vertexList = node->GetLine()->GetVertexList();
+      AppendVertices(vertexList->Begin(), vertexList->End(), points);
+      break;
+      }
+    case FEATURE_POLYGON:
+      {
+      typename InputPolygonType::VertexListType::ConstPointer vertexList =
+        node->GetPolygonExteriorRing()->GetVertexList();
+      AppendVertices(vertexList->Begin(), vertexList->End(), points);
+
+      InputPolygonListPointerType interiorRings = node->GetPolygonInteriorRings();
+      for (typename InputPolygonListType::ConstIterator it = interiorRings->Begin(); it != interiorRings->End(); ++it)
+        {
+        vertexList = it.Get()->GetVertexList();
+        AppendVertices(vertexList->Begin(), vertexList->End(), points);
+        }
+      break;
+      }
+    default:
+      {
+      break;
+      }
+    }
+}
+
+template <class TInputVectorData, class TOutputVectorData>
+void
+VectorDataProjectionFilter<TInputVectorData, TOutputVectorData>
+::SetFeatureGeometry(const FeatureType& feature,
+                     typename std::vector<TransformOutputPointType>::const_iterator& pointIt) const
+{
+  const InputDataNodeType * input = feature.Input;
+
+  switch (input->GetNodeType())
+    {
+    case FEATURE_POINT:
+      {
+      OutputPointType point;
+      point[0] = (*pointIt)[0];
+      point[1] = (*pointIt)[1];
+      ++pointIt;
+      feature.Output->SetPoint(point);
+      break;
+      }
+    case FEATURE_LINE:
+      {
+      OutputLinePointerType newLine = OutputLineType::New();
+      const unsigned long nbVertices = input->GetLine()->GetVertexList()->Size();
+      for (unsigned long i = 0; i < nbVertices; ++i, ++pointIt)
+        {
+        itk::ContinuousIndex<double, 2> index;
+        index[0] = (*pointIt)[0];
+        index[1] = (*pointIt)[1];
+        newLine->AddVertex(index);
+        }
+      feature.Output->SetLine(newLine);
+      break;
+      }
+    case FEATURE_POLYGON:
+      {
+      OutputPolygonPointerType newExteriorRing = OutputPolygonType::New();
+      const unsigned long nbVertices = input->GetPolygonExteriorRing()->GetVertexList()->Size();
+      for (unsigned long i = 0; i < nbVertices; ++i, ++pointIt)
+        {
+        itk::ContinuousIndex<double, 2> index;
+        index[0] = (*pointIt)[0];
+        index[1] = (*pointIt)[1];
+        newExteriorRing->AddVertex(index);
+        }
+
+      OutputPolygonListPointerType newInteriorRings = OutputPolygonListType::New();
+      InputPolygonListPointerType interiorRings = input->GetPolygonInteriorRings();
+      for (typename InputPolygonListType::ConstIterator it = interiorRings->Begin(); it != interiorRings->End(); ++it)
+        {
+        OutputPolygonPointerType newRing = OutputPolygonType::New();
+        const unsigned long nbRingVertices = it.Get()->GetVertexList()->Size();
+        for (unsigned long i = 0; i < nbRingVertices; ++i, ++pointIt)
+          {
+          itk::ContinuousIndex<double, 2> index;
+          index[0] = (*pointIt)[0];
+          index[1] = (*pointIt)[1];
+          newRing->AddVertex(index);
+          }
+        newInteriorRings->PushBack(newRing);
+        }
+
+      feature.Output->SetPolygonExteriorRing(newExteriorRing);
+      feature.Output->SetPolygonInteriorRings(newInteriorRings);
+      break;
+      }
+    default:
+      {
+      break;
+      }
+    }
+}
+
+/**
+ * Project the geometries of a range of features
+ */
+template <class TInputVectorData, class TOutputVectorData>
+void
+VectorDataProjectionFilter<TInputVectorData, TOutputVectorData>
+::ProcessFeatures(const FeatureListType& features, unsigned long begin, unsigned long end,
+                  const InternalTransformType * transform) const
+{
+  std::vector<TransformInputPointType>  points;
+  std::vector<TransformOutputPointType> projectedPoints;
+
+  unsigned long batchBegin = begin;
+  while (batchBegin < end)
+    {
+    // Gather the vertices of consecutive features, up to the batch size
+    points.clear();
+    unsigned long batchEnd = batchBegin;
+    while (batchEnd < end && (batchEnd == batchBegin || points.size() < m_BatchSize))
+      {
+      AppendFeatureVertices(features[batchEnd].Input, points);
+      ++batchEnd;
+      }
+
+    projectedPoints.resize(points.size());
+    if (!points.empty())
+      {
+      transform->TransformPoints(&points[0], &projectedPoints[0], points.size());
+      }
+
+    // Vertices are consumed in the order they were gathered
+    typename std::vector<TransformOutputPointType>::const_iterator pointIt = projectedPoints.begin();
+    for (unsigned long i = batchBegin; i < batchEnd; ++i)
+      {
+      this->SetFeatureGeometry(features[i], pointIt);
+      }
+
+    batchBegin = batchEnd;
+    }
+}
+
+template <class TInputVectorData, class TOutputVectorData>
+ITK_THREAD_RETURN_TYPE
+VectorDataProjectionFilter<TInputVectorData, TOutputVectorData>
+::ThreaderCallback(void *arg)
+{
+  ThreadStruct *str;
+  int           threadId, threadCount;
+
+  threadId = ((itk::MultiThreader::ThreadInfoStruct *) (arg))->ThreadID;
+  threadCount = ((itk::MultiThreader::ThreadInfoStruct *) (arg))->NumberOfThreads;
+  str = (ThreadStruct *) (((itk::MultiThreader::ThreadInfoStruct *) (arg))->UserData);
+
+  // Consecutive features with about the same number of vertices in each thread
+  const std::vector<unsigned long>& offsets = *str->VertexOffsets;
+  const unsigned long nbFeatures = str->Features->size();
+  const unsigned long nbVertices = offsets.back();
+  const unsigned long begin =
+    std::lower_bound(offsets.begin(), offsets.end() - 1, nbVertices * threadId / threadCount) - offsets.begin();
+  const unsigned long end = (threadId + 1 == threadCount) ? nbFeatures :
+    std::lower_bound(offsets.begin(), offsets.end() - 1, nbVertices * (threadId + 1) / threadCount) - offsets.begin();
+
+  if (end > begin && static_cast<unsigned int>(threadId) < str->Transforms.size())
+    {
+    str->Filter->ProcessFeatures(*str->Features, begin, end, str->Transforms[threadId]);
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
 /**
    * GenerateData Performs the coordinate conversion for each element in the tree
  */
@@ -349,7 +657,6 @@ VectorDataProjectionFilter<TInputVectorData, TOutputVectorData>
   InputInternalTreeNodeType * inputRoot = const_cast<InputInternalTreeNodeType *>(inputPtr->GetDataTree()->GetRoot());
 
   // Create the output tree root
-  typedef typename OutputVectorDataType::DataNodePointerType OutputDataNodePointerType;
   OutputDataNodePointerType newDataNode = OutputDataNodeType::New();
   newDataNode->SetNodeType(inputRoot->Get()->GetNodeType());
   newDataNode->SetNodeId(inputRoot->Get()->GetNodeId());
@@ -357,12 +664,54 @@ VectorDataProjectionFilter<TInputVectorData, TOutputVectorData>
   outputRoot->Set(newDataNode);
   tree->SetRoot(outputRoot);
 
-  // Start recursive processing
   itk::TimeProbe chrono;
   chrono.Start();
-  this->ProcessNode(inputRoot, outputRoot);
+
+  // Copy the tree structure, then project the features in parallel
+  FeatureListType features;
+  this->CopyTree(inputRoot, outputRoot, features);
+
+  std::vector<unsigned long> offsets(1, 0);
+  offsets.reserve(features.size() + 1);
+  for (typename FeatureListType::const_iterator it = features.begin(); it != features.end(); ++it)
+    {
+    offsets.push_back(offsets.back() + GetNumberOfVertices(it->Input));
+    }
+
+  if (!features.empty())
+    {
+    unsigned int nbThreads =
+      std::max(1u, std::min<unsigned int>(this->GetNumberOfThreads(), features.size()));
+
+    // Each thread has its own copy of the transform, as sensor models are not
+    // thread safe
+    ThreadStruct str;
+    str.Filter = this;
+    str.Features = &features;
+    str.VertexOffsets = &offsets;
+    str.Transforms.push_back(m_Transform);
+    for (unsigned int thread = 1; thread < nbThreads; ++thread)
+      {
+      InternalTransformPointerType clone = dynamic_cast<InternalTransformType *>(m_Transform->Clone().GetPointer());
+      if (clone.IsNull())
+        {
+        // The transform can not be shared: project with a single thread
+        otbMsgDevMacro(<< "VectorDataProjectionFilter: transform can not be cloned, using a single thread");
+        nbThreads = 1;
+        str.Transforms.resize(1);
+        break;
+        }
+      str.Transforms.push_back(clone);
+      }
+
+    this->GetMultiThreader()->SetNumberOfThreads(nbThreads);
+    this->GetMultiThreader()->SetSingleMethod(this->ThreaderCallback, &str);
+    this->GetMultiThreader()->SingleMethodExecute();
+    }
+
   chrono.Stop();
-  otbMsgDevMacro(<< "VectoDataProjectionFilter: features Processed in " << chrono.GetMean() << " seconds.");
+  otbMsgDevMacro(<< "VectoDataProjectionFilter: " << features.size() << " features (" << offsets.back()
+                 << " vertices) processed in " << chrono.GetTotal() << " seconds.");
 }
 
 } // end namespace otb
@@ -28,10 +28,13 @@
 #include "ogr_srs_api.h" // OCTDestroyCoordinateTransformation
 #include "ogr_spatialref.h" // OGRCoordinateTransformation
 #include "itkMacro.h"
+#include "otbMacro.h"
 #include "otbGeometriesSet.h"
 #include "itkMetaDataObject.h"
 #include "otbOGRGeometryWrapper.h"
 #include "otbOGRGeometriesVisitor.h"
+#include <algorithm>
+#include <vector>
 
 
 /*===========================================================================*/
@@ -60,12 +63,35 @@ void otb::internal::ReprojectTransformationFunctor::do_transform(OGRPoint & g) c
 
 void otb::internal::ReprojectTransformationFunctor::do_transform(OGRLineString & g) const
 {
-  OGRPoint point;
-  for (int i=0, N=g.getNumPoints(); i!=N; ++i)
+  typedef InternalTransformType::InputPointType  InputPointType;
+  typedef InternalTransformType::OutputPointType OutputPointType;
+  const int N = g.getNumPoints();
+  if (N == 0)
+    {
+    return;
+    }
+
+  // All the vertices are projected in a single batch
+  std::vector<InputPointType> inPoints(N);
+  for (int i=0; i!=N; ++i)
     {
-    g.getPoint(i, &point);
-    do_transform(point); // no need to go through the redispatch cycle
-    g.setPoint(i, &point);
+    inPoints[i][0] = g.getX(i);
+    inPoints[i][1] = g.getY(i);
+    }
+  std::vector<OutputPointType> outPoints(N);
+  m_Transform->TransformPoints(&inPoints[0], &outPoints[0], N);
+
+  const bool is3D = g.getCoordinateDimension() == 3;
+  for (int i=0; i!=N; ++i)
+    {
+    if (is3D)
+      {
+      g.setPoint(i, outPoints[i][0], outPoints[i][1], g.getZ(i));
+      }
+    else
+      {
+      g.setPoint(i, outPoints[i][0], outPoints[i][1]);
+      }
     }
 }
 
@@ -155,6 +181,7 @@ void otb::internal::ReprojectTransformationFunctor::apply_inplace(OGRGeometry *
 otb::GeometriesProjectionFilter::GeometriesProjectionFilter()
 : m_InputImageReference(*this)
 , m_OutputImageReference(*this)
+, m_FeatureChunkSize(10000)
 {
 }
 
@@ -237,7 +264,99 @@ void otb::GeometriesProjectionFilter::DoProcessLayer(ogr::Layer const& source, o
       " Please supply too different geometries sets to work on.");
     }
 
-  m_TransformationFunctor(source, destination); // if TransformedElementType == layer
+  // One functor per thread, each with its own copy of the transform as sensor
+  // models are not thread safe
+  const unsigned int nbThreads = std::max<unsigned int>(1, this->GetNumberOfThreads());
+  TransformationFunctorListType functors(nbThreads);
+  functors[0].SetOnePointTransformation(m_Transform);
+  for (unsigned int thread = 1; thread != nbThreads; ++thread)
+    {
+    InternalTransformPointerType clone = dynamic_cast<InternalTransformType *>(m_Transform->Clone().GetPointer());
+    if (clone.IsNull())
+      {
+      // The transform can not be shared: project with a single thread
+      otbMsgDevMacro(<< "GeometriesProjectionFilter: transform can not be cloned, using a single thread");
+      functors.resize(1);
+      break;
+      }
+    functors[thread].SetOnePointTransformation(clone);
+    }
+
+  // Features are processed by chunks: the whole layer is never loaded
+  const unsigned int chunkSize = std::max(1u, m_FeatureChunkSize);
+  std::vector<ogr::Feature> chunk;
+  for (ogr::Layer::const_iterator b = source.begin(), e = source.end(); b != e; ++b)
+    {
+    chunk.push_back(*b);
+    if (chunk.size() == chunkSize)
+      {
+      this->ProcessChunk(chunk, destination, functors);
+      chunk.clear();
+      }
+    }
+  if (!chunk.empty())
+    {
+    this->ProcessChunk(chunk, destination, functors);
+    }
+}
+
+void otb::GeometriesProjectionFilter::ProcessChunk(
+  std::vector<ogr::Feature> const& chunk, ogr::Layer & destination,
+  TransformationFunctorListType const& functors) const
+{
+  // Build the output features with copies of the input geometries, that are
+  // then projected in place
+  OGRFeatureDefn & defn = destination.GetLayerDefn();
+  std::vector<ogr::Feature> outputs;
+  std::vector<OGRGeometry*> geometries;
+  outputs.reserve(chunk.size());
+  geometries.reserve(chunk.size());
+  for (std::vector<ogr::Feature>::const_iterator it = chunk.begin(); it != chunk.end(); ++it)
+    {
+    ogr::Feature dest(defn);
+    dest.SetGeometry(it->GetGeometry());
+    m_TransformationFunctor.fieldsTransform(*it, dest);
+    outputs.push_back(dest);
+    geometries.push_back(dest.ogr().GetGeometryRef());
+    }
+
+  ThreadStruct str;
+  str.Functors = &functors;
+  str.Geometries = &geometries;
+
+  const unsigned int nbThreads = std::min<unsigned int>(functors.size(), geometries.size());
+  this->GetMultiThreader()->SetNumberOfThreads(nbThreads);
+  this->GetMultiThreader()->SetSingleMethod(ThreaderCallback, &str);
+  this->GetMultiThreader()->SingleMethodExecute();
+
+  // Features are written in the input order
+  for (std::vector<ogr::Feature>::iterator it = outputs.begin(); it != outputs.end(); ++it)
+    {
+    destination.CreateFeature(*it);
+    }
+}
+
+ITK_THREAD_RETURN_TYPE
+otb::GeometriesProjectionFilter::ThreaderCallback(void *arg)
+{
+  ThreadStruct *str;
+  int           threadId, threadCount;
+
+  threadId = ((itk::MultiThreader::ThreadInfoStruct *) (arg))->ThreadID;
+  threadCount = ((itk::MultiThreader::ThreadInfoStruct *) (arg))->NumberOfThreads;
+  str = (ThreadStruct *) (((itk::MultiThreader::ThreadInfoStruct *) (arg))->UserData);
+
+  const unsigned long nbGeometries = str->Geometries->size();
+  const unsigned long start = nbGeometries * threadId / threadCount;
+  const unsigned long end = nbGeometries * (threadId + 1) / threadCount;
+
+  TransformationFunctorType const& functor = (*str->Functors)[threadId];
+  for (unsigned long i = start; i < end; ++i)
+    {
+    functor.apply_inplace((*str->Geometries)[i]);
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
 }
 
 /*virtual*/
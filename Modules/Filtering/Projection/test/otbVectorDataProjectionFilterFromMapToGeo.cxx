@@ -28,7 +28,7 @@ int otbVectorDataProjectionFilterFromMapToGeo(int argc, char * argv[])
 
   if (argc < 2)
     {
-    std::cout << argv[0] << " <input vector filename> <output vector filename> "  << std::endl;
+    std::cout << argv[0] << " <input vector filename> <output vector filename> [number of threads] [batch size]"  << std::endl;
 
     return EXIT_FAILURE;
     }
@@ -46,6 +46,14 @@ int otbVectorDataProjectionFilterFromMapToGeo(int argc, char * argv[])
   VectorDataFilterType::Pointer vectorDataProjection = VectorDataFilterType::New();
 
   vectorDataProjection->SetInput(reader->GetOutput());
+  if (argc > 3)
+    {
+    vectorDataProjection->SetNumberOfThreads(atoi(argv[3]));
+    }
+  if (argc > 4)
+    {
+    vectorDataProjection->SetBatchSize(atoi(argv[4]));
+    }
 
   typedef otb::VectorDataFileWriter<OutputVectorDataType> VectorDataFileWriterType;
   VectorDataFileWriterType::Pointer writer = VectorDataFileWriterType::New();
@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbMeanShiftModeCache_h
+#define otbMeanShiftModeCache_h
+
+#include "otbImage.h"
+#include "otbVectorImage.h"
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+#include "itkIntTypes.h"
+
+#include <vector>
+
+namespace otb
+{
+
+/** \class MeanShiftModeCache
+ *
+ * \brief Converged modes of a previous MeanShiftSmoothingImageFilter run.
+ *
+ * The cache is filled by the filter at the end of each run, and read at the
+ * beginning of the next one, so that pixels whose mean shift trajectory only
+ * depends on unchanged input values are not iterated again. It holds:
+ *  - a mode image over the output region of the last run, with, for each
+ *    pixel, the range and spatial outputs, the number of iterations, the
+ *    bounding box of the trajectory and a validity flag (see the band
+ *    accessors below);
+ *  - a checksum image of the input pixels over the input region of the last
+ *    run;
+ *  - the signature of the parameters the modes were computed with.
+ *
+ * Both images are indexed in the global frame of the filter, i.e. pixel
+ * indices plus the filter's GlobalShift, so that the cache can be reused
+ * when processing a shifted area of interest. A cache whose signature does
+ * not match the parameters of the filter is ignored and overwritten.
+ *
+ * The cache object is meant to be kept by the caller between runs. Its
+ * images can be written and read back with the usual image file writer and
+ * reader to keep it across processes, the signature being stored aside.
+ *
+ * \sa MeanShiftSmoothingImageFilter
+ *
+ * \ingroup OTBSmoothing
+ */
+template <unsigned int VImageDimension>
+class ITK_EXPORT MeanShiftModeCache : public itk::Object
+{
+public:
+  /** Standard class typedefs. */
+  typedef MeanShiftModeCache            Self;
+  typedef itk::Object                   Superclass;
+  typedef itk::SmartPointer<Self>       Pointer;
+  typedef itk::SmartPointer<const Self> ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(MeanShiftModeCache, itk::Object);
+
+  itkStaticConstMacro(ImageDimension, unsigned int, VImageDimension);
+
+  typedef otb::VectorImage<double, VImageDimension>        ModeImageType;
+  typedef otb::Image<itk::uint64_t, VImageDimension>       ChecksumImageType;
+  typedef std::vector<double>                              SignatureType;
+
+  /** Set/Get the mode image */
+  itkSetObjectMacro(ModeImage, ModeImageType);
+  itkGetObjectMacro(ModeImage, ModeImageType);
+
+  /** Set/Get the checksum image of the input pixels */
+  itkSetObjectMacro(ChecksumImage, ChecksumImageType);
+  itkGetObjectMacro(ChecksumImage, ChecksumImageType);
+
+  /** Set/Get the signature of the parameters used to compute the modes */
+  void SetSignature(const SignatureType & signature)
+  {
+    m_Signature = signature;
+    this->Modified();
+  }
+  const SignatureType & GetSignature() const
+  {
+    return m_Signature;
+  }
+
+  /** True if the cache holds modes computed with the given signature */
+  bool IsValid(const SignatureType & signature) const
+  {
+    return m_ModeImage.IsNotNull() && m_ChecksumImage.IsNotNull() && m_Signature == signature;
+  }
+
+  /** Release the cached images */
+  void Clear()
+  {
+    m_ModeImage = ITK_NULLPTR;
+    m_ChecksumImage = ITK_NULLPTR;
+    m_Signature.clear();
+    this->Modified();
+  }
+
+  /** Bands of the mode image, for an input with the given number of components */
+  static unsigned int GetRangeBand(unsigned int itkNotUsed(nbComponents))
+  {
+    return 0;
+  }
+  static unsigned int GetSpatialBand(unsigned int nbComponents)
+  {
+    return nbComponents;
+  }
+  static unsigned int GetIterationBand(unsigned int nbComponents)
+  {
+    return nbComponents + VImageDimension;
+  }
+  static unsigned int GetTrajectoryMinimumBand(unsigned int nbComponents)
+  {
+    return nbComponents + VImageDimension + 1;
+  }
+  static unsigned int GetTrajectoryMaximumBand(unsigned int nbComponents)
+  {
+    return nbComponents + 2 * VImageDimension + 1;
+  }
+  static unsigned int GetValidityBand(unsigned int nbComponents)
+  {
+    return nbComponents + 3 * VImageDimension + 1;
+  }
+  static unsigned int GetNumberOfBands(unsigned int nbComponents)
+  {
+    return nbComponents + 3 * VImageDimension + 2;
+  }
+
+protected:
+  MeanShiftModeCache() {}
+  ~MeanShiftModeCache() ITK_OVERRIDE {}
+
+  void PrintSelf(std::ostream& os, itk::Indent indent) const ITK_OVERRIDE
+  {
+    Superclass::PrintSelf(os, indent);
+    os << indent << "Signature size: " << m_Signature.size() << std::endl;
+    if (m_ModeImage.IsNotNull())
+      {
+      os << indent << "Mode region: " << m_ModeImage->GetBufferedRegion() << std::endl;
+      }
+  }
+
+private:
+  MeanShiftModeCache(const Self &); //purposely not implemented
+  void operator =(const Self&); //purposely not implemented
+
+  typename ModeImageType::Pointer     m_ModeImage;
+  typename ChecksumImageType::Pointer m_ChecksumImage;
+  SignatureType                       m_Signature;
+};
+
+} // end namespace otb
+
+#endif
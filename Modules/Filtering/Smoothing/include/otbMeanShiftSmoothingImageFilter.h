@@ -23,6 +23,7 @@
 
 #include "otbImage.h"
 #include "otbVectorImage.h"
+#include "otbMeanShiftModeCache.h"
 #include "itkImageToImageFilter.h"
 #include "itkImageRegionConstIterator.h"
 #include "itkImageRegionConstIteratorWithIndex.h"
@@ -439,6 +440,18 @@ private:
  * MaxIterationNumber defines maximum iteration number for each pixel convergence (set using Get/Set accessor). Set to 4 by default.
  * ModeSearch is a boolean value, to choose between optimized and non optimized algorithm. If set to true (by default), assign mode value to each pixel on a path covered in convergence steps.
  *
+ * An optional MeanShiftModeCache can be set to warm-start successive runs over
+ * overlapping regions. At the end of each run, the filter stores in the cache
+ * the modes it has converged to, the bounding box of each trajectory and a
+ * checksum of the input pixels. At the beginning of the next run with the same
+ * parameters, a pixel takes its cached mode without iterating when the window
+ * read along its trajectory lies inside the input requested region and contains
+ * only unchanged input pixels, which gives the same result as a full
+ * computation. Only modes reached by the pixel's own convergence are cached:
+ * pixels assigned through the mode search optimization are iterated again.
+ * The cache is indexed in the global frame defined by GlobalShift. Only 2D
+ * images are supported by the cache.
+ *
  * For more information on mean shift techniques, one might consider reading the following article:
  *
  * D. Comaniciu, P. Meer, "Mean Shift: A Robust Approach Toward Feature Space Analysis," IEEE Transactions on
@@ -506,6 +519,10 @@ public:
   typedef otb::VectorImage<RealType, InputImageType::ImageDimension> RealVectorImageType;
   typedef otb::Image<unsigned short, InputImageType::ImageDimension> ModeTableImageType;
 
+  typedef MeanShiftModeCache<InputImageType::ImageDimension> ModeCacheType;
+  typedef typename ModeCacheType::ModeImageType              ModeImageType;
+  typedef typename ModeCacheType::ChecksumImageType          ChecksumImageType;
+
   /** Sets the spatial bandwidth (or radius in the case of a uniform kernel)
    * of the neighborhood for each pixel
    */
@@ -552,6 +569,14 @@ public:
   aligning pixel indices when performing tile processing */
   itkSetMacro(GlobalShift,InputIndexType);
 
+  /** Set/Get the mode cache used to warm-start the filter (none by default).
+   * The cache is updated at the end of each run. */
+  itkSetObjectMacro(ModeCache, ModeCacheType);
+  itkGetObjectMacro(ModeCache, ModeCacheType);
+
+  /** Number of pixels whose mode was taken from the cache during the last run */
+  itkGetConstMacro(NumberOfCachedModes, itk::SizeValueType);
+
   /** Returns the const spatial image output,spatial image output is a displacement map (pixel position after convergence minus pixel index)  */
   const OutputSpatialImageType * GetSpatialOutput() const;
   /** Returns the const spectral image output */
@@ -620,6 +645,16 @@ private:
   MeanShiftSmoothingImageFilter(const Self &); //purposely not implemented
   void operator =(const Self&); //purposely not implemented
 
+  /** Parameters the cached modes depend on */
+  typename ModeCacheType::SignatureType GetCacheSignature() const;
+
+  /** Compute the input checksums, then restore the modes of the cache which
+   * do not depend on changed input pixels */
+  void RestoreCachedModes();
+
+  /** Store the modes of the current run into the cache */
+  void UpdateModeCache();
+
   /** Range bandwidth */
   RealType m_RangeBandwidth;
 
@@ -677,6 +712,17 @@ private:
 
   InputIndexType m_GlobalShift;
 
+  /** Cache of converged modes, used to warm-start the filter */
+  typename ModeCacheType::Pointer m_ModeCache;
+
+  /** Modes of the current run, to be stored in the cache */
+  typename ModeImageType::Pointer m_NextModeImage;
+
+  /** Checksums of the input pixels of the current run */
+  typename ChecksumImageType::Pointer m_NextChecksumImage;
+
+  itk::SizeValueType m_NumberOfCachedModes;
+
 };
 
 } // end namespace otb
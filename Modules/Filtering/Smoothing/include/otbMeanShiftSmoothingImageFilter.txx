@@ -53,6 +53,7 @@ MeanShiftSmoothingImageFilter<TInputImage, TOutputImage, TKernel, TOutputIterati
   this->SetNthOutput(2, OutputIterationImageType::New());
   this->SetNthOutput(3, OutputLabelImageType::New());
   m_GlobalShift.Fill(0);
+  m_NumberOfCachedModes = 0;
 }
 
 template<class TInputImage, class TOutputImage, class TKernel, class TOutputIterationImage>
@@ -319,26 +320,281 @@ void MeanShiftSmoothingImageFilter<TInputImage, TOutputImage, TKernel, TOutputIt
 
     // Initialize counters for mode (also used for mode labeling)
     // Most significant bits of label counters are used to identify the thread
-    // Id.
-    unsigned int numThreads;
+    // Id. When a mode cache is set, one more counter labels the modes
+    // restored from the cache.
+    unsigned int numCounters = this->GetNumberOfThreads();
+    if (m_ModeCache.IsNotNull())
+      {
+      ++numCounters;
+      }
 
-    numThreads = this->GetNumberOfThreads();
-    m_ThreadIdNumberOfBits = -1;
-    unsigned int n = numThreads;
+    m_ThreadIdNumberOfBits = 0;
+    unsigned int n = numCounters - 1;
     while (n != 0)
       {
       n >>= 1;
       m_ThreadIdNumberOfBits++;
       }
     if (m_ThreadIdNumberOfBits == 0) m_ThreadIdNumberOfBits = 1; // minimum 1 bit
-    m_NumLabels.SetSize(numThreads);
-    for (unsigned int i = 0; i < numThreads; i++)
+    m_NumLabels.SetSize(numCounters);
+    for (unsigned int i = 0; i < numCounters; i++)
       {
       m_NumLabels[i] = static_cast<LabelType> (i) << (sizeof(LabelType) * 8 - m_ThreadIdNumberOfBits);
       }
 
     }
 
+  m_NumberOfCachedModes = 0;
+  m_NextModeImage = ITK_NULLPTR;
+  m_NextChecksumImage = ITK_NULLPTR;
+  if (m_ModeCache.IsNotNull())
+    {
+    this->RestoreCachedModes();
+    }
+}
+
+template<class TInputImage, class TOutputImage, class TKernel, class TOutputIterationImage>
+typename MeanShiftSmoothingImageFilter<TInputImage, TOutputImage, TKernel, TOutputIterationImage>::ModeCacheType::SignatureType
+MeanShiftSmoothingImageFilter<TInputImage, TOutputImage, TKernel, TOutputIterationImage>::GetCacheSignature() const
+{
+  typename ModeCacheType::SignatureType signature;
+  signature.push_back(m_SpatialBandwidth);
+  signature.push_back(m_RangeBandwidth);
+  signature.push_back(m_RangeBandwidthRamp);
+  signature.push_back(m_Threshold);
+  signature.push_back(m_MaxIterationNumber);
+  signature.push_back(m_NumberOfComponentsPerPixel);
+  for (unsigned int comp = 0; comp < ImageDimension; ++comp)
+    {
+    signature.push_back(m_SpatialRadius[comp]);
+    }
+  // Identifies the kernel profile
+  signature.push_back(m_Kernel(0.5));
+  signature.push_back(m_Kernel.GetRadius(1.0));
+  return signature;
+}
+
+template<class TInputImage, class TOutputImage, class TKernel, class TOutputIterationImage>
+void MeanShiftSmoothingImageFilter<TInputImage, TOutputImage, TKernel, TOutputIterationImage>::RestoreCachedModes()
+{
+  if (ImageDimension != 2)
+    {
+    itkExceptionMacro(<< "The mode cache only supports 2D images");
+    }
+
+  const unsigned int nbBands = ModeCacheType::GetNumberOfBands(m_NumberOfComponentsPerPixel);
+  const unsigned int minBand = ModeCacheType::GetTrajectoryMinimumBand(m_NumberOfComponentsPerPixel);
+  const unsigned int maxBand = ModeCacheType::GetTrajectoryMaximumBand(m_NumberOfComponentsPerPixel);
+  const unsigned int validityBand = ModeCacheType::GetValidityBand(m_NumberOfComponentsPerPixel);
+
+  // Mean shift vectors are computed over the input requested region
+  const RegionType inputRegion = this->GetInput()->GetRequestedRegion();
+  const OutputRegionType outputRegion = this->GetRangeOutput()->GetRequestedRegion();
+
+  // Regions in the global frame of the cache
+  RegionType globalInputRegion = inputRegion;
+  RegionType globalOutputRegion = outputRegion;
+  InputIndexType globalIndex;
+  for (unsigned int comp = 0; comp < ImageDimension; ++comp)
+    {
+    globalIndex[comp] = inputRegion.GetIndex()[comp] + m_GlobalShift[comp];
+    }
+  globalInputRegion.SetIndex(globalIndex);
+  for (unsigned int comp = 0; comp < ImageDimension; ++comp)
+    {
+    globalIndex[comp] = outputRegion.GetIndex()[comp] + m_GlobalShift[comp];
+    }
+  globalOutputRegion.SetIndex(globalIndex);
+
+  // Checksums of the input pixels (FNV-1a over the range components)
+  m_NextChecksumImage = ChecksumImageType::New();
+  m_NextChecksumImage->SetRegions(globalInputRegion);
+  m_NextChecksumImage->Allocate();
+
+  itk::ImageRegionConstIterator<RealVectorImageType> jointIt(m_JointImage, inputRegion);
+  itk::ImageRegionIterator<ChecksumImageType> checksumIt(m_NextChecksumImage, globalInputRegion);
+  for (jointIt.GoToBegin(), checksumIt.GoToBegin(); !jointIt.IsAtEnd(); ++jointIt, ++checksumIt)
+    {
+    const RealVector & jointPixel = jointIt.Get();
+    itk::uint64_t checksum = 14695981039346656037ULL;
+    for (unsigned int comp = ImageDimension; comp < ImageDimension + m_NumberOfComponentsPerPixel; ++comp)
+      {
+      const RealType value = jointPixel[comp];
+      const unsigned char * bytes = reinterpret_cast<const unsigned char *>(&value);
+      for (unsigned int b = 0; b < sizeof(RealType); ++b)
+        {
+        checksum = (checksum ^ bytes[b]) * 1099511628211ULL;
+        }
+      }
+    checksumIt.Set(checksum);
+    }
+
+  // Modes of the current run, filled during the threaded computation
+  m_NextModeImage = ModeImageType::New();
+  m_NextModeImage->SetNumberOfComponentsPerPixel(nbBands);
+  m_NextModeImage->SetRegions(globalOutputRegion);
+  m_NextModeImage->Allocate();
+  typename ModeImageType::PixelType zero(nbBands);
+  zero.Fill(0);
+  m_NextModeImage->FillBuffer(zero);
+
+  if (!m_ModeCache->IsValid(this->GetCacheSignature()))
+    {
+    return;
+    }
+
+  typename ModeImageType::Pointer cachedModes = m_ModeCache->GetModeImage();
+  typename ChecksumImageType::Pointer cachedChecksums = m_ModeCache->GetChecksumImage();
+  const RegionType cachedChecksumRegion = cachedChecksums->GetBufferedRegion();
+
+  RegionType restoredRegion = globalOutputRegion;
+  if (!restoredRegion.Crop(cachedModes->GetBufferedRegion()))
+    {
+    return;
+    }
+
+  // Integral image of the input pixels which changed, or are not in the cache
+  const InputIndexValueType sizeX = inputRegion.GetSize()[0];
+  const InputIndexValueType sizeY = inputRegion.GetSize()[1];
+  const InputIndexValueType stride = sizeX + 1;
+  std::vector<itk::SizeValueType> changed(stride * (sizeY + 1), 0);
+
+  itk::ImageRegionConstIteratorWithIndex<ChecksumImageType> newChecksumIt(m_NextChecksumImage, globalInputRegion);
+  for (newChecksumIt.GoToBegin(); !newChecksumIt.IsAtEnd(); ++newChecksumIt)
+    {
+    const InputIndexType & index = newChecksumIt.GetIndex();
+    const InputIndexValueType x = index[0] - globalInputRegion.GetIndex()[0];
+    const InputIndexValueType y = index[1] - globalInputRegion.GetIndex()[1];
+    const itk::SizeValueType isChanged = (!cachedChecksumRegion.IsInside(index)
+                                          || cachedChecksums->GetPixel(index) != newChecksumIt.Get()) ? 1 : 0;
+    changed[(y + 1) * stride + x + 1] = isChanged + changed[y * stride + x + 1]
+      + changed[(y + 1) * stride + x] - changed[y * stride + x];
+    }
+
+  // Restore the modes whose trajectory window is unchanged
+  typename OutputImageType::PixelType rangePixel(m_NumberOfComponentsPerPixel);
+  OutputSpatialPixelType spatialPixel(ImageDimension);
+
+  itk::ImageRegionConstIteratorWithIndex<ModeImageType> cachedIt(cachedModes, restoredRegion);
+  for (cachedIt.GoToBegin(); !cachedIt.IsAtEnd(); ++cachedIt)
+    {
+    const InputIndexType & index = cachedIt.GetIndex();
+    const RealType * cached = cachedModes->GetBufferPointer()
+      + cachedModes->ComputeOffset(index) * nbBands;
+
+    if (cached[validityBand] < 0.5)
+      {
+      continue;
+      }
+
+    // Window read along the trajectory, relative to the input region
+    InputIndexValueType lower[2];
+    InputIndexValueType upper[2];
+    bool inside = true;
+    for (unsigned int comp = 0; comp < 2; ++comp)
+      {
+      const InputIndexValueType margin = m_SpatialRadius[comp] + 1;
+      lower[comp] = static_cast<InputIndexValueType>(cached[minBand + comp]) - margin
+        - globalInputRegion.GetIndex()[comp];
+      upper[comp] = static_cast<InputIndexValueType>(cached[maxBand + comp]) + margin
+        - globalInputRegion.GetIndex()[comp];
+      inside = inside && lower[comp] >= 0
+        && upper[comp] < static_cast<InputIndexValueType>(inputRegion.GetSize()[comp]);
+      }
+    if (!inside)
+      {
+      continue;
+      }
+
+    const itk::SizeValueType nbChanged = changed[(upper[1] + 1) * stride + upper[0] + 1]
+      - changed[lower[1] * stride + upper[0] + 1] - changed[(upper[1] + 1) * stride + lower[0]]
+      + changed[lower[1] * stride + lower[0]];
+    if (nbChanged != 0)
+      {
+      continue;
+      }
+
+    InputIndexType localIndex;
+    for (unsigned int comp = 0; comp < ImageDimension; ++comp)
+      {
+      localIndex[comp] = index[comp] - m_GlobalShift[comp];
+      }
+
+    for (unsigned int comp = 0; comp < m_NumberOfComponentsPerPixel; ++comp)
+      {
+      rangePixel[comp] = cached[ModeCacheType::GetRangeBand(m_NumberOfComponentsPerPixel) + comp];
+      }
+    for (unsigned int comp = 0; comp < ImageDimension; ++comp)
+      {
+      spatialPixel[comp] = cached[ModeCacheType::GetSpatialBand(m_NumberOfComponentsPerPixel) + comp];
+      }
+    this->GetRangeOutput()->SetPixel(localIndex, rangePixel);
+    this->GetSpatialOutput()->SetPixel(localIndex, spatialPixel);
+    this->GetIterationOutput()->SetPixel(localIndex,
+      static_cast<typename OutputIterationImageType::PixelType>(cached[ModeCacheType::GetIterationBand(m_NumberOfComponentsPerPixel)]));
+
+    LabelType label = 0;
+    if (m_ModeSearch)
+      {
+      label = ++m_NumLabels[m_NumLabels.GetSize() - 1];
+      }
+    this->GetLabelOutput()->SetPixel(localIndex, label);
+
+    // Restored pixels are handled as pixels with an assigned mode
+    m_ModeTable->SetPixel(localIndex, 1);
+
+    RealType * next = m_NextModeImage->GetBufferPointer() + m_NextModeImage->ComputeOffset(index) * nbBands;
+    std::copy(cached, cached + nbBands, next);
+
+    ++m_NumberOfCachedModes;
+    }
+
+  otbMsgDevMacro(<< m_NumberOfCachedModes << " modes restored from the cache over "
+                 << outputRegion.GetNumberOfPixels() << " pixels");
+}
+
+template<class TInputImage, class TOutputImage, class TKernel, class TOutputIterationImage>
+void MeanShiftSmoothingImageFilter<TInputImage, TOutputImage, TKernel, TOutputIterationImage>::UpdateModeCache()
+{
+  if (m_ModeCache.IsNull() || m_NextModeImage.IsNull())
+    {
+    return;
+    }
+
+  const unsigned int nbBands = ModeCacheType::GetNumberOfBands(m_NumberOfComponentsPerPixel);
+  const unsigned int rangeBand = ModeCacheType::GetRangeBand(m_NumberOfComponentsPerPixel);
+  const unsigned int spatialBand = ModeCacheType::GetSpatialBand(m_NumberOfComponentsPerPixel);
+  const unsigned int iterationBand = ModeCacheType::GetIterationBand(m_NumberOfComponentsPerPixel);
+
+  const OutputRegionType outputRegion = this->GetRangeOutput()->GetRequestedRegion();
+
+  itk::ImageRegionConstIteratorWithIndex<OutputImageType> rangeIt(this->GetRangeOutput(), outputRegion);
+  itk::ImageRegionConstIterator<OutputSpatialImageType> spatialIt(this->GetSpatialOutput(), outputRegion);
+  itk::ImageRegionConstIterator<OutputIterationImageType> iterationIt(this->GetIterationOutput(), outputRegion);
+
+  RealType * next = m_NextModeImage->GetBufferPointer();
+  for (rangeIt.GoToBegin(), spatialIt.GoToBegin(), iterationIt.GoToBegin(); !rangeIt.IsAtEnd();
+       ++rangeIt, ++spatialIt, ++iterationIt, next += nbBands)
+    {
+    const typename OutputImageType::PixelType & rangePixel = rangeIt.Get();
+    const OutputSpatialPixelType & spatialPixel = spatialIt.Get();
+    for (unsigned int comp = 0; comp < m_NumberOfComponentsPerPixel; ++comp)
+      {
+      next[rangeBand + comp] = rangePixel[comp];
+      }
+    for (unsigned int comp = 0; comp < ImageDimension; ++comp)
+      {
+      next[spatialBand + comp] = spatialPixel[comp];
+      }
+    next[iterationBand] = iterationIt.Get();
+    }
+
+  m_ModeCache->SetModeImage(m_NextModeImage);
+  m_ModeCache->SetChecksumImage(m_NextChecksumImage);
+  m_ModeCache->SetSignature(this->GetCacheSignature());
+
+  m_NextModeImage = ITK_NULLPTR;
+  m_NextChecksumImage = ITK_NULLPTR;
 }
 
 // Calculates the mean shift vector at the position given by jointPixel
@@ -601,12 +857,20 @@ void MeanShiftSmoothingImageFilter<TInputImage, TOutputImage, TKernel, TOutputIt
   // index of the current pixel updated during the mean shift loop
   InputIndexType modeCandidate;
 
+  // Bounding box of the trajectory, in the global frame, kept for the mode cache
+  const bool trackTrajectory = m_NextModeImage.IsNotNull();
+  InputIndexType trajectoryMin;
+  InputIndexType trajectoryMax;
+  trajectoryMin.Fill(0);
+  trajectoryMax.Fill(0);
+
   for (; !jointIt.IsAtEnd(); ++jointIt, ++rangeIt, ++spatialIt, ++iterationIt, ++modeTableIt, ++labelIt, progress.CompletedPixel())
     {
 
-    // if pixel has been already processed (by mode search optimization), skip
+    // if pixel has been already processed (by mode search optimization, or
+    // restored from the mode cache), skip
     typename ModeTableImageType::InternalPixelType const& currentPixelMode = modeTableIt.Get();
-    if (m_ModeSearch && currentPixelMode == 1)
+    if (currentPixelMode == 1)
       {
       numBreaks++;
       continue;
@@ -629,6 +893,13 @@ void MeanShiftSmoothingImageFilter<TInputImage, TOutputImage, TKernel, TOutputIt
     // Number of points currently in the pointList
     unsigned int pointCount = 0; // Note: used only in mode search optimization
     iteration = 0;
+    if (trackTrajectory)
+      {
+      for (unsigned int comp = 0; comp < ImageDimension; comp++)
+        {
+        trajectoryMin[comp] = trajectoryMax[comp] = currentIndex[comp] + m_GlobalShift[comp];
+        }
+      }
     while ((iteration < m_MaxIterationNumber) && (!hasConverged))
       {
 
@@ -697,6 +968,15 @@ void MeanShiftSmoothingImageFilter<TInputImage, TOutputImage, TKernel, TOutputIt
       else
         {
 #endif
+        if (trackTrajectory)
+          {
+          for (unsigned int comp = 0; comp < ImageDimension; comp++)
+            {
+            const InputIndexValueType position = static_cast<InputIndexValueType>(vcl_floor(jointPixel[comp] + 0.5));
+            trajectoryMin[comp] = std::min(trajectoryMin[comp], position);
+            trajectoryMax[comp] = std::max(trajectoryMax[comp], position);
+            }
+          }
         this->CalculateMeanShiftVector(m_JointImage, jointPixel, requestedRegion, bandwidth, meanShiftVector);
 
 #if 0
@@ -734,6 +1014,34 @@ void MeanShiftSmoothingImageFilter<TInputImage, TOutputImage, TKernel, TOutputIt
     const typename OutputIterationImageType::PixelType iterationPixel = iteration;
     iterationIt.Set(iterationPixel);
 
+    // The mode can be cached if it was reached by the pixel's own trajectory,
+    // and if the window read along the trajectory was not cropped
+    if (trackTrajectory && (hasConverged || iteration == m_MaxIterationNumber))
+      {
+      bool valid = true;
+      for (unsigned int comp = 0; comp < ImageDimension; comp++)
+        {
+        const InputIndexValueType margin = m_SpatialRadius[comp] + 1;
+        const InputIndexValueType first = requestedRegion.GetIndex()[comp] + m_GlobalShift[comp];
+        const InputIndexValueType last = first + static_cast<InputIndexValueType>(requestedRegion.GetSize()[comp]) - 1;
+        valid = valid && trajectoryMin[comp] - margin >= first && trajectoryMax[comp] + margin <= last;
+        }
+
+      InputIndexType globalIndex;
+      for (unsigned int comp = 0; comp < ImageDimension; comp++)
+        {
+        globalIndex[comp] = currentIndex[comp] + m_GlobalShift[comp];
+        }
+      RealType * next = m_NextModeImage->GetBufferPointer()
+        + m_NextModeImage->ComputeOffset(globalIndex) * m_NextModeImage->GetNumberOfComponentsPerPixel();
+      for (unsigned int comp = 0; comp < ImageDimension; comp++)
+        {
+        next[ModeCacheType::GetTrajectoryMinimumBand(m_NumberOfComponentsPerPixel) + comp] = trajectoryMin[comp];
+        next[ModeCacheType::GetTrajectoryMaximumBand(m_NumberOfComponentsPerPixel) + comp] = trajectoryMax[comp];
+        }
+      next[ModeCacheType::GetValidityBand(m_NumberOfComponentsPerPixel)] = valid ? 1. : 0.;
+      }
+
     if (m_ModeSearch)
       {
       // Update the mode table now that the current pixel has been assigned
@@ -784,10 +1092,11 @@ void MeanShiftSmoothingImageFilter<TInputImage, TOutputImage, TKernel, TOutputIt
     {
     // New labels will be consecutive. The following vector contains the new
     // start label for each thread.
+    // The last counter holds the modes restored from the cache, if any.
     itk::VariableLengthVector<LabelType> newLabelOffset;
-    newLabelOffset.SetSize(this->GetNumberOfThreads());
+    newLabelOffset.SetSize(m_NumLabels.GetSize());
     newLabelOffset[0] = 0;
-    for (itk::ThreadIdType i = 1; i < this->GetNumberOfThreads(); i++)
+    for (itk::ThreadIdType i = 1; i < m_NumLabels.GetSize(); i++)
       {
       // Retrieve the number of labels in the thread by removing the threadId
       // from the most significant bits
@@ -817,6 +1126,7 @@ void MeanShiftSmoothingImageFilter<TInputImage, TOutputImage, TKernel, TOutputIt
       }
     }
 
+  this->UpdateModeCache();
 }
 
 template<class TInputImage, class TOutputImage, class TKernel, class TOutputIterationImage>
@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "otbImageFileReader.h"
+#include "otbMeanShiftSmoothingImageFilter.h"
+#include "otbMultiChannelExtractROI.h"
+
+#include "itkImageRegionConstIterator.h"
+
+
+const unsigned int Dimension = 2;
+typedef float                                                    PixelType;
+typedef otb::VectorImage<PixelType, Dimension>                   ImageType;
+typedef otb::ImageFileReader<ImageType>                          ReaderType;
+typedef otb::MeanShiftSmoothingImageFilter<ImageType, ImageType> FilterType;
+typedef otb::MultiChannelExtractROI<PixelType, PixelType>        ExtractROIFilterType;
+
+namespace
+{
+// Run the mean shift filter over an area of interest, with an optional mode cache
+FilterType::Pointer RunMeanShift(ImageType * image, unsigned int startX, unsigned int startY,
+                                 unsigned int size, char * argv[], FilterType::ModeCacheType * cache)
+{
+  ExtractROIFilterType::Pointer extract = ExtractROIFilterType::New();
+  extract->SetInput(image);
+  extract->SetStartX(startX);
+  extract->SetStartY(startY);
+  extract->SetSizeX(size);
+  extract->SetSizeY(size);
+
+  ImageType::IndexType globalShift;
+  globalShift[0] = startX;
+  globalShift[1] = startY;
+
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetSpatialBandwidth(atof(argv[2]));
+  filter->SetRangeBandwidth(atof(argv[3]));
+  filter->SetThreshold(atof(argv[4]));
+  filter->SetMaxIterationNumber(atoi(argv[5]));
+  filter->SetModeSearch(false);
+  filter->SetGlobalShift(globalShift);
+  filter->SetInput(extract->GetOutput());
+  if (cache)
+    {
+    filter->SetModeCache(cache);
+    }
+  filter->Update();
+  return filter;
+}
+}
+
+int otbMeanShiftSmoothingImageFilterModeCache(int argc, char * argv[])
+{
+  if (argc != 10)
+    {
+    std::cerr << "Usage: " << argv[0]
+              << " infname spatialBandwidth rangeBandwidth threshold maxiterationnumber startx starty shift size"
+              << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const unsigned int startX = atoi(argv[6]);
+  const unsigned int startY = atoi(argv[7]);
+  const unsigned int shift  = atoi(argv[8]);
+  const unsigned int size   = atoi(argv[9]);
+
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(argv[1]);
+  reader->UpdateOutputInformation();
+
+  FilterType::ModeCacheType::Pointer cache = FilterType::ModeCacheType::New();
+
+  // First run fills the cache
+  FilterType::Pointer first = RunMeanShift(reader->GetOutput(), startX, startY, size, argv, cache);
+  if (first->GetNumberOfCachedModes() != 0)
+    {
+    std::cerr << "The first run restored " << first->GetNumberOfCachedModes() << " modes from an empty cache" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Second run over a shifted area, warm-started by the cache
+  FilterType::Pointer warm = RunMeanShift(reader->GetOutput(), startX + shift, startY + shift, size, argv, cache);
+  FilterType::Pointer reference = RunMeanShift(reader->GetOutput(), startX + shift, startY + shift, size, argv, ITK_NULLPTR);
+
+  std::cout << warm->GetNumberOfCachedModes() << " modes restored over "
+            << warm->GetRangeOutput()->GetBufferedRegion().GetNumberOfPixels() << " pixels" << std::endl;
+
+  if (warm->GetNumberOfCachedModes() == 0)
+    {
+    std::cerr << "No mode restored from the cache" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Warm-started outputs are the same as the ones of a full computation
+  const ImageType::RegionType region = reference->GetRangeOutput()->GetBufferedRegion();
+  itk::ImageRegionConstIterator<ImageType> warmRangeIt(warm->GetRangeOutput(), region);
+  itk::ImageRegionConstIterator<ImageType> refRangeIt(reference->GetRangeOutput(), region);
+  itk::ImageRegionConstIterator<FilterType::OutputSpatialImageType> warmSpatialIt(warm->GetSpatialOutput(), region);
+  itk::ImageRegionConstIterator<FilterType::OutputSpatialImageType> refSpatialIt(reference->GetSpatialOutput(), region);
+  itk::ImageRegionConstIterator<FilterType::OutputIterationImageType> warmIterationIt(warm->GetIterationOutput(), region);
+  itk::ImageRegionConstIterator<FilterType::OutputIterationImageType> refIterationIt(reference->GetIterationOutput(), region);
+
+  unsigned int nbErrors = 0;
+  for (; !refRangeIt.IsAtEnd(); ++warmRangeIt, ++refRangeIt, ++warmSpatialIt, ++refSpatialIt, ++warmIterationIt, ++refIterationIt)
+    {
+    if (warmRangeIt.Get() != refRangeIt.Get() || warmSpatialIt.Get() != refSpatialIt.Get()
+        || warmIterationIt.Get() != refIterationIt.Get())
+      {
+      ++nbErrors;
+      }
+    }
+
+  if (nbErrors != 0)
+    {
+    std::cerr << nbErrors << " pixels differ from a full computation" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // A third run over the same area restores all the modes of the second run
+  FilterType::Pointer again = RunMeanShift(reader->GetOutput(), startX + shift, startY + shift, size, argv, cache);
+  if (again->GetNumberOfCachedModes() < warm->GetNumberOfCachedModes())
+    {
+    std::cerr << "Only " << again->GetNumberOfCachedModes() << " modes restored over an unchanged area" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -27,11 +27,40 @@
 #include "itkImageRegionIterator.h"
 #include "otbImage.h"
 
+#include <vector>
+
 namespace otb
 {
 
 namespace Functor
 {
+/** \class BlockMatchingFunctorTraits
+ *  \brief Tells whether a block-matching functor supports cost volume evaluation
+ *
+ *  When the metric of a functor only depends on sums, over the block, of
+ *  pixel-wise terms computed from the left and right pixel values, the
+ *  PixelWiseBlockMatchingImageFilter evaluates it on a cost volume: for
+ *  each disparity, the pixel-wise terms are computed once and summed over
+ *  the blocks with box filters, so that the cost does not depend on the
+ *  radius anymore.
+ *
+ *  Such functors provide, in addition to the neighborhood operator:
+ *  - unsigned int GetNumberOfTerms() const, the number of pixel-wise terms
+ *    (at most MaximumNumberOfTerms);
+ *  - void ComputeTerms(double a, double b, double * terms) const;
+ *  - MetricValueType operator()(const double * sums, double size) const,
+ *    the metric from the block sums of the terms and the block size;
+ *  and specialise this traits class with CostVolume set to true.
+ *
+ * \ingroup OTBDisparityMap
+ */
+template <class TBlockMatchingFunctor>
+struct BlockMatchingFunctorTraits
+{
+  static const bool CostVolume = false;
+  static const unsigned int MaximumNumberOfTerms = 8;
+};
+
 /** \class SSDBlockMatching
  *  \brief Functor to perform simple SSD block-matching
  *
@@ -63,6 +92,29 @@ public:
 
     return ssd;
   }
+
+  // Cost volume evaluation: block sum of the squared differences
+  unsigned int GetNumberOfTerms() const
+  {
+    return 1;
+  }
+
+  inline void ComputeTerms(double a, double b, double * terms) const
+  {
+    terms[0] = (a-b)*(a-b);
+  }
+
+  inline MetricValueType operator()(const double * sums, double itkNotUsed(size)) const
+  {
+    return static_cast<MetricValueType>(sums[0]);
+  }
+};
+
+template <class TInputImage, class TOutputMetricImage>
+struct BlockMatchingFunctorTraits< SSDBlockMatching<TInputImage, TOutputMetricImage> >
+{
+  static const bool CostVolume = true;
+  static const unsigned int MaximumNumberOfTerms = 1;
 };
 
 
@@ -108,6 +160,38 @@ public:
 
     return ssd;
   }
+
+  // Cost volume evaluation: the SSD of the normalized blocks expands into
+  // sums of a, b, a^2, b^2 and ab
+  unsigned int GetNumberOfTerms() const
+  {
+    return 5;
+  }
+
+  inline void ComputeTerms(double a, double b, double * terms) const
+  {
+    terms[0] = a;
+    terms[1] = b;
+    terms[2] = a*a;
+    terms[3] = b*b;
+    terms[4] = a*b;
+  }
+
+  inline MetricValueType operator()(const double * sums, double size) const
+  {
+    const double meana = sums[0]/size;
+    const double meanb = sums[1]/size;
+    const double ssd = sums[2]/(meana*meana) - 2*sums[4]/(meana*meanb) + sums[3]/(meanb*meanb);
+
+    return static_cast<MetricValueType>(ssd > 0 ? ssd : 0);
+  }
+};
+
+template <class TInputImage, class TOutputMetricImage>
+struct BlockMatchingFunctorTraits< SSDDivMeanBlockMatching<TInputImage, TOutputMetricImage> >
+{
+  static const bool CostVolume = true;
+  static const unsigned int MaximumNumberOfTerms = 5;
 };
 
 
@@ -179,6 +263,53 @@ public:
 
     return static_cast<MetricValueType>(ncc);
   }
+
+  // Cost volume evaluation: means, variances and covariance from the sums
+  // of a, b, a^2, b^2 and ab
+  unsigned int GetNumberOfTerms() const
+  {
+    return 5;
+  }
+
+  inline void ComputeTerms(double a, double b, double * terms) const
+  {
+    terms[0] = a;
+    terms[1] = b;
+    terms[2] = a*a;
+    terms[3] = b*b;
+    terms[4] = a*b;
+  }
+
+  inline MetricValueType operator()(const double * sums, double size) const
+  {
+    const double meanA = sums[0]/size;
+    const double meanB = sums[1]/size;
+
+    // Variances below the rounding error of the sums are null
+    double varA = (sums[2] - meanA*sums[0])/(size-1);
+    double varB = (sums[3] - meanB*sums[1])/(size-1);
+    if (varA <= 1e-12 * sums[2]/size) varA = 0;
+    if (varB <= 1e-12 * sums[3]/size) varB = 0;
+
+    const double cov = (sums[4] - meanA*sums[1])/(size-1);
+    const double sigmaA = vcl_sqrt(varA);
+    const double sigmaB = vcl_sqrt(varB);
+
+    double ncc = 0;
+    if(sigmaA > 1e-20 && sigmaB > 1e-20)
+      {
+      ncc = vcl_abs(cov)/(sigmaA*sigmaB);
+      }
+
+    return static_cast<MetricValueType>(ncc);
+  }
+};
+
+template <class TInputImage, class TOutputMetricImage>
+struct BlockMatchingFunctorTraits< NCCBlockMatching<TInputImage, TOutputMetricImage> >
+{
+  static const bool CostVolume = true;
+  static const unsigned int MaximumNumberOfTerms = 5;
 };
 
 /** \class LPBlockMatching
@@ -229,11 +360,34 @@ public:
     return score;
   }
 
+  // Cost volume evaluation: block sum of the L^p distances
+  unsigned int GetNumberOfTerms() const
+  {
+    return 1;
+  }
+
+  inline void ComputeTerms(double a, double b, double * terms) const
+  {
+    terms[0] = vcl_pow(vcl_abs(a-b), m_P);
+  }
+
+  inline MetricValueType operator()(const double * sums, double itkNotUsed(size)) const
+  {
+    return static_cast<MetricValueType>(sums[0]);
+  }
+
 private:
 
   double m_P;
 };
 
+template <class TInputImage, class TOutputMetricImage>
+struct BlockMatchingFunctorTraits< LPBlockMatching<TInputImage, TOutputMetricImage> >
+{
+  static const bool CostVolume = true;
+  static const unsigned int MaximumNumberOfTerms = 1;
+};
+
 } // End Namespace Functor
 
 /** \class PixelWiseBlockMatchingImageFilter
@@ -278,6 +432,16 @@ private:
  *  metric value and a disparity corresponding to the minimum allowed
  *  disparity.
  *
+ *  With CostVolumeOn(), functors supporting it (see
+ *  Functor::BlockMatchingFunctorTraits), which include all the functors
+ *  above, are evaluated on a cost volume: for each disparity, pixel-wise
+ *  terms are computed once and summed over the blocks with box filters,
+ *  at the pixels of the subsampled grid only, so that the processing time
+ *  does not depend on the radius. The metrics are computed from the sums
+ *  of the terms, which may differ from the neighborhood evaluation by
+ *  rounding errors, hence it is off by default and the functors are
+ *  evaluated on neighborhood iterators.
+ *
  *  The disparity exploration can also be reduced thanks to initial disparity
  *  maps. The user can provide initial disparity estimate (using the same image
  *  type and size as the output disparities), or global disparity values. Then
@@ -406,6 +570,12 @@ public:
   itkSetMacro(InitVerticalDisparity,int);
   itkGetConstReferenceMacro(InitVerticalDisparity,int);
 
+  /** Set/Get the evaluation of the metric on a cost volume, for functors
+   * supporting it (off by default) */
+  itkSetMacro(CostVolume, bool);
+  itkGetConstReferenceMacro(CostVolume, bool);
+  itkBooleanMacro(CostVolume);
+
   /** Get the functor for parameters setting */
   BlockMatchingFunctorType &  GetFunctor()
   {
@@ -465,6 +635,48 @@ private:
   PixelWiseBlockMatchingImageFilter(const Self&); //purposely not implemented
   void operator=(const Self&); //purposely not implemeFnted
 
+  typedef Functor::BlockMatchingFunctorTraits<TBlockMatchingFunctor> BlockMatchingFunctorTraitsType;
+
+  /** Tag dispatching on the support of the cost volume evaluation */
+  template <bool VCostVolume> struct CostVolumeTag {};
+
+  /** Evaluate the functor on neighborhood iterators */
+  void NeighborhoodThreadedGenerateData(const RegionType & outputRegionForThread, itk::ThreadIdType threadId);
+
+  /** Evaluate the functor on a cost volume */
+  void CostVolumeThreadedGenerateData(const RegionType & outputRegionForThread, itk::ThreadIdType threadId,
+                                      CostVolumeTag<true>);
+
+  /** Fall back on neighborhood iterators for other functors */
+  void CostVolumeThreadedGenerateData(const RegionType & outputRegionForThread, itk::ThreadIdType threadId,
+                                      CostVolumeTag<false>)
+  {
+    this->NeighborhoodThreadedGenerateData(outputRegionForThread, threadId);
+  }
+
+  /** Copy the pixels of an image over a region, with zeros outside of the
+   * buffered region like the constant boundary condition */
+  static void ExtractPaddedValues(const TInputImage * image, const RegionType & region, std::vector<double> & values);
+
+  /** Block sums of the functor terms over a region of the left image, for
+   * one disparity, at the pixels of the subsampled grid only, row by row.
+   * The values are the ones of ExtractPaddedValues(). */
+  void ComputeBlockSums(const std::vector<double> & leftValues, const RegionType & leftValuesRegion,
+                        const std::vector<double> & rightValues, const RegionType & rightValuesRegion,
+                        const RegionType & region, int hdisparity, int vdisparity,
+                        std::vector<double> & sums) const;
+
+  /** Offset of the first pixel of the subsampled grid from an index */
+  static unsigned int GetGridOffset(long index, long gridIndex, unsigned int step)
+  {
+    const long longStep = static_cast<long>(step);
+    return static_cast<unsigned int>(((gridIndex - index) % longStep + longStep) % longStep);
+  }
+
+  /** Is the disparity in the exploration range of a pixel */
+  inline bool IsExplored(int hdisparity, int vdisparity, bool useExplorationRadius,
+                         double initHDisparity, double initVDisparity) const;
+
   /** The radius of the blocks */
   SizeType                      m_Radius;
 
@@ -505,6 +717,9 @@ private:
    */
   IndexType                     m_GridIndex;
 
+  /** Evaluate the metric on a cost volume when the functor supports it */
+  bool                          m_CostVolume;
+
 };
 } // end namespace otb
 
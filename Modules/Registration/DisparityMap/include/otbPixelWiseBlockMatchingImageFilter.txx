@@ -25,6 +25,8 @@
 #include "itkProgressReporter.h"
 #include "itkConstantBoundaryCondition.h"
 
+#include <algorithm>
+
 namespace otb
 {
 template <class TInputImage, class TOutputMetricImage,
@@ -68,6 +70,9 @@ TOutputDisparityImage,TMaskImage,TBlockMatchingFunctor>
   // Default grid index
   m_GridIndex[0] = 0;
   m_GridIndex[1] = 0;
+
+  // Neighborhood evaluation by default
+  m_CostVolume = false;
 }
 
 
@@ -540,6 +545,59 @@ void
 PixelWiseBlockMatchingImageFilter<TInputImage,TOutputMetricImage,
 TOutputDisparityImage,TMaskImage,TBlockMatchingFunctor>
 ::ThreadedGenerateData(const RegionType& outputRegionForThread, itk::ThreadIdType threadId)
+{
+  if (m_CostVolume)
+    {
+    this->CostVolumeThreadedGenerateData(outputRegionForThread, threadId,
+                                         CostVolumeTag<BlockMatchingFunctorTraitsType::CostVolume>());
+    }
+  else
+    {
+    this->NeighborhoodThreadedGenerateData(outputRegionForThread, threadId);
+    }
+}
+
+template <class TInputImage, class TOutputMetricImage,
+class TOutputDisparityImage, class TMaskImage, class TBlockMatchingFunctor>
+bool
+PixelWiseBlockMatchingImageFilter<TInputImage,TOutputMetricImage,
+TOutputDisparityImage,TMaskImage,TBlockMatchingFunctor>
+::IsExplored(int hdisparity, int vdisparity, bool useExplorationRadius,
+             double initHDisparity, double initVDisparity) const
+{
+  int estimatedMinHDisp = m_MinimumHorizontalDisparity;
+  int estimatedMinVDisp = m_MinimumVerticalDisparity;
+  int estimatedMaxHDisp = m_MaximumHorizontalDisparity;
+  int estimatedMaxVDisp = m_MaximumVerticalDisparity;
+  if (useExplorationRadius)
+    {
+    // compute disparity bounds from initial position and exploration radius
+    estimatedMinHDisp = static_cast<int>(initHDisparity - static_cast<double>(m_ExplorationRadius[0]));
+    estimatedMinVDisp = static_cast<int>(initVDisparity - static_cast<double>(m_ExplorationRadius[1]));
+    estimatedMaxHDisp = static_cast<int>(initHDisparity + static_cast<double>(m_ExplorationRadius[0]));
+    estimatedMaxVDisp = static_cast<int>(initVDisparity + static_cast<double>(m_ExplorationRadius[1]));
+
+    // clamp to the minimum disparities
+    if (estimatedMinHDisp < m_MinimumHorizontalDisparity)
+      {
+      estimatedMinHDisp = m_MinimumHorizontalDisparity;
+      }
+    if (estimatedMinVDisp < m_MinimumVerticalDisparity)
+      {
+      estimatedMinVDisp = m_MinimumVerticalDisparity;
+      }
+    }
+
+  return vdisparity >= estimatedMinVDisp && vdisparity <= estimatedMaxVDisp &&
+         hdisparity >= estimatedMinHDisp && hdisparity <= estimatedMaxHDisp;
+}
+
+template <class TInputImage, class TOutputMetricImage,
+class TOutputDisparityImage, class TMaskImage, class TBlockMatchingFunctor>
+void
+PixelWiseBlockMatchingImageFilter<TInputImage,TOutputMetricImage,
+TOutputDisparityImage,TMaskImage,TBlockMatchingFunctor>
+::NeighborhoodThreadedGenerateData(const RegionType& outputRegionForThread, itk::ThreadIdType threadId)
 {
   // Retrieve pointers
   const TInputImage *     inLeftPtr    = this->GetLeftInput();
@@ -674,40 +732,10 @@ TOutputDisparityImage,TMaskImage,TBlockMatchingFunctor>
           {
           if(!inRightMaskPtr || (inRightMaskPtr && inRightMaskIt.Get() > 0) )
             {
-            int estimatedMinHDisp = m_MinimumHorizontalDisparity;
-            int estimatedMinVDisp = m_MinimumVerticalDisparity;
-            int estimatedMaxHDisp = m_MaximumHorizontalDisparity;
-            int estimatedMaxVDisp = m_MaximumVerticalDisparity;
-            if (useExplorationRadius)
-              {
-              // compute disparity bounds from initial position and exploration radius
-              if (useInitDispMaps)
-                {
-                estimatedMinHDisp = inHDispIt.Get() - m_ExplorationRadius[0];
-                estimatedMinVDisp = inVDispIt.Get() - m_ExplorationRadius[1];
-                estimatedMaxHDisp = inHDispIt.Get() + m_ExplorationRadius[0];
-                estimatedMaxVDisp = inVDispIt.Get() + m_ExplorationRadius[1];
-                }
-              else
-                {
-                estimatedMinHDisp = m_InitHorizontalDisparity - m_ExplorationRadius[0];
-                estimatedMinVDisp = m_InitVerticalDisparity - m_ExplorationRadius[1];
-                estimatedMaxHDisp = m_InitHorizontalDisparity + m_ExplorationRadius[0];
-                estimatedMaxVDisp = m_InitVerticalDisparity + m_ExplorationRadius[1];
-                }
-              // clamp to the minimum disparities
-              if (estimatedMinHDisp < m_MinimumHorizontalDisparity)
-                {
-                estimatedMinHDisp = m_MinimumHorizontalDisparity;
-                }
-              if (estimatedMinVDisp < m_MinimumVerticalDisparity)
-                {
-                estimatedMinVDisp = m_MinimumVerticalDisparity;
-                }
-              }
+            const double initHDisparity = useInitDispMaps ? static_cast<double>(inHDispIt.Get()) : m_InitHorizontalDisparity;
+            const double initVDisparity = useInitDispMaps ? static_cast<double>(inVDispIt.Get()) : m_InitVerticalDisparity;
 
-            if (vdisparity >= estimatedMinVDisp && vdisparity <= estimatedMaxVDisp &&
-                hdisparity >= estimatedMinHDisp && hdisparity <= estimatedMaxHDisp)
+            if (this->IsExplored(hdisparity, vdisparity, useExplorationRadius, initHDisparity, initVDisparity))
               {
               // Compute the block matching value
             double metric = m_Functor(leftIt,rightIt);
@@ -766,6 +794,316 @@ TOutputDisparityImage,TMaskImage,TBlockMatchingFunctor>
     }
 }
 
+template <class TInputImage, class TOutputMetricImage,
+class TOutputDisparityImage, class TMaskImage, class TBlockMatchingFunctor>
+void
+PixelWiseBlockMatchingImageFilter<TInputImage,TOutputMetricImage,
+TOutputDisparityImage,TMaskImage,TBlockMatchingFunctor>
+::ExtractPaddedValues(const TInputImage * image, const RegionType & region, std::vector<double> & values)
+{
+  values.assign(region.GetNumberOfPixels(), 0.);
+
+  RegionType bufferedRegion = region;
+  if (!bufferedRegion.Crop(image->GetBufferedRegion()))
+    {
+    return;
+    }
+
+  itk::ImageRegionConstIterator<TInputImage> it(image, bufferedRegion);
+  for (it.GoToBegin(); !it.IsAtEnd(); )
+    {
+    const IndexType index = it.GetIndex();
+    double * value = &values[(index[1] - region.GetIndex(1)) * region.GetSize(0) + index[0] - region.GetIndex(0)];
+    for (unsigned int x = 0; x < bufferedRegion.GetSize(0); ++x, ++it, ++value)
+      {
+      *value = static_cast<double>(it.Get());
+      }
+    }
+}
+
+template <class TInputImage, class TOutputMetricImage,
+class TOutputDisparityImage, class TMaskImage, class TBlockMatchingFunctor>
+void
+PixelWiseBlockMatchingImageFilter<TInputImage,TOutputMetricImage,
+TOutputDisparityImage,TMaskImage,TBlockMatchingFunctor>
+::ComputeBlockSums(const std::vector<double> & leftValues, const RegionType & leftValuesRegion,
+                   const std::vector<double> & rightValues, const RegionType & rightValuesRegion,
+                   const RegionType & region, int hdisparity, int vdisparity,
+                   std::vector<double> & sums) const
+{
+  const unsigned int nbTerms = m_Functor.GetNumberOfTerms();
+  const unsigned int width = region.GetSize(0);
+  const unsigned int height = region.GetSize(1);
+  const unsigned int radiusX = m_Radius[0];
+  const unsigned int radiusY = m_Radius[1];
+  const unsigned int paddedWidth = width + 2 * radiusX;
+  const unsigned int paddedHeight = height + 2 * radiusY;
+
+  // Pixels of the region on the subsampled grid
+  const unsigned int step = this->m_Step;
+  const unsigned int firstX = GetGridOffset(region.GetIndex(0), this->m_GridIndex[0], step);
+  const unsigned int firstY = GetGridOffset(region.GetIndex(1), this->m_GridIndex[1], step);
+  const unsigned int nbX = firstX < width ? (width - firstX - 1) / step + 1 : 0;
+  const unsigned int nbY = firstY < height ? (height - firstY - 1) / step + 1 : 0;
+
+  sums.resize(static_cast<std::size_t>(nbX) * nbY * nbTerms);
+  if (nbX == 0 || nbY == 0)
+    {
+    return;
+    }
+
+  // Pixel-wise terms over the rows of the blocks of the grid, in the region
+  // padded by the radius, computed once for all the blocks. Terms are
+  // interleaved.
+  std::vector<bool> neededRows(paddedHeight, false);
+  for (unsigned int y = firstY; y < height; y += step)
+    {
+    std::fill(neededRows.begin() + y, neededRows.begin() + y + 2 * radiusY + 1, true);
+    }
+
+  std::vector<double> terms(static_cast<std::size_t>(paddedWidth) * paddedHeight * nbTerms);
+  const long startX = region.GetIndex(0) - static_cast<long>(radiusX);
+  const long startY = region.GetIndex(1) - static_cast<long>(radiusY);
+  for (unsigned int row = 0; row < paddedHeight; ++row)
+    {
+    if (!neededRows[row])
+      {
+      continue;
+      }
+    const double * left = &leftValues[(startY + row - leftValuesRegion.GetIndex(1)) * leftValuesRegion.GetSize(0)
+                                      + startX - leftValuesRegion.GetIndex(0)];
+    const double * right = &rightValues[(startY + row + vdisparity - rightValuesRegion.GetIndex(1)) * rightValuesRegion.GetSize(0)
+                                        + startX + hdisparity - rightValuesRegion.GetIndex(0)];
+    double * rowTerms = &terms[static_cast<std::size_t>(row) * paddedWidth * nbTerms];
+    for (unsigned int col = 0; col < paddedWidth; ++col, rowTerms += nbTerms)
+      {
+      m_Functor.ComputeTerms(left[col], right[col], rowTerms);
+      }
+    }
+
+  // Box filter: column sums over the block height, moved from one row of
+  // the grid to the next, then running sums along the row, moved from one
+  // column of the grid to the next. Blocks which do not overlap are summed
+  // from scratch.
+  std::vector<double> columnSums(static_cast<std::size_t>(paddedWidth) * nbTerms);
+  double blockSums[BlockMatchingFunctorTraitsType::MaximumNumberOfTerms];
+  double * gridSums = &sums[0];
+  for (unsigned int y = firstY; y < height; y += step)
+    {
+    if (y == firstY || step > 2 * radiusY)
+      {
+      std::fill(columnSums.begin(), columnSums.end(), 0.);
+      for (unsigned int row = y; row < y + 2 * radiusY + 1; ++row)
+        {
+        const double * rowTerms = &terms[static_cast<std::size_t>(row) * paddedWidth * nbTerms];
+        for (unsigned int i = 0; i < paddedWidth * nbTerms; ++i)
+          {
+          columnSums[i] += rowTerms[i];
+          }
+        }
+      }
+    else
+      {
+      for (unsigned int row = y - step; row < y; ++row)
+        {
+        const double * enteringTerms = &terms[static_cast<std::size_t>(row + 2 * radiusY + 1) * paddedWidth * nbTerms];
+        const double * leavingTerms = &terms[static_cast<std::size_t>(row) * paddedWidth * nbTerms];
+        for (unsigned int i = 0; i < paddedWidth * nbTerms; ++i)
+          {
+          columnSums[i] += enteringTerms[i] - leavingTerms[i];
+          }
+        }
+      }
+
+    for (unsigned int x = firstX; x < width; x += step, gridSums += nbTerms)
+      {
+      if (x == firstX || step > 2 * radiusX)
+        {
+        std::fill(blockSums, blockSums + nbTerms, 0.);
+        for (unsigned int col = x; col < x + 2 * radiusX + 1; ++col)
+          {
+          for (unsigned int k = 0; k < nbTerms; ++k)
+            {
+            blockSums[k] += columnSums[col * nbTerms + k];
+            }
+          }
+        }
+      else
+        {
+        for (unsigned int col = x - step; col < x; ++col)
+          {
+          for (unsigned int k = 0; k < nbTerms; ++k)
+            {
+            blockSums[k] += columnSums[(col + 2 * radiusX + 1) * nbTerms + k] - columnSums[col * nbTerms + k];
+            }
+          }
+        }
+      std::copy(blockSums, blockSums + nbTerms, gridSums);
+      }
+    }
+}
+
+template <class TInputImage, class TOutputMetricImage,
+class TOutputDisparityImage, class TMaskImage, class TBlockMatchingFunctor>
+void
+PixelWiseBlockMatchingImageFilter<TInputImage,TOutputMetricImage,
+TOutputDisparityImage,TMaskImage,TBlockMatchingFunctor>
+::CostVolumeThreadedGenerateData(const RegionType& outputRegionForThread, itk::ThreadIdType threadId,
+                                 CostVolumeTag<true>)
+{
+  // Retrieve pointers
+  const TInputImage *     inLeftPtr    = this->GetLeftInput();
+  const TInputImage *     inRightPtr   = this->GetRightInput();
+  const TMaskImage  *     inLeftMaskPtr    = this->GetLeftMaskInput();
+  const TMaskImage  *     inRightMaskPtr    = this->GetRightMaskInput();
+  const TOutputDisparityImage * inHDispPtr = this->GetHorizontalDisparityInput();
+  const TOutputDisparityImage * inVDispPtr = this->GetVerticalDisparityInput();
+  TOutputMetricImage    * outMetricPtr = this->GetMetricOutput();
+  TOutputDisparityImage * outHDispPtr   = this->GetHorizontalDisparityOutput();
+  TOutputDisparityImage * outVDispPtr   = this->GetVerticalDisparityOutput();
+
+  // Set-up progress reporting, as for the neighborhood evaluation
+  itk::ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels()*(m_MaximumHorizontalDisparity - m_MinimumHorizontalDisparity + 1)*(m_MaximumVerticalDisparity - m_MinimumVerticalDisparity + 1),100);
+
+  // Pixels whose outputs have been initialized
+  std::vector<bool> initialized(outputRegionForThread.GetNumberOfPixels(), false);
+
+  // Compute region for thread at full resolution
+  RegionType fullRegionForThread = this->ConvertSubsampledToFullRegion(outputRegionForThread, this->m_Step, this->m_GridIndex);
+
+  // Check if we use initial disparities and exploration radius
+  bool useExplorationRadius = false;
+  bool useInitDispMaps = false;
+  if (m_ExplorationRadius[0] >= 1 || m_ExplorationRadius[1] >= 1)
+    {
+    useExplorationRadius = true;
+    if (inHDispPtr && inVDispPtr)
+      {
+      useInitDispMaps = true;
+      }
+    }
+
+  // step value as disparityType
+  DisparityPixelType stepDisparityInv = 1. / static_cast<DisparityPixelType>(this->m_Step);
+
+  // Pixel values read once for all disparities: the left pixels of the
+  // blocks, and the right pixels of the blocks shifted by any disparity
+  RegionType leftValuesRegion = fullRegionForThread;
+  leftValuesRegion.PadByRadius(m_Radius);
+
+  IndexType rightValuesIndex = leftValuesRegion.GetIndex();
+  rightValuesIndex[0] += m_MinimumHorizontalDisparity;
+  rightValuesIndex[1] += m_MinimumVerticalDisparity;
+  SizeType rightValuesSize = leftValuesRegion.GetSize();
+  rightValuesSize[0] += m_MaximumHorizontalDisparity - m_MinimumHorizontalDisparity;
+  rightValuesSize[1] += m_MaximumVerticalDisparity - m_MinimumVerticalDisparity;
+  RegionType rightValuesRegion(rightValuesIndex, rightValuesSize);
+
+  std::vector<double> leftValues, rightValues, sums;
+  ExtractPaddedValues(inLeftPtr, leftValuesRegion, leftValues);
+  ExtractPaddedValues(inRightPtr, rightValuesRegion, rightValues);
+
+  const unsigned int nbTerms = m_Functor.GetNumberOfTerms();
+  const double blockSize = static_cast<double>((2 * m_Radius[0] + 1) * (2 * m_Radius[1] + 1));
+
+  // We loop on disparities
+  for(int vdisparity = m_MinimumVerticalDisparity; vdisparity <= m_MaximumVerticalDisparity; ++vdisparity)
+    {
+  for(int hdisparity = m_MinimumHorizontalDisparity; hdisparity <= m_MaximumHorizontalDisparity; ++hdisparity)
+    {
+    // First, we cast output region to the right image
+    IndexType rightRequestedRegionIndex = fullRegionForThread.GetIndex();
+    rightRequestedRegionIndex[0]+=hdisparity;
+    rightRequestedRegionIndex[1]+=vdisparity;
+
+    // We crop
+    RegionType inputRightRegion;
+    inputRightRegion.SetIndex(rightRequestedRegionIndex);
+    inputRightRegion.SetSize(fullRegionForThread.GetSize());
+    if (!inputRightRegion.Crop(inRightPtr->GetLargestPossibleRegion()))
+      {
+      continue;
+      }
+
+    // And then cast back
+    IndexType leftRequestedRegionIndex = inputRightRegion.GetIndex();
+    leftRequestedRegionIndex[0]-=hdisparity;
+    leftRequestedRegionIndex[1]-=vdisparity;
+
+    RegionType inputLeftRegion;
+    inputLeftRegion.SetIndex(leftRequestedRegionIndex);
+    inputLeftRegion.SetSize(inputRightRegion.GetSize());
+
+    // Block sums of the functor terms for this disparity
+    this->ComputeBlockSums(leftValues, leftValuesRegion, rightValues, rightValuesRegion,
+                           inputLeftRegion, hdisparity, vdisparity, sums);
+
+    const IndexType regionIndex = inputLeftRegion.GetIndex();
+    const SizeType  regionSize = inputLeftRegion.GetSize();
+    const double *  blockSums = sums.empty() ? ITK_NULLPTR : &sums[0];
+
+    // The sums are only computed on the subsampled grid
+    const unsigned int firstX = GetGridOffset(regionIndex[0], this->m_GridIndex[0], this->m_Step);
+    const unsigned int firstY = GetGridOffset(regionIndex[1], this->m_GridIndex[1], this->m_Step);
+    for (unsigned int y = firstY; y < regionSize[1]; y += this->m_Step)
+      {
+      IndexType index;
+      index[1] = regionIndex[1] + y;
+
+      for (unsigned int x = firstX; x < regionSize[0]; x += this->m_Step, blockSums += nbTerms)
+        {
+        index[0] = regionIndex[0] + x;
+
+        IndexType outIndex;
+        outIndex[0] = (index[0] - this->m_GridIndex[0]) / static_cast<long>(this->m_Step);
+        outIndex[1] = (index[1] - this->m_GridIndex[1]) / static_cast<long>(this->m_Step);
+        progress.CompletedPixel();
+
+        // If the masks are present and valid
+        if (inLeftMaskPtr && !(inLeftMaskPtr->GetPixel(index) > 0))
+          {
+          continue;
+          }
+        if (inRightMaskPtr)
+          {
+          IndexType rightIndex = index;
+          rightIndex[0] += hdisparity;
+          rightIndex[1] += vdisparity;
+          if (!(inRightMaskPtr->GetPixel(rightIndex) > 0))
+            {
+            continue;
+            }
+          }
+
+        const double initHDisparity = useInitDispMaps ? static_cast<double>(inHDispPtr->GetPixel(index)) : m_InitHorizontalDisparity;
+        const double initVDisparity = useInitDispMaps ? static_cast<double>(inVDispPtr->GetPixel(index)) : m_InitVerticalDisparity;
+        if (!this->IsExplored(hdisparity, vdisparity, useExplorationRadius, initHDisparity, initVDisparity))
+          {
+          continue;
+          }
+
+        // Compute the block matching value from the block sums
+        double metric = m_Functor(blockSums, blockSize);
+
+        // If we are at first visit, fill both outputs
+        // We adapt the disparity value to keep consistent with disparity map index space
+        const std::size_t offset = (outIndex[1] - outputRegionForThread.GetIndex(1)) * outputRegionForThread.GetSize(0)
+          + outIndex[0] - outputRegionForThread.GetIndex(0);
+        if (!initialized[offset]
+            || (m_Minimize && metric < outMetricPtr->GetPixel(outIndex))
+            || (!m_Minimize && metric > outMetricPtr->GetPixel(outIndex)))
+          {
+          outHDispPtr->SetPixel(outIndex, static_cast<DisparityPixelType>(hdisparity) * stepDisparityInv);
+          outVDispPtr->SetPixel(outIndex, static_cast<DisparityPixelType>(vdisparity) * stepDisparityInv);
+          outMetricPtr->SetPixel(outIndex, metric);
+          initialized[offset] = true;
+          }
+        }
+      }
+    }
+    }
+}
+
 template <class TInputImage, class TOutputMetricImage,
 class TOutputDisparityImage, class TMaskImage, class TBlockMatchingFunctor>
 typename PixelWiseBlockMatchingImageFilter<TInputImage,TOutputMetricImage,
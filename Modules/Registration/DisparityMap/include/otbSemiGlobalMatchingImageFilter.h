@@ -0,0 +1,286 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbSemiGlobalMatchingImageFilter_h
+#define otbSemiGlobalMatchingImageFilter_h
+
+#include "itkImageToImageFilter.h"
+#include "itkIntTypes.h"
+#include "otbImage.h"
+
+#include <vector>
+
+namespace otb
+{
+
+/** \class SemiGlobalMatchingImageFilter
+ *  \brief Estimate horizontal disparities between epipolar images with Semi-Global Matching
+ *
+ *  The filter computes, for each pixel of the left image and each horizontal
+ *  disparity between the minimum and maximum disparities, a pixel-wise
+ *  matching cost, which is either:
+ *  - CENSUS : the Hamming distance between the census transforms of the left
+ *    and right blocks (a block has at most 64 pixels besides its center);
+ *  - SSD : the root mean square difference between the left and right blocks,
+ *    multiplied by SSDCostScale and saturated to 255.
+ *
+ *  Costs are then aggregated along 4, 8 or 16 paths: for each path direction r,
+ *  L_r(p,d) = C(p,d) + min(L_r(p-r,d), L_r(p-r,d-1)+P1, L_r(p-r,d+1)+P1,
+ *  min_k L_r(p-r,k)+P2) - min_k L_r(p-r,k). The disparity of each pixel is the
+ *  one minimizing the sum S(p,d) of the path costs, and the metric output holds
+ *  this minimum (the lower, the better). Path and aggregated costs are stored
+ *  as 16-bit integers in contiguous arrays over disparities, so that the
+ *  aggregation loops can be vectorized by the compiler. P1 and P2 must be such
+ *  that the aggregated costs fit in 16 bits, which is checked before
+ *  processing.
+ *
+ *  The filter streams: each requested region (and each thread region) is
+ *  processed independently, with paths starting at a distance of Overlap
+ *  pixels around it. The outputs therefore depend slightly on the splitting,
+ *  the larger the overlap, the smaller the difference to a processing of the
+ *  whole image.
+ *
+ *  Masks are optional. Costs involving a right pixel with a non-positive mask
+ *  value, or outside of the right image, are saturated. Left pixels with a
+ *  non-positive mask value do not weight on the aggregation, and exhibit a
+ *  null metric and a disparity equal to the maximum disparity, like in
+ *  PixelWiseBlockMatchingImageFilter.
+ *
+ *  The outputs are the same as the ones of PixelWiseBlockMatchingImageFilter:
+ *  metric, horizontal disparity and vertical disparity (null, the inputs being
+ *  in epipolar geometry). Disparities are integer, they can be refined with
+ *  SubPixelDisparityImageFilter and converted to 3D points with
+ *  DisparityMapTo3DFilter.
+ *
+ *  \sa PixelWiseBlockMatchingImageFilter
+ *  \sa SubPixelDisparityImageFilter
+ *
+ *  \ingroup Streamed
+ *  \ingroup Threaded
+ *
+ * \ingroup OTBDisparityMap
+ */
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage = TOutputMetricImage,
+          class TMaskImage = otb::Image<unsigned char> >
+class ITK_EXPORT SemiGlobalMatchingImageFilter :
+    public itk::ImageToImageFilter<TInputImage,TOutputDisparityImage>
+{
+public:
+  /** Standard class typedef */
+  typedef SemiGlobalMatchingImageFilter                     Self;
+  typedef itk::ImageToImageFilter<TInputImage,
+                                  TOutputDisparityImage>    Superclass;
+  typedef itk::SmartPointer<Self>                           Pointer;
+  typedef itk::SmartPointer<const Self>                     ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(SemiGlobalMatchingImageFilter, ImageToImageFilter);
+
+  /** Useful typedefs */
+  typedef TInputImage                                       InputImageType;
+  typedef TOutputMetricImage                                OutputMetricImageType;
+  typedef TOutputDisparityImage                             OutputDisparityImageType;
+  typedef TMaskImage                                        InputMaskImageType;
+
+  typedef typename InputImageType::SizeType                 SizeType;
+  typedef typename InputImageType::IndexType                IndexType;
+  typedef typename InputImageType::RegionType               RegionType;
+
+  typedef typename TOutputMetricImage::ValueType            MetricValueType;
+  typedef typename OutputDisparityImageType::PixelType      DisparityPixelType;
+
+  /** Type of the path and aggregated costs */
+  typedef itk::uint16_t                                     CostType;
+
+  itkStaticConstMacro(CENSUS,int,0);
+  itkStaticConstMacro(SSD,int,1);
+
+  /** Set left input */
+  void SetLeftInput( const TInputImage * image);
+
+  /** Set right input */
+  void SetRightInput( const TInputImage * image);
+
+  /** Set mask input (optional) */
+  void SetLeftMaskInput(const TMaskImage * image);
+
+  /** Set right mask input (optional) */
+  void SetRightMaskInput(const TMaskImage * image);
+
+  /** Get the inputs */
+  const TInputImage * GetLeftInput() const;
+  const TInputImage * GetRightInput() const;
+  const TMaskImage  * GetLeftMaskInput() const;
+  const TMaskImage  * GetRightMaskInput() const;
+
+  /** Get the metric output */
+  const TOutputMetricImage * GetMetricOutput() const;
+  TOutputMetricImage * GetMetricOutput();
+
+  /** Get the disparity output */
+  const TOutputDisparityImage * GetHorizontalDisparityOutput() const;
+  TOutputDisparityImage * GetHorizontalDisparityOutput();
+
+  /** Get the disparity output */
+  const TOutputDisparityImage * GetVerticalDisparityOutput() const;
+  TOutputDisparityImage * GetVerticalDisparityOutput();
+
+  /** Set unsigned int radius */
+  void SetRadius(unsigned int radius)
+  {
+    m_Radius.Fill(radius);
+  }
+
+  /** Set/Get the radius of the blocks on which the matching cost is evaluated */
+  itkSetMacro(Radius, SizeType);
+  itkGetConstReferenceMacro(Radius, SizeType);
+
+  /*** Set/Get the minimum disparity to explore */
+  itkSetMacro(MinimumHorizontalDisparity,int);
+  itkGetConstReferenceMacro(MinimumHorizontalDisparity,int);
+
+  /*** Set/Get the maximum disparity to explore */
+  itkSetMacro(MaximumHorizontalDisparity,int);
+  itkGetConstReferenceMacro(MaximumHorizontalDisparity,int);
+
+  /** Set/Get the matching cost (CENSUS or SSD) */
+  itkSetMacro(MatchingCost,int);
+  itkGetMacro(MatchingCost,int);
+
+  /** Set/Get the factor applied to the root mean square difference in the
+   * SSD matching cost, so that costs of different dynamics are in [0,255] */
+  itkSetMacro(SSDCostScale,double);
+  itkGetMacro(SSDCostScale,double);
+
+  /** Set/Get the penalty of disparity changes of one pixel along paths */
+  itkSetMacro(P1,unsigned int);
+  itkGetMacro(P1,unsigned int);
+
+  /** Set/Get the penalty of disparity changes of more than one pixel along paths */
+  itkSetMacro(P2,unsigned int);
+  itkGetMacro(P2,unsigned int);
+
+  /** Set/Get the number of aggregation paths (4, 8 or 16) */
+  itkSetMacro(NumberOfPaths,unsigned int);
+  itkGetMacro(NumberOfPaths,unsigned int);
+
+  /** Set/Get the distance (in pixels) around each processed region from
+   * which the aggregation paths start */
+  itkSetMacro(Overlap,unsigned int);
+  itkGetMacro(Overlap,unsigned int);
+
+  /** Maximum value of the pixel-wise matching cost */
+  CostType GetMaximumCost() const;
+
+protected:
+  /** Constructor */
+  SemiGlobalMatchingImageFilter();
+
+  /** Destructor */
+  ~SemiGlobalMatchingImageFilter() ITK_OVERRIDE {}
+
+  /** Generate output information */
+  void GenerateOutputInformation() ITK_OVERRIDE;
+
+  /** Generate input requested region */
+  void GenerateInputRequestedRegion() ITK_OVERRIDE;
+
+  /** Before threaded generate data */
+  void BeforeThreadedGenerateData() ITK_OVERRIDE;
+
+  /** Threaded generate data */
+  void ThreadedGenerateData(const RegionType & outputRegionForThread, itk::ThreadIdType threadId) ITK_OVERRIDE;
+
+  void PrintSelf(std::ostream& os, itk::Indent indent) const ITK_OVERRIDE;
+
+private:
+  SemiGlobalMatchingImageFilter(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+  /** Check the parameters, throw an exception if they are not consistent */
+  void CheckParameters() const;
+
+  /** Copy the pixels of an image over a region, with zeros outside of the
+   * buffered region */
+  static void ExtractPaddedValues(const TInputImage * image, const RegionType & region, std::vector<double> & values);
+
+  /** Validity of the pixels of a mask over a region, pixels outside of the
+   * largest region or with a non-positive mask value being invalid */
+  static void ExtractValidity(const TInputImage * image, const TMaskImage * mask, const RegionType & region,
+                              std::vector<bool> & validity);
+
+  /** Census transforms of the pixels of a region, from the values of
+   * ExtractPaddedValues() over the region padded by the radius */
+  void ComputeCensus(const std::vector<double> & values, const RegionType & region,
+                     std::vector<itk::uint64_t> & census) const;
+
+  /** Pixel-wise matching costs over a region of the left image, stored as
+   * costs[(y*width+x)*nbDisparities+d], and validity of the left pixels */
+  void ComputeCosts(const RegionType & region, std::vector<CostType> & costs,
+                    std::vector<bool> & leftValidity) const;
+
+  /** Add the path costs along one direction to the aggregated costs */
+  void AggregatePath(const std::vector<CostType> & costs, unsigned int width, unsigned int height,
+                     int dx, int dy, std::vector<CostType> & sums) const;
+
+  /** Number of bits set in a census difference */
+  static inline unsigned int HammingWeight(itk::uint64_t value)
+  {
+    value = value - ((value >> 1) & 0x5555555555555555ULL);
+    value = (value & 0x3333333333333333ULL) + ((value >> 2) & 0x3333333333333333ULL);
+    value = (value + (value >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return static_cast<unsigned int>((value * 0x0101010101010101ULL) >> 56);
+  }
+
+  /** The radius of the blocks */
+  SizeType                      m_Radius;
+
+  /** The min disparity to explore */
+  int                           m_MinimumHorizontalDisparity;
+
+  /** The max disparity to explore */
+  int                           m_MaximumHorizontalDisparity;
+
+  /** Matching cost (CENSUS or SSD) */
+  int                           m_MatchingCost;
+
+  /** Scale of the SSD matching cost */
+  double                        m_SSDCostScale;
+
+  /** Penalties of small and large disparity changes */
+  unsigned int                  m_P1;
+  unsigned int                  m_P2;
+
+  /** Number of aggregation paths */
+  unsigned int                  m_NumberOfPaths;
+
+  /** Margin of the aggregation around processed regions */
+  unsigned int                  m_Overlap;
+};
+} // end namespace otb
+
+#ifndef OTB_MANUAL_INSTANTIATION
+#include "otbSemiGlobalMatchingImageFilter.txx"
+#endif
+
+#endif
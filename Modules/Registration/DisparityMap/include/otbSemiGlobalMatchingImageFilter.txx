@@ -0,0 +1,782 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbSemiGlobalMatchingImageFilter_txx
+#define otbSemiGlobalMatchingImageFilter_txx
+
+#include "otbSemiGlobalMatchingImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+#include "itkProgressReporter.h"
+#include "itkNumericTraits.h"
+#include "vcl_cmath.h"
+
+#include <algorithm>
+
+namespace otb
+{
+
+namespace
+{
+// Aggregation path directions: the first 4, 8 or 16 are used
+const int SemiGlobalMatchingPathDirections[16][2] = {
+  { 1, 0}, {-1, 0}, { 0, 1}, { 0,-1},
+  { 1, 1}, {-1, 1}, { 1,-1}, {-1,-1},
+  { 2, 1}, {-2, 1}, { 2,-1}, {-2,-1},
+  { 1, 2}, {-1, 2}, { 1,-2}, {-1,-2}};
+
+// Saturation of the SSD matching cost
+const unsigned int SemiGlobalMatchingMaximumSSDCost = 255;
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+SemiGlobalMatchingImageFilter<TInputImage,TOutputMetricImage,TOutputDisparityImage,TMaskImage>
+::SemiGlobalMatchingImageFilter()
+{
+  // Set the number of inputs
+  this->SetNumberOfRequiredInputs(2);
+
+  // Set the outputs
+  this->SetNumberOfRequiredOutputs(3);
+  this->SetNthOutput(0,TOutputMetricImage::New());
+  this->SetNthOutput(1,TOutputDisparityImage::New());
+  this->SetNthOutput(2,TOutputDisparityImage::New());
+
+  // Default parameters
+  m_Radius.Fill(2);
+  m_MinimumHorizontalDisparity = -10;
+  m_MaximumHorizontalDisparity =  10;
+  m_MatchingCost = CENSUS;
+  m_SSDCostScale = 1.;
+  m_P1 = 4;
+  m_P2 = 32;
+  m_NumberOfPaths = 8;
+  m_Overlap = 32;
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+void
+SemiGlobalMatchingImageFilter<TInputImage,TOutputMetricImage,TOutputDisparityImage,TMaskImage>
+::SetLeftInput(const TInputImage * image)
+{
+  // Process object is not const-correct so the const casting is required.
+  this->SetNthInput(0, const_cast<TInputImage *>( image ));
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+void
+SemiGlobalMatchingImageFilter<TInputImage,TOutputMetricImage,TOutputDisparityImage,TMaskImage>
+::SetRightInput(const TInputImage * image)
+{
+  // Process object is not const-correct so the const casting is required.
+  this->SetNthInput(1, const_cast<TInputImage *>( image ));
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+void
+SemiGlobalMatchingImageFilter<TInputImage,TOutputMetricImage,TOutputDisparityImage,TMaskImage>
+::SetLeftMaskInput(const TMaskImage * image)
+{
+  // Process object is not const-correct so the const casting is required.
+  this->SetNthInput(2, const_cast<TMaskImage *>( image ));
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+void
+SemiGlobalMatchingImageFilter<TInputImage,TOutputMetricImage,TOutputDisparityImage,TMaskImage>
+::SetRightMaskInput(const TMaskImage * image)
+{
+  // Process object is not const-correct so the const casting is required.
+  this->SetNthInput(3, const_cast<TMaskImage *>( image ));
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+const TInputImage *
+SemiGlobalMatchingImageFilter<TInputImage,TOutputMetricImage,TOutputDisparityImage,TMaskImage>
+::GetLeftInput() const
+{
+  if (this->GetNumberOfInputs()<1)
+    {
+    return ITK_NULLPTR;
+    }
+  return static_cast<const TInputImage *>(this->itk::ProcessObject::GetInput(0));
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+const TInputImage *
+SemiGlobalMatchingImageFilter<TInputImage,TOutputMetricImage,TOutputDisparityImage,TMaskImage>
+::GetRightInput() const
+{
+  if(this->GetNumberOfInputs()<2)
+    {
+    return ITK_NULLPTR;
+    }
+  return static_cast<const TInputImage *>(this->itk::ProcessObject::GetInput(1));
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+const TMaskImage *
+SemiGlobalMatchingImageFilter<TInputImage,TOutputMetricImage,TOutputDisparityImage,TMaskImage>
+::GetLeftMaskInput() const
+{
+  if(this->GetNumberOfInputs()<3)
+    {
+    return ITK_NULLPTR;
+    }
+  return static_cast<const TMaskImage *>(this->itk::ProcessObject::GetInput(2));
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+const TMaskImage *
+SemiGlobalMatchingImageFilter<TInputImage,TOutputMetricImage,TOutputDisparityImage,TMaskImage>
+::GetRightMaskInput() const
+{
+  if(this->GetNumberOfInputs()<4)
+    {
+    return ITK_NULLPTR;
+    }
+  return static_cast<const TMaskImage *>(this->itk::ProcessObject::GetInput(3));
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+const TOutputMetricImage *
+SemiGlobalMatchingImageFilter<TInputImage,TOutputMetricImage,TOutputDisparityImage,TMaskImage>
+::GetMetricOutput() const
+{
+  if (this->GetNumberOfOutputs()<1)
+    {
+    return ITK_NULLPTR;
+    }
+  return static_cast<const TOutputMetricImage *>(this->itk::ProcessObject::GetOutput(0));
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+TOutputMetricImage *
+SemiGlobalMatchingImageFilter<TInputImage,TOutputMetricImage,TOutputDisparityImage,TMaskImage>
+::GetMetricOutput()
+{
+  if (this->GetNumberOfOutputs()<1)
+    {
+    return ITK_NULLPTR;
+    }
+  return static_cast<TOutputMetricImage *>(this->itk::ProcessObject::GetOutput(0));
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+const TOutputDisparityImage *
+SemiGlobalMatchingImageFilter<TInputImage,TOutputMetricImage,TOutputDisparityImage,TMaskImage>
+::GetHorizontalDisparityOutput() const
+{
+  if (this->GetNumberOfOutputs()<2)
+    {
+    return ITK_NULLPTR;
+    }
+  return static_cast<const TOutputDisparityImage *>(this->itk::ProcessObject::GetOutput(1));
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+TOutputDisparityImage *
+SemiGlobalMatchingImageFilter<TInputImage,TOutputMetricImage,TOutputDisparityImage,TMaskImage>
+::GetHorizontalDisparityOutput()
+{
+  if (this->GetNumberOfOutputs()<2)
+    {
+    return ITK_NULLPTR;
+    }
+  return static_cast<TOutputDisparityImage *>(this->itk::ProcessObject::GetOutput(1));
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+const TOutputDisparityImage *
+SemiGlobalMatchingImageFilter<TInputImage,TOutputMetricImage,TOutputDisparityImage,TMaskImage>
+::GetVerticalDisparityOutput() const
+{
+  if (this->GetNumberOfOutputs()<3)
+    {
+    return ITK_NULLPTR;
+    }
+  return static_cast<const TOutputDisparityImage *>(this->itk::ProcessObject::GetOutput(2));
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+TOutputDisparityImage *
+SemiGlobalMatchingImageFilter<TInputImage,TOutputMetricImage,TOutputDisparityImage,TMaskImage>
+::GetVerticalDisparityOutput()
+{
+  if (this->GetNumberOfOutputs()<3)
+    {
+    return ITK_NULLPTR;
+    }
+  return static_cast<TOutputDisparityImage *>(this->itk::ProcessObject::GetOutput(2));
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+typename SemiGlobalMatchingImageFilter<TInputImage,TOutputMetricImage,TOutputDisparityImage,TMaskImage>::CostType
+SemiGlobalMatchingImageFilter<TInputImage,TOutputMetricImage,TOutputDisparityImage,TMaskImage>
+::GetMaximumCost() const
+{
+  if (m_MatchingCost == CENSUS)
+    {
+    return static_cast<CostType>((2 * m_Radius[0] + 1) * (2 * m_Radius[1] + 1) - 1);
+    }
+  return static_cast<CostType>(SemiGlobalMatchingMaximumSSDCost);
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+void
+SemiGlobalMatchingImageFilter<TInputImage,TOutputMetricImage,TOutputDisparityImage,TMaskImage>
+::CheckParameters() const
+{
+  if (m_MinimumHorizontalDisparity > m_MaximumHorizontalDisparity)
+    {
+    itkExceptionMacro(<<"Minimum horizontal disparity ("<<m_MinimumHorizontalDisparity
+                      <<") is greater than the maximum horizontal disparity ("<<m_MaximumHorizontalDisparity<<")");
+    }
+  if (m_MatchingCost != CENSUS && m_MatchingCost != SSD)
+    {
+    itkExceptionMacro(<<"Unknown matching cost "<<m_MatchingCost);
+    }
+  if (m_MatchingCost == CENSUS && (2 * m_Radius[0] + 1) * (2 * m_Radius[1] + 1) - 1 > 64)
+    {
+    itkExceptionMacro(<<"Census blocks are limited to 64 pixels besides their center, radius "<<m_Radius<<" is too large");
+    }
+  if (m_NumberOfPaths != 4 && m_NumberOfPaths != 8 && m_NumberOfPaths != 16)
+    {
+    itkExceptionMacro(<<"The number of paths must be 4, 8 or 16, not "<<m_NumberOfPaths);
+    }
+
+  // Path costs are bounded by the maximum cost plus P2
+  const unsigned long maximumSum = static_cast<unsigned long>(m_NumberOfPaths)
+    * (static_cast<unsigned long>(this->GetMaximumCost()) + m_P2);
+  if (maximumSum > static_cast<unsigned long>(itk::NumericTraits<CostType>::max()))
+    {
+    itkExceptionMacro(<<"Aggregated costs may overflow with P2 = "<<m_P2<<" and "<<m_NumberOfPaths
+                      <<" paths (maximum matching cost is "<<this->GetMaximumCost()<<")");
+    }
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+void
+SemiGlobalMatchingImageFilter<TInputImage,TOutputMetricImage,TOutputDisparityImage,TMaskImage>
+::GenerateOutputInformation()
+{
+  // Call superclass implementation
+  Superclass::GenerateOutputInformation();
+
+  this->CheckParameters();
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+void
+SemiGlobalMatchingImageFilter<TInputImage,TOutputMetricImage,TOutputDisparityImage,TMaskImage>
+::GenerateInputRequestedRegion()
+{
+  // Call superclass implementation
+  Superclass::GenerateInputRequestedRegion();
+
+  // Retrieve input pointers
+  TInputImage * inLeftPtr  = const_cast<TInputImage *>(this->GetLeftInput());
+  TInputImage * inRightPtr = const_cast<TInputImage *>(this->GetRightInput());
+  TMaskImage *  inLeftMaskPtr  = const_cast<TMaskImage * >(this->GetLeftMaskInput());
+  TMaskImage *  inRightMaskPtr  = const_cast<TMaskImage * >(this->GetRightMaskInput());
+
+  TOutputMetricImage    * outMetricPtr = this->GetMetricOutput();
+
+  // Check pointers before using them
+  if(!inLeftPtr || !inRightPtr || !outMetricPtr)
+    {
+    return;
+    }
+
+  // Now, we impose that both inputs have the same size
+  if(inLeftPtr->GetLargestPossibleRegion()
+     != inRightPtr->GetLargestPossibleRegion())
+    {
+    itkExceptionMacro(<<"Left and right images do not have the same size ! Left largest region: "<<inLeftPtr->GetLargestPossibleRegion()<<", right largest region: "<<inRightPtr->GetLargestPossibleRegion());
+    }
+
+  // We also check that the masks have the same size if present
+  if(inLeftMaskPtr && inLeftPtr->GetLargestPossibleRegion() != inLeftMaskPtr->GetLargestPossibleRegion())
+    {
+    itkExceptionMacro(<<"Left and mask images do not have the same size ! Left largest region: "<<inLeftPtr->GetLargestPossibleRegion()<<", mask largest region: "<<inLeftMaskPtr->GetLargestPossibleRegion());
+    }
+  if(inRightMaskPtr && inRightPtr->GetLargestPossibleRegion() != inRightMaskPtr->GetLargestPossibleRegion())
+    {
+    itkExceptionMacro(<<"Right and mask images do not have the same size ! Right largest region: "<<inRightPtr->GetLargestPossibleRegion()<<", mask largest region: "<<inRightMaskPtr->GetLargestPossibleRegion());
+    }
+
+  // Aggregation region: the requested region padded by the overlap
+  RegionType aggregationRegion = outMetricPtr->GetRequestedRegion();
+  aggregationRegion.PadByRadius(m_Overlap);
+  if (!aggregationRegion.Crop(inLeftPtr->GetLargestPossibleRegion()))
+    {
+    itk::InvalidRequestedRegionError e(__FILE__, __LINE__);
+    std::ostringstream msg;
+    msg << this->GetNameOfClass()
+                << "::GenerateInputRequestedRegion()";
+    e.SetLocation(msg.str().c_str());
+    e.SetDescription("Requested region is (at least partially) outside the largest possible region of left image.");
+    e.SetDataObject(inLeftPtr);
+    throw e;
+    }
+
+  // Blocks of the aggregation region
+  RegionType inputLeftRegion = aggregationRegion;
+  inputLeftRegion.PadByRadius(m_Radius);
+
+  // Blocks of the right image, for all disparities
+  IndexType rightRequestedRegionIndex = inputLeftRegion.GetIndex();
+  rightRequestedRegionIndex[0] += m_MinimumHorizontalDisparity;
+  SizeType rightRequestedRegionSize = inputLeftRegion.GetSize();
+  rightRequestedRegionSize[0] += m_MaximumHorizontalDisparity - m_MinimumHorizontalDisparity;
+  RegionType inputRightRegion(rightRequestedRegionIndex, rightRequestedRegionSize);
+
+  // Pixels outside of the largest regions are handled as null values
+  inputLeftRegion.Crop(inLeftPtr->GetLargestPossibleRegion());
+  inLeftPtr->SetRequestedRegion(inputLeftRegion);
+
+  if (inputRightRegion.Crop(inRightPtr->GetLargestPossibleRegion()))
+    {
+    inRightPtr->SetRequestedRegion(inputRightRegion);
+    }
+  else
+    {
+    // No right pixel can be matched: request an empty region
+    inputRightRegion.SetIndex(inRightPtr->GetLargestPossibleRegion().GetIndex());
+    inputRightRegion.SetSize(0, 0);
+    inputRightRegion.SetSize(1, 0);
+    inRightPtr->SetRequestedRegion(inputRightRegion);
+    }
+
+  if(inLeftMaskPtr)
+    {
+    // no need to crop the mask region : left mask and left image have same largest possible region
+    inLeftMaskPtr->SetRequestedRegion(inputLeftRegion);
+    }
+
+  if(inRightMaskPtr)
+    {
+    // no need to crop the mask region : right mask and right image have same largest possible region
+    inRightMaskPtr->SetRequestedRegion(inputRightRegion);
+    }
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+void
+SemiGlobalMatchingImageFilter<TInputImage,TOutputMetricImage,TOutputDisparityImage,TMaskImage>
+::BeforeThreadedGenerateData()
+{
+  this->CheckParameters();
+
+  // Fill buffers with default values
+  this->GetMetricOutput()->FillBuffer(0.);
+  this->GetHorizontalDisparityOutput()->FillBuffer(static_cast<DisparityPixelType>(m_MaximumHorizontalDisparity));
+  this->GetVerticalDisparityOutput()->FillBuffer(0.);
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+void
+SemiGlobalMatchingImageFilter<TInputImage,TOutputMetricImage,TOutputDisparityImage,TMaskImage>
+::ExtractPaddedValues(const TInputImage * image, const RegionType & region, std::vector<double> & values)
+{
+  values.assign(region.GetNumberOfPixels(), 0.);
+
+  RegionType bufferedRegion = region;
+  if (!bufferedRegion.Crop(image->GetBufferedRegion()))
+    {
+    return;
+    }
+
+  itk::ImageRegionConstIterator<TInputImage> it(image, bufferedRegion);
+  for (it.GoToBegin(); !it.IsAtEnd(); )
+    {
+    const IndexType index = it.GetIndex();
+    double * value = &values[(index[1] - region.GetIndex(1)) * region.GetSize(0) + index[0] - region.GetIndex(0)];
+    for (unsigned int x = 0; x < bufferedRegion.GetSize(0); ++x, ++it, ++value)
+      {
+      *value = static_cast<double>(it.Get());
+      }
+    }
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+void
+SemiGlobalMatchingImageFilter<TInputImage,TOutputMetricImage,TOutputDisparityImage,TMaskImage>
+::ExtractValidity(const TInputImage * image, const TMaskImage * mask, const RegionType & region,
+                  std::vector<bool> & validity)
+{
+  validity.assign(region.GetNumberOfPixels(), false);
+
+  RegionType validRegion = region;
+  if (!validRegion.Crop(image->GetLargestPossibleRegion()))
+    {
+    return;
+    }
+  if (mask && !validRegion.Crop(mask->GetBufferedRegion()))
+    {
+    return;
+    }
+
+  for (unsigned int y = 0; y < validRegion.GetSize(1); ++y)
+    {
+    const std::size_t offset = (validRegion.GetIndex(1) + y - region.GetIndex(1)) * region.GetSize(0)
+      + validRegion.GetIndex(0) - region.GetIndex(0);
+    std::fill(validity.begin() + offset, validity.begin() + offset + validRegion.GetSize(0), true);
+    }
+
+  if (mask)
+    {
+    itk::ImageRegionConstIterator<TMaskImage> it(mask, validRegion);
+    for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+      {
+      if (!(it.Get() > 0))
+        {
+        const IndexType index = it.GetIndex();
+        validity[(index[1] - region.GetIndex(1)) * region.GetSize(0) + index[0] - region.GetIndex(0)] = false;
+        }
+      }
+    }
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+void
+SemiGlobalMatchingImageFilter<TInputImage,TOutputMetricImage,TOutputDisparityImage,TMaskImage>
+::ComputeCensus(const std::vector<double> & values, const RegionType & region,
+                std::vector<itk::uint64_t> & census) const
+{
+  const unsigned int width = region.GetSize(0);
+  const unsigned int height = region.GetSize(1);
+  const unsigned int paddedWidth = width + 2 * m_Radius[0];
+
+  census.resize(static_cast<std::size_t>(width) * height);
+  for (unsigned int y = 0; y < height; ++y)
+    {
+    for (unsigned int x = 0; x < width; ++x)
+      {
+      const double center = values[(y + m_Radius[1]) * paddedWidth + x + m_Radius[0]];
+      itk::uint64_t code = 0;
+      for (unsigned int j = 0; j < 2 * m_Radius[1] + 1; ++j)
+        {
+        const double * row = &values[(y + j) * paddedWidth + x];
+        for (unsigned int i = 0; i < 2 * m_Radius[0] + 1; ++i)
+          {
+          if (i != m_Radius[0] || j != m_Radius[1])
+            {
+            code = (code << 1) | (row[i] < center ? 1 : 0);
+            }
+          }
+        }
+      census[static_cast<std::size_t>(y) * width + x] = code;
+      }
+    }
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+void
+SemiGlobalMatchingImageFilter<TInputImage,TOutputMetricImage,TOutputDisparityImage,TMaskImage>
+::ComputeCosts(const RegionType & region, std::vector<CostType> & costs, std::vector<bool> & leftValidity) const
+{
+  const unsigned int width = region.GetSize(0);
+  const unsigned int height = region.GetSize(1);
+  const unsigned int nbDisparities = m_MaximumHorizontalDisparity - m_MinimumHorizontalDisparity + 1;
+  const CostType maximumCost = this->GetMaximumCost();
+
+  // Left blocks, and right blocks for all disparities
+  RegionType leftValuesRegion = region;
+  leftValuesRegion.PadByRadius(m_Radius);
+
+  IndexType rightValuesIndex = leftValuesRegion.GetIndex();
+  rightValuesIndex[0] += m_MinimumHorizontalDisparity;
+  SizeType rightValuesSize = leftValuesRegion.GetSize();
+  rightValuesSize[0] += nbDisparities - 1;
+  RegionType rightValuesRegion(rightValuesIndex, rightValuesSize);
+
+  std::vector<double> leftValues, rightValues;
+  ExtractPaddedValues(this->GetLeftInput(), leftValuesRegion, leftValues);
+  ExtractPaddedValues(this->GetRightInput(), rightValuesRegion, rightValues);
+
+  // Right pixels matched by the left pixels of the region
+  IndexType rightIndex = region.GetIndex();
+  rightIndex[0] += m_MinimumHorizontalDisparity;
+  SizeType rightSize = region.GetSize();
+  rightSize[0] += nbDisparities - 1;
+  RegionType rightRegion(rightIndex, rightSize);
+  const unsigned int rightWidth = rightSize[0];
+
+  std::vector<bool> rightValidity;
+  ExtractValidity(this->GetLeftInput(), this->GetLeftMaskInput(), region, leftValidity);
+  ExtractValidity(this->GetRightInput(), this->GetRightMaskInput(), rightRegion, rightValidity);
+
+  costs.resize(static_cast<std::size_t>(width) * height * nbDisparities);
+
+  if (m_MatchingCost == CENSUS)
+    {
+    std::vector<itk::uint64_t> leftCensus, rightCensus;
+    this->ComputeCensus(leftValues, region, leftCensus);
+    this->ComputeCensus(rightValues, rightRegion, rightCensus);
+
+    for (unsigned int y = 0; y < height; ++y)
+      {
+      for (unsigned int x = 0; x < width; ++x)
+        {
+        const itk::uint64_t code = leftCensus[static_cast<std::size_t>(y) * width + x];
+        const itk::uint64_t * rightCodes = &rightCensus[static_cast<std::size_t>(y) * rightWidth + x];
+        CostType * pixelCosts = &costs[(static_cast<std::size_t>(y) * width + x) * nbDisparities];
+        for (unsigned int d = 0; d < nbDisparities; ++d)
+          {
+          pixelCosts[d] = static_cast<CostType>(HammingWeight(code ^ rightCodes[d]));
+          }
+        }
+      }
+    }
+  else
+    {
+    // Box sums of the squared differences, one disparity at a time
+    const unsigned int paddedWidth = width + 2 * m_Radius[0];
+    const unsigned int paddedHeight = height + 2 * m_Radius[1];
+    const unsigned int rightPaddedWidth = rightValuesSize[0];
+    const unsigned int blockHeight = 2 * m_Radius[1] + 1;
+    const unsigned int blockWidth = 2 * m_Radius[0] + 1;
+    const double scale = m_SSDCostScale / vcl_sqrt(static_cast<double>(blockWidth * blockHeight));
+
+    std::vector<double> squares(static_cast<std::size_t>(paddedWidth) * paddedHeight);
+    std::vector<double> columnSums(paddedWidth);
+    for (unsigned int d = 0; d < nbDisparities; ++d)
+      {
+      for (unsigned int row = 0; row < paddedHeight; ++row)
+        {
+        const double * left = &leftValues[static_cast<std::size_t>(row) * paddedWidth];
+        const double * right = &rightValues[static_cast<std::size_t>(row) * rightPaddedWidth + d];
+        double * rowSquares = &squares[static_cast<std::size_t>(row) * paddedWidth];
+        for (unsigned int col = 0; col < paddedWidth; ++col)
+          {
+          const double diff = left[col] - right[col];
+          rowSquares[col] = diff * diff;
+          }
+        }
+
+      std::fill(columnSums.begin(), columnSums.end(), 0.);
+      for (unsigned int row = 0; row < blockHeight; ++row)
+        {
+        for (unsigned int col = 0; col < paddedWidth; ++col)
+          {
+          columnSums[col] += squares[static_cast<std::size_t>(row) * paddedWidth + col];
+          }
+        }
+
+      for (unsigned int y = 0; y < height; ++y)
+        {
+        if (y > 0)
+          {
+          const double * entering = &squares[static_cast<std::size_t>(y + blockHeight - 1) * paddedWidth];
+          const double * leaving = &squares[static_cast<std::size_t>(y - 1) * paddedWidth];
+          for (unsigned int col = 0; col < paddedWidth; ++col)
+            {
+            columnSums[col] += entering[col] - leaving[col];
+            }
+          }
+
+        double blockSum = 0.;
+        for (unsigned int col = 0; col < blockWidth; ++col)
+          {
+          blockSum += columnSums[col];
+          }
+        for (unsigned int x = 0; x < width; ++x)
+          {
+          if (x > 0)
+            {
+            blockSum += columnSums[x + blockWidth - 1] - columnSums[x - 1];
+            }
+          // Running sums may be slightly negative
+          const double cost = scale * vcl_sqrt(std::max(blockSum, 0.)) + 0.5;
+          costs[(static_cast<std::size_t>(y) * width + x) * nbDisparities + d] =
+            cost < static_cast<double>(maximumCost) ? static_cast<CostType>(cost) : maximumCost;
+          }
+        }
+      }
+    }
+
+  // Saturate the costs of invalid right pixels. Invalid left pixels do not
+  // weight on the aggregation.
+  for (unsigned int y = 0; y < height; ++y)
+    {
+    for (unsigned int x = 0; x < width; ++x)
+      {
+      CostType * pixelCosts = &costs[(static_cast<std::size_t>(y) * width + x) * nbDisparities];
+      if (!leftValidity[static_cast<std::size_t>(y) * width + x])
+        {
+        std::fill(pixelCosts, pixelCosts + nbDisparities, 0);
+        continue;
+        }
+      const std::size_t rightOffset = static_cast<std::size_t>(y) * rightWidth + x;
+      for (unsigned int d = 0; d < nbDisparities; ++d)
+        {
+        if (!rightValidity[rightOffset + d])
+          {
+          pixelCosts[d] = maximumCost;
+          }
+        }
+      }
+    }
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+void
+SemiGlobalMatchingImageFilter<TInputImage,TOutputMetricImage,TOutputDisparityImage,TMaskImage>
+::AggregatePath(const std::vector<CostType> & costs, unsigned int width, unsigned int height,
+                int dx, int dy, std::vector<CostType> & sums) const
+{
+  const unsigned int nbDisparities = m_MaximumHorizontalDisparity - m_MinimumHorizontalDisparity + 1;
+  const unsigned int p1 = m_P1;
+
+  // Path costs of the last three rows, the previous pixel of a path being at
+  // most two rows before
+  std::vector<CostType> pathCosts(3 * static_cast<std::size_t>(width) * nbDisparities);
+  std::vector<CostType> minPathCosts(3 * static_cast<std::size_t>(width));
+
+  for (unsigned int iy = 0; iy < height; ++iy)
+    {
+    // Rows and columns are traversed so that previous pixels come first
+    const int y = dy >= 0 ? iy : height - 1 - iy;
+    const int py = y - dy;
+
+    for (unsigned int ix = 0; ix < width; ++ix)
+      {
+      const int x = dx >= 0 ? ix : width - 1 - ix;
+      const int px = x - dx;
+
+      const std::size_t offset = static_cast<std::size_t>(y) * width + x;
+      const CostType * pixelCosts = &costs[offset * nbDisparities];
+      CostType * pixelPathCosts = &pathCosts[(static_cast<std::size_t>(y % 3) * width + x) * nbDisparities];
+      CostType * pixelSums = &sums[offset * nbDisparities];
+      unsigned int minPathCost = itk::NumericTraits<CostType>::max();
+
+      if (px < 0 || px >= static_cast<int>(width) || py < 0 || py >= static_cast<int>(height))
+        {
+        // First pixel of the path
+        for (unsigned int d = 0; d < nbDisparities; ++d)
+          {
+          pixelPathCosts[d] = pixelCosts[d];
+          minPathCost = std::min(minPathCost, static_cast<unsigned int>(pixelCosts[d]));
+          }
+        }
+      else
+        {
+        const CostType * previous = &pathCosts[(static_cast<std::size_t>(py % 3) * width + px) * nbDisparities];
+        const unsigned int minPrevious = minPathCosts[static_cast<std::size_t>(py % 3) * width + px];
+        const unsigned int jump = minPrevious + m_P2;
+
+        for (unsigned int d = 0; d < nbDisparities; ++d)
+          {
+          unsigned int best = std::min(static_cast<unsigned int>(previous[d]), jump);
+          if (d > 0)
+            {
+            best = std::min(best, previous[d - 1] + p1);
+            }
+          if (d + 1 < nbDisparities)
+            {
+            best = std::min(best, previous[d + 1] + p1);
+            }
+          const unsigned int pathCost = pixelCosts[d] + best - minPrevious;
+          pixelPathCosts[d] = static_cast<CostType>(pathCost);
+          minPathCost = std::min(minPathCost, pathCost);
+          }
+        }
+
+      minPathCosts[static_cast<std::size_t>(y % 3) * width + x] = static_cast<CostType>(minPathCost);
+
+      for (unsigned int d = 0; d < nbDisparities; ++d)
+        {
+        pixelSums[d] += pixelPathCosts[d];
+        }
+      }
+    }
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+void
+SemiGlobalMatchingImageFilter<TInputImage,TOutputMetricImage,TOutputDisparityImage,TMaskImage>
+::ThreadedGenerateData(const RegionType& outputRegionForThread, itk::ThreadIdType threadId)
+{
+  // Set-up progress reporting: matching costs, then each path
+  itk::ProgressReporter progress(this, threadId, m_NumberOfPaths + 1);
+
+  // Aggregation region of the thread
+  RegionType region = outputRegionForThread;
+  region.PadByRadius(m_Overlap);
+  region.Crop(this->GetLeftInput()->GetLargestPossibleRegion());
+
+  const unsigned int width = region.GetSize(0);
+  const unsigned int height = region.GetSize(1);
+  const unsigned int nbDisparities = m_MaximumHorizontalDisparity - m_MinimumHorizontalDisparity + 1;
+
+  std::vector<CostType> costs;
+  std::vector<bool> leftValidity;
+  this->ComputeCosts(region, costs, leftValidity);
+  progress.CompletedPixel();
+
+  std::vector<CostType> sums(costs.size(), 0);
+  for (unsigned int path = 0; path < m_NumberOfPaths; ++path)
+    {
+    this->AggregatePath(costs, width, height, SemiGlobalMatchingPathDirections[path][0],
+                        SemiGlobalMatchingPathDirections[path][1], sums);
+    progress.CompletedPixel();
+    }
+
+  // Winner takes all on the aggregated costs
+  itk::ImageRegionIterator<TOutputMetricImage>    outMetricIt(this->GetMetricOutput(), outputRegionForThread);
+  itk::ImageRegionIterator<TOutputDisparityImage> outHDispIt(this->GetHorizontalDisparityOutput(), outputRegionForThread);
+
+  for (outMetricIt.GoToBegin(), outHDispIt.GoToBegin(); !outMetricIt.IsAtEnd(); ++outMetricIt, ++outHDispIt)
+    {
+    const IndexType index = outMetricIt.GetIndex();
+    const std::size_t offset = (index[1] - region.GetIndex(1)) * width + index[0] - region.GetIndex(0);
+    if (!leftValidity[offset])
+      {
+      continue;
+      }
+
+    const CostType * pixelSums = &sums[offset * nbDisparities];
+    const CostType * best = std::min_element(pixelSums, pixelSums + nbDisparities);
+
+    outMetricIt.Set(static_cast<MetricValueType>(*best));
+    outHDispIt.Set(static_cast<DisparityPixelType>(m_MinimumHorizontalDisparity + (best - pixelSums)));
+    }
+}
+
+template <class TInputImage, class TOutputMetricImage, class TOutputDisparityImage, class TMaskImage>
+void
+SemiGlobalMatchingImageFilter<TInputImage,TOutputMetricImage,TOutputDisparityImage,TMaskImage>
+::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "Radius: " << m_Radius << std::endl;
+  os << indent << "Horizontal disparities: [" << m_MinimumHorizontalDisparity << ", "
+     << m_MaximumHorizontalDisparity << "]" << std::endl;
+  os << indent << "Matching cost: " << (m_MatchingCost == CENSUS ? "census" : "SSD") << std::endl;
+  os << indent << "SSD cost scale: " << m_SSDCostScale << std::endl;
+  os << indent << "P1: " << m_P1 << ", P2: " << m_P2 << std::endl;
+  os << indent << "Number of paths: " << m_NumberOfPaths << std::endl;
+  os << indent << "Overlap: " << m_Overlap << std::endl;
+}
+
+} // end namespace otb
+
+#endif
@@ -43,4 +43,6 @@ void RegisterTests()
   REGISTER_TEST(otbPixelWiseBlockMatchingImageFilter);
   REGISTER_TEST(otbPixelWiseBlockMatchingImageFilterNew);
   REGISTER_TEST(otbPixelWiseBlockMatchingImageFilterNCC);
+  REGISTER_TEST(otbPixelWiseBlockMatchingImageFilterCostVolume);
+  REGISTER_TEST(otbSemiGlobalMatchingImageFilter);
 }
@@ -23,6 +23,7 @@
 #include "otbImageFileReader.h"
 #include "otbImageFileWriter.h"
 #include "otbStandardWriterWatcher.h"
+#include "itkImageRegionConstIterator.h"
 
 typedef otb::Image<unsigned short>                    ImageType;
 typedef otb::Image<float>                             FloatImageType;
@@ -35,6 +36,10 @@ typedef otb::Functor::NCCBlockMatching<ImageType,FloatImageType> NCCBlockMatchin
 
 typedef otb::PixelWiseBlockMatchingImageFilter<ImageType,FloatImageType,FloatImageType,ImageType, NCCBlockMatchingFunctorType> PixelWiseNCCBlockMatchingImageFilterType;
 
+typedef otb::Functor::LPBlockMatching<ImageType,FloatImageType> LPBlockMatchingFunctorType;
+
+typedef otb::PixelWiseBlockMatchingImageFilter<ImageType,FloatImageType,FloatImageType,ImageType, LPBlockMatchingFunctorType> PixelWiseLPBlockMatchingImageFilterType;
+
 int otbPixelWiseBlockMatchingImageFilterNew(int itkNotUsed(argc), char * itkNotUsed(argv) [])
 {
   // Instantiation
@@ -126,3 +131,120 @@ int otbPixelWiseBlockMatchingImageFilterNCC(int argc, char * argv[])
 
   return EXIT_SUCCESS;
 }
+
+namespace
+{
+// Run the filter with and without the cost volume, and count the pixels
+// whose metrics differ, and the pixels whose disparities differ on a tie
+// of the metric.
+template <class TFilter>
+unsigned int CompareCostVolume(TFilter * filter, double tolerance, unsigned int & nbTies, unsigned int & nbPixels)
+{
+  filter->CostVolumeOff();
+  filter->UpdateLargestPossibleRegion();
+
+  FloatImageType::Pointer refHDisp = filter->GetHorizontalDisparityOutput();
+  FloatImageType::Pointer refVDisp = filter->GetVerticalDisparityOutput();
+  FloatImageType::Pointer refMetric = filter->GetMetricOutput();
+  refHDisp->DisconnectPipeline();
+  refVDisp->DisconnectPipeline();
+  refMetric->DisconnectPipeline();
+
+  filter->CostVolumeOn();
+  filter->UpdateLargestPossibleRegion();
+
+  const FloatImageType::RegionType region = refMetric->GetBufferedRegion();
+  itk::ImageRegionConstIterator<FloatImageType> refHDispIt(refHDisp, region);
+  itk::ImageRegionConstIterator<FloatImageType> refVDispIt(refVDisp, region);
+  itk::ImageRegionConstIterator<FloatImageType> refMetricIt(refMetric, region);
+  itk::ImageRegionConstIterator<FloatImageType> hDispIt(filter->GetHorizontalDisparityOutput(), region);
+  itk::ImageRegionConstIterator<FloatImageType> vDispIt(filter->GetVerticalDisparityOutput(), region);
+  itk::ImageRegionConstIterator<FloatImageType> metricIt(filter->GetMetricOutput(), region);
+
+  unsigned int nbErrors = 0;
+  nbTies = 0;
+  nbPixels = region.GetNumberOfPixels();
+  for (; !refMetricIt.IsAtEnd(); ++refHDispIt, ++refVDispIt, ++refMetricIt, ++hDispIt, ++vDispIt, ++metricIt)
+    {
+    const double error = vcl_abs(static_cast<double>(metricIt.Get()) - static_cast<double>(refMetricIt.Get()));
+    if (error > tolerance * std::max(1., vcl_abs(static_cast<double>(refMetricIt.Get()))))
+      {
+      ++nbErrors;
+      }
+    else if (hDispIt.Get() != refHDispIt.Get() || vDispIt.Get() != refVDispIt.Get())
+      {
+      ++nbTies;
+      }
+    }
+  return nbErrors;
+}
+
+template <class TFilter>
+void SetUpCostVolumeFilter(TFilter * filter, ImageType * left, ImageType * right, ImageType * mask, char * argv[])
+{
+  filter->SetLeftInput(left);
+  filter->SetRightInput(right);
+  filter->SetLeftMaskInput(mask);
+  filter->SetRadius(atoi(argv[3]));
+  filter->SetMinimumHorizontalDisparity(atoi(argv[4]));
+  filter->SetMaximumHorizontalDisparity(atoi(argv[5]));
+  filter->SetMinimumVerticalDisparity(-1);
+  filter->SetMaximumVerticalDisparity(1);
+  filter->SetStep(atoi(argv[6]));
+}
+}
+
+int otbPixelWiseBlockMatchingImageFilterCostVolume(int argc, char * argv[])
+{
+  if (argc != 7)
+    {
+    std::cerr << "Usage: " << argv[0] << " left right radius minhdisp maxhdisp step" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  ReaderType::Pointer leftReader = ReaderType::New();
+  leftReader->SetFileName(argv[1]);
+  leftReader->Update();
+
+  ReaderType::Pointer rightReader = ReaderType::New();
+  rightReader->SetFileName(argv[2]);
+  rightReader->Update();
+
+  // The left image is its own mask: null pixels are not matched
+  const double tolerance = 1e-5;
+
+  // Disparities may only differ on a tie of the metric, which should be
+  // rare on real images
+  const double maxTieRatio = 1e-3;
+
+  unsigned int nbTies = 0;
+  unsigned int nbPixels = 0;
+  unsigned int nbFailures = 0;
+
+  PixelWiseBlockMatchingImageFilterType::Pointer ssdFilter = PixelWiseBlockMatchingImageFilterType::New();
+  SetUpCostVolumeFilter(ssdFilter.GetPointer(), leftReader->GetOutput(), rightReader->GetOutput(), leftReader->GetOutput(), argv);
+  const unsigned int ssdErrors = CompareCostVolume(ssdFilter.GetPointer(), tolerance, nbTies, nbPixels);
+  std::cout << "SSD: " << ssdErrors << " differences, " << nbTies << " ties out of " << nbPixels << " pixels" << std::endl;
+  nbFailures += ssdErrors + (nbTies > maxTieRatio * nbPixels ? 1 : 0);
+
+  PixelWiseNCCBlockMatchingImageFilterType::Pointer nccFilter = PixelWiseNCCBlockMatchingImageFilterType::New();
+  SetUpCostVolumeFilter(nccFilter.GetPointer(), leftReader->GetOutput(), rightReader->GetOutput(), leftReader->GetOutput(), argv);
+  nccFilter->MinimizeOff();
+  const unsigned int nccErrors = CompareCostVolume(nccFilter.GetPointer(), tolerance, nbTies, nbPixels);
+  std::cout << "NCC: " << nccErrors << " differences, " << nbTies << " ties out of " << nbPixels << " pixels" << std::endl;
+  nbFailures += nccErrors + (nbTies > maxTieRatio * nbPixels ? 1 : 0);
+
+  PixelWiseLPBlockMatchingImageFilterType::Pointer lpFilter = PixelWiseLPBlockMatchingImageFilterType::New();
+  SetUpCostVolumeFilter(lpFilter.GetPointer(), leftReader->GetOutput(), rightReader->GetOutput(), leftReader->GetOutput(), argv);
+  lpFilter->GetFunctor().SetP(1.5);
+  const unsigned int lpErrors = CompareCostVolume(lpFilter.GetPointer(), tolerance, nbTies, nbPixels);
+  std::cout << "LP: " << lpErrors << " differences, " << nbTies << " ties out of " << nbPixels << " pixels" << std::endl;
+  nbFailures += lpErrors + (nbTies > maxTieRatio * nbPixels ? 1 : 0);
+
+  if (nbFailures != 0)
+    {
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
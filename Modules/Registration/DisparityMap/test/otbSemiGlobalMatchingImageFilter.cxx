@@ -0,0 +1,134 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "otbSemiGlobalMatchingImageFilter.h"
+#include "itkStreamingImageFilter.h"
+#include "itkImageRegionIterator.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+
+typedef otb::Image<float>                                                  FloatImageType;
+typedef otb::SemiGlobalMatchingImageFilter<FloatImageType,FloatImageType> SemiGlobalMatchingFilterType;
+typedef itk::StreamingImageFilter<FloatImageType,FloatImageType>           StreamingFilterType;
+
+int otbSemiGlobalMatchingImageFilter(int argc, char * argv[])
+{
+  if (argc != 5)
+    {
+    std::cerr << "Usage: " << argv[0] << " cost(census|ssd) nbpaths disparity nbdivisions" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const std::string cost = argv[1];
+  const unsigned int nbPaths = atoi(argv[2]);
+  const int disparity = atoi(argv[3]);
+  const unsigned int nbDivisions = atoi(argv[4]);
+
+  // Textured left image, with a flat area, and right image shifted by the disparity
+  FloatImageType::RegionType region;
+  region.SetSize(0, 120);
+  region.SetSize(1, 100);
+
+  FloatImageType::Pointer left = FloatImageType::New();
+  left->SetRegions(region);
+  left->Allocate();
+  FloatImageType::Pointer right = FloatImageType::New();
+  right->SetRegions(region);
+  right->Allocate();
+
+  typedef itk::Statistics::MersenneTwisterRandomVariateGenerator RandomGeneratorType;
+  RandomGeneratorType::Pointer randomGenerator = RandomGeneratorType::GetInstance();
+  randomGenerator->Initialize(12345);
+
+  itk::ImageRegionIterator<FloatImageType> leftIt(left, region);
+  for (leftIt.GoToBegin(); !leftIt.IsAtEnd(); ++leftIt)
+    {
+    const FloatImageType::IndexType index = leftIt.GetIndex();
+    const bool flat = index[0] >= 50 && index[0] < 60 && index[1] >= 40 && index[1] < 50;
+    leftIt.Set(flat ? 100. : randomGenerator->GetUniformVariate(0., 255.));
+    }
+
+  itk::ImageRegionIterator<FloatImageType> rightIt(right, region);
+  for (rightIt.GoToBegin(); !rightIt.IsAtEnd(); ++rightIt)
+    {
+    FloatImageType::IndexType index = rightIt.GetIndex();
+    index[0] -= disparity;
+    rightIt.Set(region.IsInside(index) ? left->GetPixel(index) : randomGenerator->GetUniformVariate(0., 255.));
+    }
+
+  SemiGlobalMatchingFilterType::Pointer sgmFilter = SemiGlobalMatchingFilterType::New();
+  sgmFilter->SetLeftInput(left);
+  sgmFilter->SetRightInput(right);
+  sgmFilter->SetMinimumHorizontalDisparity(-5);
+  sgmFilter->SetMaximumHorizontalDisparity(5);
+  sgmFilter->SetNumberOfPaths(nbPaths);
+  if (cost == "ssd")
+    {
+    sgmFilter->SetMatchingCost(SemiGlobalMatchingFilterType::SSD);
+    sgmFilter->SetRadius(1);
+    sgmFilter->SetP1(8);
+    sgmFilter->SetP2(64);
+    }
+  else
+    {
+    sgmFilter->SetMatchingCost(SemiGlobalMatchingFilterType::CENSUS);
+    }
+
+  StreamingFilterType::Pointer streamer = StreamingFilterType::New();
+  streamer->SetInput(sgmFilter->GetHorizontalDisparityOutput());
+  streamer->SetNumberOfStreamDivisions(nbDivisions);
+  streamer->Update();
+
+  // All pixels whose left and right blocks are in the image, including the
+  // flat area thanks to the aggregation, must be matched
+  FloatImageType::RegionType innerRegion = region;
+  FloatImageType::SizeType radius;
+  radius[0] = 2;
+  radius[1] = 0;
+  innerRegion.ShrinkByRadius(radius);
+
+  unsigned int nbPixels = 0;
+  unsigned int nbErrors = 0;
+  itk::ImageRegionConstIterator<FloatImageType> dispIt(streamer->GetOutput(), innerRegion);
+  for (dispIt.GoToBegin(); !dispIt.IsAtEnd(); ++dispIt)
+    {
+    FloatImageType::IndexType index = dispIt.GetIndex();
+    index[0] += disparity;
+    if (!innerRegion.IsInside(index))
+      {
+      continue;
+      }
+    ++nbPixels;
+    if (dispIt.Get() != disparity)
+      {
+      ++nbErrors;
+      }
+    }
+
+  std::cout << nbErrors << " wrong disparities over " << nbPixels << " pixels" << std::endl;
+
+  if (nbErrors > nbPixels / 100)
+    {
+    std::cerr << "Too many wrong disparities" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
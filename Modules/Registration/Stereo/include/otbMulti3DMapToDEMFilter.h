@@ -29,6 +29,7 @@
 #include "otbImage.h"
 #include "itkImageRegionSplitter.h"
 #include "otbObjectList.h"
+#include "itkMultiThreader.h"
 
 namespace otb
 {
@@ -39,7 +40,8 @@ enum CellFusionMode {
   MIN = 0,
   MAX = 1,
   MEAN = 2,
-  ACC = 3 //return accumulator for debug purpose
+  ACC = 3, //return accumulator for debug purpose
+  MEDIAN = 4
   };
 }
 
@@ -55,6 +57,19 @@ enum CellFusionMode {
  * - 1 MAX : we keep the maximum altitude
  * - 2 MEAN : mean is computed
  * - 3 ACC : returns cell count (useful to create mask from output)
+ * - 4 MEDIAN : median is computed
+ *
+ *  The DEM is computed by point splatting. For each requested output region,
+ *  the 3D points of the input maps are read and projected once: each thread
+ *  handles a split of every map and bins the points falling in the region
+ *  into the output tiles they belong to (TileSize cells). Then each thread
+ *  fuses the tiles of its own part of the output, reading the bins filled by
+ *  all threads, so that no merge of per-thread DEMs is needed. MIN, MAX, MEAN
+ *  and ACC modes cost a constant time per point. The median of a cell is
+ *  computed on at most MaximumNumberOfSamplesPerCell samples, evenly picked
+ *  among the points of the cell when there are more, in the order of the
+ *  maps and of their pixels, so that it does not depend on the number of
+ *  threads nor on the streaming.
  *
  *  empty cell are filled with the NoDataValue (-32768 by default)
  *
@@ -226,6 +241,15 @@ public:
     itkSetMacro(Margin, SizeType);
     itkGetConstReferenceMacro(Margin, SizeType);
 
+    /** Size of the output tiles used to bin the 3D points (64x64 by default) */
+    itkSetMacro(TileSize, SizeType);
+    itkGetConstReferenceMacro(TileSize, SizeType);
+
+    /** Maximum number of samples used to compute the median of a cell
+     * (64 by default) */
+    itkSetMacro(MaximumNumberOfSamplesPerCell, unsigned int);
+    itkGetConstReferenceMacro(MaximumNumberOfSamplesPerCell, unsigned int);
+
 
 protected:
   /** Constructor */
@@ -249,6 +273,50 @@ protected:
   /** After threaded generate data */
   void AfterThreadedGenerateData() ITK_OVERRIDE;
 
+  /** A 3D point binned in an output tile */
+  struct CellSample
+  {
+    /** Offset of the DEM cell in the output requested region */
+    itk::SizeValueType Offset;
+    /** Elevation of the point */
+    ValueType          Height;
+  };
+
+  typedef std::vector<CellSample> CellSampleListType;
+
+  /** Points binned in a tile from a split of a map. Splits are bands of
+   * rows, so that the points of a split are in the raster order of the map. */
+  struct SampleSegment
+  {
+    unsigned int       Map;
+    unsigned int       Split;
+    unsigned int       Thread;
+    itk::SizeValueType Begin;
+    itk::SizeValueType End;
+
+    bool operator<(const SampleSegment & other) const
+    {
+      return Map < other.Map || (Map == other.Map && Split < other.Split);
+    }
+  };
+
+  typedef std::vector<SampleSegment> SampleSegmentListType;
+
+  /** Static function used as a "callback" by the MultiThreader to bin the 3D points */
+  static ITK_THREAD_RETURN_TYPE BinningThreaderCallback(void *arg);
+
+  /** Internal structure used for passing data to the binning threads */
+  struct BinningThreadStruct
+  {
+    Self * Filter;
+  };
+
+  /** Bin the 3D points of the map splits handled by a thread */
+  void BinPoints(itk::ThreadIdType threadId, itk::ThreadIdType threadCount);
+
+  /** Fuse the points binned in a tile over a part of this tile */
+  void FuseTile(unsigned int tile, const RegionType & fusedRegion);
+
   /** Override VerifyInputInformation() since this filter's inputs do
     * not need to occupy the same physical space.
     *
@@ -279,10 +347,14 @@ private:
   /** DEM grid step (in meters) */
   double m_DEMGridStep;
 
-  /** Temporary DEMs for multithreading */
-   std::vector<typename OutputImageType::Pointer>      m_TempDEMRegions;
-   /** Temporary accumulator for multithreading and mean calculus*/
-   std::vector<typename AccumulatorImageType::Pointer> m_TempDEMAccumulatorRegions;
+  /** Points binned by thread and by output tile */
+  std::vector<std::vector<CellSampleListType> > m_TileSamples;
+
+  /** Splits of the points binned by thread and by output tile */
+  std::vector<std::vector<SampleSegmentListType> > m_TileSegments;
+
+  /** Number of output tiles in each dimension */
+  SizeType      m_NumberOfTiles;
 
 
   std::vector<unsigned int> m_NumberOfSplit; // number of split for each map
@@ -308,6 +380,10 @@ private:
 
   SizeType      m_Margin;
 
+  SizeType      m_TileSize;
+
+  unsigned int  m_MaximumNumberOfSamplesPerCell;
+
   int           m_OutputParametersFrom3DMap;
   bool          m_IsGeographic;
   
@@ -27,6 +27,8 @@
 #include "otbStreamingStatisticsVectorImageFilter.h"
 #include "otbInverseSensorModel.h"
 
+#include <algorithm>
+
 namespace otb
 {
 
@@ -54,6 +56,10 @@ Multi3DMapToDEMFilter<T3DImage, TMaskImage, TOutputDEMImage>::Multi3DMapToDEMFil
   m_Margin[0]=10;
   m_Margin[1]=10;
 
+  m_TileSize.Fill(64);
+  m_NumberOfTiles.Fill(0);
+  m_MaximumNumberOfSamplesPerCell = 64;
+
 }
 
 template<class T3DImage, class TMaskImage, class TOutputDEMImage>
@@ -496,12 +502,17 @@ template<class T3DImage, class TMaskImage, class TOutputDEMImage>
 void Multi3DMapToDEMFilter<T3DImage, TMaskImage, TOutputDEMImage>::BeforeThreadedGenerateData()
 {
   const TOutputDEMImage * outputDEM = this->GetDEMOutput();
+  const RegionType outputRequestedRegion = outputDEM->GetRequestedRegion();
+
+  if (m_CellFusionMode < otb::CellFusionMode::MIN || m_CellFusionMode > otb::CellFusionMode::MEDIAN)
+    {
+    itkExceptionMacro(<< "Unexpected value cell fusion mode :"<<this->m_CellFusionMode);
+    }
 
   //create splits
   // for each map we check if the input region can be split into threadNb
   m_NumberOfSplit.resize(this->GetNumberOf3DMaps());
-
-  unsigned int maximumRegionsNumber = 1;
+  m_MapSplitterList->Clear();
 
   for (unsigned int k = 0; k < this->GetNumberOf3DMaps(); ++k)
     {
@@ -519,32 +530,6 @@ void Multi3DMapToDEMFilter<T3DImage, TMaskImage, TOutputDEMImage>::BeforeThreade
       }
     m_NumberOfSplit[k] = regionsNumber;
     otbMsgDevMacro( "map " << k << " will be split into " << regionsNumber << " regions" );
-    if (maximumRegionsNumber < regionsNumber) maximumRegionsNumber = regionsNumber;
-
-    }
-
-  m_TempDEMRegions.clear();
-  m_TempDEMAccumulatorRegions.clear();
-  //m_ThreadProcessed.resize(maximumRegionsNumber);
-
-  for (unsigned int i = 0; i < maximumRegionsNumber; i++)
-    {
-    //m_ThreadProcessed[i] = 0;
-    typename TOutputDEMImage::Pointer tmpImg = TOutputDEMImage::New();
-    tmpImg->SetNumberOfComponentsPerPixel(1); //Two components for mean calculus ?
-    tmpImg->SetRegions(outputDEM->GetRequestedRegion());
-    tmpImg->Allocate();
-
-    tmpImg->FillBuffer(m_NoDataValue);
-    m_TempDEMRegions.push_back(tmpImg);
-
-    typename AccumulatorImageType::Pointer tmpImg2 = AccumulatorImageType::New();
-    tmpImg2->SetNumberOfComponentsPerPixel(1); //Two components for mean calculus ?
-    tmpImg2->SetRegions(outputDEM->GetRequestedRegion());
-    tmpImg2->Allocate();
-
-    tmpImg2->FillBuffer(0.);
-    m_TempDEMAccumulatorRegions.push_back(tmpImg2);
     }
 
   if (!this->m_IsGeographic)
@@ -555,347 +540,346 @@ void Multi3DMapToDEMFilter<T3DImage, TMaskImage, TOutputDEMImage>::BeforeThreade
     m_GroundTransform->InstantiateTransform();
     }
 
+  // Spatial index : the output requested region is cut into tiles
+  for (unsigned int dim = 0; dim < 2; ++dim)
+    {
+    if (m_TileSize[dim] == 0)
+      {
+      itkExceptionMacro(<< "Tile size must be positive");
+      }
+    m_NumberOfTiles[dim] = (outputRequestedRegion.GetSize(dim) + m_TileSize[dim] - 1) / m_TileSize[dim];
+    }
+
+  const unsigned int nbThreads = std::max(1u, static_cast<unsigned int>(this->GetNumberOfThreads()));
+  m_TileSamples.assign(nbThreads, std::vector<CellSampleListType>(m_NumberOfTiles[0] * m_NumberOfTiles[1]));
+  m_TileSegments.assign(nbThreads, std::vector<SampleSegmentListType>(m_NumberOfTiles[0] * m_NumberOfTiles[1]));
+
+  // Bin the 3D points, each map split being read once
+  BinningThreadStruct str;
+  str.Filter = this;
+  this->GetMultiThreader()->SetNumberOfThreads(nbThreads);
+  this->GetMultiThreader()->SetSingleMethod(this->BinningThreaderCallback, &str);
+  this->GetMultiThreader()->SingleMethodExecute();
 }
 
 template<class T3DImage, class TMaskImage, class TOutputDEMImage>
-void Multi3DMapToDEMFilter<T3DImage, TMaskImage, TOutputDEMImage>::ThreadedGenerateData(
-  const RegionType & itkNotUsed(outputRegionForThread),
-  itk::ThreadIdType threadId)
+ITK_THREAD_RETURN_TYPE
+Multi3DMapToDEMFilter<T3DImage, TMaskImage, TOutputDEMImage>::BinningThreaderCallback(void *arg)
 {
-  TOutputDEMImage * outputPtr = this->GetOutput();
-
-  typename OutputImageType::PointType pointRef;
-  typename OutputImageType::PointType pointRefStep;
-  typename OutputImageType::RegionType requestedRegion = outputPtr->GetRequestedRegion();
+  BinningThreadStruct *str;
+  int                  threadId, threadCount;
 
-//  typename TOutputDEMImage::SpacingType step = outputPtr->GetSpacing();
+  threadId = ((itk::MultiThreader::ThreadInfoStruct *) (arg))->ThreadID;
+  threadCount = ((itk::MultiThreader::ThreadInfoStruct *) (arg))->NumberOfThreads;
+  str = (BinningThreadStruct *) (((itk::MultiThreader::ThreadInfoStruct *) (arg))->UserData);
 
-  //convert requested region to Long/Lat
+  str->Filter->BinPoints(threadId, threadCount);
 
-//  typename TOutputDEMImage::SizeType size = requestedRegion.GetSize();
-
-  typename TOutputDEMImage::IndexType index = requestedRegion.GetIndex();
-  outputPtr->TransformIndexToPhysicalPoint(index, pointRef);
-  /*
-  InputInternalPixelType regionLong1 = pointRef[0];
-  InputInternalPixelType regionLat1 = pointRef[1];
-  InputInternalPixelType regionLong2 = pointRef[0] + size[0] * step[0];
-  InputInternalPixelType regionLat2 = pointRef[1] + size[1] * step[1];
-  InputInternalPixelType minLong = std::min(regionLong1, regionLong2);
-  InputInternalPixelType minLat = std::min(regionLat1, regionLat2);
-  InputInternalPixelType maxLong = std::max(regionLong1, regionLong2);
-  InputInternalPixelType maxLat = std::max(regionLat1, regionLat2);
-  */
+  return ITK_THREAD_RETURN_VALUE;
+}
 
-  TOutputDEMImage * tmpDEM = ITK_NULLPTR;
-  AccumulatorImageType *tmpAcc = ITK_NULLPTR;
-  typename TOutputDEMImage::RegionType outputRequestedRegion = outputPtr->GetRequestedRegion();
+template<class T3DImage, class TMaskImage, class TOutputDEMImage>
+void Multi3DMapToDEMFilter<T3DImage, TMaskImage, TOutputDEMImage>::BinPoints(
+  itk::ThreadIdType threadId,
+  itk::ThreadIdType threadCount)
+{
+  const TOutputDEMImage * outputPtr = this->GetDEMOutput();
+  const RegionType outputRequestedRegion = outputPtr->GetRequestedRegion();
+  const IndexType outputStart = outputRequestedRegion.GetIndex();
+  const itk::SizeValueType outputWidth = outputRequestedRegion.GetSize(0);
 
-  typename T3DImage::RegionType splitRegion;
+  std::vector<CellSampleListType> & tileSamples = m_TileSamples[threadId];
+  std::vector<SampleSegmentListType> & tileSegments = m_TileSegments[threadId];
 
   MapPixelType position;
+  CellSample sample;
 
-  itk::ImageRegionConstIterator<InputMapType> mapIt;
   for (unsigned int k = 0; k < this->GetNumberOf3DMaps(); ++k)
     {
-    if (m_NumberOfSplit[k] > 0)
-      {
-      T3DImage *imgPtr = const_cast<T3DImage *> (this->Get3DMapInput(k));
-      TMaskImage *mskPtr = const_cast<TMaskImage *> (this->GetMaskInput(k));
+    const T3DImage *imgPtr = this->Get3DMapInput(k);
+    const TMaskImage *mskPtr = this->GetMaskInput(k);
 
-      typename InputMapType::PointType origin;
-      origin = imgPtr->GetOrigin();
-      typename InputMapType::SpacingType spacing;
-      spacing = imgPtr->GetSpacing();
+    // The multithreader may use less threads than requested
+    for (unsigned int split = threadId; split < m_NumberOfSplit[k]; split += threadCount)
+      {
+      typename T3DImage::RegionType splitRegion =
+        m_MapSplitterList->GetNthElement(k)->GetSplit(split, m_NumberOfSplit[k], imgPtr->GetRequestedRegion());
 
-      if (static_cast<unsigned int> (threadId) < m_NumberOfSplit[k])
+      itk::ImageRegionConstIterator<InputMapType> mapIt(imgPtr, splitRegion);
+      itk::ImageRegionConstIterator<MaskImageType> maskIt;
+      if (mskPtr)
         {
-        splitRegion = m_MapSplitterList->GetNthElement(k)->GetSplit(threadId, m_NumberOfSplit[k],
-                                                                    imgPtr->GetRequestedRegion());
-
-        tmpDEM = m_TempDEMRegions[threadId];
-        tmpAcc = m_TempDEMAccumulatorRegions[threadId];
+        maskIt = itk::ImageRegionConstIterator<MaskImageType>(mskPtr, splitRegion);
+        maskIt.GoToBegin();
+        }
 
-        mapIt = itk::ImageRegionConstIterator<InputMapType>(imgPtr, splitRegion);
-        mapIt.GoToBegin();
-        itk::ImageRegionConstIterator<MaskImageType> maskIt;
-        bool useMask = false;
+      for (mapIt.GoToBegin(); !mapIt.IsAtEnd(); ++mapIt)
+        {
+        // check mask value if any
         if (mskPtr)
           {
-          useMask = true;
-          maskIt = itk::ImageRegionConstIterator<MaskImageType>(mskPtr, splitRegion);
-          maskIt.GoToBegin();
-          }
-
-        while (!mapIt.IsAtEnd())
-          {
-          // check mask value if any
-          if (useMask)
+          const bool isMasked = !(maskIt.Get() > 0);
+          ++maskIt;
+          if (isMasked)
             {
-            if (!(maskIt.Get() > 0))
-              {
-              ++mapIt;
-              ++maskIt;
-              continue;
-              }
+            continue;
             }
+          }
 
-          position = mapIt.Get();
+        position = mapIt.Get();
 
-          //std::cout<<"position"<<position<<std::endl;
-          if (!this->m_IsGeographic)
-            {
-            //std::cout<<"is geographic "<<std::endl;
-            typename RSTransform2DType::InputPointType tmpPoint;
-            tmpPoint[0] = position[0];
-            tmpPoint[1] = position[1];
-            RSTransform2DType::OutputPointType groundPosition = m_GroundTransform->TransformPoint(tmpPoint);
-            position[0] = groundPosition[0];
-            position[1] = groundPosition[1];
-            }
+        typename OutputImageType::PointType point2D;
+        point2D[0] = position[0];
+        point2D[1] = position[1];
+        if (!this->m_IsGeographic)
+          {
+          typename RSTransform2DType::InputPointType tmpPoint;
+          tmpPoint[0] = position[0];
+          tmpPoint[1] = position[1];
+          RSTransform2DType::OutputPointType groundPosition = m_GroundTransform->TransformPoint(tmpPoint);
+          point2D[0] = groundPosition[0];
+          point2D[1] = groundPosition[1];
+          }
 
-          //test if position is in DEM BBOX
-          /**    -Wunused-variable
-          bool isInDEM = (position[0] >= minLong) && (position[0] < maxLong) && (position[1] >= minLat) && (position[1]
-                      < maxLat);
-          **/
-          // Is point inside DEM area ?
-          typename OutputImageType::PointType point2D;
-          point2D[0] = position[0];
-          point2D[1] = position[1];
-          itk::ContinuousIndex<double, 2> continuousIndex;
-
-          //std::cout<<"point2D "<<point2D<<std::endl;
-          // The DEM cell at index 'n' contains continuous indexes from 'n-0.5' to 'n+0.5'
-          outputPtr->TransformPhysicalPointToContinuousIndex(point2D, continuousIndex);
-          typename OutputImageType::IndexType cellIndex;
-          cellIndex[0] = static_cast<int> (vcl_floor(continuousIndex[0] + 0.5));
-          cellIndex[1] = static_cast<int> (vcl_floor(continuousIndex[1] + 0.5));
-          //std::cout<<"cellindex "<<cellIndex<<std::endl;
-          //index from physical
-          /** -Wunused-variable
-            typename OutputImageType::IndexType physCellIndex;
-
-          //double CellIndexLong=(position[0]-outOrigin[0])/step[0];
-          //double CellIndexLat=(position[1]-outOrigin[1])/step[1];
-          typename OutputImageType::IndexType cellIndex2;
-          **/
-          if (outputRequestedRegion.IsInside(cellIndex))
-            {
-            //std::cout<<"is inside "<<std::endl;
-            // Add point to its corresponding cell (keep maximum)
-            DEMPixelType cellHeight = static_cast<DEMPixelType> (position[2]);
-            //if (cellHeight > tmpDEM->GetPixel(cellIndex) && cellHeight < static_cast<DEMPixelType>(m_ElevationMax))
-            //  {
-            // tmpDEM->SetPixel(cellIndex,tmpDEM->GetPixel(cellIndex)+1);
-
-            AccumulatorPixelType accPixel = tmpAcc->GetPixel(cellIndex);
-            tmpAcc->SetPixel(cellIndex, tmpAcc->GetPixel(cellIndex) + 1);
-
-            if (accPixel == 0)
-              {
-              tmpDEM->SetPixel(cellIndex, cellHeight);
-              }
-            else
-              {
-              DEMPixelType cellCurrentValue = tmpDEM->GetPixel(cellIndex);
-
-              switch (this->m_CellFusionMode)
-                {
-                case otb::CellFusionMode::MIN:
-                  {
-                  if (cellHeight < cellCurrentValue)
-                    {
-                    tmpDEM->SetPixel(cellIndex, cellHeight);
-                    }
-                  }
-                  break;
-                case otb::CellFusionMode::MAX:
-                  {
-                  if (cellHeight > cellCurrentValue)
-                    {
-                    tmpDEM->SetPixel(cellIndex, cellHeight);
-                    }
-                  }
-                  break;
-                case otb::CellFusionMode::MEAN:
-                  {
-                  tmpDEM->SetPixel(cellIndex, cellCurrentValue + cellHeight);
-                  }
-                  break;
-                case otb::CellFusionMode::ACC:
-                  {
-                  }
-                  break;
-                default:
-
-                  itkExceptionMacro(<< "Unexpected value cell fusion mode :"<<this->m_CellFusionMode)
-;
-                  break;
-                }
-              }
+        // The DEM cell at index 'n' contains continuous indexes from 'n-0.5' to 'n+0.5'
+        itk::ContinuousIndex<double, 2> continuousIndex;
+        outputPtr->TransformPhysicalPointToContinuousIndex(point2D, continuousIndex);
+        typename OutputImageType::IndexType cellIndex;
+        cellIndex[0] = static_cast<int> (vcl_floor(continuousIndex[0] + 0.5));
+        cellIndex[1] = static_cast<int> (vcl_floor(continuousIndex[1] + 0.5));
 
+        // Points outside of the output requested region are dropped
+        if (outputRequestedRegion.IsInside(cellIndex))
+          {
+          const itk::SizeValueType x = cellIndex[0] - outputStart[0];
+          const itk::SizeValueType y = cellIndex[1] - outputStart[1];
+          sample.Offset = x + y * outputWidth;
+          sample.Height = static_cast<DEMPixelType> (position[2]);
+
+          const itk::SizeValueType tile = x / m_TileSize[0] + (y / m_TileSize[1]) * m_NumberOfTiles[0];
+          SampleSegmentListType & segments = tileSegments[tile];
+          if (segments.empty() || segments.back().Map != k || segments.back().Split != split)
+            {
+            SampleSegment segment;
+            segment.Map = k;
+            segment.Split = split;
+            segment.Thread = threadId;
+            segment.Begin = tileSamples[tile].size();
+            segments.push_back(segment);
             }
-
-          ++mapIt;
-
-          if (useMask) ++maskIt;
-
+          tileSamples[tile].push_back(sample);
+          segments.back().End = tileSamples[tile].size();
           }
         }
-      else
-        {
-        splitRegion = requestedRegion;
-        otbMsgDevMacro( "map " << k << " will not be split " );
-        }
       }
     }
 }
 
 template<class T3DImage, class TMaskImage, class TOutputDEMImage>
-void Multi3DMapToDEMFilter<T3DImage, TMaskImage, TOutputDEMImage>::AfterThreadedGenerateData()
+void Multi3DMapToDEMFilter<T3DImage, TMaskImage, TOutputDEMImage>::ThreadedGenerateData(
+  const RegionType & outputRegionForThread,
+  itk::ThreadIdType itkNotUsed(threadId))
 {
-
-  TOutputDEMImage * outputDEM = this->GetOutput();
-
-  //check is that case can occur
-  if (m_TempDEMRegions.size() < 1)
+  if (outputRegionForThread.GetNumberOfPixels() == 0)
     {
-    outputDEM->FillBuffer(m_NoDataValue);
     return;
     }
 
-  itk::ImageRegionIterator<OutputImageType> outputDEMIt(outputDEM, outputDEM->GetRequestedRegion());
-  itk::ImageRegionIterator<OutputImageType> firstDEMIt(m_TempDEMRegions[0], outputDEM->GetRequestedRegion());
-  itk::ImageRegionIterator<AccumulatorImageType> firstDEMAccIt(m_TempDEMAccumulatorRegions[0],
-                                                               outputDEM->GetRequestedRegion());
-  //we use the first accumulator as global accumulator over tmpAcc for mean calculus
+  const RegionType outputRequestedRegion = this->GetDEMOutput()->GetRequestedRegion();
+  const IndexType outputStart = outputRequestedRegion.GetIndex();
 
-  outputDEMIt.GoToBegin();
-  firstDEMIt.GoToBegin();
-  firstDEMAccIt.GoToBegin();
-  // Copy first DEM
-
-  while (!outputDEMIt.IsAtEnd() && !firstDEMIt.IsAtEnd() && !firstDEMAccIt.IsAtEnd())
+  // Fuse the tiles overlapping the region of this thread. The output regions
+  // of the threads are disjoint, so that cells are written only once.
+  itk::SizeValueType firstTile[2];
+  itk::SizeValueType lastTile[2];
+  for (unsigned int dim = 0; dim < 2; ++dim)
     {
+    const itk::SizeValueType start = outputRegionForThread.GetIndex(dim) - outputStart[dim];
+    firstTile[dim] = start / m_TileSize[dim];
+    lastTile[dim] = (start + outputRegionForThread.GetSize(dim) - 1) / m_TileSize[dim];
+    }
 
-    AccumulatorPixelType accPixel = firstDEMAccIt.Get();
-    //useless test tempDEm is initialized with NoDataValue
-    if (accPixel == 0)
+  for (itk::SizeValueType tileY = firstTile[1]; tileY <= lastTile[1]; ++tileY)
+    {
+    for (itk::SizeValueType tileX = firstTile[0]; tileX <= lastTile[0]; ++tileX)
       {
-      outputDEMIt.Set(m_NoDataValue);
+      RegionType tileRegion;
+      tileRegion.SetIndex(0, outputStart[0] + tileX * m_TileSize[0]);
+      tileRegion.SetIndex(1, outputStart[1] + tileY * m_TileSize[1]);
+      tileRegion.SetSize(m_TileSize);
+      tileRegion.Crop(outputRegionForThread);
+
+      this->FuseTile(tileX + tileY * m_NumberOfTiles[0], tileRegion);
       }
-    else
-      {
+    }
+}
+
+template<class T3DImage, class TMaskImage, class TOutputDEMImage>
+void Multi3DMapToDEMFilter<T3DImage, TMaskImage, TOutputDEMImage>::FuseTile(
+  unsigned int tile,
+  const RegionType & fusedRegion)
+{
+  TOutputDEMImage * outputPtr = this->GetDEMOutput();
 
-      DEMPixelType pixelValue = firstDEMIt.Get();
+  const RegionType outputRequestedRegion = outputPtr->GetRequestedRegion();
+  const itk::SizeValueType outputWidth = outputRequestedRegion.GetSize(0);
+  const itk::SizeValueType startX = fusedRegion.GetIndex(0) - outputRequestedRegion.GetIndex(0);
+  const itk::SizeValueType startY = fusedRegion.GetIndex(1) - outputRequestedRegion.GetIndex(1);
+  const itk::SizeValueType width = fusedRegion.GetSize(0);
+  const itk::SizeValueType height = fusedRegion.GetSize(1);
+  const itk::SizeValueType nbCells = width * height;
 
-      outputDEMIt.Set(pixelValue);
+  const bool isMedian = (this->m_CellFusionMode == otb::CellFusionMode::MEDIAN);
 
-      if ((this->m_CellFusionMode == otb::CellFusionMode::MEAN) && (m_TempDEMRegions.size() == 1))
+  std::vector<AccumulatorPixelType> counts(nbCells, 0);
+  std::vector<ValueType> values(nbCells, 0.);
+
+  // Accumulate the points binned in the tile by all threads. A tile shared by
+  // several output regions only gets the points of its fused part.
+  for (unsigned int thread = 0; thread < m_TileSamples.size(); ++thread)
+    {
+    const CellSampleListType & samples = m_TileSamples[thread][tile];
+    for (typename CellSampleListType::const_iterator it = samples.begin(); it != samples.end(); ++it)
+      {
+      const itk::SizeValueType x = it->Offset % outputWidth;
+      const itk::SizeValueType y = it->Offset / outputWidth;
+      if (x < startX || x >= startX + width || y < startY || y >= startY + height)
         {
-        outputDEMIt.Set(firstDEMIt.Get() / static_cast<DEMPixelType> (accPixel));
+        continue;
         }
-      if (this->m_CellFusionMode == otb::CellFusionMode::ACC)
+      const itk::SizeValueType cell = (x - startX) + (y - startY) * width;
+
+      switch (this->m_CellFusionMode)
         {
-        outputDEMIt.Set(static_cast<DEMPixelType> (accPixel));
+        case otb::CellFusionMode::MIN:
+          {
+          if (counts[cell] == 0 || it->Height < values[cell])
+            {
+            values[cell] = it->Height;
+            }
+          }
+          break;
+        case otb::CellFusionMode::MAX:
+          {
+          if (counts[cell] == 0 || it->Height > values[cell])
+            {
+            values[cell] = it->Height;
+            }
+          }
+          break;
+        case otb::CellFusionMode::MEAN:
+          {
+          values[cell] += it->Height;
+          }
+          break;
+        default:
+          break;
         }
+      ++counts[cell];
       }
-    ++outputDEMIt;
-    ++firstDEMIt;
-    ++firstDEMAccIt;
     }
 
-  // Check DEMs from other threads and keep the maximum elevation
-  for (unsigned int i = 1; i < m_TempDEMRegions.size(); i++)
+  // For the median, gather at most m_MaximumNumberOfSamplesPerCell points per
+  // cell, evenly picked among the points of the cell in the order of the maps
+  // and of their splits, whatever the thread which binned them
+  std::vector<ValueType> cellSamples;
+  std::vector<itk::SizeValueType> firstSample;
+  if (isMedian)
     {
+    const itk::SizeValueType maxSamples = std::max(1u, m_MaximumNumberOfSamplesPerCell);
 
-    itk::ImageRegionIterator<OutputImageType> tmpDEMIt(m_TempDEMRegions[i], outputDEM->GetRequestedRegion());
-    itk::ImageRegionIterator<AccumulatorImageType> tmpDEMAccIt(m_TempDEMAccumulatorRegions[i],
-                                                               outputDEM->GetRequestedRegion());
+    firstSample.resize(nbCells + 1, 0);
+    for (itk::SizeValueType cell = 0; cell < nbCells; ++cell)
+      {
+      firstSample[cell + 1] = firstSample[cell] + std::min<itk::SizeValueType>(counts[cell], maxSamples);
+      }
+    cellSamples.resize(firstSample[nbCells]);
 
-    outputDEMIt.GoToBegin();
-    tmpDEMIt.GoToBegin();
-    tmpDEMAccIt.GoToBegin();
-    firstDEMAccIt.GoToBegin(); //Global Accumulator
-    while (!outputDEMIt.IsAtEnd() && !tmpDEMIt.IsAtEnd() && !tmpDEMAccIt.IsAtEnd() && !firstDEMAccIt.IsAtEnd())
+    SampleSegmentListType segments;
+    for (unsigned int thread = 0; thread < m_TileSegments.size(); ++thread)
       {
+      segments.insert(segments.end(), m_TileSegments[thread][tile].begin(), m_TileSegments[thread][tile].end());
+      }
+    std::sort(segments.begin(), segments.end());
 
-      // get the accumulator value
-      AccumulatorPixelType accPixel = tmpDEMAccIt.Get();
-      if (accPixel != 0)
+    std::vector<AccumulatorPixelType> ranks(nbCells, 0);
+    for (typename SampleSegmentListType::const_iterator segIt = segments.begin(); segIt != segments.end(); ++segIt)
+      {
+      const CellSampleListType & samples = m_TileSamples[segIt->Thread][tile];
+      for (typename CellSampleListType::const_iterator it = samples.begin() + segIt->Begin;
+           it != samples.begin() + segIt->End; ++it)
         {
-
-        DEMPixelType cellCurrentValue = outputDEMIt.Get();
-        DEMPixelType cellHeight = tmpDEMIt.Get();
-        switch (this->m_CellFusionMode)
+        const itk::SizeValueType x = it->Offset % outputWidth;
+        const itk::SizeValueType y = it->Offset / outputWidth;
+        if (x < startX || x >= startX + width || y < startY || y >= startY + height)
           {
-          case otb::CellFusionMode::MIN:
-            {
-            if ((cellHeight < cellCurrentValue) || (cellCurrentValue == m_NoDataValue))
-              {
-              outputDEMIt.Set(cellHeight);
-              }
-            }
-            break;
-          case otb::CellFusionMode::MAX:
-            {
-            if ((cellHeight > cellCurrentValue) || ((cellCurrentValue == m_NoDataValue)))
-              {
-              outputDEMIt.Set(cellHeight);
-              }
-            }
-            break;
-          case otb::CellFusionMode::MEAN:
-            {
-
-            outputDEMIt.Set(
-                            cellCurrentValue * static_cast<DEMPixelType> (cellCurrentValue != m_NoDataValue)
-                                + cellHeight);
-            firstDEMAccIt.Set(firstDEMAccIt.Get() + accPixel);
-
-            }
-            break;
-          case otb::CellFusionMode::ACC:
-            {
-            firstDEMAccIt.Set(firstDEMAccIt.Get() + accPixel);
-            }
-            break;
+          continue;
+          }
+        const itk::SizeValueType cell = (x - startX) + (y - startY) * width;
 
-          default:
-            itkExceptionMacro(<< "Unexpected value cell fusion mode :"<<this->m_CellFusionMode);
-            break;
+        const itk::SizeValueType count = counts[cell];
+        const itk::SizeValueType nbSamples = firstSample[cell + 1] - firstSample[cell];
+        const itk::SizeValueType rank = ranks[cell]++;
+        const itk::SizeValueType slot = (rank * nbSamples) / count;
+        if (((rank + 1) * nbSamples) / count != slot)
+          {
+          cellSamples[firstSample[cell] + slot] = it->Height;
           }
         }
+      }
+    }
 
-      if (i == (m_TempDEMRegions.size() - 1))
+  itk::ImageRegionIterator<OutputImageType> outputIt(outputPtr, fusedRegion);
+  itk::SizeValueType cell = 0;
+  for (outputIt.GoToBegin(); !outputIt.IsAtEnd(); ++outputIt, ++cell)
+    {
+    if (counts[cell] == 0)
+      {
+      outputIt.Set(m_NoDataValue);
+      continue;
+      }
+
+    switch (this->m_CellFusionMode)
+      {
+      case otb::CellFusionMode::MEAN:
+        {
+        outputIt.Set(static_cast<DEMPixelType> (values[cell] / static_cast<ValueType> (counts[cell])));
+        }
+        break;
+      case otb::CellFusionMode::ACC:
+        {
+        outputIt.Set(static_cast<DEMPixelType> (counts[cell]));
+        }
+        break;
+      case otb::CellFusionMode::MEDIAN:
         {
-        if (this->m_CellFusionMode == otb::CellFusionMode::MEAN)
+        typename std::vector<ValueType>::iterator first = cellSamples.begin() + firstSample[cell];
+        typename std::vector<ValueType>::iterator last = cellSamples.begin() + firstSample[cell + 1];
+        typename std::vector<ValueType>::iterator middle = first + (last - first) / 2;
+        std::nth_element(first, middle, last);
+        ValueType median = *middle;
+        if ((last - first) % 2 == 0)
           {
-          if (static_cast<DEMPixelType> (firstDEMAccIt.Get()) != 0)
-            {
-            outputDEMIt.Set(outputDEMIt.Get() / static_cast<DEMPixelType> (firstDEMAccIt.Get()));
-            }
-          else
-            {
-            outputDEMIt.Set(m_NoDataValue);
-            }
+          median = 0.5 * (median + *std::max_element(first, middle));
           }
-        else
-          if (this->m_CellFusionMode == otb::CellFusionMode::ACC)
-            {
-            outputDEMIt.Set(static_cast<DEMPixelType> (firstDEMAccIt.Get()));
-            }
-
+        outputIt.Set(static_cast<DEMPixelType> (median));
         }
-      ++outputDEMIt;
-      ++tmpDEMIt;
-      ++tmpDEMAccIt;
-      ++firstDEMAccIt;
+        break;
+      default:
+        {
+        outputIt.Set(static_cast<DEMPixelType> (values[cell]));
+        }
+        break;
       }
-
     }
+}
 
+template<class T3DImage, class TMaskImage, class TOutputDEMImage>
+void Multi3DMapToDEMFilter<T3DImage, TMaskImage, TOutputDEMImage>::AfterThreadedGenerateData()
+{
+  // Release the binned points
+  m_TileSamples.clear();
+  m_TileSegments.clear();
 }
 
 }
@@ -25,6 +25,9 @@
 #include "otbVectorImageToImageListFilter.h"
 #include <string>
 #include "otbGeoInformationConversion.h"
+#include "itkStreamingImageFilter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include <algorithm>
 
 typedef otb::Image<double, 2>                    ImageType;
 
@@ -555,3 +558,116 @@ int otbMulti3DMapToDEMFilter(int argc, char* argv[])
 
   return EXIT_SUCCESS;
 }
+
+int otbMulti3DMapToDEMFilterMedian(int argc, char* argv[])
+{
+  if (argc != 3)
+    {
+    std::cout << "Usage: " << argv[0] << " ThreadNb StreamNb" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Synthetic 3D map: each cell of a 6x5 DEM receives 7 points from
+  // consecutive map pixels, some of them masked out, so that cells get odd
+  // and even numbers of points. The map has no geometry, its indexes are
+  // the coordinates of its points, as is the DEM grid.
+  const unsigned int demWidth = 6;
+  const unsigned int demHeight = 5;
+  const unsigned int pointsPerCell = 7;
+
+  VectorImageType::RegionType mapRegion;
+  mapRegion.SetIndex(0, 0);
+  mapRegion.SetIndex(1, 0);
+  mapRegion.SetSize(0, demWidth * pointsPerCell);
+  mapRegion.SetSize(1, demHeight);
+
+  VectorImageType::Pointer map = VectorImageType::New();
+  map->SetRegions(mapRegion);
+  map->SetNumberOfComponentsPerPixel(3);
+  map->Allocate();
+
+  ImageType::Pointer mask = ImageType::New();
+  mask->SetRegions(mapRegion);
+  mask->Allocate();
+
+  std::vector<std::vector<double> > cellHeights(demWidth * demHeight);
+
+  itk::ImageRegionIteratorWithIndex<VectorImageType> mapIt(map, mapRegion);
+  itk::ImageRegionIteratorWithIndex<ImageType> maskIt(mask, mapRegion);
+  for (mapIt.GoToBegin(), maskIt.GoToBegin(); !mapIt.IsAtEnd(); ++mapIt, ++maskIt)
+    {
+    const unsigned int x = mapIt.GetIndex()[0] / pointsPerCell;
+    const unsigned int y = mapIt.GetIndex()[1];
+    const unsigned int k = mapIt.GetIndex()[0] % pointsPerCell;
+    const unsigned int cell = x + y * demWidth;
+
+    VectorImageType::PixelType point(3);
+    point[0] = x + 0.1 * (static_cast<double>(k) - 3.);
+    point[1] = y;
+    point[2] = 100. + 10. * cell + ((3 * k + cell) % pointsPerCell) * 1.5;
+    mapIt.Set(point);
+
+    // The last point of one cell out of two is masked
+    const bool masked = (k == pointsPerCell - 1) && (cell % 2 == 0);
+    maskIt.Set(masked ? 0. : 1.);
+    if (!masked)
+      {
+      cellHeights[cell].push_back(point[2]);
+      }
+    }
+
+  Multi3DFilterType::Pointer multiFilter = Multi3DFilterType::New();
+  multiFilter->SetNumberOf3DMaps(1);
+  multiFilter->Set3DMapInput(0, map);
+  multiFilter->SetMaskInput(0, mask);
+  multiFilter->SetCellFusionMode(otb::CellFusionMode::MEDIAN);
+
+  ImageType::IndexType start;
+  start.Fill(0);
+  multiFilter->SetOutputStartIndex(start);
+  ImageType::SizeType size;
+  size[0] = demWidth;
+  size[1] = demHeight;
+  multiFilter->SetOutputSize(size);
+  ImageType::SpacingType spacing;
+  spacing.Fill(1.);
+  multiFilter->SetOutputSpacing(spacing);
+  ImageType::PointType origin;
+  origin.Fill(0.);
+  multiFilter->SetOutputOrigin(origin);
+
+  // The whole map is requested whatever the DEM region, since the map
+  // indexes do not follow the DEM grid along x
+  multiFilter->SetMargin(mapRegion.GetSize());
+
+  // Small tiles, so that cells are spread over several tiles and threads
+  ImageType::SizeType tileSize;
+  tileSize.Fill(2);
+  multiFilter->SetTileSize(tileSize);
+  multiFilter->SetNumberOfThreads(atoi(argv[1]));
+
+  typedef itk::StreamingImageFilter<ImageType, ImageType> StreamingFilterType;
+  StreamingFilterType::Pointer streamingFilter = StreamingFilterType::New();
+  streamingFilter->SetInput(multiFilter->GetOutput());
+  streamingFilter->SetNumberOfStreamDivisions(atoi(argv[2]));
+  streamingFilter->Update();
+
+  unsigned int nbErrors = 0;
+  itk::ImageRegionIteratorWithIndex<ImageType> demIt(streamingFilter->GetOutput(),
+                                                     streamingFilter->GetOutput()->GetLargestPossibleRegion());
+  for (demIt.GoToBegin(); !demIt.IsAtEnd(); ++demIt)
+    {
+    std::vector<double> & heights = cellHeights[demIt.GetIndex()[0] + demIt.GetIndex()[1] * demWidth];
+    std::sort(heights.begin(), heights.end());
+    const std::size_t middle = heights.size() / 2;
+    const double expected = (heights.size() % 2) ? heights[middle] : 0.5 * (heights[middle - 1] + heights[middle]);
+
+    if (demIt.Get() != expected)
+      {
+      std::cout << "Cell " << demIt.GetIndex() << ": median " << demIt.Get() << " instead of " << expected << std::endl;
+      ++nbErrors;
+      }
+    }
+
+  return nbErrors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
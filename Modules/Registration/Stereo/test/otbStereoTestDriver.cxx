@@ -28,6 +28,7 @@ void RegisterTests()
   REGISTER_TEST(otbMulti3DMapToDEMFilterEPSG);
   REGISTER_TEST(otbMulti3DMapToDEMFilterManual);
   REGISTER_TEST(otbMulti3DMapToDEMFilter);
+  REGISTER_TEST(otbMulti3DMapToDEMFilterMedian);
   REGISTER_TEST(otbAdhesionCorrectionFilterNew);
   REGISTER_TEST(otbAdhesionCorrectionFilter);
   REGISTER_TEST(otbStereoSensorModelToElevationMapFilterNew);
@@ -128,7 +128,8 @@ PersistentImageToOGRLayerFilter<TImage>
 
   if (this->GetStreamSize()[0]==0 && this->GetStreamSize()[1]==0)
   {
-     this->m_StreamSize = this->GetInput()->GetRequestedRegion().GetSize();
+     // The input requested region may be padded by subclasses
+     this->m_StreamSize = this->GetOutput()->GetRequestedRegion().GetSize();
   }
 
   // call the processing function for this tile
@@ -0,0 +1,309 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbStreamingLabelImageToOGRLayerFilter_h
+#define otbStreamingLabelImageToOGRLayerFilter_h
+
+#include "otbPersistentImageToOGRLayerFilter.h"
+#include "otbPersistentFilterStreamingDecorator.h"
+#include "itkIntTypes.h"
+
+#include <deque>
+#include <list>
+#include <vector>
+#include <unordered_map>
+
+namespace otb
+{
+
+/** \class PersistentLabelImageToOGRLayerFilter
+ *  \brief Vectorize a label image by tracing pixel boundaries while streaming.
+ *
+ *  Contrary to \c LabelImageToOGRDataSourceFilter, this filter does not call
+ *  \c GDALPolygonize() on each streamed piece. Pixel boundaries are scanned
+ *  vertex by vertex, and the boundary edges of each label are linked into open
+ *  chains. Chains reaching the border of a piece are kept until the piece on the
+ *  other side has been processed, so that polygons crossing streaming lines are
+ *  closed directly, without any geometric union afterwards.
+ *
+ *  Closed rings are cut at the vertices they go through twice, so that written
+ *  geometries are valid. Each simple ring is either an exterior ring or a hole.
+ *  Holes are kept until the exterior ring of the same label enclosing them is
+ *  closed; the polygon is then written to the output layer. One feature is
+ *  produced per connected component, with the label written in the field
+ *  specified by \c SetFieldName().
+ *
+ *  Pieces have to be streamed in raster order (which is the case of all OTB
+ *  streaming managers) for holes to be attached to their exterior ring.
+ *
+ *  An optional input mask can be used to exclude pixels from vectorization.
+ *  All pixels with a value of 0 in the input mask image will not be vectorized.
+ *
+ * \note With the Use8Connected option, parts of a label touching by a corner are
+ * merged into the same feature, written as a multi-polygon. Where two labels
+ * touch by both diagonals of the same vertex, only the lowest one is joined.
+ *
+ * \sa StreamingLabelImageToOGRLayerFilter
+ * \sa LabelImageToOGRDataSourceFilter
+ *
+ * \ingroup OTBConversion
+ */
+template <class TInputImage>
+class ITK_EXPORT PersistentLabelImageToOGRLayerFilter :
+  public PersistentImageToOGRLayerFilter<TInputImage>
+{
+public:
+  /** Standard Self typedef */
+  typedef PersistentLabelImageToOGRLayerFilter           Self;
+  typedef PersistentImageToOGRLayerFilter<TInputImage>   Superclass;
+  typedef itk::SmartPointer<Self>                        Pointer;
+  typedef itk::SmartPointer<const Self>                  ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(PersistentLabelImageToOGRLayerFilter, PersistentImageToOGRLayerFilter);
+
+  typedef typename Superclass::InputImageType            InputImageType;
+  typedef typename InputImageType::PixelType             LabelPixelType;
+  typedef typename InputImageType::RegionType            RegionType;
+  typedef typename InputImageType::SizeType              SizeType;
+  typedef typename InputImageType::IndexType             IndexType;
+  typedef typename IndexType::IndexValueType             IndexValueType;
+
+  typedef typename Superclass::OGRDataSourceType         OGRDataSourceType;
+  typedef typename Superclass::OGRDataSourcePointerType  OGRDataSourcePointerType;
+  typedef typename Superclass::OGRLayerType              OGRLayerType;
+  typedef typename Superclass::OGRFeatureType            OGRFeatureType;
+
+  /** Set/Get the input mask image.
+   * All pixels in the mask with a value of 0 will not be considered
+   * suitable for vectorization.
+   */
+  virtual void SetInputMask(const InputImageType *mask);
+  virtual const InputImageType * GetInputMask(void);
+
+  /** Set/Get the field name in which labels will be written (default is "DN"). */
+  itkSetStringMacro(FieldName);
+  itkGetStringMacro(FieldName);
+
+  /** Set/Get the 8-connected neighborhood option (default is false). */
+  itkSetMacro(Use8Connected, bool);
+  itkGetMacro(Use8Connected, bool);
+
+  /** Get the number of polygons written to the output layer. */
+  itkGetConstMacro(NumberOfPolygons, itk::SizeValueType);
+
+  void Reset(void) ITK_OVERRIDE;
+  void Synthetize(void) ITK_OVERRIDE;
+
+protected:
+  PersistentLabelImageToOGRLayerFilter();
+  ~PersistentLabelImageToOGRLayerFilter() ITK_OVERRIDE;
+
+  /** Pad the requested region by one pixel on top and left, to get the
+   * pixels around each boundary vertex of the streamed piece. */
+  void GenerateInputRequestedRegion() ITK_OVERRIDE;
+
+  void PrintSelf(std::ostream& os, itk::Indent indent) const ITK_OVERRIDE;
+
+private:
+  PersistentLabelImageToOGRLayerFilter(const Self &); //purposely not implemented
+  void operator =(const Self&); //purposely not implemented
+
+  OGRDataSourcePointerType ProcessTile() ITK_OVERRIDE;
+
+  /** Directed boundary edges are identified by their start vertex and
+   * direction (0: +x, 1: +y, 2: -x, 3: -y). */
+  typedef itk::uint64_t                                  EdgeKeyType;
+  typedef itk::SizeValueType                             ChainIdType;
+  typedef std::vector<IndexType>                         RingType;
+
+  /** Open chain of boundary edges, with the label on its right side. Only
+   * vertices where the boundary changes direction are stored. */
+  struct BoundaryChain
+  {
+    LabelPixelType          Label;
+    EdgeKeyType             Head;
+    EdgeKeyType             Tail;
+    std::deque<IndexType>   Vertices;
+  };
+
+  /** Closed ring waiting to be assembled into a polygon */
+  struct ClosedRing
+  {
+    LabelPixelType Label;
+    RingType       Vertices;
+  };
+
+  typedef std::unordered_map<ChainIdType, BoundaryChain> ChainMapType;
+  typedef std::unordered_map<EdgeKeyType, ChainIdType>   ChainEndMapType;
+  typedef std::list<ClosedRing>                           ClosedRingListType;
+  typedef std::unordered_map<LabelPixelType, ClosedRingListType> HoleMapType;
+
+  /** Read one line of labels and validity flags over [xBegin, xEnd) */
+  void ReadLine(IndexValueType y, IndexValueType xBegin, IndexValueType xEnd,
+                std::vector<LabelPixelType> & labels, std::vector<char> & valid) const;
+
+  EdgeKeyType ComputeEdgeKey(IndexValueType x, IndexValueType y, unsigned int direction) const;
+
+  /** Link the incoming edge to the outgoing edge at the given vertex */
+  void LinkEdges(LabelPixelType label, const IndexType & vertex, EdgeKeyType in, EdgeKeyType out,
+                 ClosedRingListType & closedRings);
+
+  /** Cut a closed ring at the vertices it goes through twice */
+  void SplitRing(const RingType & ring, std::vector<RingType> & simpleRings) const;
+
+  /** Assemble closed rings of the current piece into polygons */
+  void FlushClosedRings(ClosedRingListType & closedRings, OGRLayerType & layer);
+
+  /** Twice the signed area of a ring in index coordinates. Exterior rings are positive. */
+  static double ComputeDoubleSignedArea(const RingType & ring);
+
+  /** Crossing number test of a point given in doubled index coordinates */
+  static bool IsInside(const RingType & ring, IndexValueType px2, IndexValueType py2);
+
+  void AddRingToPolygon(const RingType & ring, OGRPolygon & polygon) const;
+
+  std::string        m_FieldName;
+  bool               m_Use8Connected;
+  itk::SizeValueType m_NumberOfPolygons;
+
+  ChainMapType       m_Chains;
+  ChainEndMapType    m_ChainHeads;
+  ChainEndMapType    m_ChainTails;
+  ChainIdType        m_NextChainId;
+  HoleMapType        m_PendingHoles;
+};
+
+/** \class StreamingLabelImageToOGRLayerFilter
+ *  \brief Streamed vectorization of a label image into an \c ogr::Layer.
+ *
+ *  This filter wraps \c PersistentLabelImageToOGRLayerFilter with a streaming
+ *  decorator. The label image is vectorized piece by piece, and polygons are
+ *  written to the output layer as soon as they are closed, so that the memory
+ *  footprint only depends on the polygons crossing the current streaming lines.
+ *
+ *  The output layer must contain an integer field named as specified by
+ *  \c SetFieldName(), and \c Initialize() must be called before \c Update().
+ *
+ * \sa PersistentLabelImageToOGRLayerFilter
+ *
+ * \ingroup OTBConversion
+ */
+template <class TInputImage>
+class ITK_EXPORT StreamingLabelImageToOGRLayerFilter :
+  public PersistentFilterStreamingDecorator<PersistentLabelImageToOGRLayerFilter<TInputImage> >
+{
+public:
+  /** Standard Self typedef */
+  typedef StreamingLabelImageToOGRLayerFilter                                       Self;
+  typedef PersistentFilterStreamingDecorator
+  <PersistentLabelImageToOGRLayerFilter<TInputImage> >                              Superclass;
+  typedef itk::SmartPointer<Self>                                                   Pointer;
+  typedef itk::SmartPointer<const Self>                                             ConstPointer;
+
+  /** Type macro */
+  itkNewMacro(Self);
+
+  /** Creation through object factory macro */
+  itkTypeMacro(StreamingLabelImageToOGRLayerFilter, PersistentFilterStreamingDecorator);
+
+  typedef TInputImage                                                               InputImageType;
+  typedef typename PersistentLabelImageToOGRLayerFilter<TInputImage>::OGRLayerType  OGRLayerType;
+
+  using Superclass::SetInput;
+  void SetInput(const InputImageType * input)
+  {
+    this->GetFilter()->SetInput(input);
+  }
+  const InputImageType * GetInput()
+  {
+    return this->GetFilter()->GetInput();
+  }
+
+  /** Set/Get the input mask image.
+   * All pixels in the mask with a value of 0 will not be considered
+   * suitable for vectorization.
+   */
+  void SetInputMask(const InputImageType * mask)
+  {
+    this->GetFilter()->SetInputMask(mask);
+  }
+  const InputImageType * GetInputMask()
+  {
+    return this->GetFilter()->GetInputMask();
+  }
+
+  /** Set the \c ogr::Layer in which the polygons will be written. */
+  void SetOGRLayer( const OGRLayerType & ogrLayer )
+  {
+    this->GetFilter()->SetOGRLayer(ogrLayer);
+  }
+
+  void SetFieldName( const std::string & fieldName )
+  {
+    this->GetFilter()->SetFieldName(fieldName);
+  }
+
+  const char * GetFieldName()
+  {
+    return this->GetFilter()->GetFieldName();
+  }
+
+  void SetUse8Connected(bool flag)
+  {
+    this->GetFilter()->SetUse8Connected(flag);
+  }
+
+  bool GetUse8Connected()
+  {
+    return this->GetFilter()->GetUse8Connected();
+  }
+
+  itk::SizeValueType GetNumberOfPolygons() const
+  {
+    return this->GetFilter()->GetNumberOfPolygons();
+  }
+
+  void Initialize()
+  {
+    this->GetFilter()->Initialize();
+  }
+
+protected:
+  /** Constructor */
+  StreamingLabelImageToOGRLayerFilter() {}
+  /** Destructor */
+  ~StreamingLabelImageToOGRLayerFilter() ITK_OVERRIDE {}
+
+private:
+  StreamingLabelImageToOGRLayerFilter(const Self &); //purposely not implemented
+  void operator =(const Self&); //purposely not implemented
+};
+
+} // end namespace otb
+
+#ifndef OTB_MANUAL_INSTANTIATION
+#include "otbStreamingLabelImageToOGRLayerFilter.txx"
+#endif
+
+#endif
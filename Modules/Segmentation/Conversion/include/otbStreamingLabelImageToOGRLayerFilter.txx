@@ -0,0 +1,695 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbStreamingLabelImageToOGRLayerFilter_txx
+#define otbStreamingLabelImageToOGRLayerFilter_txx
+
+#include "otbStreamingLabelImageToOGRLayerFilter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkTimeProbe.h"
+#include "otbMacro.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace otb
+{
+
+template <class TInputImage>
+PersistentLabelImageToOGRLayerFilter<TInputImage>
+::PersistentLabelImageToOGRLayerFilter() : m_FieldName("DN"), m_Use8Connected(false), m_NumberOfPolygons(0), m_NextChainId(0)
+{
+  this->SetNumberOfRequiredInputs(1);
+}
+
+template <class TInputImage>
+PersistentLabelImageToOGRLayerFilter<TInputImage>
+::~PersistentLabelImageToOGRLayerFilter()
+{
+}
+
+template <class TInputImage>
+void
+PersistentLabelImageToOGRLayerFilter<TInputImage>
+::SetInputMask(const InputImageType *mask)
+{
+  this->itk::ProcessObject::SetNthInput(1, const_cast<InputImageType *>(mask));
+}
+
+template <class TInputImage>
+const typename PersistentLabelImageToOGRLayerFilter<TInputImage>::InputImageType *
+PersistentLabelImageToOGRLayerFilter<TInputImage>
+::GetInputMask(void)
+{
+  if (this->GetNumberOfInputs() < 2)
+    {
+    return ITK_NULLPTR;
+    }
+  return static_cast<const InputImageType *>(this->itk::ProcessObject::GetInput(1));
+}
+
+template <class TInputImage>
+void
+PersistentLabelImageToOGRLayerFilter<TInputImage>
+::Reset()
+{
+  m_Chains.clear();
+  m_ChainHeads.clear();
+  m_ChainTails.clear();
+  m_PendingHoles.clear();
+  m_NextChainId = 0;
+  m_NumberOfPolygons = 0;
+}
+
+template <class TInputImage>
+void
+PersistentLabelImageToOGRLayerFilter<TInputImage>
+::Synthetize()
+{
+  // All chains are closed once the last piece has been processed, unless
+  // the streamed pieces did not cover the whole image.
+  if (!m_Chains.empty())
+    {
+    itkWarningMacro(<< m_Chains.size() << " boundary chains are still open after streaming. "
+                    << "The corresponding polygons have not been written.");
+    }
+
+  itk::SizeValueType nbOrphanHoles = 0;
+  for (typename HoleMapType::const_iterator it = m_PendingHoles.begin(); it != m_PendingHoles.end(); ++it)
+    {
+    nbOrphanHoles += it->second.size();
+    }
+  if (nbOrphanHoles > 0)
+    {
+    itkWarningMacro(<< nbOrphanHoles << " holes could not be attached to their polygon. "
+                    << "Pieces were probably not streamed in raster order.");
+    }
+
+  m_Chains.clear();
+  m_ChainHeads.clear();
+  m_ChainTails.clear();
+  m_PendingHoles.clear();
+}
+
+template <class TInputImage>
+void
+PersistentLabelImageToOGRLayerFilter<TInputImage>
+::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  // Vertices of the streamed piece are the top-left corners of its pixels
+  // (plus the right and bottom image borders), so that each vertex is processed
+  // once. Pixels above and on the left of the piece are needed as well.
+  RegionType requestedRegion = this->GetOutput()->GetRequestedRegion();
+  IndexType index = requestedRegion.GetIndex();
+  SizeType  size  = requestedRegion.GetSize();
+  index[0] -= 1;
+  index[1] -= 1;
+  size[0] += 1;
+  size[1] += 1;
+  requestedRegion.SetIndex(index);
+  requestedRegion.SetSize(size);
+
+  for (unsigned int i = 0; i < this->GetNumberOfInputs(); ++i)
+    {
+    InputImageType * input = const_cast<InputImageType *>(
+      static_cast<const InputImageType *>(this->itk::ProcessObject::GetInput(i)));
+    if (input)
+      {
+      RegionType inputRegion = requestedRegion;
+      inputRegion.Crop(input->GetLargestPossibleRegion());
+      input->SetRequestedRegion(inputRegion);
+      }
+    }
+}
+
+template <class TInputImage>
+typename PersistentLabelImageToOGRLayerFilter<TInputImage>::EdgeKeyType
+PersistentLabelImageToOGRLayerFilter<TInputImage>
+::ComputeEdgeKey(IndexValueType x, IndexValueType y, unsigned int direction) const
+{
+  const RegionType & largest = this->GetInput()->GetLargestPossibleRegion();
+  const EdgeKeyType vx = static_cast<EdgeKeyType>(x - largest.GetIndex()[0]);
+  const EdgeKeyType vy = static_cast<EdgeKeyType>(y - largest.GetIndex()[1]);
+  const EdgeKeyType nbVerticesPerLine = static_cast<EdgeKeyType>(largest.GetSize()[0]) + 1;
+  return ((vy * nbVerticesPerLine + vx) << 2) | direction;
+}
+
+template <class TInputImage>
+void
+PersistentLabelImageToOGRLayerFilter<TInputImage>
+::ReadLine(IndexValueType y, IndexValueType xBegin, IndexValueType xEnd,
+           std::vector<LabelPixelType> & labels, std::vector<char> & valid) const
+{
+  std::fill(valid.begin(), valid.end(), 0);
+
+  const InputImageType * input = this->GetInput();
+  const InputImageType * mask = static_cast<const InputImageType *>(this->itk::ProcessObject::GetInput(1));
+
+  RegionType lineRegion;
+  IndexType lineIndex;
+  SizeType lineSize;
+  lineIndex[0] = xBegin;
+  lineIndex[1] = y;
+  lineSize[0] = xEnd - xBegin;
+  lineSize[1] = 1;
+  lineRegion.SetIndex(lineIndex);
+  lineRegion.SetSize(lineSize);
+
+  // Pixels outside of the buffered region are either outside the image
+  // or not needed by the vertices of this piece.
+  if (!lineRegion.Crop(input->GetBufferedRegion()))
+    {
+    return;
+    }
+
+  const IndexValueType offset = lineRegion.GetIndex()[0] - xBegin;
+
+  itk::ImageRegionConstIterator<InputImageType> it(input, lineRegion);
+  unsigned int i = offset;
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it, ++i)
+    {
+    labels[i] = it.Get();
+    valid[i] = 1;
+    }
+
+  if (mask)
+    {
+    itk::ImageRegionConstIterator<InputImageType> maskIt(mask, lineRegion);
+    i = offset;
+    for (maskIt.GoToBegin(); !maskIt.IsAtEnd(); ++maskIt, ++i)
+      {
+      if (maskIt.Get() == 0)
+        {
+        valid[i] = 0;
+        }
+      }
+    }
+}
+
+template <class TInputImage>
+void
+PersistentLabelImageToOGRLayerFilter<TInputImage>
+::LinkEdges(LabelPixelType label, const IndexType & vertex, EdgeKeyType in, EdgeKeyType out,
+            ClosedRingListType & closedRings)
+{
+  // Straight boundaries do not need intermediate vertices
+  const bool corner = (in & 3) != (out & 3);
+
+  typename ChainEndMapType::iterator previous = m_ChainTails.find(in);
+  typename ChainEndMapType::iterator next = m_ChainHeads.find(out);
+
+  if (previous == m_ChainTails.end() && next == m_ChainHeads.end())
+    {
+    // Start a new chain
+    const ChainIdType id = m_NextChainId++;
+    BoundaryChain & chain = m_Chains[id];
+    chain.Label = label;
+    chain.Head = in;
+    chain.Tail = out;
+    if (corner)
+      {
+      chain.Vertices.push_back(vertex);
+      }
+    m_ChainHeads[in] = id;
+    m_ChainTails[out] = id;
+    }
+  else if (next == m_ChainHeads.end())
+    {
+    // Extend the chain ending with the incoming edge
+    const ChainIdType id = previous->second;
+    BoundaryChain & chain = m_Chains[id];
+    if (corner)
+      {
+      chain.Vertices.push_back(vertex);
+      }
+    chain.Tail = out;
+    m_ChainTails.erase(previous);
+    m_ChainTails[out] = id;
+    }
+  else if (previous == m_ChainTails.end())
+    {
+    // Extend the chain starting with the outgoing edge
+    const ChainIdType id = next->second;
+    BoundaryChain & chain = m_Chains[id];
+    if (corner)
+      {
+      chain.Vertices.push_front(vertex);
+      }
+    chain.Head = in;
+    m_ChainHeads.erase(next);
+    m_ChainHeads[in] = id;
+    }
+  else if (previous->second == next->second)
+    {
+    // The chain closes on itself
+    const ChainIdType id = previous->second;
+    typename ChainMapType::iterator chainIt = m_Chains.find(id);
+    if (corner)
+      {
+      chainIt->second.Vertices.push_back(vertex);
+      }
+    m_ChainTails.erase(previous);
+    m_ChainHeads.erase(next);
+
+    closedRings.push_back(ClosedRing());
+    closedRings.back().Label = label;
+    closedRings.back().Vertices.assign(chainIt->second.Vertices.begin(), chainIt->second.Vertices.end());
+    m_Chains.erase(chainIt);
+    }
+  else
+    {
+    // Join two chains, copying the shortest one into the longest one
+    const ChainIdType previousId = previous->second;
+    const ChainIdType nextId = next->second;
+    m_ChainTails.erase(previous);
+    m_ChainHeads.erase(next);
+
+    typename ChainMapType::iterator previousIt = m_Chains.find(previousId);
+    typename ChainMapType::iterator nextIt = m_Chains.find(nextId);
+    BoundaryChain & previousChain = previousIt->second;
+    BoundaryChain & nextChain = nextIt->second;
+
+    if (previousChain.Vertices.size() >= nextChain.Vertices.size())
+      {
+      if (corner)
+        {
+        previousChain.Vertices.push_back(vertex);
+        }
+      previousChain.Vertices.insert(previousChain.Vertices.end(), nextChain.Vertices.begin(), nextChain.Vertices.end());
+      previousChain.Tail = nextChain.Tail;
+      m_ChainTails[nextChain.Tail] = previousId;
+      m_Chains.erase(nextIt);
+      }
+    else
+      {
+      if (corner)
+        {
+        nextChain.Vertices.push_front(vertex);
+        }
+      nextChain.Vertices.insert(nextChain.Vertices.begin(), previousChain.Vertices.begin(), previousChain.Vertices.end());
+      nextChain.Head = previousChain.Head;
+      m_ChainHeads[previousChain.Head] = nextId;
+      m_Chains.erase(previousIt);
+      }
+    }
+}
+
+template <class TInputImage>
+double
+PersistentLabelImageToOGRLayerFilter<TInputImage>
+::ComputeDoubleSignedArea(const RingType & ring)
+{
+  double area = 0.;
+  const std::size_t n = ring.size();
+  for (std::size_t i = 0; i < n; ++i)
+    {
+    const IndexType & p = ring[i];
+    const IndexType & q = ring[(i + 1) % n];
+    area += static_cast<double>(p[0]) * static_cast<double>(q[1])
+      - static_cast<double>(q[0]) * static_cast<double>(p[1]);
+    }
+  return area;
+}
+
+template <class TInputImage>
+bool
+PersistentLabelImageToOGRLayerFilter<TInputImage>
+::IsInside(const RingType & ring, IndexValueType px2, IndexValueType py2)
+{
+  // Rings only have horizontal and vertical edges: count the vertical edges
+  // crossed by a ray going toward +x.
+  bool inside = false;
+  const std::size_t n = ring.size();
+  for (std::size_t i = 0; i < n; ++i)
+    {
+    const IndexType & p = ring[i];
+    const IndexType & q = ring[(i + 1) % n];
+    if (p[0] == q[0] && 2 * p[0] > px2 && ((2 * p[1] > py2) != (2 * q[1] > py2)))
+      {
+      inside = !inside;
+      }
+    }
+  return inside;
+}
+
+template <class TInputImage>
+void
+PersistentLabelImageToOGRLayerFilter<TInputImage>
+::AddRingToPolygon(const RingType & ring, OGRPolygon & polygon) const
+{
+  const InputImageType * input = this->GetInput();
+  const typename InputImageType::PointType & origin = input->GetOrigin();
+  const typename InputImageType::SpacingType & spacing = input->GetSpacing();
+
+  // Vertex (i,j) is the top-left corner of pixel (i,j)
+  OGRLinearRing ogrRing;
+  ogrRing.setNumPoints(static_cast<int>(ring.size()) + 1);
+  for (std::size_t i = 0; i < ring.size(); ++i)
+    {
+    ogrRing.setPoint(static_cast<int>(i),
+                     origin[0] + (static_cast<double>(ring[i][0]) - 0.5) * spacing[0],
+                     origin[1] + (static_cast<double>(ring[i][1]) - 0.5) * spacing[1]);
+    }
+  ogrRing.setPoint(static_cast<int>(ring.size()),
+                   origin[0] + (static_cast<double>(ring[0][0]) - 0.5) * spacing[0],
+                   origin[1] + (static_cast<double>(ring[0][1]) - 0.5) * spacing[1]);
+  polygon.addRing(&ogrRing);
+}
+
+template <class TInputImage>
+void
+PersistentLabelImageToOGRLayerFilter<TInputImage>
+::SplitRing(const RingType & ring, std::vector<RingType> & simpleRings) const
+{
+  // A boundary pinched at a diagonal vertex goes twice through this vertex:
+  // the ring is cut there so that only simple rings are written.
+  std::unordered_map<EdgeKeyType, std::size_t> positions;
+  RingType stack;
+  stack.reserve(ring.size());
+
+  for (typename RingType::const_iterator it = ring.begin(); it != ring.end(); ++it)
+    {
+    const EdgeKeyType key = ComputeEdgeKey((*it)[0], (*it)[1], 0);
+    typename std::unordered_map<EdgeKeyType, std::size_t>::iterator posIt = positions.find(key);
+    if (posIt == positions.end())
+      {
+      positions[key] = stack.size();
+      stack.push_back(*it);
+      }
+    else
+      {
+      const std::size_t first = posIt->second;
+      simpleRings.push_back(RingType(stack.begin() + first, stack.end()));
+      for (std::size_t i = first + 1; i < stack.size(); ++i)
+        {
+        positions.erase(ComputeEdgeKey(stack[i][0], stack[i][1], 0));
+        }
+      stack.resize(first + 1);
+      }
+    }
+  simpleRings.push_back(stack);
+}
+
+template <class TInputImage>
+void
+PersistentLabelImageToOGRLayerFilter<TInputImage>
+::FlushClosedRings(ClosedRingListType & closedRings, OGRLayerType & layer)
+{
+  // Holes closed in this piece are registered first: a hole is always
+  // closed before, or at the same vertex as, its exterior ring.
+  std::vector<std::vector<RingType> > exteriors(closedRings.size());
+  std::vector<RingType> simpleRings;
+
+  unsigned int ringId = 0;
+  for (typename ClosedRingListType::iterator ringIt = closedRings.begin(); ringIt != closedRings.end(); ++ringIt, ++ringId)
+    {
+    simpleRings.clear();
+    SplitRing(ringIt->Vertices, simpleRings);
+
+    for (typename std::vector<RingType>::iterator it = simpleRings.begin(); it != simpleRings.end(); ++it)
+      {
+      if (ComputeDoubleSignedArea(*it) > 0)
+        {
+        exteriors[ringId].push_back(RingType());
+        exteriors[ringId].back().swap(*it);
+        }
+      else
+        {
+        ClosedRingListType & holes = m_PendingHoles[ringIt->Label];
+        holes.push_back(ClosedRing());
+        holes.back().Label = ringIt->Label;
+        holes.back().Vertices.swap(*it);
+        }
+      }
+    }
+
+  // Exterior rings are processed in closing order, so that the innermost
+  // exterior ring of a label gets its holes first.
+  ringId = 0;
+  for (typename ClosedRingListType::iterator ringIt = closedRings.begin(); ringIt != closedRings.end(); ++ringIt, ++ringId)
+    {
+    if (exteriors[ringId].empty())
+      {
+      continue;
+      }
+
+    // Several exterior rings come from the same boundary only when parts
+    // of a 8-connected component touch by a corner.
+    OGRMultiPolygon parts;
+    for (typename std::vector<RingType>::const_iterator extIt = exteriors[ringId].begin(); extIt != exteriors[ringId].end(); ++extIt)
+      {
+      const RingType & exterior = *extIt;
+
+      OGRPolygon polygon;
+      AddRingToPolygon(exterior, polygon);
+
+      typename HoleMapType::iterator holesIt = m_PendingHoles.find(ringIt->Label);
+      if (holesIt != m_PendingHoles.end())
+        {
+        IndexType minCorner = exterior[0];
+        IndexType maxCorner = exterior[0];
+        for (typename RingType::const_iterator vIt = exterior.begin(); vIt != exterior.end(); ++vIt)
+          {
+          for (unsigned int dim = 0; dim < 2; ++dim)
+            {
+            minCorner[dim] = std::min(minCorner[dim], (*vIt)[dim]);
+            maxCorner[dim] = std::max(maxCorner[dim], (*vIt)[dim]);
+            }
+          }
+
+        typename ClosedRingListType::iterator holeIt = holesIt->second.begin();
+        while (holeIt != holesIt->second.end())
+          {
+          // The middle of the first unit edge of the hole can not lie on
+          // another boundary of the same label
+          const IndexType & p = holeIt->Vertices[0];
+          const IndexType & q = holeIt->Vertices[1];
+          const IndexValueType px2 = 2 * p[0] + (q[0] > p[0] ? 1 : (q[0] < p[0] ? -1 : 0));
+          const IndexValueType py2 = 2 * p[1] + (q[1] > p[1] ? 1 : (q[1] < p[1] ? -1 : 0));
+
+          if (px2 > 2 * minCorner[0] && px2 < 2 * maxCorner[0]
+              && py2 > 2 * minCorner[1] && py2 < 2 * maxCorner[1]
+              && IsInside(exterior, px2, py2))
+            {
+            AddRingToPolygon(holeIt->Vertices, polygon);
+            holeIt = holesIt->second.erase(holeIt);
+            }
+          else
+            {
+            ++holeIt;
+            }
+          }
+
+        if (holesIt->second.empty())
+          {
+          m_PendingHoles.erase(holesIt);
+          }
+        }
+      parts.addGeometry(&polygon);
+      }
+
+    OGRFeatureType feature(layer.GetLayerDefn());
+    feature[m_FieldName].SetValue<int>(static_cast<int>(ringIt->Label));
+    if (parts.getNumGeometries() == 1)
+      {
+      feature.SetGeometry(parts.getGeometryRef(0));
+      }
+    else
+      {
+      feature.SetGeometry(&parts);
+      }
+    layer.CreateFeature(feature);
+    ++m_NumberOfPolygons;
+    }
+
+  closedRings.clear();
+}
+
+template <class TInputImage>
+typename PersistentLabelImageToOGRLayerFilter<TInputImage>::OGRDataSourcePointerType
+PersistentLabelImageToOGRLayerFilter<TInputImage>
+::ProcessTile()
+{
+  itk::TimeProbe chrono;
+  chrono.Start();
+
+  OGRDataSourcePointerType tileDS = OGRDataSourceType::New();
+  OGRLayerType tileLayer = tileDS->CreateLayer("layer", ITK_NULLPTR, wkbPolygon);
+  OGRFieldDefn field(m_FieldName.c_str(), OFTInteger);
+  tileLayer.CreateField(field, true);
+
+  const RegionType & largest = this->GetInput()->GetLargestPossibleRegion();
+  const RegionType & piece = this->GetOutput()->GetRequestedRegion();
+
+  // Range of vertices processed in this piece
+  const IndexValueType xBegin = piece.GetIndex()[0];
+  const IndexValueType yBegin = piece.GetIndex()[1];
+  IndexValueType xEnd = xBegin + static_cast<IndexValueType>(piece.GetSize()[0]);
+  IndexValueType yEnd = yBegin + static_cast<IndexValueType>(piece.GetSize()[1]);
+  if (xEnd == largest.GetIndex()[0] + static_cast<IndexValueType>(largest.GetSize()[0]))
+    {
+    ++xEnd;
+    }
+  if (yEnd == largest.GetIndex()[1] + static_cast<IndexValueType>(largest.GetSize()[1]))
+    {
+    ++yEnd;
+    }
+
+  // Lines of pixels above and below the current line of vertices,
+  // starting at pixel xBegin-1.
+  const std::size_t lineLength = static_cast<std::size_t>(xEnd - xBegin + 1);
+  std::vector<LabelPixelType> upperLabels(lineLength), lowerLabels(lineLength);
+  std::vector<char> upperValid(lineLength), lowerValid(lineLength);
+
+  ReadLine(yBegin - 1, xBegin - 1, xEnd, upperLabels, upperValid);
+
+  ClosedRingListType closedRings;
+
+  LabelPixelType labels[4];
+  bool valid[4];
+  EdgeKeyType inEdges[4];
+  EdgeKeyType outEdges[4];
+  bool hasIn[4];
+  bool hasOut[4];
+
+  for (IndexValueType y = yBegin; y < yEnd; ++y)
+    {
+    ReadLine(y, xBegin - 1, xEnd, lowerLabels, lowerValid);
+
+    for (IndexValueType x = xBegin; x < xEnd; ++x)
+      {
+      // Pixels around the vertex: 0 = upper left, 1 = upper right, 2 = lower left, 3 = lower right
+      const std::size_t i = static_cast<std::size_t>(x - xBegin);
+      labels[0] = upperLabels[i];
+      labels[1] = upperLabels[i + 1];
+      labels[2] = lowerLabels[i];
+      labels[3] = lowerLabels[i + 1];
+      valid[0] = upperValid[i] != 0;
+      valid[1] = upperValid[i + 1] != 0;
+      valid[2] = lowerValid[i] != 0;
+      valid[3] = lowerValid[i + 1] != 0;
+
+      if (!valid[0] && !valid[1] && !valid[2] && !valid[3])
+        {
+        continue;
+        }
+
+      const bool same01 = valid[0] && valid[1] && labels[0] == labels[1];
+      const bool same02 = valid[0] && valid[2] && labels[0] == labels[2];
+      const bool same13 = valid[1] && valid[3] && labels[1] == labels[3];
+      const bool same23 = valid[2] && valid[3] && labels[2] == labels[3];
+
+      // Homogeneous neighborhood: no boundary passes through this vertex
+      if (same01 && same02 && same13 && same23)
+        {
+        continue;
+        }
+
+      // Boundary edges follow the pixel outline clockwise in index space,
+      // the labelled pixel being on their right.
+      hasIn[0] = valid[0] && !same01;
+      hasOut[0] = valid[0] && !same02;
+      hasIn[1] = valid[1] && !same13;
+      hasOut[1] = valid[1] && !same01;
+      hasIn[2] = valid[2] && !same02;
+      hasOut[2] = valid[2] && !same23;
+      hasIn[3] = valid[3] && !same23;
+      hasOut[3] = valid[3] && !same13;
+
+      inEdges[0] = ComputeEdgeKey(x, y - 1, 1);
+      outEdges[0] = ComputeEdgeKey(x, y, 2);
+      inEdges[1] = ComputeEdgeKey(x + 1, y, 2);
+      outEdges[1] = ComputeEdgeKey(x, y, 3);
+      inEdges[2] = ComputeEdgeKey(x - 1, y, 0);
+      outEdges[2] = ComputeEdgeKey(x, y, 1);
+      inEdges[3] = ComputeEdgeKey(x, y + 1, 3);
+      outEdges[3] = ComputeEdgeKey(x, y, 0);
+
+      IndexType vertex;
+      vertex[0] = x;
+      vertex[1] = y;
+
+      // Diagonal configurations: two boundaries of the same label cross the vertex
+      const bool diagonal03 = valid[0] && valid[3] && labels[0] == labels[3] && !same01 && !same02;
+      const bool diagonal12 = valid[1] && valid[2] && labels[1] == labels[2] && !same01 && !same13;
+
+      for (unsigned int p = 0; p < 4; ++p)
+        {
+        if (!hasIn[p])
+          {
+          continue;
+          }
+
+        // Find the outgoing edge of the same boundary
+        unsigned int q = 4;
+        if ((diagonal03 && (p == 0 || p == 3)) || (diagonal12 && (p == 1 || p == 2)))
+          {
+          // When both diagonals hold the same label, only the lowest label is
+          // joined so that boundaries never cross.
+          const bool join = m_Use8Connected
+            && !(diagonal03 && diagonal12 && labels[p] != std::min(labels[0], labels[1]));
+          q = join ? 3 - p : p;
+          }
+        else
+          {
+          for (unsigned int k = 0; k < 4 && q == 4; ++k)
+            {
+            if (hasOut[k] && valid[k] && labels[k] == labels[p])
+              {
+              q = k;
+              }
+            }
+          }
+        assert(q < 4 && "Unable to find the outgoing boundary edge.");
+
+        LinkEdges(labels[p], vertex, inEdges[p], outEdges[q], closedRings);
+        }
+      }
+
+    FlushClosedRings(closedRings, tileLayer);
+
+    std::swap(upperLabels, lowerLabels);
+    std::swap(upperValid, lowerValid);
+    }
+
+  chrono.Stop();
+  otbMsgDebugMacro(<< "boundary tracing took " << chrono.GetTotal() << " sec, "
+                   << m_Chains.size() << " chains left open");
+
+  return tileDS;
+}
+
+template <class TInputImage>
+void
+PersistentLabelImageToOGRLayerFilter<TInputImage>
+::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "Field name: " << m_FieldName << std::endl;
+  os << indent << "Use 8 connected: " << m_Use8Connected << std::endl;
+  os << indent << "Number of polygons: " << m_NumberOfPolygons << std::endl;
+  os << indent << "Open chains: " << m_Chains.size() << std::endl;
+}
+
+} // end namespace otb
+
+#endif
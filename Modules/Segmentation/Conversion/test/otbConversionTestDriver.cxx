@@ -39,4 +39,6 @@ void RegisterTests()
   REGISTER_TEST(otbLabelImageRegionMergingFilter);
   REGISTER_TEST(otbLabelMapToVectorDataFilter);
   REGISTER_TEST(otbLabelMapToVectorDataFilterNew);
+  REGISTER_TEST(otbStreamingLabelImageToOGRLayerFilterNew);
+  REGISTER_TEST(otbStreamingLabelImageToOGRLayerFilter);
 }
@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbImage.h"
+#include "otbImageFileReader.h"
+
+#include "otbStreamingLabelImageToOGRLayerFilter.h"
+#include "otbOGRDataSourceToLabelImageFilter.h"
+
+#include "itkImageRegionConstIteratorWithIndex.h"
+
+int otbStreamingLabelImageToOGRLayerFilterNew(int itkNotUsed(argc), char * itkNotUsed(argv) [])
+{
+  typedef otb::Image<unsigned int, 2>                               ImageType;
+  typedef otb::StreamingLabelImageToOGRLayerFilter<ImageType>       FilterType;
+
+  FilterType::Pointer filter = FilterType::New();
+
+  std::cout << filter << std::endl;
+
+  return EXIT_SUCCESS;
+}
+
+int otbStreamingLabelImageToOGRLayerFilter(int argc, char * argv[])
+{
+  if (argc != 4)
+    {
+    std::cerr << "Usage: " << argv[0];
+    std::cerr << " inputLabelImageFile tileSize use8Connected" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  typedef unsigned int                                              PixelType;
+  typedef otb::Image<PixelType, 2>                                  ImageType;
+  typedef otb::ImageFileReader<ImageType>                           ReaderType;
+  typedef otb::StreamingLabelImageToOGRLayerFilter<ImageType>       FilterType;
+  typedef otb::OGRDataSourceToLabelImageFilter<ImageType>           RasterizationFilterType;
+
+  const unsigned int tileSize = atoi(argv[2]);
+  const bool use8Connected = atoi(argv[3]);
+
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(argv[1]);
+  reader->UpdateOutputInformation();
+
+  // Vectorize the label image in a memory layer, with small tiles so that
+  // many polygons cross streaming lines
+  otb::ogr::DataSource::Pointer ogrDS = otb::ogr::DataSource::New();
+  OGRSpatialReference oSRS(reader->GetOutput()->GetProjectionRef().c_str());
+  otb::ogr::Layer layer = ogrDS->CreateLayer("layer",
+    reader->GetOutput()->GetProjectionRef().empty() ? ITK_NULLPTR : &oSRS, wkbPolygon);
+  OGRFieldDefn field("DN", OFTInteger);
+  layer.CreateField(field, true);
+
+  FilterType::Pointer vectorization = FilterType::New();
+  vectorization->SetInput(reader->GetOutput());
+  vectorization->SetOGRLayer(layer);
+  vectorization->SetFieldName("DN");
+  vectorization->SetUse8Connected(use8Connected);
+  vectorization->GetStreamer()->SetTileDimensionTiledStreaming(tileSize);
+  vectorization->Initialize();
+  vectorization->Update();
+
+  std::cout << vectorization->GetNumberOfPolygons() << " polygons written" << std::endl;
+
+  // Every polygon must be valid
+  for (otb::ogr::Layer::const_iterator featIt = layer.begin(); featIt != layer.end(); ++featIt)
+    {
+    if (!featIt->GetGeometry()->IsValid())
+      {
+      std::cerr << "Feature " << featIt->GetFID() << " has an invalid geometry" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // Rasterize back the polygons: the result must be exactly the input label image
+  RasterizationFilterType::Pointer rasterization = RasterizationFilterType::New();
+  rasterization->AddOGRDataSource(ogrDS);
+  rasterization->SetOutputParametersFromImage(reader->GetOutput());
+  rasterization->SetBurnAttribute("DN");
+  rasterization->Update();
+
+  reader->Update();
+
+  itk::ImageRegionConstIteratorWithIndex<ImageType> itRef(reader->GetOutput(),
+                                                          reader->GetOutput()->GetLargestPossibleRegion());
+  itk::ImageRegionConstIteratorWithIndex<ImageType> itTest(rasterization->GetOutput(),
+                                                           rasterization->GetOutput()->GetLargestPossibleRegion());
+
+  for(itRef.GoToBegin(), itTest.GoToBegin();
+      !itRef.IsAtEnd() && !itTest.IsAtEnd();
+      ++itRef, ++itTest)
+    {
+    if (itRef.Get() != itTest.Get())
+      {
+      std::cerr << "Pixel at position " << itRef.GetIndex() << " differs : in=" << itRef.Get() << " while out=" << itTest.Get() << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
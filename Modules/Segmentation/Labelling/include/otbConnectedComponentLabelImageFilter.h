@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbConnectedComponentLabelImageFilter_h
+#define otbConnectedComponentLabelImageFilter_h
+
+#include "itkImageToImageFilter.h"
+#include "otbStreamingConnectedComponentLabellingFilter.h"
+
+namespace otb
+{
+
+/** \class ConnectedComponentLabelImageFilter
+ * \brief Second pass of a streamed connected component labelling.
+ *
+ * This filter writes the label image of the connected components resolved by
+ * a \c PersistentConnectedComponentLabellingFilter, which must have processed
+ * the whole input image first (see \c StreamingConnectedComponentLabellingFilter).
+ *
+ * The blocks of the labelling grid intersecting the requested region are
+ * labelled again, and their labels replaced by the final ones. This filter is
+ * streamable and multithreaded, the input requested region being padded to
+ * whole blocks.
+ *
+ * \sa PersistentConnectedComponentLabellingFilter
+ *
+ * \ingroup Streamed
+ * \ingroup Multithreaded
+ *
+ * \ingroup OTBLabelling
+ */
+template <class TInputImage, class TOutputImage>
+class ITK_EXPORT ConnectedComponentLabelImageFilter
+  : public itk::ImageToImageFilter<TInputImage, TOutputImage>
+{
+public:
+  /** Standard class typedefs. */
+  typedef ConnectedComponentLabelImageFilter                 Self;
+  typedef itk::ImageToImageFilter<TInputImage, TOutputImage> Superclass;
+  typedef itk::SmartPointer<Self>                            Pointer;
+  typedef itk::SmartPointer<const Self>                      ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(ConnectedComponentLabelImageFilter, ImageToImageFilter);
+
+  typedef TInputImage                              InputImageType;
+  typedef TOutputImage                             OutputImageType;
+  typedef typename OutputImageType::PixelType      OutputPixelType;
+  typedef typename OutputImageType::RegionType     OutputImageRegionType;
+
+  typedef PersistentConnectedComponentLabellingFilter<InputImageType> LabellingFilterType;
+  typedef typename LabellingFilterType::LabelType                     LabelType;
+  typedef typename LabellingFilterType::RegionType                    RegionType;
+
+  /** Set/Get the labelling filter used in the first pass */
+  itkSetConstObjectMacro(LabellingFilter, LabellingFilterType);
+  itkGetConstObjectMacro(LabellingFilter, LabellingFilterType);
+
+protected:
+  ConnectedComponentLabelImageFilter();
+  ~ConnectedComponentLabelImageFilter() ITK_OVERRIDE {}
+
+  void BeforeThreadedGenerateData() ITK_OVERRIDE;
+
+  /** Pad the requested region to whole blocks of the labelling grid */
+  void GenerateInputRequestedRegion() ITK_OVERRIDE;
+
+  void ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread, itk::ThreadIdType threadId) ITK_OVERRIDE;
+
+  void PrintSelf(std::ostream& os, itk::Indent indent) const ITK_OVERRIDE;
+
+private:
+  ConnectedComponentLabelImageFilter(const Self &); //purposely not implemented
+  void operator =(const Self&); //purposely not implemented
+
+  typename LabellingFilterType::ConstPointer m_LabellingFilter;
+};
+
+} // end namespace otb
+
+#ifndef OTB_MANUAL_INSTANTIATION
+#include "otbConnectedComponentLabelImageFilter.txx"
+#endif
+
+#endif
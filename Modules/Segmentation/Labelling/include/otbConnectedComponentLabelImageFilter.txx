@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbConnectedComponentLabelImageFilter_txx
+#define otbConnectedComponentLabelImageFilter_txx
+
+#include "otbConnectedComponentLabelImageFilter.h"
+#include "itkImageRegionIterator.h"
+#include "itkProgressReporter.h"
+
+namespace otb
+{
+
+template <class TInputImage, class TOutputImage>
+ConnectedComponentLabelImageFilter<TInputImage, TOutputImage>
+::ConnectedComponentLabelImageFilter()
+{
+}
+
+template <class TInputImage, class TOutputImage>
+void
+ConnectedComponentLabelImageFilter<TInputImage, TOutputImage>
+::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  InputImageType * input = const_cast<InputImageType *>(this->GetInput());
+  if (!input || m_LabellingFilter.IsNull())
+    {
+    return;
+    }
+
+  input->SetRequestedRegion(m_LabellingFilter->GetBlockAlignedRegion(this->GetOutput()->GetRequestedRegion()));
+}
+
+template <class TInputImage, class TOutputImage>
+void
+ConnectedComponentLabelImageFilter<TInputImage, TOutputImage>
+::BeforeThreadedGenerateData()
+{
+  if (m_LabellingFilter.IsNull())
+    {
+    itkExceptionMacro(<< "The labelling filter is not set.");
+    }
+  if (m_LabellingFilter->GetInput()->GetLargestPossibleRegion() != this->GetInput()->GetLargestPossibleRegion())
+    {
+    itkExceptionMacro(<< "The labelling filter has not processed an image of the same size as the input image.");
+    }
+}
+
+template <class TInputImage, class TOutputImage>
+void
+ConnectedComponentLabelImageFilter<TInputImage, TOutputImage>
+::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread, itk::ThreadIdType threadId)
+{
+  const InputImageType * input = this->GetInput();
+  OutputImageType * output = this->GetOutput();
+
+  itk::ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels());
+
+  // Go through the blocks intersecting the region of this thread
+  const RegionType blocks = m_LabellingFilter->GetBlockAlignedRegion(outputRegionForThread);
+  const typename RegionType::SizeType blockSize = m_LabellingFilter->GetBlockSize();
+
+  std::vector<LabelType> labels;
+  typename RegionType::IndexType index;
+  for (index[1] = blocks.GetIndex()[1];
+       index[1] < static_cast<typename RegionType::IndexValueType>(blocks.GetIndex()[1] + blocks.GetSize()[1]);
+       index[1] += blockSize[1])
+    {
+    for (index[0] = blocks.GetIndex()[0];
+         index[0] < static_cast<typename RegionType::IndexValueType>(blocks.GetIndex()[0] + blocks.GetSize()[0]);
+         index[0] += blockSize[0])
+      {
+      const RegionType block = m_LabellingFilter->GetBlockRegion(index);
+      m_LabellingFilter->ComputeBlockLabels(input, block, labels);
+
+      RegionType region = block;
+      region.Crop(outputRegionForThread);
+
+      itk::ImageRegionIterator<OutputImageType> outIt(output, region);
+      for (outIt.GoToBegin(); !outIt.IsAtEnd(); ++outIt)
+        {
+        const typename RegionType::IndexType pixel = outIt.GetIndex();
+        const itk::SizeValueType pos = (pixel[1] - block.GetIndex()[1]) * block.GetSize()[0]
+          + pixel[0] - block.GetIndex()[0];
+        outIt.Set(static_cast<OutputPixelType>(labels[pos]));
+        progress.CompletedPixel();
+        }
+      }
+    }
+}
+
+template <class TInputImage, class TOutputImage>
+void
+ConnectedComponentLabelImageFilter<TInputImage, TOutputImage>
+::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "Labelling filter: " << m_LabellingFilter.GetPointer() << std::endl;
+}
+
+} // end namespace otb
+
+#endif
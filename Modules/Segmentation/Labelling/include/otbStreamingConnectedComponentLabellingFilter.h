@@ -0,0 +1,380 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbStreamingConnectedComponentLabellingFilter_h
+#define otbStreamingConnectedComponentLabellingFilter_h
+
+#include "otbPersistentImageFilter.h"
+#include "otbPersistentFilterStreamingDecorator.h"
+#include "itkMultiThreader.h"
+#include "itkIntTypes.h"
+#include "itkNumericTraits.h"
+#include "otbMacro.h"
+
+#include <algorithm>
+#include <vector>
+#include <unordered_map>
+
+namespace otb
+{
+
+/** \class PersistentConnectedComponentLabellingFilter
+ * \brief First pass of a streamed connected component labelling.
+ *
+ * The input image is split in a fixed grid of blocks (see \c SetBlockSize()),
+ * independent of the streaming and threading layout. Each block whose first
+ * pixel lies in the requested region is labelled on its own, blocks being
+ * processed in parallel. Components touching the border of their block are
+ * then merged with the components of the neighbour blocks in a global
+ * union-find, while the other components get their final label directly.
+ *
+ * Pixels different from the background value (see \c SetBackgroundValue())
+ * are foreground pixels, and all connected foreground pixels get the same
+ * label, as in \c itk::ConnectedComponentImageFilter. Labels are consecutive,
+ * starting at 1.
+ *
+ * This filter does not produce the label image: once the image has been
+ * streamed and \c Synthetize() called, use \c ConnectedComponentLabelImageFilter
+ * to write it in a second streamed pass. The memory footprint only depends
+ * on the number of components crossing block borders, and on the number of
+ * components if statistics are computed.
+ *
+ * If \c SetComputeStatistics() is on, the area, bounding region and mean
+ * input value of each component are collected while streaming.
+ *
+ * \note Only 2D images are supported.
+ *
+ * \sa StreamingConnectedComponentLabellingFilter
+ * \sa ConnectedComponentLabelImageFilter
+ *
+ * \ingroup Streamed
+ * \ingroup Multithreaded
+ *
+ * \ingroup OTBLabelling
+ */
+template<class TInputImage>
+class ITK_EXPORT PersistentConnectedComponentLabellingFilter :
+  public PersistentImageFilter<TInputImage, TInputImage>
+{
+public:
+  /** Standard Self typedef */
+  typedef PersistentConnectedComponentLabellingFilter     Self;
+  typedef PersistentImageFilter<TInputImage, TInputImage> Superclass;
+  typedef itk::SmartPointer<Self>                         Pointer;
+  typedef itk::SmartPointer<const Self>                   ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(PersistentConnectedComponentLabellingFilter, PersistentImageFilter);
+
+  /** Image related typedefs. */
+  typedef TInputImage                            InputImageType;
+  typedef typename InputImageType::PixelType     InputPixelType;
+  typedef typename InputImageType::RegionType    RegionType;
+  typedef typename InputImageType::SizeType      SizeType;
+  typedef typename InputImageType::IndexType     IndexType;
+
+  itkStaticConstMacro(InputImageDimension, unsigned int,
+                      TInputImage::ImageDimension);
+
+  typedef itk::SizeValueType                     LabelType;
+
+  /** Set/Get the background value (default is 0) */
+  itkSetMacro(BackgroundValue, InputPixelType);
+  itkGetConstMacro(BackgroundValue, InputPixelType);
+
+  /** Set/Get the 8-connected neighborhood option (default is false) */
+  itkSetMacro(FullyConnected, bool);
+  itkGetConstMacro(FullyConnected, bool);
+  itkBooleanMacro(FullyConnected);
+
+  /** Set/Get the size of the labelling blocks (default is 256x256).
+   * Blocks are labelled as a whole, so the streamed pieces should be larger
+   * than the blocks. */
+  itkSetMacro(BlockSize, SizeType);
+  itkGetConstMacro(BlockSize, SizeType);
+
+  /** Set/Get the statistics computation option (default is false) */
+  itkSetMacro(ComputeStatistics, bool);
+  itkGetConstMacro(ComputeStatistics, bool);
+  itkBooleanMacro(ComputeStatistics);
+
+  /** Get the number of components. Valid after Synthetize(). */
+  itkGetConstMacro(NumberOfComponents, LabelType);
+
+  /** Statistics of a component. Valid after Synthetize(), and only if
+   * \c ComputeStatistics is on. */
+  itk::SizeValueType GetComponentArea(LabelType label) const;
+  RegionType GetComponentBoundingRegion(LabelType label) const;
+  double GetComponentMean(LabelType label) const;
+
+  /** Compute the final labels of a block of the input image. The block must
+   * be one of the blocks of the labelling grid, see \c GetBlockRegion().
+   * Valid after Synthetize(). This method is thread safe. */
+  void ComputeBlockLabels(const InputImageType * image, const RegionType & block,
+                          std::vector<LabelType> & labels) const;
+
+  /** Get the smallest region made of whole blocks containing the given region */
+  RegionType GetBlockAlignedRegion(const RegionType & region) const;
+
+  /** Get the region of a block of the labelling grid, from any of its pixels */
+  RegionType GetBlockRegion(const IndexType & index) const;
+
+  void AllocateOutputs() ITK_OVERRIDE;
+
+  void GenerateOutputInformation() ITK_OVERRIDE;
+
+  void Synthetize(void) ITK_OVERRIDE;
+
+  void Reset(void) ITK_OVERRIDE;
+
+protected:
+  PersistentConnectedComponentLabellingFilter();
+  ~PersistentConnectedComponentLabellingFilter() ITK_OVERRIDE {}
+  void PrintSelf(std::ostream& os, itk::Indent indent) const ITK_OVERRIDE;
+
+  /** Request the blocks whose first pixel lies in the output requested region */
+  void GenerateInputRequestedRegion() ITK_OVERRIDE;
+
+  void GenerateData() ITK_OVERRIDE;
+
+private:
+  PersistentConnectedComponentLabellingFilter(const Self &); //purposely not implemented
+  void operator =(const Self&); //purposely not implemented
+
+  /** Components of neighbour blocks are identified by the block number
+   * and their label inside the block. */
+  typedef itk::uint64_t                             KeyType;
+
+  struct ComponentStatistics
+  {
+    ComponentStatistics() : Area(0), Sum(0.)
+    {
+      Min.Fill(itk::NumericTraits<typename IndexType::IndexValueType>::max());
+      Max.Fill(itk::NumericTraits<typename IndexType::IndexValueType>::NonpositiveMin());
+    }
+    void Merge(const ComponentStatistics & other)
+    {
+      Area += other.Area;
+      Sum += other.Sum;
+      for (unsigned int d = 0; d < InputImageDimension; ++d)
+        {
+        Min[d] = std::min(Min[d], other.Min[d]);
+        Max[d] = std::max(Max[d], other.Max[d]);
+        }
+    }
+
+    itk::SizeValueType Area;
+    double             Sum;
+    IndexType          Min;
+    IndexType          Max;
+  };
+  typedef std::vector<ComponentStatistics>          StatisticsVectorType;
+
+  /** Labels along the four sides of a block, waiting for its neighbours */
+  struct BlockBorders
+  {
+    std::vector<LabelType> Top;
+    std::vector<LabelType> Bottom;
+    std::vector<LabelType> Left;
+    std::vector<LabelType> Right;
+    unsigned int           RemainingNeighbours;
+  };
+
+  /** Result of the labelling of a block */
+  struct BlockResult
+  {
+    itk::SizeValueType   Id;
+    RegionType           Region;
+    LabelType            NumberOfComponents;
+    std::vector<bool>    OnBorder;
+    BlockBorders         Borders;
+    StatisticsVectorType Statistics;
+  };
+
+  /** Label a block on its own, labels being consecutive in raster order */
+  LabelType LabelBlock(const InputImageType * image, const RegionType & block,
+                       std::vector<LabelType> & labels) const;
+
+  /** Flag the components touching the sides of a block */
+  static void ComputeOnBorder(const std::vector<LabelType> & labels, const SizeType & size,
+                              LabelType nbComponents, std::vector<bool> & onBorder);
+
+  void ProcessBlock(BlockResult & block) const;
+
+  /** Record the equivalences with the neighbour blocks already processed */
+  void MergeBlock(BlockResult & block);
+
+  void MergeSide(itk::SizeValueType id1, const std::vector<LabelType> & side1,
+                 itk::SizeValueType id2, const std::vector<LabelType> & side2);
+
+  itk::SizeValueType GetBlockId(const IndexType & index) const;
+  KeyType MakeKey(itk::SizeValueType blockId, LabelType label) const;
+  KeyType FindRoot(KeyType key);
+  void Union(KeyType key1, KeyType key2);
+
+  /** Static function used as a "callback" by the MultiThreader. */
+  static ITK_THREAD_RETURN_TYPE ThreaderCallback(void *arg);
+
+  /** Internal structure used for passing data into the threading library */
+  struct ThreadStruct
+  {
+    Pointer Filter;
+  };
+
+  InputPixelType m_BackgroundValue;
+  bool           m_FullyConnected;
+  SizeType       m_BlockSize;
+  bool           m_ComputeStatistics;
+  LabelType      m_NumberOfComponents;
+
+  /** Number of blocks along each dimension */
+  SizeType       m_GridSize;
+
+  /** Blocks of the current streamed piece */
+  std::vector<BlockResult> m_CurrentBlocks;
+
+  /** Equivalences between components crossing block borders */
+  std::unordered_map<KeyType, KeyType>           m_Parents;
+  std::unordered_map<itk::SizeValueType, BlockBorders> m_PendingBorders;
+  std::unordered_map<KeyType, ComponentStatistics> m_BorderStatistics;
+
+  /** Number and statistics of the components inside each block */
+  std::vector<LabelType>             m_InnerCounts;
+  std::vector<StatisticsVectorType>  m_InnerStatistics;
+
+  /** Results of the synthesis */
+  std::unordered_map<KeyType, LabelType> m_BorderLabels;
+  std::vector<LabelType>                 m_InnerOffsets;
+  StatisticsVectorType                   m_Statistics;
+};
+
+/** \class StreamingConnectedComponentLabellingFilter
+ * \brief Streamed first pass of the connected component labelling.
+ *
+ * This filter streams the whole input image through the
+ * \c PersistentConnectedComponentLabellingFilter, to resolve the labels of
+ * the connected components and optionally compute their statistics.
+ *
+ * The label image is then produced in a second streamed pass:
+ * \code
+ * typedef otb::StreamingConnectedComponentLabellingFilter<MaskType> LabellingType;
+ * typedef otb::ConnectedComponentLabelImageFilter<MaskType, LabelImageType> LabelFilterType;
+ * LabellingType::Pointer labelling = LabellingType::New();
+ * labelling->SetInput(reader->GetOutput());
+ * labelling->Update();
+ * LabelFilterType::Pointer labelFilter = LabelFilterType::New();
+ * labelFilter->SetInput(reader->GetOutput());
+ * labelFilter->SetLabellingFilter(labelling->GetFilter());
+ * writer->SetInput(labelFilter->GetOutput());
+ * writer->Update();
+ * \endcode
+ *
+ * \sa PersistentConnectedComponentLabellingFilter
+ * \sa ConnectedComponentLabelImageFilter
+ *
+ * \ingroup Streamed
+ * \ingroup Multithreaded
+ *
+ * \ingroup OTBLabelling
+ */
+template<class TInputImage>
+class ITK_EXPORT StreamingConnectedComponentLabellingFilter :
+  public PersistentFilterStreamingDecorator<PersistentConnectedComponentLabellingFilter<TInputImage> >
+{
+public:
+  /** Standard Self typedef */
+  typedef StreamingConnectedComponentLabellingFilter Self;
+  typedef PersistentFilterStreamingDecorator
+  <PersistentConnectedComponentLabellingFilter<TInputImage> > Superclass;
+  typedef itk::SmartPointer<Self>       Pointer;
+  typedef itk::SmartPointer<const Self> ConstPointer;
+
+  /** Type macro */
+  itkNewMacro(Self);
+
+  /** Creation through object factory macro */
+  itkTypeMacro(StreamingConnectedComponentLabellingFilter, PersistentFilterStreamingDecorator);
+
+  typedef TInputImage                                  InputImageType;
+  typedef typename Superclass::FilterType::LabelType   LabelType;
+  typedef typename Superclass::FilterType::RegionType  RegionType;
+  typedef typename Superclass::FilterType::SizeType    SizeType;
+  typedef typename InputImageType::PixelType           InputPixelType;
+
+  using Superclass::SetInput;
+  void SetInput(const InputImageType * input)
+  {
+    this->GetFilter()->SetInput(input);
+  }
+  const InputImageType * GetInput()
+  {
+    return this->GetFilter()->GetInput();
+  }
+
+  otbSetObjectMemberMacro(Filter, BackgroundValue, InputPixelType);
+  otbGetObjectMemberMacro(Filter, BackgroundValue, InputPixelType);
+  otbSetObjectMemberMacro(Filter, FullyConnected, bool);
+  otbGetObjectMemberMacro(Filter, FullyConnected, bool);
+  otbSetObjectMemberMacro(Filter, BlockSize, SizeType);
+  otbGetObjectMemberMacro(Filter, BlockSize, SizeType);
+  otbSetObjectMemberMacro(Filter, ComputeStatistics, bool);
+  otbGetObjectMemberMacro(Filter, ComputeStatistics, bool);
+
+  LabelType GetNumberOfComponents() const
+  {
+    return this->GetFilter()->GetNumberOfComponents();
+  }
+
+  itk::SizeValueType GetComponentArea(LabelType label) const
+  {
+    return this->GetFilter()->GetComponentArea(label);
+  }
+
+  RegionType GetComponentBoundingRegion(LabelType label) const
+  {
+    return this->GetFilter()->GetComponentBoundingRegion(label);
+  }
+
+  double GetComponentMean(LabelType label) const
+  {
+    return this->GetFilter()->GetComponentMean(label);
+  }
+
+protected:
+  /** Constructor */
+  StreamingConnectedComponentLabellingFilter() {}
+  /** Destructor */
+  ~StreamingConnectedComponentLabellingFilter() ITK_OVERRIDE {}
+
+private:
+  StreamingConnectedComponentLabellingFilter(const Self &); //purposely not implemented
+  void operator =(const Self&); //purposely not implemented
+};
+
+} // end namespace otb
+
+#ifndef OTB_MANUAL_INSTANTIATION
+#include "otbStreamingConnectedComponentLabellingFilter.txx"
+#endif
+
+#endif
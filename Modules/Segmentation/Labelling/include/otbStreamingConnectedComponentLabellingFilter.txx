@@ -0,0 +1,772 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbStreamingConnectedComponentLabellingFilter_txx
+#define otbStreamingConnectedComponentLabellingFilter_txx
+
+#include "otbStreamingConnectedComponentLabellingFilter.h"
+
+#include "itkImageRegionConstIterator.h"
+
+#include <algorithm>
+
+namespace otb
+{
+
+template<class TInputImage>
+PersistentConnectedComponentLabellingFilter<TInputImage>
+::PersistentConnectedComponentLabellingFilter()
+  : m_BackgroundValue(itk::NumericTraits<InputPixelType>::Zero),
+    m_FullyConnected(false),
+    m_ComputeStatistics(false),
+    m_NumberOfComponents(0)
+{
+  m_BlockSize.Fill(256);
+  m_GridSize.Fill(0);
+}
+
+template<class TInputImage>
+void
+PersistentConnectedComponentLabellingFilter<TInputImage>
+::GenerateOutputInformation()
+{
+  Superclass::GenerateOutputInformation();
+
+  if (this->GetInput())
+    {
+    this->GetOutput()->CopyInformation(this->GetInput());
+    this->GetOutput()->SetLargestPossibleRegion(this->GetInput()->GetLargestPossibleRegion());
+
+    if (this->GetOutput()->GetRequestedRegion().GetNumberOfPixels() == 0)
+      {
+      this->GetOutput()->SetRequestedRegion(this->GetOutput()->GetLargestPossibleRegion());
+      }
+
+    const SizeType largestSize = this->GetInput()->GetLargestPossibleRegion().GetSize();
+    for (unsigned int d = 0; d < InputImageDimension; ++d)
+      {
+      m_GridSize[d] = (largestSize[d] + m_BlockSize[d] - 1) / m_BlockSize[d];
+      }
+    }
+}
+
+template<class TInputImage>
+void
+PersistentConnectedComponentLabellingFilter<TInputImage>
+::AllocateOutputs()
+{
+  // The output image of this filter is not intended to be used.
+  // Nothing that needs to be allocated for the remaining outputs
+}
+
+template<class TInputImage>
+typename PersistentConnectedComponentLabellingFilter<TInputImage>::RegionType
+PersistentConnectedComponentLabellingFilter<TInputImage>
+::GetBlockRegion(const IndexType & index) const
+{
+  const RegionType & largest = this->GetInput()->GetLargestPossibleRegion();
+
+  RegionType block;
+  for (unsigned int d = 0; d < InputImageDimension; ++d)
+    {
+    const itk::SizeValueType blockIndex = (index[d] - largest.GetIndex()[d]) / m_BlockSize[d];
+    block.SetIndex(d, largest.GetIndex()[d] + blockIndex * m_BlockSize[d]);
+    block.SetSize(d, std::min(m_BlockSize[d], largest.GetSize()[d] - blockIndex * m_BlockSize[d]));
+    }
+  return block;
+}
+
+template<class TInputImage>
+typename PersistentConnectedComponentLabellingFilter<TInputImage>::RegionType
+PersistentConnectedComponentLabellingFilter<TInputImage>
+::GetBlockAlignedRegion(const RegionType & region) const
+{
+  IndexType last;
+  for (unsigned int d = 0; d < InputImageDimension; ++d)
+    {
+    last[d] = region.GetIndex()[d] + region.GetSize()[d] - 1;
+    }
+
+  const RegionType firstBlock = this->GetBlockRegion(region.GetIndex());
+  const RegionType lastBlock = this->GetBlockRegion(last);
+
+  RegionType aligned;
+  for (unsigned int d = 0; d < InputImageDimension; ++d)
+    {
+    aligned.SetIndex(d, firstBlock.GetIndex()[d]);
+    aligned.SetSize(d, lastBlock.GetIndex()[d] + lastBlock.GetSize()[d] - firstBlock.GetIndex()[d]);
+    }
+  return aligned;
+}
+
+template<class TInputImage>
+itk::SizeValueType
+PersistentConnectedComponentLabellingFilter<TInputImage>
+::GetBlockId(const IndexType & index) const
+{
+  const IndexType & origin = this->GetInput()->GetLargestPossibleRegion().GetIndex();
+  return ((index[1] - origin[1]) / m_BlockSize[1]) * m_GridSize[0]
+    + (index[0] - origin[0]) / m_BlockSize[0];
+}
+
+template<class TInputImage>
+typename PersistentConnectedComponentLabellingFilter<TInputImage>::KeyType
+PersistentConnectedComponentLabellingFilter<TInputImage>
+::MakeKey(itk::SizeValueType blockId, LabelType label) const
+{
+  return (static_cast<KeyType>(blockId) << 32) | static_cast<KeyType>(label);
+}
+
+template<class TInputImage>
+void
+PersistentConnectedComponentLabellingFilter<TInputImage>
+::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  InputImageType * input = const_cast<InputImageType *>(this->GetInput());
+  if (!input)
+    {
+    return;
+    }
+
+  const RegionType & requested = this->GetOutput()->GetRequestedRegion();
+  const RegionType & largest = input->GetLargestPossibleRegion();
+
+  // Blocks are processed by the piece containing their first pixel
+  RegionType blocks;
+  for (unsigned int d = 0; d < InputImageDimension; ++d)
+    {
+    const itk::SizeValueType offset = requested.GetIndex()[d] - largest.GetIndex()[d];
+    const itk::SizeValueType first = (offset + m_BlockSize[d] - 1) / m_BlockSize[d];
+    const itk::SizeValueType last = (offset + requested.GetSize()[d] - 1) / m_BlockSize[d];
+    if (last < first)
+      {
+      // No block starts in this piece, only request it to keep the pipeline happy
+      return;
+      }
+    const itk::SizeValueType end = std::min((last + 1) * m_BlockSize[d], largest.GetSize()[d]);
+    blocks.SetIndex(d, largest.GetIndex()[d] + first * m_BlockSize[d]);
+    blocks.SetSize(d, end - first * m_BlockSize[d]);
+    }
+  input->SetRequestedRegion(blocks);
+}
+
+template<class TInputImage>
+void
+PersistentConnectedComponentLabellingFilter<TInputImage>
+::Reset()
+{
+  m_NumberOfComponents = 0;
+  m_CurrentBlocks.clear();
+  m_Parents.clear();
+  m_PendingBorders.clear();
+  m_BorderStatistics.clear();
+  m_InnerCounts.clear();
+  m_InnerStatistics.clear();
+  m_BorderLabels.clear();
+  m_InnerOffsets.clear();
+  m_Statistics.clear();
+}
+
+template<class TInputImage>
+typename PersistentConnectedComponentLabellingFilter<TInputImage>::LabelType
+PersistentConnectedComponentLabellingFilter<TInputImage>
+::LabelBlock(const InputImageType * image, const RegionType & block,
+             std::vector<LabelType> & labels) const
+{
+  const itk::SizeValueType width = block.GetSize()[0];
+  const itk::SizeValueType height = block.GetSize()[1];
+  labels.assign(width * height, 0);
+
+  // Provisional labels, equivalent labels pointing to the smallest one
+  std::vector<LabelType> parents(1, 0);
+
+  itk::ImageRegionConstIterator<InputImageType> it(image, block);
+  it.GoToBegin();
+  for (itk::SizeValueType y = 0; y < height; ++y)
+    {
+    for (itk::SizeValueType x = 0; x < width; ++x, ++it)
+      {
+      if (it.Get() == m_BackgroundValue)
+        {
+        continue;
+        }
+
+      const itk::SizeValueType pos = y * width + x;
+      itk::SizeValueType neighbours[4];
+      unsigned int nbNeighbours = 0;
+      if (x > 0)
+        {
+        neighbours[nbNeighbours++] = pos - 1;
+        }
+      if (y > 0)
+        {
+        neighbours[nbNeighbours++] = pos - width;
+        if (m_FullyConnected)
+          {
+          if (x > 0)
+            {
+            neighbours[nbNeighbours++] = pos - width - 1;
+            }
+          if (x + 1 < width)
+            {
+            neighbours[nbNeighbours++] = pos - width + 1;
+            }
+          }
+        }
+
+      LabelType label = 0;
+      for (unsigned int n = 0; n < nbNeighbours; ++n)
+        {
+        LabelType root = labels[neighbours[n]];
+        if (root == 0)
+          {
+          continue;
+          }
+        while (parents[root] != root)
+          {
+          parents[root] = parents[parents[root]];
+          root = parents[root];
+          }
+        if (label == 0)
+          {
+          label = root;
+          }
+        else if (root != label)
+          {
+          parents[std::max(root, label)] = std::min(root, label);
+          label = std::min(root, label);
+          }
+        }
+
+      if (label == 0)
+        {
+        label = parents.size();
+        parents.push_back(label);
+        }
+      labels[pos] = label;
+      }
+    }
+
+  // Consecutive labels, in the order of their first pixel
+  std::vector<LabelType> consecutive(parents.size(), 0);
+  LabelType nbComponents = 0;
+  for (typename std::vector<LabelType>::iterator lit = labels.begin(); lit != labels.end(); ++lit)
+    {
+    if (*lit == 0)
+      {
+      continue;
+      }
+    LabelType root = *lit;
+    while (parents[root] != root)
+      {
+      root = parents[root];
+      }
+    if (consecutive[root] == 0)
+      {
+      consecutive[root] = ++nbComponents;
+      }
+    *lit = consecutive[root];
+    }
+
+  return nbComponents;
+}
+
+template<class TInputImage>
+void
+PersistentConnectedComponentLabellingFilter<TInputImage>
+::ComputeOnBorder(const std::vector<LabelType> & labels, const SizeType & size,
+                  LabelType nbComponents, std::vector<bool> & onBorder)
+{
+  const itk::SizeValueType width = size[0];
+  const itk::SizeValueType height = size[1];
+
+  onBorder.assign(nbComponents + 1, false);
+  for (itk::SizeValueType x = 0; x < width; ++x)
+    {
+    onBorder[labels[x]] = true;
+    onBorder[labels[(height - 1) * width + x]] = true;
+    }
+  for (itk::SizeValueType y = 0; y < height; ++y)
+    {
+    onBorder[labels[y * width]] = true;
+    onBorder[labels[y * width + width - 1]] = true;
+    }
+  onBorder[0] = false;
+}
+
+template<class TInputImage>
+void
+PersistentConnectedComponentLabellingFilter<TInputImage>
+::ProcessBlock(BlockResult & block) const
+{
+  const InputImageType * input = this->GetInput();
+
+  std::vector<LabelType> labels;
+  block.NumberOfComponents = this->LabelBlock(input, block.Region, labels);
+
+  const SizeType size = block.Region.GetSize();
+  ComputeOnBorder(labels, size, block.NumberOfComponents, block.OnBorder);
+
+  block.Borders.Top.assign(labels.begin(), labels.begin() + size[0]);
+  block.Borders.Bottom.assign(labels.end() - size[0], labels.end());
+  block.Borders.Left.resize(size[1]);
+  block.Borders.Right.resize(size[1]);
+  for (itk::SizeValueType y = 0; y < size[1]; ++y)
+    {
+    block.Borders.Left[y] = labels[y * size[0]];
+    block.Borders.Right[y] = labels[y * size[0] + size[0] - 1];
+    }
+
+  if (m_ComputeStatistics)
+    {
+    block.Statistics.assign(block.NumberOfComponents + 1, ComponentStatistics());
+
+    itk::ImageRegionConstIterator<InputImageType> it(input, block.Region);
+    typename std::vector<LabelType>::const_iterator lit = labels.begin();
+    for (it.GoToBegin(); !it.IsAtEnd(); ++it, ++lit)
+      {
+      if (*lit == 0)
+        {
+        continue;
+        }
+      ComponentStatistics & stats = block.Statistics[*lit];
+      const IndexType index = it.GetIndex();
+      stats.Area++;
+      stats.Sum += static_cast<double>(it.Get());
+      for (unsigned int d = 0; d < InputImageDimension; ++d)
+        {
+        stats.Min[d] = std::min(stats.Min[d], index[d]);
+        stats.Max[d] = std::max(stats.Max[d], index[d]);
+        }
+      }
+    }
+}
+
+template<class TInputImage>
+typename PersistentConnectedComponentLabellingFilter<TInputImage>::KeyType
+PersistentConnectedComponentLabellingFilter<TInputImage>
+::FindRoot(KeyType key)
+{
+  KeyType parent = m_Parents[key];
+  while (parent != key)
+    {
+    const KeyType grandParent = m_Parents[parent];
+    m_Parents[key] = grandParent;
+    key = parent;
+    parent = grandParent;
+    }
+  return key;
+}
+
+template<class TInputImage>
+void
+PersistentConnectedComponentLabellingFilter<TInputImage>
+::Union(KeyType key1, KeyType key2)
+{
+  const KeyType root1 = this->FindRoot(key1);
+  const KeyType root2 = this->FindRoot(key2);
+  if (root1 != root2)
+    {
+    m_Parents[std::max(root1, root2)] = std::min(root1, root2);
+    }
+}
+
+template<class TInputImage>
+void
+PersistentConnectedComponentLabellingFilter<TInputImage>
+::MergeSide(itk::SizeValueType id1, const std::vector<LabelType> & side1,
+            itk::SizeValueType id2, const std::vector<LabelType> & side2)
+{
+  const itk::SizeValueType length = side1.size();
+  for (itk::SizeValueType i = 0; i < length; ++i)
+    {
+    if (side1[i] == 0)
+      {
+      continue;
+      }
+    const KeyType key1 = this->MakeKey(id1, side1[i]);
+    const itk::SizeValueType begin = (m_FullyConnected && i > 0) ? i - 1 : i;
+    const itk::SizeValueType end = (m_FullyConnected && i + 1 < length) ? i + 1 : i;
+    for (itk::SizeValueType j = begin; j <= end; ++j)
+      {
+      if (side2[j] != 0)
+        {
+        this->Union(key1, this->MakeKey(id2, side2[j]));
+        }
+      }
+    }
+}
+
+template<class TInputImage>
+void
+PersistentConnectedComponentLabellingFilter<TInputImage>
+::MergeBlock(BlockResult & block)
+{
+  const itk::SizeValueType id = block.Id;
+  const itk::SizeValueType bx = id % m_GridSize[0];
+  const itk::SizeValueType by = id / m_GridSize[0];
+
+  // Components inside the block get their final label directly
+  LabelType nbInner = 0;
+  StatisticsVectorType innerStatistics;
+  for (LabelType label = 1; label <= block.NumberOfComponents; ++label)
+    {
+    if (block.OnBorder[label])
+      {
+      const KeyType key = this->MakeKey(id, label);
+      m_Parents[key] = key;
+      if (m_ComputeStatistics)
+        {
+        m_BorderStatistics[key] = block.Statistics[label];
+        }
+      }
+    else
+      {
+      ++nbInner;
+      if (m_ComputeStatistics)
+        {
+        innerStatistics.push_back(block.Statistics[label]);
+        }
+      }
+    }
+  m_InnerCounts[id] = nbInner;
+  if (m_ComputeStatistics)
+    {
+    m_InnerStatistics[id].swap(innerStatistics);
+    }
+
+  // Merge with the neighbour blocks already processed
+  block.Borders.RemainingNeighbours = 0;
+  for (int dy = -1; dy <= 1; ++dy)
+    {
+    for (int dx = -1; dx <= 1; ++dx)
+      {
+      if ((dx == 0 && dy == 0) || (!m_FullyConnected && dx != 0 && dy != 0))
+        {
+        continue;
+        }
+      if ((dx < 0 && bx == 0) || (dx > 0 && bx + 1 >= m_GridSize[0])
+          || (dy < 0 && by == 0) || (dy > 0 && by + 1 >= m_GridSize[1]))
+        {
+        continue;
+        }
+
+      const itk::SizeValueType neighbourId = (by + dy) * m_GridSize[0] + bx + dx;
+      typename std::unordered_map<itk::SizeValueType, BlockBorders>::iterator neighbourIt
+        = m_PendingBorders.find(neighbourId);
+      if (neighbourIt == m_PendingBorders.end())
+        {
+        block.Borders.RemainingNeighbours++;
+        continue;
+        }
+
+      BlockBorders & neighbour = neighbourIt->second;
+      if (dy == 0)
+        {
+        if (dx < 0)
+          {
+          this->MergeSide(neighbourId, neighbour.Right, id, block.Borders.Left);
+          }
+        else
+          {
+          this->MergeSide(id, block.Borders.Right, neighbourId, neighbour.Left);
+          }
+        }
+      else if (dx == 0)
+        {
+        if (dy < 0)
+          {
+          this->MergeSide(neighbourId, neighbour.Bottom, id, block.Borders.Top);
+          }
+        else
+          {
+          this->MergeSide(id, block.Borders.Bottom, neighbourId, neighbour.Top);
+          }
+        }
+      else
+        {
+        // Diagonal neighbours only share a corner
+        const LabelType cornerLabel = dy < 0
+          ? (dx < 0 ? block.Borders.Top.front() : block.Borders.Top.back())
+          : (dx < 0 ? block.Borders.Bottom.front() : block.Borders.Bottom.back());
+        const LabelType neighbourLabel = dy < 0
+          ? (dx < 0 ? neighbour.Bottom.back() : neighbour.Bottom.front())
+          : (dx < 0 ? neighbour.Top.back() : neighbour.Top.front());
+        if (cornerLabel != 0 && neighbourLabel != 0)
+          {
+          this->Union(this->MakeKey(id, cornerLabel), this->MakeKey(neighbourId, neighbourLabel));
+          }
+        }
+
+      if (--neighbour.RemainingNeighbours == 0)
+        {
+        m_PendingBorders.erase(neighbourIt);
+        }
+      }
+    }
+
+  if (block.Borders.RemainingNeighbours > 0)
+    {
+    m_PendingBorders[id] = block.Borders;
+    }
+}
+
+template<class TInputImage>
+ITK_THREAD_RETURN_TYPE
+PersistentConnectedComponentLabellingFilter<TInputImage>
+::ThreaderCallback(void *arg)
+{
+  ThreadStruct *str;
+  int           threadId, threadCount;
+
+  threadId = ((itk::MultiThreader::ThreadInfoStruct *) (arg))->ThreadID;
+  threadCount = ((itk::MultiThreader::ThreadInfoStruct *) (arg))->NumberOfThreads;
+  str = (ThreadStruct *) (((itk::MultiThreader::ThreadInfoStruct *) (arg))->UserData);
+
+  const unsigned int nbBlocks = str->Filter->m_CurrentBlocks.size();
+  for (unsigned int b = threadId; b < nbBlocks; b += threadCount)
+    {
+    str->Filter->ProcessBlock(str->Filter->m_CurrentBlocks[b]);
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template<class TInputImage>
+void
+PersistentConnectedComponentLabellingFilter<TInputImage>
+::GenerateData()
+{
+  const InputImageType * input = this->GetInput();
+  const RegionType & requested = this->GetOutput()->GetRequestedRegion();
+  const RegionType & largest = input->GetLargestPossibleRegion();
+
+  const itk::SizeValueType nbBlocks = m_GridSize[0] * m_GridSize[1];
+  if (m_InnerCounts.size() != nbBlocks)
+    {
+    m_InnerCounts.assign(nbBlocks, 0);
+    m_InnerStatistics.assign(m_ComputeStatistics ? nbBlocks : 0, StatisticsVectorType());
+    }
+
+  // Blocks whose first pixel lies in the requested region
+  m_CurrentBlocks.clear();
+  IndexType first;
+  IndexType end;
+  for (unsigned int d = 0; d < InputImageDimension; ++d)
+    {
+    const itk::SizeValueType offset = requested.GetIndex()[d] - largest.GetIndex()[d];
+    first[d] = largest.GetIndex()[d] + ((offset + m_BlockSize[d] - 1) / m_BlockSize[d]) * m_BlockSize[d];
+    end[d] = requested.GetIndex()[d] + requested.GetSize()[d];
+    }
+
+  IndexType index;
+  for (index[1] = first[1]; index[1] < end[1]; index[1] += m_BlockSize[1])
+    {
+    for (index[0] = first[0]; index[0] < end[0]; index[0] += m_BlockSize[0])
+      {
+      BlockResult block;
+      block.Id = this->GetBlockId(index);
+      block.Region = this->GetBlockRegion(index);
+      block.NumberOfComponents = 0;
+      m_CurrentBlocks.push_back(block);
+      }
+    }
+
+  // Label the blocks in parallel
+  ThreadStruct str;
+  str.Filter = this;
+
+  this->GetMultiThreader()->SetNumberOfThreads(this->GetNumberOfThreads());
+  this->GetMultiThreader()->SetSingleMethod(this->ThreaderCallback, &str);
+  this->GetMultiThreader()->SingleMethodExecute();
+
+  // Record the equivalences between blocks
+  for (typename std::vector<BlockResult>::iterator it = m_CurrentBlocks.begin(); it != m_CurrentBlocks.end(); ++it)
+    {
+    this->MergeBlock(*it);
+    }
+  m_CurrentBlocks.clear();
+}
+
+template<class TInputImage>
+void
+PersistentConnectedComponentLabellingFilter<TInputImage>
+::Synthetize()
+{
+  if (!m_PendingBorders.empty())
+    {
+    itkWarningMacro(<< m_PendingBorders.size() << " blocks are waiting for neighbours which have not been processed. "
+                    << "The whole image should be streamed through the filter.");
+    }
+  m_PendingBorders.clear();
+
+  // Components crossing block borders are numbered first, in the order of their roots
+  std::vector<KeyType> roots;
+  for (typename std::unordered_map<KeyType, KeyType>::iterator it = m_Parents.begin(); it != m_Parents.end(); ++it)
+    {
+    if (it->first == it->second)
+      {
+      roots.push_back(it->first);
+      }
+    }
+  std::sort(roots.begin(), roots.end());
+
+  std::unordered_map<KeyType, LabelType> rootLabels;
+  for (LabelType i = 0; i < roots.size(); ++i)
+    {
+    rootLabels[roots[i]] = i + 1;
+    }
+
+  m_BorderLabels.clear();
+  for (typename std::unordered_map<KeyType, KeyType>::iterator it = m_Parents.begin(); it != m_Parents.end(); ++it)
+    {
+    m_BorderLabels[it->first] = rootLabels[this->FindRoot(it->first)];
+    }
+
+  // Then components inside the blocks, block after block
+  m_InnerOffsets.assign(m_InnerCounts.size(), 0);
+  LabelType offset = roots.size();
+  for (itk::SizeValueType b = 0; b < m_InnerCounts.size(); ++b)
+    {
+    m_InnerOffsets[b] = offset;
+    offset += m_InnerCounts[b];
+    }
+  m_NumberOfComponents = offset;
+
+  m_Statistics.clear();
+  if (m_ComputeStatistics)
+    {
+    m_Statistics.assign(m_NumberOfComponents + 1, ComponentStatistics());
+    for (typename std::unordered_map<KeyType, ComponentStatistics>::const_iterator it = m_BorderStatistics.begin();
+         it != m_BorderStatistics.end(); ++it)
+      {
+      m_Statistics[m_BorderLabels[it->first]].Merge(it->second);
+      }
+    for (itk::SizeValueType b = 0; b < m_InnerStatistics.size(); ++b)
+      {
+      for (LabelType i = 0; i < m_InnerStatistics[b].size(); ++i)
+        {
+        m_Statistics[m_InnerOffsets[b] + i + 1] = m_InnerStatistics[b][i];
+        }
+      }
+    }
+
+  m_Parents.clear();
+  m_BorderStatistics.clear();
+  m_InnerStatistics.clear();
+}
+
+template<class TInputImage>
+void
+PersistentConnectedComponentLabellingFilter<TInputImage>
+::ComputeBlockLabels(const InputImageType * image, const RegionType & block,
+                     std::vector<LabelType> & labels) const
+{
+  const LabelType nbComponents = this->LabelBlock(image, block, labels);
+
+  std::vector<bool> onBorder;
+  ComputeOnBorder(labels, block.GetSize(), nbComponents, onBorder);
+
+  const itk::SizeValueType id = this->GetBlockId(block.GetIndex());
+  std::vector<LabelType> finalLabels(nbComponents + 1, 0);
+  LabelType innerLabel = id < m_InnerOffsets.size() ? m_InnerOffsets[id] : 0;
+  for (LabelType label = 1; label <= nbComponents; ++label)
+    {
+    if (onBorder[label])
+      {
+      typename std::unordered_map<KeyType, LabelType>::const_iterator it
+        = m_BorderLabels.find(this->MakeKey(id, label));
+      if (it != m_BorderLabels.end())
+        {
+        finalLabels[label] = it->second;
+        }
+      }
+    else
+      {
+      finalLabels[label] = ++innerLabel;
+      }
+    }
+
+  for (typename std::vector<LabelType>::iterator it = labels.begin(); it != labels.end(); ++it)
+    {
+    *it = finalLabels[*it];
+    }
+}
+
+template<class TInputImage>
+itk::SizeValueType
+PersistentConnectedComponentLabellingFilter<TInputImage>
+::GetComponentArea(LabelType label) const
+{
+  if (label == 0 || label >= m_Statistics.size())
+    {
+    itkExceptionMacro(<< "No statistics available for label " << label << ".");
+    }
+  return m_Statistics[label].Area;
+}
+
+template<class TInputImage>
+typename PersistentConnectedComponentLabellingFilter<TInputImage>::RegionType
+PersistentConnectedComponentLabellingFilter<TInputImage>
+::GetComponentBoundingRegion(LabelType label) const
+{
+  if (label == 0 || label >= m_Statistics.size())
+    {
+    itkExceptionMacro(<< "No statistics available for label " << label << ".");
+    }
+  RegionType region;
+  region.SetIndex(m_Statistics[label].Min);
+  for (unsigned int d = 0; d < InputImageDimension; ++d)
+    {
+    region.SetSize(d, m_Statistics[label].Max[d] - m_Statistics[label].Min[d] + 1);
+    }
+  return region;
+}
+
+template<class TInputImage>
+double
+PersistentConnectedComponentLabellingFilter<TInputImage>
+::GetComponentMean(LabelType label) const
+{
+  if (label == 0 || label >= m_Statistics.size())
+    {
+    itkExceptionMacro(<< "No statistics available for label " << label << ".");
+    }
+  return m_Statistics[label].Sum / static_cast<double>(m_Statistics[label].Area);
+}
+
+template<class TInputImage>
+void
+PersistentConnectedComponentLabellingFilter<TInputImage>
+::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "Background value: " << static_cast<typename itk::NumericTraits<InputPixelType>::PrintType>(m_BackgroundValue) << std::endl;
+  os << indent << "Fully connected: " << m_FullyConnected << std::endl;
+  os << indent << "Block size: " << m_BlockSize << std::endl;
+  os << indent << "Compute statistics: " << m_ComputeStatistics << std::endl;
+  os << indent << "Number of components: " << m_NumberOfComponents << std::endl;
+}
+
+} // end namespace otb
+#endif
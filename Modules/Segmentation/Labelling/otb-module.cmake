@@ -31,6 +31,7 @@ otb_module(OTBLabelling
     OTBITK
     OTBImageManipulation
     OTBPointSet
+    OTBStreaming
 
   TEST_DEPENDS
     OTBImageBase
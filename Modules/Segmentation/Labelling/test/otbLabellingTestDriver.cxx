@@ -30,4 +30,6 @@ void RegisterTests()
   REGISTER_TEST(otbLabelizeConfidenceConnectedImageFilterNew);
   REGISTER_TEST(otbLabelToBoundaryImageFilter);
   REGISTER_TEST(otbLabelToBoundaryImageFilterNew);
+  REGISTER_TEST(otbStreamingConnectedComponentLabellingFilterNew);
+  REGISTER_TEST(otbStreamingConnectedComponentLabellingFilter);
 }
@@ -0,0 +1,181 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "otbStreamingConnectedComponentLabellingFilter.h"
+#include "otbConnectedComponentLabelImageFilter.h"
+#include "otbImageFileReader.h"
+#include "otbImageFileWriter.h"
+#include "otbImage.h"
+#include "itkBinaryThresholdImageFilter.h"
+#include "itkConnectedComponentImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+
+#include <map>
+
+int otbStreamingConnectedComponentLabellingFilterNew(int itkNotUsed(argc), char * itkNotUsed(argv) [])
+{
+  typedef unsigned char MaskPixelType;
+  typedef unsigned int  LabelPixelType;
+  const unsigned int Dimension = 2;
+
+  typedef otb::Image<MaskPixelType, Dimension>  MaskImageType;
+  typedef otb::Image<LabelPixelType, Dimension> LabelImageType;
+
+  typedef otb::StreamingConnectedComponentLabellingFilter<MaskImageType>        LabellingFilterType;
+  typedef otb::ConnectedComponentLabelImageFilter<MaskImageType, LabelImageType> LabelFilterType;
+
+  LabellingFilterType::Pointer labelling = LabellingFilterType::New();
+  LabelFilterType::Pointer     labelFilter = LabelFilterType::New();
+
+  std::cout << labelling->GetFilter() << std::endl;
+  std::cout << labelFilter << std::endl;
+
+  return EXIT_SUCCESS;
+}
+
+int otbStreamingConnectedComponentLabellingFilter(int argc, char * argv [])
+{
+  if (argc != 7)
+  {
+    std::cerr << "Usage : " << argv[0]
+              << " input_image threshold block_size tile_size fully_connected output_labels" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  typedef float         InputPixelType;
+  typedef unsigned char MaskPixelType;
+  typedef unsigned int  LabelPixelType;
+  const unsigned int Dimension = 2;
+
+  typedef otb::Image<InputPixelType, Dimension> InputImageType;
+  typedef otb::Image<MaskPixelType, Dimension>  MaskImageType;
+  typedef otb::Image<LabelPixelType, Dimension> LabelImageType;
+
+  typedef otb::ImageFileReader<InputImageType>                                   ReaderType;
+  typedef otb::ImageFileWriter<LabelImageType>                                   WriterType;
+  typedef itk::BinaryThresholdImageFilter<InputImageType, MaskImageType>         ThresholdFilterType;
+  typedef otb::StreamingConnectedComponentLabellingFilter<MaskImageType>        LabellingFilterType;
+  typedef otb::ConnectedComponentLabelImageFilter<MaskImageType, LabelImageType> LabelFilterType;
+  typedef itk::ConnectedComponentImageFilter<MaskImageType, LabelImageType>     ReferenceFilterType;
+
+  const double       thresholdValue = atof(argv[2]);
+  const unsigned int blockSize = atoi(argv[3]);
+  const unsigned int tileSize = atoi(argv[4]);
+  const bool         fullyConnected = atoi(argv[5]) != 0;
+
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(argv[1]);
+
+  ThresholdFilterType::Pointer threshold = ThresholdFilterType::New();
+  threshold->SetInput(reader->GetOutput());
+  threshold->SetLowerThreshold(thresholdValue);
+  threshold->SetInsideValue(1);
+  threshold->SetOutsideValue(0);
+
+  // First pass: resolve the labels and compute the statistics
+  LabellingFilterType::Pointer labelling = LabellingFilterType::New();
+  labelling->SetInput(threshold->GetOutput());
+  labelling->SetFullyConnected(fullyConnected);
+  LabellingFilterType::SizeType size;
+  size.Fill(blockSize);
+  labelling->SetBlockSize(size);
+  labelling->SetComputeStatistics(true);
+  labelling->GetStreamer()->SetTileDimensionTiledStreaming(tileSize);
+  labelling->Update();
+
+  // Second pass: write the label image
+  LabelFilterType::Pointer labelFilter = LabelFilterType::New();
+  labelFilter->SetInput(threshold->GetOutput());
+  labelFilter->SetLabellingFilter(labelling->GetFilter());
+
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetInput(labelFilter->GetOutput());
+  writer->SetFileName(argv[6]);
+  writer->SetTileDimensionTiledStreaming(tileSize);
+  writer->Update();
+
+  // Compare with the in-memory labelling
+  ReferenceFilterType::Pointer reference = ReferenceFilterType::New();
+  reference->SetInput(threshold->GetOutput());
+  reference->SetFullyConnected(fullyConnected);
+  reference->Update();
+
+  typedef otb::ImageFileReader<LabelImageType> LabelReaderType;
+  LabelReaderType::Pointer labelReader = LabelReaderType::New();
+  labelReader->SetFileName(argv[6]);
+  labelReader->Update();
+
+  if (reference->GetObjectCount() != labelling->GetNumberOfComponents())
+    {
+    std::cerr << "Found " << labelling->GetNumberOfComponents() << " components instead of "
+              << reference->GetObjectCount() << "." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Labels must correspond one to one
+  std::map<LabelPixelType, LabelPixelType> labelToReference;
+  std::map<LabelPixelType, LabelPixelType> referenceToLabel;
+  std::map<LabelPixelType, unsigned long>  areas;
+
+  itk::ImageRegionConstIterator<LabelImageType> refIt(reference->GetOutput(),
+                                                      reference->GetOutput()->GetLargestPossibleRegion());
+  itk::ImageRegionConstIterator<LabelImageType> labelIt(labelReader->GetOutput(),
+                                                        labelReader->GetOutput()->GetLargestPossibleRegion());
+  for (refIt.GoToBegin(), labelIt.GoToBegin(); !refIt.IsAtEnd(); ++refIt, ++labelIt)
+    {
+    const LabelPixelType ref = refIt.Get();
+    const LabelPixelType label = labelIt.Get();
+    if ((ref == 0) != (label == 0))
+      {
+      std::cerr << "Background mismatch at index " << refIt.GetIndex() << "." << std::endl;
+      return EXIT_FAILURE;
+      }
+    if (ref == 0)
+      {
+      continue;
+      }
+    if (labelToReference.insert(std::make_pair(label, ref)).first->second != ref
+        || referenceToLabel.insert(std::make_pair(ref, label)).first->second != label)
+      {
+      std::cerr << "Label " << label << " does not match reference label " << ref
+                << " at index " << refIt.GetIndex() << "." << std::endl;
+      return EXIT_FAILURE;
+      }
+    areas[label]++;
+    }
+
+  for (std::map<LabelPixelType, unsigned long>::const_iterator it = areas.begin(); it != areas.end(); ++it)
+    {
+    if (labelling->GetComponentArea(it->first) != it->second)
+      {
+      std::cerr << "Wrong area for label " << it->first << ": " << labelling->GetComponentArea(it->first)
+                << " instead of " << it->second << "." << std::endl;
+      return EXIT_FAILURE;
+      }
+    if (labelling->GetComponentMean(it->first) != 1.)
+      {
+      std::cerr << "Wrong mean for label " << it->first << "." << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -81,6 +81,8 @@ private:
 *  merging filter.
 *  This filter relies on MeanShift Labeled image created from clustered filtered output of meanshift filter.
 *  Mode search algorithm is not performed on tiles boundaries. Thus output depends on Thread numbers.
+*  A MeanShiftModeCache can be set to warm-start the mean shift filter when
+*  reprocessing overlapping areas (see MeanShiftSmoothingImageFilter).
  *
  * \ingroup OTBMeanShift
 */
@@ -117,6 +119,7 @@ public:
   typedef OutputClusteredImageType                                                               MeanShiftFilteredImageType;
   typedef MeanShiftSmoothingImageFilter<InputSpectralImageType, MeanShiftFilteredImageType, KernelType>  MeanShiftFilterType;
   typedef typename MeanShiftFilterType::Pointer                                                  MeanShiftFilterPointerType;
+  typedef typename MeanShiftFilterType::ModeCacheType                                            ModeCacheType;
   // Region merging filter
   typedef typename MeanShiftFilterType::OutputLabelImageType                             InputLabelImageType;
   typedef typename MeanShiftFilterType::LabelType                                        InputLabelPixelType;
@@ -161,6 +164,23 @@ public:
   otbGetObjectMemberMacro(RegionPruningFilter,MinRegionSize,RealType);
 
 
+  /** Set/Get the mode cache used to warm-start the mean shift filter */
+  void SetModeCache(ModeCacheType * cache)
+  {
+    m_MeanShiftFilter->SetModeCache(cache);
+    this->Modified();
+  }
+  ModeCacheType * GetModeCache()
+  {
+    return m_MeanShiftFilter->GetModeCache();
+  }
+
+  /** Number of modes restored from the cache during the last run */
+  itk::SizeValueType GetNumberOfCachedModes() const
+  {
+    return m_MeanShiftFilter->GetNumberOfCachedModes();
+  }
+
   /** Returns the const image of region labels */
   const OutputLabelImageType * GetLabelOutput() const;
   /** Returns the image of region labels */
@@ -0,0 +1,403 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbStreamingHooverCompareFilter_h
+#define otbStreamingHooverCompareFilter_h
+
+#include "otbPersistentImageFilter.h"
+#include "otbPersistentFilterStreamingDecorator.h"
+
+#include <vector>
+#include <unordered_map>
+
+namespace otb
+{
+
+/** \class PersistentHooverCompareFilter
+ * \brief Compute the Hoover instances between two label images, using the output requested region.
+ *
+ * The first input is the ground truth segmentation (GT), the second input is
+ * the machine segmentation (MS). Pixels labelled with the background value in
+ * one of the images do not belong to any region of this image.
+ *
+ * Contrary to HooverMatrixFilter, no dense GT x MS confusion matrix is built:
+ * each thread accumulates the overlap counts of the pairs of labels it meets
+ * in a hash map, along with the region cardinalities. Consecutive pixels with
+ * the same pair of labels are counted at once. The thread maps are merged
+ * after each streamed region, so that the memory footprint only depends on the
+ * number of overlapping pairs.
+ *
+ * Synthetize() sorts the merged counts into a sparse table, indexed by GT
+ * region and by MS region, and computes the Hoover instances from this table,
+ * following the same rules as HooverInstanceFilter. The mean scores are
+ * available through GetMeanRC(), GetMeanRF(), GetMeanRA(), GetMeanRM() and
+ * GetMeanRN(), and the scores of each region through GetGroundTruthScores()
+ * and GetMachineSegmentationScores().
+ *
+ * This filter persists its temporary data. It means that if you Update it n times on n different
+ * requested regions, the output scores will be the scores of the whole set of n regions.
+ *
+ * To reset the temporary data, one should call the Reset() function.
+ *
+ * To get the scores once the regions have been processed via the pipeline, use the Synthetize() method.
+ *
+ * \sa HooverMatrixFilter
+ * \sa HooverInstanceFilter
+ * \sa PersistentImageFilter
+ * \ingroup Streamed
+ * \ingroup Multithreaded
+ *
+ * \ingroup OTBMetrics
+ */
+template<class TLabelImage>
+class ITK_EXPORT PersistentHooverCompareFilter :
+  public PersistentImageFilter<TLabelImage, TLabelImage>
+{
+public:
+  /** Standard Self typedef */
+  typedef PersistentHooverCompareFilter                   Self;
+  typedef PersistentImageFilter<TLabelImage, TLabelImage> Superclass;
+  typedef itk::SmartPointer<Self>                         Pointer;
+  typedef itk::SmartPointer<const Self>                   ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(PersistentHooverCompareFilter, PersistentImageFilter);
+
+  /** Image related typedefs. */
+  typedef TLabelImage                      LabelImageType;
+  typedef typename TLabelImage::RegionType RegionType;
+  typedef typename TLabelImage::PixelType  LabelType;
+
+  typedef std::vector<LabelType>           LabelVectorType;
+  typedef std::vector<itk::SizeValueType>  CardinalityVectorType;
+
+  /** Hoover scores of a region. RM is only set for GT regions, RN only for MS regions. */
+  struct ScoresType
+  {
+    double RC;
+    double RF;
+    double RA;
+    double RM;
+    double RN;
+  };
+  typedef std::vector<ScoresType>          ScoresVectorType;
+
+  /** Non-empty intersection between a GT region and a MS region, given by their position in the sorted labels */
+  struct OverlapType
+  {
+    itk::SizeValueType GroundTruthRegion;
+    itk::SizeValueType MachineSegmentationRegion;
+    itk::SizeValueType Count;
+  };
+  typedef std::vector<OverlapType>         OverlapVectorType;
+
+  /** Connect the ground truth label image */
+  void SetGroundTruthImage(const LabelImageType *image);
+  const LabelImageType * GetGroundTruthImage();
+
+  /** Connect the machine segmentation label image */
+  void SetMachineSegmentationImage(const LabelImageType *image);
+  const LabelImageType * GetMachineSegmentationImage();
+
+  /** Set/Get the background label of both images (default is 0) */
+  itkSetMacro(BackgroundValue, LabelType);
+  itkGetConstMacro(BackgroundValue, LabelType);
+
+  /** Set/Get the overlapping threshold used to find Hoover instances (default is 0.8) */
+  itkSetMacro(Threshold, double);
+  itkGetConstMacro(Threshold, double);
+
+  /** Mean Hoover scores, available after Synthetize() */
+  itkGetConstMacro(MeanRC, double);
+  itkGetConstMacro(MeanRF, double);
+  itkGetConstMacro(MeanRA, double);
+  itkGetConstMacro(MeanRM, double);
+  itkGetConstMacro(MeanRN, double);
+
+  /** Sorted labels of the regions found in each segmentation */
+  const LabelVectorType & GetGroundTruthLabels() const
+  {
+    return m_GroundTruthLabels;
+  }
+  const LabelVectorType & GetMachineSegmentationLabels() const
+  {
+    return m_MachineSegmentationLabels;
+  }
+
+  /** Number of pixels of each region, in the order of the labels */
+  const CardinalityVectorType & GetGroundTruthCardinalities() const
+  {
+    return m_GroundTruthCardinalities;
+  }
+  const CardinalityVectorType & GetMachineSegmentationCardinalities() const
+  {
+    return m_MachineSegmentationCardinalities;
+  }
+
+  /** Hoover scores of each region, in the order of the labels */
+  const ScoresVectorType & GetGroundTruthScores() const
+  {
+    return m_GroundTruthScores;
+  }
+  const ScoresVectorType & GetMachineSegmentationScores() const
+  {
+    return m_MachineSegmentationScores;
+  }
+
+  /** Sparse overlap table, sorted by GT region then by MS region */
+  const OverlapVectorType & GetOverlaps() const
+  {
+    return m_OverlapTable;
+  }
+
+  /** Number of pixels shared by two regions, given by their labels */
+  itk::SizeValueType GetOverlap(LabelType groundTruthLabel, LabelType machineSegmentationLabel) const;
+
+  void AllocateOutputs() ITK_OVERRIDE;
+  void GenerateOutputInformation() ITK_OVERRIDE;
+  void Synthetize(void) ITK_OVERRIDE;
+  void Reset(void) ITK_OVERRIDE;
+
+protected:
+  PersistentHooverCompareFilter();
+  ~PersistentHooverCompareFilter() ITK_OVERRIDE {}
+  void PrintSelf(std::ostream& os, itk::Indent indent) const ITK_OVERRIDE;
+
+  void BeforeThreadedGenerateData() ITK_OVERRIDE;
+
+  /** Multi-thread version GenerateData. */
+  void ThreadedGenerateData(const RegionType& outputRegionForThread,
+                            itk::ThreadIdType threadId) ITK_OVERRIDE;
+
+  /** Merge the thread maps */
+  void AfterThreadedGenerateData() ITK_OVERRIDE;
+
+private:
+  PersistentHooverCompareFilter(const Self &); //purposely not implemented
+  void operator =(const Self&); //purposely not implemented
+
+  typedef std::pair<LabelType, LabelType> LabelPairType;
+
+  struct LabelPairHash
+  {
+    std::size_t operator()(const LabelPairType & pair) const
+    {
+      const std::size_t h = std::hash<LabelType>()(pair.first);
+      return h ^ (std::hash<LabelType>()(pair.second) + 0x9e3779b9 + (h << 6) + (h >> 2));
+    }
+  };
+
+  typedef std::unordered_map<LabelPairType, itk::SizeValueType, LabelPairHash> OverlapMapType;
+  typedef std::unordered_map<LabelType, itk::SizeValueType>                    CardinalityMapType;
+
+  /** Add a run of pixels sharing the same labels to the maps of a thread */
+  void AccumulateRun(itk::ThreadIdType threadId, LabelType groundTruthLabel,
+                     LabelType machineSegmentationLabel, itk::SizeValueType length);
+
+  /** Sort the labels and cardinalities of a map */
+  static void SortCardinalities(const CardinalityMapType & map, LabelVectorType & labels,
+                                CardinalityVectorType & cardinalities);
+
+  /** Position of a label in sorted labels */
+  static itk::SizeValueType FindRegion(const LabelVectorType & labels, LabelType label);
+
+  /** Compute the Hoover instances from the sparse overlap table */
+  void ComputeInstances();
+
+  LabelType m_BackgroundValue;
+  double    m_Threshold;
+
+  /** Per-thread accumulators */
+  std::vector<OverlapMapType>     m_ThreadOverlaps;
+  std::vector<CardinalityMapType> m_ThreadGroundTruthCardinalities;
+  std::vector<CardinalityMapType> m_ThreadMachineSegmentationCardinalities;
+
+  /** Accumulators merged over the processed regions */
+  OverlapMapType     m_Overlaps;
+  CardinalityMapType m_GroundTruthCardinalityMap;
+  CardinalityMapType m_MachineSegmentationCardinalityMap;
+
+  /** Sparse table, built by Synthetize() */
+  LabelVectorType          m_GroundTruthLabels;
+  LabelVectorType          m_MachineSegmentationLabels;
+  CardinalityVectorType    m_GroundTruthCardinalities;
+  CardinalityVectorType    m_MachineSegmentationCardinalities;
+  OverlapVectorType        m_OverlapTable;
+  /** First overlap of each GT region, with one more element for the end */
+  std::vector<itk::SizeValueType> m_GroundTruthOffsets;
+  /** Overlaps sorted by MS region then by GT region, and first one of each MS region */
+  std::vector<itk::SizeValueType> m_MachineSegmentationOrder;
+  std::vector<itk::SizeValueType> m_MachineSegmentationOffsets;
+
+  ScoresVectorType m_GroundTruthScores;
+  ScoresVectorType m_MachineSegmentationScores;
+
+  double m_MeanRC;
+  double m_MeanRF;
+  double m_MeanRA;
+  double m_MeanRM;
+  double m_MeanRN;
+}; // end of class PersistentHooverCompareFilter
+
+/*===========================================================================*/
+
+/** \class StreamingHooverCompareFilter
+ * \brief This class streams two label images through the PersistentHooverCompareFilter.
+ *
+ * It allows computing the Hoover scores of segmentations too large to be
+ * represented as label maps, or with too many regions for a dense confusion
+ * matrix. The accessors on the results wrap the accessors of the internal
+ * PersistentHooverCompareFilter.
+ *
+ * This filter can be used as:
+ * \code
+ * typedef otb::StreamingHooverCompareFilter<LabelImageType> HooverCompareType;
+ * HooverCompareType::Pointer hoover = HooverCompareType::New();
+ * hoover->SetGroundTruthImage(gtReader->GetOutput());
+ * hoover->SetMachineSegmentationImage(msReader->GetOutput());
+ * hoover->SetThreshold(0.75);
+ * hoover->Update();
+ * std::cout << hoover->GetMeanRC() << std::endl;
+ * \endcode
+ *
+ * \sa PersistentHooverCompareFilter
+ * \sa PersistentFilterStreamingDecorator
+ * \ingroup Streamed
+ * \ingroup Multithreaded
+ *
+ * \ingroup OTBMetrics
+ */
+template<class TLabelImage>
+class ITK_EXPORT StreamingHooverCompareFilter :
+  public PersistentFilterStreamingDecorator<PersistentHooverCompareFilter<TLabelImage> >
+{
+public:
+  /** Standard Self typedef */
+  typedef StreamingHooverCompareFilter Self;
+  typedef PersistentFilterStreamingDecorator
+  <PersistentHooverCompareFilter<TLabelImage> > Superclass;
+  typedef itk::SmartPointer<Self>       Pointer;
+  typedef itk::SmartPointer<const Self> ConstPointer;
+
+  /** Type macro */
+  itkNewMacro(Self);
+
+  /** Creation through object factory macro */
+  itkTypeMacro(StreamingHooverCompareFilter, PersistentFilterStreamingDecorator);
+
+  typedef typename Superclass::FilterType             HooverFilterType;
+  typedef TLabelImage                                 LabelImageType;
+  typedef typename HooverFilterType::LabelType        LabelType;
+  typedef typename HooverFilterType::ScoresVectorType ScoresVectorType;
+  typedef typename HooverFilterType::LabelVectorType  LabelVectorType;
+
+  void SetGroundTruthImage(const LabelImageType * input)
+  {
+    this->GetFilter()->SetGroundTruthImage(input);
+  }
+
+  void SetMachineSegmentationImage(const LabelImageType * input)
+  {
+    this->GetFilter()->SetMachineSegmentationImage(input);
+  }
+
+  void SetBackgroundValue(LabelType value)
+  {
+    this->GetFilter()->SetBackgroundValue(value);
+  }
+  LabelType GetBackgroundValue() const
+  {
+    return this->GetFilter()->GetBackgroundValue();
+  }
+
+  void SetThreshold(double threshold)
+  {
+    this->GetFilter()->SetThreshold(threshold);
+  }
+  double GetThreshold() const
+  {
+    return this->GetFilter()->GetThreshold();
+  }
+
+  double GetMeanRC() const
+  {
+    return this->GetFilter()->GetMeanRC();
+  }
+  double GetMeanRF() const
+  {
+    return this->GetFilter()->GetMeanRF();
+  }
+  double GetMeanRA() const
+  {
+    return this->GetFilter()->GetMeanRA();
+  }
+  double GetMeanRM() const
+  {
+    return this->GetFilter()->GetMeanRM();
+  }
+  double GetMeanRN() const
+  {
+    return this->GetFilter()->GetMeanRN();
+  }
+
+  const LabelVectorType & GetGroundTruthLabels() const
+  {
+    return this->GetFilter()->GetGroundTruthLabels();
+  }
+  const LabelVectorType & GetMachineSegmentationLabels() const
+  {
+    return this->GetFilter()->GetMachineSegmentationLabels();
+  }
+
+  const ScoresVectorType & GetGroundTruthScores() const
+  {
+    return this->GetFilter()->GetGroundTruthScores();
+  }
+  const ScoresVectorType & GetMachineSegmentationScores() const
+  {
+    return this->GetFilter()->GetMachineSegmentationScores();
+  }
+
+  itk::SizeValueType GetOverlap(LabelType groundTruthLabel, LabelType machineSegmentationLabel) const
+  {
+    return this->GetFilter()->GetOverlap(groundTruthLabel, machineSegmentationLabel);
+  }
+
+protected:
+  /** Constructor */
+  StreamingHooverCompareFilter() {}
+  /** Destructor */
+  ~StreamingHooverCompareFilter() ITK_OVERRIDE {}
+
+private:
+  StreamingHooverCompareFilter(const Self &); //purposely not implemented
+  void operator =(const Self&); //purposely not implemented
+};
+
+} // end namespace otb
+
+#ifndef OTB_MANUAL_INSTANTIATION
+#include "otbStreamingHooverCompareFilter.txx"
+#endif
+
+#endif
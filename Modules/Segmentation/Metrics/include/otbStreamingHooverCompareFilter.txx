@@ -0,0 +1,543 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbStreamingHooverCompareFilter_txx
+#define otbStreamingHooverCompareFilter_txx
+#include "otbStreamingHooverCompareFilter.h"
+
+#include "itkImageRegionConstIterator.h"
+#include "itkProgressReporter.h"
+
+#include <algorithm>
+
+namespace otb
+{
+
+template<class TLabelImage>
+PersistentHooverCompareFilter<TLabelImage>
+::PersistentHooverCompareFilter() :
+  m_BackgroundValue(itk::NumericTraits<LabelType>::Zero),
+  m_Threshold(0.8),
+  m_MeanRC(0.),
+  m_MeanRF(0.),
+  m_MeanRA(0.),
+  m_MeanRM(0.),
+  m_MeanRN(0.)
+{
+  this->SetNumberOfRequiredInputs(2);
+}
+
+template<class TLabelImage>
+void
+PersistentHooverCompareFilter<TLabelImage>
+::SetGroundTruthImage(const LabelImageType *image)
+{
+  // The ProcessObject is not const-correct so the const_cast is required here
+  this->SetNthInput(0, const_cast<LabelImageType *>(image));
+}
+
+template<class TLabelImage>
+void
+PersistentHooverCompareFilter<TLabelImage>
+::SetMachineSegmentationImage(const LabelImageType *image)
+{
+  // The ProcessObject is not const-correct so the const_cast is required here
+  this->SetNthInput(1, const_cast<LabelImageType *>(image));
+}
+
+template<class TLabelImage>
+const TLabelImage *
+PersistentHooverCompareFilter<TLabelImage>
+::GetGroundTruthImage()
+{
+  if (this->GetNumberOfInputs() < 1)
+    {
+    return ITK_NULLPTR;
+    }
+  return static_cast<const LabelImageType *>(this->itk::ProcessObject::GetInput(0));
+}
+
+template<class TLabelImage>
+const TLabelImage *
+PersistentHooverCompareFilter<TLabelImage>
+::GetMachineSegmentationImage()
+{
+  if (this->GetNumberOfInputs() < 2)
+    {
+    return ITK_NULLPTR;
+    }
+  return static_cast<const LabelImageType *>(this->itk::ProcessObject::GetInput(1));
+}
+
+template<class TLabelImage>
+void
+PersistentHooverCompareFilter<TLabelImage>
+::GenerateOutputInformation()
+{
+  Superclass::GenerateOutputInformation();
+  if (this->GetInput())
+    {
+    this->GetOutput()->CopyInformation(this->GetInput());
+    this->GetOutput()->SetLargestPossibleRegion(this->GetInput()->GetLargestPossibleRegion());
+
+    if (this->GetOutput()->GetRequestedRegion().GetNumberOfPixels() == 0)
+      {
+      this->GetOutput()->SetRequestedRegion(this->GetOutput()->GetLargestPossibleRegion());
+      }
+    }
+}
+
+template<class TLabelImage>
+void
+PersistentHooverCompareFilter<TLabelImage>
+::AllocateOutputs()
+{
+  // Nothing to allocate: the output image of this filter is not intended to be used.
+}
+
+template<class TLabelImage>
+void
+PersistentHooverCompareFilter<TLabelImage>
+::Reset()
+{
+  m_ThreadOverlaps.clear();
+  m_ThreadGroundTruthCardinalities.clear();
+  m_ThreadMachineSegmentationCardinalities.clear();
+
+  m_Overlaps.clear();
+  m_GroundTruthCardinalityMap.clear();
+  m_MachineSegmentationCardinalityMap.clear();
+
+  m_GroundTruthLabels.clear();
+  m_MachineSegmentationLabels.clear();
+  m_GroundTruthCardinalities.clear();
+  m_MachineSegmentationCardinalities.clear();
+  m_OverlapTable.clear();
+  m_GroundTruthOffsets.clear();
+  m_MachineSegmentationOrder.clear();
+  m_MachineSegmentationOffsets.clear();
+  m_GroundTruthScores.clear();
+  m_MachineSegmentationScores.clear();
+
+  m_MeanRC = 0.;
+  m_MeanRF = 0.;
+  m_MeanRA = 0.;
+  m_MeanRM = 0.;
+  m_MeanRN = 0.;
+}
+
+template<class TLabelImage>
+void
+PersistentHooverCompareFilter<TLabelImage>
+::BeforeThreadedGenerateData()
+{
+  const unsigned int numberOfThreads = this->GetNumberOfThreads();
+  m_ThreadOverlaps.assign(numberOfThreads, OverlapMapType());
+  m_ThreadGroundTruthCardinalities.assign(numberOfThreads, CardinalityMapType());
+  m_ThreadMachineSegmentationCardinalities.assign(numberOfThreads, CardinalityMapType());
+}
+
+template<class TLabelImage>
+void
+PersistentHooverCompareFilter<TLabelImage>
+::AccumulateRun(itk::ThreadIdType threadId, LabelType groundTruthLabel,
+                LabelType machineSegmentationLabel, itk::SizeValueType length)
+{
+  const bool inGroundTruth = (groundTruthLabel != m_BackgroundValue);
+  const bool inMachineSegmentation = (machineSegmentationLabel != m_BackgroundValue);
+
+  if (inGroundTruth)
+    {
+    m_ThreadGroundTruthCardinalities[threadId][groundTruthLabel] += length;
+    }
+  if (inMachineSegmentation)
+    {
+    m_ThreadMachineSegmentationCardinalities[threadId][machineSegmentationLabel] += length;
+    }
+  if (inGroundTruth && inMachineSegmentation)
+    {
+    m_ThreadOverlaps[threadId][LabelPairType(groundTruthLabel, machineSegmentationLabel)] += length;
+    }
+}
+
+template<class TLabelImage>
+void
+PersistentHooverCompareFilter<TLabelImage>
+::ThreadedGenerateData(const RegionType& outputRegionForThread,
+                       itk::ThreadIdType threadId)
+{
+  itk::ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels());
+
+  itk::ImageRegionConstIterator<LabelImageType> itGT(this->GetGroundTruthImage(), outputRegionForThread);
+  itk::ImageRegionConstIterator<LabelImageType> itMS(this->GetMachineSegmentationImage(), outputRegionForThread);
+
+  itGT.GoToBegin();
+  itMS.GoToBegin();
+  if (itGT.IsAtEnd())
+    {
+    return;
+    }
+
+  // Pixels sharing the same pair of labels are accumulated before touching the maps
+  LabelType currentGT = itGT.Get();
+  LabelType currentMS = itMS.Get();
+  itk::SizeValueType length = 0;
+
+  for (; !itGT.IsAtEnd(); ++itGT, ++itMS)
+    {
+    const LabelType labelGT = itGT.Get();
+    const LabelType labelMS = itMS.Get();
+    if (labelGT != currentGT || labelMS != currentMS)
+      {
+      AccumulateRun(threadId, currentGT, currentMS, length);
+      currentGT = labelGT;
+      currentMS = labelMS;
+      length = 0;
+      }
+    ++length;
+    progress.CompletedPixel();
+    }
+  AccumulateRun(threadId, currentGT, currentMS, length);
+}
+
+template<class TLabelImage>
+void
+PersistentHooverCompareFilter<TLabelImage>
+::AfterThreadedGenerateData()
+{
+  for (unsigned int threadId = 0; threadId < m_ThreadOverlaps.size(); ++threadId)
+    {
+    for (typename OverlapMapType::const_iterator it = m_ThreadOverlaps[threadId].begin();
+         it != m_ThreadOverlaps[threadId].end(); ++it)
+      {
+      m_Overlaps[it->first] += it->second;
+      }
+    for (typename CardinalityMapType::const_iterator it = m_ThreadGroundTruthCardinalities[threadId].begin();
+         it != m_ThreadGroundTruthCardinalities[threadId].end(); ++it)
+      {
+      m_GroundTruthCardinalityMap[it->first] += it->second;
+      }
+    for (typename CardinalityMapType::const_iterator it = m_ThreadMachineSegmentationCardinalities[threadId].begin();
+         it != m_ThreadMachineSegmentationCardinalities[threadId].end(); ++it)
+      {
+      m_MachineSegmentationCardinalityMap[it->first] += it->second;
+      }
+    }
+
+  // Release the thread maps between two streamed regions
+  m_ThreadOverlaps.clear();
+  m_ThreadGroundTruthCardinalities.clear();
+  m_ThreadMachineSegmentationCardinalities.clear();
+}
+
+template<class TLabelImage>
+void
+PersistentHooverCompareFilter<TLabelImage>
+::SortCardinalities(const CardinalityMapType & map, LabelVectorType & labels,
+                    CardinalityVectorType & cardinalities)
+{
+  std::vector<std::pair<LabelType, itk::SizeValueType> > sorted(map.begin(), map.end());
+  std::sort(sorted.begin(), sorted.end());
+
+  labels.resize(sorted.size());
+  cardinalities.resize(sorted.size());
+  for (std::size_t i = 0; i < sorted.size(); ++i)
+    {
+    labels[i] = sorted[i].first;
+    cardinalities[i] = sorted[i].second;
+    }
+}
+
+template<class TLabelImage>
+itk::SizeValueType
+PersistentHooverCompareFilter<TLabelImage>
+::FindRegion(const LabelVectorType & labels, LabelType label)
+{
+  return std::lower_bound(labels.begin(), labels.end(), label) - labels.begin();
+}
+
+template<class TLabelImage>
+void
+PersistentHooverCompareFilter<TLabelImage>
+::Synthetize()
+{
+  SortCardinalities(m_GroundTruthCardinalityMap, m_GroundTruthLabels, m_GroundTruthCardinalities);
+  SortCardinalities(m_MachineSegmentationCardinalityMap, m_MachineSegmentationLabels,
+                    m_MachineSegmentationCardinalities);
+  CardinalityMapType().swap(m_GroundTruthCardinalityMap);
+  CardinalityMapType().swap(m_MachineSegmentationCardinalityMap);
+
+  const itk::SizeValueType nbRegionsGT = m_GroundTruthLabels.size();
+  const itk::SizeValueType nbRegionsMS = m_MachineSegmentationLabels.size();
+
+  // Build the sparse table, sorted by GT region then by MS region
+  m_OverlapTable.clear();
+  m_OverlapTable.reserve(m_Overlaps.size());
+  for (typename OverlapMapType::const_iterator it = m_Overlaps.begin(); it != m_Overlaps.end(); ++it)
+    {
+    OverlapType overlap;
+    overlap.GroundTruthRegion = FindRegion(m_GroundTruthLabels, it->first.first);
+    overlap.MachineSegmentationRegion = FindRegion(m_MachineSegmentationLabels, it->first.second);
+    overlap.Count = it->second;
+    m_OverlapTable.push_back(overlap);
+    }
+  OverlapMapType().swap(m_Overlaps);
+
+  std::sort(m_OverlapTable.begin(), m_OverlapTable.end(),
+            [](const OverlapType & a, const OverlapType & b)
+            {
+              return a.GroundTruthRegion < b.GroundTruthRegion
+                || (a.GroundTruthRegion == b.GroundTruthRegion
+                    && a.MachineSegmentationRegion < b.MachineSegmentationRegion);
+            });
+
+  m_GroundTruthOffsets.assign(nbRegionsGT + 1, 0);
+  m_MachineSegmentationOffsets.assign(nbRegionsMS + 1, 0);
+  for (typename OverlapVectorType::const_iterator it = m_OverlapTable.begin(); it != m_OverlapTable.end(); ++it)
+    {
+    ++m_GroundTruthOffsets[it->GroundTruthRegion + 1];
+    ++m_MachineSegmentationOffsets[it->MachineSegmentationRegion + 1];
+    }
+  for (itk::SizeValueType i = 0; i < nbRegionsGT; ++i)
+    {
+    m_GroundTruthOffsets[i + 1] += m_GroundTruthOffsets[i];
+    }
+  for (itk::SizeValueType j = 0; j < nbRegionsMS; ++j)
+    {
+    m_MachineSegmentationOffsets[j + 1] += m_MachineSegmentationOffsets[j];
+    }
+
+  // Counting sort of the table by MS region: GT regions stay sorted within each MS region
+  m_MachineSegmentationOrder.resize(m_OverlapTable.size());
+  std::vector<itk::SizeValueType> position(m_MachineSegmentationOffsets.begin(),
+                                           m_MachineSegmentationOffsets.end() - 1);
+  for (itk::SizeValueType k = 0; k < m_OverlapTable.size(); ++k)
+    {
+    m_MachineSegmentationOrder[position[m_OverlapTable[k].MachineSegmentationRegion]++] = k;
+    }
+
+  ComputeInstances();
+}
+
+template<class TLabelImage>
+void
+PersistentHooverCompareFilter<TLabelImage>
+::ComputeInstances()
+{
+  const itk::SizeValueType nbRegionsGT = m_GroundTruthLabels.size();
+  const itk::SizeValueType nbRegionsMS = m_MachineSegmentationLabels.size();
+
+  ScoresType blank;
+  blank.RC = blank.RF = blank.RA = blank.RM = blank.RN = 0.;
+  m_GroundTruthScores.assign(nbRegionsGT, blank);
+  m_MachineSegmentationScores.assign(nbRegionsMS, blank);
+
+  // Regions already part of an instance, or without any intersection
+  std::vector<bool> registeredGT(nbRegionsGT, false);
+  std::vector<bool> registeredMS(nbRegionsMS, false);
+
+  double bufferRC = 0.0;
+  double bufferRF = 0.0;
+  double bufferRA = 0.0;
+  double bufferRM = 0.0;
+  double bufferRN = 0.0;
+  double areaGT = 0.0;
+  double areaMS = 0.0;
+
+  std::vector<itk::SizeValueType> candidates;
+
+  // first pass : correct detections and over-segmentations, GT region by GT region
+  for (itk::SizeValueType row = 0; row < nbRegionsGT; ++row)
+    {
+    const double cardRegGT = static_cast<double>(m_GroundTruthCardinalities[row]);
+    const double tGT = cardRegGT * m_Threshold;
+    double sumOS = 0.0;
+    double sumScoreRF = 0.0;
+    candidates.clear();
+
+    for (itk::SizeValueType k = m_GroundTruthOffsets[row]; k < m_GroundTruthOffsets[row + 1]; ++k)
+      {
+      const double coefT = static_cast<double>(m_OverlapTable[k].Count);
+      const itk::SizeValueType col = m_OverlapTable[k].MachineSegmentationRegion;
+      const double tMS = static_cast<double>(m_MachineSegmentationCardinalities[col]) * m_Threshold;
+
+      if (coefT >= tMS)
+        {
+        if (coefT >= tGT)
+          {
+          const double scoreRC = m_Threshold * std::min(coefT / tGT, coefT / tMS);
+          bufferRC += scoreRC * cardRegGT;
+          m_GroundTruthScores[row].RC = scoreRC;
+          m_MachineSegmentationScores[col].RC = scoreRC;
+          registeredGT[row] = true;
+          registeredMS[col] = true;
+          }
+        candidates.push_back(col);
+        sumOS += coefT;
+        sumScoreRF += coefT * (coefT - 1.0);
+        }
+      }
+
+    if (sumOS >= tGT && sumOS > 0 && candidates.size() > 1)
+      {
+      const double scoreRF = 1.0 - sumScoreRF / (cardRegGT * (cardRegGT - 1.0));
+      bufferRF += scoreRF * cardRegGT;
+      m_GroundTruthScores[row].RF = scoreRF;
+      registeredGT[row] = true;
+      for (std::vector<itk::SizeValueType>::const_iterator it = candidates.begin(); it != candidates.end(); ++it)
+        {
+        m_MachineSegmentationScores[*it].RF = scoreRF;
+        registeredMS[*it] = true;
+        }
+      }
+
+    // empty rows are ignored and have no Hoover score
+    if (m_GroundTruthOffsets[row] == m_GroundTruthOffsets[row + 1])
+      {
+      registeredGT[row] = true;
+      }
+    else
+      {
+      areaGT += cardRegGT;
+      }
+    }
+
+  // second pass : under-segmentations, MS region by MS region
+  for (itk::SizeValueType col = 0; col < nbRegionsMS; ++col)
+    {
+    const double cardRegMS = static_cast<double>(m_MachineSegmentationCardinalities[col]);
+    const double tMS = cardRegMS * m_Threshold;
+    double sumUS = 0.0;
+    double sumScoreUS = 0.0;
+    double sumCardUS = 0.0;
+    candidates.clear();
+
+    for (itk::SizeValueType k = m_MachineSegmentationOffsets[col]; k < m_MachineSegmentationOffsets[col + 1]; ++k)
+      {
+      const OverlapType & overlap = m_OverlapTable[m_MachineSegmentationOrder[k]];
+      const double coefT = static_cast<double>(overlap.Count);
+      const itk::SizeValueType row = overlap.GroundTruthRegion;
+      const double cardRegGT = static_cast<double>(m_GroundTruthCardinalities[row]);
+
+      if (coefT >= cardRegGT * m_Threshold)
+        {
+        candidates.push_back(row);
+        sumUS += coefT;
+        sumScoreUS += coefT * (coefT - 1.0);
+        sumCardUS += cardRegGT;
+        }
+      }
+
+    if (sumUS >= tMS && candidates.size() > 1)
+      {
+      const double scoreRA = 1.0 - sumScoreUS / (sumCardUS * (sumCardUS - 1.0));
+      bufferRA += scoreRA * sumCardUS;
+      m_MachineSegmentationScores[col].RA = scoreRA;
+      registeredMS[col] = true;
+      for (std::vector<itk::SizeValueType>::const_iterator it = candidates.begin(); it != candidates.end(); ++it)
+        {
+        m_GroundTruthScores[*it].RA = scoreRA;
+        registeredGT[*it] = true;
+        }
+      }
+
+    // MS regions that don't intersect any GT region are ignored
+    if (m_MachineSegmentationOffsets[col] == m_MachineSegmentationOffsets[col + 1])
+      {
+      registeredMS[col] = true;
+      }
+    else
+      {
+      areaMS += cardRegMS;
+      }
+    }
+
+  // Missed regions (unregistered regions in GT)
+  for (itk::SizeValueType row = 0; row < nbRegionsGT; ++row)
+    {
+    if (!registeredGT[row])
+      {
+      bufferRM += static_cast<double>(m_GroundTruthCardinalities[row]);
+      m_GroundTruthScores[row].RM = 1.0;
+      }
+    }
+
+  // Noise regions (unregistered regions in MS)
+  for (itk::SizeValueType col = 0; col < nbRegionsMS; ++col)
+    {
+    if (!registeredMS[col])
+      {
+      bufferRN += static_cast<double>(m_MachineSegmentationCardinalities[col]);
+      m_MachineSegmentationScores[col].RN = 1.0;
+      }
+    }
+
+  m_MeanRC = areaGT > 0. ? bufferRC / areaGT : 0.;
+  m_MeanRF = areaGT > 0. ? bufferRF / areaGT : 0.;
+  m_MeanRA = areaGT > 0. ? bufferRA / areaGT : 0.;
+  m_MeanRM = areaGT > 0. ? bufferRM / areaGT : 0.;
+  m_MeanRN = areaMS > 0. ? bufferRN / areaMS : 0.;
+}
+
+template<class TLabelImage>
+itk::SizeValueType
+PersistentHooverCompareFilter<TLabelImage>
+::GetOverlap(LabelType groundTruthLabel, LabelType machineSegmentationLabel) const
+{
+  const itk::SizeValueType row = FindRegion(m_GroundTruthLabels, groundTruthLabel);
+  const itk::SizeValueType col = FindRegion(m_MachineSegmentationLabels, machineSegmentationLabel);
+  if (row == m_GroundTruthLabels.size() || m_GroundTruthLabels[row] != groundTruthLabel
+      || col == m_MachineSegmentationLabels.size() || m_MachineSegmentationLabels[col] != machineSegmentationLabel)
+    {
+    return 0;
+    }
+
+  typename OverlapVectorType::const_iterator begin = m_OverlapTable.begin() + m_GroundTruthOffsets[row];
+  typename OverlapVectorType::const_iterator end = m_OverlapTable.begin() + m_GroundTruthOffsets[row + 1];
+  typename OverlapVectorType::const_iterator it =
+    std::lower_bound(begin, end, col,
+                     [](const OverlapType & overlap, itk::SizeValueType region)
+                     {
+                       return overlap.MachineSegmentationRegion < region;
+                     });
+  return (it != end && it->MachineSegmentationRegion == col) ? it->Count : 0;
+}
+
+template<class TLabelImage>
+void
+PersistentHooverCompareFilter<TLabelImage>
+::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "BackgroundValue: " << static_cast<typename itk::NumericTraits<LabelType>::PrintType>(m_BackgroundValue) << std::endl;
+  os << indent << "Threshold: " << m_Threshold << std::endl;
+  os << indent << "Number of GT regions: " << m_GroundTruthLabels.size() << std::endl;
+  os << indent << "Number of MS regions: " << m_MachineSegmentationLabels.size() << std::endl;
+  os << indent << "Number of overlaps: " << m_OverlapTable.size() << std::endl;
+  os << indent << "Mean RC: " << m_MeanRC << std::endl;
+  os << indent << "Mean RF: " << m_MeanRF << std::endl;
+  os << indent << "Mean RA: " << m_MeanRA << std::endl;
+  os << indent << "Mean RM: " << m_MeanRM << std::endl;
+  os << indent << "Mean RN: " << m_MeanRN << std::endl;
+}
+
+} // end namespace otb
+#endif
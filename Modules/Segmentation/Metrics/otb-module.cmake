@@ -25,6 +25,7 @@ otb_module(OTBMetrics
   DEPENDS
     OTBCommon
     OTBITK
+    OTBStreaming
 
   TEST_DEPENDS
     OTBLabelMap
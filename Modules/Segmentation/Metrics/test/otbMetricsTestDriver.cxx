@@ -26,4 +26,6 @@ void RegisterTests()
   REGISTER_TEST(otbHooverInstanceFilterNew);
   REGISTER_TEST(otbHooverInstanceFilterToAttributeImage);
   REGISTER_TEST(otbHooverMatrixFilter);
+  REGISTER_TEST(otbStreamingHooverCompareFilterNew);
+  REGISTER_TEST(otbStreamingHooverCompareFilter);
 }
@@ -0,0 +1,189 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "otbStreamingHooverCompareFilter.h"
+#include "otbHooverMatrixFilter.h"
+#include "otbHooverInstanceFilter.h"
+#include "otbAttributesMapLabelObject.h"
+
+#include "otbImage.h"
+#include "otbImageFileReader.h"
+#include "itkLabelImageToLabelMapFilter.h"
+
+typedef otb::Image<unsigned int, 2>                           ImageType;
+typedef otb::StreamingHooverCompareFilter<ImageType>          StreamingHooverFilterType;
+
+int otbStreamingHooverCompareFilterNew(int itkNotUsed(argc), char * itkNotUsed(argv)[])
+{
+  StreamingHooverFilterType::Pointer filter = StreamingHooverFilterType::New();
+  std::cout << filter << std::endl;
+  return EXIT_SUCCESS;
+}
+
+namespace
+{
+bool IsClose(double value, double reference)
+{
+  return vcl_abs(value - reference) <= 1e-5;
+}
+}
+
+int otbStreamingHooverCompareFilter(int argc, char* argv[])
+{
+  typedef otb::AttributesMapLabelObject<unsigned int, 2, float> LabelObjectType;
+  typedef itk::LabelMap<LabelObjectType>            LabelMapType;
+  typedef otb::HooverMatrixFilter<LabelMapType>     HooverMatrixFilterType;
+  typedef itk::LabelImageToLabelMapFilter
+    <ImageType, LabelMapType>                       ImageToLabelMapFilterType;
+  typedef otb::ImageFileReader<ImageType>           ImageReaderType;
+  typedef HooverMatrixFilterType::MatrixType        MatrixType;
+  typedef otb::HooverInstanceFilter<LabelMapType>   InstanceFilterType;
+  typedef StreamingHooverFilterType::ScoresVectorType ScoresVectorType;
+
+  if(argc != 4)
+    {
+    std::cerr << "Usage: " << argv[0];
+    std::cerr << " segmentationGT segmentationMS tileSize" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const double threshold = 0.75;
+
+  ImageReaderType::Pointer gt_reader = ImageReaderType::New();
+  gt_reader->SetFileName(argv[1]);
+
+  ImageReaderType::Pointer ms_reader = ImageReaderType::New();
+  ms_reader->SetFileName(argv[2]);
+
+  // Reference : dense confusion matrix over label maps
+  ImageToLabelMapFilterType::Pointer gt_filter = ImageToLabelMapFilterType::New();
+  gt_filter->SetInput(gt_reader->GetOutput());
+  gt_filter->SetBackgroundValue(0);
+
+  ImageToLabelMapFilterType::Pointer ms_filter = ImageToLabelMapFilterType::New();
+  ms_filter->SetInput(ms_reader->GetOutput());
+  ms_filter->SetBackgroundValue(0);
+
+  HooverMatrixFilterType::Pointer hooverFilter = HooverMatrixFilterType::New();
+  hooverFilter->SetGroundTruthLabelMap(gt_filter->GetOutput());
+  hooverFilter->SetMachineSegmentationLabelMap(ms_filter->GetOutput());
+  hooverFilter->Update();
+
+  MatrixType &mat = hooverFilter->GetHooverConfusionMatrix();
+
+  InstanceFilterType::Pointer instances = InstanceFilterType::New();
+  instances->SetGroundTruthLabelMap(gt_filter->GetOutput());
+  instances->SetMachineSegmentationLabelMap(ms_filter->GetOutput());
+  instances->SetThreshold(threshold);
+  instances->SetHooverMatrix(mat);
+  instances->SetUseExtendedAttributes(false);
+  instances->Update();
+
+  // Streamed comparison with sparse overlaps
+  StreamingHooverFilterType::Pointer streamingFilter = StreamingHooverFilterType::New();
+  streamingFilter->SetGroundTruthImage(gt_reader->GetOutput());
+  streamingFilter->SetMachineSegmentationImage(ms_reader->GetOutput());
+  streamingFilter->SetBackgroundValue(0);
+  streamingFilter->SetThreshold(threshold);
+  streamingFilter->GetStreamer()->SetTileDimensionTiledStreaming(atoi(argv[3]));
+  streamingFilter->Update();
+
+  unsigned int nbErrors = 0;
+
+  const LabelMapType * gtMap = instances->GetOutputGroundTruthLabelMap();
+  const LabelMapType * msMap = instances->GetOutputMachineSegmentationLabelMap();
+  if (streamingFilter->GetGroundTruthLabels().size() != gtMap->GetNumberOfLabelObjects()
+      || streamingFilter->GetMachineSegmentationLabels().size() != msMap->GetNumberOfLabelObjects())
+    {
+    std::cerr << "Number of regions differ" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Overlaps
+  for (unsigned int row = 0; row < mat.Rows(); ++row)
+    {
+    for (unsigned int col = 0; col < mat.Cols(); ++col)
+      {
+      const unsigned int labelGT = gtMap->GetNthLabelObject(row)->GetLabel();
+      const unsigned int labelMS = msMap->GetNthLabelObject(col)->GetLabel();
+      if (streamingFilter->GetOverlap(labelGT, labelMS) != mat(row, col))
+        {
+        std::cerr << "Overlap (" << labelGT << ", " << labelMS << ") is "
+                  << streamingFilter->GetOverlap(labelGT, labelMS) << " instead of " << mat(row, col) << std::endl;
+        ++nbErrors;
+        }
+      }
+    }
+
+  // Scores of each region
+  const std::string nameRC = InstanceFilterType::GetNameFromAttribute(InstanceFilterType::ATTRIBUTE_RC);
+  const std::string nameRF = InstanceFilterType::GetNameFromAttribute(InstanceFilterType::ATTRIBUTE_RF);
+  const std::string nameRA = InstanceFilterType::GetNameFromAttribute(InstanceFilterType::ATTRIBUTE_RA);
+  const std::string nameRM = InstanceFilterType::GetNameFromAttribute(InstanceFilterType::ATTRIBUTE_RM);
+  const std::string nameRN = InstanceFilterType::GetNameFromAttribute(InstanceFilterType::ATTRIBUTE_RN);
+
+  const ScoresVectorType & scoresGT = streamingFilter->GetGroundTruthScores();
+  for (unsigned int row = 0; row < scoresGT.size(); ++row)
+    {
+    const LabelObjectType * region = gtMap->GetNthLabelObject(row);
+    if (!IsClose(scoresGT[row].RC, region->GetAttribute(nameRC.c_str()))
+        || !IsClose(scoresGT[row].RF, region->GetAttribute(nameRF.c_str()))
+        || !IsClose(scoresGT[row].RA, region->GetAttribute(nameRA.c_str()))
+        || !IsClose(scoresGT[row].RM, region->GetAttribute(nameRM.c_str())))
+      {
+      std::cerr << "Scores of GT region " << region->GetLabel() << " differ" << std::endl;
+      ++nbErrors;
+      }
+    }
+
+  const ScoresVectorType & scoresMS = streamingFilter->GetMachineSegmentationScores();
+  for (unsigned int col = 0; col < scoresMS.size(); ++col)
+    {
+    const LabelObjectType * region = msMap->GetNthLabelObject(col);
+    if (!IsClose(scoresMS[col].RC, region->GetAttribute(nameRC.c_str()))
+        || !IsClose(scoresMS[col].RF, region->GetAttribute(nameRF.c_str()))
+        || !IsClose(scoresMS[col].RA, region->GetAttribute(nameRA.c_str()))
+        || !IsClose(scoresMS[col].RN, region->GetAttribute(nameRN.c_str())))
+      {
+      std::cerr << "Scores of MS region " << region->GetLabel() << " differ" << std::endl;
+      ++nbErrors;
+      }
+    }
+
+  // Mean scores
+  if (!IsClose(streamingFilter->GetMeanRC(), instances->GetMeanRC())
+      || !IsClose(streamingFilter->GetMeanRF(), instances->GetMeanRF())
+      || !IsClose(streamingFilter->GetMeanRA(), instances->GetMeanRA())
+      || !IsClose(streamingFilter->GetMeanRM(), instances->GetMeanRM())
+      || !IsClose(streamingFilter->GetMeanRN(), instances->GetMeanRN()))
+    {
+    std::cerr << "Mean scores differ" << std::endl;
+    ++nbErrors;
+    }
+
+  std::cout << "Mean RC =" << streamingFilter->GetMeanRC() << std::endl;
+  std::cout << "Mean RF =" << streamingFilter->GetMeanRF() << std::endl;
+  std::cout << "Mean RA =" << streamingFilter->GetMeanRA() << std::endl;
+  std::cout << "Mean RM =" << streamingFilter->GetMeanRM() << std::endl;
+  std::cout << "Mean RN =" << streamingFilter->GetMeanRN() << std::endl;
+
+  return nbErrors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
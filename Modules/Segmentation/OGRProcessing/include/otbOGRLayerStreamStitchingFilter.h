@@ -29,8 +29,10 @@
 //#endif
 
 #include "itkProgressReporter.h"
+#include "itkMultiThreader.h"
 
 #include <algorithm>
+#include <vector>
 
 namespace otb
 {
@@ -47,6 +49,11 @@ namespace otb
  *  The input image is used to transform pixel coordinates of the streaming lines into
  *  coordinate system of the image, which must be the same as the one in the OGR input file.
  *  This filter is intended to be used after \c StreamingVectorizedSegmentationOGR.
+ *  When \c ParallelStitching is on, intersections along each stream line are computed
+ *  with the number of threads set by \c SetNumberOfThreads(), and the fusions are then
+ *  resolved sequentially along the line, so that the result does not depend on the number
+ *  of threads. Polygons fused along a stream line are then merged at once, so that the
+ *  output differs from the default sequential stitching.
  *  @see Example/StreamingMeanShiftSegmentation.cxx
  *
  *  \ingroup OBIA
@@ -105,6 +112,11 @@ public:
   /** Get stream size*/
   itkGetMacro(StreamSize, SizeType);
 
+  /** Set/Get whether stream lines are stitched in parallel (off by default) */
+  itkSetMacro(ParallelStitching, bool);
+  itkGetMacro(ParallelStitching, bool);
+  itkBooleanMacro(ParallelStitching);
+
   /** Generate Data method. This method must be called explicitly (not through the \c Update method). */
   void GenerateData() ITK_OVERRIDE;
 
@@ -126,6 +138,30 @@ protected:
      OGRFeatureType feat;
      bool fusioned;
   };
+  /** Feature intersecting the band around the current stream line */
+  struct BorderFeatureStruct
+  {
+     BorderFeatureStruct(const OGRFeatureType & feature) : feat(feature)
+     {
+       feat.GetGeometry()->getEnvelope(&envelope);
+     }
+     OGRFeatureType feat;
+     OGREnvelope envelope;
+  };
+  /** Segment of the current stream line, between two stream divisions */
+  struct StreamSegmentStruct
+  {
+     OriginType startPoint;
+     OriginType endPoint;
+     OGREnvelope upperEnvelope;
+     OGREnvelope lowerEnvelope;
+     /** Border features whose envelope is close to the segment */
+     std::vector<unsigned int> candidates;
+     /** Border features intersecting the upper/left spatial filter */
+     std::vector<unsigned int> upperFeatures;
+     /** Intersecting pairs of upper/left and lower/right features */
+     std::vector<FusionStruct> fusions;
+  };
   struct SortFeatureStruct
   {
      bool operator() (FusionStruct f1, FusionStruct f2) { return (f1.overlap > f2.overlap); }
@@ -135,6 +171,13 @@ protected:
    Main computation method. if line is true process row part, else process column part.
    */
   void ProcessStreamingLine(bool line, itk::ProgressReporter &progress);
+  /**
+   Parallel version of \c ProcessStreamingLine(). Each stream line is processed at once:
+   the border features are read with a single spatial filter, the intersections along the
+   stream line segments are computed in parallel, and the fused features are written in a
+   single transaction.
+   */
+  void ProcessStreamingLineParallel(bool line, itk::ProgressReporter &progress);
   /** get length in case of  OGRGeometryCollection.
    * This function recodes the get_lenght method available since gdal 1.8.0
    * in the case of OGRGeometryCollection. The aim is to allow accessing polygon stiching
@@ -142,6 +185,35 @@ protected:
    */
   double GetLengthOGRGeometryCollection(OGRGeometryCollection * intersection);
 
+  /** Find the upper/left and lower/right features of a segment and their overlap
+   * along the stream line. Segments are independent, so that this method is
+   * called concurrently on the segments of a stream line. */
+  void ComputeSegmentFusions(unsigned int segment);
+
+  /** Compute the length (or area) of the intersection of two features along the
+   * stream line. Return false if the intersection could not be computed. */
+  bool ComputeOverlap(const OGRGeometry & upper, const OGRGeometry & lower,
+                      const OGRLineString & streamLine, double & overlap);
+
+  /** Union of the geometries of a group of border features */
+  ogr::UniqueGeometryPtr MergeGeometries(const std::vector<unsigned int> & group) const;
+
+  /** Root of a border feature in the forest of fused features */
+  static unsigned int FindFusionRoot(std::vector<unsigned int> & parents, unsigned int i);
+
+  /** Envelope of a pixel rectangle of the input image, in physical coordinates */
+  OGREnvelope ComputeEnvelope(const IndexType & upperLeft, const IndexType & lowerRight) const;
+
+  /** Static functions used as "callbacks" for the MultiThreader. */
+  static ITK_THREAD_RETURN_TYPE FusionsThreaderCallback(void *arg);
+  static ITK_THREAD_RETURN_TYPE MergeThreaderCallback(void *arg);
+
+  /** Internal structure used for passing data into the threading library */
+  struct ThreadStruct
+  {
+    Pointer Filter;
+  };
+
 private:
   OGRLayerStreamStitchingFilter(const Self &);  //purposely not implemented
   void operator =(const Self&);      //purposely not implemented
@@ -149,6 +221,13 @@ private:
   SizeType m_StreamSize;
   unsigned int m_Radius;
   OGRLayerType m_OGRLayer;
+  bool m_ParallelStitching;
+
+  /** Working data of the stream line being processed */
+  std::vector<BorderFeatureStruct> m_BorderFeatures;
+  std::vector<StreamSegmentStruct> m_Segments;
+  std::vector<std::vector<unsigned int> > m_FusionGroups;
+  std::vector<OGRGeometry *> m_FusionGeometries;
 
 
 };
@@ -28,13 +28,15 @@
 #include "ogrsf_frmts.h"
 #include "itkTimeProbe.h"
 #include <set>
+#include <map>
+#include <cmath>
 
 namespace otb
 {
 
 template<class TImage>
 OGRLayerStreamStitchingFilter<TImage>
-::OGRLayerStreamStitchingFilter() : m_Radius(2), m_OGRLayer(ITK_NULLPTR, false)
+::OGRLayerStreamStitchingFilter() : m_Radius(2), m_OGRLayer(ITK_NULLPTR, false), m_ParallelStitching(false)
 {
    m_StreamSize.Fill(0);
 }
@@ -102,6 +104,249 @@ OGRLayerStreamStitchingFilter<TInputImage>
     }
   return dfLength;
 }
+template<class TInputImage>
+OGREnvelope
+OGRLayerStreamStitchingFilter<TInputImage>
+::ComputeEnvelope(const IndexType & upperLeft, const IndexType & lowerRight) const
+{
+  const InputImageType * inputImage = static_cast<const InputImageType *>(this->Superclass::GetInput(0));
+
+  OriginType  ulCorner;
+  inputImage->TransformIndexToPhysicalPoint(upperLeft, ulCorner);
+  OriginType  lrCorner;
+  inputImage->TransformIndexToPhysicalPoint(lowerRight, lrCorner);
+
+  OGREnvelope envelope;
+  envelope.MinX = std::min(ulCorner[0], lrCorner[0]);
+  envelope.MaxX = std::max(ulCorner[0], lrCorner[0]);
+  envelope.MinY = std::min(ulCorner[1], lrCorner[1]);
+  envelope.MaxY = std::max(ulCorner[1], lrCorner[1]);
+  return envelope;
+}
+
+template<class TInputImage>
+bool
+OGRLayerStreamStitchingFilter<TInputImage>
+::ComputeOverlap(const OGRGeometry & upper, const OGRGeometry & lower,
+                 const OGRLineString & streamLine, double & overlap)
+{
+  ogr::UniqueGeometryPtr intersection2 = ogr::Intersection(upper, lower);
+  if (!intersection2)
+    {
+    return false;
+    }
+  ogr::UniqueGeometryPtr intersection = ogr::Intersection(*intersection2, streamLine);
+  if (!intersection)
+    {
+    return false;
+    }
+
+  overlap = 0.;
+  if(intersection->getGeometryType() == wkbPolygon)
+    {
+    overlap = dynamic_cast<OGRPolygon *>(intersection.get())->get_Area();
+    }
+  else if(intersection->getGeometryType() == wkbMultiPolygon)
+    {
+    overlap = dynamic_cast<OGRMultiPolygon *>(intersection.get())->get_Area();
+    }
+  else if(intersection->getGeometryType() == wkbGeometryCollection)
+    {
+    overlap = dynamic_cast<OGRGeometryCollection *>(intersection.get())->get_Area();
+    }
+  else if(intersection->getGeometryType() == wkbLineString)
+    {
+    overlap = dynamic_cast<OGRLineString *>(intersection.get())->get_Length();
+    }
+  else if (intersection->getGeometryType() == wkbMultiLineString)
+    {
+#if(GDAL_VERSION_NUM < 1800)
+    overlap = GetLengthOGRGeometryCollection(dynamic_cast<OGRGeometryCollection *> (intersection.get()));
+#else
+    overlap = dynamic_cast<OGRMultiLineString *>(intersection.get())->get_Length();
+#endif
+    }
+  return true;
+}
+
+template<class TInputImage>
+void
+OGRLayerStreamStitchingFilter<TInputImage>
+::ComputeSegmentFusions(unsigned int segmentIndex)
+{
+  StreamSegmentStruct & segment = m_Segments[segmentIndex];
+
+  OGRLineString streamLine;
+  streamLine.addPoint(segment.startPoint[0], segment.startPoint[1]);
+  streamLine.addPoint(segment.endPoint[0], segment.endPoint[1]);
+
+  // Spatial filters of the upper/left and lower/right streams
+  OGRPolygon upperFilter;
+  OGRPolygon lowerFilter;
+  const OGREnvelope * envelopes[2] = {&segment.upperEnvelope, &segment.lowerEnvelope};
+  OGRPolygon * filters[2] = {&upperFilter, &lowerFilter};
+  for (unsigned int i = 0; i < 2; ++i)
+    {
+    OGRLinearRing ring;
+    ring.addPoint(envelopes[i]->MinX, envelopes[i]->MinY);
+    ring.addPoint(envelopes[i]->MaxX, envelopes[i]->MinY);
+    ring.addPoint(envelopes[i]->MaxX, envelopes[i]->MaxY);
+    ring.addPoint(envelopes[i]->MinX, envelopes[i]->MaxY);
+    ring.closeRings();
+    filters[i]->addRing(&ring);
+    }
+
+  // Features intersecting the upper filter are upper features only, as in
+  // two successive spatial filter requests on the layer
+  std::vector<unsigned int> lowerFeatures;
+  for (std::vector<unsigned int>::const_iterator it = segment.candidates.begin();
+       it != segment.candidates.end(); ++it)
+    {
+    const BorderFeatureStruct & border = m_BorderFeatures[*it];
+    if (border.envelope.Intersects(segment.upperEnvelope)
+        && ogr::Intersects(*border.feat.GetGeometry(), upperFilter))
+      {
+      segment.upperFeatures.push_back(*it);
+      }
+    else if (border.envelope.Intersects(segment.lowerEnvelope)
+             && ogr::Intersects(*border.feat.GetGeometry(), lowerFilter))
+      {
+      lowerFeatures.push_back(*it);
+      }
+    }
+
+  for (std::vector<unsigned int>::const_iterator u = segment.upperFeatures.begin();
+       u != segment.upperFeatures.end(); ++u)
+    {
+    const BorderFeatureStruct & upper = m_BorderFeatures[*u];
+    for (std::vector<unsigned int>::const_iterator l = lowerFeatures.begin();
+         l != lowerFeatures.end(); ++l)
+      {
+      const BorderFeatureStruct & lower = m_BorderFeatures[*l];
+      if (upper.envelope.Intersects(lower.envelope)
+          && ogr::Intersects(*upper.feat.GetGeometry(), *lower.feat.GetGeometry()))
+        {
+        FusionStruct fusion;
+        fusion.indStream1 = *u;
+        fusion.indStream2 = *l;
+        if (this->ComputeOverlap(*upper.feat.GetGeometry(), *lower.feat.GetGeometry(), streamLine, fusion.overlap))
+          {
+          segment.fusions.push_back(fusion);
+          }
+        }
+      }
+    }
+}
+
+template<class TInputImage>
+ogr::UniqueGeometryPtr
+OGRLayerStreamStitchingFilter<TInputImage>
+::MergeGeometries(const std::vector<unsigned int> & group) const
+{
+  if (group.size() == 2)
+    {
+    return ogr::Union(*m_BorderFeatures[group[0]].feat.GetGeometry(),
+                      *m_BorderFeatures[group[1]].feat.GetGeometry());
+    }
+
+  OGRMultiPolygon polygons;
+  bool onlyPolygons = true;
+  for (std::vector<unsigned int>::const_iterator it = group.begin(); it != group.end() && onlyPolygons; ++it)
+    {
+    const OGRGeometry * geometry = m_BorderFeatures[*it].feat.GetGeometry();
+    switch (wkbFlatten(geometry->getGeometryType()))
+      {
+      case wkbPolygon:
+        polygons.addGeometry(geometry);
+        break;
+      case wkbMultiPolygon:
+      {
+        const OGRMultiPolygon * multiPolygon = dynamic_cast<const OGRMultiPolygon *>(geometry);
+        for (int i = 0; i < multiPolygon->getNumGeometries(); ++i)
+          {
+          polygons.addGeometry(multiPolygon->getGeometryRef(i));
+          }
+        break;
+      }
+      default:
+        onlyPolygons = false;
+        break;
+      }
+    }
+
+  if (onlyPolygons)
+    {
+    return ogr::UnionCascaded(polygons);
+    }
+
+  // Fall back to successive unions
+  OGRGeometry * merged = m_BorderFeatures[group[0]].feat.GetGeometry()->clone();
+  for (unsigned int i = 1; i < group.size() && merged; ++i)
+    {
+    OGRGeometry * next = merged->Union(m_BorderFeatures[group[i]].feat.GetGeometry());
+    delete merged;
+    merged = next;
+    }
+  return ogr::UniqueGeometryPtr(merged);
+}
+
+template<class TInputImage>
+ITK_THREAD_RETURN_TYPE
+OGRLayerStreamStitchingFilter<TInputImage>
+::FusionsThreaderCallback(void *arg)
+{
+  ThreadStruct *str;
+  int           threadId, threadCount;
+
+  threadId = ((itk::MultiThreader::ThreadInfoStruct *) (arg))->ThreadID;
+  threadCount = ((itk::MultiThreader::ThreadInfoStruct *) (arg))->NumberOfThreads;
+  str = (ThreadStruct *) (((itk::MultiThreader::ThreadInfoStruct *) (arg))->UserData);
+
+  // Segments are dealt in turn, as the number of border features may vary a lot
+  // along the stream line
+  const unsigned int nbSegments = str->Filter->m_Segments.size();
+  for (unsigned int s = threadId; s < nbSegments; s += threadCount)
+    {
+    str->Filter->ComputeSegmentFusions(s);
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template<class TInputImage>
+ITK_THREAD_RETURN_TYPE
+OGRLayerStreamStitchingFilter<TInputImage>
+::MergeThreaderCallback(void *arg)
+{
+  ThreadStruct *str;
+  int           threadId, threadCount;
+
+  threadId = ((itk::MultiThreader::ThreadInfoStruct *) (arg))->ThreadID;
+  threadCount = ((itk::MultiThreader::ThreadInfoStruct *) (arg))->NumberOfThreads;
+  str = (ThreadStruct *) (((itk::MultiThreader::ThreadInfoStruct *) (arg))->UserData);
+
+  const unsigned int nbGroups = str->Filter->m_FusionGroups.size();
+  for (unsigned int g = threadId; g < nbGroups; g += threadCount)
+    {
+    str->Filter->m_FusionGeometries[g] = str->Filter->MergeGeometries(str->Filter->m_FusionGroups[g]).release();
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template<class TInputImage>
+unsigned int
+OGRLayerStreamStitchingFilter<TInputImage>
+::FindFusionRoot(std::vector<unsigned int> & parents, unsigned int i)
+{
+  while (parents[i] != i)
+    {
+    parents[i] = parents[parents[i]];
+    i = parents[i];
+    }
+  return i;
+}
+
 template<class TInputImage>
 void
 OGRLayerStreamStitchingFilter<TInputImage>
@@ -382,6 +627,303 @@ OGRLayerStreamStitchingFilter<TInputImage>
        }
      }
 }
+
+template<class TInputImage>
+void
+OGRLayerStreamStitchingFilter<TInputImage>
+::ProcessStreamingLineParallel( bool line, itk::ProgressReporter & progress)
+{
+   typename InputImageType::ConstPointer inputImage = this->GetInput();
+
+   //compute the number of stream division in row and column
+   SizeType imageSize = this->GetInput()->GetLargestPossibleRegion().GetSize();
+   unsigned int nbRowStream = static_cast<unsigned int>(imageSize[1] / m_StreamSize[1] + 1);
+   unsigned int nbColStream = static_cast<unsigned int>(imageSize[0] / m_StreamSize[0] + 1);
+
+   // Vertical stream lines are split in segments along rows, horizontal
+   // stream lines along columns
+   const unsigned int nbLines = line ? nbRowStream : nbColStream;
+   const unsigned int nbSegments = line ? nbColStream : nbRowStream;
+   const unsigned int axis = line ? 0 : 1;
+   const long segmentSize = static_cast<long>(m_StreamSize[axis]);
+
+   // Geometric operators of OGR are only reentrant since GDAL 2
+#ifdef OTB_USE_GDAL_20
+   const unsigned int nbThreads = this->GetNumberOfThreads();
+#else
+   const unsigned int nbThreads = 1;
+#endif
+   this->GetMultiThreader()->SetNumberOfThreads(nbThreads);
+
+   ThreadStruct str;
+   str.Filter = this;
+
+   for(unsigned int l=1; l<=nbLines; l++)
+   {
+     //Compute the stream line segments and the spatial filters on both sides
+     m_Segments.assign(nbSegments, StreamSegmentStruct());
+     OGREnvelope band;
+
+     for(unsigned int s=1; s<=nbSegments; s++)
+     {
+       const unsigned int x = line ? s : l;
+       const unsigned int y = line ? l : s;
+       StreamSegmentStruct & segment = m_Segments[s-1];
+
+       itk::ContinuousIndex<double,2> startIndex;
+       itk::ContinuousIndex<double,2> endIndex;
+       IndexType  UpperLeftCorner;
+       IndexType  LowerRightCorner;
+
+       if(!line)
+       {
+         // Treat vertical stream line
+         startIndex[0] = static_cast<double>(m_StreamSize[0] * x) - 0.5;
+         startIndex[1] = static_cast<double>(m_StreamSize[1] * (y-1)) - 0.5;
+         endIndex = startIndex;
+         endIndex[1] += static_cast<double>(m_StreamSize[1]);
+
+         //Compute the spatial filter of the upper stream
+         UpperLeftCorner[0] = x*m_StreamSize[0] - 1 - m_Radius;
+         UpperLeftCorner[1] = m_StreamSize[1]*(y-1);
+         LowerRightCorner[0] = m_StreamSize[0]*x - 1;
+         LowerRightCorner[1] = m_StreamSize[1]*y - 1;
+         segment.upperEnvelope = this->ComputeEnvelope(UpperLeftCorner, LowerRightCorner);
+
+         //Compute the spatial filter of the lower stream
+         UpperLeftCorner[0] = x*m_StreamSize[0];
+         LowerRightCorner[0] = m_StreamSize[0]*x + m_Radius;
+         segment.lowerEnvelope = this->ComputeEnvelope(UpperLeftCorner, LowerRightCorner);
+       }
+       else
+       {
+         // Treat horizontal stream line
+         startIndex[0] = static_cast<double>(m_StreamSize[0] * (x-1)) - 0.5;
+         startIndex[1] = static_cast<double>(m_StreamSize[1] * y) - 0.5;
+         endIndex = startIndex;
+         endIndex[0] += static_cast<double>(m_StreamSize[0]);
+
+         //Compute the spatial filter of the left stream
+         UpperLeftCorner[0] = (x-1)*m_StreamSize[0];
+         UpperLeftCorner[1] = m_StreamSize[1]*y - 1 - m_Radius;
+         LowerRightCorner[0] = m_StreamSize[0]*x - 1;
+         LowerRightCorner[1] = m_StreamSize[1]*y - 1; //-1 to stop just before stream line
+         segment.upperEnvelope = this->ComputeEnvelope(UpperLeftCorner, LowerRightCorner);
+
+         //Compute the spatial filter of the right stream
+         UpperLeftCorner[1] = m_StreamSize[1]*y;
+         LowerRightCorner[1] = m_StreamSize[1]*y + m_Radius;
+         segment.lowerEnvelope = this->ComputeEnvelope(UpperLeftCorner, LowerRightCorner);
+       }
+
+       inputImage->TransformContinuousIndexToPhysicalPoint(startIndex, segment.startPoint);
+       inputImage->TransformContinuousIndexToPhysicalPoint(endIndex, segment.endPoint);
+
+       band.Merge(segment.upperEnvelope);
+       band.Merge(segment.lowerEnvelope);
+     }
+
+     //Get all the features along the stream line with a single request, and
+     //dispatch them to the segments they may intersect
+     m_BorderFeatures.clear();
+     m_OGRLayer.SetSpatialFilterRect(band.MinX, band.MinY, band.MaxX, band.MaxY);
+
+     for(OGRLayerType::const_iterator featIt = m_OGRLayer.begin(); featIt!=m_OGRLayer.end(); ++featIt)
+     {
+       if (!(*featIt).GetGeometry())
+       {
+         continue;
+       }
+       const unsigned int ind = m_BorderFeatures.size();
+       m_BorderFeatures.push_back(BorderFeatureStruct(*featIt));
+       const OGREnvelope & envelope = m_BorderFeatures.back().envelope;
+
+       OriginType minPoint;
+       minPoint[0] = envelope.MinX;
+       minPoint[1] = envelope.MinY;
+       OriginType maxPoint;
+       maxPoint[0] = envelope.MaxX;
+       maxPoint[1] = envelope.MaxY;
+       itk::ContinuousIndex<double,2> minIndex;
+       itk::ContinuousIndex<double,2> maxIndex;
+       inputImage->TransformPhysicalPointToContinuousIndex(minPoint, minIndex);
+       inputImage->TransformPhysicalPointToContinuousIndex(maxPoint, maxIndex);
+
+       // Segments are indexed from 1, with one extra segment on each side
+       // to be safe with respect to rounding
+       const double lower = std::min(minIndex[axis], maxIndex[axis]) + 0.5;
+       const double upper = std::max(minIndex[axis], maxIndex[axis]) + 0.5;
+       const long first = std::max(static_cast<long>(std::floor(lower / segmentSize)), 1L);
+       const long last = std::min(static_cast<long>(std::floor(upper / segmentSize)) + 2,
+                                  static_cast<long>(nbSegments));
+       for (long s = first; s <= last; ++s)
+       {
+         m_Segments[s-1].candidates.push_back(ind);
+       }
+     }
+     m_OGRLayer.SetSpatialFilter(ITK_NULLPTR);
+
+     //Compute the intersections of all segments in parallel
+     this->GetMultiThreader()->SetSingleMethod(this->FusionsThreaderCallback, &str);
+     this->GetMultiThreader()->SingleMethodExecute();
+
+     //Resolve fusions segment after segment. Features already fused along the
+     //stream line are handled as a single polygon, represented by the root of
+     //their group.
+     std::vector<unsigned int> parents(m_BorderFeatures.size());
+     for (unsigned int i = 0; i < parents.size(); ++i)
+     {
+       parents[i] = i;
+     }
+
+     for (unsigned int s = 0; s < nbSegments; ++s)
+     {
+       const StreamSegmentStruct & segment = m_Segments[s];
+
+       std::set<unsigned int> upperRoots;
+       for (unsigned int i = 0; i < segment.upperFeatures.size(); ++i)
+       {
+         upperRoots.insert(FindFusionRoot(parents, segment.upperFeatures[i]));
+       }
+
+       // Overlaps are accumulated between groups
+       typedef std::map<std::pair<unsigned int, unsigned int>, double> GroupOverlapMapType;
+       GroupOverlapMapType groupOverlaps;
+       for (unsigned int i = 0; i < segment.fusions.size(); ++i)
+       {
+         const unsigned int upperRoot = FindFusionRoot(parents, segment.fusions[i].indStream1);
+         const unsigned int lowerRoot = FindFusionRoot(parents, segment.fusions[i].indStream2);
+         if (upperRoot != lowerRoot && upperRoots.find(lowerRoot) == upperRoots.end())
+         {
+           groupOverlaps[std::make_pair(upperRoot, lowerRoot)] += segment.fusions[i].overlap;
+         }
+       }
+
+       std::vector<FusionStruct> fusionList;
+       for (typename GroupOverlapMapType::const_iterator it = groupOverlaps.begin(); it != groupOverlaps.end(); ++it)
+       {
+         FusionStruct fusion;
+         fusion.indStream1 = it->first.first;
+         fusion.indStream2 = it->first.second;
+         fusion.overlap = it->second;
+         fusionList.push_back(fusion);
+       }
+       std::stable_sort(fusionList.begin(),fusionList.end(),SortFeature);
+
+       std::set<unsigned int> fusioned;
+       for (unsigned int i = 0; i < fusionList.size(); ++i)
+       {
+         if (fusioned.find(fusionList[i].indStream1) == fusioned.end()
+             && fusioned.find(fusionList[i].indStream2) == fusioned.end())
+         {
+           fusioned.insert(fusionList[i].indStream1);
+           fusioned.insert(fusionList[i].indStream2);
+           // The upper/left polygon gives its field to the fusion
+           parents[fusionList[i].indStream2] = fusionList[i].indStream1;
+         }
+       }
+
+       // Update progress
+       progress.CompletedPixel();
+     }
+
+     //Compute the fused geometries in parallel
+     std::map<unsigned int, std::vector<unsigned int> > groups;
+     for (unsigned int i = 0; i < parents.size(); ++i)
+     {
+       const unsigned int root = FindFusionRoot(parents, i);
+       if (root != i)
+       {
+         std::vector<unsigned int> & group = groups[root];
+         if (group.empty())
+         {
+           group.push_back(root);
+         }
+         group.push_back(i);
+       }
+     }
+
+     m_FusionGroups.clear();
+     for (std::map<unsigned int, std::vector<unsigned int> >::const_iterator it = groups.begin(); it != groups.end(); ++it)
+     {
+       m_FusionGroups.push_back(it->second);
+     }
+     m_FusionGeometries.assign(m_FusionGroups.size(), ITK_NULLPTR);
+
+     this->GetMultiThreader()->SetSingleMethod(this->MergeThreaderCallback, &str);
+     this->GetMultiThreader()->SingleMethodExecute();
+
+     //Rewrite the fused features in a single transaction
+     OGRErr errStart = m_OGRLayer.ogr().StartTransaction();
+
+     if (errStart != OGRERR_NONE)
+     {
+       itkExceptionMacro(<< "Unable to start transaction for OGR layer " << m_OGRLayer.ogr().GetName() << ".");
+     }
+
+     for (unsigned int g = 0; g < m_FusionGroups.size(); ++g)
+     {
+       ogr::UniqueGeometryPtr fusionPolygon(m_FusionGeometries[g]);
+       m_FusionGeometries[g] = ITK_NULLPTR;
+       if (!fusionPolygon)
+       {
+         otbWarningMacro(<<"Unable to compute the fusion of " << m_FusionGroups[g].size() << " polygons.");
+         continue;
+       }
+
+       const std::vector<unsigned int> & group = m_FusionGroups[g];
+       OGRFeatureType fusionFeature(m_OGRLayer.GetLayerDefn());
+       fusionFeature.SetGeometry( fusionPolygon.get() );
+
+       ogr::Field field = m_BorderFeatures[group[0]].feat[0];
+       try
+       {
+#ifdef OTB_USE_GDAL_20
+         // In this case, the feature id can be either
+         // OFTInteger64 or OFTInteger
+         switch(field.GetType())
+         {
+           case OFTInteger64:
+           {
+             fusionFeature[0].SetValue(field.GetValue<GIntBig>());
+             break;
+           }
+           default:
+           {
+             fusionFeature[0].SetValue(field.GetValue<int>());
+           }
+         }
+#else
+         // Only OFTInteger supported in this case
+         fusionFeature[0].SetValue(field.GetValue<int>());
+#endif
+         m_OGRLayer.CreateFeature(fusionFeature);
+         for (unsigned int i = 0; i < group.size(); ++i)
+         {
+           m_OGRLayer.DeleteFeature(m_BorderFeatures[group[i]].feat.GetFID());
+         }
+       }
+       catch(itk::ExceptionObject& err)
+       {
+         otbWarningMacro(<<"An exception was caught during fusion: "<<err);
+       }
+     }
+
+     if(m_OGRLayer.ogr().TestCapability("Transactions"))
+     {
+       OGRErr errCommit = m_OGRLayer.ogr().CommitTransaction();
+       if (errCommit != OGRERR_NONE)
+       {
+         itkExceptionMacro(<< "Unable to commit transaction for OGR layer " << m_OGRLayer.ogr().GetName() << ".");
+       }
+     }
+   }
+
+   m_BorderFeatures.clear();
+   m_Segments.clear();
+   m_FusionGroups.clear();
+}
+
 template<class TImage>
 void
 OGRLayerStreamStitchingFilter<TImage>
@@ -402,10 +944,20 @@ OGRLayerStreamStitchingFilter<TImage>
    unsigned int nbColStream = static_cast<unsigned int>(imageSize[0] / m_StreamSize[0] + 1);
 
    itk::ProgressReporter progress(this,0,2*nbRowStream*nbColStream,100,0);
-   //Process column
-   this->ProcessStreamingLine(false, progress);
-   //Process row
-   this->ProcessStreamingLine(true, progress);
+   if (m_ParallelStitching)
+   {
+     //Process column
+     this->ProcessStreamingLineParallel(false, progress);
+     //Process row
+     this->ProcessStreamingLineParallel(true, progress);
+   }
+   else
+   {
+     //Process column
+     this->ProcessStreamingLine(false, progress);
+     //Process row
+     this->ProcessStreamingLine(true, progress);
+   }
 
    this->InvokeEvent(itk::EndEvent());
 }
@@ -31,6 +31,12 @@
 #include "otbLabeledOutputAccessor.h"
 
 #include "otbMeanShiftSmoothingImageFilter.h"
+#include "itkMultiThreader.h"
+#include "itkVariableLengthVector.h"
+
+#include <map>
+#include <set>
+#include <vector>
 
 namespace otb
 {
@@ -49,6 +55,38 @@ class LabeledOutputAccessor<MeanShiftSmoothingImageFilter<TInputImage, TOutputIm
       itkStaticConstMacro(LabeledOutputIndex, unsigned int, 0);
 };
 
+template <class TInputImage, class TOutputLabelImage> class WatershedSegmentationFilter;
+
+/**
+ * \class OverlappingTilesSegmentationTraits
+ * \brief Tells whether a segmentation filter can segment overlapping tiles.
+ *
+ * Segments of neighbour tiles are merged as basins, and tiles are segmented
+ * by clones of the segmentation filter, which must copy its parameters in
+ * InternalClone(). Only the watershed segmentation supports it.
+ *
+ * \ingroup OTBOGRProcessing
+ */
+template <class TFilter>
+class OverlappingTilesSegmentationTraits
+{
+   public:
+      itkStaticConstMacro(IsSupported, bool, false);
+};
+
+/**
+ * \class OverlappingTilesSegmentationTraits
+ * \brief Specialized class for the watershed segmentation.
+ *
+ * \ingroup OTBOGRProcessing
+ */
+template <class TInputImage, class TOutputLabelImage>
+class OverlappingTilesSegmentationTraits<WatershedSegmentationFilter<TInputImage, TOutputLabelImage> >
+{
+   public:
+      itkStaticConstMacro(IsSupported, bool, true);
+};
+
 /** \class PersistentStreamingLabelImageToOGRDataFilter
  * \brief This filter is a framework for large scale segmentation.
  * For a detailed description @see StreamingImageToOGRLayerSegmentationFilter
@@ -68,6 +106,9 @@ public:
 
   typedef typename Superclass::InputImageType              InputImageType;
   typedef typename Superclass::InputImagePointer           InputImagePointerType;
+  typedef typename Superclass::RegionType                  RegionType;
+  typedef typename Superclass::IndexType                   IndexType;
+  typedef typename IndexType::IndexValueType               IndexValueType;
 
   typedef TSegmentationFilter                              SegmentationFilterType;
   typedef typename LabeledOutputAccessor<SegmentationFilterType>::LabelImageType  LabelImageType;
@@ -77,6 +118,7 @@ public:
   typedef typename Superclass::OGRDataSourceType                        OGRDataSourceType;
   typedef typename Superclass::OGRDataSourcePointerType                 OGRDataSourcePointerType;
   typedef typename Superclass::OGRLayerType                             OGRLayerType;
+  typedef typename Superclass::OGRFeatureType                           OGRFeatureType;
 
   typedef RelabelComponentImageFilter<LabelImageType,LabelImageType>    RelabelComponentImageFilterType;
   typedef itk::MultiplyImageFilter<LabelImageType,LabelImageType,LabelImageType>  MultiplyImageFilterType;
@@ -141,11 +183,43 @@ public:
   virtual void SetInputMask(const LabelImageType *mask);
   virtual const LabelImageType * GetInputMask(void);
 
+  /** Set the overlap between streamed tiles, in pixels (default is 0).
+   * With a positive overlap, each tile is segmented with a margin of this
+   * size around it, and only its core is vectorized. Segments on both sides
+   * of a tile border are then merged as basins: the lowest pass between
+   * them is compared to the higher of their minima, and they are merged if
+   * the difference is not above SeamMergeLevel. Polygons of merged segments
+   * are dissolved as soon as no tile can be merged with them anymore, which
+   * makes the stitching step unnecessary. An exception is thrown if the
+   * segmentation filter does not support it, see
+   * \c OverlappingTilesSegmentationTraits.
+   */
+  itkSetMacro(TileOverlap, unsigned int);
+  itkGetMacro(TileOverlap, unsigned int);
+
+  /** Set the size of the tiles segmented in parallel when TileOverlap is
+   * positive (default is 0: each streamed piece is segmented as one tile).
+   * Tiles are segmented by clones of the segmentation filter, which must
+   * copy its parameters in InternalClone(), using one thread each. */
+  itkSetMacro(TileSize, unsigned int);
+  itkGetMacro(TileSize, unsigned int);
+
+  /** Set the highest saliency of a pass between two segments of
+   * neighbour tiles for them to be merged (default is 0: only segments of
+   * a basin cut by the tile border are merged). It is in the unit of the
+   * input pixels, or of their norm for vector images. */
+  itkSetMacro(SeamMergeLevel, double);
+  itkGetMacro(SeamMergeLevel, double);
+  void Reset(void) ITK_OVERRIDE;
+  void Synthetize(void) ITK_OVERRIDE;
+
 protected:
   PersistentImageToOGRLayerSegmentationFilter();
 
   ~PersistentImageToOGRLayerSegmentationFilter() ITK_OVERRIDE;
 
+  /** Pad the requested region of the input image by the tile overlap */
+  void GenerateInputRequestedRegion() ITK_OVERRIDE;
 
 private:
   PersistentImageToOGRLayerSegmentationFilter(const Self &); //purposely not implemented
@@ -153,6 +227,77 @@ private:
 
   OGRDataSourcePointerType ProcessTile() ITK_OVERRIDE;
 
+  /** Labels and heights along the last column or row of a tile core,
+   * starting at index Begin on the other axis */
+  struct Strip
+  {
+    IndexValueType              Begin;
+    std::vector<LabelPixelType> Labels;
+    std::vector<float>          Heights;
+  };
+  typedef std::map<IndexValueType, std::vector<Strip> >              StripMapType;
+  typedef std::map<LabelPixelType, LabelPixelType>                   LabelParentMapType;
+  typedef std::set<LabelPixelType>                                   LabelSetType;
+  typedef std::map<LabelPixelType, double>                           LabelMinimumMapType;
+  typedef std::pair<LabelPixelType, LabelPixelType>                  LabelPairType;
+  typedef std::map<LabelPairType, double>                            PassMapType;
+
+  /** Segment the tiles of the piece, then merge their segments across
+   * tile borders. Labels of the piece cores are written in m_PieceLabels. */
+  void SegmentPieceTiles(const RegionType & piece);
+
+  /** Static function used as a "callback" by the MultiThreader */
+  static ITK_THREAD_RETURN_TYPE SegmentationThreaderCallback(void *arg);
+
+  void SegmentTilesForThread(itk::ThreadIdType threadId, itk::ThreadIdType threadCount);
+
+  /** Segment one tile with its margin, and write its core labels,
+   * numbered from 0, in m_PieceLabels */
+  void SegmentTile(unsigned int tile, bool useOwnFilter);
+
+  /** Accumulate the passes between the labels of a strip and the labels
+   * of the piece along a line starting at index and going in direction
+   * axis, on [begin, end). Labels of the tile starting at firstLabel
+   * are marked as seam labels. */
+  void AddSeamPasses(const std::vector<Strip> & strips, IndexType index, unsigned int axis,
+                     IndexValueType begin, IndexValueType end, const std::vector<double> & minima,
+                     LabelPixelType firstLabel, PassMapType & passes);
+
+  /** Store the labels and heights of the piece along a line */
+  void StoreStrip(std::vector<Strip> & strips, IndexType index, unsigned int axis,
+                  IndexValueType begin, IndexValueType end, const std::vector<double> & minima,
+                  LabelPixelType firstLabel);
+
+  /** Merge the labels of the passes by increasing saliency */
+  void MergeSeamPasses(const PassMapType & passes);
+
+  LabelPixelType FindLabelRoot(LabelPixelType label);
+  void MergeLabels(LabelPixelType label1, LabelPixelType label2);
+
+  /** Height of a pixel in the seam saliency */
+  template <class TPixel>
+  static double GetPixelHeight(const TPixel & pixel)
+  {
+    return static_cast<double>(pixel);
+  }
+  template <class TValue>
+  static double GetPixelHeight(const itk::VariableLengthVector<TValue> & pixel)
+  {
+    return pixel.GetNorm();
+  }
+
+  /** Read/write a label in an integer field */
+  static LabelPixelType GetFieldLabel(const ogr::Field & field);
+  static void SetFieldLabel(ogr::Field field, LabelPixelType label);
+
+  /** Union of the geometries of features sharing the same label */
+  static OGRGeometry * DissolveGeometries(const std::vector<OGRFeatureType> & features);
+
+  /** Write the dissolved polygons of the merged regions which can not be
+   * merged with the next tiles anymore (all of them if flushAll is true)
+   * in layer, and forget their labels. */
+  void FlushSeamRegions(OGRLayerType & layer, bool flushAll);
+
 
   int m_TileMaxLabel;
   LabelPixelType m_StartLabel;
@@ -167,7 +312,24 @@ private:
   bool m_Simplify;
   double m_SimplificationTolerance;
 
-
+  unsigned int m_TileOverlap;
+  unsigned int m_TileSize;
+  double       m_SeamMergeLevel;
+
+  /** Strips of the last column and row of the tiles, by column and row */
+  StripMapType        m_ColumnStrips;
+  StripMapType        m_RowStrips;
+  LabelParentMapType  m_LabelParents;
+  LabelMinimumMapType m_LabelMinima;
+  LabelSetType        m_SeamLabels;
+  /** Polygons of the seam labels, until their region is complete */
+  std::map<LabelPixelType, std::vector<OGRFeatureType> > m_SeamFeatures;
+
+  /** Data of the piece being segmented by tiles */
+  typename InputImageType::Pointer    m_PieceImage;
+  typename LabelImageType::Pointer    m_PieceLabels;
+  std::vector<RegionType>             m_PieceTiles;
+  std::vector<std::vector<double> >   m_TileMinima;
 };
 
 /** \class StreamingImageToOGRLayerSegmentationFilter
@@ -190,6 +352,15 @@ private:
  * can create cross polygons !
  * \note The input mask can be used to exclude pixels from vectorization process.
  * All pixels with a value of 0 in the input mask image will not be suitable for vectorization.
+ * \note With a positive TileOverlap, each streamed piece is cut into tiles of TileSize
+ * pixels, segmented in parallel with a margin of TileOverlap pixels. Segments on both
+ * sides of tile borders are merged when the saliency of their lowest pass is not above
+ * SeamMergeLevel, so that the output layer has no seams along tile borders. Only the last
+ * column and row of each tile are kept to merge segments with the next tiles, and pieces
+ * must be streamed in raster order. Segmentation parameters relative to the input content
+ * (such as the watershed threshold and level) must be given for the whole image, see
+ * \c WatershedSegmentationFilter::SetInputMinimum(). Simplification and small object
+ * filtering of polygons crossing tile borders are done after their dissolve.
  *
  * \ingroup OTBOGRProcessing
  */
@@ -344,6 +515,36 @@ public:
   {
      return this->GetFilter()->GetSimplificationTolerance();
   }
+  /** Set the overlap between streamed tiles, in pixels (default is 0). */
+  void SetTileOverlap(unsigned int overlap)
+  {
+     this->GetFilter()->SetTileOverlap(overlap);
+  }
+
+  unsigned int GetTileOverlap()
+  {
+     return this->GetFilter()->GetTileOverlap();
+  }
+  /** Set the size of the tiles segmented in parallel (default is 0). */
+  void SetTileSize(unsigned int size)
+  {
+     this->GetFilter()->SetTileSize(size);
+  }
+
+  unsigned int GetTileSize()
+  {
+     return this->GetFilter()->GetTileSize();
+  }
+  /** Set the highest saliency of merged passes across tile borders (default is 0). */
+  void SetSeamMergeLevel(double level)
+  {
+     this->GetFilter()->SetSeamMergeLevel(level);
+  }
+
+  double GetSeamMergeLevel()
+  {
+     return this->GetFilter()->GetSeamMergeLevel();
+  }
 
 protected:
   /** Constructor */
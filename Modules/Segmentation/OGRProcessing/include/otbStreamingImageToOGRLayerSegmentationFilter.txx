@@ -27,9 +27,14 @@
 #include "otbVectorDataTransformFilter.h"
 #include "itkAffineTransform.h"
 
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
 #include "itkTimeProbe.h"
 #include "otbMacro.h"
+#include "otbOGRHelpers.h"
 #include <cassert>
+#include <functional>
+#include <queue>
 
 namespace otb
 {
@@ -37,7 +42,8 @@ namespace otb
 template <class TImageType, class TSegmentationFilter>
 PersistentImageToOGRLayerSegmentationFilter<TImageType, TSegmentationFilter>
 ::PersistentImageToOGRLayerSegmentationFilter() : m_TileMaxLabel(0), m_StartLabel(0), m_SegmentationFilter(), m_FieldName("DN"), m_Use8Connected(false),
-  m_FilterSmallObject(false), m_MinimumObjectSize(1),m_Simplify(false), m_SimplificationTolerance(0.3)
+  m_FilterSmallObject(false), m_MinimumObjectSize(1),m_Simplify(false), m_SimplificationTolerance(0.3),
+  m_TileOverlap(0), m_TileSize(0), m_SeamMergeLevel(0.)
 {
    this->SetNumberOfRequiredInputs(2);
    this->SetNumberOfRequiredInputs(1);
@@ -69,6 +75,679 @@ PersistentImageToOGRLayerSegmentationFilter<TImageType, TSegmentationFilter>
 }
 
 
+template <class TImageType, class TSegmentationFilter>
+void
+PersistentImageToOGRLayerSegmentationFilter<TImageType, TSegmentationFilter>
+::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  InputImageType * input = const_cast<InputImageType *>(this->GetInput());
+  if (m_TileOverlap == 0 || !input)
+    {
+    return;
+    }
+
+  // Only the image to segment is padded, the mask is used on the tile itself
+  RegionType region = this->GetOutput()->GetRequestedRegion();
+  region.PadByRadius(m_TileOverlap);
+  region.Crop(input->GetLargestPossibleRegion());
+  input->SetRequestedRegion(region);
+}
+
+template <class TImageType, class TSegmentationFilter>
+void
+PersistentImageToOGRLayerSegmentationFilter<TImageType, TSegmentationFilter>
+::Reset()
+{
+  Superclass::Reset();
+
+  m_ColumnStrips.clear();
+  m_RowStrips.clear();
+  m_LabelParents.clear();
+  m_LabelMinima.clear();
+  m_SeamLabels.clear();
+  m_SeamFeatures.clear();
+}
+
+template <class TImageType, class TSegmentationFilter>
+typename PersistentImageToOGRLayerSegmentationFilter<TImageType, TSegmentationFilter>::LabelPixelType
+PersistentImageToOGRLayerSegmentationFilter<TImageType, TSegmentationFilter>
+::FindLabelRoot(LabelPixelType label)
+{
+  LabelPixelType root = label;
+  typename LabelParentMapType::const_iterator parentIt = m_LabelParents.find(root);
+  while (parentIt != m_LabelParents.end())
+    {
+    root = parentIt->second;
+    parentIt = m_LabelParents.find(root);
+    }
+
+  // Path compression
+  while (label != root)
+    {
+    LabelPixelType & parent = m_LabelParents[label];
+    label = parent;
+    parent = root;
+    }
+  return root;
+}
+
+template <class TImageType, class TSegmentationFilter>
+void
+PersistentImageToOGRLayerSegmentationFilter<TImageType, TSegmentationFilter>
+::MergeLabels(LabelPixelType label1, LabelPixelType label2)
+{
+  const LabelPixelType root1 = this->FindLabelRoot(label1);
+  const LabelPixelType root2 = this->FindLabelRoot(label2);
+  if (root1 == root2)
+    {
+    return;
+    }
+
+  // The lowest label is kept for the merged region, with the lowest minimum
+  const LabelPixelType root = std::min(root1, root2);
+  const LabelPixelType child = std::max(root1, root2);
+  m_LabelParents[child] = root;
+
+  typename LabelMinimumMapType::iterator childIt = m_LabelMinima.find(child);
+  if (childIt != m_LabelMinima.end())
+    {
+    typename LabelMinimumMapType::iterator rootIt = m_LabelMinima.find(root);
+    if (rootIt == m_LabelMinima.end())
+      {
+      m_LabelMinima[root] = childIt->second;
+      }
+    else
+      {
+      rootIt->second = std::min(rootIt->second, childIt->second);
+      }
+    m_LabelMinima.erase(childIt);
+    }
+}
+
+template <class TImageType, class TSegmentationFilter>
+ITK_THREAD_RETURN_TYPE
+PersistentImageToOGRLayerSegmentationFilter<TImageType, TSegmentationFilter>
+::SegmentationThreaderCallback(void *arg)
+{
+  itk::ThreadIdType threadId = ((itk::MultiThreader::ThreadInfoStruct *) (arg))->ThreadID;
+  itk::ThreadIdType threadCount = ((itk::MultiThreader::ThreadInfoStruct *) (arg))->NumberOfThreads;
+  Self * filter = (Self *) (((itk::MultiThreader::ThreadInfoStruct *) (arg))->UserData);
+
+  filter->SegmentTilesForThread(threadId, threadCount);
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template <class TImageType, class TSegmentationFilter>
+void
+PersistentImageToOGRLayerSegmentationFilter<TImageType, TSegmentationFilter>
+::SegmentTilesForThread(itk::ThreadIdType threadId, itk::ThreadIdType threadCount)
+{
+  for (unsigned int tile = threadId; tile < m_PieceTiles.size(); tile += threadCount)
+    {
+    this->SegmentTile(tile, false);
+    }
+}
+
+template <class TImageType, class TSegmentationFilter>
+void
+PersistentImageToOGRLayerSegmentationFilter<TImageType, TSegmentationFilter>
+::SegmentTile(unsigned int tile, bool useOwnFilter)
+{
+  const RegionType & core = m_PieceTiles[tile];
+
+  RegionType paddedRegion = core;
+  paddedRegion.PadByRadius(m_TileOverlap);
+  paddedRegion.Crop(m_PieceImage->GetBufferedRegion());
+
+  // Copy the padded tile in a standalone image, so that the segmentation
+  // filter is not connected to the pipeline
+  typename InputImageType::Pointer tileImage = InputImageType::New();
+  tileImage->CopyInformation(m_PieceImage);
+  tileImage->SetRegions(paddedRegion);
+  tileImage->Allocate();
+
+  itk::ImageRegionConstIterator<InputImageType> pieceIt(m_PieceImage, paddedRegion);
+  itk::ImageRegionIterator<InputImageType> tileIt(tileImage, paddedRegion);
+  for (pieceIt.GoToBegin(), tileIt.GoToBegin(); !pieceIt.IsAtEnd(); ++pieceIt, ++tileIt)
+    {
+    tileIt.Set(pieceIt.Get());
+    }
+
+  typename SegmentationFilterType::Pointer segmentationFilter = m_SegmentationFilter;
+  if (!useOwnFilter)
+    {
+    // Tiles are segmented concurrently, by single threaded clones
+    itk::LightObject::Pointer clone = m_SegmentationFilter->Clone();
+    segmentationFilter = dynamic_cast<SegmentationFilterType *>(clone.GetPointer());
+    segmentationFilter->SetNumberOfThreads(1);
+    }
+  segmentationFilter->SetInput(tileImage);
+  segmentationFilter->UpdateLargestPossibleRegion();
+
+  const unsigned int labelImageIndex = LabeledOutputAccessor<SegmentationFilterType>::LabeledOutputIndex;
+  const LabelImageType * labelImage =
+    dynamic_cast<const LabelImageType *>(segmentationFilter->GetOutputs().at(labelImageIndex).GetPointer());
+
+  // Number the segments of the core from 0, and record their minima
+  std::map<LabelPixelType, LabelPixelType> coreLabels;
+  std::vector<double> & minima = m_TileMinima[tile];
+  minima.clear();
+
+  itk::ImageRegionConstIterator<LabelImageType> labelIt(labelImage, core);
+  itk::ImageRegionConstIterator<InputImageType> heightIt(tileImage, core);
+  itk::ImageRegionIterator<LabelImageType> outIt(m_PieceLabels, core);
+  for (labelIt.GoToBegin(), heightIt.GoToBegin(), outIt.GoToBegin(); !labelIt.IsAtEnd(); ++labelIt, ++heightIt, ++outIt)
+    {
+    const double height = GetPixelHeight(heightIt.Get());
+    typename std::map<LabelPixelType, LabelPixelType>::const_iterator coreIt = coreLabels.find(labelIt.Get());
+    if (coreIt == coreLabels.end())
+      {
+      const LabelPixelType coreLabel = static_cast<LabelPixelType>(minima.size());
+      coreLabels[labelIt.Get()] = coreLabel;
+      minima.push_back(height);
+      outIt.Set(coreLabel);
+      }
+    else
+      {
+      minima[coreIt->second] = std::min(minima[coreIt->second], height);
+      outIt.Set(coreIt->second);
+      }
+    }
+}
+
+template <class TImageType, class TSegmentationFilter>
+void
+PersistentImageToOGRLayerSegmentationFilter<TImageType, TSegmentationFilter>
+::AddSeamPasses(const std::vector<Strip> & strips, IndexType index, unsigned int axis,
+                IndexValueType begin, IndexValueType end, const std::vector<double> & minima,
+                LabelPixelType firstLabel, PassMapType & passes)
+{
+  for (typename std::vector<Strip>::const_iterator stripIt = strips.begin(); stripIt != strips.end(); ++stripIt)
+    {
+    const IndexValueType stripEnd = stripIt->Begin + static_cast<IndexValueType>(stripIt->Labels.size());
+    for (IndexValueType i = std::max(begin, stripIt->Begin); i < std::min(end, stripEnd); ++i)
+      {
+      index[axis] = i;
+      const LabelPixelType label1 = stripIt->Labels[i - stripIt->Begin];
+      const LabelPixelType label2 = m_PieceLabels->GetPixel(index);
+      const double pass = std::max(static_cast<double>(stripIt->Heights[i - stripIt->Begin]),
+                                   GetPixelHeight(m_PieceImage->GetPixel(index)));
+
+      // Polygons of the labels of the tile may be merged
+      if (m_SeamLabels.insert(label2).second)
+        {
+        m_LabelMinima[label2] = minima[label2 - firstLabel];
+        }
+
+      const LabelPairType key(std::min(label1, label2), std::max(label1, label2));
+      typename PassMapType::iterator passIt = passes.find(key);
+      if (passIt == passes.end())
+        {
+        passes[key] = pass;
+        }
+      else if (pass < passIt->second)
+        {
+        passIt->second = pass;
+        }
+      }
+    }
+}
+
+template <class TImageType, class TSegmentationFilter>
+void
+PersistentImageToOGRLayerSegmentationFilter<TImageType, TSegmentationFilter>
+::StoreStrip(std::vector<Strip> & strips, IndexType index, unsigned int axis,
+             IndexValueType begin, IndexValueType end, const std::vector<double> & minima,
+             LabelPixelType firstLabel)
+{
+  strips.push_back(Strip());
+  Strip & strip = strips.back();
+  strip.Begin = begin;
+  strip.Labels.reserve(end - begin);
+  strip.Heights.reserve(end - begin);
+
+  for (IndexValueType i = begin; i < end; ++i)
+    {
+    index[axis] = i;
+    const LabelPixelType label = m_PieceLabels->GetPixel(index);
+    strip.Labels.push_back(label);
+    strip.Heights.push_back(static_cast<float>(GetPixelHeight(m_PieceImage->GetPixel(index))));
+
+    // Polygons of these labels may be merged with the next tiles
+    if (m_SeamLabels.insert(label).second)
+      {
+      m_LabelMinima[label] = minima[label - firstLabel];
+      }
+    }
+}
+
+template <class TImageType, class TSegmentationFilter>
+void
+PersistentImageToOGRLayerSegmentationFilter<TImageType, TSegmentationFilter>
+::MergeSeamPasses(const PassMapType & passes)
+{
+  // Passes are processed by increasing saliency, which is the height of the
+  // pass above the higher of the minima of the two regions. Saliencies can
+  // only increase as regions are merged, so that outdated entries of the
+  // queue are pushed back with their new value.
+  typedef std::pair<double, std::pair<double, LabelPairType> > QueueEntryType;
+  std::priority_queue<QueueEntryType, std::vector<QueueEntryType>, std::greater<QueueEntryType> > queue;
+
+  for (typename PassMapType::const_iterator passIt = passes.begin(); passIt != passes.end(); ++passIt)
+    {
+    const double saliency = passIt->second
+      - std::max(m_LabelMinima[this->FindLabelRoot(passIt->first.first)],
+                 m_LabelMinima[this->FindLabelRoot(passIt->first.second)]);
+    queue.push(QueueEntryType(saliency, std::make_pair(passIt->second, passIt->first)));
+    }
+
+  while (!queue.empty())
+    {
+    QueueEntryType entry = queue.top();
+    queue.pop();
+
+    const LabelPixelType root1 = this->FindLabelRoot(entry.second.second.first);
+    const LabelPixelType root2 = this->FindLabelRoot(entry.second.second.second);
+    if (root1 == root2)
+      {
+      continue;
+      }
+
+    const double saliency = entry.second.first - std::max(m_LabelMinima[root1], m_LabelMinima[root2]);
+    if (saliency > entry.first)
+      {
+      entry.first = saliency;
+      queue.push(entry);
+      continue;
+      }
+    if (saliency > m_SeamMergeLevel)
+      {
+      break;
+      }
+
+    this->MergeLabels(root1, root2);
+    }
+}
+
+template <class TImageType, class TSegmentationFilter>
+void
+PersistentImageToOGRLayerSegmentationFilter<TImageType, TSegmentationFilter>
+::SegmentPieceTiles(const RegionType & piece)
+{
+  const RegionType & largest = this->GetInput()->GetLargestPossibleRegion();
+  const IndexValueType largestEndX = largest.GetIndex(0) + static_cast<IndexValueType>(largest.GetSize(0));
+  const IndexValueType largestEndY = largest.GetIndex(1) + static_cast<IndexValueType>(largest.GetSize(1));
+
+  // Next pieces are below or on the right of this one: strips above its
+  // first row will not be read again
+  const IndexValueType firstRow = piece.GetIndex(1);
+  m_RowStrips.erase(m_RowStrips.begin(), m_RowStrips.lower_bound(firstRow - 1));
+  for (typename StripMapType::iterator columnIt = m_ColumnStrips.begin(); columnIt != m_ColumnStrips.end();)
+    {
+    std::vector<Strip> & strips = columnIt->second;
+    for (unsigned int i = 0; i < strips.size();)
+      {
+      if (strips[i].Begin + static_cast<IndexValueType>(strips[i].Labels.size()) <= firstRow)
+        {
+        strips.erase(strips.begin() + i);
+        }
+      else
+        {
+        ++i;
+        }
+      }
+    if (strips.empty())
+      {
+      m_ColumnStrips.erase(columnIt++);
+      }
+    else
+      {
+      ++columnIt;
+      }
+    }
+
+  // Cut the piece into tiles anchored on the image grid
+  m_PieceTiles.clear();
+  if (m_TileSize == 0)
+    {
+    m_PieceTiles.push_back(piece);
+    }
+  else
+    {
+    const IndexValueType tileSize = static_cast<IndexValueType>(m_TileSize);
+    const IndexValueType xBegin = largest.GetIndex(0)
+      + ((piece.GetIndex(0) - largest.GetIndex(0)) / tileSize) * tileSize;
+    const IndexValueType yBegin = largest.GetIndex(1)
+      + ((piece.GetIndex(1) - largest.GetIndex(1)) / tileSize) * tileSize;
+    const IndexValueType xEnd = piece.GetIndex(0) + static_cast<IndexValueType>(piece.GetSize(0));
+    const IndexValueType yEnd = piece.GetIndex(1) + static_cast<IndexValueType>(piece.GetSize(1));
+
+    for (IndexValueType y = yBegin; y < yEnd; y += tileSize)
+      {
+      for (IndexValueType x = xBegin; x < xEnd; x += tileSize)
+        {
+        RegionType tile;
+        tile.SetIndex(0, x);
+        tile.SetIndex(1, y);
+        tile.SetSize(0, tileSize);
+        tile.SetSize(1, tileSize);
+        if (tile.Crop(piece))
+          {
+          m_PieceTiles.push_back(tile);
+          }
+        }
+      }
+    }
+
+  m_PieceLabels = LabelImageType::New();
+  m_PieceLabels->CopyInformation(m_PieceImage);
+  m_PieceLabels->SetRegions(piece);
+  m_PieceLabels->Allocate();
+
+  m_TileMinima.assign(m_PieceTiles.size(), std::vector<double>());
+
+  // Segment the tiles in parallel. A single tile is segmented by the
+  // segmentation filter itself, with all its threads.
+  if (m_PieceTiles.size() == 1)
+    {
+    this->SegmentTile(0, true);
+    }
+  else
+    {
+    this->GetMultiThreader()->SetNumberOfThreads(this->GetNumberOfThreads());
+    this->GetMultiThreader()->SetSingleMethod(this->SegmentationThreaderCallback, this);
+    this->GetMultiThreader()->SingleMethodExecute();
+    }
+
+  // Give the final labels and find the passes across tile borders, in the
+  // order of the tiles so that the output does not depend on the threads
+  // scheduling
+  PassMapType passes;
+  for (unsigned int tile = 0; tile < m_PieceTiles.size(); ++tile)
+    {
+    const RegionType & core = m_PieceTiles[tile];
+    const std::vector<double> & minima = m_TileMinima[tile];
+    const LabelPixelType firstLabel = static_cast<LabelPixelType>(m_TileMaxLabel);
+
+    itk::ImageRegionIterator<LabelImageType> labelIt(m_PieceLabels, core);
+    for (labelIt.GoToBegin(); !labelIt.IsAtEnd(); ++labelIt)
+      {
+      labelIt.Set(labelIt.Get() + firstLabel);
+      }
+    m_TileMaxLabel += static_cast<int>(minima.size());
+
+    const IndexType & begin = core.GetIndex();
+    const IndexValueType endX = begin[0] + static_cast<IndexValueType>(core.GetSize(0));
+    const IndexValueType endY = begin[1] + static_cast<IndexValueType>(core.GetSize(1));
+
+    // Segments along the first column and row of the tile are compared with
+    // the strips of the tiles on the left and top sides
+    typename StripMapType::const_iterator leftIt = m_ColumnStrips.find(begin[0] - 1);
+    typename StripMapType::const_iterator topIt = m_RowStrips.find(begin[1] - 1);
+    if (leftIt != m_ColumnStrips.end())
+      {
+      this->AddSeamPasses(leftIt->second, begin, 1, begin[1], endY, minima, firstLabel, passes);
+      }
+    if (topIt != m_RowStrips.end())
+      {
+      this->AddSeamPasses(topIt->second, begin, 0, begin[0], endX, minima, firstLabel, passes);
+      }
+
+    // Keep the last column and row of the tile for the next tiles
+    if (endX < largestEndX)
+      {
+      IndexType index = begin;
+      index[0] = endX - 1;
+      this->StoreStrip(m_ColumnStrips[endX - 1], index, 1, begin[1], endY, minima, firstLabel);
+      }
+    if (endY < largestEndY)
+      {
+      IndexType index = begin;
+      index[1] = endY - 1;
+      this->StoreStrip(m_RowStrips[endY - 1], index, 0, begin[0], endX, minima, firstLabel);
+      }
+    }
+
+  this->MergeSeamPasses(passes);
+
+  m_PieceTiles.clear();
+  m_TileMinima.clear();
+}
+
+template <class TImageType, class TSegmentationFilter>
+OGRGeometry *
+PersistentImageToOGRLayerSegmentationFilter<TImageType, TSegmentationFilter>
+::DissolveGeometries(const std::vector<OGRFeatureType> & features)
+{
+  OGRMultiPolygon polygons;
+  bool onlyPolygons = true;
+  for (unsigned int i = 0; i < features.size(); ++i)
+    {
+    const OGRGeometry * geometry = features[i].GetGeometry();
+    switch (wkbFlatten(geometry->getGeometryType()))
+      {
+      case wkbPolygon:
+        polygons.addGeometry(geometry);
+        break;
+      case wkbMultiPolygon:
+      {
+        const OGRMultiPolygon * multiPolygon = dynamic_cast<const OGRMultiPolygon *>(geometry);
+        for (int j = 0; j < multiPolygon->getNumGeometries(); ++j)
+          {
+          polygons.addGeometry(multiPolygon->getGeometryRef(j));
+          }
+        break;
+      }
+      default:
+        onlyPolygons = false;
+        break;
+      }
+    }
+
+  if (onlyPolygons)
+    {
+    return ogr::UnionCascaded(polygons).release();
+    }
+
+  // Fall back to successive unions
+  OGRGeometry * merged = features[0].GetGeometry()->clone();
+  for (unsigned int i = 1; i < features.size() && merged; ++i)
+    {
+    OGRGeometry * previous = merged;
+    merged = ogr::Union(*previous, *features[i].GetGeometry()).release();
+    delete previous;
+    }
+  return merged;
+}
+
+template <class TImageType, class TSegmentationFilter>
+typename PersistentImageToOGRLayerSegmentationFilter<TImageType, TSegmentationFilter>::LabelPixelType
+PersistentImageToOGRLayerSegmentationFilter<TImageType, TSegmentationFilter>
+::GetFieldLabel(const ogr::Field & field)
+{
+#ifdef OTB_USE_GDAL_20
+  // The label field can be either OFTInteger64 or OFTInteger
+  if (field.GetType() == OFTInteger64)
+    {
+    return static_cast<LabelPixelType>(field.GetValue<GIntBig>());
+    }
+#endif
+  return static_cast<LabelPixelType>(field.GetValue<int>());
+}
+
+template <class TImageType, class TSegmentationFilter>
+void
+PersistentImageToOGRLayerSegmentationFilter<TImageType, TSegmentationFilter>
+::SetFieldLabel(ogr::Field field, LabelPixelType label)
+{
+#ifdef OTB_USE_GDAL_20
+  if (field.GetType() == OFTInteger64)
+    {
+    field.SetValue(static_cast<GIntBig>(label));
+    return;
+    }
+#endif
+  field.SetValue(static_cast<int>(label));
+}
+
+template <class TImageType, class TSegmentationFilter>
+void
+PersistentImageToOGRLayerSegmentationFilter<TImageType, TSegmentationFilter>
+::FlushSeamRegions(OGRLayerType & layer, bool flushAll)
+{
+  // Regions with a label on a strip may still be merged with the next tiles
+  LabelSetType activeRoots;
+  if (!flushAll)
+    {
+    const StripMapType * stripMaps[2] = {&m_ColumnStrips, &m_RowStrips};
+    for (unsigned int m = 0; m < 2; ++m)
+      {
+      for (typename StripMapType::const_iterator mapIt = stripMaps[m]->begin(); mapIt != stripMaps[m]->end(); ++mapIt)
+        {
+        for (typename std::vector<Strip>::const_iterator stripIt = mapIt->second.begin(); stripIt != mapIt->second.end(); ++stripIt)
+          {
+          for (unsigned int i = 0; i < stripIt->Labels.size(); ++i)
+            {
+            activeRoots.insert(this->FindLabelRoot(stripIt->Labels[i]));
+            }
+          }
+        }
+      }
+    }
+
+  // Gather the polygons of the complete regions, by merged label
+  typedef std::map<LabelPixelType, std::vector<OGRFeatureType> > FeatureGroupMapType;
+  FeatureGroupMapType groups;
+  std::vector<LabelPixelType> completeLabels;
+  for (typename LabelSetType::const_iterator labelIt = m_SeamLabels.begin(); labelIt != m_SeamLabels.end(); ++labelIt)
+    {
+    const LabelPixelType root = this->FindLabelRoot(*labelIt);
+    if (activeRoots.count(root))
+      {
+      continue;
+      }
+    completeLabels.push_back(*labelIt);
+
+    typename FeatureGroupMapType::iterator featuresIt = m_SeamFeatures.find(*labelIt);
+    if (featuresIt != m_SeamFeatures.end())
+      {
+      std::vector<OGRFeatureType> & group = groups[root];
+      group.insert(group.end(), featuresIt->second.begin(), featuresIt->second.end());
+      m_SeamFeatures.erase(featuresIt);
+      }
+    }
+
+  // Labels of complete regions will not be met again
+  for (unsigned int i = 0; i < completeLabels.size(); ++i)
+    {
+    m_SeamLabels.erase(completeLabels[i]);
+    m_LabelParents.erase(completeLabels[i]);
+    m_LabelMinima.erase(completeLabels[i]);
+    }
+
+  const int fieldIndex = layer.GetLayerDefn().GetFieldIndex(m_FieldName.c_str());
+  if (fieldIndex < 0)
+    {
+    itkExceptionMacro(<< "Field " << m_FieldName << " not found in layer.");
+    }
+
+  const typename InputImageType::SpacingType spacing = this->GetInput()->GetSpacing();
+  const double tol = m_SimplificationTolerance * std::max(vcl_abs(spacing[0]),vcl_abs(spacing[1]));
+
+  for (typename FeatureGroupMapType::const_iterator groupIt = groups.begin(); groupIt != groups.end(); ++groupIt)
+    {
+    const std::vector<OGRFeatureType> & features = groupIt->second;
+
+    ogr::UniqueGeometryPtr geometry(features.size() == 1 ? features[0].GetGeometry()->clone()
+                                    : DissolveGeometries(features));
+    if (!geometry)
+      {
+      otbWarningMacro(<<"Unable to dissolve the " << features.size() << " polygons of label " << groupIt->first << ".");
+      continue;
+      }
+
+    if (m_Simplify)
+      {
+      geometry = ogr::Simplify(*geometry, tol);
+      }
+
+    if (m_FilterSmallObject)
+      {
+      double area = 0.;
+      if (const OGRSurface * surface = dynamic_cast<const OGRSurface *>(geometry.get()))
+        {
+        area = surface->get_Area();
+        }
+      else if (const OGRMultiPolygon * multiPolygon = dynamic_cast<const OGRMultiPolygon *>(geometry.get()))
+        {
+        area = multiPolygon->get_Area();
+        }
+      if (area / vcl_abs(spacing[0]*spacing[1]) < m_MinimumObjectSize)
+        {
+        continue;
+        }
+      }
+
+    try
+      {
+      OGRFeatureType dissolvedFeature(layer.GetLayerDefn());
+      dissolvedFeature.SetGeometryDirectly(otb::move(geometry));
+      SetFieldLabel(dissolvedFeature[fieldIndex], groupIt->first);
+      layer.CreateFeature(dissolvedFeature);
+      }
+    catch(itk::ExceptionObject& err)
+      {
+      otbWarningMacro(<<"An exception was caught while dissolving polygons: "<<err);
+      }
+    }
+
+  otbMsgDebugMacro(<< groups.size() << " regions crossing tile borders written, "
+                   << m_SeamLabels.size() << " labels may still be merged");
+}
+
+template <class TImageType, class TSegmentationFilter>
+void
+PersistentImageToOGRLayerSegmentationFilter<TImageType, TSegmentationFilter>
+::Synthetize()
+{
+  Superclass::Synthetize();
+
+  if (m_TileOverlap == 0 || m_SeamLabels.empty())
+    {
+    return;
+    }
+
+  // Regions on the last strips are complete
+  OGRLayerType layer = this->GetOGRLayer();
+
+  OGRErr errStart = layer.ogr().StartTransaction();
+  if (errStart != OGRERR_NONE)
+    {
+    itkExceptionMacro(<< "Unable to start transaction for OGR layer " << layer.ogr().GetName() << ".");
+    }
+
+  this->FlushSeamRegions(layer, true);
+
+  if (layer.ogr().TestCapability("Transactions"))
+    {
+    OGRErr errCommit = layer.ogr().CommitTransaction();
+    if (errCommit != OGRERR_NONE)
+      {
+      itkExceptionMacro(<< "Unable to commit transaction for OGR layer " << layer.ogr().GetName() << ".");
+      }
+    }
+
+  m_ColumnStrips.clear();
+  m_RowStrips.clear();
+  m_LabelParents.clear();
+  m_LabelMinima.clear();
+  m_SeamLabels.clear();
+  m_SeamFeatures.clear();
+}
+
 template <class TImageType, class TSegmentationFilter>
 typename PersistentImageToOGRLayerSegmentationFilter<TImageType, TSegmentationFilter>::OGRDataSourcePointerType
 PersistentImageToOGRLayerSegmentationFilter<TImageType, TSegmentationFilter>
@@ -89,15 +768,36 @@ PersistentImageToOGRLayerSegmentationFilter<TImageType, TSegmentationFilter>
   // WARNING: itk::ExtractImageFilter does not copy the MetadataDictionary
   extract->GetOutput()->SetMetaDataDictionary(this->GetInput()->GetMetaDataDictionary());
 
-  const unsigned int labelImageIndex = LabeledOutputAccessor<SegmentationFilterType>::LabeledOutputIndex;
-
   typename LabelImageToOGRDataSourceFilterType::Pointer labelImageToOGRDataFilter =
                                               LabelImageToOGRDataSourceFilterType::New();
 
   itk::TimeProbe chrono1;
   chrono1.Start();
-  m_SegmentationFilter->SetInput(extract->GetOutput());
-  m_SegmentationFilter->UpdateLargestPossibleRegion();
+
+  typename LabelImageType::Pointer labelImage;
+  if (m_TileOverlap > 0)
+  {
+     if (!OverlappingTilesSegmentationTraits<SegmentationFilterType>::IsSupported)
+     {
+        itkExceptionMacro(<< "Segmentation by overlapping tiles is not supported by "
+                          << m_SegmentationFilter->GetNameOfClass() << ".");
+     }
+
+     // Only the core of the tiles is vectorized, with labels merged across tile borders
+     m_PieceImage = extract->GetOutput();
+     this->SegmentPieceTiles(this->GetOutput()->GetRequestedRegion());
+     labelImage = m_PieceLabels;
+     m_PieceImage = ITK_NULLPTR;
+     m_PieceLabels = ITK_NULLPTR;
+  }
+  else
+  {
+     m_SegmentationFilter->SetInput(extract->GetOutput());
+     m_SegmentationFilter->UpdateLargestPossibleRegion();
+
+     const unsigned int labelImageIndex = LabeledOutputAccessor<SegmentationFilterType>::LabeledOutputIndex;
+     labelImage = dynamic_cast<LabelImageType *>(m_SegmentationFilter->GetOutputs().at(labelImageIndex).GetPointer());
+  }
 
   chrono1.Stop();
   otbMsgDebugMacro(<<"segmentation took " << chrono1.GetTotal() << " sec");
@@ -111,7 +811,7 @@ PersistentImageToOGRLayerSegmentationFilter<TImageType, TSegmentationFilter>
      typedef itk::ExtractImageFilter<LabelImageType, LabelImageType> ExtractLabelImageFilterType;
      typename ExtractLabelImageFilterType::Pointer maskExtract = ExtractLabelImageFilterType::New();
      maskExtract->SetInput( this->GetInputMask() );
-     maskExtract->SetExtractionRegion( this->GetInput()->GetRequestedRegion() );
+     maskExtract->SetExtractionRegion( labelImage->GetBufferedRegion() );
      maskExtract->Update();
      // WARNING: itk::ExtractImageFilter does not copy the MetadataDictionary
      maskExtract->GetOutput()->SetMetaDataDictionary(this->GetInputMask()->GetMetaDataDictionary());
@@ -119,7 +819,7 @@ PersistentImageToOGRLayerSegmentationFilter<TImageType, TSegmentationFilter>
      labelImageToOGRDataFilter->SetInputMask(maskExtract->GetOutput());
   }
 
-  labelImageToOGRDataFilter->SetInput(dynamic_cast<LabelImageType *>(m_SegmentationFilter->GetOutputs().at(labelImageIndex).GetPointer()));
+  labelImageToOGRDataFilter->SetInput(labelImage);
   labelImageToOGRDataFilter->SetFieldName(m_FieldName);
   labelImageToOGRDataFilter->SetUse8Connected(m_Use8Connected);
   labelImageToOGRDataFilter->Update();
@@ -140,9 +840,24 @@ PersistentImageToOGRLayerSegmentationFilter<TImageType, TSegmentationFilter>
   for(featIt = tmpLayer.begin(); featIt!=tmpLayer.end(); ++featIt)
   {
      ogr::Field field = (*featIt)[0];
-     // field.Unset();
-     field.SetValue(m_TileMaxLabel);
-     m_TileMaxLabel++;
+     if (m_TileOverlap > 0)
+     {
+        // Labels are already final. Polygons crossing tile borders are kept
+        // aside, to be dissolved, simplified and filtered once complete.
+        const LabelPixelType label = GetFieldLabel(field);
+        if (m_SeamLabels.count(label))
+        {
+           m_SeamFeatures[label].push_back((*featIt).Clone());
+           tmpLayer.DeleteFeature((*featIt).GetFID());
+           continue;
+        }
+     }
+     else
+     {
+        // field.Unset();
+        field.SetValue(m_TileMaxLabel);
+        m_TileMaxLabel++;
+     }
 
      //Simplify the geometry
      if (m_Simplify)
@@ -169,6 +884,10 @@ PersistentImageToOGRLayerSegmentationFilter<TImageType, TSegmentationFilter>
         }
      }
   }
+  if (m_TileOverlap > 0)
+  {
+     this->FlushSeamRegions(tmpLayer, false);
+  }
   chrono3.Stop();
   otbMsgDebugMacro(<< "relabeling, filtering small objects and simplifying geometries took " << chrono3.GetTotal() << " sec");
 
@@ -38,6 +38,7 @@ otb_module(OTBOGRProcessing
     OTBTestKernel
     OTBImageIO
     OTBImageBase
+    OTBWatersheds
 
   DESCRIPTION
     "${DOCUMENTATION}"
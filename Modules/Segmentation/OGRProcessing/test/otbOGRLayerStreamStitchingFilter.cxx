@@ -26,10 +26,10 @@
 
 int otbOGRLayerStreamStitchingFilter(int argc, char * argv[])
 {
-  if (argc != 5)
+  if (argc != 5 && argc != 6)
     {
       std::cerr << "Usage: " << argv[0];
-      std::cerr << " inputImage inputOGR outputOGR streamingSize" << std::endl;
+      std::cerr << " inputImage inputOGR outputOGR streamingSize [numberOfThreadsForParallelStitching]" << std::endl;
       return EXIT_FAILURE;
     }
 
@@ -83,6 +83,11 @@ int otbOGRLayerStreamStitchingFilter(int argc, char * argv[])
   filter->SetInput(reader->GetOutput());
   filter->SetOGRLayer(ogrDS->GetLayer(layerName));
   filter->SetStreamSize(streamSize);
+  if (argc == 6)
+    {
+    filter->ParallelStitchingOn();
+    filter->SetNumberOfThreads(atoi(argv[5]));
+    }
   filter->GenerateData();
 
   //REPACK the layer to remove features marked as deleted in the Shapefile.
@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "otbStreamingImageToOGRLayerSegmentationFilter.h"
+#include "otbWatershedSegmentationFilter.h"
+#include "otbImage.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <set>
+#include <vector>
+
+/** Segment the distance map to a set of seeds by overlapping tiles. The
+ * basins of the watershed are the Voronoi cells of the seeds: whatever the
+ * tiles and streaming, each cell must be a single feature, with its own
+ * label, and contain one seed. */
+int otbStreamingImageToOGRLayerSegmentationFilterTiles(int argc, char * argv[])
+{
+  if (argc != 4)
+    {
+    std::cerr << "Usage: " << argv[0] << " tileSize tileOverlap numberOfStreamDivisions" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const unsigned int tileSize = atoi(argv[1]);
+  const unsigned int tileOverlap = atoi(argv[2]);
+  const unsigned int numberOfDivisions = atoi(argv[3]);
+
+  typedef otb::Image<float, 2>        ImageType;
+  typedef otb::Image<unsigned int, 2> LabelImageType;
+  typedef otb::WatershedSegmentationFilter<ImageType, LabelImageType> SegmentationFilterType;
+  typedef otb::StreamingImageToOGRLayerSegmentationFilter<ImageType, SegmentationFilterType> FilterType;
+
+  // Seeds on a jittered grid, so that the cell of each pixel has its seed
+  // within the margin of the tiles
+  const unsigned int width = 160;
+  const unsigned int height = 128;
+  const int step = 24;
+  std::vector<ImageType::IndexType> seeds;
+  for (int i = 0; 12 + step * i < static_cast<int>(width); ++i)
+    {
+    for (int j = 0; 12 + step * j < static_cast<int>(height); ++j)
+      {
+      ImageType::IndexType seed;
+      seed[0] = 12 + step * i + (7 * i + 3 * j) % 9 - 4;
+      seed[1] = 12 + step * j + (5 * i + 11 * j) % 9 - 4;
+      seeds.push_back(seed);
+      }
+    }
+
+  ImageType::RegionType region;
+  region.SetSize(0, width);
+  region.SetSize(1, height);
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions(region);
+  image->Allocate();
+
+  float maximum = 0.;
+  itk::ImageRegionIteratorWithIndex<ImageType> it(image, region);
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+    float distance = static_cast<float>(width + height);
+    for (unsigned int s = 0; s < seeds.size(); ++s)
+      {
+      const float dx = static_cast<float>(it.GetIndex()[0] - seeds[s][0]);
+      const float dy = static_cast<float>(it.GetIndex()[1] - seeds[s][1]);
+      distance = std::min(distance, std::sqrt(dx * dx + dy * dy));
+      }
+    it.Set(distance);
+    maximum = std::max(maximum, distance);
+    }
+
+  otb::ogr::DataSource::Pointer ogrDS = otb::ogr::DataSource::New();
+  otb::ogr::Layer layer = ogrDS->CreateLayer("layer", ITK_NULLPTR, wkbMultiPolygon);
+  OGRFieldDefn field("DN", OFTInteger);
+  layer.CreateField(field, true);
+
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput(image);
+  filter->SetOGRLayer(layer);
+  filter->SetFieldName("DN");
+  filter->SetStartLabel(1);
+  filter->SetTileSize(tileSize);
+  filter->SetTileOverlap(tileOverlap);
+  filter->SetSeamMergeLevel(0.);
+  filter->GetStreamer()->SetNumberOfDivisionsStrippedStreaming(numberOfDivisions);
+  filter->GetSegmentationFilter()->SetThreshold(0.);
+  filter->GetSegmentationFilter()->SetLevel(0.);
+  filter->GetSegmentationFilter()->SetInputMinimum(0.);
+  filter->GetSegmentationFilter()->SetInputMaximum(maximum);
+  filter->Initialize();
+  filter->Update();
+
+  bool ok = true;
+
+  std::set<int> labels;
+  for (otb::ogr::Layer::iterator featIt = layer.begin(); featIt != layer.end(); ++featIt)
+    {
+    labels.insert((*featIt)["DN"].GetValue<int>());
+    }
+  if (labels.size() != seeds.size())
+    {
+    std::cerr << labels.size() << " labels found for " << seeds.size() << " seeds." << std::endl;
+    ok = false;
+    }
+
+  std::set<int> seedLabels;
+  for (unsigned int s = 0; s < seeds.size(); ++s)
+    {
+    OGRPoint point(seeds[s][0], seeds[s][1]);
+    unsigned int nbFeatures = 0;
+    for (otb::ogr::Layer::iterator featIt = layer.begin(); featIt != layer.end(); ++featIt)
+      {
+      if (featIt->GetGeometry()->Contains(&point))
+        {
+        ++nbFeatures;
+        seedLabels.insert((*featIt)["DN"].GetValue<int>());
+        }
+      }
+    if (nbFeatures != 1)
+      {
+      std::cerr << "Seed " << seeds[s] << " is in " << nbFeatures << " features." << std::endl;
+      ok = false;
+      }
+    }
+  if (seedLabels.size() != seeds.size())
+    {
+    std::cerr << "Seeds are in " << seedLabels.size() << " different regions." << std::endl;
+    ok = false;
+    }
+
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -25,6 +25,7 @@
 #include "itkUnaryFunctorImageFilter.h"
 #include "itkCastImageFilter.h"
 #include "itkWatershedImageFilter.h"
+#include "itkThresholdImageFilter.h"
 
 namespace otb {
 
@@ -40,6 +41,16 @@ namespace otb {
 *
 *   For more information, please refere to the documentation of the
 *   original itk::WatershedImageFilter .
+*
+*   By default, Threshold and Level are relative to the range of the
+*   input, as in itk::WatershedImageFilter. When the input is a tile of a
+*   larger image, the range of the whole image can be given with
+*   SetInputMinimum() and SetInputMaximum(). The input is then clamped
+*   below InputMinimum + Threshold * (InputMaximum - InputMinimum), and
+*   adjacent basins are merged while the height of their lowest pass
+*   above the higher of their minima is below
+*   Level * (InputMaximum - InputMinimum), so that the segmentation of a
+*   tile does not depend on its content.
 *
  *
  * \ingroup OTBWatersheds
@@ -65,6 +76,8 @@ public:
   typedef itk::CastImageFilter<InternalOutputImageType,
                                OutputLabelImageType>              CastImageFilterType;
 
+  typedef itk::ThresholdImageFilter<InputImageType>               ThresholdImageFilterType;
+
   /** Method for creation through the object factory. */
   itkNewMacro(Self);
 
@@ -80,6 +93,15 @@ public:
   otbSetObjectMemberMacro(WatershedFilter,Threshold,float);
   otbGetObjectMemberMacro(WatershedFilter,Threshold,float);
 
+  /** Set/Get the range of the input used for Threshold and Level. If
+   * InputMaximum is not greater than InputMinimum (the default), the range
+   * of the input of each update is used. */
+  itkSetMacro(InputMinimum, double);
+  itkGetConstMacro(InputMinimum, double);
+
+  itkSetMacro(InputMaximum, double);
+  itkGetConstMacro(InputMaximum, double);
+
 
 protected:
   WatershedSegmentationFilter();
@@ -88,9 +110,23 @@ protected:
 
   void GenerateData() ITK_OVERRIDE;
 
+  /** Merge the basins of the label image while the height of their lowest
+   * pass above the higher of their minima is below level */
+  void MergeBasins(const InputImageType * heights, InternalOutputImageType * labels, double level) const;
+
+  /** Clone with the same segmentation parameters */
+  itk::LightObject::Pointer InternalClone() const ITK_OVERRIDE;
+
 private:
+  WatershedSegmentationFilter(const Self &); //purposely not implemented
+  void operator =(const Self&); //purposely not implemented
+
   typename CastImageFilterType::Pointer m_CastFilter;
   typename WatershedFilterType::Pointer m_WatershedFilter;
+  typename ThresholdImageFilterType::Pointer m_ThresholdFilter;
+
+  double m_InputMinimum;
+  double m_InputMaximum;
 };
 
 
@@ -23,14 +23,23 @@
 
 #include "otbWatershedSegmentationFilter.h"
 
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+
+#include <functional>
+#include <map>
+#include <queue>
+#include <vector>
+
 namespace otb {
 
 template <class TInputImage,  class TOutputLabelImage>
 WatershedSegmentationFilter<TInputImage, TOutputLabelImage>
-::WatershedSegmentationFilter()
+::WatershedSegmentationFilter() : m_InputMinimum(0.), m_InputMaximum(0.)
 {
    m_WatershedFilter = WatershedFilterType::New();
    m_CastFilter      = CastImageFilterType::New();
+   m_ThresholdFilter = ThresholdImageFilterType::New();
    m_CastFilter->SetInput(m_WatershedFilter->GetOutput());
    this->SetNthOutput(0,TOutputLabelImage::New());
 }
@@ -46,16 +55,229 @@ void
 WatershedSegmentationFilter<TInputImage, TOutputLabelImage>
 ::GenerateData()
 {
-  this->m_WatershedFilter->SetInput(this->GetInput());
+  m_CastFilter->SetNumberOfThreads(this->GetNumberOfThreads());
+
+  const float threshold = m_WatershedFilter->GetThreshold();
+  const float level = m_WatershedFilter->GetLevel();
+
+  if (m_InputMaximum > m_InputMinimum)
+    {
+    // Threshold and level are given relative to the input range: the input
+    // is clamped here, and basins are merged after the segmentation
+    const double range = m_InputMaximum - m_InputMinimum;
+    const typename InputImageType::PixelType absoluteThreshold =
+      static_cast<typename InputImageType::PixelType>(m_InputMinimum + threshold * range);
+
+    m_ThresholdFilter->SetInput(this->GetInput());
+    m_ThresholdFilter->ThresholdBelow(absoluteThreshold);
+    m_ThresholdFilter->SetOutsideValue(absoluteThreshold);
+    m_ThresholdFilter->SetNumberOfThreads(this->GetNumberOfThreads());
+    m_ThresholdFilter->Update();
+
+    m_WatershedFilter->SetInput(m_ThresholdFilter->GetOutput());
+    m_WatershedFilter->SetThreshold(0.);
+    m_WatershedFilter->SetLevel(0.);
+    m_WatershedFilter->Update();
+
+    this->MergeBasins(m_ThresholdFilter->GetOutput(), m_WatershedFilter->GetOutput(), level * range);
+    }
+  else
+    {
+    this->m_WatershedFilter->SetInput(this->GetInput());
+    }
+
   m_CastFilter->GraftOutput(this->GetOutput());
   m_CastFilter->Update();
   this->GraftOutput(m_CastFilter->GetOutput());
 
+  // Restore the relative parameters once the pipeline has run, so that
+  // the watershed is not updated again by the cast filter
+  if (m_InputMaximum > m_InputMinimum)
+    {
+    m_WatershedFilter->SetThreshold(threshold);
+    m_WatershedFilter->SetLevel(level);
+    }
+
   // Since WatershedFilterType outputs an itk::Image,
   // we loose the additional metadata of OTB like ProjectionRef.
   // Import them before exiting
   this->GetOutput()->CopyInformation( this->GetInput() );
 }
 
+template <class TInputImage,  class TOutputLabelImage>
+void
+WatershedSegmentationFilter<TInputImage, TOutputLabelImage>
+::MergeBasins(const InputImageType * heights, InternalOutputImageType * labels, double level) const
+{
+  typedef typename InternalOutputImageType::PixelType LabelType;
+  typedef std::pair<LabelType, LabelType>             LabelPairType;
+  typedef std::map<LabelType, double>                 MinimumMapType;
+  typedef std::map<LabelPairType, double>             PassMapType;
+
+  if (level <= 0.)
+    {
+    return;
+    }
+
+  const typename InternalOutputImageType::RegionType region = labels->GetBufferedRegion();
+  const unsigned int width = region.GetSize(0);
+
+  // Minimum of each basin, and lowest pass between adjacent basins. The
+  // height of a pass between two pixels is the highest of their heights.
+  MinimumMapType minima;
+  PassMapType passes;
+
+  std::vector<LabelType> upperLabels(width), currentLabels(width);
+  std::vector<double> upperHeights(width), currentHeights(width);
+
+  itk::ImageRegionConstIterator<InternalOutputImageType> labelIt(labels, region);
+  itk::ImageRegionConstIterator<InputImageType> heightIt(heights, region);
+  labelIt.GoToBegin();
+  heightIt.GoToBegin();
+  for (unsigned int y = 0; !labelIt.IsAtEnd(); ++y)
+    {
+    for (unsigned int x = 0; x < width; ++x, ++labelIt, ++heightIt)
+      {
+      const LabelType label = labelIt.Get();
+      const double height = static_cast<double>(heightIt.Get());
+      currentLabels[x] = label;
+      currentHeights[x] = height;
+
+      typename MinimumMapType::iterator minIt = minima.find(label);
+      if (minIt == minima.end())
+        {
+        minima[label] = height;
+        }
+      else if (height < minIt->second)
+        {
+        minIt->second = height;
+        }
+
+      // Left and upper neighbours
+      for (unsigned int n = 0; n < 2; ++n)
+        {
+        if ((n == 0 && x == 0) || (n == 1 && y == 0))
+          {
+          continue;
+          }
+        const LabelType neighbourLabel = (n == 0) ? currentLabels[x - 1] : upperLabels[x];
+        if (neighbourLabel == label)
+          {
+          continue;
+          }
+        const double neighbourHeight = (n == 0) ? currentHeights[x - 1] : upperHeights[x];
+        const double pass = std::max(height, neighbourHeight);
+        const LabelPairType key(std::min(label, neighbourLabel), std::max(label, neighbourLabel));
+        typename PassMapType::iterator passIt = passes.find(key);
+        if (passIt == passes.end())
+          {
+          passes[key] = pass;
+          }
+        else if (pass < passIt->second)
+          {
+          passIt->second = pass;
+          }
+        }
+      }
+    upperLabels.swap(currentLabels);
+    upperHeights.swap(currentHeights);
+    }
+
+  // Flood the basins: passes are processed by increasing saliency, which
+  // is the height of the pass above the higher of the minima of the two
+  // basins. Saliencies can only increase as basins are merged, so that
+  // outdated entries of the queue are pushed back with their new value.
+  typedef std::pair<double, std::pair<double, LabelPairType> > QueueEntryType;
+  std::priority_queue<QueueEntryType, std::vector<QueueEntryType>, std::greater<QueueEntryType> > queue;
+  for (typename PassMapType::const_iterator passIt = passes.begin(); passIt != passes.end(); ++passIt)
+    {
+    const double saliency = passIt->second
+      - std::max(minima[passIt->first.first], minima[passIt->first.second]);
+    queue.push(QueueEntryType(saliency, std::make_pair(passIt->second, passIt->first)));
+    }
+
+  std::map<LabelType, LabelType> parents;
+  while (!queue.empty())
+    {
+    QueueEntryType entry = queue.top();
+    queue.pop();
+
+    LabelType roots[2] = {entry.second.second.first, entry.second.second.second};
+    for (unsigned int i = 0; i < 2; ++i)
+      {
+      typename std::map<LabelType, LabelType>::const_iterator parentIt = parents.find(roots[i]);
+      while (parentIt != parents.end())
+        {
+        roots[i] = parentIt->second;
+        parentIt = parents.find(roots[i]);
+        }
+      }
+    if (roots[0] == roots[1])
+      {
+      continue;
+      }
+
+    const double saliency = entry.second.first - std::max(minima[roots[0]], minima[roots[1]]);
+    if (saliency > entry.first)
+      {
+      entry.first = saliency;
+      queue.push(entry);
+      continue;
+      }
+    if (saliency >= level)
+      {
+      break;
+      }
+
+    parents[roots[1]] = roots[0];
+    minima[roots[0]] = std::min(minima[roots[0]], minima[roots[1]]);
+    }
+
+  if (parents.empty())
+    {
+    return;
+    }
+
+  // Relabel merged basins
+  std::map<LabelType, LabelType> finalLabels;
+  itk::ImageRegionIterator<InternalOutputImageType> outIt(labels, region);
+  for (outIt.GoToBegin(); !outIt.IsAtEnd(); ++outIt)
+    {
+    const LabelType label = outIt.Get();
+    typename std::map<LabelType, LabelType>::const_iterator finalIt = finalLabels.find(label);
+    if (finalIt != finalLabels.end())
+      {
+      outIt.Set(finalIt->second);
+      continue;
+      }
+    LabelType root = label;
+    typename std::map<LabelType, LabelType>::const_iterator parentIt = parents.find(root);
+    while (parentIt != parents.end())
+      {
+      root = parentIt->second;
+      parentIt = parents.find(root);
+      }
+    finalLabels[label] = root;
+    outIt.Set(root);
+    }
+}
+
+template <class TInputImage,  class TOutputLabelImage>
+itk::LightObject::Pointer
+WatershedSegmentationFilter<TInputImage, TOutputLabelImage>
+::InternalClone() const
+{
+  Pointer clone = Self::New();
+
+  clone->SetThreshold(m_WatershedFilter->GetThreshold());
+  clone->SetLevel(m_WatershedFilter->GetLevel());
+  clone->m_InputMinimum = m_InputMinimum;
+  clone->m_InputMaximum = m_InputMaximum;
+  clone->SetNumberOfThreads(this->GetNumberOfThreads());
+
+  itk::LightObject::Pointer loPtr = clone.GetPointer();
+  return loPtr;
+}
+
 } // end namespace otb
 #endif
@@ -46,6 +46,7 @@ using ossimplugins::time::seconds;
 namespace {// Anonymous namespace
    const bool         k_verbose = false; // global verbose constant; TODO: use an option
    const unsigned int k_version = 2;
+   const unsigned int k_orbitLagrangeDegree = 8; // default degree of interpolateSensorPosVel()
 
    // Sometimes, we don't need to compare the actual distance, its square value is
    // more than enough.
@@ -94,6 +95,26 @@ namespace {// Anonymous namespace
          assert(out_odd.size() + out_even.size() == size);
       }
 
+   template <typename OrbitRecordType>
+      struct OrbitRecordTimeLess
+      {
+         template <typename TimeType>
+         bool operator()(TimeType const& time, OrbitRecordType const& record) const
+         { return time < record.azimuthTime; }
+      };
+
+   template <typename GCPRecordType>
+      struct GCPLineLess
+      {
+         explicit GCPLineLess(std::vector<GCPRecordType> const& records) : m_records(records) {}
+         bool operator()(std::size_t lhs, std::size_t rhs) const
+         { return m_records[lhs].imPt.y < m_records[rhs].imPt.y; }
+         bool operator()(std::size_t lhs, double rhs) const
+         { return m_records[lhs].imPt.y < rhs; }
+      private:
+         std::vector<GCPRecordType> const& m_records;
+      };
+
    ossimTrace traceExec  ("ossimSarSensorModel:exec");
    ossimTrace traceDebug ("ossimSarSensorModel:debug");
 
@@ -133,7 +154,8 @@ namespace ossimplugins
       theRangeResolution(0.),
       theBistaticCorrectionNeeded(false),
       theAzimuthTimeOffset(seconds(0)),
-      theRangeTimeOffset(0.)
+      theRangeTimeOffset(0.),
+      theOrbitLagrangeDegree(0)
       {}
 
    ossimSarSensorModel::GCPRecordType const&
@@ -141,6 +163,11 @@ namespace ossimplugins
       {
          assert(!theGCPRecords.empty()&&"theGCPRecords is empty.");
 
+         if (theGCPLineIndex.size() == theGCPRecords.size() && !imPt.hasNans())
+         {
+            return theGCPRecords[findClosestGCPIndex(imPt, theGCPRecords.size())];
+         }
+
          // Find the closest GCP
          double distance2 = squareDistance(imPt, theGCPRecords.front().imPt);
 
@@ -162,6 +189,108 @@ namespace ossimplugins
          return *refGcp;
       }
 
+   std::size_t ossimSarSensorModel::findClosestGCPIndex(ossimDpt const& imPt, std::size_t hint) const
+   {
+      assert(!theGCPRecords.empty()&&"theGCPRecords is empty.");
+
+      const std::size_t nbGCPs = theGCPRecords.size();
+
+      if (theGCPLineIndex.size() != nbGCPs || imPt.hasNans())
+      {
+         return &findClosestGCP(imPt) - &theGCPRecords.front();
+      }
+
+      // First GCP at or after the line of imPt
+      const std::vector<std::size_t>::const_iterator start
+         = std::lower_bound(theGCPLineIndex.begin(), theGCPLineIndex.end(), imPt.y, GCPLineLess<GCPRecordType>(theGCPRecords));
+
+      std::size_t bestId = hint < nbGCPs ? hint : theGCPLineIndex[std::min<std::size_t>(start - theGCPLineIndex.begin(), nbGCPs-1)];
+      double distance2 = squareDistance(imPt, theGCPRecords[bestId].imPt);
+
+      // The line distance alone is a lower bound of the distance, and it
+      // grows as we walk away from start. On equal distances, the first
+      // GCP in theGCPRecords is kept, as a linear search would do.
+      for (std::vector<std::size_t>::const_iterator it = start; it != theGCPLineIndex.end(); ++it)
+      {
+         const double dy = theGCPRecords[*it].imPt.y - imPt.y;
+         if (dy*dy > distance2)
+         {
+            break;
+         }
+         const double currentDistance2 = squareDistance(imPt, theGCPRecords[*it].imPt);
+         if (currentDistance2 < distance2 || (currentDistance2 == distance2 && *it < bestId))
+         {
+            distance2 = currentDistance2;
+            bestId = *it;
+         }
+      }
+      for (std::vector<std::size_t>::const_iterator it = start; it != theGCPLineIndex.begin(); )
+      {
+         --it;
+         const double dy = imPt.y - theGCPRecords[*it].imPt.y;
+         if (dy*dy > distance2)
+         {
+            break;
+         }
+         const double currentDistance2 = squareDistance(imPt, theGCPRecords[*it].imPt);
+         if (currentDistance2 < distance2 || (currentDistance2 == distance2 && *it < bestId))
+         {
+            distance2 = currentDistance2;
+            bestId = *it;
+         }
+      }
+
+      return bestId;
+   }
+
+   void ossimSarSensorModel::buildLookupTables()
+   {
+      theOrbitLagrangeDenominators.clear();
+      theOrbitLagrangeDegree = 0;
+      theGCPLineIndex.clear();
+
+      // Orbit records: the nearest record search relies on sorted times
+      const std::size_t nbRecords = theOrbitRecords.size();
+      bool sorted = true;
+      for (std::size_t i = 1; i < nbRecords && sorted; ++i)
+      {
+         sorted = !(theOrbitRecords[i].azimuthTime < theOrbitRecords[i-1].azimuthTime);
+      }
+
+      if (sorted && nbRecords >= 2)
+      {
+         // Denominators of the lagrangian weights within interpolation
+         // windows, stored as theOrbitLagrangeDenominators[i*width + j-i + deg-1]
+         const int deg   = k_orbitLagrangeDegree;
+         const int width = 2*deg-1;
+         const int n     = nbRecords;
+         theOrbitLagrangeDenominators.resize(nbRecords*width, DurationType(0));
+         for (int i = 0; i < n; ++i)
+         {
+            for (int j = std::max(0, i-deg+1); j <= std::min(n-1, i+deg-1); ++j)
+            {
+               theOrbitLagrangeDenominators[i*width + j-i + deg-1] = theOrbitRecords[i].azimuthTime - theOrbitRecords[j].azimuthTime;
+            }
+         }
+         theOrbitLagrangeDegree = k_orbitLagrangeDegree;
+      }
+
+      // GCPs sorted by line
+      for (std::vector<GCPRecordType>::const_iterator gcpIt = theGCPRecords.begin(); gcpIt != theGCPRecords.end(); ++gcpIt)
+      {
+         if (gcpIt->imPt.hasNans())
+         {
+            return;
+         }
+      }
+      theGCPLineIndex.resize(theGCPRecords.size());
+      for (std::size_t i = 0; i < theGCPLineIndex.size(); ++i)
+      {
+         theGCPLineIndex[i] = i;
+      }
+      std::stable_sort(theGCPLineIndex.begin(), theGCPLineIndex.end(), GCPLineLess<GCPRecordType>(theGCPRecords));
+   }
+
    void ossimSarSensorModel::lineSampleHeightToWorld(const ossimDpt& imPt, const double & heightAboveEllipsoid, ossimGpt& worldPt) const
    {
       // std::clog << "ossimSarSensorModel::lineSampleHeightToWorld()\n";
@@ -207,6 +336,44 @@ namespace ossimplugins
       worldPt = ossimGpt(ellPt);
    }
 
+   void ossimSarSensorModel::lineSampleHeightToWorld(const ossimDpt * imPts, const double * heightsEllipsoid, ossimGpt * worldPts, std::size_t nbPoints) const
+   {
+      assert(!theGCPRecords.empty()&&"theGCPRecords is empty.");
+
+      std::size_t gcpId = theGCPRecords.size();
+
+      for (std::size_t i = 0; i < nbPoints; ++i)
+      {
+         // Neighbouring points share their closest GCP most of the time
+         gcpId = findClosestGCPIndex(imPts[i], gcpId);
+         GCPRecordType const& refGcp = theGCPRecords[gcpId];
+
+         ossimEcefPoint ellPt;
+
+         if (heightsEllipsoid)
+         {
+            const ossim_float64 hgtSet = ossim::isnan(heightsEllipsoid[i]) ? refGcp.worldPt.height() : heightsEllipsoid[i];
+            const ossimHgtRef hgtRef(AT_HGT, hgtSet);
+            projToSurface(refGcp,imPts[i],hgtRef,ellPt);
+         }
+         else
+         {
+            const ossimHgtRef hgtRef(AT_DEM);
+            projToSurface(refGcp,imPts[i],hgtRef,ellPt);
+         }
+
+         worldPts[i] = ossimGpt(ellPt);
+      }
+   }
+
+   void ossimSarSensorModel::worldToLineSample(const ossimGpt * worldPts, ossimDpt * imPts, std::size_t nbPoints) const
+   {
+      for (std::size_t i = 0; i < nbPoints; ++i)
+      {
+         worldToLineSample(worldPts[i], imPts[i]);
+      }
+   }
+
    void ossimSarSensorModel::worldToLineSample(const ossimGpt& worldPt, ossimDpt & imPt) const
    {
       // std::clog << "ossimSarSensorModel::worldToLineSample()\n";
@@ -346,11 +513,40 @@ namespace ossimplugins
       // First, we search for the correct set of record to use during
       // interpolation
 
+      // Lookup tables are only built for the default degree
+      const bool useLookupTables
+         =  deg == theOrbitLagrangeDegree
+         && theOrbitLagrangeDenominators.size() == theOrbitRecords.size()*(2*deg-1);
+
       // If there are less records than degrees, use them all
       if(theOrbitRecords.size()<deg)
       {
          nEnd = theOrbitRecords.size()-1;
       }
+      else if(useLookupTables)
+      {
+         // Records are sorted: the closest one is next to the first
+         // record after the azimuth time. As with the linear search
+         // below, the first record at the minimal distance is kept.
+         const std::vector<OrbitRecordType>::const_iterator next
+            = std::upper_bound(theOrbitRecords.begin(), theOrbitRecords.end(), azimuthTime, OrbitRecordTimeLess<OrbitRecordType>());
+         unsigned int t_min_idx = next - theOrbitRecords.begin();
+
+         if (t_min_idx == theOrbitRecords.size()
+               || (t_min_idx > 0 && !(abs(azimuthTime - theOrbitRecords[t_min_idx].azimuthTime) < abs(azimuthTime - theOrbitRecords[t_min_idx-1].azimuthTime))))
+         {
+            --t_min_idx;
+            const DurationType t_min = abs(azimuthTime - theOrbitRecords[t_min_idx].azimuthTime);
+            while (t_min_idx > 0 && abs(azimuthTime - theOrbitRecords[t_min_idx-1].azimuthTime) == t_min)
+            {
+               --t_min_idx;
+            }
+         }
+
+         nBegin = std::max((int)t_min_idx-(int)deg/2+1,(int)0);
+         nEnd = std::min(nBegin+deg-1,(unsigned int)theOrbitRecords.size());
+         nBegin = nEnd<theOrbitRecords.size()-1 ? nBegin : nEnd-deg+1;
+      }
       else
       {
          // Search for the deg number of records around the azimuth time
@@ -375,6 +571,42 @@ namespace ossimplugins
          nBegin = nEnd<theOrbitRecords.size()-1 ? nBegin : nEnd-deg+1;
       }
 
+      if (useLookupTables)
+      {
+         // Same computations as below, with the time differences computed
+         // once per record and the denominators taken from the table
+         const unsigned int width = 2*deg-1;
+         DurationType td1[k_orbitLagrangeDegree];
+         for(unsigned int j = nBegin; j < nEnd; ++j)
+         {
+            td1[j-nBegin] = azimuthTime - theOrbitRecords[j].azimuthTime;
+         }
+
+         for(unsigned int i = nBegin; i < nEnd; ++i)
+         {
+            double w = 1.;
+            const DurationType * td2 = &theOrbitLagrangeDenominators[i*width + deg-1 - (i-nBegin)];
+
+            for(unsigned int j = nBegin; j < nEnd; ++j)
+            {
+               if (j != i)
+               {
+                  const double f = td1[j-nBegin] / td2[j-nBegin];
+                  w *= f;
+               }
+            }
+
+            sensorPos[0]+=w*theOrbitRecords[i].position[0];
+            sensorPos[1]+=w*theOrbitRecords[i].position[1];
+            sensorPos[2]+=w*theOrbitRecords[i].position[2];
+
+            sensorVel[0]+=w*theOrbitRecords[i].velocity[0];
+            sensorVel[1]+=w*theOrbitRecords[i].velocity[1];
+            sensorVel[2]+=w*theOrbitRecords[i].velocity[2];
+         }
+         return;
+      }
+
       // Compute lagrangian interpolation using records from nBegin to nEnd
       for(unsigned int i = nBegin; i < nEnd; ++i)
       {
@@ -532,7 +764,8 @@ namespace ossimplugins
       ++it; // -> it != begin
 
       // Look for the consecutive records where doppler freq changes sign
-      // Note: implementing a bisection algorithm here might be faster
+      // Note: a bisection is not used here, since orbit records may cover
+      // more than one pass, with several changes of the doppler sign
       for ( ; it!=theOrbitRecords.end() ; ++it)
       {
          // compute range and doppler of current record
@@ -1176,6 +1409,7 @@ namespace ossimplugins
             throw std::runtime_error("Geom file generated with previous version of ossim plugins");
          }
 
+         buildLookupTables();
          optimizeTimeOffsetsFromGcps();
          return true;
       } catch (std::runtime_error const& e) {
@@ -1278,6 +1512,8 @@ bool ossimSarSensorModel::deburst(std::vector<std::pair<unsigned long, unsigned
 
   theGCPRecords.swap(deburstGCPs);
 
+  buildLookupTables();
+
   return true;
 }
 
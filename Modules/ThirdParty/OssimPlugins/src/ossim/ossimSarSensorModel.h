@@ -220,6 +220,22 @@ public:
 
    virtual void lineSampleToWorld(const ossimDpt& imPt, ossimGpt& worldPt) const;
 
+   /**
+    * Batch version of lineSampleHeightToWorld() and
+    * lineSampleToWorld(). Each point is located as by the point-wise
+    * methods, with the same results. The search for the closest GCP is
+    * warm-started from the GCP found for the previous point, which is
+    * efficient when consecutive points are neighbours (e.g. along an
+    * image line).
+    *
+    * \param[in] imPts Image points to locate
+    * \param[in] heightsEllipsoid Heights above ellipsoid of the points,
+    * or NULL to use the elevation manager (as lineSampleToWorld())
+    * \param[out] worldPts Located world points
+    * \param[in] nbPoints Number of points
+    */
+   void lineSampleHeightToWorld(const ossimDpt * imPts, const double * heightsEllipsoid, ossimGpt * worldPts, std::size_t nbPoints) const;
+
 
    /** This method implement inverse sar geolocation using method found
     *  in ESA document "Guide to ASAR geocoding" (ref
@@ -231,6 +247,15 @@ public:
     */
    virtual void worldToLineSample(const ossimGpt& worldPt, ossimDpt & imPt) const;
 
+   /**
+    * Batch version of worldToLineSample().
+    *
+    * \param[in] worldPts World points to geocode
+    * \param[out] imPts Corresponding estimated image points
+    * \param[in] nbPoints Number of points
+    */
+   void worldToLineSample(const ossimGpt * worldPts, ossimDpt * imPts, std::size_t nbPoints) const;
+
    /**
     * Sub-routine of lineSampleToWorld that computes azimuthTime and
     * slant range time from worldPoint
@@ -401,6 +426,33 @@ protected:
     */
    GCPRecordType const& findClosestGCP(ossimDpt const& imPt) const;
 
+   /**
+    * Finds the position of the closest GCP in `theGCPRecords`.
+    *
+    * The GCPs are searched through `theGCPLineIndex`, starting from
+    * the line of \c imPt, and the search stops as soon as the line
+    * distance alone exceeds the distance to the closest GCP found so
+    * far. Ties are solved as with a linear search.
+    *
+    * \param[in] imPt  Image point
+    * \param[in] hint  Position of a GCP expected to be close to \c imPt
+    * (e.g. the one of a neighbouring point), or theGCPRecords.size()
+    * if there is none.
+    * \return the position of the closest GCP record to \c imPt.
+    * \pre `theGCPRecords` shall not be empty.
+    */
+   std::size_t findClosestGCPIndex(ossimDpt const& imPt, std::size_t hint) const;
+
+   /**
+    * Builds the lookup tables used to speed up geolocation: the
+    * denominators of the lagrangian interpolation of the orbit records
+    * and the index of GCPs sorted by line. It shall be called whenever
+    * the orbit or GCP records are modified. Tables whose size does not
+    * match the records are ignored, and the plain searches are used
+    * instead.
+    */
+   void buildLookupTables();
+
 
    std::vector<OrbitRecordType>                theOrbitRecords;
    std::vector<GCPRecordType>                  theGCPRecords;
@@ -420,6 +472,11 @@ protected:
    double                                      theRangeTimeOffset; // Offset in seconds, computed
 
    static const double C;
+
+   // Lookup tables, see buildLookupTables()
+   std::vector<DurationType>                   theOrbitLagrangeDenominators; // t_i - t_j, for |i-j| < degree
+   unsigned int                                theOrbitLagrangeDegree;
+   std::vector<std::size_t>                    theGCPLineIndex; // GCP positions sorted by line
 private:
    /** Disabled assignment operator.  */
    ossimSarSensorModel& operator=(ossimSarSensorModel const& rhs);
@@ -313,6 +313,7 @@ void ossimSentinel1SarSensorModel::readAnnotationFile(const std::string & annota
         theGCPRecords.push_back(gcpRecord);
     }
 
+    this->buildLookupTables();
     this->optimizeTimeOffsetsFromGcps();
 }
 
@@ -218,5 +218,6 @@ void ossimplugins::ossimTerraSarXSarSensorModel::readAnnotationFile(const std::s
         theGCPRecords.push_back(gcpRecord);
     }
 
+    this->buildLookupTables();
     this->optimizeTimeOffsetsFromGcps();
 }
@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 2005-2017 by Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is licensed under MIT license:
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#if defined(__GNUC__) || defined(__clang__)
+# pragma GCC diagnostic push
+#   pragma GCC diagnostic ignored "-Wunused-parameter"
+#   pragma GCC diagnostic ignored "-Woverloaded-virtual"
+#   pragma GCC diagnostic ignored "-Wshadow"
+#include "ossimSentinel1Model.h"
+#include "ossimPluginProjectionFactory.h"
+# pragma GCC diagnostic pop
+#else
+#include "ossimSentinel1Model.h"
+#include "ossimPluginProjectionFactory.h"
+#endif
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace ossimplugins;
+
+namespace {
+   // Same model, without lookup tables: geolocation goes through the
+   // plain searches
+   class ReferenceModel : public ossimSentinel1Model
+   {
+   public:
+      explicit ReferenceModel(ossimSentinel1Model const& m)
+         : ossimSentinel1Model(m)
+         {
+            theOrbitLagrangeDenominators.clear();
+            theGCPLineIndex.clear();
+         }
+
+      std::vector<GCPRecordType> const& gcps() const
+      { return theGCPRecords; }
+   };
+
+   bool same(ossimDpt const& lhs, ossimDpt const& rhs)
+   {
+      return lhs.x == rhs.x && lhs.y == rhs.y;
+   }
+
+   bool same(ossimGpt const& lhs, ossimGpt const& rhs)
+   {
+      return lhs.lat == rhs.lat && lhs.lon == rhs.lon && lhs.hgt == rhs.hgt;
+   }
+}// Anonymous namespace
+
+int main(int argc, char * argv[])
+{
+   if (argc != 2)
+   {
+      std::cerr << "Usage: " << argv[0] << " <annotationXml>\n";
+      return EXIT_FAILURE;
+   }
+   std::string const annotationXml(argv[1]);
+
+   try {
+      std::auto_ptr<ossimProjection> projection
+         (ossimPluginProjectionFactory::instance()->createProjection(annotationXml, 42));
+      if (!projection.get()) {
+         throw std::runtime_error("Cannot read annotation file ("+annotationXml+"). Cannot create a projection from it.");
+      }
+
+      ossimSentinel1Model * sensor = dynamic_cast<ossimSentinel1Model*>(projection.get());
+      if (!sensor) {
+         throw std::runtime_error(
+               "Unlike Expectations, the annotation file ("+annotationXml+") is not a Sentinel Annotation File");
+      }
+
+      ossimKeywordlist kwl;
+      sensor->saveState(kwl, "S1.");
+      sensor->loadState(kwl, "S1.");
+
+      ReferenceModel const reference(*sensor);
+
+      // Image points over the area covered by the GCPs, line by line
+      std::vector<ossimDpt> imPts;
+      std::vector<double>   heights;
+      std::vector<ossimGpt> worldPts;
+      for (std::vector<ReferenceModel::GCPRecordType>::const_iterator gcpIt = reference.gcps().begin(); gcpIt != reference.gcps().end(); ++gcpIt)
+      {
+         imPts.push_back(gcpIt->imPt);
+      }
+      if (imPts.empty()) {
+         throw std::runtime_error("No GCP found in annotation file ("+annotationXml+")");
+      }
+      const ossimDrect bounds(imPts);
+
+      const unsigned int nbSteps = 25;
+      imPts.clear();
+      for (unsigned int l = 0; l <= nbSteps; ++l)
+      {
+         for (unsigned int s = 0; s <= nbSteps; ++s)
+         {
+            imPts.push_back(ossimDpt(bounds.ul().x + s * bounds.width() / nbSteps,
+                                     bounds.ul().y + l * bounds.height() / nbSteps));
+            heights.push_back(100. * (l % 3));
+         }
+      }
+
+      unsigned int nbErrors = 0;
+
+      // Forward model: point-wise and batch, against the reference
+      worldPts.resize(imPts.size());
+      sensor->lineSampleHeightToWorld(&imPts[0], &heights[0], &worldPts[0], imPts.size());
+      for (std::size_t i = 0; i < imPts.size(); ++i)
+      {
+         ossimGpt refPt, pt;
+         reference.lineSampleHeightToWorld(imPts[i], heights[i], refPt);
+         sensor->lineSampleHeightToWorld(imPts[i], heights[i], pt);
+         if (!same(refPt, pt) || !same(refPt, worldPts[i]))
+         {
+            std::cerr << "Forward: " << imPts[i] << " -> " << refPt << " (reference), "
+               << pt << " (point-wise), " << worldPts[i] << " (batch)\n";
+            ++nbErrors;
+         }
+      }
+
+      // Inverse model: point-wise and batch, against the reference
+      std::vector<ossimDpt> estimatedImPts(worldPts.size());
+      sensor->worldToLineSample(&worldPts[0], &estimatedImPts[0], worldPts.size());
+      for (std::size_t i = 0; i < worldPts.size(); ++i)
+      {
+         ossimDpt refPt, pt;
+         reference.worldToLineSample(worldPts[i], refPt);
+         sensor->worldToLineSample(worldPts[i], pt);
+         if (!same(refPt, pt) || !same(refPt, estimatedImPts[i]))
+         {
+            std::cerr << "Inverse: " << worldPts[i] << " -> " << refPt << " (reference), "
+               << pt << " (point-wise), " << estimatedImPts[i] << " (batch)\n";
+            ++nbErrors;
+         }
+      }
+
+      std::cout << nbErrors << " differences over " << imPts.size() << " points\n";
+      return nbErrors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+   } catch (std::exception const& e) {
+      std::cerr << "Error: " << e.what() << "\n";
+   }
+   return EXIT_FAILURE;
+}
@@ -37,6 +37,7 @@ namespace Wrapper
  * modes to be used, supported modes are DEM, Geoid file, average
  * elevation. The user can get the value relative to each mode
  * using one the following methods Get{AverageElevation, DEMDirectory, GeoidFile}.
+ * The size of the DEM tile cache of DEMHandler can also be set.
  *
  *
  *
@@ -58,6 +59,7 @@ public:
   static OTBApplicationEngine_EXPORT const std::string GetDEMDirectory(const Application::Pointer app, const std::string& key);
   static OTBApplicationEngine_EXPORT bool IsGeoidUsed(const Application::Pointer app, const std::string& key);
   static OTBApplicationEngine_EXPORT bool IsDEMUsed(const Application::Pointer app, const std::string & key);
+  static OTBApplicationEngine_EXPORT unsigned int GetDEMCacheSize(const Application::Pointer app, const std::string& key);
 
   static OTBApplicationEngine_EXPORT void SetupDEMHandlerFromElevationParameters(const Application::Pointer app, const std::string& key);
 
@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbWrapperLocalisationGridParametersHandler_h
+#define otbWrapperLocalisationGridParametersHandler_h
+
+#include "otbWrapperApplication.h"
+#include "otbLocalisationGrid.h"
+
+namespace otb
+{
+namespace Wrapper
+{
+
+/** \class LocalisationGridParametersHandler
+ *  \brief This class represent a helper class for the localisation grid
+ *  cache. It adds the parameters automatically to the application where
+ *  it is used, and provides the grid of an input sensor image.
+ *
+ * When enabled, the localisation grid of the image is read from the
+ * .locgrid.tif file next to it if it was computed for the same product,
+ * elevation settings and node spacing, and computed and written there
+ * otherwise. The elevation settings must be set up before calling
+ * GetLocalisationGrid().
+ *
+ * \sa LocalisationGrid
+ *
+ * \ingroup OTBApplicationEngine
+ */
+
+class LocalisationGridParametersHandler
+{
+public:
+  /** Add a group with the localisation grid parameters */
+  static OTBApplicationEngine_EXPORT void AddLocalisationGridParameters(Application::Pointer app, const std::string & key);
+
+  /** Is the localisation grid cache enabled */
+  static OTBApplicationEngine_EXPORT bool IsLocalisationGridUsed(const Application::Pointer app, const std::string & key);
+
+  /** Get the localisation grid of the sensor image given by the input
+   * image parameter imageKey. Returns a null pointer if the cache is
+   * disabled or if the image is not a sensor image. */
+  static OTBApplicationEngine_EXPORT LocalisationGrid::Pointer GetLocalisationGrid(const Application::Pointer app,
+                                                                                  const std::string & key,
+                                                                                  const std::string & imageKey);
+
+protected:
+  LocalisationGridParametersHandler(); // not implemented
+  virtual ~LocalisationGridParametersHandler(); // not implemented
+};
+
+}
+}
+
+
+#endif // otbWrapperLocalisationGridParametersHandler_h
@@ -79,6 +79,15 @@ void ElevationParametersHandler::AddElevationParameters(Application::Pointer app
   app->SetParameterDescription(oss.str(),"This parameter allows setting the default height above ellipsoid when there is no DEM available, no coverage for some points or pixels with no_data in the DEM tiles, and no geoid file has been set. This is also used by some application as an average elevation value.");
   app->SetDefaultParameterFloat(oss.str(), 0.);
 
+  // DEM cache
+  oss.str("");
+  oss << key <<".cache";
+  app->AddParameter(ParameterType_Int, oss.str(), "DEM cache size");
+  app->SetParameterDescription(oss.str(),"Size in MB of the in-memory cache of DEM tiles. When it is not 0, the tiles of the DEM directory are read once and the heights are interpolated without lock, which speeds up the elevation lookups of multi-threaded processing. With 0, the heights are read through OSSIM.");
+  app->SetDefaultParameterInt(oss.str(), otb::DEMHandler::Instance()->GetDEMCacheSize());
+  app->SetMinimumParameterIntValue(oss.str(), 0);
+  app->MandatoryOff(oss.str());
+
  // TODO : not implemented yet
  //   // Tiff image
  //   oss << ".tiff";
@@ -125,6 +134,16 @@ void ElevationParametersHandler::SetupDEMHandlerFromElevationParameters(const Ap
       app->GetLogger()->Warning( oss.str() );
       }
     }
+
+  // Set DEM cache size, indexing the opened DEM directories
+  const unsigned int cacheSize = GetDEMCacheSize(app,key);
+  otb::DEMHandler::Instance()->SetDEMCacheSize(cacheSize);
+  if(otb::DEMHandler::Instance()->IsDEMCacheActive())
+    {
+    oss.str("");
+    oss<<"Elevation management: using a DEM cache of "<<cacheSize<<" MB"<<std::endl;
+    app->GetLogger()->Info(oss.str());
+    }
 }
 
 /**
@@ -194,6 +213,16 @@ ElevationParametersHandler::GetDEMDirectory(const Application::Pointer app, cons
   return "";
 }
 
+/**
+ * Get the DEM cache size, in MB
+ */
+unsigned int
+ElevationParametersHandler::GetDEMCacheSize(const Application::Pointer app, const std::string& key)
+{
+  std::ostringstream oss;
+  oss << key <<".cache";
+  return static_cast<unsigned int>(app->GetParameterInt(oss.str()));
+}
 
 }// End namespace Wrapper
 }// End namespace otb
@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbWrapperLocalisationGridParametersHandler.h"
+
+namespace otb
+{
+namespace Wrapper
+{
+
+void LocalisationGridParametersHandler::AddLocalisationGridParameters(Application::Pointer app,
+                                                                      const std::string & key)
+{
+  app->AddParameter(ParameterType_Group, key, "Localisation grid cache");
+  app->SetParameterDescription(key,
+                               "This group of parameters allows reusing the sensor model localisation of an input image "
+                               "across runs. The forward and inverse localisation is sampled once on a grid, which is "
+                               "stored next to the image (.locgrid.tif file) and read back by the next runs on the same "
+                               "product with the same elevation settings. Positions are then interpolated in the grid "
+                               "instead of being computed by the sensor model.");
+
+  std::ostringstream oss;
+  oss << key << ".enable";
+  app->AddParameter(ParameterType_Empty, oss.str(), "Use the localisation grid cache");
+  app->SetParameterDescription(oss.str(), "Read or create the localisation grid of the sensor image.");
+  app->MandatoryOff(oss.str());
+
+  oss.str("");
+  oss << key << ".spacing";
+  app->AddParameter(ParameterType_Int, oss.str(), "Grid spacing");
+  app->SetParameterDescription(oss.str(),
+                               "Distance between two nodes of the grid, in pixels of the sensor image. Smaller values "
+                               "give a more accurate localisation over rugged terrain, at the cost of a longer first run.");
+  app->SetDefaultParameterInt(oss.str(), 16);
+  app->SetMinimumParameterIntValue(oss.str(), 1);
+  app->MandatoryOff(oss.str());
+}
+
+bool
+LocalisationGridParametersHandler::IsLocalisationGridUsed(const Application::Pointer app, const std::string & key)
+{
+  std::ostringstream oss;
+  oss << key << ".enable";
+  return app->IsParameterEnabled(oss.str());
+}
+
+LocalisationGrid::Pointer
+LocalisationGridParametersHandler::GetLocalisationGrid(const Application::Pointer app,
+                                                       const std::string & key,
+                                                       const std::string & imageKey)
+{
+  if (!IsLocalisationGridUsed(app, key))
+    {
+    return ITK_NULLPTR;
+    }
+
+  FloatVectorImageType * image = app->GetParameterImage(imageKey);
+  const ImageKeywordlist kwl = image->GetImageKeywordlist();
+  if (kwl.GetSize() == 0 || !image->GetProjectionRef().empty())
+    {
+    return ITK_NULLPTR;
+    }
+
+  std::ostringstream oss;
+  oss << key << ".spacing";
+  LocalisationGrid::Pointer grid = LocalisationGrid::New();
+  grid->SetSpacing(app->GetParameterInt(oss.str()));
+
+  // The grid covers the whole image, pixel borders included
+  const FloatVectorImageType::PointType   origin = image->GetOrigin();
+  const FloatVectorImageType::SpacingType spacing = image->GetSpacing();
+  const FloatVectorImageType::RegionType  region = image->GetLargestPossibleRegion();
+  const double startX = origin[0] + (region.GetIndex()[0] - 0.5) * spacing[0];
+  const double startY = origin[1] + (region.GetIndex()[1] - 0.5) * spacing[1];
+
+  const std::string filename = LocalisationGrid::GetCacheFileName(app->GetParameterString(imageKey));
+  const bool cached = grid->LoadOrGenerate(filename, kwl, startX, startY,
+                                           region.GetSize()[0] * spacing[0], region.GetSize()[1] * spacing[1]);
+
+  oss.str("");
+  oss << "Localisation grid of " << imageKey << (cached ? " read from " : " computed, cache file ")
+      << filename << std::endl;
+  app->GetLogger()->Info(oss.str());
+
+  return grid;
+}
+
+}// End namespace Wrapper
+}// End namespace otb